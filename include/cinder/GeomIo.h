@@ -37,6 +37,8 @@
 #include <map>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <initializer_list>
 
 // Forward declarations in cinder::
 namespace cinder {
@@ -77,6 +79,14 @@ void copyData( uint8_t srcDimensions, size_t srcStrideBytes, const float *srcDat
 void calculateTangents( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const vec2 *texCoords, std::vector<vec3> *resultTangents, std::vector<vec3> *resultBitangents );
 //! Utility function for calculating tangents and bitangents from indexed geometry and 3D texture coordinates. \a resultBitangents may be NULL if not needed.
 void calculateTangents( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const vec3 *texCoords, std::vector<vec3> *resultTangents, std::vector<vec3> *resultBitangents );
+//! Returns the average cache miss ratio (ACMR) of TRIANGLES \a indices: the number of vertices a GPU with a FIFO post-transform cache of \a cacheSize vertices transforms per triangle. Ranges from 3 down to about 0.5 for well ordered regular meshes.
+float calcAcmr( size_t numIndices, const uint32_t *indices, size_t numVertices, size_t cacheSize = 16 );
+//! Reorders TRIANGLES \a indices in place to make better use of a post-transform vertex cache of \a cacheSize vertices, using Tipsify. Runs in linear time.
+void optimizeVertexCache( size_t numIndices, uint32_t *indices, size_t numVertices, size_t cacheSize = 16 );
+//! Reorders clusters of TRIANGLES \a indices in place so that the ones likely to occlude others draw first, reducing overdraw. Expects \a indices already optimized with optimizeVertexCache(), whose ACMR grows by at most about a factor of \a threshold.
+void optimizeOverdraw( size_t numIndices, uint32_t *indices, size_t numVertices, const vec3 *positions, size_t cacheSize = 16, float threshold = 1.05f );
+//! Renumbers the vertices in the order \a indices first reference them, rewriting \a indices, to improve the locality of vertex fetches. \a resultRemap receives the new index of every vertex, with unreferenced vertices moved to the end. Returns the number of referenced vertices.
+size_t optimizeVertexFetch( size_t numIndices, uint32_t *indices, size_t numVertices, std::vector<uint32_t> *resultRemap );
 
 struct AttribInfo {
 	AttribInfo( const Attrib &attrib, uint8_t dims, size_t stride, size_t offset, uint32_t instanceDivisor = 0 )
@@ -158,12 +168,34 @@ class Source {
 	void forceCopyIndicesTrianglesImpl( T *dest ) const;
 };
 
+//! A pointer to elements of type \a T which lie \a strideBytes apart, such as a single attribute in an interleaved vertex buffer.
+template<typename T>
+class StridedPtr {
+  public:
+	StridedPtr() : mData( nullptr ), mStrideBytes( sizeof( T ) ) {}
+	//! A \a strideBytes of \c 0 implies tightly packed data.
+	StridedPtr( T *data, size_t strideBytes = 0 ) : mData( data ), mStrideBytes( strideBytes ? strideBytes : sizeof( T ) ) {}
+
+	T&		operator[]( size_t index ) const	{ return *reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( mData ) + index * mStrideBytes ); }
+	T*		get() const							{ return mData; }
+	size_t	getStrideBytes() const				{ return mStrideBytes; }
+
+  private:
+	T		*mData;
+	size_t	mStrideBytes;
+};
+
 class Target {
   public:
 	virtual uint8_t		getAttribDims( Attrib attr ) const = 0;	
 
 	virtual void	copyAttrib( Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) = 0;
 	virtual void	copyIndices( Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) = 0;
+	/*! Optionally returns the Target's own storage for \a count elements of \a attr with \a dims dimensions, so that a Source can generate its data
+		in place (possibly from several threads) instead of passing it to copyAttrib(). The distance in bytes between elements is returned in \a resultStrideBytes.
+		Filling the storage before loadInto() returns is equivalent to calling copyAttrib() with the same data. The default returns \c nullptr,
+		which means the Target has no storage in that layout and copyAttrib() has to be used. */
+	virtual float*	getAttribStorage( Attrib, uint8_t, size_t, size_t * ) { return nullptr; }
 
 	//! For non-indexed geometry, this generates appropriate indices and then calls the copyIndices() virtual method.
 	void	generateIndices( Primitive sourcePrimitive, size_t sourceNumIndices );
@@ -213,6 +245,23 @@ class Modifier {
 	virtual void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const = 0;
 };
 
+/*! Base class for Modifiers which map every vertex independently of the others, without changing the number of vertices or indices.
+	A run of consecutive PointwiseModifiers in a SourceMods is applied in a single pass over the vertices, block by block, rather than one Modifier after another. */
+class PointwiseModifier : public Modifier {
+  public:
+	//! Processes the upstream, then calls prepare() and processVertices() for all vertices.
+	void			process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+
+	//! Returns an attribute which the Modifier reads and so needs from upstream even if it wasn't requested downstream, or \c NUM_ATTRIBS for none.
+	virtual Attrib	getUpstreamAttrib() const { return NUM_ATTRIBS; }
+	//! Returns whether prepare() keeps the dimensions of every attribute already in \a ctx, which allows the Modifier to share a pass over the vertices with the Modifiers upstream of it.
+	virtual bool	isInPlace( const SourceModsContext & ) const { return true; }
+	//! Called once the upstream has been processed, before processVertices(). Allocates the attributes the Modifier outputs. Returns \c false if processVertices() shouldn't be called, either because the Modifier can't process \a ctx or because it has already done all of its work.
+	virtual bool	prepare( SourceModsContext * ) const { return true; }
+	//! Processes the vertices in the range [\a begin, \a end). Attribute data should be retrieved from \a ctx on every call, as other Modifiers sharing the pass may have run in between.
+	virtual void	processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const = 0;
+};
+
 class Rect : public Source {
   public:
 	//! Equivalent to Rectf( -0.5, -0.5, 0.5, 0.5 )
@@ -379,14 +428,12 @@ class Teapot : public Source {
 	Teapot*		clone() const override { return new Teapot( *this ); }
 
   protected:
-	void			calculate( std::vector<float> *positions, std::vector<float> *normals, std::vector<float> *texCoords, std::vector<uint32_t> *indices ) const;
+	void			calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec2> texCoords, uint32_t *indices ) const;
 	void			updateVertexCounts();
 
-	static void		generatePatches( float *v, float *n, float *tc, uint32_t *el, int grid );
-	static void		buildPatchReflect( int patchNum, float *B, float *dB, float *v, float *n, float *tc, unsigned int *el,
-										int &index, int &elIndex, int &tcIndex, int grid, bool reflectX, bool reflectY );
-	static void		buildPatch( vec3 patch[][4], float *B, float *dB, float *v, float *n, float *tc, 
-										unsigned int *el, int &index, int &elIndex, int &tcIndex, int grid, const mat3 reflect, bool invertNormal );
+	static void		generatePatches( StridedPtr<vec3> v, StridedPtr<vec3> n, StridedPtr<vec2> tc, uint32_t *el, int grid );
+	static void		buildPatch( vec3 patch[][4], const float *B, const float *dB, StridedPtr<vec3> v, StridedPtr<vec3> n, StridedPtr<vec2> tc,
+										uint32_t *el, int startIndex, int grid, const mat3 reflect, bool invertNormal );
 	static void		getPatch( int patchNum, vec3 patch[][4], bool reverseV );
 	static void		computeBasisFunctions( float *B, float *dB, int grid );
 	static vec3		evaluate( int gridU, int gridV, const float *B, const vec3 patch[][4] );
@@ -544,7 +591,7 @@ class Torus : public Source {
 
   protected:
 	void		updateCounts();
-	void		calculate( std::vector<vec3> *positions, std::vector<vec3> *normals, std::vector<vec2> *texCoords, std::vector<vec3> *colors, std::vector<uint32_t> *indices ) const;
+	void		calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec2> texCoords, StridedPtr<vec3> colors, uint32_t *indices ) const;
 
 	vec3		mCenter;
 	float		mRadiusMajor;
@@ -585,7 +632,7 @@ public:
 	TorusKnot*	clone() const override { return new TorusKnot( *this ); }
 
 protected:
-	void		calculate( std::vector<vec3> *positions, std::vector<vec3> *normals, std::vector<vec2> *texCoords, std::vector<vec3> *colors, std::vector<vec3> *tangents, std::vector<uint32_t> *indices ) const;
+	void		calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec2> texCoords, StridedPtr<vec3> colors, StridedPtr<vec3> tangents, uint32_t *indices ) const;
 
 	inline int	gcd( int a, int b ) const
 	{
@@ -768,7 +815,7 @@ class Extrude : public Source {
 	
   protected:
 	void		updatePathSubdivision();
-	void		calculate( std::vector<vec3> *positions, std::vector<vec3> *normals, std::vector<vec3> *texCoords, std::vector<uint32_t> *indices ) const;
+	void		calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec3> texCoords, uint32_t *indices ) const;
   
 	std::vector<Path2d>				mPaths;
 	float							mApproximationScale;
@@ -804,7 +851,7 @@ class ExtrudeSpline : public Source {
 	
   protected:
 	void updatePathSubdivision();
-	void calculate( std::vector<vec3> *positions, std::vector<vec3> *normals, std::vector<vec3> *texCoords, std::vector<uint32_t> *indices ) const;
+	void calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec3> texCoords, uint32_t *indices ) const;
 	
 	std::vector<Path2d>				mPaths;
 	std::vector<mat4>				mSplineFrames;
@@ -1155,7 +1202,7 @@ class WireTorus : public WireSource {
 //////////////////////////////////////////////////////////////////////////////////////
 // Modifiers
 //! "Bakes" a mat4 transformation into the positions, normals and tangents of a geom::Source. Promotes 2D positions to 3D.
-class Transform : public Modifier {
+class Transform : public PointwiseModifier {
   public:
 	//! Does not currently support a projection matrix (i.e. doesn't divide by 'w' )
 	Transform( const mat4 &transform )
@@ -1170,7 +1217,9 @@ class Transform : public Modifier {
 	// Inherited from Modifier
 	Modifier*			clone() const override { return new Transform( mTransform ); }
 	uint8_t				getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
-	void				process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+	bool				isInPlace( const SourceModsContext &ctx ) const override;
+	bool				prepare( SourceModsContext *ctx ) const override;
+	void				processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const override;
 
   protected:
 	mat4		mTransform;
@@ -1203,7 +1252,7 @@ class Rotate : public Transform {
 };
 
 //! Twists a geom::Source around a given axis
-class Twist : public Modifier {
+class Twist : public PointwiseModifier {
   public:
 	Twist()
 		: mAxisStart( 0, -1, 0 ), mAxisEnd( 0, 1, 0 ), mStartAngle( (float)-M_PI ), mEndAngle( (float)M_PI )
@@ -1216,7 +1265,8 @@ class Twist : public Modifier {
 	Twist&		endAngle( float radians ) { mEndAngle = radians; return *this; }
 
 	Modifier*	clone() const override { return new Twist( *this ); }
-	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+	bool		prepare( SourceModsContext *ctx ) const override;
+	void		processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const override;
 	
   protected:
 	vec3					mAxisStart, mAxisEnd;
@@ -1237,7 +1287,7 @@ class Lines : public Modifier {
 };
 
 //! Modifies the color of a geom::Source as a function of a 2D or 3D input attribute
-class ColorFromAttrib : public Modifier {
+class ColorFromAttrib : public PointwiseModifier {
   public:
 	ColorFromAttrib( Attrib attrib, const std::function<Colorf(vec2)> &fn )
 		: mAttrib( attrib ), mFnColor2( fn )
@@ -1253,7 +1303,10 @@ class ColorFromAttrib : public Modifier {
 	uint8_t		getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 	
-	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+	Attrib		getUpstreamAttrib() const override { return mAttrib; }
+	bool		isInPlace( const SourceModsContext &ctx ) const override;
+	bool		prepare( SourceModsContext *ctx ) const override;
+	void		processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const override;
 	
   protected:
 	ColorFromAttrib( Attrib attrib, const std::function<Colorf(vec2)> &fn2, const std::function<Colorf(vec3)> &fn3 )
@@ -1266,7 +1319,7 @@ class ColorFromAttrib : public Modifier {
 };
 
 //! Sets an attribute of a geom::Source to be a constant value for every vertex. Determines dimension from constructor (vec4 -> 4, for example)
-class Constant : public Modifier {
+class Constant : public PointwiseModifier {
   public:
 	Constant( geom::Attrib attrib, float v )
 		: mAttrib( attrib ), mValue( v, 0, 0, 0 ), mDims( 1 ) {}
@@ -1281,7 +1334,9 @@ class Constant : public Modifier {
 	uint8_t		getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 	
-	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+	bool		isInPlace( const SourceModsContext &ctx ) const override;
+	bool		prepare( SourceModsContext *ctx ) const override;
+	void		processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const override;
 
   protected:
 	geom::Attrib	mAttrib;
@@ -1291,7 +1346,7 @@ class Constant : public Modifier {
 
 //! Maps an attribute as a function of another attribute. Valid types are: float, vec2, vec3, vec4
 template<typename S, typename D>
-class AttribFn : public Modifier {
+class AttribFn : public PointwiseModifier {
   public:
 	typedef typename std::function<D(S)> FN;
 	static const int SRCDIM = sizeof(S)/ sizeof(float);
@@ -1309,7 +1364,10 @@ class AttribFn : public Modifier {
 	uint8_t		getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 	
-	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+	Attrib		getUpstreamAttrib() const override { return mSrcAttrib; }
+	bool		isInPlace( const SourceModsContext &ctx ) const override;
+	bool		prepare( SourceModsContext *ctx ) const override;
+	void		processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const override;
 	
   protected:
 	geom::Attrib		mSrcAttrib, mDstAttrib;
@@ -1350,14 +1408,15 @@ class Tangents : public Modifier {
 };
 
 //! Inverts the value of an attribute. Works for any dimension.
-class Invert : public Modifier {
+class Invert : public PointwiseModifier {
   public:
 	Invert( Attrib attrib )
 		: mAttrib( attrib )
 	{}
 
 	Modifier*	clone() const override { return new Invert( mAttrib ); }
-	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+	bool		prepare( SourceModsContext *ctx ) const override;
+	void		processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const override;
 
   protected:
 	Attrib		mAttrib;
@@ -1396,6 +1455,35 @@ class Bounds : public Modifier {
 	Attrib				mAttrib;
 };
 
+/*! Reorders indexed TRIANGLES for rendering without changing the geometry: the triangles for the post-transform vertex cache and optionally to reduce
+	overdraw, and the vertices in the order the triangles first use them. Keeps the number of vertices and indices. */
+class Optimize : public Modifier {
+  public:
+	Optimize()
+		: mVertexCache( true ), mOverdraw( false ), mVertexFetch( true ), mCacheSize( 16 ), mOverdrawThreshold( 1.05f ), mAcmrBefore( nullptr ), mAcmrAfter( nullptr )
+	{}
+
+	//! Enables reordering the triangles for the post-transform vertex cache. Default is \c true.
+	Optimize&	vertexCache( bool enable = true ) { mVertexCache = enable; return *this; }
+	//! Enables reordering clusters of triangles to reduce overdraw, allowing the ACMR to grow by about a factor of \a threshold. Requires 3D POSITION. Default is \c false.
+	Optimize&	overdraw( bool enable = true, float threshold = 1.05f ) { mOverdraw = enable; mOverdrawThreshold = threshold; return *this; }
+	//! Enables reordering the vertices for locality of vertex fetches. Default is \c true.
+	Optimize&	vertexFetch( bool enable = true ) { mVertexFetch = enable; return *this; }
+	//! Sets the number of vertices of the simulated post-transform cache. Default is \c 16.
+	Optimize&	cacheSize( size_t size ) { mCacheSize = size; return *this; }
+	//! Reports the average cache miss ratio of the triangles before and after optimization in \a before and \a after, either of which may be \c nullptr.
+	Optimize&	acmr( float *before, float *after ) { mAcmrBefore = before; mAcmrAfter = after; return *this; }
+
+	Modifier*	clone() const override { return new Optimize( *this ); }
+	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+
+  protected:
+	bool		mVertexCache, mOverdraw, mVertexFetch;
+	size_t		mCacheSize;
+	float		mOverdrawThreshold;
+	float		*mAcmrBefore, *mAcmrAfter;
+};
+
 //! Calculates a single level of subdivision of triangles by inserting a single vertex in the center of each triangle.
 //! Interpolates all attributes and normalizes 3D NORMAL, TANGENT and BITANGENT attributes.
 class Subdivide : public Modifier {
@@ -1420,6 +1508,26 @@ class SourceModsContext : public Target {
 	//! Can be used to capture a Source. Calling loadInto() in this case is an error.
 	SourceModsContext();
 
+	//! Returns the context to its initial state for \a sourceMods (which may be \c nullptr), retaining all of its allocations so that loading a similarly sized Source again doesn't reallocate.
+	void			reset( const SourceMods *sourceMods );
+
+	//! A SourceModsContext owned by a SourceMods and reused across calls to SourceMods::loadInto(). Holds onto the memory of the largest geometry loaded through it. Copies start out empty.
+	class Cache {
+	  public:
+		Cache() : mInUse( false ) {}
+		Cache( const Cache & ) : mInUse( false ) {}
+		Cache&	operator=( const Cache & ) { return *this; }
+
+		//! Returns the cached context reset for \a sourceMods, or \c nullptr if it is already in use, either by another thread or further up the call stack.
+		SourceModsContext*	acquire( const SourceMods *sourceMods );
+		//! Makes the context returned by acquire() available again.
+		void				release() { mInUse = false; }
+
+	  private:
+		std::unique_ptr<SourceModsContext>	mContext;
+		std::atomic<bool>					mInUse;
+	};
+
 	// called by SourceMods::loadInto()
 	void			loadInto( Target *target, const AttribSet &requestedAttribs );
 	
@@ -1427,6 +1535,7 @@ class SourceModsContext : public Target {
 	uint8_t			getAttribDims( Attrib attr ) const override;
 	void			copyAttrib( Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) override;
 	void			copyIndices( Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) override;
+	float*			getAttribStorage( Attrib attr, uint8_t dims, size_t count, size_t *resultStrideBytes ) override;
 	
 	//! Appends vertex data to existing data for \a attr. \a dims must match existing data.
 	void			appendAttrib( Attrib attr, uint8_t dims, const float *srcData, size_t count );
@@ -1441,31 +1550,60 @@ class SourceModsContext : public Target {
 	AttribSet		getAvailableAttribs() const;
 	
 	void			processUpstream( const AttribSet &requestedAttribs );
+	//! Processes the upstream with \a additionalAttribs requested on top of \a requestedAttribs. Prefer this to copying \a requestedAttribs, as the combined AttribSet is reused between calls.
+	void			processUpstream( const AttribSet &requestedAttribs, std::initializer_list<Attrib> additionalAttribs );
 
 	float*			getAttribData( Attrib attr );
 	const float*	getAttribData( Attrib attr ) const { return const_cast<SourceModsContext*>( this )->getAttribData( attr ); }
 	uint32_t*		getIndicesData();
 	const uint32_t*	getIndicesData() const { return const_cast<SourceModsContext*>( this )->getIndicesData(); }
+
+	//! Converts the existing data for \a attr to \a dims dimensions in place, following the rules of copyData().
+	void			convertAttribDims( Attrib attr, uint8_t dims );
+	//! Returns temporary storage for at least \a count floats, which remains valid until the next call. Not to be used across a call to processUpstream().
+	float*			getScratchData( size_t count );
+	//! Returns temporary storage for at least \a count indices, which remains valid until the next call. Not to be used across a call to processUpstream().
+	uint32_t*		getScratchIndices( size_t count );
 	
 	void			preload( const AttribSet &requestedAttribs );
 	void			combine( const SourceModsContext &rhs );
 	void			complete( Target *target, const AttribSet &requestedAttribs );
 	
   private:
+	void			processUpstream( const AttribSet &requestedAttribs, const Attrib *additionalAttribs, size_t numAdditionalAttribs );
+	void			processModifier( const Modifier *modifier, const AttribSet &requestedAttribs );
+	void			processPointwiseRun( size_t begin, size_t end );
+
+	// Storage for a single attribute. 'mData' never shrinks, so it can hold more than mDims * mCount floats
+	struct AttribBuffer {
+		AttribBuffer() : mDims( 0 ), mCount( 0 ) {}
+
+		uint8_t				mDims;
+		size_t				mCount;
+		std::vector<float>	mData;
+	};
+
 	const Source					*mSource;
 	std::vector<Modifier*>			mModiferStack;
 	
 	const AttribSet					*mAttribMask;
 	
 	size_t										mNumVertices;
-	std::map<Attrib,AttribInfo>					mAttribInfo;
-	std::map<Attrib,std::unique_ptr<float[]>>	mAttribData;
-	std::map<Attrib,size_t>						mAttribCount;
+	std::array<AttribBuffer,NUM_ATTRIBS>		mAttribs;
 	
-	std::unique_ptr<uint32_t[]>				mIndices;
+	std::vector<uint32_t>					mIndices; // never shrinks; see mNumIndices
 	size_t									mNumIndices;
 	uint8_t									mIndicesRequiredBytes;
 	geom::Primitive							mPrimitive;
+
+	std::vector<float>						mScratchData;
+	std::vector<uint32_t>					mScratchIndices;
+	// AttribSets built by processUpstream(), reused as a stack across nested calls
+	std::vector<std::unique_ptr<AttribSet>>	mRequests;
+	size_t									mNumRequests;
+	// runs of PointwiseModifiers and their upstream attributes being processed, used as stacks
+	std::vector<const PointwiseModifier*>	mPointwiseRun;
+	std::vector<Attrib>						mPointwiseAttribs;
 };
 
 //! Represents a geom::Source with 0 or more geom::Modifiers concatenated.
@@ -1545,6 +1683,8 @@ class SourceMods : public Source {
 	mutable std::vector<Modifier::Params>	mParamsStack;
 	
 	std::vector<std::unique_ptr<SourceMods>>	mChildren;
+
+	mutable SourceModsContext::Cache		mContextCache;
 	
 	friend class SourceModsContext;
 };
@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Vector.h"
+#include "cinder/Utilities.h"
 
 #include <vector>
 #include <float.h>
@@ -33,60 +34,145 @@
 
 namespace cinder {
 
-// KdTree Declarations
-template<unsigned char K>
-struct KdNode {
-	void init( float p, uint32_t a) {
-		splitPos = p;
-		splitAxis = a;
-		rightChild = ~0;
-		hasLeftChild = 0;
-	}
-	void initLeaf() {
-		splitAxis = K;
-		rightChild = ~0;
-		hasLeftChild = 0;
-	}
-	// KdNode Data
-	float splitPos;
-	uint32_t splitAxis:2;
-	uint32_t hasLeftChild:1;
-	uint32_t rightChild:29;
-};
-
 struct NullLookupProc {
  public:
-	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) {}
+	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) const {}
 };
 
+/*! A k-d tree over points of type NodeData, for nearest neighbor and radius queries. NodeDataTraits supplies the coordinates of a NodeData, which
+	are copied into the tree, so the points don't need to outlive it. Points are identified by their index in the container the tree was built from.
+	The tree is balanced and implicit: the points are stored in a single array in which the median of every range splits it, so there are no
+	nodes or child links. Building large trees splits ranges in parallel, and queries are thread safe. */
 template <typename NodeData, unsigned char K=3, class LookupProc = NullLookupProc> class KdTree {
 public:
-	typedef std::pair<const NodeData*, uint32_t> NodeDataIndex;
-	
-	// KdTree Public Methods
+	//! The index written for the missing results of a batch findNearest()
+	static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	KdTree() {}
 	template<typename NodeDataVector>
 	KdTree( const NodeDataVector &data );
-	KdTree() {}
+
+	//! Builds the tree over \a d, replacing any points it held. Reuses the tree's storage, so rebuilding every frame for moving points doesn't allocate once their number settles.
 	template<typename NodeDataVector>
 	void initialize( const NodeDataVector &d );
-	~KdTree() {
-		free( nodes );
-		delete[] mNodeData;
-	}
-	void recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes );
-	void lookup( const NodeData &p, const LookupProc &process, float maxDist ) const;
-	void findNearest( float p[K], float result[K], uint32_t *resultIndex ) const;
-	
+	/*! Adds \a point to the tree and returns its index, which follows those of the points already in it. Added points are searched linearly until
+		the next rebuild(), which happens automatically once they make up a sizable fraction of the tree. */
+	uint32_t	insert( const NodeData &point );
+	//! Rebuilds the tree to include the points added by insert().
+	void		rebuild();
+	//! Removes all of the points.
+	void		clear();
+	//! Returns the number of points in the tree, including those added by insert().
+	size_t		size() const { return mEntries.size() + mPending.size(); }
+	bool		empty() const { return size() == 0; }
+
+	//! Calls \a process.process( index, distanceSquared, maxDistanceSquared ) for each point closer than \a maxDist to \a p, in no particular order. \a process may lower maxDistanceSquared to narrow the search.
+	void	lookup( const NodeData &p, const LookupProc &process, float maxDist ) const;
+	//! Finds the point nearest to \a p, writing its coordinates to \a result and its index to \a resultIndex, which is INVALID_INDEX if the tree is empty.
+	void	findNearest( float p[K], float result[K], uint32_t *resultIndex ) const;
+	/*! Finds the \a k points nearest to \a p and closer than \a maxDist, writing their indices to \a resultIndices and their squared distances to
+		\a resultDistancesSquared, nearest first. Both must have room for \a k values. Returns the number of points found, which is less than \a k
+		when fewer points are in range. */
+	size_t	findNearest( const NodeData &p, size_t k, uint32_t *resultIndices, float *resultDistancesSquared, float maxDist = FLT_MAX ) const;
+	/*! Finds the \a k nearest points for each of the \a numPoints \a points, spread across threads. The results for point \c i are written from
+		<tt>i * k</tt> in \a resultIndices and \a resultDistancesSquared, nearest first, and any missing ones are INVALID_INDEX at FLT_MAX. */
+	void	findNearest( const NodeData *points, size_t numPoints, size_t k, uint32_t *resultIndices, float *resultDistancesSquared, float maxDist = FLT_MAX ) const;
+	//! Appends the indices of the points closer than \a radius to \a p to \a result, in no particular order. Returns the number of points appended.
+	size_t	findWithinRadius( const NodeData &p, float radius, std::vector<uint32_t> *result ) const;
+	/*! Finds the points closer than \a radius to each of the \a numPoints \a points, spread across threads. The indices found for point \c i are
+		<tt>[(*resultOffsets)[i], (*resultOffsets)[i + 1])</tt> in \a resultIndices. */
+	void	findWithinRadius( const NodeData *points, size_t numPoints, float radius, std::vector<uint32_t> *resultIndices, std::vector<uint32_t> *resultOffsets ) const;
+
 private:
-	// KdTree Private Methods
-	void privateLookup(uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared) const;
-	void privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const;
-	// KdTree Private Data
-	KdNode<K> *nodes;
-	NodeDataIndex *mNodeData;
-	uint32_t nNodes, nextFreeNode;
+	enum {
+		// ranges of at most this many points are searched linearly
+		BUCKET_SIZE = 8,
+		// the top levels are split in parallel one level at a time, until there are this many ranges to build independently
+		PARALLEL_RANGES = 64,
+		// the number of points of a batch query handled by each task
+		POINTS_PER_TASK = 256,
+		// trees with fewer points are built serially, as handing the work to other threads would cost more than it saves
+		MIN_PARALLEL_BUILD_POINTS = 32768,
+		// batch queries with fewer points run serially
+		MIN_PARALLEL_QUERY_POINTS = 2048,
+		// the fewest points added by insert() that trigger a rebuild
+		MIN_PENDING_REBUILD = 64
+	};
+
+	struct Entry {
+		float		mCoords[K];
+		uint32_t	mIndex;
+	};
+
+	// A range of mEntries and the bounds of the cell it occupies
+	struct Range {
+		uint32_t	mBegin, mEnd;
+		float		mMin[K], mMax[K];
+	};
+
+	struct LookupVisitor {
+		void visit( const Entry &entry, float distanceSquared ) { mProcess->process( entry.mIndex, distanceSquared, mMaxDistanceSquared ); }
+
+		const LookupProc	*mProcess;
+		float				mMaxDistanceSquared;
+	};
+
+	struct NearestVisitor {
+		void visit( const Entry &entry, float distanceSquared ) { mNearest = &entry; mMaxDistanceSquared = distanceSquared; }
+
+		const Entry		*mNearest;
+		float			mMaxDistanceSquared;
+	};
+
+	// Keeps the k nearest points in sorted order, by insertion
+	struct NearestKVisitor {
+		void visit( const Entry &entry, float distanceSquared )
+		{
+			size_t i = ( mCount < mK ) ? mCount++ : mK - 1;
+			for( ; i > 0 && mDistancesSquared[i - 1] > distanceSquared; --i ) {
+				mIndices[i] = mIndices[i - 1];
+				mDistancesSquared[i] = mDistancesSquared[i - 1];
+			}
+			mIndices[i] = entry.mIndex;
+			mDistancesSquared[i] = distanceSquared;
+			if( mCount == mK )
+				mMaxDistanceSquared = mDistancesSquared[mK - 1];
+		}
+
+		uint32_t	*mIndices;
+		float		*mDistancesSquared;
+		size_t		mK, mCount;
+		float		mMaxDistanceSquared;
+	};
+
+	struct RadiusVisitor {
+		void visit( const Entry &entry, float /*distanceSquared*/ ) { mResult->push_back( entry.mIndex ); }
+
+		std::vector<uint32_t>	*mResult;
+		float					mMaxDistanceSquared;
+	};
+
+	static Entry	makeEntry( const NodeData &data, uint32_t index );
+	static float	calcDistanceSquared( const float a[K], const float b[K] );
+
+	void	build();
+	bool	splitRange( const Range &range, Range *left, Range *right );
+	void	buildRange( const Range &range );
+	template<typename Visitor>
+	void	visit( const float p[K], Visitor *visitor ) const;
+	template<typename Visitor>
+	void	visitRange( uint32_t begin, uint32_t end, const float p[K], Visitor *visitor ) const;
+
+	std::vector<Entry>		mEntries;
+	// the axis each median splits its range along
+	std::vector<uint8_t>	mAxes;
+	// points added by insert() since the last build
+	std::vector<Entry>		mPending;
 };
 
+template<typename NodeData, unsigned char K, typename LookupProc>
+const uint32_t KdTree<NodeData, K, LookupProc>::INVALID_INDEX;
+
 
 // Shims
 template<typename NDV>
@@ -132,16 +218,6 @@ struct NodeDataTraits<vec2>
 	}
 };
 
-template<typename NodeData> struct CompareNode {
-	CompareNode( int a ) { axis = a; }
-	int axis;
-	bool operator()(const std::pair<const NodeData*,uint32_t> &d1,
-			const std::pair<const NodeData*,uint32_t> &d2) const {
-		return NodeDataTraits<NodeData>::getAxis( *d1.first, axis ) == NodeDataTraits<NodeData>::getAxis( *d2.first, axis ) ? ( d1.first < d2.first ) :
-			NodeDataTraits<NodeData>::getAxis( *d1.first, axis ) < NodeDataTraits<NodeData>::getAxis( *d2.first, axis );
-	}
-};
-
 // KdTree Method Definitions
 template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
@@ -154,151 +230,264 @@ template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
 void KdTree<NodeData, K, LookupProc>::initialize( const NodeDataVector &d )
 {
-	nNodes = NodeDataVectorTraits<NodeDataVector>::getSize( d );
-	nextFreeNode = 1;
-	nodes = (KdNode<K> *)malloc(nNodes * sizeof(KdNode<K>));
-	mNodeData = new NodeDataIndex[nNodes];
-	std::vector<NodeDataIndex> buildNodes;
-	buildNodes.reserve( nNodes );
-	for( uint32_t i = 0; i < nNodes; ++i )
-		buildNodes.push_back( std::make_pair( &d[i], i ) );
-	// Begin the KdTree building process
-	recursiveBuild( 0, 0, nNodes, buildNodes );
+	const uint32_t numPoints = NodeDataVectorTraits<NodeDataVector>::getSize( d );
+	mPending.clear();
+	mEntries.resize( numPoints );
+	for( uint32_t i = 0; i < numPoints; ++i )
+		mEntries[i] = makeEntry( d[i], i );
+
+	build();
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+uint32_t KdTree<NodeData, K, LookupProc>::insert( const NodeData &point )
+{
+	const uint32_t index = uint32_t( size() );
+	mPending.push_back( makeEntry( point, index ) );
+	if( mPending.size() > std::max<size_t>( MIN_PENDING_REBUILD, mEntries.size() / 8 ) )
+		rebuild();
+
+	return index;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::rebuild()
+{
+	mEntries.insert( mEntries.end(), mPending.begin(), mPending.end() );
+	mPending.clear();
+	build();
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::clear()
+{
+	mEntries.clear();
+	mAxes.clear();
+	mPending.clear();
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+typename KdTree<NodeData, K, LookupProc>::Entry KdTree<NodeData, K, LookupProc>::makeEntry( const NodeData &data, uint32_t index )
+{
+	Entry result;
+	for( unsigned char k = 0; k < K; ++k )
+		result.mCoords[k] = NodeDataTraits<NodeData>::getAxis( data, k );
+	result.mIndex = index;
+	return result;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+float KdTree<NodeData, K, LookupProc>::calcDistanceSquared( const float a[K], const float b[K] )
+{
+	float result = 0;
+	for( unsigned char k = 0; k < K; ++k )
+		result += ( a[k] - b[k] ) * ( a[k] - b[k] );
+	return result;
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes )
+void KdTree<NodeData, K, LookupProc>::build()
 {
-	// Create leaf node of kd-tree if we've reached the bottom
-	if( start + 1 == end) {
-		nodes[nodeNum].initLeaf();
-		mNodeData[nodeNum] = buildNodes[start];
+	mAxes.resize( mEntries.size() );
+	if( mEntries.empty() )
 		return;
-	}
-	// Choose split direction and partition data
-	// Compute bounds of data from _start_ to _end_
-	float boundMin[K], boundMax[K];
+
+	Range root;
+	root.mBegin = 0;
+	root.mEnd = uint32_t( mEntries.size() );
 	for( unsigned char k = 0; k < K; ++k ) {
-		boundMin[k] = FLT_MAX;
-		boundMax[k] = FLT_MIN;
+		root.mMin[k] = FLT_MAX;
+		root.mMax[k] = -FLT_MAX;
 	}
-	
-	for( uint32_t i = start; i < end; ++i ) {
-		for( uint8_t axis = 0; axis < K; axis++ ) {
-			// NOT Compiling? you should define NOMINMAX
-			boundMin[axis] = std::min( boundMin[axis], NodeDataTraits<NodeData>::getAxis( *buildNodes[i].first, axis ) );
-			boundMax[axis] = std::max( boundMax[axis], NodeDataTraits<NodeData>::getAxis( *buildNodes[i].first, axis ) );
+	for( const Entry &entry : mEntries ) {
+		for( unsigned char k = 0; k < K; ++k ) {
+			root.mMin[k] = std::min( root.mMin[k], entry.mCoords[k] );
+			root.mMax[k] = std::max( root.mMax[k], entry.mCoords[k] );
 		}
 	}
-	int splitAxis = 0;
-	float maxExtent = boundMax[0] - boundMin[0];
-	for( unsigned char k = 1; k < K; ++k ) {
-		if( boundMax[k] - boundMin[k] > maxExtent ) {
-			splitAxis = k;
-			maxExtent = boundMax[k] - boundMin[k];
-		}	
-	}
-	uint32_t splitPos = ( start + end ) / 2;
-	std::nth_element( &buildNodes[start], &buildNodes[splitPos], &buildNodes[end-1] + 1, CompareNode<NodeData>(splitAxis) );
-	// Allocate kd-tree node and continue recursively
-	nodes[nodeNum].init( NodeDataTraits<NodeData>::getAxis( *buildNodes[splitPos].first, splitAxis ), splitAxis );
-	mNodeData[nodeNum] = buildNodes[splitPos];
-	if( start < splitPos ) {
-		nodes[nodeNum].hasLeftChild = 1;
-		uint32_t childNum = nextFreeNode++;
-		recursiveBuild( childNum, start, splitPos, buildNodes );
+
+	// split the top levels with the ranges of each level in parallel, then build the subtrees below them in parallel
+	const size_t numThreads = mEntries.size() >= MIN_PARALLEL_BUILD_POINTS ? 0 : 1;
+	std::vector<Range> ranges( 1, root ), next;
+	while( ! ranges.empty() && ranges.size() < PARALLEL_RANGES ) {
+		next.resize( ranges.size() * 2 );
+		std::vector<uint8_t> split( ranges.size() );
+		parallelFor( ranges.size(), [&]( size_t r ) {
+			split[r] = splitRange( ranges[r], &next[r * 2], &next[r * 2 + 1] );
+		}, numThreads );
+
+		ranges.clear();
+		for( size_t r = 0; r < split.size(); ++r ) {
+			if( split[r] ) {
+				ranges.push_back( next[r * 2] );
+				ranges.push_back( next[r * 2 + 1] );
+			}
+		}
 	}
-	if( splitPos + 1 < end ) {
-		nodes[nodeNum].rightChild = nextFreeNode++;
-		recursiveBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes );
+
+	parallelFor( ranges.size(), [&]( size_t r ) {
+		buildRange( ranges[r] );
+	}, numThreads );
+}
+
+// Splits the cell of range at the median along its longest axis, returning false for ranges small enough to be searched linearly
+template<typename NodeData, unsigned char K, typename LookupProc>
+bool KdTree<NodeData, K, LookupProc>::splitRange( const Range &range, Range *left, Range *right )
+{
+	if( range.mEnd - range.mBegin <= BUCKET_SIZE )
+		return false;
+
+	unsigned char axis = 0;
+	for( unsigned char k = 1; k < K; ++k ) {
+		if( range.mMax[k] - range.mMin[k] > range.mMax[axis] - range.mMin[axis] )
+			axis = k;
 	}
+
+	const uint32_t mid = range.mBegin + ( range.mEnd - range.mBegin ) / 2;
+	std::nth_element( mEntries.begin() + range.mBegin, mEntries.begin() + mid, mEntries.begin() + range.mEnd, [axis]( const Entry &a, const Entry &b ) {
+		return a.mCoords[axis] < b.mCoords[axis];
+	} );
+	mAxes[mid] = axis;
+
+	*left = *right = range;
+	left->mEnd = mid;
+	left->mMax[axis] = mEntries[mid].mCoords[axis];
+	right->mBegin = mid + 1;
+	right->mMin[axis] = mEntries[mid].mCoords[axis];
+	return true;
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::lookup( const NodeData &p, const LookupProc &proc, float maxDist ) const 
+void KdTree<NodeData, K, LookupProc>::buildRange( const Range &range )
 {
-	float maxDistSqrd = maxDist * maxDist;
-	float pt[K];
-	for( unsigned char k = 0; k < K; ++k )
-		pt[k] = NodeDataTraits<NodeData>::getAxis( p, k );
+	Range left, right;
+	if( splitRange( range, &left, &right ) ) {
+		buildRange( left );
+		buildRange( right );
+	}
+}
 
-	privateLookup( 0, pt, proc, maxDistSqrd );
+template<typename NodeData, unsigned char K, typename LookupProc>
+ template<typename Visitor>
+void KdTree<NodeData, K, LookupProc>::visit( const float p[K], Visitor *visitor ) const
+{
+	visitRange( 0, uint32_t( mEntries.size() ), p, visitor );
+	for( const Entry &entry : mPending ) {
+		const float distanceSquared = calcDistanceSquared( entry.mCoords, p );
+		if( distanceSquared < visitor->mMaxDistanceSquared )
+			visitor->visit( entry, distanceSquared );
+	}
 }
 
+// Visits the points of [begin, end) closer to p than visitor->mMaxDistanceSquared, descending into the side of each median nearer to p first
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::privateLookup( uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared ) const 
+ template<typename Visitor>
+void KdTree<NodeData, K, LookupProc>::visitRange( uint32_t begin, uint32_t end, const float p[K], Visitor *visitor ) const
 {
-	KdNode<K> *node = &nodes[nodeNum];
-	// process kd-tree node's children
-	int axis = node->splitAxis;
-	if( axis != K ) {
-		float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
-		if( p[axis] <= node->splitPos ) {
-			if(node->hasLeftChild)
-				privateLookup( nodeNum + 1, p, process, maxDistSquared );
-			if( ( dist2 < maxDistSquared ) && ( node->rightChild < nNodes ) )
-				privateLookup( node->rightChild, p, process, maxDistSquared );
-		}
-		else {
-			if( node->rightChild < nNodes )
-				privateLookup( node->rightChild, p, process, maxDistSquared );
-			if( ( dist2 < maxDistSquared ) && node->hasLeftChild )
-				privateLookup( nodeNum + 1, p, process, maxDistSquared );
-		}
+	while( end - begin > BUCKET_SIZE ) {
+		const uint32_t mid = begin + ( end - begin ) / 2;
+		const Entry &median = mEntries[mid];
+		const float offset = p[mAxes[mid]] - median.mCoords[mAxes[mid]];
+		visitRange( offset <= 0 ? begin : mid + 1, offset <= 0 ? mid : end, p, visitor );
+
+		// the median and the far side are at least offset away
+		if( offset * offset >= visitor->mMaxDistanceSquared )
+			return;
+
+		const float distanceSquared = calcDistanceSquared( median.mCoords, p );
+		if( distanceSquared < visitor->mMaxDistanceSquared )
+			visitor->visit( median, distanceSquared );
+		if( offset <= 0 )
+			begin = mid + 1;
+		else
+			end = mid;
 	}
-	// Hand kd-tree node to processing function
-	float distSqr = 0.0f;
-	for( unsigned char k = 0; k < K; ++k ) {
-		float v = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, k ) - p[k];
-		distSqr += v * v;
+
+	for( uint32_t i = begin; i < end; ++i ) {
+		const float distanceSquared = calcDistanceSquared( mEntries[i].mCoords, p );
+		if( distanceSquared < visitor->mMaxDistanceSquared )
+			visitor->visit( mEntries[i], distanceSquared );
 	}
-	
-	if( distSqr < maxDistSquared )
-		process.process( mNodeData[nodeNum].second, distSqr, maxDistSquared );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::lookup( const NodeData &p, const LookupProc &proc, float maxDist ) const 
+{
+	const Entry point = makeEntry( p, 0 );
+	LookupVisitor visitor = { &proc, maxDist * maxDist };
+	visit( point.mCoords, &visitor );
 }
 
 // Find Nearest
 template<typename NodeData, unsigned char K, typename LookupProc>
 void KdTree<NodeData, K, LookupProc>::findNearest( float p[K], float result[K], uint32_t *resultIndex ) const
 {
-	float maxDist = FLT_MAX;
-	*resultIndex = -1;
-	privateFindNearest( 0, p, maxDist, result, resultIndex );
+	NearestVisitor visitor = { nullptr, FLT_MAX };
+	visit( p, &visitor );
+	*resultIndex = INVALID_INDEX;
+	if( visitor.mNearest ) {
+		std::copy( visitor.mNearest->mCoords, visitor.mNearest->mCoords + K, result );
+		*resultIndex = visitor.mNearest->mIndex;
+	}
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const
+size_t KdTree<NodeData, K, LookupProc>::findNearest( const NodeData &p, size_t k, uint32_t *resultIndices, float *resultDistancesSquared, float maxDist ) const
 {
-	KdNode<K> *node = &nodes[nodeNum];
-	// process kd-tree node's children
-	int axis = node->splitAxis;
-	if( axis != K ) {
-		float dist2 = (p[axis] - node->splitPos) * (p[axis] - node->splitPos);
-		if( p[axis] <= node->splitPos ) {
-			if( node->hasLeftChild )
-				privateFindNearest( nodeNum+1, p, maxDistSquared, result, resultIndex );
-			if( ( dist2 < maxDistSquared ) && ( node->rightChild < nNodes) )
-				privateFindNearest( node->rightChild, p, maxDistSquared, result, resultIndex );
-		}
-		else {
-			if( node->rightChild < nNodes)
-				privateFindNearest(node->rightChild,
-				              p,
-							  maxDistSquared, result, resultIndex );
-			if( dist2 < maxDistSquared && node->hasLeftChild)
-				privateFindNearest(nodeNum+1,
-				              p,
-							  maxDistSquared, result, resultIndex );
+	if( ! k )
+		return 0;
+
+	const Entry point = makeEntry( p, 0 );
+	NearestKVisitor visitor = { resultIndices, resultDistancesSquared, k, 0, maxDist * maxDist };
+	visit( point.mCoords, &visitor );
+	return visitor.mCount;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findNearest( const NodeData *points, size_t numPoints, size_t k, uint32_t *resultIndices, float *resultDistancesSquared, float maxDist ) const
+{
+	parallelFor( ( numPoints + POINTS_PER_TASK - 1 ) / POINTS_PER_TASK, [&]( size_t task ) {
+		const size_t end = std::min<size_t>( ( task + 1 ) * POINTS_PER_TASK, numPoints );
+		for( size_t i = task * POINTS_PER_TASK; i < end; ++i ) {
+			const size_t count = findNearest( points[i], k, resultIndices + i * k, resultDistancesSquared + i * k, maxDist );
+			std::fill( resultIndices + i * k + count, resultIndices + ( i + 1 ) * k, INVALID_INDEX );
+			std::fill( resultDistancesSquared + i * k + count, resultDistancesSquared + ( i + 1 ) * k, FLT_MAX );
 		}
-	}
-	
-	float distSqr = NodeDataTraits<NodeData>::distanceSquared( *mNodeData[nodeNum].first, p );
-	if( distSqr < maxDistSquared ) {
-		maxDistSquared = distSqr;
-		for( unsigned char k = 0; k < K; ++k )
-			result[k] = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, k );
-		*resultIndex = mNodeData[nodeNum].second;
-	}
+	}, numPoints >= MIN_PARALLEL_QUERY_POINTS ? 0 : 1 );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+size_t KdTree<NodeData, K, LookupProc>::findWithinRadius( const NodeData &p, float radius, std::vector<uint32_t> *result ) const
+{
+	const Entry point = makeEntry( p, 0 );
+	const size_t initialSize = result->size();
+	RadiusVisitor visitor = { result, radius * radius };
+	visit( point.mCoords, &visitor );
+	return result->size() - initialSize;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findWithinRadius( const NodeData *points, size_t numPoints, float radius, std::vector<uint32_t> *resultIndices, std::vector<uint32_t> *resultOffsets ) const
+{
+	// each task gathers its points' results, which are then concatenated
+	const size_t numTasks = ( numPoints + POINTS_PER_TASK - 1 ) / POINTS_PER_TASK;
+	const size_t numThreads = numPoints >= MIN_PARALLEL_QUERY_POINTS ? 0 : 1;
+	std::vector<std::vector<uint32_t>> taskResults( numTasks );
+	resultOffsets->resize( numPoints + 1 );
+	parallelFor( numTasks, [&]( size_t task ) {
+		const size_t end = std::min<size_t>( ( task + 1 ) * POINTS_PER_TASK, numPoints );
+		for( size_t i = task * POINTS_PER_TASK; i < end; ++i )
+			(*resultOffsets)[i + 1] = uint32_t( findWithinRadius( points[i], radius, &taskResults[task] ) );
+	}, numThreads );
+
+	(*resultOffsets)[0] = 0;
+	for( size_t i = 0; i < numPoints; ++i )
+		(*resultOffsets)[i + 1] += (*resultOffsets)[i];
+
+	resultIndices->resize( resultOffsets->back() );
+	parallelFor( numTasks, [&]( size_t task ) {
+		std::copy( taskResults[task].begin(), taskResults[task].end(), resultIndices->begin() + (*resultOffsets)[task * POINTS_PER_TASK] );
+	}, numThreads );
 }
 
 } // namespace ci
@@ -0,0 +1,74 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+
+namespace cinder {
+
+typedef std::shared_ptr<class MappedFile>	MappedFileRef;
+
+//! \brief A file that is memory mapped for reading.
+//!
+//! The contents are backed by the operating system's page cache, so they only become resident as they are touched and are shared with every
+//! other mapping of the same file. The mapping stays valid for the lifetime of the MappedFile, even if the file is removed in the meantime.
+class MappedFile {
+  public:
+	//! Maps the file at \a path. Throws MappedFileExc if it can't be opened or mapped.
+	static MappedFileRef	create( const fs::path &path )	{ return MappedFileRef( new MappedFile( path ) ); }
+
+	~MappedFile();
+
+	//! Returns a pointer to the first byte of the file, or \c nullptr if the file is empty.
+	const void*		getData() const			{ return mData; }
+	//! Returns the size of the file in bytes.
+	size_t			getSize() const			{ return mSize; }
+	//! Returns the path of the mapped file.
+	const fs::path&	getFilePath() const		{ return mFilePath; }
+
+	//! Reads every page of the file into memory, so that touching them later doesn't block on disk I/O. Blocks until done.
+	//! The pages can still be evicted again if the system runs low on memory.
+	void			prefault();
+
+  private:
+	MappedFile( const fs::path &path );
+
+	// non-copyable
+	MappedFile( const MappedFile & );
+	MappedFile& operator=( const MappedFile & );
+
+	fs::path	mFilePath;
+	void		*mData;
+	size_t		mSize;
+};
+
+//! Exception thrown when a MappedFile can't be created.
+class MappedFileExc : public Exception {
+  public:
+	MappedFileExc( const std::string &description ) : Exception( description )	{}
+};
+
+} // namespace cinder
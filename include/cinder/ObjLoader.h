@@ -29,7 +29,6 @@
 #include "cinder/DataTarget.h"
 #include "cinder/GeomIo.h"
 
-#include <tuple>
 #include <map>
 
 namespace cinder {
@@ -43,6 +42,9 @@ namespace cinder {
  * myCubeRef = gl::Batch::create( loader, gl::getStockShader( gl::ShaderDef().color() ) );
  * myCubeRef->draw();
  * \endcode
+ *
+ * The file is parsed in parallel chunks (memory mapped when it is loaded from a file path), and vertices are deduplicated through a hash table.
+ * To skip parsing entirely on later runs, use the constructor that takes a cache path.
 **/
 
 class ObjLoader : public geom::Source {
@@ -62,6 +64,13 @@ class ObjLoader : public geom::Source {
 	 * \param includeTexCoords if false normasls will be skipped, which can provide a faster load time
 	**/
 	ObjLoader( DataSourceRef dataSource, DataSourceRef materialSource, bool includeNormals = true, bool includeTexCoords = true,  bool optimize = true );
+	/**Constructs and does the parsing of the file at \a filePath, which is memory mapped.
+	 * If \a cachePath is not empty, the loaded geometry is written there in the TriMesh::writeMapped() format, and mapped back instead of parsing the file
+	 * on later runs as long as the size and modification time of \a filePath and the \a includeNormals, \a includeTexCoords and \a optimize flags
+	 * recorded in it still match. Otherwise the file is parsed and the cache rewritten. The cache records the names of the groups, and selecting
+	 * a group with groupIndex() or groupName() parses the file, since the cached geometry holds them all.
+	**/
+	ObjLoader( const fs::path &filePath, const fs::path &cachePath = fs::path(), bool includeNormals = true, bool includeTexCoords = true, bool optimize = true );
 
 	/**Loads a specific group index from the file**/
 	ObjLoader&	groupIndex( size_t groupIndex );
@@ -76,16 +85,6 @@ class ObjLoader : public geom::Source {
             Kd[0] = Kd[1] = Kd[2] = 1;
         }
 
-        Material( const Material& rhs ) {
-            mName = rhs.mName;
-            Ka[0] = rhs.Ka[0];
-            Ka[1] = rhs.Ka[1];
-            Ka[2] = rhs.Ka[2];
-            Kd[0] = rhs.Kd[0];
-            Kd[1] = rhs.Kd[1];
-            Kd[2] = rhs.Kd[2];
-        }
-
         std::string mName;
         float		Ka[3];
         float		Kd[3];
@@ -110,8 +109,10 @@ class ObjLoader : public geom::Source {
 	//! Returns the total number of groups.
 	size_t		getNumGroups() const { return mGroups.size(); }
 	
-	//! Returns a vector<> of the Groups in the OBJ.
-	const std::vector<Group>&		getGroups() const { return mGroups; }
+	//! Returns a vector<> of the Groups in the OBJ. Their Faces are created on the first call, and are empty while the geometry is loaded from a cache.
+	const std::vector<Group>&		getGroups() const;
+	//! Returns whether the geometry was read from the cache passed to the constructor, rather than parsed.
+	bool		isLoadedFromCache() const	{ return mLoadedFromCache; }
 
 	size_t			getNumVertices() const override { load(); return mOutputVertices.size(); }
 	size_t			getNumIndices() const override { load(); return mOutputIndices.size(); }
@@ -122,26 +123,29 @@ class ObjLoader : public geom::Source {
 	Source*			clone() const override { return new ObjLoader( *this ); }
 
   private:
-	typedef std::tuple<int,int> VertexPair;
-	typedef std::tuple<int,int,int> VertexTriple;
-
-	void	parse( bool includeNormals, bool includeTexCoords );
- 	void	parseFace( Group *group, const Material *material, const std::string &s, bool includeNormals, bool includeTexCoords );
+	void	parse( const char *data, size_t size, bool includeNormals, bool includeTexCoords );
+	void	parse( const DataSourceRef &dataSource, bool includeNormals, bool includeTexCoords );
+	void	parse( const std::shared_ptr<IStreamCinder> &stream, bool includeNormals, bool includeTexCoords );
     void    parseMaterial( std::shared_ptr<IStreamCinder> material );
 
 	void	load() const;
-
-	void	loadGroupNormalsTextures( const Group &group, std::map<VertexTriple,int> &uniqueVerts ) const;
-	void	loadGroupNormals( const Group &group, std::map<VertexPair,int> &uniqueVerts ) const;
-	void	loadGroupTextures( const Group &group, std::map<VertexPair,int> &uniqueVerts ) const;
-	void	loadGroup( const Group &group, std::map<int,int> &uniqueVerts ) const;
-
-	std::shared_ptr<IStreamCinder>	mStream;
+	bool	readCache( const fs::path &cachePath );
+	void	writeCache( const fs::path &cachePath ) const;
+	//! Parses mFilePath in place of the geometry loaded from the cache
+	void	parseCachedFile();
 
 	std::vector<vec3>			    mInternalVertices, mInternalNormals;
 	std::vector<vec2>			    mInternalTexCoords;
 	std::vector<Colorf>				mInternalColors;
 
+	// The faces of all groups, stored flat. The corners of face f are [mFaceStarts[f], mFaceStarts[f + 1]), and a corner's
+	// tex coord or normal index is -1 when it doesn't have one.
+	std::vector<uint32_t>			mFaceStarts;
+	std::vector<const Material*>	mFaceMaterials;
+	std::vector<int32_t>			mCornerVertices, mCornerTexCoords, mCornerNormals;
+	//! The range of faces [first, last) belonging to each group.
+	std::vector<std::pair<size_t, size_t>>	mGroupFaces;
+
     mutable bool					mOptimizeVertices;
 	mutable bool					mOutputCached;
 	mutable std::vector<vec3>		mOutputVertices, mOutputNormals;
@@ -150,8 +154,13 @@ class ObjLoader : public geom::Source {
 	mutable std::vector<uint32_t>	mOutputIndices;
 
 	size_t							mGroupIndex;
+	bool							mLoadedFromCache;
+	//! The file and flags passed to the constructor that takes a cache path
+	fs::path						mFilePath;
+	bool							mIncludeNormals, mIncludeTexCoords;
 
-	std::vector<Group>				mGroups;
+	mutable std::vector<Group>		mGroups;
+	mutable bool					mGroupFacesCreated;
 	std::map<std::string, Material>	mMaterials;
 
 };
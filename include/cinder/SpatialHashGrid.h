@@ -0,0 +1,446 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Utilities.h"
+
+#include <vector>
+#include <float.h>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+
+namespace cinder {
+
+/*! A uniform grid over 2D or 3D points for neighbor searches over points that move every frame. Rebuilding is a counting sort in O(n), rather
+	than the O(n log n) of a KdTree, and queries are fastest when their radius is close to the cell size. Cells are numbered row by row across
+	the bounds of the points and hashed into a table of about as many buckets as points. While the bounds span no more cells than that, each row
+	of cells is a contiguous run of points. Larger bounds wrap around the table, so sparse point sets need no fixed extent. The points are copied,
+	sorted by cell, into one array per axis, and are identified by their index in the array the grid was built from. Building is spread across
+	threads, and queries are thread safe. */
+template<uint8_t K>
+class SpatialHashGrid {
+  public:
+	typedef typename VECDIM<K, float>::TYPE	VecT;
+	typedef typename VECDIM<K, int>::TYPE	CellT;
+
+	//! Creates an empty grid with cells \a cellSize wide. The cell size is typically the radius of the queries.
+	explicit SpatialHashGrid( float cellSize = 1.0f )
+		: mMask( 0 ), mDense( true ), mMin( 0 ), mMax( 0 ), mMinCell( 0 ), mMaxCell( 0 )
+	{
+		setCellSize( cellSize );
+	}
+
+	//! Sets the width of the cells, which takes effect at the next build().
+	void	setCellSize( float cellSize ) { mCellSize = cellSize; mInvCellSize = 1.0f / cellSize; }
+	//! Returns the width of the cells.
+	float	getCellSize() const { return mCellSize; }
+
+	//! Rebuilds the grid over the \a numPoints \a points, replacing the points it held. Reuses the grid's storage, so rebuilding every frame doesn't allocate once the number of points settles.
+	void	build( const VecT *points, size_t numPoints );
+	//! Rebuilds the grid over \a points.
+	void	build( const std::vector<VecT> &points ) { build( points.data(), points.size() ); }
+	//! Removes all of the points.
+	void	clear() { build( nullptr, 0 ); }
+
+	//! Returns the number of points in the grid.
+	size_t	size() const { return mIndices.size(); }
+	bool	empty() const { return mIndices.empty(); }
+	//! Returns the bounds of the points. For a 2D grid, the z coordinates are \c 0.
+	AxisAlignedBox	getBounds() const;
+
+	//! Returns the coordinates along \a axis of the points, in the grid's order.
+	const std::vector<float>&		getCoords( uint8_t axis ) const { return mCoords[axis]; }
+	//! Returns the indices of the points, in the grid's order.
+	const std::vector<uint32_t>&	getIndices() const { return mIndices; }
+
+	//! Appends the indices of the points closer than \a radius to \a p to \a result, in no particular order. Returns the number of points appended.
+	size_t	findWithinRadius( const VecT &p, float radius, std::vector<uint32_t> *result ) const;
+	/*! Finds the points closer than \a radius to each of the \a numPoints \a points, spread across threads. The indices found for point \c i are
+		<tt>[(*resultOffsets)[i], (*resultOffsets)[i + 1])</tt> in \a resultIndices. */
+	void	findWithinRadius( const VecT *points, size_t numPoints, float radius, std::vector<uint32_t> *resultIndices, std::vector<uint32_t> *resultOffsets ) const;
+	//! Appends the indices of the points inside \a box to \a result, in no particular order. A 2D grid ignores the z coordinates of \a box. Returns the number of points appended.
+	size_t	findInBox( const AxisAlignedBox &box, std::vector<uint32_t> *result ) const;
+
+	//! Calls \a fn( index, distanceSquared ) for each point closer than \a radius to \a p, in no particular order.
+	template<typename Fn>
+	void	forEachWithinRadius( const VecT &p, float radius, const Fn &fn ) const;
+	/*! Calls \a fn( i, j, distanceSquared ) once for every pair of points \a i and \a j closer than \a radius to each other. Pairs of large grids are
+		visited in parallel, so \a fn may be called concurrently from several threads and must be thread safe. */
+	template<typename Fn>
+	void	forEachPair( float radius, const Fn &fn ) const;
+
+  private:
+	enum {
+		// grids with fewer points are built serially, as handing the work to other threads would cost more than it saves
+		MIN_PARALLEL_BUILD_POINTS = 32768,
+		// the fewest points each thread builds
+		MIN_POINTS_PER_TASK = 4096,
+		// the number of points of a batch query or forEachPair() handled by each task
+		POINTS_PER_TASK = 256,
+		// batch queries and forEachPair() with fewer points run serially
+		MIN_PARALLEL_QUERY_POINTS = 2048,
+		// queries of a wrapped table spanning at most this many cells skip repeated buckets, and larger ones check the cell of each point instead
+		MAX_DEDUPLICATED_CELLS = 64
+	};
+
+	CellT		calcCell( const VecT &p ) const { return CellT( glm::floor( p * mInvCellSize ) ); }
+	int			calcCell( float coord ) const { return int( std::floor( coord * mInvCellSize ) ); }
+	uint32_t	calcBucket( const CellT &cell ) const;
+	VecT		getPoint( uint32_t position ) const;
+	float		calcDistanceSquared( uint32_t position, const VecT &p ) const;
+	template<typename RowFn, typename Fn>
+	void		forEachCandidate( const VecT &min, const VecT &max, const RowFn &clipRow, const Fn &fn ) const;
+	bool		clipRowToSphere( const CellT &row, const VecT &p, float radiusSquared, int *begin, int *end ) const;
+
+	float					mCellSize, mInvCellSize;
+	uint32_t				mMask;
+	// whether every cell within the bounds has its own bucket
+	bool					mDense;
+	// the points of bucket b are [mBucketStarts[b], mBucketStarts[b + 1]) in mIndices and mCoords
+	std::vector<uint32_t>	mBucketStarts;
+	std::vector<uint32_t>	mIndices;
+	std::vector<float>		mCoords[K];
+	VecT					mMin, mMax;
+	CellT					mMinCell, mMaxCell;
+	// the bucket numbering's step along each axis
+	uint32_t				mStrides[K];
+	// the bucket of each point in build order, kept to reuse its storage
+	std::vector<uint32_t>	mBuckets;
+};
+
+typedef SpatialHashGrid<2>	SpatialHashGrid2;
+typedef SpatialHashGrid<3>	SpatialHashGrid3;
+
+template<uint8_t K>
+void SpatialHashGrid<K>::build( const VecT *points, size_t numPoints )
+{
+	mBuckets.resize( numPoints );
+	mIndices.resize( numPoints );
+	for( uint8_t k = 0; k < K; ++k )
+		mCoords[k].resize( numPoints );
+	const size_t numTasks = numPoints < MIN_PARALLEL_BUILD_POINTS ? 1 : std::max<size_t>( 1, std::min<size_t>( std::thread::hardware_concurrency(), numPoints / MIN_POINTS_PER_TASK ) );
+
+	// the bounds of the points determine the numbering of the cells
+	std::vector<VecT> taskMin( numTasks, VecT( FLT_MAX ) ), taskMax( numTasks, VecT( -FLT_MAX ) );
+	parallelFor( numTasks, [&]( size_t task ) {
+		const size_t end = numPoints * ( task + 1 ) / numTasks;
+		for( size_t i = numPoints * task / numTasks; i < end; ++i ) {
+			taskMin[task] = glm::min( taskMin[task], points[i] );
+			taskMax[task] = glm::max( taskMax[task], points[i] );
+		}
+	} );
+
+	mMin = numPoints ? taskMin[0] : VecT( 0 );
+	mMax = numPoints ? taskMax[0] : VecT( 0 );
+	for( size_t task = 1; task < numTasks; ++task ) {
+		mMin = glm::min( mMin, taskMin[task] );
+		mMax = glm::max( mMax, taskMax[task] );
+	}
+
+	mMinCell = calcCell( mMin );
+	mMaxCell = calcCell( mMax );
+	double numCells = 1;
+	for( uint8_t k = 0; k < K; ++k ) {
+		mStrides[k] = k ? mStrides[k - 1] * uint32_t( mMaxCell[k - 1] - mMinCell[k - 1] + 1 ) : 1;
+		numCells *= double( mMaxCell[k] - mMinCell[k] ) + 1;
+	}
+
+	uint32_t numBuckets = 1;
+	while( numBuckets < numPoints && numBuckets < numCells )
+		numBuckets *= 2;
+	mMask = numBuckets - 1;
+	mDense = numCells <= numBuckets;
+	mBucketStarts.assign( numBuckets + 1, 0 );
+
+	// a stable counting sort by bucket, in which every thread numbers a range of the points, then counts and places the points of its own range of buckets
+	parallelFor( numTasks, [&]( size_t task ) {
+		const size_t end = numPoints * ( task + 1 ) / numTasks;
+		for( size_t i = numPoints * task / numTasks; i < end; ++i )
+			mBuckets[i] = calcBucket( calcCell( points[i] ) );
+	} );
+
+	auto taskBuckets = [&]( size_t task, uint32_t *begin, uint32_t *end ) {
+		*begin = uint32_t( uint64_t( numBuckets ) * task / numTasks );
+		*end = uint32_t( uint64_t( numBuckets ) * ( task + 1 ) / numTasks );
+	};
+
+	parallelFor( numTasks, [&]( size_t task ) {
+		uint32_t begin, end;
+		taskBuckets( task, &begin, &end );
+		for( uint32_t bucket : mBuckets ) {
+			if( bucket >= begin && bucket < end )
+				++mBucketStarts[bucket + 1];
+		}
+	} );
+
+	for( uint32_t b = 0; b < numBuckets; ++b )
+		mBucketStarts[b + 1] += mBucketStarts[b];
+
+	parallelFor( numTasks, [&]( size_t task ) {
+		uint32_t begin, end;
+		taskBuckets( task, &begin, &end );
+		std::vector<uint32_t> next( mBucketStarts.begin() + begin, mBucketStarts.begin() + end );
+		for( size_t i = 0; i < numPoints; ++i ) {
+			const uint32_t bucket = mBuckets[i];
+			if( bucket < begin || bucket >= end )
+				continue;
+
+			const uint32_t position = next[bucket - begin]++;
+			mIndices[position] = uint32_t( i );
+			for( uint8_t k = 0; k < K; ++k )
+				mCoords[k][position] = points[i][k];
+		}
+	} );
+}
+
+template<uint8_t K>
+AxisAlignedBox SpatialHashGrid<K>::getBounds() const
+{
+	vec3 min( 0 ), max( 0 );
+	for( uint8_t k = 0; k < K; ++k ) {
+		min[k] = mMin[k];
+		max[k] = mMax[k];
+	}
+	return AxisAlignedBox( min, max );
+}
+
+template<uint8_t K>
+uint32_t SpatialHashGrid<K>::calcBucket( const CellT &cell ) const
+{
+	uint32_t result = 0;
+	for( uint8_t k = 0; k < K; ++k )
+		result += uint32_t( cell[k] - mMinCell[k] ) * mStrides[k];
+	return result & mMask;
+}
+
+template<uint8_t K>
+typename SpatialHashGrid<K>::VecT SpatialHashGrid<K>::getPoint( uint32_t position ) const
+{
+	VecT result;
+	for( uint8_t k = 0; k < K; ++k )
+		result[k] = mCoords[k][position];
+	return result;
+}
+
+template<uint8_t K>
+float SpatialHashGrid<K>::calcDistanceSquared( uint32_t position, const VecT &p ) const
+{
+	float result = 0;
+	for( uint8_t k = 0; k < K; ++k )
+		result += ( mCoords[k][position] - p[k] ) * ( mCoords[k][position] - p[k] );
+	return result;
+}
+
+/* Calls fn( position ) for the points in the cells overlapping [min, max], each at most once, along with points of other cells that share their
+   buckets. The cells are visited in rows along x, and clipRow( row, &begin, &end ) may narrow the row's cells [begin, end] or return false to skip it. */
+template<uint8_t K>
+ template<typename RowFn, typename Fn>
+void SpatialHashGrid<K>::forEachCandidate( const VecT &min, const VecT &max, const RowFn &clipRow, const Fn &fn ) const
+{
+	if( mIndices.empty() )
+		return;
+
+	// clamping to the bounds of the points keeps the number of cells down for queries far larger than them
+	const CellT minCell = calcCell( glm::max( min, mMin ) ), maxCell = calcCell( glm::min( max, mMax ) );
+	double numCells = 1;
+	for( uint8_t k = 0; k < K; ++k ) {
+		if( maxCell[k] < minCell[k] )
+			return;
+		numCells *= double( maxCell[k] - minCell[k] ) + 1;
+	}
+
+	if( numCells >= double( mIndices.size() ) ) {
+		// as many cells as points, so scan all of them
+		for( uint32_t position = 0; position < mIndices.size(); ++position )
+			fn( position );
+		return;
+	}
+
+	uint32_t visited[MAX_DEDUPLICATED_CELLS];
+	size_t numVisited = 0;
+	CellT row = minCell;
+	while( true ) {
+		int begin = minCell[0], end = maxCell[0];
+		if( clipRow( row, &begin, &end ) ) {
+			CellT cell = row;
+			cell[0] = begin;
+			if( mDense ) {
+				// the row's cells have consecutive buckets, whose points are contiguous
+				const uint32_t bucket = calcBucket( cell );
+				for( uint32_t position = mBucketStarts[bucket]; position < mBucketStarts[bucket + end - begin + 1]; ++position )
+					fn( position );
+			}
+			else {
+				for( ; cell[0] <= end; ++cell[0] ) {
+					const uint32_t bucket = calcBucket( cell );
+					if( numCells <= MAX_DEDUPLICATED_CELLS ) {
+						// visit each bucket once, even when several of the cells share it
+						if( std::find( visited, visited + numVisited, bucket ) != visited + numVisited )
+							continue;
+						visited[numVisited++] = bucket;
+						for( uint32_t position = mBucketStarts[bucket]; position < mBucketStarts[bucket + 1]; ++position )
+							fn( position );
+					}
+					else {
+						// visit only the points of the cell in its bucket
+						for( uint32_t position = mBucketStarts[bucket]; position < mBucketStarts[bucket + 1]; ++position ) {
+							if( calcCell( getPoint( position ) ) == cell )
+								fn( position );
+						}
+					}
+				}
+			}
+		}
+
+		// the next row
+		uint8_t k = 1;
+		for( ; k < K; ++k ) {
+			if( row[k] < maxCell[k] ) {
+				++row[k];
+				break;
+			}
+			row[k] = minCell[k];
+		}
+		if( k == K )
+			return;
+	}
+}
+
+// Narrows the cells [*begin, *end] of row to those within radiusSquared of p, returning false if none are
+template<uint8_t K>
+bool SpatialHashGrid<K>::clipRowToSphere( const CellT &row, const VecT &p, float radiusSquared, int *begin, int *end ) const
+{
+	float distanceSquared = 0;
+	for( uint8_t k = 1; k < K; ++k ) {
+		const float min = row[k] * mCellSize;
+		const float offset = std::max( std::max( min - p[k], p[k] - ( min + mCellSize ) ), 0.0f );
+		distanceSquared += offset * offset;
+	}
+	if( distanceSquared >= radiusSquared )
+		return false;
+
+	const float halfWidth = std::sqrt( radiusSquared - distanceSquared );
+	*begin = std::max( *begin, calcCell( p[0] - halfWidth ) );
+	*end = std::min( *end, calcCell( p[0] + halfWidth ) );
+	return *begin <= *end;
+}
+
+template<uint8_t K>
+ template<typename Fn>
+void SpatialHashGrid<K>::forEachWithinRadius( const VecT &p, float radius, const Fn &fn ) const
+{
+	const float radiusSquared = radius * radius;
+	forEachCandidate( p - VecT( radius ), p + VecT( radius ), [&]( const CellT &row, int *begin, int *end ) {
+		return clipRowToSphere( row, p, radiusSquared, begin, end );
+	}, [&]( uint32_t position ) {
+		const float distanceSquared = calcDistanceSquared( position, p );
+		if( distanceSquared < radiusSquared )
+			fn( mIndices[position], distanceSquared );
+	} );
+}
+
+template<uint8_t K>
+size_t SpatialHashGrid<K>::findWithinRadius( const VecT &p, float radius, std::vector<uint32_t> *result ) const
+{
+	const size_t initialSize = result->size();
+	forEachWithinRadius( p, radius, [result]( uint32_t index, float ) {
+		result->push_back( index );
+	} );
+	return result->size() - initialSize;
+}
+
+template<uint8_t K>
+void SpatialHashGrid<K>::findWithinRadius( const VecT *points, size_t numPoints, float radius, std::vector<uint32_t> *resultIndices, std::vector<uint32_t> *resultOffsets ) const
+{
+	// each task gathers its points' results, which are then concatenated
+	const size_t numTasks = ( numPoints + POINTS_PER_TASK - 1 ) / POINTS_PER_TASK;
+	const size_t numThreads = numPoints >= MIN_PARALLEL_QUERY_POINTS ? 0 : 1;
+	std::vector<std::vector<uint32_t>> taskResults( numTasks );
+	resultOffsets->resize( numPoints + 1 );
+	parallelFor( numTasks, [&]( size_t task ) {
+		const size_t end = std::min<size_t>( ( task + 1 ) * POINTS_PER_TASK, numPoints );
+		for( size_t i = task * POINTS_PER_TASK; i < end; ++i )
+			(*resultOffsets)[i + 1] = uint32_t( findWithinRadius( points[i], radius, &taskResults[task] ) );
+	}, numThreads );
+
+	(*resultOffsets)[0] = 0;
+	for( size_t i = 0; i < numPoints; ++i )
+		(*resultOffsets)[i + 1] += (*resultOffsets)[i];
+
+	resultIndices->resize( resultOffsets->back() );
+	parallelFor( numTasks, [&]( size_t task ) {
+		std::copy( taskResults[task].begin(), taskResults[task].end(), resultIndices->begin() + (*resultOffsets)[task * POINTS_PER_TASK] );
+	}, numThreads );
+}
+
+template<uint8_t K>
+size_t SpatialHashGrid<K>::findInBox( const AxisAlignedBox &box, std::vector<uint32_t> *result ) const
+{
+	const size_t initialSize = result->size();
+	VecT min, max;
+	for( uint8_t k = 0; k < K; ++k ) {
+		min[k] = box.getMin()[k];
+		max[k] = box.getMax()[k];
+	}
+
+	forEachCandidate( min, max, []( const CellT &, int *, int * ) { return true; }, [&]( uint32_t position ) {
+		for( uint8_t k = 0; k < K; ++k ) {
+			if( mCoords[k][position] < min[k] || mCoords[k][position] > max[k] )
+				return;
+		}
+		result->push_back( mIndices[position] );
+	} );
+	return result->size() - initialSize;
+}
+
+template<uint8_t K>
+ template<typename Fn>
+void SpatialHashGrid<K>::forEachPair( float radius, const Fn &fn ) const
+{
+	// every point looks for the points after it in the grid's order, so each pair is found once
+	const float radiusSquared = radius * radius;
+	const size_t numPoints = mIndices.size();
+	parallelFor( ( numPoints + POINTS_PER_TASK - 1 ) / POINTS_PER_TASK, [&]( size_t task ) {
+		const uint32_t end = uint32_t( std::min<size_t>( ( task + 1 ) * POINTS_PER_TASK, numPoints ) );
+		for( uint32_t first = uint32_t( task * POINTS_PER_TASK ); first < end; ++first ) {
+			const VecT p = getPoint( first );
+			forEachCandidate( p - VecT( radius ), p + VecT( radius ), [&]( const CellT &row, int *begin, int *end ) {
+				return clipRowToSphere( row, p, radiusSquared, begin, end );
+			}, [&]( uint32_t second ) {
+				if( second <= first )
+					return;
+
+				const float distanceSquared = calcDistanceSquared( second, p );
+				if( distanceSquared < radiusSquared )
+					fn( mIndices[first], mIndices[second], distanceSquared );
+			} );
+		}
+	}, numPoints >= MIN_PARALLEL_QUERY_POINTS ? 0 : 1 );
+}
+
+} // namespace cinder
@@ -25,11 +25,13 @@
 
 #pragma once
 
+#include <limits>
 #include <vector>
 #include "cinder/Vector.h"
 #include "cinder/AxisAlignedBox.h"
 #include "cinder/DataSource.h"
 #include "cinder/DataTarget.h"
+#include "cinder/MappedFile.h"
 #include "cinder/Matrix.h"
 #include "cinder/Color.h"
 #include "cinder/Rect.h"
@@ -38,6 +40,7 @@
 namespace cinder {
 
 typedef std::shared_ptr<class TriMesh>		TriMeshRef;
+typedef std::shared_ptr<class MappedTriMesh>	MappedTriMeshRef;
 	
 class TriMesh : public geom::Source {
  public:
@@ -298,7 +301,7 @@ class TriMesh : public geom::Source {
 	//! Calculates the bounding box of all vertices as transformed by \a transform. Fails if the positions are not 3D.
 	AxisAlignedBox	calcBoundingBox( const mat4 &transform ) const;
 
-	//! Fills this TriMesh with the data from a binary file, which was created with TriMesh::write().
+	//! Fills this TriMesh with the data from a binary file, which was created with TriMesh::write() or TriMesh::writeMapped().
 	void		read( const DataSourceRef &dataSource );
 	//! Writes this TriMesh out to a binary data file.
 	void		write( const DataTargetRef &dataTarget ) const { write( dataTarget, ~0 ); }
@@ -306,6 +309,11 @@ class TriMesh : public geom::Source {
 	void		write( const DataTargetRef &dataTarget, bool writeNormals, bool writeTangents ) const;
 	//! Writes this TriMesh out to a binary data file. You can specify which attributes to write by supplying a list of \a attribs.
 	void		write( const DataTargetRef &dataTarget, const std::set<geom::Attrib> &attribs ) const;
+	/*! Writes this TriMesh out to a binary data file in the memory-mappable (version 3) format, where the indices and each attribute live in their own
+		page-aligned block, listed in an offset table at the start of the file. These files can be loaded without any parsing or copying by MappedTriMesh.
+		If \a compress is \c true, each block is losslessly compressed instead, which typically makes the file 2-3x smaller at the cost of decoding it on load.
+		Throws if an attribute doesn't hold exactly one element per vertex. */
+	void		writeMapped( const DataTargetRef &dataTarget, bool compress = false ) const;
 
 	/*! Adds or replaces normals by calculating them from the vertices and faces. If \a smooth is TRUE,
 		similar vertices are grouped together to calculate their average. This will not change the mesh,
@@ -317,6 +325,39 @@ class TriMesh : public geom::Source {
 	//! Adds or replaces bitangents by calculating them from the normals and tangents. Requires 3D normals and tangents.
 	bool		recalculateBitangents();
 
+	/*! Returns, for every vertex, the index of the vertex it coincides with. Vertices are visited in index order and each one either maps to the
+		lowest-indexed earlier representative whose position lies within \a epsilon, or becomes a representative itself (mapping to its own index).
+		Uses a spatial hash with cells of size \a epsilon, so it runs in linear time for reasonably distributed meshes. */
+	std::vector<uint32_t>	calcCoincidentVertices( float epsilon ) const;
+	/*! Merges all vertices whose positions lie within \a epsilon of each other, keeping the attributes of the lowest-indexed vertex in each group.
+		Indices are remapped and triangles that collapse as a result are removed. Returns the number of vertices removed. */
+	size_t		weld( float epsilon );
+	//! Merges vertices whose positions and attributes are all equal, compacting the vertex data and remapping the indices. Returns the number of vertices removed.
+	size_t		removeDuplicateVertices();
+	//! Removes the vertices which aren't referenced by any triangle, compacting the vertex data and remapping the indices. Returns the number of vertices removed.
+	size_t		removeUnusedVertices();
+
+	/*! Reduces the TriMesh to about \a targetRatio of its triangles by repeatedly collapsing the edge whose removal moves the surface the least, as
+		measured by quadric error metrics (Garland & Heckbert). Stops early once the cheapest remaining collapse would move the surface by more than
+		\a maxError, in the units of the positions. Every collapse moves a vertex onto one of its neighbors, so the remaining vertices keep their exact
+		normals, texture coordinates and other attributes. Open borders and attribute seams (vertices sharing a position but not their attributes, such
+		as UV seams or hard edges) only collapse along themselves, which keeps them intact. Duplicate vertices count as seams too, so they should be
+		merged with removeDuplicateVertices() beforehand. Disconnected components are simplified in parallel. Requires 3D positions; unused vertices are
+		removed. Returns the number of triangles removed. */
+	size_t		simplify( float targetRatio, float maxError = std::numeric_limits<float>::max() );
+	/*! Returns \a numLevels successively coarser copies of the TriMesh, each one simplified from the previous one to \a ratioPerLevel of its
+		triangles with simplify(). \a maxError bounds the error introduced by each step. Stops early if a level can't be reduced any further. */
+	std::vector<TriMesh>	buildLodChain( size_t numLevels, float ratioPerLevel = 0.5f, float maxError = std::numeric_limits<float>::max() ) const;
+
+	//! Returns the average cache miss ratio (ACMR) of the triangles, the number of vertices transformed per triangle by a GPU with a FIFO post-transform cache of \a cacheSize vertices.
+	float		calcAcmr( size_t cacheSize = 16 ) const;
+	//! Reorders the triangles to make better use of the GPU's post-transform vertex cache, using Tipsify. Returns the ACMR afterwards.
+	float		optimizeVertexCache( size_t cacheSize = 16 );
+	//! Reorders clusters of triangles so that the ones likely to occlude others draw first, letting the ACMR grow by about a factor of \a threshold. Call after optimizeVertexCache(). Requires 3D positions. Returns the ACMR afterwards.
+	float		optimizeOverdraw( float threshold = 1.05f, size_t cacheSize = 16 );
+	//! Reorders the vertices in the order the triangles first use them, improving the locality of vertex fetches. Unused vertices are moved to the end. Call after reordering the triangles.
+	void		optimizeVertexFetch();
+
 	/*! Subdivide each triangle of the TriMesh into \a division times division triangles. Division less than 2 leaves the mesh unaltered.
 		Optionally, vertices are normalized if \a normalize is TRUE. */
 	void		subdivide( int division = 2, bool normalize = false );
@@ -340,6 +381,8 @@ class TriMesh : public geom::Source {
 
 	//! Returns whether or not the vertex, color etc. at both indices is the same.
 	bool		verticesEqual( uint32_t indexA, uint32_t indexB ) const;
+	//! Removes every vertex that isn't its own representative, as returned by calcCoincidentVertices(), and remaps the indices onto the remaining ones. Returns the number of vertices removed.
+	size_t		compactVertices( const std::vector<uint32_t> &representatives );
 
 	void		readImplV2( const IStreamRef &in );
 	void		readImplV1( const IStreamRef &in );
@@ -366,6 +409,50 @@ class TriMesh : public geom::Source {
 	std::vector<uint32_t>	mIndices;
 	
 	friend class TriMeshGeomTarget;
+	friend class MappedTriMesh;
+};
+
+/*! A read-only geom::Source backed by a TriMesh file written with TriMesh::writeMapped(). Uncompressed files are memory mapped, and their
+	attributes and indices are handed to geom::Target's straight from the mapping, so nothing is parsed or copied up front and pages are only read
+	from disk as they are touched. Compressed blocks are decoded in parallel on construction. Copies share the underlying mapping. */
+class MappedTriMesh : public geom::Source {
+  public:
+	static MappedTriMeshRef	create( const fs::path &filePath )				{ return MappedTriMeshRef( new MappedTriMesh( filePath ) ); }
+	static MappedTriMeshRef	create( const DataSourceRef &dataSource )		{ return MappedTriMeshRef( new MappedTriMesh( dataSource ) ); }
+
+	//! Maps the file at \a filePath. Throws MappedFileExc if it can't be mapped, or Exception if it isn't a valid version 3 TriMesh file.
+	explicit MappedTriMesh( const fs::path &filePath );
+	//! Maps \a dataSource if it refers to a file, otherwise references its Buffer. Throws Exception if it isn't a valid version 3 TriMesh file.
+	explicit MappedTriMesh( const DataSourceRef &dataSource );
+
+	//! Returns a pointer to getNumVertices() * getAttribDims( \a attr ) floats of tightly packed data for \a attr, or \c nullptr if it isn't present.
+	const float*		getAttribData( geom::Attrib attr ) const	{ return attr < geom::NUM_ATTRIBS ? mAttribData[attr] : nullptr; }
+	//! Returns a pointer to getNumIndices() triangle indices, or \c nullptr if there are none.
+	const uint32_t*		getIndices() const							{ return mIndices; }
+	//! Returns the MappedFile the data is read from, or \c nullptr if it came from a DataSource that isn't a file.
+	const MappedFileRef&	getMappedFile() const					{ return mMappedFile; }
+
+	// geom::Source virtuals
+	size_t				getNumVertices() const override				{ return mNumVertices; }
+	size_t				getNumIndices() const override				{ return mNumIndices; }
+	geom::Primitive		getPrimitive() const override				{ return geom::Primitive::TRIANGLES; }
+	uint8_t				getAttribDims( geom::Attrib attr ) const override;
+	geom::AttribSet		getAvailableAttribs() const override;
+	void				loadInto( geom::Target *target, const geom::AttribSet &requestedAttribs ) const override;
+	MappedTriMesh*		clone() const override						{ return new MappedTriMesh( *this ); }
+
+  protected:
+	void	init( const uint8_t *data, size_t size );
+
+	MappedFileRef			mMappedFile;
+	BufferRef				mBuffer;
+	//! Storage for compressed blocks once they're decoded
+	std::shared_ptr<std::vector<uint32_t>>	mDecoded;
+
+	size_t			mNumVertices, mNumIndices;
+	const uint32_t	*mIndices;
+	const float		*mAttribData[geom::NUM_ATTRIBS];
+	uint8_t			mAttribDims[geom::NUM_ATTRIBS];
 };
 
 } // namespace cinder
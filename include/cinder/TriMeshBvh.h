@@ -0,0 +1,135 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/TriMesh.h"
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Frustum.h"
+#include "cinder/Ray.h"
+
+#include <limits>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class TriMeshBvh>	TriMeshBvhRef;
+
+/*! A bounding volume hierarchy over the triangles of a TriMesh, which accelerates ray casting, picking and overlap queries by only testing the
+	triangles near the query. Built top-down with binned surface area heuristic (SAH) splits, in parallel, into a flat array of nodes in depth-first
+	order. References the TriMesh, which must outlive it. Call refit() after moving the TriMesh's vertices, and rebuild the hierarchy after changing its
+	triangles. Requires 3D positions. All queries are thread safe. */
+class TriMeshBvh {
+  public:
+	class Format {
+	  public:
+		Format() : mMaxLeafTriangles( 4 ), mNumBins( 16 ) {}
+
+		//! Sets the most triangles a leaf may hold, up to \c 255. Default is \c 4.
+		Format&		maxLeafTriangles( size_t count ) { mMaxLeafTriangles = count; return *this; }
+		//! Sets the number of candidate split planes evaluated along each axis for every node. Default is \c 16.
+		Format&		bins( size_t count ) { mNumBins = count; return *this; }
+
+		size_t		getMaxLeafTriangles() const { return mMaxLeafTriangles; }
+		size_t		getNumBins() const { return mNumBins; }
+
+	  protected:
+		size_t		mMaxLeafTriangles, mNumBins;
+	};
+
+	//! The result of a ray query
+	struct RayHit {
+		RayHit() : mTriangle( std::numeric_limits<uint32_t>::max() ), mDistance( std::numeric_limits<float>::max() ), mBarycentric( 0 ) {}
+
+		//! Returns whether the ray hit a triangle.
+		bool		isHit() const { return mTriangle != std::numeric_limits<uint32_t>::max(); }
+
+		//! The index of the triangle hit, as used by TriMesh::getTriangleVertices()
+		uint32_t	mTriangle;
+		//! The distance along the ray to the hit, in multiples of its direction
+		float		mDistance;
+		//! The barycentric coordinates of the hit relative to the triangle's second and third vertices
+		vec2		mBarycentric;
+	};
+
+	/*! A node of the hierarchy. An inner node is immediately followed by its first child, and mOffset holds the index of its second child. A leaf
+		holds the mCount triangles starting at mOffset in getTriangles(). */
+	struct Node {
+		bool		isLeaf() const { return mCount != 0; }
+
+		vec3		mMin;
+		uint32_t	mOffset;
+		vec3		mMax;
+		uint16_t	mCount;
+		//! The axis an inner node's children were split along
+		uint16_t	mAxis;
+	};
+
+	static TriMeshBvhRef	create( const TriMesh &mesh, const Format &format = Format() ) { return TriMeshBvhRef( new TriMeshBvh( mesh, format ) ); }
+
+	//! Builds a hierarchy over the triangles of \a mesh, which must outlive it.
+	explicit TriMeshBvh( const TriMesh &mesh, const Format &format = Format() );
+
+	//! Returns the closest triangle hit by \a ray in front of its origin and at most \a maxDistance away, or a RayHit for which isHit() returns \c false.
+	RayHit		raycast( const Ray &ray, float maxDistance = std::numeric_limits<float>::max() ) const;
+	//! Returns whether \a ray hits any triangle in front of its origin and at most \a maxDistance away, returning as soon as it finds one. Suited to shadow and visibility rays.
+	bool		raycastAny( const Ray &ray, float maxDistance = std::numeric_limits<float>::max() ) const;
+	/*! Finds the closest hits of \a numRays \a rays, writing them to \a results. The rays traverse the hierarchy together in small packets, which
+		shares the work of coherent rays such as those through neighboring pixels, and the packets are spread across threads. Returns the number of rays that hit. */
+	size_t		raycast( const Ray *rays, size_t numRays, RayHit *results, float maxDistance = std::numeric_limits<float>::max() ) const;
+	//! Finds whether each of \a numRays \a rays hits any triangle, writing the answers to \a results. Traverses the hierarchy with packets of rays like raycast(). Returns the number of rays that hit.
+	size_t		raycastAny( const Ray *rays, size_t numRays, bool *results, float maxDistance = std::numeric_limits<float>::max() ) const;
+
+	//! Appends the indices of the triangles overlapping \a box to \a result.
+	void		queryOverlapping( const AxisAlignedBox &box, std::vector<uint32_t> *result ) const;
+	//! Appends the indices of the triangles inside or overlapping \a frustum to \a result. Conservative: a triangle outside the frustum but crossing the planes of two of its sides near their corner can be included.
+	void		queryOverlapping( const Frustum &frustum, std::vector<uint32_t> *result ) const;
+
+	//! Updates the bounds of the hierarchy to the current positions of the TriMesh, keeping its structure. Much faster than rebuilding, though queries slow down as triangles move far from where they were when it was built.
+	void		refit();
+
+	//! Returns the TriMesh the hierarchy was built over.
+	const TriMesh&				getTriMesh() const { return *mMesh; }
+	//! Returns the bounds of all of the triangles.
+	AxisAlignedBox				getBounds() const;
+	//! Returns the nodes of the hierarchy, starting with the root.
+	const std::vector<Node>&	getNodes() const { return mNodes; }
+	//! Returns the indices of the triangles in the order of the leaves referring to them.
+	const std::vector<uint32_t>&	getTriangles() const { return mTriangles; }
+	//! Returns the number of levels of the hierarchy.
+	size_t						getDepth() const { return mDepth; }
+
+  protected:
+	void		build();
+	void		updateVertices();
+
+	const TriMesh			*mMesh;
+	Format					mFormat;
+	std::vector<Node>		mNodes;
+	std::vector<uint32_t>	mTriangles;
+	// the vertices of mTriangles, three per triangle, so that leaves don't need to look them up in the TriMesh
+	std::vector<vec3>		mVertices;
+	size_t					mDepth;
+};
+
+} // namespace cinder
@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
 
 #include "cinder/Cinder.h"
 #include "cinder/Url.h"
@@ -57,6 +58,11 @@ std::string loadString( const DataSourceRef &dataSource );
 //! Suspends the execution of the current thread until \a milliseconds have passed. Supports sub-millisecond precision only on Mac OS X.
 void sleep( float milliseconds );
 
+/*! Calls \a fn for each index in [0, \a count), spread across at most \a numThreads threads (0 = one per hardware thread), and blocks until all calls complete.
+	The work runs on the calling thread plus a persistent pool of worker threads shared by all calls, so no threads are created per call, and \a fn may itself call parallelFor().
+	Indices are handed out dynamically. If any call throws, the remaining indices are skipped and the first exception is rethrown on the calling thread. */
+void parallelFor( size_t count, const std::function<void( size_t )> &fn, size_t numThreads = 0 );
+
 //! Returns the path separator for the host operating system's file system, \c '\' on Windows and \c '/' on Mac OS
 #if defined( CINDER_MSW )
 inline char getPathSeparator() { return '\\'; }
@@ -36,6 +36,27 @@ namespace cinder { namespace audio {
 
 class DeviceManager;
 
+//! Snapshot of the profiling data collected by a Context and the Node's it processes. \see Context::getProfile()
+struct ContextProfile {
+	ContextProfile() : mNumBlocks( 0 ), mNumDeadlineMisses( 0 ), mDeadlineSeconds( 0 ), mTotalSeconds( 0 ), mMaxSeconds( 0 ), mLastSeconds( 0 )	{}
+
+	//! Returns the average time spent processing one block, in seconds.
+	double getAverageSeconds() const	{ return mNumBlocks ? mTotalSeconds / (double)mNumBlocks : 0; }
+	//! Returns the average time spent processing one block as a fraction of mDeadlineSeconds. Values approaching 1 will lead to drop-outs.
+	double getLoad() const				{ return mDeadlineSeconds > 0 ? getAverageSeconds() / mDeadlineSeconds : 0; }
+
+	//! Number of processing blocks that were measured.
+	uint64_t	mNumBlocks;
+	//! Number of blocks that took longer to process than mDeadlineSeconds.
+	uint64_t	mNumDeadlineMisses;
+	//! The duration of one block (frames per block / samplerate), which is the most time the audio thread has to process it.
+	double		mDeadlineSeconds;
+	//! Total, longest and most recent time spent processing one block, in seconds.
+	double		mTotalSeconds, mMaxSeconds, mLastSeconds;
+	//! The profile of each Node that is processed, those connected to the OutputNode first followed by the auto-pulled Node's.
+	std::vector<std::pair<NodeRef, NodeProfile> >	mNodes;
+};
+
 //! \brief Manages the creation, connections, and lifecycle of audio::Node's.
 
 //!	The Context class manages platform specific audio processing and thread synchronization between the
@@ -124,8 +145,21 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! OutputNode implementations should call this after each rendering block.
 	void postProcess();
 
-	//! Returns a string representation of the Node graph for debugging purposes.
+	//! Returns a string representation of the Node graph for debugging purposes. Includes each Node's timings when profiling is enabled.
 	std::string printGraphToString();
+	//! Returns a JSON representation of the Node graph and the current profile, suitable for tooling.
+	std::string printGraphToJson();
+
+	//! \brief Sets whether the time spent processing each block and in each Node::process() is measured (default = false).
+	//!
+	//! The measurements are made on the audio thread without locking and cost two clock reads per Node, so this can be left on in production.
+	void setProfilingEnabled( bool enable = true )	{ mProfilingEnabled = enable; }
+	//! Returns whether the time spent processing each block and in each Node::process() is being measured.
+	bool isProfilingEnabled() const					{ return mProfilingEnabled.load( std::memory_order_relaxed ); }
+	//! Returns a snapshot of the profiling data collected for this Context and all of its processed Node's.
+	ContextProfile getProfile();
+	//! Resets the profiling data for this Context and all of its processed Node's.
+	void resetProfile();
 
   protected:
 	Context();
@@ -151,11 +185,18 @@ class Context : public std::enable_shared_from_this<Context> {
 	void	preProcessScheduledEvents();
 	void	postProcessScheduledEvents();
 	void	incrementFrameCount();
+	void	collectNodesRecursive( const NodeRef &node, std::vector<NodeRef> &nodes, std::set<NodeRef> &traversedNodes );
+	std::vector<NodeRef>	collectProcessedNodes();
 
 	static void registerClearStatics();
 
 	bool						mEnabled;
 	std::atomic<uint64_t>		mNumProcessedFrames;
+
+	// profiling, counters are only written to on the audio thread (besides reset).
+	std::atomic<bool>			mProfilingEnabled;
+	uint64_t					mProfileBlockBeginNanos;
+	std::atomic<uint64_t>		mProfileNumBlocks, mProfileNumDeadlineMisses, mProfileTotalNanos, mProfileMaxNanos, mProfileLastNanos;
 	OutputNodeRef				mOutput;
 	std::list<ScheduledEvent>	mScheduledEvents;
 
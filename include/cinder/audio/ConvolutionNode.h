@@ -0,0 +1,117 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/dsp/Convolver.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class ConvolutionNode>		ConvolutionNodeRef;
+
+//! \brief Convolves its input with an impulse response (ex. reverb from a recorded room), using partitioned overlap-save FFT convolution.
+//!
+//! The head of the impulse response is processed on the audio thread with partitions the size of one processing block, so no latency is added.
+//! When non-uniform partitioning is enabled (default), the remaining tail is split into stages with increasingly larger partitions, each of which is
+//! computed on its own background thread and has a full partition period to finish. This makes multi-second impulse responses on many channels
+//! affordable, as the audio thread only does a small, constant amount of work per block.
+//!
+//! The impulse response can have either one channel, which is used for all channels of this Node, or one per channel. If there are less impulse
+//! response channels than Node channels, they are repeated. The output is fully 'wet', mix it with the dry signal externally if needed.
+class ConvolutionNode : public Node {
+  public:
+	struct Format : public Node::Format {
+		Format() : mPartitionSize( 0 ), mMaxPartitionSize( 32768 ), mNonUniform( true ) {}
+
+		//! Sets the partition size of the head, which is processed on the audio thread. Rounded up to a power of two. Default is the Context's frames-per-block (rounded up to a power of two).
+		Format&		partitionSize( size_t size )		{ mPartitionSize = size; return *this; }
+		//! Sets the largest partition size used by the background tail stages. Default is 32768.
+		Format&		maxPartitionSize( size_t size )		{ mMaxPartitionSize = size; return *this; }
+		//! Sets whether the tail of the impulse response is split into larger partitions that are computed on background threads (default = true). If false, all partitions are uniform and processed on the audio thread.
+		Format&		nonUniform( bool b = true )			{ mNonUniform = b; return *this; }
+
+		size_t		getPartitionSize() const			{ return mPartitionSize; }
+		size_t		getMaxPartitionSize() const			{ return mMaxPartitionSize; }
+		bool		isNonUniform() const				{ return mNonUniform; }
+
+		// reimpl Node::Format
+		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
+		Format&		channelMode( ChannelMode mode )			{ Node::Format::channelMode( mode ); return *this; }
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		size_t	mPartitionSize, mMaxPartitionSize;
+		bool	mNonUniform;
+	};
+
+	//! Constructs a ConvolutionNode without an impulse response, with the assumption one will be set later. Outputs silence until then.
+	ConvolutionNode( const Format &format = Format() );
+	//! Constructs a ConvolutionNode that convolves with \a impulseResponse.
+	ConvolutionNode( const BufferRef &impulseResponse, const Format &format = Format() );
+	virtual ~ConvolutionNode();
+
+	//! Sets the impulse response. If this Node is initialized, the (potentially heavy) preparation of the frequency-domain partitions happens on the calling thread
+	//! and the result is swapped in afterwards, so it is safe to do while processing. \a impulseResponse is expected to be at the Context's samplerate.
+	void	setImpulseResponse( const BufferRef &impulseResponse );
+	//! Loads the entire contents of \a sourceFile and uses it as the impulse response, converting the samplerate to match the Context if needed.
+	void	loadImpulseResponse( const SourceFileRef &sourceFile );
+	//! Returns the current impulse response.
+	const BufferRef&	getImpulseResponse() const	{ return mImpulseResponse; }
+
+	//! Returns the partition size used on the audio thread (only valid once initialized).
+	size_t	getPartitionSize() const		{ return mPartitionSize; }
+	//! Returns the number of background stages that are used to process the tail of the impulse response.
+	size_t	getNumTailStages() const		{ return mTailStages.size(); }
+	//! Returns the number of times a background stage missed its deadline since this Node was initialized. The audio thread doesn't wait for it, so each miss drops a
+	//! block of input from that part of the tail, and that part of the tail is silent for a block. A non-zero value means the system can't keep up.
+	uint64_t getNumTailDeadlineMisses() const	{ return mNumTailDeadlineMisses; }
+
+	//! Clears all input history and pending output, for example when the input changes abruptly.
+	void	reset();
+
+  protected:
+	void initialize()				override;
+	void uninitialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	class TailStage;
+	typedef std::vector<std::unique_ptr<dsp::Convolver> >	ConvolverVector;
+	typedef std::vector<std::unique_ptr<TailStage> >		TailStageVector;
+
+	void	buildConvolvers( const BufferRef &impulseResponse, ConvolverVector *headConvolvers, TailStageVector *tailStages ) const;
+
+	BufferRef				mImpulseResponse;
+	ConvolverVector			mHeadConvolvers;	// one per channel
+	TailStageVector			mTailStages;
+	Buffer					mInputBuffer;		// copy of the dry input, as processing happens in-place
+	size_t					mPartitionSize, mMaxPartitionSize;
+	bool					mNonUniform;
+	std::atomic<uint64_t>	mNumTailDeadlineMisses;
+};
+
+} } // namespace cinder::audio
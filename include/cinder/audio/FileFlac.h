@@ -0,0 +1,65 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Target.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+//! \brief TargetFile implementation for encoding lossless FLAC files.
+//!
+//! Samples are quantized to 16 bits for SampleType::INT_16 and 24 bits otherwise. FLAC has no floating point format, so SampleType::FLOAT_32
+//! is downgraded to 24 bit integers, which getSampleType() still reports but getBitsPerSample() reflects. Each block
+//! is encoded with the cheapest of the fixed linear predictors, with Rice coded residuals and stereo decorrelation. No MD5
+//! signature is computed. The STREAMINFO header is updated with the total length when the TargetFileFlac is destroyed.
+class TargetFileFlac : public TargetFile {
+  public:
+	TargetFileFlac( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType );
+	virtual ~TargetFileFlac();
+
+	//! Returns the number of bits per sample that are encoded.
+	size_t getBitsPerSample() const		{ return mBitsPerSample; }
+
+  protected:
+	void performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset ) override;
+
+  private:
+	void writeStreamInfo();
+	void writeFrame();
+
+	ci::OStreamRef						mStream;
+	off_t								mStreamInfoOffset;
+	size_t								mBitsPerSample;
+	std::vector<std::vector<int32_t>>	mBlock;
+	size_t								mNumBlockFrames;
+	std::vector<uint8_t>				mFrameBytes;
+	std::vector<int32_t>				mMid, mSide, mResidual;
+
+	uint64_t		mNumFramesTotal, mFrameNumber;
+	size_t			mMinFrameBytes, mMaxFrameBytes;
+};
+
+} } // namespace cinder::audio
@@ -24,12 +24,14 @@
 #pragma once
 
 #include "cinder/audio/Source.h"
+#include "cinder/audio/Target.h"
 
 //! don't include ogg's static callbacks (we rely on cinder's stream utils instead)
 #define OV_EXCLUDE_STATIC_CALLBACKS
 
 #include "vorbis/codec.h"
 #include "vorbis/vorbisfile.h"
+#include "vorbis/vorbisenc.h"
 
 namespace cinder { namespace audio {
 
@@ -37,6 +39,41 @@ namespace dsp {
 	class Converter;
 }
 
+typedef std::shared_ptr<class SourceFileOggVorbis>		SourceFileOggVorbisRef;
+typedef std::shared_ptr<const class SeekIndexOggVorbis>	SeekIndexOggVorbisRef;
+
+//! \brief Maps frames to byte offsets of the pages within an ogg vorbis file, allowing sample accurate seeks without bisecting the file.
+//!
+//! Build one with SourceFileOggVorbis::buildSeekIndex(). The index can be saved with write() and loaded again with read(), so it only has to be built once per file.
+class SeekIndexOggVorbis {
+  public:
+	struct Page {
+		uint64_t	mByteOffset;	//!< byte offset of the page from the beginning of the file
+		uint64_t	mEndFrame;		//!< frame after the last one that is completed by this page
+	};
+
+	//! Reads an index that was previously written with write(). \note throws AudioFileExc if \a dataSource doesn't contain a valid index.
+	static SeekIndexOggVorbisRef read( const DataSourceRef &dataSource );
+	//! Writes the index to \a dataTarget.
+	void write( const DataTargetRef &dataTarget ) const;
+
+	//! Returns the size of the indexed file in bytes, used to check that the index still matches the file.
+	uint64_t					getFileSize() const		{ return mFileSize; }
+	//! Returns the total number of frames in the indexed file.
+	uint64_t					getNumFrames() const	{ return mNumFrames; }
+	//! Returns the indexed pages, in file order.
+	const std::vector<Page>&	getPages() const		{ return mPages; }
+
+	//! Returns the index of the page that decoding should start from to reach \a frame, which is the page before the one that completes \a frame. Returns -1 if \a frame is within the first page.
+	int findSeekPage( uint64_t frame ) const;
+
+  private:
+	std::vector<Page>	mPages;
+	uint64_t			mFileSize, mNumFrames;
+
+	friend class SourceFileOggVorbis;
+};
+
 //! SourceFile implementation for decoding ogg vorbis files.
 class SourceFileOggVorbis : public SourceFile {
   public:
@@ -53,8 +90,23 @@ class SourceFileOggVorbis : public SourceFile {
 	void		performSeek( size_t readPositionFrames )											override;
 	std::string getMetaData() const																	override;
 
+	//! Scans the file's pages and builds a seek index, which is used for all following seeks. Returns the index, which can be saved for later use with SeekIndexOggVorbis::write().
+	SeekIndexOggVorbisRef	buildSeekIndex();
+	//! \brief Sets the index used for seeking, which can be shared between SourceFileOggVorbis's that read the same file. Pass null to seek without an index.
+	//!
+	//! \note throws AudioFileExc if \a seekIndex doesn't match this file, for example because the file changed since the index was built.
+	void					setSeekIndex( const SeekIndexOggVorbisRef &seekIndex );
+	//! Returns the index used for seeking, or null if there is none.
+	const SeekIndexOggVorbisRef&	getSeekIndex() const	{ return mSeekIndex; }
+
+	//! \brief Loads the entire file like loadBuffer(), but decodes separate chunks of it in parallel on up to \a numThreads threads (0 = one per hardware thread).
+	//!
+	//! A seek index is built first if one hasn't been set. Decoding is only split up when no samplerate conversion is needed, otherwise this is the same as loadBuffer().
+	BufferRef				loadBufferParallel( size_t numThreads = 0 );
+
   private:
 	void init();
+	uint64_t getFileSize() const;
 
 	// ov_callbacks
 	static size_t	readFn( void *ptr, size_t size, size_t count, void *datasource );
@@ -64,19 +116,37 @@ class SourceFileOggVorbis : public SourceFile {
 
 	::OggVorbis_File	mOggVorbisFile;
 
-	ci::DataSourceRef	mDataSource;
-	ci::IStreamRef		mStream;
-	size_t				mNumChannels, mSampleRate;
+	ci::DataSourceRef		mDataSource;
+	ci::IStreamRef			mStream;
+	size_t					mNumChannels, mSampleRate;
+	SeekIndexOggVorbisRef	mSeekIndex;
 };
 
-//class TargetFileImplOggVorbis : public TargetFile {
-//public:
-//	TargetFileImplOggVorbis( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, const std::string &extension );
-//	virtual TargetFileImplOggVorbis() {}
-//
-//	void write( const Buffer *buffer, size_t frameOffset, size_t numFrames ) override;
-//
-//private:
-//};
+//! \brief TargetFile implementation for encoding ogg vorbis files.
+//!
+//! Uses variable bitrate encoding at the given \a quality, which ranges from -0.1 (lowest) to 1.0 (highest). \a sampleType is ignored,
+//! since vorbis always encodes from floating point samples. The stream is finalized when the TargetFileOggVorbis is destroyed.
+class TargetFileOggVorbis : public TargetFile {
+  public:
+	TargetFileOggVorbis( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType, float quality = 0.4f );
+	virtual ~TargetFileOggVorbis();
+
+	float getQuality() const	{ return mQuality; }
+
+  protected:
+	void performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset ) override;
+
+  private:
+	void writePages( bool flush );
+
+	::vorbis_info		mVorbisInfo;
+	::vorbis_comment	mVorbisComment;
+	::vorbis_dsp_state	mVorbisDspState;
+	::vorbis_block		mVorbisBlock;
+	::ogg_stream_state	mOggStream;
+
+	ci::OStreamRef		mStream;
+	float				mQuality;
+};
 
 } } // namespace cinder::audio
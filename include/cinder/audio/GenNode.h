@@ -38,6 +38,7 @@ typedef std::shared_ptr<class GenTriangleNode>		GenTriangleNodeRef;
 typedef std::shared_ptr<class GenTableNode>			GenTableNodeRef;
 typedef std::shared_ptr<class GenOscNode>			GenOscNodeRef;
 typedef std::shared_ptr<class GenPulseNode>			GenPulseNodeRef;
+typedef std::shared_ptr<class GenOscBankNode>		GenOscBankNodeRef;
 
 //! Base class for InputNode's that generate audio samples. Gen's are always mono channel.
 class GenNode : public InputNode {
@@ -181,4 +182,78 @@ class GenPulseNode : public GenNode {
 	Param					mWidth;
 };
 
+//! \brief Bank of band-limited wavetable oscillators that are summed into one mono channel, useful for additive and unison synthesis.
+//!
+//! Oscillator phases, frequencies and gains are stored in contiguous arrays and four oscillators are rendered at a time with SIMD
+//! table lookup, so thousands of partials can be run from a single Node. Each oscillator reads from the band-limited table in the
+//! shared WaveTable2d that matches its frequency. Gain changes are ramped over one processing block to avoid clicks.
+class GenOscBankNode : public InputNode {
+  public:
+	//! Called once per block on the audio thread with the frequencies and gains about to be rendered, which may be modified in place.
+	//! Changes only apply to the current block, the values set with setFreq() and setGain() are passed in again next block.
+	typedef std::function<void ( float *freqs, float *gains, size_t numOscillators )>	ModulationFn;
+
+	//! Constructs a GenOscBankNode with \a numOscillators, all initially silent with a frequency of zero.
+	GenOscBankNode( size_t numOscillators = 0, WaveformType waveformType = WaveformType::SINE, const Format &format = Format() );
+
+	//! Sets the number of oscillators. New oscillators start at zero phase, frequency and gain. \note Allocates, so don't call this from the audio thread.
+	void	setNumOscillators( size_t numOscillators );
+	//! Returns the number of oscillators.
+	size_t	getNumOscillators() const		{ return mNumOscillators; }
+
+	//! Sets the frequency in hertz of the oscillator at \a index.
+	void	setFreq( size_t index, float freq );
+	//! Returns the frequency in hertz of the oscillator at \a index.
+	float	getFreq( size_t index ) const;
+	//! Sets the linear gain of the oscillator at \a index.
+	void	setGain( size_t index, float gain );
+	//! Returns the linear gain of the oscillator at \a index.
+	float	getGain( size_t index ) const;
+	//! Sets the phase of the oscillator at \a index, in the range [0:1).
+	void	setPhase( size_t index, float phase );
+	//! Copies \a count frequencies from \a freqs into the oscillators starting at \a offset. Cheaper than multiple calls to setFreq() as it only synchronizes with the audio thread once.
+	void	setFreqs( const float *freqs, size_t count, size_t offset = 0 );
+	//! Copies \a count gains from \a gains into the oscillators starting at \a offset. Cheaper than multiple calls to setGain() as it only synchronizes with the audio thread once.
+	void	setGains( const float *gains, size_t count, size_t offset = 0 );
+
+	//! Sets a function that can modulate each oscillator's frequency and gain every processing block. \see ModulationFn
+	void	setModulationFn( const ModulationFn &modulationFn );
+
+	//! Sets the factor that all oscillator frequencies are multiplied by (default = 1).
+	void	setFreqScale( float scale )		{ mFreqScale.setValue( scale ); }
+	//! Returns the factor that all oscillator frequencies are multiplied by.
+	float	getFreqScale() const			{ return mFreqScale.getValue(); }
+	//! Returns a pointer to the Param that scales all oscillator frequencies, which can be used for sample accurate pitch modulation.
+	Param*	getParamFreqScale()				{ return &mFreqScale; }
+
+	//! Sets the WaveformType of the internal wavetable. This can be a heavy operation and requires thread synchronization, so be careful not to block the audio thread for too long.
+	void			setWaveform( WaveformType waveformType );
+	//! Returns the current WaveformType.
+	WaveformType	getWaveform() const							{ return mWaveformType; }
+	//! Assigns \a waveTable as the internal wavetable. This allows one to share a WaveTable2d across multiple Node's.
+	void			setWaveTable( const WaveTable2dRef &waveTable )	{ mWaveTable = waveTable; }
+	//! Returns a reference to the current wavetable.
+	const WaveTable2dRef&	getWaveTable() const				{ return mWaveTable; }
+
+  protected:
+	void initialize() override;
+	void process( Buffer *buffer ) override;
+
+	void	resizeImpl( size_t numOscillators );
+	void	renderGroup( size_t group, float *accumulator, size_t numFrames, size_t tableSize, const float *freqScaleArray, float freqScale );
+
+	size_t					mNumOscillators;
+	// oscillator arrays are padded to a multiple of four with silent oscillators, so that rendering always works on complete groups.
+	std::vector<uint32_t>	mPhases;
+	std::vector<float>		mFreqs, mGains, mGainsCurrent;
+	std::vector<float>		mFreqsBlock, mGainsBlock;
+	std::vector<const float *>	mTables;
+	BufferDynamic			mAccumulator;
+	ModulationFn			mModulationFn;
+	Param					mFreqScale;
+	WaveTable2dRef			mWaveTable;
+	WaveformType			mWaveformType;
+	double					mPhaseIncrScale;
+};
+
 } } // namespace cinder::audio
@@ -26,6 +26,7 @@
 #include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/RingBuffer.h"
+#include "cinder/audio/dsp/TripleBuffer.h"
 
 #include "cinder/Thread.h"
 
@@ -35,6 +36,8 @@ namespace dsp {
 	class Fft;
 }
 
+class SpectrumAnalyzer;
+
 typedef std::shared_ptr<class MonitorNode>			MonitorNodeRef;
 typedef std::shared_ptr<class MonitorSpectralNode>	MonitorSpectralNodeRef;
 
@@ -85,7 +88,7 @@ class MonitorNode : public NodeAutoPullable {
 	void process( Buffer *buffer )	override;
 
 	//! Copies audio frames from the RingBuffer into mCopiedBuffer, which is suitable for operation on the main thread.
-	void fillCopiedBuffer();
+	virtual void fillCopiedBuffer();
 	
 	std::vector<dsp::RingBuffer>	mRingBuffers;	// one per channel
 	Buffer							mCopiedBuffer;	// used to safely read audio frames on a non-audio thread
@@ -93,11 +96,16 @@ class MonitorNode : public NodeAutoPullable {
 	size_t							mRingBufferPaddingFactor;
 };
 
-//! A Scope that performs spectral (Fourier) analysis.
+//! \brief A Scope that performs spectral (Fourier) analysis.
+//!
+//! By default the analysis happens asynchronously: a background thread shared by all MonitorSpectralNode's reads each new window from the audio
+//! thread, computes its magnitude spectrum and publishes both through a dsp::TripleBuffer. Any number of threads can then read the latest
+//! spectrum with copyLatestAnalysis() without locking or recomputing it, and the window and spectrum they see always belong together. getMagSpectrum()
+//! and getBuffer() return references to storage owned by the node, so they are meant for a single reader thread (normally the main thread).
 class MonitorSpectralNode : public MonitorNode {
   public:
 	struct Format : public MonitorNode::Format {
-		Format() : MonitorNode::Format(), mFftSize( 0 ), mWindowType( dsp::WindowType::BLACKMAN ) {}
+		Format() : MonitorNode::Format(), mFftSize( 0 ), mWindowType( dsp::WindowType::BLACKMAN ), mAsyncAnalysis( true ) {}
 
 		//! Sets the FFT size, rounded up to the nearest power of 2 greater or equal to \a windowSize. Setting this larger than \a windowSize causes the FFT transform to be 'zero-padded'.
 		//! Default is getWindowSize() rounded up to the nearest power of two. \note resulting number of output spectral bins is equal to (\a size / 2)
@@ -106,9 +114,12 @@ class MonitorSpectralNode : public MonitorNode {
 		Format&		windowType( dsp::WindowType type )	{ mWindowType = type; return *this; }
 		//! \see MonitorNode::Format::windowSize() 
 		Format&		windowSize( size_t size )			{ MonitorNode::Format::windowSize( size ); return *this; }
+		//! Sets whether the spectrum is computed on the shared analysis thread (default = true). If false, it is computed on the thread that calls getMagSpectrum().
+		Format&		asyncAnalysis( bool async = true )	{ mAsyncAnalysis = async; return *this; }
 
 		size_t			getFftSize() const				{ return mFftSize; }
 		dsp::WindowType	getWindowType() const			{ return mWindowType; }
+		bool			isAsyncAnalysis() const			{ return mAsyncAnalysis; }
 
 		// reimpl Node::Format
 		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
@@ -118,41 +129,78 @@ class MonitorSpectralNode : public MonitorNode {
       protected:
 		size_t			mFftSize;
 		dsp::WindowType	mWindowType;
+		bool			mAsyncAnalysis;
 	};
 
 	MonitorSpectralNode( const Format &format = Format() );
 	virtual ~MonitorSpectralNode();
 
 	//! Returns the magnitude spectrum of the currently sampled audio stream, suitable for consuming on the main UI thread.
+	//! \note The returned vector is refreshed by each call to getMagSpectrum(), getBuffer() or getVolume(), so these must all be called from the same
+	//! thread. Other threads should use copyLatestAnalysis() instead.
 	const	std::vector<float>& getMagSpectrum();
 	//! Returns the 'center of mass' of the magnitude spectrum, which is often correlated with the perception of 'brightness', in hertz.
-	//! \note The calculation of the magnitude spectrum happens on the main thread, so the result of getMagSpectrum() and getSpectralCentroid() might be analyzing different
+	//! \note If analysis isn't async, the calculation of the magnitude spectrum happens on the main thread, so the result of getMagSpectrum() and getSpectralCentroid() might be analyzing different
 	//! audio data that is streaming on the audio thread. For a more precise centroid of getMagSpectrum(), you can use audio::dsp::spectralCentroid() directly on it.
 	float	getSpectralCentroid();
+	//! Copies the most recently analyzed window of samples into \a buffer and its magnitude spectrum into \a magSpectrum, either of which can be null.
+	//! Both always come from the same analysis. \return false if nothing has been analyzed yet.
+	//! \note Safe to call from any thread, concurrently with other readers and without locking. Only allocates if the arguments need to grow.
+	bool	copyLatestAnalysis( Buffer *buffer, std::vector<float> *magSpectrum ) const;
+	//! Returns the number of windows that have been analyzed, which can be used to check whether copyLatestAnalysis() has anything new.
+	uint64_t getNumAnalyses() const			{ return mAnalysis.getNumPublished(); }
+	//! Returns whether the spectrum is computed on the shared analysis thread. \see Format::asyncAnalysis()
+	bool	isAsyncAnalysis() const			{ return mIsAsyncAnalysis; }
 	//! Returns the number of frequency bins in the analyzed magnitude spectrum. Equivalent to fftSize / 2.
 	size_t	getNumBins() const				{ return mFftSize / 2; }
 	//! Returns the size of the FFT used for spectral analysis.
 	size_t	getFftSize() const				{ return mFftSize; }
 	//! Returns the corresponding frequency for \a bin. Computed as \code bin * getSampleRate() / getFftSize() \endcode
 	float	getFreqForBin( size_t bin );
-	//! Returns the factor (0 - 1, default = 0.5) used when smoothing the magnitude spectrum between sequential calls to getMagSpectrum().
+	//! Returns the factor (0 - 1, default = 0.5) used when smoothing the magnitude spectrum between sequential analyses.
 	float	getSmoothingFactor() const		{ return mSmoothingFactor; }
-	//! Sets the factor (0 - 1, default = 0.5) used when smoothing the magnitude spectrum between sequential calls to getMagSpectrum()
+	//! Sets the factor (0 - 1, default = 0.5) used when smoothing the magnitude spectrum between sequential analyses. If analysis isn't async, there is one analysis per call to getMagSpectrum().
 	void	setSmoothingFactor( float factor );
 
   protected:
-	void initialize() override;
+	void initialize()		override;
+	void uninitialize()		override;
+	void fillCopiedBuffer()	override;
 
   private:
+	struct Analysis {
+		Buffer				mBuffer;
+		std::vector<float>	mMagSpectrum;
+	};
+
+	//! Reads any complete windows from the RingBuffer's and analyzes the latest one. Called from the analysis thread.
+	void	analyzeAvailable();
+	//! Returns true if a complete window is available in the RingBuffer's. Called from the analysis thread.
+	bool	isWindowAvailable() const;
+	//! Computes the smoothed magnitude spectrum of \a window and publishes both.
+	void	analyze( const Buffer &window );
+	void	updateLatestAnalysis();
+	void	stopAnalysis();
+
 	std::unique_ptr<dsp::Fft>	mFft;
 	Buffer						mFftBuffer;			// windowed samples before transform
 	BufferSpectral				mBufferSpectral;	// transformed samples
-	std::vector<float>			mMagSpectrum;		// computed magnitude spectrum from frequency-domain samples
+	Buffer						mWindowBuffer;		// window read on the analysis thread
+	std::vector<float>			mMagSpectrumSmoothed;	// smoothing state, only accessed by the thread doing the analysis
 	AlignedArrayPtr				mWindowingTable;
 	size_t						mFftSize;
 	dsp::WindowType				mWindowType;
-	float						mSmoothingFactor;
+	std::atomic<float>			mSmoothingFactor;
 	uint64_t					mLastFrameMagSpectrumComputed;
+
+	dsp::TripleBuffer<Analysis>	mAnalysis;			// published results
+	Analysis					mLatestAnalysis;	// latest published results, only accessed by the thread calling getMagSpectrum() and getBuffer()
+	uint64_t					mNumAnalysesRead;
+	bool						mIsAsyncAnalysis;
+	std::shared_ptr<SpectrumAnalyzer>	mAnalyzer;
+	bool						mAnalysisBusy;		// guarded by the analyzer's mutex
+
+	friend class SpectrumAnalyzer;
 };
 
 } } // namespace cinder::audio
@@ -38,6 +38,21 @@ namespace cinder { namespace audio {
 typedef std::shared_ptr<class Context>			ContextRef;
 typedef std::shared_ptr<class Node>				NodeRef;
 
+//! Snapshot of a Node's profiling counters. Timings are only collected while Context::isProfilingEnabled() is true, underruns and overruns are always counted. \see Node::getProfile()
+struct NodeProfile {
+	NodeProfile() : mNumBlocks( 0 ), mTotalSeconds( 0 ), mMaxSeconds( 0 ), mLastSeconds( 0 ), mNumUnderruns( 0 ), mNumOverruns( 0 )	{}
+
+	//! Returns the average time spent in Node::process() per block, in seconds.
+	double getAverageSeconds() const	{ return mNumBlocks ? mTotalSeconds / (double)mNumBlocks : 0; }
+
+	//! Number of blocks that Node::process() was called and measured.
+	uint64_t	mNumBlocks;
+	//! Total, longest and most recent time spent in Node::process(), in seconds. This excludes the time spent processing inputs.
+	double		mTotalSeconds, mMaxSeconds, mLastSeconds;
+	//! Number of times the Node could not provide enough samples (i.e. from a ring buffer) or could not store all of them.
+	uint64_t	mNumUnderruns, mNumOverruns;
+};
+
 //! \brief Fundamental building block for creating an audio processing graph.
 //!
 //!	Node's allow for flexible combinations of synthesis, analysis, effects, file reading/writing, etc, and are designed so that
@@ -165,6 +180,11 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 	//! Sets this Node's name to a user-specified string.
 	void				setName( const std::string &name )	{ mName = name; }
 
+	//! Returns a snapshot of this Node's profiling counters. Safe to call from any thread. \see Context::setProfilingEnabled()
+	NodeProfile			getProfile() const;
+	//! Resets this Node's profiling counters. \note Callers on the non-audio thread must synchronize with the Context's mutex.
+	void				resetProfile();
+
 	//! Usually used internally by a Node subclass, returns a pointer to the internal buffer storage.
 	Buffer*			getInternalBuffer()			{ return &mInternalBuffer; }
 	//! Usually used internally by a Node subclass, returns a pointer to the internal buffer storage.
@@ -184,6 +204,12 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 	virtual void disableProcessing()		{}
 	//! Override to perform audio processing on \t buffer.
 	virtual void process( Buffer *buffer )	{}
+	//! Calls process(), measuring how long it takes if the Context is profiling. Subclasses that override sumInputs() should use this instead of calling process() directly.
+	void processWithProfiling( Buffer *buffer );
+	//! Counts a buffer underrun in this Node's profile. Safe to call from any thread.
+	void countUnderrun()	{ mProfileNumUnderruns.fetch_add( 1, std::memory_order_relaxed ); }
+	//! Counts a buffer overrun in this Node's profile. Safe to call from any thread.
+	void countOverrun()		{ mProfileNumOverruns.fetch_add( 1, std::memory_order_relaxed ); }
 
 	virtual void sumInputs();
 
@@ -223,9 +249,10 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 
   private:
 	// The owning Context calls this.
-	void setContext( const ContextRef &context )	{ mContext = context; }
+	void setContext( const ContextRef &context )	{ mContext = context; mContextPtr = context.get(); }
 
 	std::weak_ptr<Context>	mContext;
+	Context*				mContextPtr; // avoids locking mContext on the audio thread, which is always driven by the owning Context
 	std::atomic<bool>		mEnabled;
 	bool					mInitialized;
 	bool					mAutoEnabled;
@@ -237,6 +264,9 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 
 	uint64_t				mLastProcessedFrame;
 	std::string				mName;
+
+	// profiling counters, only written to on the audio thread (besides reset and under / overruns) so they don't need read-modify-write operations
+	std::atomic<uint64_t>	mProfileNumBlocks, mProfileTotalNanos, mProfileMaxNanos, mProfileLastNanos, mProfileNumUnderruns, mProfileNumOverruns;
 	BufferDynamic			mInternalBuffer, mSummingBuffer;
 
 	std::set<std::shared_ptr<Node> >	mInputs;
@@ -42,6 +42,8 @@ typedef std::function<void ( float *, size_t, double, double, float, float )>	Ra
 
 //! Array-based linear ramping function.
 void rampLinear( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd );
+//! Array-based exponential ramping function, where the value changes by a constant ratio over time. If \a valueBegin and \a valueEnd are zero or of opposite sign, the ramp is linear instead.
+void rampExponential( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd );
 //! Array-based quadradic (t^2) ease-in ramping function.
 void rampInQuad( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd );
 //! Array-based quadradic (t^2) ease-out ramping function.
@@ -71,12 +73,16 @@ class Event {
   private:
 	Event( double timeBegin, double timeEnd, float valueBegin, float valueEnd, bool copyValueOnBegin, const RampFn &rampFn );
 
+	//! Ramps that Param knows how to evaluate directly, without going through the std::function.
+	enum class RampType { LINEAR, EXPONENTIAL, CUSTOM };
+
 	double				mTimeBegin, mTimeEnd, mTimeCancel, mDuration;
 	float				mValueBegin, mValueEnd;
 	std::atomic<bool>	mIsComplete, mIsCanceled;
 	bool				mCopyValueOnBegin;
 	std::string			mLabel;
 	RampFn				mRampFn;
+	RampType			mRampType;
 
 	friend class Param;
 };
@@ -176,11 +182,17 @@ class Param {
 	void		initInternalBuffer();
 	void		resetImpl();
 	void		removeEventsAt( double time );
+	void		addEvent( const EventRef &event );
 	ContextRef	getContext() const;
 
 	std::list<EventRef>	mEvents;
 	std::atomic<float>	mValue;
 	bool				mIsVaryingThisBlock;
+	//! Earliest begin time of all scheduled Events, used so that eval() can return without walking mEvents until one of them begins.
+	double				mEventsTimeBegin;
+	//! Whether mInternalBuffer currently holds mInternalBufferValue in every sample, so getValueArray() can skip refilling it.
+	bool				mIsInternalBufferConstant;
+	float				mInternalBufferValue;
 	Node*				mParentNode;
 	NodeRef				mProcessor;
 	BufferDynamic		mInternalBuffer;
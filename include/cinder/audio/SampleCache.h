@@ -0,0 +1,128 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Buffer.h"
+#include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
+#include "cinder/MappedFile.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class SampleCache>		SampleCacheRef;
+typedef std::shared_ptr<class CachedSample>		CachedSampleRef;
+
+//! \brief Read-only, non-interleaved float32 samples that are memory mapped from a SampleCache file.
+//!
+//! The memory is backed by the operating system's page cache and is shared with every other CachedSample (in this or another process) that maps
+//! the same cache file. SampleCache::load() reads all of it into memory before returning, so that playback doesn't block on page faults.
+class CachedSample {
+  public:
+	//! Returns the number of frames.
+	size_t	getNumFrames() const		{ return mNumFrames; }
+	//! Returns the number of channels.
+	size_t	getNumChannels() const		{ return mNumChannels; }
+	//! Returns the samplerate that the samples were decoded at.
+	size_t	getSampleRate() const		{ return mSampleRate; }
+	//! Returns a pointer to the first sample of channel \a ch. Channels are stored contiguously, same as Buffer.
+	const float*	getChannel( size_t ch ) const
+	{
+		CI_ASSERT_MSG( ch < mNumChannels, "ch out of range" );
+		return mData + ch * mNumFrames;
+	}
+
+	//! Returns the size of the mapped cache file in bytes.
+	size_t			getNumBytes() const			{ return mMappedFile->getSize(); }
+	//! Returns the path of the mapped cache file.
+	const fs::path&	getFilePath() const			{ return mFilePath; }
+	//! Returns a new Buffer that contains a copy of all samples.
+	BufferRef		copyToBuffer() const;
+
+  private:
+	CachedSample( const fs::path &filePath );
+
+	fs::path		mFilePath;
+	const float		*mData;
+	size_t			mNumFrames, mNumChannels, mSampleRate;
+	MappedFileRef	mMappedFile;
+	std::string		mKey;
+
+	friend class SampleCache;
+};
+
+//! \brief Decodes audio files once into float32 cache files on disk and memory maps them for playback.
+//!
+//! The first load() of a file decodes it (converting to the requested samplerate) and writes the result to a file in the cache directory,
+//! which later loads (also from other processes pointed at the same directory) map without decoding. Loads of the same file within a process
+//! share one CachedSample. The total size of the cache directory is kept under a byte budget by removing the least recently used files
+//! that are not currently loaded. Use the resulting CachedSample with BufferPlayerNode::setCachedSample().
+//!
+//! All methods are thread-safe, but load() may block for a long time and should not be called from the audio thread.
+class SampleCache {
+  public:
+	//! Creates a SampleCache that stores its files in \a directory (created if necessary), using at most \a maxBytes of disk space (default = 1 GB).
+	static SampleCacheRef create( const fs::path &directory, uint64_t maxBytes = 1024 * 1024 * 1024 );
+
+	//! Returns the CachedSample for \a dataSource at \a sampleRate, decoding it if it isn't already in the cache. Throws AudioFileExc if the cache file can't be written or mapped.
+	CachedSampleRef		load( const DataSourceRef &dataSource, size_t sampleRate );
+
+	//! Sets the disk space budget in bytes, evicting files if it is now exceeded.
+	void		setMaxBytes( uint64_t maxBytes );
+	//! Returns the disk space budget in bytes.
+	uint64_t	getMaxBytes() const;
+	//! Returns the total size of the files in the cache directory that this SampleCache knows about.
+	uint64_t	getNumBytes() const;
+	//! Returns the number of cache files.
+	size_t		getNumFiles() const;
+	//! Returns the cache directory.
+	const fs::path&	getDirectory() const	{ return mDirectory; }
+	//! Removes all cache files that aren't currently loaded.
+	void		clear();
+
+  private:
+	SampleCache( const fs::path &directory, uint64_t maxBytes );
+
+	struct Entry {
+		std::string						mFileName;
+		uint64_t						mNumBytes;
+		std::weak_ptr<CachedSample>		mSample;
+	};
+	typedef std::list<Entry>	EntryList; // ordered from least to most recently used
+
+	void	scanDirectory();
+	void	evict( uint64_t maxBytes );
+	void	writeCacheFile( const fs::path &filePath, const std::string &key, const DataSourceRef &dataSource, size_t sampleRate ) const;
+
+	fs::path								mDirectory;
+	uint64_t								mMaxBytes, mNumBytes;
+	EntryList								mEntries;
+	std::map<std::string, EntryList::iterator>	mEntryLookup;	// key is file name
+	mutable std::mutex						mMutex;
+};
+
+} } // namespace cinder::audio
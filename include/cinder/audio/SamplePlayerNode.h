@@ -24,12 +24,11 @@
 #pragma once
 
 #include "cinder/audio/InputNode.h"
+#include "cinder/audio/SampleCache.h"
 #include "cinder/audio/Source.h"
 #include "cinder/audio/dsp/RingBuffer.h"
 
-#include <thread>
-#include <mutex>
-#include <condition_variable>
+#include <memory>
 
 namespace cinder { namespace audio {
 
@@ -37,6 +36,8 @@ typedef std::shared_ptr<class SamplePlayerNode>				SamplePlayerNodeRef;
 typedef std::shared_ptr<class BufferPlayerNode>				BufferPlayerNodeRef;
 typedef std::shared_ptr<class FilePlayerNode>				FilePlayerNodeRef;
 
+class FileStreamer;
+
 //! \brief Base Node class for sampled audio playback. Can do operations like seek and loop.
 //!
 //! SamplePlayerNode itself doesn't process any audio, but contains the common interface for InputNode's that do.
@@ -99,13 +100,17 @@ class SamplePlayerNode : public InputNode {
 	std::atomic<bool>	mLoop, mIsEof;
 };
 
-//! Buffer-based SamplePlayerNode, where all samples are loaded into memory before playback.
+//! \brief Buffer-based SamplePlayerNode, where all samples are loaded into memory before playback.
+//!
+//! Can alternatively play a CachedSample, in which case the samples are memory mapped from a SampleCache file instead of owned by this Node.
 class BufferPlayerNode : public SamplePlayerNode {
   public:
 	//! Constructs a BufferPlayerNode without a buffer, with the assumption one will be set later. \note Format::channels() can still be used to allocate the expected channel count ahead of time.
 	BufferPlayerNode( const Format &format = Format() );
 	//! Constructs a BufferPlayerNode with \a buffer. \note Channel mode is always ChannelMode::SPECIFIED and num channels matches \a buffer. Format::channels() is ignored.
 	BufferPlayerNode( const BufferRef &buffer, const Format &format = Format() );
+	//! Constructs a BufferPlayerNode that plays the memory mapped \a cachedSample. \note Channel mode is always ChannelMode::SPECIFIED and num channels matches \a cachedSample. Format::channels() is ignored.
+	BufferPlayerNode( const CachedSampleRef &cachedSample, const Format &format = Format() );
 
 	virtual ~BufferPlayerNode() {}
 
@@ -118,14 +123,28 @@ class BufferPlayerNode : public SamplePlayerNode {
 	//! returns a shared_ptr to the current Buffer.
 	const BufferRef& getBuffer() const	{ return mBuffer; }
 
+	//! Loads \a dataSource through \a sampleCache at this Node's samplerate, so it is decoded only once and then memory mapped. Resets the loop points to 0:getNumFrames()).
+	void loadCachedSample( const SampleCacheRef &sampleCache, const DataSourceRef &dataSource );
+	//! Sets the current CachedSample, replacing any Buffer. Safe to do while enabled. Resets the loop points to 0:getNumFrames()). \a cachedSample is expected to be at the Context's samplerate.
+	void setCachedSample( const CachedSampleRef &cachedSample );
+	//! Returns a shared_ptr to the current CachedSample, or null if playing a Buffer.
+	const CachedSampleRef& getCachedSample() const	{ return mCachedSample; }
+
   protected:
 	void enableProcessing()			override;
 	void process( Buffer *buffer )	override;
 
-	BufferRef mBuffer;
+	void copySamples( Buffer *buffer, size_t numFrames, size_t frameOffset, size_t readPos ) const;
+
+	BufferRef		mBuffer;
+	CachedSampleRef	mCachedSample;
 };
 
-//! File-based SamplePlayerNode, where samples are constantly streamed from file. Suitable for large audio files.
+//! \brief File-based SamplePlayerNode, where samples are constantly streamed from file. Suitable for large audio files.
+//!
+//! When reading asynchronously (the default), all FilePlayerNode's share a small pool of streaming threads, which keep each player's ring buffers
+//! filled, servicing the emptiest ones first. The audio thread never blocks on the streaming threads: seeks are posted with atomics and the
+//! samples arrive through lock-free ring buffers. When looping, reading wraps around at the loop end ahead of time, so there is no gap.
 class FilePlayerNode : public SamplePlayerNode {
   public:
 	//! Constructs a FilePlayerNode with optional \a format.
@@ -137,14 +156,14 @@ class FilePlayerNode : public SamplePlayerNode {
 	void stop() override;
 	void seek( size_t readPositionFrames ) override;
 
-	//! Returns whether reading occurs asynchronously (default is false). If true, file reading is done from an internal thread, if false it is done directly on the audio thread.
+	//! Returns whether reading occurs asynchronously (default is true). If true, file reading is done from a shared streaming thread, if false it is done directly on the audio thread.
 	bool isReadAsync() const	{ return mIsReadAsync; }
 
 	//! \note \a sourceFile's samplerate is forced to match this Node's Context. Resets the loop points to 0:getNumFrames()).
 	void setSourceFile( const SourceFileRef &sourceFile );
 	const SourceFileRef& getSourceFile() const	{ return mSourceFile; }
 
-	//! Returns the frame of the last buffer underrun or 0 if none since the last time this method was called.
+	//! Returns the frame of the last buffer underrun or 0 if none since the last time this method was called. The total number of underruns is available from getProfile().
 	uint64_t getLastUnderrun();
 	//! Returns the frame of the last buffer overrun or 0 if none since the last time this method was called.
 	uint64_t getLastOverrun();
@@ -156,11 +175,17 @@ class FilePlayerNode : public SamplePlayerNode {
 	void disableProcessing()		override;
 	void process( Buffer *buffer )	override;
 
-	void readAsyncImpl();
+	void setupStreaming();
+	void startStreaming();
+	void stopStreaming();
+	//! Returns how urgently the ring buffers need to be filled, from 0 (empty or seek pending) to 1 (nothing to do). Called from the streaming thread.
+	float getStreamUrgency() const;
+	//! Reads from the SourceFile into the ring buffers until they are full. Called from the streaming thread (or the audio thread if not reading async).
 	void readImpl();
 	void seekImpl( size_t readPos );
 	void stopImpl();
-	void destroyReadThreadImpl();
+	//! Publishes that the reading side has caught up with seek \a generation, whose first frame is \a beginFrame in the ring buffers and \a readPos in the file.
+	void publishGeneration( uint64_t generation, uint64_t beginFrame, size_t readPos );
 
 	std::vector<dsp::RingBuffer>				mRingBuffers;	// used to transfer samples from io to audio thread, one ring buffer per channel
 	BufferDynamic								mIoBuffer;		// used to read samples from the file on read thread, resizeable so the ringbuffer can be filled
@@ -168,11 +193,20 @@ class FilePlayerNode : public SamplePlayerNode {
 	SourceFileRef								mSourceFile;
 	size_t										mBufferFramesThreshold, mRingBufferPaddingFactor;
 	std::atomic<uint64_t>						mLastUnderrun, mLastOverrun;
+	bool										mIsReadAsync;
+
+	// Seeks are posted by bumping mSeekGeneration. The reading side acknowledges by publishing mWriteGeneration, along with the total
+	// number of frames written before the new position, so the audio thread knows exactly how many stale frames to discard.
+	// The three are published together under the mGenerationSequence seqlock, which is odd while they are being written.
+	std::atomic<size_t>							mSeekPos, mGenerationReadPos;
+	std::atomic<uint64_t>						mSeekGeneration, mWriteGeneration, mGenerationBeginFrame, mGenerationSequence, mNumFramesWritten, mStreamEndFrame;
+	uint64_t									mReadGeneration, mNumFramesRead;	// only accessed by the audio thread
+	size_t										mStreamPos;							// only accessed by the reading side
+
+	std::shared_ptr<FileStreamer>				mStreamer;
+	bool										mStreamBusy;	// guarded by the FileStreamer
 
-	std::unique_ptr<std::thread>				mReadThread;
-	std::mutex									mAsyncReadMutex;
-	std::condition_variable						mIssueAsyncReadCond;
-	bool										mIsReadAsync, mAsyncReadShouldQuit;
+	friend class FileStreamer;
 };
 
 } } // namespace cinder::audio
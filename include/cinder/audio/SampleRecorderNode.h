@@ -25,12 +25,17 @@
 
 #include "cinder/audio/Node.h"
 #include "cinder/audio/SampleType.h"
+#include "cinder/DataTarget.h"
 #include "cinder/Filesystem.h"
 
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class SampleRecorderNode> SampleRecorderNodeRef;
 typedef std::shared_ptr<class BufferRecorderNode> BufferRecorderNodeRef;
+typedef std::shared_ptr<class FileRecorderNode> FileRecorderNodeRef;
+
+class TargetFile;
+class TargetFileAsync;
 
 //! Base Node class for recording audio samples. Inherits from NodeAudioPullable, and therefore does not need to be connected to an output.
 class SampleRecorderNode : public NodeAutoPullable {
@@ -93,4 +98,45 @@ class BufferRecorderNode : public SampleRecorderNode {
 	std::atomic<uint64_t>	mLastOverrun;
 };
 
+//! \brief Records its inputs directly to a file, with bounded memory usage.
+//!
+//! Samples are handed off to a TargetFileAsync from the audio thread, which encodes and writes them to disk from a background thread.
+//! The amount of memory used is fixed by the buffer duration (see setBufferSeconds()), regardless of how long the recording is.
+//! If the disk can't keep up, frames are dropped and reported by getLastOverrun().
+class FileRecorderNode : public SampleRecorderNode {
+  public:
+	FileRecorderNode( const Format &format = Format() );
+	virtual ~FileRecorderNode();
+
+	//! \brief Starts recording to a file at \a filePath, replacing any recording in progress.
+	//!
+	//! The encoding format is derived from \a filePath's extension and \a sampleType (default = SampleType::INT_16).
+	//! \note throws AudioFileExc if the file cannot be created.
+	void start( const ci::fs::path &filePath, SampleType sampleType = SampleType::INT_16 );
+	//! Starts recording to \a dataTarget, using \a extension to choose the encoding format.
+	void start( const DataTargetRef &dataTarget, const std::string &extension, SampleType sampleType = SampleType::INT_16 );
+	//! Starts recording to \a target, which must have the same number of channels as this Node.
+	void start( std::unique_ptr<TargetFile> &&target );
+	//! Stops recording and finalizes the file. Blocks until all recorded frames have been written.
+	void stop();
+	//! Returns whether a file is currently being recorded to.
+	bool isRecording() const;
+
+	//! Sets the number of seconds that can be buffered before frames are dropped. Takes effect on the next call to start(). Default is 2 seconds.
+	void	setBufferSeconds( double seconds )	{ mBufferSeconds = seconds; }
+	//! Returns the number of seconds that can be buffered before frames are dropped.
+	double	getBufferSeconds() const			{ return mBufferSeconds; }
+
+	//! Returns the frame of the last buffer overrun or 0 if none since the last time this method was called. When this happens, it means the recorded file has skipped some frames.
+	uint64_t getLastOverrun();
+
+  protected:
+	void process( Buffer *buffer )	override;
+
+  private:
+	std::unique_ptr<TargetFileAsync>	mTarget;
+	double								mBufferSeconds;
+	std::atomic<uint64_t>				mLastOverrun;
+};
+
 } } // namespace cinder::audio
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "cinder/audio/Buffer.h"
+#include "cinder/audio/dsp/Converter.h"
 #include "cinder/DataSource.h"
 #include "cinder/Noncopyable.h"
 
@@ -32,10 +33,6 @@ namespace cinder { namespace audio {
 typedef std::shared_ptr<class Source>			SourceRef;
 typedef std::shared_ptr<class SourceFile>		SourceFileRef;
 
-namespace dsp {
-	class Converter;
-}
-
 //! Base class that is used to load and read from an audio source.
 class Source : private Noncopyable {
   public:
@@ -107,6 +104,14 @@ class SourceFile : public Source {
 	//! Returns the length in seconds.
 	double	getNumSeconds() const						{ return (double)getNumFrames() / (double)getSampleRate(); }
 
+	//! \brief Sets the quality of the samplerate conversion that is used when the output samplerate differs from the file's (default = dsp::Converter::Quality::BEST).
+	//!
+	//! Cheaper qualities are useful for quickly decoding previews or waveform overviews. The setting is kept by clone() and cloneWithSampleRate().
+	//! \note Has no effect on implementations that perform their own samplerate conversion.
+	void	setConverterQuality( dsp::Converter::Quality quality );
+	//! Returns the quality of the samplerate conversion that is used when the output samplerate differs from the file's.
+	dsp::Converter::Quality	getConverterQuality() const	{ return mConverterQuality; }
+
 	//! Returns a vector of extensions that SourceFile support for loading. Suitable for the \a extensions parameter of getOpenFilePath().
 	static std::vector<std::string>	getSupportedExtensions();
 
@@ -118,10 +123,19 @@ class SourceFile : public Source {
 	//! Sets up samplerate conversion if needed. Can be overridden by implementation if they handle samplerate conversion in a specific way, else it is handled generically with a dsp::Converter.
 	virtual void setupSampleRateConversion();
 
-	size_t mNumFrames, mFileNumFrames, mReadPos;
+	size_t					mNumFrames, mFileNumFrames, mReadPos;
+	dsp::Converter::Quality	mConverterQuality;
 };
 
 //! Convenience method for loading a SourceFile from \a dataSource. \return SourceFileRef. \see SourceFile::create()
 inline SourceFileRef	load( const DataSourceRef &dataSource, size_t sampleRate = 0 )	{ return SourceFile::create( dataSource, sampleRate ); }
 
+//! \brief Loads the entire contents of each of \a sourceFiles, decoding them in parallel on up to \a numThreads threads (0 = one per hardware thread).
+//!
+//! The returned Buffers are in the same order as \a sourceFiles. Each SourceFile must be a separate instance, since they are read from concurrently.
+//! \note rethrows the first exception that occurs while decoding.
+std::vector<BufferRef>	loadBuffers( const std::vector<SourceFileRef> &sourceFiles, size_t numThreads = 0 );
+//! Opens and loads the entire contents of each of \a dataSources in parallel, converted to \a sampleRate (0 = each file's native samplerate). \see loadBuffers()
+std::vector<BufferRef>	loadBuffers( const std::vector<DataSourceRef> &dataSources, size_t sampleRate = 0, size_t numThreads = 0 );
+
 } } // namespace cinder::audio
@@ -0,0 +1,182 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class SpatialNode>				SpatialNodeRef;
+typedef std::shared_ptr<class SpatialPannerNode>		SpatialPannerNodeRef;
+typedef std::shared_ptr<class VbapNode>					VbapNodeRef;
+typedef std::shared_ptr<class AmbisonicEncoderNode>		AmbisonicEncoderNodeRef;
+typedef std::shared_ptr<class AmbisonicDecoderNode>		AmbisonicDecoderNodeRef;
+
+//! Direction on the unit sphere, in degrees. Azimuth is measured counter-clockwise from the front (so 90 is to the left) and elevation is measured upwards from the horizontal plane.
+struct SpatialDirection {
+	SpatialDirection( float azimuth = 0, float elevation = 0 ) : mAzimuth( azimuth ), mElevation( elevation )	{}
+
+	float	mAzimuth, mElevation;
+};
+
+//! \brief Base class for Node's that map a number of input channels (sources) to output channels with a gain matrix.
+//!
+//! Channel \a i of every connected input feeds source \a i, so many sources are usually assembled with a ChannelRouterNode.
+//! The whole matrix is applied to the block at once, skipping source / output pairs that are silent. When gains change they are
+//! linearly interpolated across the next processing block to avoid clicks.
+class SpatialNode : public Node {
+  public:
+	//! Returns the number of sources (input channels) that are mapped to the outputs.
+	size_t	getNumSources() const	{ return mNumSources; }
+	//! Returns the gain that \a source currently contributes to \a outputChannel.
+	float	getGain( size_t source, size_t outputChannel ) const;
+
+  protected:
+	//! Constructs a SpatialNode with \a numSources inputs and \a numOutputChannels outputs. \note Format::channels() and Format::channelMode() are ignored.
+	SpatialNode( size_t numSources, size_t numOutputChannels, const Format &format );
+
+	void initialize() override;
+	void process( Buffer *buffer ) override;
+	void sumInputs() override;
+	bool supportsInputNumChannels( size_t ) const override			{ return true; }
+	bool supportsProcessInPlace() const override						{ return false; }
+
+	//! Sets the target gains of \a count consecutive sources starting at \a firstSource, where \a gains holds getNumChannels() values per source. Synchronizes with the audio thread.
+	void	setGains( size_t firstSource, size_t count, const float *gains );
+
+	size_t				mNumSources;
+	// gain matrices are stored source-major, with getNumChannels() gains per source.
+	std::vector<float>	mGains, mGainsCurrent;
+	bool				mGainsChanged;
+	Buffer				mSourceBuffer;
+	BufferDynamic		mInputBuffer;
+};
+
+//! \brief Base class for spatial panners that position each source in a direction.
+class SpatialPannerNode : public SpatialNode {
+  public:
+	//! Sets the direction of \a source.
+	void	setSourceDirection( size_t source, const SpatialDirection &direction );
+	//! Sets the directions of consecutive sources starting at \a firstSource. Cheaper than multiple calls to setSourceDirection() as it only synchronizes with the audio thread once.
+	void	setSourceDirections( const std::vector<SpatialDirection> &directions, size_t firstSource = 0 );
+	//! Returns the direction of \a source.
+	const SpatialDirection&	getSourceDirection( size_t source ) const;
+
+  protected:
+	SpatialPannerNode( size_t numSources, size_t numOutputChannels, const Format &format );
+
+	//! Computes the getNumChannels() output gains of a source at \a direction, writing them to \a gains. Called on the thread that sets the direction.
+	virtual void computeGains( const SpatialDirection &direction, float *gains ) const = 0;
+
+	//! Recomputes the gains of all sources from their current directions.
+	void	updateAllGains();
+
+	std::vector<SpatialDirection>	mDirections;
+};
+
+//! \brief Vector base amplitude panning (VBAP) of many sources over a speaker layout.
+//!
+//! Each source is panned between the two (horizontal layouts) or three (3D layouts) adjacent speakers that surround it, with
+//! power-normalized gains. A layout is treated as horizontal when all speaker elevations are zero, otherwise the speakers are
+//! triangulated with their convex hull. Sources outside the area covered by the speakers snap to the closest speaker pair or triplet.
+class VbapNode : public SpatialPannerNode {
+  public:
+	//! Constructs a VbapNode with \a numSources that are panned over \a speakers, one output channel per speaker. Sources start out in front (0, 0).
+	VbapNode( size_t numSources, const std::vector<SpatialDirection> &speakers, const Format &format = Format() );
+
+	//! Returns the speaker layout.
+	const std::vector<SpatialDirection>&	getSpeakers() const	{ return mSpeakers; }
+	//! Returns whether the speaker layout is horizontal (panned in pairs) or not (panned in triplets).
+	bool	isHorizontal() const	{ return mHorizontal; }
+
+  protected:
+	void computeGains( const SpatialDirection &direction, float *gains ) const override;
+
+  private:
+	void	buildPairs();
+	void	buildTriplets();
+
+	// each speaker group stores the speaker indices and the inverse of the matrix whose rows are the speaker unit vectors.
+	struct SpeakerGroup {
+		size_t	mSpeakers[3];
+		float	mInverse[9];
+	};
+
+	std::vector<SpatialDirection>	mSpeakers;
+	std::vector<SpeakerGroup>		mGroups;
+	bool							mHorizontal;
+};
+
+//! \brief Encodes many sources into a B-format ambisonic sound field of order one to three.
+//!
+//! Output channels follow the AmbiX convention: ACN channel ordering and SN3D normalization, so there are (order + 1)^2 output channels.
+class AmbisonicEncoderNode : public SpatialPannerNode {
+  public:
+	//! Constructs an AmbisonicEncoderNode with \a numSources, encoding at \a order (1 to 3). Sources start out in front (0, 0).
+	AmbisonicEncoderNode( size_t numSources, size_t order = 1, const Format &format = Format() );
+
+	//! Returns the ambisonic order.
+	size_t	getOrder() const	{ return mOrder; }
+
+	//! Writes the (order + 1)^2 SN3D spherical harmonics in ACN order for \a direction to \a result.
+	static void computeSphericalHarmonics( size_t order, const SpatialDirection &direction, float *result );
+
+  protected:
+	void computeGains( const SpatialDirection &direction, float *gains ) const override;
+
+  private:
+	size_t	mOrder;
+};
+
+//! \brief Decodes an AmbiX B-format sound field (ACN, SN3D) of order one to three to a speaker layout.
+//!
+//! Uses a sampling (projection) decoder, which is best suited to layouts that cover the sphere fairly evenly. The decoding matrix
+//! is scaled so that a source keeps its power, on average, when encoded and then decoded over a uniform layout.
+class AmbisonicDecoderNode : public SpatialNode {
+  public:
+	//! Weighting applied to each order of the decoded sound field.
+	enum class Weighting {
+		BASIC,	//!< No weighting, which gives the sharpest localization at the center of the layout.
+		MAX_RE	//!< Maximizes the energy vector, which reduces the spread of a source to the opposite speakers and works better for larger audiences.
+	};
+
+	//! Constructs an AmbisonicDecoderNode that decodes a sound field of \a order (1 to 3) to \a speakers, one output channel per speaker. The input must have (order + 1)^2 channels.
+	AmbisonicDecoderNode( size_t order, const std::vector<SpatialDirection> &speakers, Weighting weighting = Weighting::MAX_RE, const Format &format = Format() );
+
+	//! Returns the ambisonic order.
+	size_t	getOrder() const	{ return mOrder; }
+	//! Returns the speaker layout.
+	const std::vector<SpatialDirection>&	getSpeakers() const	{ return mSpeakers; }
+	//! Returns the Weighting used to decode.
+	Weighting	getWeighting() const	{ return mWeighting; }
+
+  private:
+	size_t							mOrder;
+	std::vector<SpatialDirection>	mSpeakers;
+	Weighting						mWeighting;
+};
+
+} } // namespace cinder::audio
@@ -0,0 +1,117 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/audio/dsp/Dsp.h"
+
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+namespace dsp {
+	class Fft;
+}
+
+typedef std::shared_ptr<class SpectralNode>		SpectralNodeRef;
+
+//! \brief Base class for Node's that process audio in the frequency domain with a short-time Fourier transform (STFT).
+//!
+//! Every getHopSize() frames, the last getFftSize() input samples of each channel are windowed and transformed, passed to processSpectrum(),
+//! then transformed back, windowed again and overlap-added into the output. The synthesis window is normalized for the chosen window and hop,
+//! so if processSpectrum() leaves the spectra untouched the output equals the input, delayed by getLatencyFrames().
+//!
+//! All buffers are allocated in initialize(), so nothing is allocated on the audio thread. Subclasses only need to implement processSpectrum().
+class SpectralNode : public Node {
+  public:
+	struct Format : public Node::Format {
+		Format() : mFftSize( 1024 ), mHopSize( 0 ), mWindowType( dsp::WindowType::HANN ) {}
+
+		//! Sets the size of each analysis frame, which is rounded up to a size supported by dsp::Fft. Default is 1024.
+		Format&		fftSize( size_t size )				{ mFftSize = size; return *this; }
+		//! Sets the number of frames between the start of each analysis frame. Default is a quarter of the fft size. Clamped to the fft size,
+		//! and halved while the window would vanish at some position, for example a HANN window with a hop equal to the fft size.
+		Format&		hopSize( size_t size )				{ mHopSize = size; return *this; }
+		//! Sets the window that is applied both before the forward transform and after the inverse transform. Default is WindowType::HANN.
+		Format&		windowType( dsp::WindowType type )	{ mWindowType = type; return *this; }
+
+		size_t			getFftSize() const				{ return mFftSize; }
+		size_t			getHopSize() const				{ return mHopSize; }
+		dsp::WindowType	getWindowType() const			{ return mWindowType; }
+
+		// reimpl Node::Format
+		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
+		Format&		channelMode( ChannelMode mode )			{ Node::Format::channelMode( mode ); return *this; }
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		size_t			mFftSize, mHopSize;
+		dsp::WindowType	mWindowType;
+	};
+
+	virtual ~SpectralNode();
+
+	//! Returns the size of each analysis frame.
+	size_t			getFftSize() const			{ return mFftSize; }
+	//! Returns the number of frames between the start of each analysis frame.
+	size_t			getHopSize() const			{ return mHopSize; }
+	//! Returns the number of frequency bins passed to processSpectrum(). Equivalent to getFftSize() / 2.
+	size_t			getNumBins() const			{ return mFftSize / 2; }
+	//! Returns the window that is applied before and after the transforms.
+	dsp::WindowType	getWindowType() const		{ return mWindowType; }
+	//! Returns the number of frames that the output is delayed with respect to the input, which is equal to getFftSize().
+	size_t			getLatencyFrames() const	{ return mFftSize; }
+	//! Returns the corresponding frequency for \a bin. Computed as \code bin * getSampleRate() / getFftSize() \endcode
+	float			getFreqForBin( size_t bin ) const;
+
+	//! Clears all input history and pending output, for example when the input changes abruptly.
+	void	reset();
+
+  protected:
+	SpectralNode( const Format &format = Format() );
+
+	//! Called on the audio thread once per hop with the spectra of the current frame, which can be modified in place. \a spectra points to
+	//! getNumChannels() BufferSpectral's, one per channel, so that effects like vocoding can combine channels. Each has getNumBins() bins packed
+	//! as in dsp::Fft, where the imaginary part of bin 0 holds the Nyquist component.
+	virtual void processSpectrum( BufferSpectral *spectra ) = 0;
+
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	void processFrame();
+	bool computeSynthesisWindow();
+
+	std::unique_ptr<dsp::Fft>		mFft;
+	Buffer							mInputBuffer;		// the last mFftSize input samples of each channel
+	Buffer							mFftBuffer;			// windowed samples for the transforms
+	Buffer							mOverlapBuffer;		// overlap-add accumulation, the first mHopSize frames are being output
+	std::vector<BufferSpectral>		mSpectra;			// one per channel
+	std::vector<float>				mAnalysisWindow, mSynthesisWindow;
+	size_t							mFftSize, mHopSize, mHopPos;
+	dsp::WindowType					mWindowType;
+};
+
+} } // namespace cinder::audio
@@ -26,13 +26,25 @@
 #include "cinder/audio/Buffer.h"
 #include "cinder/audio/SampleType.h"
 
+#include "cinder/audio/dsp/RingBuffer.h"
+
 #include "cinder/DataTarget.h"
 
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class TargetFile>		TargetFileRef;
 
-//! Base class that is used to create and write to an audio destination. Currently only supports .wav encoding.
+//! \brief Base class that is used to create and write to an audio destination.
+//!
+//! The encoding is chosen by extension: "ogg" and "flac" are encoded on all platforms, other formats (such as .wav) are handled
+//! by the platform specific implementation. The file is finalized when the TargetFile is destroyed.
+//! \note FLAC has no floating point format, so SampleType::FLOAT_32 is written to "flac" files as 24 bit integers.
 class TargetFile {
   public:
 	static std::unique_ptr<TargetFile> create( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType = SampleType::INT_16, const std::string &extension = "" );
@@ -45,6 +57,7 @@ class TargetFile {
 
 	size_t getSampleRate() const	{ return mSampleRate; }
 	size_t getNumChannels() const	{ return mNumChannels; }
+	SampleType getSampleType() const	{ return mSampleType; }
 
   protected:
 	TargetFile( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType )
@@ -58,4 +71,45 @@ class TargetFile {
 	SampleType		mSampleType;
 };
 
+//! \brief TargetFile that hands its writes off to another TargetFile, which is then written to from a background thread.
+//!
+//! write() copies the samples into a lock-free ring buffer and returns without blocking, so it is safe to call from the audio thread.
+//! If the ring buffer is full, the frames are dropped and counted in getNumDroppedFrames(). All remaining frames are written to the
+//! underlying target when the TargetFileAsync is destroyed.
+class TargetFileAsync : public TargetFile {
+  public:
+	//! Constructs a TargetFileAsync that writes to \a target, buffering up to \a maxBufferedFrames frames (default = one second).
+	TargetFileAsync( std::unique_ptr<TargetFile> &&target, size_t maxBufferedFrames = 0 );
+	virtual ~TargetFileAsync();
+
+	//! Blocks until all frames written so far have been passed to the underlying target. \note Rethrows any exception that occurred while writing on the background thread.
+	void flush();
+
+	//! Returns the number of frames that were dropped because the ring buffer was full.
+	uint64_t	getNumDroppedFrames() const		{ return mNumFramesDropped; }
+	//! Returns the maximum number of frames that can be buffered before writes are dropped.
+	size_t		getMaxBufferedFrames() const	{ return mRingBuffers.empty() ? 0 : mRingBuffers[0].getSize(); }
+	//! Returns the TargetFile that is being written to from the background thread.
+	TargetFile*	getTarget() const				{ return mTarget.get(); }
+
+  protected:
+	void performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset ) override;
+
+  private:
+	void run();
+	void writeAvailable();
+
+	std::unique_ptr<TargetFile>		mTarget;
+	std::vector<dsp::RingBuffer>	mRingBuffers;
+	BufferDynamic					mWriteBuffer;
+
+	std::thread					mThread;
+	std::mutex					mMutex;
+	std::condition_variable		mCondition, mFlushCondition;
+	bool						mRunning;
+	std::exception_ptr			mException;
+
+	std::atomic<uint64_t>		mNumFramesWritten, mNumFramesFlushed, mNumFramesDropped;
+};
+
 } } // namespace cinder::audio
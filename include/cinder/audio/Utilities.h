@@ -48,6 +48,9 @@ float midiToFreq( float midi );
 //! Convert \a timeSeconds to frames running at \a sampleRate, rounding to the nearest integral frame.
 uint64_t timeToFrame( double timeSeconds, double sampleRate );
 
+//! Returns a monotonic timestamp in nanoseconds from the highest resolution clock available. Cheap enough to be called on the audio thread.
+uint64_t getTimestampNanoseconds();
+
 //! Checks if the absolute value of any sample in \a buffer is over \a threshold. Optionally provide \a recordFrame to record the frame index. \return true if one is found, false otherwise. 
 bool thresholdBuffer( const Buffer &buffer, float threshold, size_t *recordFrame = nullptr );
 
@@ -44,6 +44,7 @@ typedef std::shared_ptr<class VoiceSamplePlayerNode> VoiceSamplePlayerNodeRef;
 //! Underneath, playback is managed by a Node, which can be retrieved via the virtual getNode() method to
 //! perform more complex tasks.
 //!
+//! Each Voice builds its own chain of Node's, so for playing many short sounds at once, VoicePoolNode is a better fit.
 class Voice {
   public:
 	//! Optional parameters passed into Voice::create() methods.
@@ -0,0 +1,208 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/InputNode.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/dsp/RingBuffer.h"
+
+#include <mutex>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class VoicePoolNode>		VoicePoolNodeRef;
+
+//! \brief InputNode that plays many short samples at once from a fixed pool of voices, all rendered within a single process() call.
+//!
+//! Unlike Voice, which builds a separate SamplePlayerNode -> GainNode -> Pan2dNode chain for every sound, triggering a sample on a VoicePoolNode
+//! only pushes a small command onto a lock-free queue. All voices are preallocated, so the audio thread never allocates or rewires the graph.
+//! Triggers can be scheduled with sample accuracy, and when all voices are busy one is taken over according to the StealPolicy. Stopped or
+//! stolen voices are faded out over a short period to avoid clicks.
+//!
+//! Samples are registered ahead of time with addSample() or loadSample(). The output has two channels by default, in which case mono samples
+//! are panned with equal power and stereo samples are balanced. Auto-enabled by default, unlike other InputNode's.
+class VoicePoolNode : public InputNode {
+  public:
+	//! Identifies a triggered voice, used to stop it later. Valid ids are never 0.
+	typedef uint64_t VoiceId;
+
+	//! Determines which voice is taken over when a trigger occurs and all voices are busy.
+	enum class StealPolicy {
+		//! Voices are never stolen, the trigger is dropped.
+		NONE,
+		//! The voice that started first is stolen.
+		OLDEST,
+		//! The voice with the lowest gain is stolen.
+		QUIETEST,
+		//! The voice with the lowest priority is stolen, or the oldest of those if there are many. Triggers with a lower priority than all playing voices are dropped.
+		LOWEST_PRIORITY
+	};
+
+	struct Format : public Node::Format {
+		Format() : mMaxVoices( 32 ), mMaxPendingTriggers( 256 ), mStealPolicy( StealPolicy::OLDEST ), mFadeSeconds( 0.005 ) {}
+
+		//! Sets the number of voices that can play at once. Default is 32.
+		Format&		maxVoices( size_t voices )					{ mMaxVoices = voices; return *this; }
+		//! Sets the number of triggers that can be queued (including those scheduled in the future) before more are dropped. Default is 256.
+		Format&		maxPendingTriggers( size_t triggers )		{ mMaxPendingTriggers = triggers; return *this; }
+		//! Sets the policy used when a trigger occurs and all voices are busy. Default is StealPolicy::OLDEST.
+		Format&		stealPolicy( StealPolicy policy )			{ mStealPolicy = policy; return *this; }
+		//! Sets the duration of the fade out applied to stopped or stolen voices. Default is 0.005 seconds.
+		Format&		fadeSeconds( double seconds )				{ mFadeSeconds = seconds; return *this; }
+
+		size_t		getMaxVoices() const						{ return mMaxVoices; }
+		size_t		getMaxPendingTriggers() const				{ return mMaxPendingTriggers; }
+		StealPolicy	getStealPolicy() const						{ return mStealPolicy; }
+		double		getFadeSeconds() const						{ return mFadeSeconds; }
+
+		// reimpl Node::Format
+		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
+		Format&		channelMode( ChannelMode mode )			{ Node::Format::channelMode( mode ); return *this; }
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		size_t		mMaxVoices, mMaxPendingTriggers;
+		StealPolicy	mStealPolicy;
+		double		mFadeSeconds;
+	};
+
+	//! Per-trigger playback options.
+	struct TriggerOptions {
+		TriggerOptions() : mGain( 1 ), mPan( 0.5f ), mPriority( 0 ), mLoop( false ) {}
+
+		//! Sets the linear gain of the voice. Default is 1.
+		TriggerOptions&	gain( float gain )				{ mGain = gain; return *this; }
+		//! Sets the pan position of the voice, from 0 (left) to 1 (right). Default is 0.5 (center). Only used when this Node has two channels.
+		TriggerOptions&	pan( float pos )				{ mPan = pos; return *this; }
+		//! Sets the priority of the voice, used with StealPolicy::LOWEST_PRIORITY. Default is 0.
+		TriggerOptions&	priority( int priority )		{ mPriority = priority; return *this; }
+		//! Sets whether the voice loops until stopped. Default is false.
+		TriggerOptions&	loop( bool b = true )			{ mLoop = b; return *this; }
+
+		float	getGain() const			{ return mGain; }
+		float	getPan() const			{ return mPan; }
+		int		getPriority() const		{ return mPriority; }
+		bool	isLoop() const			{ return mLoop; }
+
+	  protected:
+		float	mGain, mPan;
+		int		mPriority;
+		bool	mLoop;
+	};
+
+	VoicePoolNode( const Format &format = Format() );
+	virtual ~VoicePoolNode();
+
+	//! Registers \a buffer as a sample that can be triggered and returns its index. \a buffer is expected to be at the Context's samplerate.
+	size_t	addSample( const BufferRef &buffer );
+	//! Loads the entire contents of \a sourceFile, converting the samplerate to match the Context if needed, and registers it as a sample. Returns its index.
+	size_t	loadSample( const SourceFileRef &sourceFile );
+	//! Removes all samples, silencing any voices that are playing them.
+	void	clearSamples();
+	//! Returns the number of registered samples.
+	size_t	getNumSamples() const		{ return mNumSamples; }
+
+	//! Plays the sample at \a sampleIndex as soon as possible, returning the id of the new voice (or 0 if it could not be queued). \note Lock-free for the audio thread, but should not be called from it.
+	VoiceId	trigger( size_t sampleIndex, const TriggerOptions &options = TriggerOptions() );
+	//! Plays the sample at \a sampleIndex at exactly \a when seconds, measured against Context::getNumProcessedSeconds(). Times in the past start on the next processing block.
+	VoiceId	trigger( size_t sampleIndex, double when, const TriggerOptions &options = TriggerOptions() );
+	//! Fades out and stops the voice identified by \a voiceId, or cancels it if it hasn't started yet. Does nothing if the voice has already finished. Returns false if the command queue is full.
+	bool	stop( VoiceId voiceId );
+	//! Fades out and stops all voices, and cancels all pending triggers. Returns false if the command queue is full.
+	bool	stopAll();
+
+	//! Returns the maximum number of voices that can play at once.
+	size_t		getMaxVoices() const				{ return mVoices.size(); }
+	//! Returns the number of voices that are currently playing.
+	size_t		getNumActiveVoices() const			{ return mNumActiveVoices; }
+	//! Returns the StealPolicy used when all voices are busy.
+	StealPolicy	getStealPolicy() const				{ return mStealPolicy; }
+	//! Returns the number of voices that have been stolen since this Node was created.
+	uint64_t	getNumStolenVoices() const			{ return mNumStolenVoices; }
+	//! Returns the number of triggers that were dropped since this Node was created, either because the queue was full or no voice could be stolen.
+	uint64_t	getNumDroppedTriggers() const		{ return mNumDroppedTriggers; }
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	enum class CommandType { TRIGGER, STOP, STOP_ALL };
+
+	// POD, passed from the user thread to the audio thread with a RingBufferT.
+	struct Command {
+		CommandType	mType;
+		VoiceId		mVoiceId;
+		size_t		mSampleIndex;
+		uint64_t	mStartFrame;
+		float		mGain, mPan;
+		int			mPriority;
+		bool		mLoop;
+	};
+
+	// All state is owned by the audio thread. A voice slot is free when mSample is null.
+	struct VoiceState {
+		VoiceId			mId;
+		const Buffer	*mSample;
+		size_t			mReadPos;
+		uint64_t		mStartFrame;	// absolute frame, measured against Context::getNumProcessedFrames()
+		float			mGain, mGainLeft, mGainRight;
+		int				mPriority;
+		bool			mLoop;
+
+		// a voice that was stopped or stolen from this slot, faded out while the slot plays something else
+		const Buffer	*mFadeSample;
+		size_t			mFadeReadPos, mFadeFramesLeft;
+		uint64_t		mFadeStartFrame;
+		float			mFadeGainLeft, mFadeGainRight;
+		bool			mFadeLoop;
+	};
+
+	VoiceId		pushTrigger( size_t sampleIndex, uint64_t startFrame, const TriggerOptions &options );
+	bool		pushCommand( const Command &command );
+	void		processCommands( uint64_t frame, Buffer *buffer );
+	void		startVoice( const Command &trigger, size_t frameOffset, Buffer *buffer );
+	VoiceState*	findVoice( int priority );
+	void		fadeOutVoice( VoiceState *voice, uint64_t frame, Buffer *buffer );
+	void		renderVoice( VoiceState *voice, size_t frameEnd, Buffer *buffer );
+	void		renderFade( VoiceState *voice, size_t frameEnd, Buffer *buffer );
+
+	std::vector<BufferRef>			mSamples;
+	std::vector<VoiceState>			mVoices;
+	std::vector<Command>			mPendingTriggers;	// capacity reserved up front, only modified on the audio thread
+	dsp::RingBufferT<Command>		mCommands;
+	std::mutex						mCommandWriteMutex;	// serializes writers, the ring buffer is single-producer
+	StealPolicy						mStealPolicy;
+	double							mFadeSeconds;
+	size_t							mFadeFrames, mMaxPendingTriggers;
+	VoiceId							mNextVoiceId;		// guarded by mCommandWriteMutex
+	uint64_t						mBlockFrame;		// Context frame at the beginning of the current processing block
+
+	std::atomic<size_t>				mNumSamples;		// mirrors mSamples.size() for the user threads, which can't read mSamples without the Context's mutex
+	std::atomic<size_t>				mNumActiveVoices;
+	std::atomic<uint64_t>			mNumStolenVoices, mNumDroppedTriggers;
+};
+
+} } // namespace cinder::audio
@@ -29,6 +29,7 @@
 #include "cinder/audio/Device.h"
 #include "cinder/audio/Exception.h"
 #include "cinder/audio/Param.h"
+#include "cinder/audio/SampleCache.h"
 #include "cinder/audio/Source.h"
 #include "cinder/audio/Target.h"
 #include "cinder/audio/Utilities.h"
@@ -46,10 +47,12 @@
 #include "cinder/audio/OutputNode.h"
 #include "cinder/audio/SamplePlayerNode.h"
 #include "cinder/audio/SampleRecorderNode.h"
+#include "cinder/audio/VoicePoolNode.h"
 
 // audio::dsp
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/Biquad.h"
 #include "cinder/audio/dsp/Converter.h"
+#include "cinder/audio/dsp/Convolver.h"
 #include "cinder/audio/dsp/Fft.h"
 #include "cinder/audio/dsp/RingBuffer.h"
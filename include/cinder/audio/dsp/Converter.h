@@ -33,8 +33,20 @@ namespace cinder { namespace audio { namespace dsp {
 //! A platform-specific converter that supports samplerate and channel conversion.
 class Converter {
   public:
-	//! If \a destSampleRate is 0, it is set to match \a sourceSampleRate. If \a destNumChannels is 0, it is set to match \a sourceNumChannels.
-	static std::unique_ptr<Converter> create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock );
+	//! Selects the samplerate conversion algorithm, trading quality for speed and latency.
+	enum class Quality {
+		//! Linear interpolation. Cheapest, one frame of latency but audible aliasing and high frequency loss.
+		LINEAR,
+		//! Four-point cubic (Catmull-Rom) interpolation. Still very cheap, with less high frequency loss than LINEAR.
+		CUBIC,
+		//! Kaiser-windowed sinc interpolation with a polyphase kernel. Suitable for live input, with a latency of 16 source frames (more when downsampling).
+		SINC,
+		//! The platform's highest quality converter (r8brain, or CoreAudio on OS X and iOS). Expensive and has the most latency.
+		BEST
+	};
+
+	//! If \a destSampleRate is 0, it is set to match \a sourceSampleRate. If \a destNumChannels is 0, it is set to match \a sourceNumChannels. \a quality selects the algorithm (default = Quality::BEST).
+	static std::unique_ptr<Converter> create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality = Quality::BEST );
 
 	virtual ~Converter() {}
 
@@ -0,0 +1,68 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/dsp/Converter.h"
+
+#include <vector>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief \a Converter implementation that resamples with linear, cubic or windowed-sinc interpolation.
+//!
+//! All channels are processed in one pass, sharing the interpolation kernel. The ratio between source and destination samplerates
+//! can also be scaled while running with setRate(), which is useful for varispeed playback. Unlike other Converter's, convert() may
+//! consume less than the provided number of source frames if \a destBuffer is full, which can happen when the rate is below 1.
+class ConverterImplResampler : public Converter {
+  public:
+	ConverterImplResampler( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality = Quality::SINC );
+
+	std::pair<size_t, size_t>	convert( const Buffer *sourceBuffer, Buffer *destBuffer )	override;
+	void						clear()														override;
+
+	//! Scales the rate that source frames are consumed at by \a rate (default = 1), gliding to it over \a rampFrames destination frames. Values above 1 raise the pitch.
+	//! \note The sinc kernel's cutoff is designed for a rate of 1, so rates above 1 may introduce some aliasing.
+	void	setRate( double rate, size_t rampFrames = 0 );
+	//! Returns the rate that is set or being ramped towards.
+	double	getRate() const				{ return mTargetRate; }
+	//! Returns the interpolation quality, which is never Quality::BEST.
+	Quality	getQuality() const			{ return mQuality; }
+	//! Returns the number of source frames that are needed ahead of the current output position, which is the latency of this Converter.
+	size_t	getLatencyFrames() const	{ return mNumTaps / 2; }
+
+  private:
+	void	setupSincKernel();
+	size_t	resample( Buffer *destBuffer, size_t maxNumFrames );
+
+	Quality				mQuality;
+	size_t				mNumTaps;
+	std::vector<float>	mKernel, mBlendedKernel;	// mKernel contains SINC_NUM_PHASES + 1 rows of mNumTaps coefficients
+
+	Buffer				mHistory, mMixingBuffer;
+	size_t				mNumHistoryFrames;
+	double				mPos, mBaseStep, mStep, mTargetStep, mStepIncrement, mTargetRate;
+	size_t				mNumRampFramesRemaining;
+};
+
+} } } // namespace cinder::audio::dsp
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Buffer.h"
+
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace audio { namespace dsp {
+
+class Fft;
+
+typedef std::shared_ptr<const class ConvolutionKernel>	ConvolutionKernelRef;
+
+//! \brief Frequency-domain partitions of an impulse response, as consumed by Convolver.
+//!
+//! The impulse response is split into uniform partitions of \a partitionSize frames, each of which is zero-padded to twice its length and transformed once up front.
+//! A ConvolutionKernel is immutable after construction, so a single instance can be shared between any number of Convolver's (ex. one per channel).
+class ConvolutionKernel {
+  public:
+	//! Constructs a kernel from \a length samples of \a impulseResponse, split into partitions of \a partitionSize frames. \a partitionSize must be a power of two.
+	ConvolutionKernel( const float *impulseResponse, size_t length, size_t partitionSize );
+
+	//! Returns the number of frames in each partition.
+	size_t	getPartitionSize() const		{ return mPartitionSize; }
+	//! Returns the number of partitions.
+	size_t	getNumPartitions() const		{ return mPartitions.size(); }
+	//! Returns the transformed partition at \a index.
+	const BufferSpectral&	getPartition( size_t index ) const	{ return mPartitions[index]; }
+
+  private:
+	size_t						mPartitionSize;
+	std::vector<BufferSpectral>	mPartitions;
+};
+
+//! \brief Uniformly partitioned overlap-save (UPOLS) convolution of a single channel.
+//!
+//! Processing is done with a frequency-domain delay line, so the cost per partition is one complex multiply-accumulate rather than a time-domain FIR.
+//! process() can be called with any number of frames; output is produced for every input sample so no latency is added, although it is most efficient
+//! when called with exactly getPartitionSize() frames. Heap allocations only happen at construction.
+class Convolver {
+  public:
+	//! Constructs a Convolver that filters with \a kernel.
+	Convolver( const ConvolutionKernelRef &kernel );
+	~Convolver();
+
+	//! Convolves \a numFrames samples of \a input with the kernel, writing the result to \a output. \a input and \a output can be the same.
+	void process( const float *input, float *output, size_t numFrames );
+	//! Clears all input history and pending output.
+	void reset();
+
+	//! Returns the number of frames in each partition.
+	size_t	getPartitionSize() const	{ return mPartitionSize; }
+	//! Returns the kernel used by this Convolver.
+	const ConvolutionKernelRef&	getKernel() const	{ return mKernel; }
+
+  private:
+	ConvolutionKernelRef		mKernel;
+	std::unique_ptr<Fft>		mFft;
+	size_t						mPartitionSize, mInputFill, mCurrentSegment;
+	Buffer						mInputBuffer, mOutputBuffer;	// time domain, twice the partition size
+	std::vector<BufferSpectral>	mSegments;						// frequency-domain delay line, one per partition
+	BufferSpectral				mPreMultiplied, mConvolved;
+};
+
+//! Multiplies the spectra \a a and \a b and adds the result to \a accum. All buffers are expected to be in the packed format produced by Fft::forward().
+void multiplyAccumulateSpectral( const BufferSpectral &a, const BufferSpectral &b, BufferSpectral *accum );
+
+} } } // namespace cinder::audio::dsp
@@ -28,20 +28,60 @@
 
 #include "cinder/Cinder.h"
 
+#include <memory>
 #include <vector>
 
 #if defined( CINDER_AUDIO_VDSP )
 	#include <Accelerate/Accelerate.h>
-#else
-	#define CINDER_AUDIO_FFT_OOURA
 #endif
 
 namespace cinder { namespace audio { namespace dsp {
 
-//! Real Discrete Fourier Transform (DFT).
+typedef std::shared_ptr<const class FftPlan>	FftPlanRef;
+
+//! \brief Precomputed factorization and twiddle factors for a real DFT of a given size.
+//!
+//! FftPlan's are immutable and cached by size, so all Fft instances of the same size share one. Sizes must be even and
+//! half the size must factor into 2, 3 and 5 (ex. 480, 1000, 1024 and 1536 are all supported).
+class FftPlan {
+  public:
+	//! Returns the shared plan for \a fftSize, creating it if necessary. Thread-safe, but creation allocates so avoid calling this from the audio thread.
+	static FftPlanRef	get( size_t fftSize );
+	//! Returns true if an FftPlan can be created for \a fftSize.
+	static bool			isSizeSupported( size_t fftSize );
+	//! Returns the smallest supported size that is greater than or equal to \a fftSize.
+	static size_t		getNextSupportedSize( size_t fftSize );
+
+	//! Returns the size of the real transform.
+	size_t	getSize() const		{ return mSize; }
+
+	// Used internally, describes one pass of the complex transform of half size.
+	struct Stage {
+		size_t mRadix, mNumButterflies, mStride, mTwiddleOffset;
+	};
+
+	//! Constructs a plan for \a fftSize directly, bypassing the cache. Prefer get().
+	FftPlan( size_t fftSize );
+
+  private:
+	size_t				mSize, mComplexSize;
+	std::vector<Stage>	mStages;
+	std::vector<float>	mTwiddlesReal, mTwiddlesImag;	// per stage, consumed in order by the complex transform
+	std::vector<float>	mPostTwiddlesReal, mPostTwiddlesImag;	// used to split the half size complex transform into the real spectrum
+
+	friend class Fft;
+};
+
+//! \brief Real Discrete Fourier Transform (DFT).
+//!
+//! Uses a mixed-radix (2, 3, 4 and 5) Stockham transform whose butterflies are vectorized with SSE or NEON where available. Precomputed tables
+//! are shared between instances through FftPlan, while each Fft owns its scratch memory, so forward() and inverse() never allocate and separate
+//! instances can be used concurrently from different threads. On platforms with Accelerate, power-of-two sizes use vDSP instead.
+//!
+//! Spectral data is packed into getSize() / 2 bins, where the real part of bin 0 is the DC component and the imaginary part of bin 0 is the Nyquist component.
 class Fft {
   public:
-	//! Constructs an Fft object. \a fftSize must be a power of two and greater than two.
+	//! Constructs an Fft object. \a fftSize must be supported by FftPlan, which includes all powers of two greater than or equal to two.
 	Fft( size_t fftSize );
 	~Fft();
 
@@ -49,22 +89,30 @@ class Fft {
 	void forward( const Buffer *waveform, BufferSpectral *spectral );
 	//! Computes the Inverse DFT of \a spectral, filling \a waveform with time-domain audio data
 	void inverse( const BufferSpectral *spectral, Buffer *waveform );
+	//! Computes the Forward DFT of each channel in \a waveforms, filling the corresponding element of \a spectra, which must point to an array of at least waveforms->getNumChannels() BufferSpectral's.
+	//! Channels are transformed four at a time in separate vector lanes, which is faster than transforming them one by one.
+	void forwardBatch( const Buffer *waveforms, BufferSpectral *spectra );
+	//! Computes the Inverse DFT of each element in \a spectra, filling the corresponding channel of \a waveforms. \see forwardBatch()
+	void inverseBatch( const BufferSpectral *spectra, Buffer *waveforms );
 	//! Returns the size of the FFT.
 	size_t getSize() const	{ return mSize; }
 
   protected:
 	void init();
 
+	void forwardImpl( const float *waveform, float *real, float *imag );
+	void inverseImpl( const float *real, const float *imag, float *waveform );
+	void forwardBatchImpl( const float *const *waveforms, BufferSpectral *const *spectra );
+	void inverseBatchImpl( const BufferSpectral *const *spectra, float *const *waveforms );
+
 	size_t				mSize, mSizeOverTwo;
+	FftPlanRef			mPlan;
+	std::vector<float>	mScratch;
 
 #if defined( CINDER_AUDIO_VDSP )
 	size_t				mLog2FftSize;
 	::FFTSetup			mFftSetup;
 	::DSPSplitComplex	mSplitComplexSignal, mSplitComplexResult;
-#elif defined( CINDER_AUDIO_FFT_OOURA )
-	Buffer				mBufferCopy;
-	int					*mOouraIp;
-	float				*mOouraW;
 #endif
 };
 
@@ -0,0 +1,156 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+	#define CINDER_AUDIO_SIMD_SSE
+	#include <emmintrin.h>
+#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+	#define CINDER_AUDIO_SIMD_NEON
+	#include <arm_neon.h>
+#endif
+
+#include <cstdint>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief Four packed floats, used by the vectorized dsp routines.
+//!
+//! Maps to SSE2 or NEON registers when available, otherwise falls back to plain arrays that compilers can still auto-vectorize.
+//! Loads and stores are unaligned, so any float array can be used.
+struct Float4 {
+	Float4()	{}
+
+#if defined( CINDER_AUDIO_SIMD_SSE )
+	explicit Float4( float scalar ) : mValue( _mm_set1_ps( scalar ) )	{}
+	Float4( __m128 value ) : mValue( value )							{}
+
+	static Float4	load( const float *array )		{ return _mm_loadu_ps( array ); }
+	void			store( float *array ) const		{ _mm_storeu_ps( array, mValue ); }
+
+	Float4	operator+( const Float4 &rhs ) const	{ return _mm_add_ps( mValue, rhs.mValue ); }
+	Float4	operator-( const Float4 &rhs ) const	{ return _mm_sub_ps( mValue, rhs.mValue ); }
+	Float4	operator*( const Float4 &rhs ) const	{ return _mm_mul_ps( mValue, rhs.mValue ); }
+
+	__m128	mValue;
+#elif defined( CINDER_AUDIO_SIMD_NEON )
+	explicit Float4( float scalar ) : mValue( vdupq_n_f32( scalar ) )	{}
+	Float4( float32x4_t value ) : mValue( value )						{}
+
+	static Float4	load( const float *array )		{ return vld1q_f32( array ); }
+	void			store( float *array ) const		{ vst1q_f32( array, mValue ); }
+
+	Float4	operator+( const Float4 &rhs ) const	{ return vaddq_f32( mValue, rhs.mValue ); }
+	Float4	operator-( const Float4 &rhs ) const	{ return vsubq_f32( mValue, rhs.mValue ); }
+	Float4	operator*( const Float4 &rhs ) const	{ return vmulq_f32( mValue, rhs.mValue ); }
+
+	float32x4_t	mValue;
+#else
+	explicit Float4( float scalar )					{ mValue[0] = mValue[1] = mValue[2] = mValue[3] = scalar; }
+
+	static Float4	load( const float *array )		{ Float4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = array[i]; return result; }
+	void			store( float *array ) const		{ for( int i = 0; i < 4; i++ ) array[i] = mValue[i]; }
+
+	Float4	operator+( const Float4 &rhs ) const	{ Float4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = mValue[i] + rhs.mValue[i]; return result; }
+	Float4	operator-( const Float4 &rhs ) const	{ Float4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = mValue[i] - rhs.mValue[i]; return result; }
+	Float4	operator*( const Float4 &rhs ) const	{ Float4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = mValue[i] * rhs.mValue[i]; return result; }
+
+	float	mValue[4];
+#endif
+
+	Float4	operator*( float rhs ) const			{ return *this * Float4( rhs ); }
+	//! Returns the sum of all four elements.
+	float	sum() const								{ float values[4]; store( values ); return ( values[0] + values[1] ) + ( values[2] + values[3] ); }
+	Float4&	operator+=( const Float4 &rhs )			{ return *this = *this + rhs; }
+	Float4&	operator-=( const Float4 &rhs )			{ return *this = *this - rhs; }
+	Float4&	operator*=( const Float4 &rhs )			{ return *this = *this * rhs; }
+};
+
+//! \brief Four packed 32-bit unsigned integers, used alongside Float4 for fixed-point phase accumulators and table indices.
+//!
+//! Addition wraps around modulo 2^32. Conversions to and from Float4 treat the values as signed.
+struct Int4 {
+	Int4()	{}
+
+#if defined( CINDER_AUDIO_SIMD_SSE )
+	explicit Int4( uint32_t scalar ) : mValue( _mm_set1_epi32( int( scalar ) ) )	{}
+	Int4( __m128i value ) : mValue( value )											{}
+
+	static Int4		load( const uint32_t *array )		{ return _mm_loadu_si128( reinterpret_cast<const __m128i *>( array ) ); }
+	void			store( uint32_t *array ) const		{ _mm_storeu_si128( reinterpret_cast<__m128i *>( array ), mValue ); }
+
+	Int4	operator+( const Int4 &rhs ) const		{ return _mm_add_epi32( mValue, rhs.mValue ); }
+	Int4	operator&( const Int4 &rhs ) const		{ return _mm_and_si128( mValue, rhs.mValue ); }
+	//! Logical right shift of each element by \a bits.
+	Int4	shiftRight( int bits ) const			{ return _mm_srl_epi32( mValue, _mm_cvtsi32_si128( bits ) ); }
+	Float4	toFloat() const							{ return _mm_cvtepi32_ps( mValue ); }
+	//! Converts \a value to integers, truncating towards zero.
+	static Int4	fromFloat( const Float4 &value )	{ return _mm_cvttps_epi32( value.mValue ); }
+
+	__m128i	mValue;
+#elif defined( CINDER_AUDIO_SIMD_NEON )
+	explicit Int4( uint32_t scalar ) : mValue( vdupq_n_u32( scalar ) )	{}
+	Int4( uint32x4_t value ) : mValue( value )							{}
+
+	static Int4		load( const uint32_t *array )		{ return vld1q_u32( array ); }
+	void			store( uint32_t *array ) const		{ vst1q_u32( array, mValue ); }
+
+	Int4	operator+( const Int4 &rhs ) const		{ return vaddq_u32( mValue, rhs.mValue ); }
+	Int4	operator&( const Int4 &rhs ) const		{ return vandq_u32( mValue, rhs.mValue ); }
+	//! Logical right shift of each element by \a bits.
+	Int4	shiftRight( int bits ) const			{ return vshlq_u32( mValue, vdupq_n_s32( -bits ) ); }
+	Float4	toFloat() const							{ return vcvtq_f32_s32( vreinterpretq_s32_u32( mValue ) ); }
+	//! Converts \a value to integers, truncating towards zero.
+	static Int4	fromFloat( const Float4 &value )	{ return vreinterpretq_u32_s32( vcvtq_s32_f32( value.mValue ) ); }
+
+	uint32x4_t	mValue;
+#else
+	explicit Int4( uint32_t scalar )				{ mValue[0] = mValue[1] = mValue[2] = mValue[3] = scalar; }
+
+	static Int4		load( const uint32_t *array )		{ Int4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = array[i]; return result; }
+	void			store( uint32_t *array ) const		{ for( int i = 0; i < 4; i++ ) array[i] = mValue[i]; }
+
+	Int4	operator+( const Int4 &rhs ) const		{ Int4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = mValue[i] + rhs.mValue[i]; return result; }
+	Int4	operator&( const Int4 &rhs ) const		{ Int4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = mValue[i] & rhs.mValue[i]; return result; }
+	//! Logical right shift of each element by \a bits.
+	Int4	shiftRight( int bits ) const			{ Int4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = mValue[i] >> bits; return result; }
+	Float4	toFloat() const							{ Float4 result; for( int i = 0; i < 4; i++ ) result.mValue[i] = (float)int32_t( mValue[i] ); return result; }
+	//! Converts \a value to integers, truncating towards zero. Out of range values are clamped.
+	static Int4	fromFloat( const Float4 &value )
+	{
+		Int4 result;
+		for( int i = 0; i < 4; i++ ) {
+			const float x = value.mValue[i];
+			result.mValue[i] = uint32_t( x >= 2147483520.0f ? INT32_MAX : ( x <= -2147483648.0f ? INT32_MIN : int32_t( x ) ) );
+		}
+		return result;
+	}
+
+	uint32_t	mValue[4];
+#endif
+
+	Int4&	operator+=( const Int4 &rhs )			{ return *this = *this + rhs; }
+};
+
+} } } // namespace cinder::audio::dsp
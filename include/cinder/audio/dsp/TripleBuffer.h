@@ -0,0 +1,105 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief Publishes values of type \a T from one writer thread to any number of reader threads, without locking.
+//!
+//! Three copies of \a T are kept. The writer fills a copy that is neither the latest nor being read and publishes it with a single atomic store.
+//! Readers mark the latest copy as in use while copying it out, so they always see a complete value and never block the writer or each other.
+//! If readers are still busy with both other copies, beginWrite() returns null and the writer should skip that update.
+template <typename T>
+class TripleBuffer {
+  public:
+	TripleBuffer() : mLatest( -1 ), mWriteIndex( 0 ), mNumPublished( 0 )
+	{
+		for( int i = 0; i < 3; i++ )
+			mNumReaders[i] = 0;
+	}
+
+	//! Returns a copy that can be filled by the writer, or null if none is available. Its previous contents are an older value, so it must be completely rewritten.
+	//! \note Only safe to call from the writer thread. \see endWrite()
+	T* beginWrite()
+	{
+		const int latest = mLatest;
+		for( int i = 0; i < 3; i++ ) {
+			if( i != latest && mNumReaders[i] == 0 ) {
+				mWriteIndex = i;
+				return &mValues[i];
+			}
+		}
+
+		return nullptr;
+	}
+	//! Publishes the copy returned by the last successful call to beginWrite(). \note Only safe to call from the writer thread.
+	void endWrite()
+	{
+		mLatest = mWriteIndex;
+		mNumPublished++;
+	}
+
+	//! Copies the latest published value into \a result. \return false if nothing has been published yet. \note Safe to call from any thread.
+	bool read( T *result ) const
+	{
+		return visit( [result]( const T &value ) { *result = value; } );
+	}
+
+	//! Calls \a fn with a const reference to the latest published value, which is kept from being overwritten until \a fn returns.
+	//! Useful for copying only part of the value. \return false if nothing has been published yet. \note Safe to call from any thread.
+	template <typename FnT>
+	bool visit( const FnT &fn ) const
+	{
+		for( ;; ) {
+			const int latest = mLatest;
+			if( latest < 0 )
+				return false;
+
+			// Mark the copy as in use, then make sure it is still the latest. If it isn't, the writer may have picked it before it was marked.
+			mNumReaders[latest]++;
+			if( mLatest == latest ) {
+				fn( mValues[latest] );
+				mNumReaders[latest]--;
+				return true;
+			}
+
+			mNumReaders[latest]--;
+		}
+	}
+
+	//! Returns the number of values that have been published, which can be used by readers to check for new values.
+	uint64_t getNumPublished() const	{ return mNumPublished; }
+
+  private:
+	T						mValues[3];
+	mutable std::atomic<int> mNumReaders[3];
+	std::atomic<int>		mLatest;
+	int						mWriteIndex;
+	std::atomic<uint64_t>	mNumPublished;
+};
+
+} } } // namespace cinder::audio::dsp
@@ -34,6 +34,7 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/ImageTargetFileStbImage.cpp
 	${CINDER_SRC_DIR}/cinder/Json.cpp
 	${CINDER_SRC_DIR}/cinder/Log.cpp
+	${CINDER_SRC_DIR}/cinder/MappedFile.cpp
 	${CINDER_SRC_DIR}/cinder/Matrix.cpp
 	${CINDER_SRC_DIR}/cinder/ObjLoader.cpp
 	${CINDER_SRC_DIR}/cinder/Path2d.cpp
@@ -55,6 +56,7 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/Timer.cpp
 	${CINDER_SRC_DIR}/cinder/Triangulate.cpp
 	${CINDER_SRC_DIR}/cinder/TriMesh.cpp
+	${CINDER_SRC_DIR}/cinder/TriMeshBvh.cpp
 	${CINDER_SRC_DIR}/cinder/Tween.cpp
 	${CINDER_SRC_DIR}/cinder/Unicode.cpp
 	${CINDER_SRC_DIR}/cinder/Url.cpp
@@ -101,9 +103,11 @@ source_group( "cinder\\app" FILES   ${SRC_SET_CINDER_APP} )
 list( APPEND SRC_SET_CINDER_AUDIO
 	${CINDER_SRC_DIR}/cinder/audio/ChannelRouterNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Context.cpp
+	${CINDER_SRC_DIR}/cinder/audio/ConvolutionNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/DelayNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Device.cpp
 	${CINDER_SRC_DIR}/cinder/audio/FileOggVorbis.cpp
+	${CINDER_SRC_DIR}/cinder/audio/FileFlac.cpp
 	${CINDER_SRC_DIR}/cinder/audio/FilterNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/GenNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/InputNode.cpp
@@ -114,14 +118,20 @@ list( APPEND SRC_SET_CINDER_AUDIO
 	${CINDER_SRC_DIR}/cinder/audio/PanNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Param.cpp
 	${CINDER_SRC_DIR}/cinder/audio/SamplePlayerNode.cpp
+	${CINDER_SRC_DIR}/cinder/audio/SpectralNode.cpp
+	${CINDER_SRC_DIR}/cinder/audio/SpatialNode.cpp
+	${CINDER_SRC_DIR}/cinder/audio/SampleCache.cpp
 	${CINDER_SRC_DIR}/cinder/audio/SampleRecorderNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Source.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Target.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Utilities.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Voice.cpp
+	${CINDER_SRC_DIR}/cinder/audio/VoicePoolNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/WaveTable.cpp
 	${CINDER_SRC_DIR}/cinder/audio/dsp/Biquad.cpp
 	${CINDER_SRC_DIR}/cinder/audio/dsp/Converter.cpp
+	${CINDER_SRC_DIR}/cinder/audio/dsp/ConverterResampler.cpp
+	${CINDER_SRC_DIR}/cinder/audio/dsp/Convolver.cpp
 	${CINDER_SRC_DIR}/cinder/audio/dsp/Dsp.cpp
 	${CINDER_SRC_DIR}/cinder/audio/dsp/Fft.cpp
 )
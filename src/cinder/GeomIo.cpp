@@ -31,7 +31,10 @@
 #include "cinder/BSpline.h"
 #include "cinder/Matrix.h"
 #include "cinder/Sphere.h"
+#include "cinder/Utilities.h"
 #include <algorithm>
+#include <functional>
+#include <limits>
 
 #if defined( CINDER_ANDROID )
   #include "cinder/app/App.h"
@@ -374,10 +377,9 @@ void copyIndexDataForceTrianglesImpl( Primitive primitive, const uint32_t *sourc
 // Terathon Software 3D Graphics Library, 2001.
 // http://www.terathon.com/code/tangent.html
 template<typename TEXTYPE>
-void calculateTangentsImpl( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const TEXTYPE *texCoords, vector<vec3> *resultTangents, vector<vec3> *resultBitangents )
+void calculateTangentsImpl( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const TEXTYPE *texCoords, vec3 *resultTangents, vec3 *resultBitangents )
 {
-	if( resultTangents )
-		resultTangents->assign( numVertices, vec3( 0 ) );
+	std::fill( resultTangents, resultTangents + numVertices, vec3( 0 ) );
 
 	size_t numTriangles = numIndices / 3;
 	for( size_t i = 0; i < numTriangles; ++i ) {
@@ -410,28 +412,37 @@ void calculateTangentsImpl( size_t numIndices, const uint32_t *indices, size_t n
 
 		vec3 tangent( (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r );
 
-		(*resultTangents)[index0] += tangent;
-		(*resultTangents)[index1] += tangent;
-		(*resultTangents)[index2] += tangent;
+		resultTangents[index0] += tangent;
+		resultTangents[index1] += tangent;
+		resultTangents[index2] += tangent;
 	}
 
 	for( size_t i = 0; i < numVertices; ++i ) {
 		vec3 normal = normals[i];
-		vec3 tangent = (*resultTangents)[i];
-		(*resultTangents)[i] = ( tangent - normal * dot( normal, tangent ) );
+		vec3 tangent = resultTangents[i];
+		resultTangents[i] = ( tangent - normal * dot( normal, tangent ) );
 
-		float len = length2( (*resultTangents)[i] );
+		float len = length2( resultTangents[i] );
 		if( len > 0.0f )
-			(*resultTangents)[i] /= sqrt( len );
+			resultTangents[i] /= sqrt( len );
 	}
 
 	if( resultBitangents ) {
-		resultBitangents->reserve( numVertices );
 		for( size_t i = 0; i < numVertices; ++i )
-			resultBitangents->emplace_back( normalize( cross( normals[i], (*resultTangents)[i] ) ) );
+			resultBitangents[i] = normalize( cross( normals[i], resultTangents[i] ) );
 	}
 }
 
+template<typename TEXTYPE>
+void calculateTangentsImpl( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const TEXTYPE *texCoords, vector<vec3> *resultTangents, vector<vec3> *resultBitangents )
+{
+	resultTangents->resize( numVertices );
+	if( resultBitangents )
+		resultBitangents->resize( numVertices );
+
+	calculateTangentsImpl( numIndices, indices, numVertices, positions, normals, texCoords, resultTangents->data(), resultBitangents ? resultBitangents->data() : nullptr );
+}
+
 } // anonymous namespace
 
 void calculateTangents( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const vec2 *texCoords, vector<vec3> *resultTangents, vector<vec3> *resultBitangents )
@@ -444,6 +455,323 @@ void calculateTangents( size_t numIndices, const uint32_t *indices, size_t numVe
 	calculateTangentsImpl( numIndices, indices, numVertices, positions, normals, texCoords, resultTangents, resultBitangents );
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+// Index optimization
+namespace {
+
+// Simulates a FIFO post-transform cache by timestamping vertices as they're added; a vertex stays cached until cacheSize others have been added after it
+class VertexCacheSim {
+  public:
+	VertexCacheSim( size_t numVertices, size_t cacheSize )
+		: mCacheTimes( numVertices, 0 ), mCacheSize( cacheSize ), mTime( cacheSize + 1 )
+	{}
+
+	bool	isCached( uint32_t vertex ) const		{ return mTime - mCacheTimes[vertex] <= mCacheSize; }
+	size_t	getAge( uint32_t vertex ) const			{ return mTime - mCacheTimes[vertex]; }
+	size_t	getCacheSize() const					{ return mCacheSize; }
+	// empties the cache
+	void	flush()									{ mTime += mCacheSize + 1; }
+
+	// returns the number of vertices of the triangle which missed the cache
+	size_t addTriangle( const uint32_t *triangle )
+	{
+		size_t numMisses = 0;
+		for( size_t c = 0; c < 3; ++c ) {
+			if( ! isCached( triangle[c] ) ) {
+				mCacheTimes[triangle[c]] = mTime++;
+				++numMisses;
+			}
+		}
+		return numMisses;
+	}
+
+  private:
+	vector<size_t>	mCacheTimes;
+	size_t			mCacheSize, mTime;
+};
+
+/* Tipsify (Sander, Nehab & Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007). Emits all the remaining triangles
+   around a fanning vertex, then moves on to the neighbor that has been cached the longest while still staying in the cache for all of its remaining
+   triangles. Runs in time linear in the number of indices, independent of the cache size. */
+void tipsify( size_t numTriangles, const uint32_t *indices, size_t numVertices, size_t cacheSize, uint32_t *result )
+{
+	// the triangles using each vertex
+	vector<uint32_t> offsets( numVertices + 1, 0 );
+	for( size_t i = 0; i < numTriangles * 3; ++i )
+		++offsets[indices[i] + 1];
+	for( size_t v = 0; v < numVertices; ++v )
+		offsets[v + 1] += offsets[v];
+
+	vector<uint32_t> triangles( numTriangles * 3 ), fill( offsets.begin(), offsets.end() - 1 );
+	for( size_t i = 0; i < numTriangles * 3; ++i )
+		triangles[fill[indices[i]]++] = uint32_t( i / 3 );
+
+	vector<uint32_t> liveTriangles( numVertices );
+	for( size_t v = 0; v < numVertices; ++v )
+		liveTriangles[v] = offsets[v + 1] - offsets[v];
+
+	const uint32_t noVertex = numeric_limits<uint32_t>::max();
+	VertexCacheSim cache( numVertices, cacheSize );
+	vector<uint8_t> emitted( numTriangles, 0 );
+	vector<uint32_t> deadEnd, candidates;
+	deadEnd.reserve( numTriangles * 3 );
+	uint32_t cursor = 0, fanning = numTriangles ? indices[0] : noVertex;
+	size_t numResult = 0;
+	while( fanning != noVertex ) {
+		candidates.clear();
+		for( uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; ++a ) {
+			const uint32_t t = triangles[a];
+			if( emitted[t] )
+				continue;
+
+			const uint32_t *triangle = &indices[t * 3];
+			for( size_t c = 0; c < 3; ++c ) {
+				result[numResult++] = triangle[c];
+				deadEnd.push_back( triangle[c] );
+				candidates.push_back( triangle[c] );
+				--liveTriangles[triangle[c]];
+			}
+			cache.addTriangle( triangle );
+			emitted[t] = 1;
+		}
+
+		// prefer the oldest neighbor which stays cached through its remaining triangles, then any neighbor with triangles left
+		fanning = noVertex;
+		size_t bestPriority = 0;
+		for( uint32_t v : candidates ) {
+			if( ! liveTriangles[v] )
+				continue;
+
+			const size_t priority = ( cache.getAge( v ) + 2 * liveTriangles[v] <= cacheSize ) ? cache.getAge( v ) : 0;
+			if( fanning == noVertex || priority > bestPriority ) {
+				fanning = v;
+				bestPriority = priority;
+			}
+		}
+
+		// at a dead end, fall back on the most recently used vertex with triangles left, then the next one in order
+		while( fanning == noVertex && ! deadEnd.empty() ) {
+			if( liveTriangles[deadEnd.back()] )
+				fanning = deadEnd.back();
+			deadEnd.pop_back();
+		}
+		for( ; fanning == noVertex && cursor < numVertices; ++cursor ) {
+			if( liveTriangles[cursor] )
+				fanning = cursor;
+		}
+	}
+}
+
+} // anonymous namespace
+
+float calcAcmr( size_t numIndices, const uint32_t *indices, size_t numVertices, size_t cacheSize )
+{
+	const size_t numTriangles = numIndices / 3;
+	if( ! numTriangles )
+		return 0;
+
+	VertexCacheSim cache( numVertices, cacheSize );
+	size_t numMisses = 0;
+	for( size_t t = 0; t < numTriangles; ++t )
+		numMisses += cache.addTriangle( &indices[t * 3] );
+
+	return float( numMisses ) / float( numTriangles );
+}
+
+void optimizeVertexCache( size_t numIndices, uint32_t *indices, size_t numVertices, size_t cacheSize )
+{
+	const size_t numTriangles = numIndices / 3;
+	vector<uint32_t> result( numTriangles * 3 );
+	tipsify( numTriangles, indices, numVertices, cacheSize, result.data() );
+	std::copy( result.begin(), result.end(), indices );
+}
+
+void optimizeOverdraw( size_t numIndices, uint32_t *indices, size_t numVertices, const vec3 *positions, size_t cacheSize, float threshold )
+{
+	const size_t numTriangles = numIndices / 3;
+	if( numTriangles < 2 )
+		return;
+
+	// the vertex cache order breaks up into clusters wherever it had to start over, missing on all three vertices of a triangle
+	vector<uint32_t> hardClusters;
+	VertexCacheSim cache( numVertices, cacheSize );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		if( cache.addTriangle( &indices[t * 3] ) == 3 || t == 0 )
+			hardClusters.push_back( uint32_t( t ) );
+	}
+	hardClusters.push_back( uint32_t( numTriangles ) );
+
+	// split these further wherever the ACMR since the last split comes within threshold of the whole cluster's; drawn on its own, every piece then
+	// still uses the cache about as well as the cluster did
+	vector<uint32_t> clusters;
+	for( size_t h = 0; h + 1 < hardClusters.size(); ++h ) {
+		const uint32_t begin = hardClusters[h], end = hardClusters[h + 1];
+		cache.flush();
+		size_t numClusterMisses = 0;
+		for( uint32_t t = begin; t < end; ++t )
+			numClusterMisses += cache.addTriangle( &indices[t * 3] );
+		const float clusterAcmr = float( numClusterMisses ) / float( end - begin );
+
+		cache.flush();
+		clusters.push_back( begin );
+		size_t numMisses = 0;
+		for( uint32_t t = begin; t < end; ++t ) {
+			numMisses += cache.addTriangle( &indices[t * 3] );
+			if( t + 1 < end && float( numMisses ) <= threshold * clusterAcmr * float( t + 1 - clusters.back() ) ) {
+				clusters.push_back( t + 1 );
+				numMisses = 0;
+				cache.flush();
+			}
+		}
+	}
+	clusters.push_back( uint32_t( numTriangles ) );
+	const size_t numClusters = clusters.size() - 1;
+
+	// clusters facing away from the center of the mesh are likely to occlude the others, so they're drawn first
+	vector<vec3> centroids( numClusters, vec3( 0 ) ), normals( numClusters, vec3( 0 ) );
+	vec3 meshCentroid( 0 );
+	float meshArea = 0;
+	for( size_t c = 0; c < numClusters; ++c ) {
+		float clusterArea = 0;
+		for( uint32_t t = clusters[c]; t < clusters[c + 1]; ++t ) {
+			const vec3 &p0 = positions[indices[t * 3]], &p1 = positions[indices[t * 3 + 1]], &p2 = positions[indices[t * 3 + 2]];
+			const vec3 normal = cross( p1 - p0, p2 - p0 );
+			const float area = length( normal );
+			centroids[c] += ( p0 + p1 + p2 ) * ( area / 3 );
+			normals[c] += normal;
+			clusterArea += area;
+		}
+		meshCentroid += centroids[c];
+		meshArea += clusterArea;
+		if( clusterArea > 0 )
+			centroids[c] /= clusterArea;
+	}
+	if( meshArea > 0 )
+		meshCentroid /= meshArea;
+
+	vector<float> sortKeys( numClusters, 0 );
+	vector<uint32_t> order( numClusters );
+	for( size_t c = 0; c < numClusters; ++c ) {
+		const float normalLength = length( normals[c] );
+		if( normalLength > 0 )
+			sortKeys[c] = dot( centroids[c] - meshCentroid, normals[c] / normalLength );
+		order[c] = uint32_t( c );
+	}
+	std::stable_sort( order.begin(), order.end(), [&]( uint32_t a, uint32_t b ) { return sortKeys[a] > sortKeys[b]; } );
+
+	vector<uint32_t> result;
+	result.reserve( numTriangles * 3 );
+	for( uint32_t c : order )
+		result.insert( result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3 );
+	std::copy( result.begin(), result.end(), indices );
+}
+
+size_t optimizeVertexFetch( size_t numIndices, uint32_t *indices, size_t numVertices, vector<uint32_t> *resultRemap )
+{
+	const uint32_t unused = numeric_limits<uint32_t>::max();
+	resultRemap->assign( numVertices, unused );
+	uint32_t numReferenced = 0;
+	for( size_t i = 0; i < numIndices; ++i ) {
+		uint32_t &remapped = (*resultRemap)[indices[i]];
+		if( remapped == unused )
+			remapped = numReferenced++;
+		indices[i] = remapped;
+	}
+
+	uint32_t next = numReferenced;
+	for( auto &remapped : *resultRemap ) {
+		if( remapped == unused )
+			remapped = next++;
+	}
+
+	return numReferenced;
+}
+
+namespace {
+
+// Sources only spread their vertex generation across threads above this many vertices, where it makes up for starting the threads
+const size_t kMinParallelVertices = 32768;
+
+// Calls \a fn for each of \a numRows rows of roughly \a verticesPerRow vertices, in parallel when there are enough vertices in total
+void forEachRow( size_t numRows, size_t verticesPerRow, const std::function<void( size_t )> &fn )
+{
+	parallelFor( numRows, fn, numRows * verticesPerRow >= kMinParallelVertices ? 0 : 1 );
+}
+
+// Storage for one attribute generated by a Source. Uses the Target's own storage when it offers a matching layout through
+// getAttribStorage(), otherwise a temporary which commit() passes on to copyAttrib(). If \a contiguous, the Target's storage is only
+// used when it is tightly packed, so that data() can be read back as an array (e.g. by calculateTangents()).
+template<typename T>
+class AttribStorage {
+  public:
+	AttribStorage( Target *target, Attrib attrib, size_t count, bool enabled = true, bool contiguous = false )
+		: mTarget( target ), mAttrib( attrib ), mCount( count ), mEnabled( enabled ), mDirect( false )
+	{
+		if( ! mEnabled )
+			return;
+
+		size_t strideBytes = 0;
+		T *data = reinterpret_cast<T*>( target->getAttribStorage( attrib, getDims(), count, &strideBytes ) );
+		if( data && ( ! contiguous || strideBytes == 0 || strideBytes == sizeof( T ) ) ) {
+			mPtr = StridedPtr<T>( data, strideBytes );
+			mDirect = true;
+		}
+		else {
+			mTemp.resize( count );
+			mPtr = StridedPtr<T>( mTemp.data() );
+		}
+	}
+
+	//! Returns where the elements should be written, or a null StridedPtr if the attribute isn't enabled.
+	const StridedPtr<T>&	get() const		{ return mPtr; }
+	//! Returns the elements as a contiguous array. Requires \a contiguous to have been passed to the constructor.
+	const T*				data() const	{ return mPtr.get(); }
+
+	//! Hands the elements to the Target, unless they were written into its storage directly.
+	void commit() const
+	{
+		if( mEnabled && ! mDirect )
+			mTarget->copyAttrib( mAttrib, getDims(), 0, reinterpret_cast<const float*>( mTemp.data() ), mCount );
+	}
+
+  private:
+	static uint8_t	getDims()	{ return uint8_t( sizeof( T ) / sizeof( float ) ); }
+
+	Target			*mTarget;
+	Attrib			mAttrib;
+	size_t			mCount;
+	bool			mEnabled, mDirect;
+	StridedPtr<T>	mPtr;
+	std::vector<T>	mTemp;
+};
+
+// One ring of an extrusion; the vertices of path \a path at subdivision \a sub, along with the indices of the quads joining it to the next ring
+struct ExtrusionRow {
+	size_t		path;
+	int			sub;
+	uint32_t	baseVertex;
+	size_t		baseIndex;
+};
+
+// Lays out the extrusion rings of \a paths after the cap's \a baseVertex vertices and \a baseIndex indices, path by path and subdivision by subdivision
+std::vector<ExtrusionRow> calcExtrusionRows( const std::vector<std::vector<vec2>> &paths, int subdivisions, uint32_t baseVertex, size_t baseIndex )
+{
+	std::vector<ExtrusionRow> result;
+	result.reserve( paths.size() * ( subdivisions + 1 ) );
+	for( size_t p = 0; p < paths.size(); ++p ) {
+		for( int sub = 0; sub <= subdivisions; ++sub ) {
+			ExtrusionRow row = { p, sub, baseVertex, baseIndex };
+			result.push_back( row );
+			baseVertex += (uint32_t)paths[p].size();
+			if( sub != subdivisions )
+				baseIndex += 6 * paths[p].size();
+		}
+	}
+	return result;
+}
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // Target
 void Target::copyIndexDataForceTriangles( Primitive primitive, const uint32_t *source, size_t numIndices, uint32_t indexOffset, uint32_t *target )
@@ -1448,83 +1776,62 @@ void Teapot::updateVertexCounts()
 	mNumVertices = 32 * (mSubdivision + 1) * (mSubdivision + 1);
 }
 
-void Teapot::calculate( vector<float> *positions, vector<float> *normals, vector<float> *texCoords, vector<uint32_t> *indices ) const
+void Teapot::calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec2> texCoords, uint32_t *indices ) const
 {
-	positions->resize( mNumVertices * 3 );
-	texCoords->resize( mNumVertices * 2 );
-	normals->resize( mNumVertices * 3 );
-	indices->resize( mNumIndices );
-
-	generatePatches( positions->data(), normals->data(), texCoords->data(), indices->data(), mSubdivision );
+	generatePatches( positions, normals, texCoords, indices, mSubdivision );
 }
 
-void Teapot::generatePatches( float *v, float *n, float *tc, uint32_t *el, int grid )
+void Teapot::generatePatches( StridedPtr<vec3> v, StridedPtr<vec3> n, StridedPtr<vec2> tc, uint32_t *el, int grid )
 {
 	unique_ptr<float[]> B( new float[4*(grid+1)] );  // Pre-computed Bernstein basis functions
 	unique_ptr<float[]> dB( new float[4*(grid+1)] ); // Pre-computed derivitives of basis functions
-	int idx = 0, elIndex = 0, tcIndex = 0;
 
 	// Pre-compute the basis functions  (Bernstein polynomials)
 	// and their derivatives
 	computeBasisFunctions( B.get(), dB.get(), grid );
 
-	// Build each patch
-	// The rim
-	buildPatchReflect( 0, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The body
-	buildPatchReflect( 1, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	buildPatchReflect( 2, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The lid
-	buildPatchReflect( 3, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	buildPatchReflect( 4, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The bottom
-	buildPatchReflect( 5, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The handle
-	buildPatchReflect( 6, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-	buildPatchReflect( 7, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-	// The spout
-	buildPatchReflect( 8, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-	buildPatchReflect( 9, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-}
-
-void Teapot::buildPatchReflect( int patchNum, float *B, float *dB, float *v, float *n, float *tc, unsigned int *el,
-								int &index, int &elIndex, int &tcIndex, int grid, bool reflectX, bool reflectY )
-{
-	vec3 patch[4][4];
-	vec3 patchRevV[4][4];
-	getPatch( patchNum, patch, false );
-	getPatch( patchNum, patchRevV, true );
-
-	// Patch without modification
-	buildPatch( patchRevV, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, mat3(), false );
+	// Each patch is built unmodified and then reflected. The rim, body, lid and bottom (patches 0 - 5) are reflected
+	// in x, y and both, while the handle and spout (patches 6 - 9) are only reflected in y.
+	struct PatchInstance {
+		PatchInstance( int patchNum, bool reverseV, bool invertNormal, const mat3 &reflect )
+			: patchNum( patchNum ), reverseV( reverseV ), invertNormal( invertNormal ), reflect( reflect )
+		{}
 
-	// Patch reflected in x
-	if( reflectX ) {
-		mat3 reflect( glm::scale( vec3( -1, 1, 1 ) ) );
-		buildPatch( patch, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, reflect, true );
-	}
+		int		patchNum;
+		bool	reverseV, invertNormal;
+		mat3	reflect;
+	};
 
-	// Patch reflected in y
-	if( reflectY ) {
-		mat3 reflect( glm::scale( vec3( 1, -1, 1 ) ) );
-		buildPatch( patch, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, reflect, true );
+	vector<PatchInstance> instances;
+	for( int patchNum = 0; patchNum < 10; ++patchNum ) {
+		bool reflectX = patchNum < 6;
+		instances.emplace_back( patchNum, true, false, mat3() );
+		if( reflectX )
+			instances.emplace_back( patchNum, false, true, mat3( glm::scale( vec3( -1, 1, 1 ) ) ) );
+		instances.emplace_back( patchNum, false, true, mat3( glm::scale( vec3( 1, -1, 1 ) ) ) );
+		if( reflectX )
+			instances.emplace_back( patchNum, true, false, mat3( glm::scale( vec3( -1, -1, 1 ) ) ) );
 	}
 
-	// Patch reflected in x and y
-	if( reflectX && reflectY ) {
-		mat3 reflect( glm::scale( vec3( -1, -1, 1 ) ) );
-		buildPatch( patchRevV, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, reflect, false );
-	}
+	// every patch instance covers a fixed range of vertices and indices, so they can be built independently
+	const int verticesPerPatch = ( grid + 1 ) * ( grid + 1 );
+	const int indicesPerPatch = grid * grid * 6;
+	forEachRow( instances.size(), verticesPerPatch, [&]( size_t k ) {
+		const PatchInstance &instance = instances[k];
+		vec3 patch[4][4];
+		getPatch( instance.patchNum, patch, instance.reverseV );
+		buildPatch( patch, B.get(), dB.get(), v, n, tc, el + k * indicesPerPatch, int( k * verticesPerPatch ), grid, instance.reflect, instance.invertNormal );
+	} );
 }
 
-void Teapot::buildPatch( vec3 patch[][4], float *B, float *dB, float *v, float *n, float *tc,
-						unsigned int *el, int &index, int &elIndex, int &tcIndex, int grid, mat3 reflect, bool invertNormal )
+void Teapot::buildPatch( vec3 patch[][4], const float *B, const float *dB, StridedPtr<vec3> v, StridedPtr<vec3> n, StridedPtr<vec2> tc,
+						uint32_t *el, int startIndex, int grid, mat3 reflect, bool invertNormal )
 {
-	int startIndex = index / 3;
 	float tcFactor = 1.0f / grid;
 
 	float scale = 2.0f / 6.42813f; // awful hack to keep it within unit cube
 
+	int index = startIndex;
 	for( int i = 0; i <= grid; i++ ) {
 		for( int j = 0 ; j <= grid; j++) {
 			vec3 pt = reflect * evaluate( i, j, B, patch );
@@ -1535,14 +1842,14 @@ void Teapot::buildPatch( vec3 patch[][4], float *B, float *dB, float *v, float *
 			if( abs( pt.x ) < 0.01f && abs( pt.y ) < 0.01f )
 				norm = ( pt.z < 1 ) ? vec3( 0, 0, -1 ) : vec3( 0, 0, 1 );
 
-			v[index] = pt.x * scale; v[index+1] = pt.z * scale; v[index+2] = pt.y * scale;
-			n[index] = norm.x; n[index+1] = norm.z; n[index+2] = norm.y;
-			tc[tcIndex] = i * tcFactor; tc[tcIndex+1] = j * tcFactor;
-			index += 3;
-			tcIndex += 2;
+			v[index] = vec3( pt.x * scale, pt.z * scale, pt.y * scale );
+			n[index] = vec3( norm.x, norm.z, norm.y );
+			tc[index] = vec2( i * tcFactor, j * tcFactor );
+			index++;
 		}
 	}
 
+	int elIndex = 0;
 	for( int i = 0; i < grid; i++ ) {
 		int iStart = i * (grid+1) + startIndex;
 		int nextiStart = (i+1) * (grid+1) + startIndex;
@@ -1630,18 +1937,21 @@ vec3 Teapot::evaluateNormal( int gridU, int gridV, const float *B, const float *
 
 void Teapot::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 {
-	vector<float> positions, normals, texCoords;
-	vector<uint32_t> indices;
-	
-	calculate( &positions, &normals, &texCoords, &indices );
+	const bool needTangents = requestedAttribs.count( Attrib::TANGENT ) > 0;
+	AttribStorage<vec3> positions( target, Attrib::POSITION, mNumVertices, true, needTangents );
+	AttribStorage<vec3> normals( target, Attrib::NORMAL, mNumVertices, true, needTangents );
+	AttribStorage<vec2> texCoords( target, Attrib::TEX_COORD_0, mNumVertices, true, needTangents );
+	vector<uint32_t> indices( mNumIndices );
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, positions.data(), mNumVertices );
-	target->copyAttrib( Attrib::NORMAL, 3, 0, normals.data(), mNumVertices );
-	target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, texCoords.data(), mNumVertices );
+	calculate( positions.get(), normals.get(), texCoords.get(), indices.data() );
 
-	if( requestedAttribs.count( Attrib::TANGENT ) ) {
+	positions.commit();
+	normals.commit();
+	texCoords.commit();
+
+	if( needTangents ) {
 		vector<vec3> tangents;
-		calculateTangents( indices.size(), indices.data(), positions.size() / 3, (const vec3*)positions.data(), (const vec3*)normals.data(), (const vec2*)texCoords.data(), &tangents, nullptr );
+		calculateTangents( indices.size(), indices.data(), mNumVertices, positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
 		target->copyAttrib( Attrib::TANGENT, 3, 0, value_ptr( *tangents.data() ), tangents.size() );
 	}
 
@@ -1885,27 +2195,20 @@ void Sphere::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 	int numRings, numSegments;
 	numRingsAndSegments( &numRings, &numSegments );
 
-	std::vector<vec3> positions;
-	std::vector<vec2> texCoords;
-	std::vector<vec3> normals;
-	std::vector<vec3> colors;
-	std::vector<uint32_t> indices;
-
-	positions.resize( numSegments * numRings );
-	normals.resize( numSegments * numRings );
-	texCoords.resize( numSegments * numRings );
-	colors.resize( numSegments * numRings );
-	indices.resize( numSegments * numRings * 6 );
+	const size_t numVertices = numSegments * numRings;
+	const bool needTangents = requestedAttribs.count( geom::TANGENT ) > 0;
+	AttribStorage<vec3> positions( target, Attrib::POSITION, numVertices, true, needTangents );
+	AttribStorage<vec3> normals( target, Attrib::NORMAL, numVertices, true, needTangents );
+	AttribStorage<vec2> texCoords( target, Attrib::TEX_COORD_0, numVertices, true, needTangents );
+	AttribStorage<vec3> colors( target, Attrib::COLOR, numVertices );
+	std::vector<uint32_t> indices( numSegments * numRings * 6 );
 
 	float ringIncr = 1.0f / (float)( numRings - 1 );
 	float segIncr = 1.0f / (float)( numSegments - 1 );
 	float radius = mRadius;
 
-	auto vertIt = positions.begin();
-	auto normIt = normals.begin();
-	auto texIt = texCoords.begin();
-	auto colorIt = colors.begin();
-	for( int r = 0; r < numRings; r++ ) {
+	// each ring is independent, so they're generated in parallel for dense spheres
+	forEachRow( numRings, numSegments, [&]( size_t r ) {
 		float v = r * ringIncr;
 		for( int s = 0; s < numSegments; s++ ) {
 			float u = 1.0f - s * segIncr;
@@ -1913,16 +2216,17 @@ void Sphere::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 			float y = math<float>::sin( float(M_PI) * (v - 0.5f) );
 			float z = math<float>::cos( float(M_PI * 2) * u ) * math<float>::sin( float(M_PI) * v );
 
-			*vertIt++ = vec3( x * radius + mCenter.x, y * radius + mCenter.y, z * radius + mCenter.z );
-
-			*normIt++ = vec3( x, y, z );
-			*texIt++ = vec2( u, v );
-			*colorIt++ = vec3( x * 0.5f + 0.5f, y * 0.5f + 0.5f, z * 0.5f + 0.5f );
+			const size_t vert = r * numSegments + s;
+			positions.get()[vert] = vec3( x * radius + mCenter.x, y * radius + mCenter.y, z * radius + mCenter.z );
+			normals.get()[vert] = vec3( x, y, z );
+			texCoords.get()[vert] = vec2( u, v );
+			colors.get()[vert] = vec3( x * 0.5f + 0.5f, y * 0.5f + 0.5f, z * 0.5f + 0.5f );
 		}
-	}
 
-	auto indexIt = indices.begin();
-	for( int r = 0; r < numRings - 1; r++ ) {
+		if( r == (size_t)numRings - 1 )
+			return;
+
+		auto indexIt = indices.begin() + r * ( numSegments - 1 ) * 6;
 		for( int s = 0; s < numSegments - 1 ; s++ ) {
 			*indexIt++ = (uint32_t)(r * numSegments + ( s + 1 ));
 			*indexIt++ = (uint32_t)(r * numSegments + s);
@@ -1932,19 +2236,17 @@ void Sphere::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 			*indexIt++ = (uint32_t)(( r + 1 ) * numSegments + ( s + 1 ));
 			*indexIt++ = (uint32_t)(r * numSegments + s);
 		}
-	}
-	
-	target->copyAttrib( Attrib::POSITION, 3, 0, value_ptr( *positions.data() ), positions.size() );
-	target->copyAttrib( Attrib::NORMAL, 3, 0, value_ptr( *normals.data() ), normals.size() );
-	target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, value_ptr( *texCoords.data() ), texCoords.size() );
-	target->copyAttrib( Attrib::COLOR, 3, 0, value_ptr( *colors.data() ), colors.size() );
+	} );
 
-	if( requestedAttribs.count( geom::TANGENT ) ) {
+	positions.commit();
+	normals.commit();
+	texCoords.commit();
+	colors.commit();
+
+	if( needTangents ) {
 		vector<vec3> tangents;
-		calculateTangents( indices.size(), indices.data(), positions.size(), positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
-		
-		if( requestedAttribs.count( geom::TANGENT ) )
-			target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
+		calculateTangents( indices.size(), indices.data(), numVertices, positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
+		target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
 	}
 
 	target->copyIndices( Primitive::TRIANGLES, indices.data(), indices.size(), 4 );
@@ -2136,23 +2438,17 @@ size_t Torus::getNumIndices() const
 	return (mNumAxis - 1) * (mNumRings - 1) * 6;
 }
 
-void Torus::calculate( vector<vec3> *positions, vector<vec3> *normals, vector<vec2> *texCoords, vector<vec3> *colors, vector<uint32_t> *indices ) const
+void Torus::calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec2> texCoords, StridedPtr<vec3> colors, uint32_t *indices ) const
 {
-	positions->reserve( mNumAxis * mNumRings );
-	normals->reserve( mNumAxis * mNumRings );
-	texCoords->reserve( mNumAxis * mNumRings );
-	if( colors )
-		colors->reserve( mNumAxis * mNumRings );
-	indices->reserve( (mNumAxis - 1) * (mNumRings - 1) * 6 );
-
 	float majorIncr = 1.0f / (mNumAxis - 1);
 	float minorIncr = 1.0f / (mNumRings - 1);
 	float radiusDiff = mRadiusMajor - mRadiusMinor;
 	float angle = float(M_PI * 2) * mCoils;
 	float twist = angle * mTwist * minorIncr * majorIncr;
 
-	// vertex, normal, tex coord and color buffers
-	for( int i = 0; i < mNumAxis; ++i ) {
+	// vertex, normal, tex coord and color buffers, and the indices of the quads following each ring
+	forEachRow( mNumAxis, mNumRings, [&]( size_t row ) {
+		const int i = (int)row;
 		float phi = i * majorIncr * angle;
 		float cosPhi = -math<float>::cos( phi );
 		float sinPhi =  math<float>::sin( phi );
@@ -2167,28 +2463,29 @@ void Torus::calculate( vector<vec3> *positions, vector<vec3> *normals, vector<ve
 			float y = i * majorIncr * mHeight + sinTheta * radiusDiff;
 			float z = r * sinPhi;
 
-			positions->emplace_back( mCenter + vec3( x, y, z ) );
-			texCoords->emplace_back( i * majorIncr, j * minorIncr );
-			normals->emplace_back( cosPhi * cosTheta, sinTheta, sinPhi * cosTheta );
-
-			const vec3 &n = normals->back();
-			if( colors )
-				colors->emplace_back( n.x * 0.5f + 0.5f, n.y * 0.5f + 0.5f, n.z * 0.5f + 0.5f );
+			const size_t vert = i * mNumRings + j;
+			const vec3 n( cosPhi * cosTheta, sinTheta, sinPhi * cosTheta );
+			positions[vert] = mCenter + vec3( x, y, z );
+			texCoords[vert] = vec2( i * majorIncr, j * minorIncr );
+			normals[vert] = n;
+			if( colors.get() )
+				colors[vert] = vec3( n.x * 0.5f + 0.5f, n.y * 0.5f + 0.5f, n.z * 0.5f + 0.5f );
 		}
-	}
 
-	// index buffer
-	for( int i = 0; i < mNumAxis - 1; ++i ) {
+		if( i == mNumAxis - 1 )
+			return;
+
+		uint32_t *index = indices + i * ( mNumRings - 1 ) * 6;
 		for ( int j = 0; j < mNumRings - 1; ++j ) {
-			indices->push_back( (uint32_t)((i + 0) * mNumRings + (j + 0)) );
-			indices->push_back( (uint32_t)((i + 1) * mNumRings + (j + 1)) );
-			indices->push_back( (uint32_t)((i + 1) * mNumRings + (j + 0)) );
+			*index++ = (uint32_t)((i + 0) * mNumRings + (j + 0));
+			*index++ = (uint32_t)((i + 1) * mNumRings + (j + 1));
+			*index++ = (uint32_t)((i + 1) * mNumRings + (j + 0));
 
-			indices->push_back( (uint32_t)((i + 0) * mNumRings + (j + 0)) );
-			indices->push_back( (uint32_t)((i + 0) * mNumRings + (j + 1)) );
-			indices->push_back( (uint32_t)((i + 1) * mNumRings + (j + 1)) );
+			*index++ = (uint32_t)((i + 0) * mNumRings + (j + 0));
+			*index++ = (uint32_t)((i + 0) * mNumRings + (j + 1));
+			*index++ = (uint32_t)((i + 1) * mNumRings + (j + 1));
 		}
-	}
+	} );
 }
 
 uint8_t Torus::getAttribDims( Attrib attr ) const
@@ -2211,27 +2508,25 @@ AttribSet Torus::getAvailableAttribs() const
 
 void Torus::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 {
-	std::vector<vec3> positions, normals;
-	std::vector<vec2> texCoords;
-	std::vector<vec3> colors;
-	std::vector<uint32_t> indices;
+	const size_t numVertices = getNumVertices();
+	const bool needTangents = requestedAttribs.count( geom::TANGENT ) > 0;
+	AttribStorage<vec3> positions( target, Attrib::POSITION, numVertices, true, needTangents );
+	AttribStorage<vec3> normals( target, Attrib::NORMAL, numVertices, true, needTangents );
+	AttribStorage<vec2> texCoords( target, Attrib::TEX_COORD_0, numVertices, true, needTangents );
+	AttribStorage<vec3> colors( target, Attrib::COLOR, numVertices, requestedAttribs.count( Attrib::COLOR ) > 0 );
+	std::vector<uint32_t> indices( getNumIndices() );
 
-	vector<vec3> *colorsPtr = ( requestedAttribs.count( Attrib::COLOR ) ) ? &colors : nullptr;
+	calculate( positions.get(), normals.get(), texCoords.get(), colors.get(), indices.data() );
 
-	calculate( &positions, &normals, &texCoords, colorsPtr, &indices );
+	positions.commit();
+	normals.commit();
+	texCoords.commit();
+	colors.commit();
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, value_ptr( *positions.data() ), positions.size() );
-	target->copyAttrib( Attrib::NORMAL, 3, 0, value_ptr( *normals.data() ), normals.size() );
-	target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, value_ptr( *texCoords.data() ), texCoords.size() );
-	if( requestedAttribs.count( Attrib::COLOR ) )
-		target->copyAttrib( Attrib::COLOR, 3, 0, value_ptr( *colors.data() ), colors.size() );
-
-	if( requestedAttribs.count( geom::TANGENT ) ) {
+	if( needTangents ) {
 		vector<vec3> tangents;
-		calculateTangents( indices.size(), indices.data(), positions.size(), positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
-		
-		if( requestedAttribs.count( geom::TANGENT ) )
-			target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
+		calculateTangents( indices.size(), indices.data(), numVertices, positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
+		target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
 	}
 
 	target->copyIndices( Primitive::TRIANGLES, indices.data(), indices.size(), 4 );
@@ -2275,32 +2570,26 @@ AttribSet TorusKnot::getAvailableAttribs() const
 void TorusKnot::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 {
 	auto numVertices = getNumVertices();
-	auto numIndices = getNumIndices();
 
-	std::vector<vec3> positions( numVertices ), normals( numVertices );
-	std::vector<vec2> texCoords( numVertices );
-	std::vector<vec3> colors( numVertices );
-	std::vector<vec3> tangents( numVertices );
-	std::vector<uint32_t> indices( numIndices );
+	AttribStorage<vec3> positions( target, Attrib::POSITION, numVertices );
+	AttribStorage<vec3> normals( target, Attrib::NORMAL, numVertices );
+	AttribStorage<vec2> texCoords( target, Attrib::TEX_COORD_0, numVertices );
+	AttribStorage<vec3> colors( target, Attrib::COLOR, numVertices, requestedAttribs.count( Attrib::COLOR ) > 0 );
+	AttribStorage<vec3> tangents( target, Attrib::TANGENT, numVertices, requestedAttribs.count( Attrib::TANGENT ) > 0 );
+	std::vector<uint32_t> indices( getNumIndices() );
 
-	std::vector<vec3> *colorsPtr = ( requestedAttribs.count( Attrib::COLOR ) ) ? &colors : nullptr;
-	std::vector<vec3> *tangentsPtr = ( requestedAttribs.count( Attrib::TANGENT ) ) ? &tangents : nullptr;
+	calculate( positions.get(), normals.get(), texCoords.get(), colors.get(), tangents.get(), indices.data() );
 
-	calculate( &positions, &normals, &texCoords, colorsPtr, tangentsPtr, &indices );
-
-	target->copyAttrib( Attrib::POSITION, 3, 0, value_ptr( *positions.data() ), positions.size() );
-	target->copyAttrib( Attrib::NORMAL, 3, 0, value_ptr( *normals.data() ), normals.size() );
-	target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, value_ptr( *texCoords.data() ), texCoords.size() );
-
-	if( requestedAttribs.count( Attrib::COLOR ) )
-		target->copyAttrib( Attrib::COLOR, 3, 0, value_ptr( *colors.data() ), colors.size() );
-	if( requestedAttribs.count( geom::TANGENT ) )
-		target->copyAttrib( Attrib::TANGENT, 3, 0, value_ptr( *tangents.data() ), tangents.size() );
+	positions.commit();
+	normals.commit();
+	texCoords.commit();
+	colors.commit();
+	tangents.commit();
 
 	target->copyIndices( Primitive::TRIANGLES, indices.data(), indices.size(), 4 );
 }
 
-void TorusKnot::calculate( std::vector<vec3> *positions, std::vector<vec3> *normals, std::vector<vec2> *texCoords, std::vector<vec3> *colors, std::vector<vec3> *tangents, std::vector<uint32_t> *indices ) const
+void TorusKnot::calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec2> texCoords, StridedPtr<vec3> colors, StridedPtr<vec3> tangents, uint32_t *indices ) const
 {
 	float stepHeight = float( 2.0 * M_PI ) / mSubdivisionsHeight;
 	float stepAxis = float( 2.0 * M_PI ) / mSubdivisionsAxis;
@@ -2310,7 +2599,9 @@ void TorusKnot::calculate( std::vector<vec3> *positions, std::vector<vec3> *norm
 	int _p = ( divider != 0 ) ? mP / divider : 1;
 	int _q = ( divider != 0 ) ? mQ / divider : 0;
 
-	for( int i = 0; i <= mSubdivisionsHeight; ++i ) {
+	int nAxis = mSubdivisionsAxis + 1;
+	forEachRow( mSubdivisionsHeight + 1, nAxis, [&]( size_t row ) {
+		const int i = (int)row;
 		float p = _p * i * stepHeight;
 		float q = _q * i * stepHeight;
 		float r = 0.5f * ( 2.0f + glm::cos( q ) );
@@ -2329,33 +2620,33 @@ void TorusKnot::calculate( std::vector<vec3> *positions, std::vector<vec3> *norm
 			float x = glm::cos( j * stepAxis ) * mRadius;
 			float y = glm::sin( j * stepAxis ) * mRadius;
 
-			int idx = i * ( mSubdivisionsAxis + 1 ) + j;
-			( *normals )[idx] = B * x + N * y;
-			( *positions )[idx] = ( *normals )[idx] + center;
-			( *normals )[idx] = glm::normalize( ( *normals )[idx] );
-			( *texCoords )[idx].y = float( j ) / mSubdivisionsAxis;
-			( *texCoords )[idx].x = float( i ) / mSubdivisionsHeight;
+			int idx = i * nAxis + j;
+			vec3 offset = B * x + N * y;
+			vec3 n = glm::normalize( offset );
+			positions[idx] = offset + center;
+			normals[idx] = n;
+			texCoords[idx] = vec2( float( i ) / mSubdivisionsHeight, float( j ) / mSubdivisionsAxis );
 
-			if( tangents )
-				( *tangents )[idx] = T; 
-			
-			if( colors )
-				( *colors )[idx] = ( *normals )[idx] * 0.5f + 0.5f;
+			if( tangents.get() )
+				tangents[idx] = T;
+
+			if( colors.get() )
+				colors[idx] = n * 0.5f + 0.5f;
 		}
-	}
 
-	int nAxis = mSubdivisionsAxis + 1;
-	for( int j = 0; j < mSubdivisionsAxis; j++ ) {
-		for( int i = 0; i < mSubdivisionsHeight; i++ ) {
+		if( i == mSubdivisionsHeight )
+			return;
+
+		for( int j = 0; j < mSubdivisionsAxis; j++ ) {
 			int idx = 6 * ( j * mSubdivisionsHeight + i );
-			( *indices )[idx + 0] = ( j + i * nAxis );
-			( *indices )[idx + 1] = ( j + ( i + 1 ) * nAxis );
-			( *indices )[idx + 2] = ( ( j + 1 ) + i * nAxis );
-			( *indices )[idx + 3] = ( ( j + 1 ) + i * nAxis );
-			( *indices )[idx + 4] = ( j + ( i + 1 ) * nAxis );
-			( *indices )[idx + 5] = ( ( j + 1 ) + ( i + 1 ) * nAxis );
+			indices[idx + 0] = ( j + i * nAxis );
+			indices[idx + 1] = ( j + ( i + 1 ) * nAxis );
+			indices[idx + 2] = ( ( j + 1 ) + i * nAxis );
+			indices[idx + 3] = ( ( j + 1 ) + i * nAxis );
+			indices[idx + 4] = ( j + ( i + 1 ) * nAxis );
+			indices[idx + 5] = ( ( j + 1 ) + ( i + 1 ) * nAxis );
 		}
-	}
+	} );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -2676,6 +2967,20 @@ void Plane::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 	target->copyIndices( Primitive::TRIANGLES, indices.data(), indices.size(), 4 );
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+// PointwiseModifier
+void PointwiseModifier::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+{
+	const Attrib upstreamAttrib = getUpstreamAttrib();
+	if( upstreamAttrib != NUM_ATTRIBS )
+		ctx->processUpstream( requestedAttribs, { upstreamAttrib } );
+	else
+		ctx->processUpstream( requestedAttribs );
+
+	if( prepare( ctx ) )
+		processVertices( ctx, 0, ctx->getNumVertices() );
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // Transform
 uint8_t	Transform::getAttribDims( Attrib attr, uint8_t upstreamDims ) const
@@ -2686,96 +2991,105 @@ uint8_t	Transform::getAttribDims( Attrib attr, uint8_t upstreamDims ) const
 		return upstreamDims;
 }
 
-void Transform::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+bool Transform::isInPlace( const SourceModsContext &ctx ) const
 {
-	ctx->processUpstream( requestedAttribs );
-	
-	const size_t numVertices = ctx->getNumVertices();
+	// 2D positions are promoted to 3D
+	return ctx.getAttribDims( POSITION ) != 2;
+}
 
-	if( ctx->getAttribDims( POSITION ) == 2 ) {
-		const vec2* inPositions = reinterpret_cast<vec2*>( ctx->getAttribData( POSITION ) );
-		vector<vec3> outPositions;
-		outPositions.reserve( numVertices );
-		for( size_t v = 0; v < numVertices; ++v )
-			outPositions.push_back( vec3( mTransform * vec4( inPositions[v], 0, 1 ) ) );
-		ctx->copyAttrib( POSITION, 3, 0, (const float*)outPositions.data(), numVertices );
-	}
-	else if( ctx->getAttribDims( POSITION ) == 3 ) {
+bool Transform::prepare( SourceModsContext *ctx ) const
+{
+	const uint8_t positionDims = ctx->getAttribDims( POSITION );
+	if( positionDims == 2 )
+		ctx->convertAttribDims( POSITION, 3 );
+	else if( positionDims != 0 && positionDims != 3 && positionDims != 4 )
+		CI_LOG_W( "Unsupported dimension for geom::POSITION passed to geom::Transform" );
+	if( ctx->getAttribDims( NORMAL ) != 0 && ctx->getAttribDims( NORMAL ) != 3 )
+		CI_LOG_W( "Unsupported dimension for geom::NORMAL passed to geom::Transform" );
+	if( ctx->getAttribDims( TANGENT ) != 0 && ctx->getAttribDims( TANGENT ) != 3 )
+		CI_LOG_W( "Unsupported dimension for geom::TANGENT passed to geom::Transform" );
+
+	return true;
+}
+
+void Transform::processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const
+{
+	if( ctx->getAttribDims( POSITION ) == 3 ) {
 		vec3* positions = reinterpret_cast<vec3*>( ctx->getAttribData( POSITION ) );
-		for( size_t v = 0; v < numVertices; ++v )
+		for( size_t v = begin; v < end; ++v )
 			positions[v] = vec3( mTransform * vec4( positions[v], 1 ) );
 	}
 	else if( ctx->getAttribDims( POSITION ) == 4 ) {
 		vec4* positions = reinterpret_cast<vec4*>( ctx->getAttribData( POSITION ) );
-		for( size_t v = 0; v < numVertices; ++v )
+		for( size_t v = begin; v < end; ++v )
 			positions[v] = mTransform * positions[v];
 	}
-	else if( ctx->getAttribDims( POSITION ) != 0 )
-		CI_LOG_W( "Unsupported dimension for geom::POSITION passed to geom::Transform" );
 	
-	// we'll make the sort of modification to our normals (if they're present)
+	// we'll make the sort of modification to our normals and tangents (if they're present)
 	// using the inverse transpose of 'mTransform'
-	if( ctx->getAttribDims( NORMAL ) == 3 ) {
+	const bool hasNormals = ctx->getAttribDims( NORMAL ) == 3;
+	const bool hasTangents = ctx->getAttribDims( TANGENT ) == 3;
+	if( ! hasNormals && ! hasTangents )
+		return;
+
+	const mat3 normalsTransform = glm::transpose( inverse( mat3( mTransform ) ) );
+	if( hasNormals ) {
 		vec3* normals = reinterpret_cast<vec3*>( ctx->getAttribData( NORMAL ) );
-		mat3 normalsTransform = glm::transpose( inverse( mat3( mTransform ) ) );
-		for( size_t v = 0; v < numVertices; ++v )
+		for( size_t v = begin; v < end; ++v )
 			normals[v] = normalize( normalsTransform * normals[v] );
 	}
-	else if( ctx->getAttribDims( NORMAL ) != 0 )
-		CI_LOG_W( "Unsupported dimension for geom::NORMAL passed to geom::Transform" );
-
-	// and finally, we'll make the sort of modification to our tangents (if they're present)
-	// using the inverse transpose of 'mTransform'
-	if( ctx->getAttribDims( TANGENT ) == 3 ) {
+	if( hasTangents ) {
 		vec3* tangents = reinterpret_cast<vec3*>( ctx->getAttribData( TANGENT ) );
-		mat3 tangentsTransform = glm::transpose( inverse( mat3( mTransform ) ) );
-		for( size_t v = 0; v < numVertices; ++v )
-			tangents[v] = normalize( tangentsTransform * tangents[v] );
+		for( size_t v = begin; v < end; ++v )
+			tangents[v] = normalize( normalsTransform * tangents[v] );
 	}
-	else if( ctx->getAttribDims( TANGENT ) != 0 )
-		CI_LOG_W( "Unsupported dimension for geom::TANGENT passed to geom::Transform" );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
 // Twist
-void Twist::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+bool Twist::prepare( SourceModsContext *ctx ) const
 {
-	ctx->processUpstream( requestedAttribs );
-	
-	const size_t numVertices = ctx->getNumVertices();
+	const uint8_t positionDims = ctx->getAttribDims( POSITION );
+	if( positionDims != 3 && positionDims != 0 )
+		CI_LOG_W( "Unsupported dimension for geom::POSITION passed to geom::Twist" );
+
+	return positionDims == 3;
+}
+
+void Twist::processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const
+{
+	if( ctx->getAttribDims( POSITION ) != 3 )
+		return;
+
 	const float invAxisLength = 1.0f / distance( mAxisStart, mAxisEnd );
 	const vec3 axisDir = ( mAxisEnd - mAxisStart ) * vec3( invAxisLength );
 
-	if( ctx->getAttribDims( POSITION ) == 3 ) {
-		vec3* positions = reinterpret_cast<vec3*>( ctx->getAttribData( POSITION ) );
-		vec3* normals = nullptr, *tangents = nullptr;
-		if( ctx->getAttribDims( NORMAL ) == 3 )
-			normals = reinterpret_cast<vec3*>( ctx->getAttribData( NORMAL ) );
-		if( ctx->getAttribDims( TANGENT ) == 3 )
-			tangents = reinterpret_cast<vec3*>( ctx->getAttribData( TANGENT ) );
-		
-		for( size_t v = 0; v < numVertices; ++v ) {
-			// find the 't' value of the point on the axis that inPosition is closest to
-			float closestDist = dot( positions[v] - mAxisStart, axisDir );
-			float tVal = glm::clamp<float>( closestDist * invAxisLength, 0, 1 );
-			// 'pointOnAxis' is the actual point on the axis inPosition is closest to
-			vec3 pointOnAxis = mAxisStart + axisDir * closestDist;
-			// our rotation is around the axis, and the angle is a lerp between 'mStartAngle' and 'mEndAngle' based on 't'
-			mat4 rotation = rotate( glm::mix( mStartAngle, mEndAngle, tVal ), axisDir );
-			// now transform the point by rotating around 'pointOnAxis'
-			mat4 transform = translate( pointOnAxis ) * rotation * translate( -pointOnAxis );
-			vec3 outPos = vec3( transform * vec4( positions[v], 1 ) );
-			positions[v] = outPos;
-			// we need to transform the normal by rotating it by the same angle (but not around the point) we did the position
-			if( normals )
-				normals[v] = vec3( rotation * vec4( normals[v], 0 ) );
-			// we need to transform the tangent by rotating it by the same angle (but not around the point) we did the position
-			if( tangents )
-				tangents[v] = vec3( rotation * vec4( tangents[v], 0 ) );
-		}
+	vec3* positions = reinterpret_cast<vec3*>( ctx->getAttribData( POSITION ) );
+	vec3* normals = nullptr, *tangents = nullptr;
+	if( ctx->getAttribDims( NORMAL ) == 3 )
+		normals = reinterpret_cast<vec3*>( ctx->getAttribData( NORMAL ) );
+	if( ctx->getAttribDims( TANGENT ) == 3 )
+		tangents = reinterpret_cast<vec3*>( ctx->getAttribData( TANGENT ) );
+	
+	for( size_t v = begin; v < end; ++v ) {
+		// find the 't' value of the point on the axis that inPosition is closest to
+		float closestDist = dot( positions[v] - mAxisStart, axisDir );
+		float tVal = glm::clamp<float>( closestDist * invAxisLength, 0, 1 );
+		// 'pointOnAxis' is the actual point on the axis inPosition is closest to
+		vec3 pointOnAxis = mAxisStart + axisDir * closestDist;
+		// our rotation is around the axis, and the angle is a lerp between 'mStartAngle' and 'mEndAngle' based on 't'
+		mat4 rotation = rotate( glm::mix( mStartAngle, mEndAngle, tVal ), axisDir );
+		// now transform the point by rotating around 'pointOnAxis'
+		mat4 transform = translate( pointOnAxis ) * rotation * translate( -pointOnAxis );
+		vec3 outPos = vec3( transform * vec4( positions[v], 1 ) );
+		positions[v] = outPos;
+		// we need to transform the normal by rotating it by the same angle (but not around the point) we did the position
+		if( normals )
+			normals[v] = vec3( rotation * vec4( normals[v], 0 ) );
+		// we need to transform the tangent by rotating it by the same angle (but not around the point) we did the position
+		if( tangents )
+			tangents[v] = vec3( rotation * vec4( tangents[v], 0 ) );
 	}
-	else if( ctx->getAttribDims( POSITION ) != 0 )
-		CI_LOG_W( "Unsupported dimension for geom::POSITION passed to geom::Twist" );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -2935,63 +3249,89 @@ AttribSet ColorFromAttrib::getAvailableAttribs( const Modifier::Params &upstream
 }
 
 namespace {
-template<typename I, typename IFD, typename O>
-void processColorAttrib( const I* inputData, O *outputData, const std::function<O(IFD)> &fn, size_t numVertices )
+template<typename I, typename IFD>
+void processColorAttrib( const I* inputData, Colorf *outputData, const std::function<Colorf(IFD)> &fn, size_t begin, size_t end )
 {
-	for( size_t v = 0; v < numVertices; ++v ) {
+	for( size_t v = begin; v < end; ++v ) {
 		IFD in( (IFD)inputData[v] );
 		outputData[v] = fn( in );
 	}
 }
 
-template<typename O>
-void processColorAttrib2d( const vec2* inputData, O *outputData, const std::function<O(vec3)> &fn, size_t numVertices )
+void processColorAttrib2d( const vec2* inputData, Colorf *outputData, const std::function<Colorf(vec3)> &fn, size_t begin, size_t end )
 {
-	for( size_t v = 0; v < numVertices; ++v ) {
+	for( size_t v = begin; v < end; ++v ) {
 		vec3 in( inputData[v], 0 );
 		outputData[v] = fn( in );
 	}
 }
+
+// Applies whichever of 'fn2' or 'fn3' is set to the vertices [begin, end) of 'inputData'
+void processColorAttrib( uint8_t inputDims, const float *inputData, Colorf *outputData, const std::function<Colorf(vec2)> &fn2, const std::function<Colorf(vec3)> &fn3, size_t begin, size_t end )
+{
+	if( fn2 ) {
+		if( inputDims == 2 )
+			processColorAttrib( reinterpret_cast<const vec2*>( inputData ), outputData, fn2, begin, end );
+		else if( inputDims == 3 )
+			processColorAttrib( reinterpret_cast<const vec3*>( inputData ), outputData, fn2, begin, end );
+		else if( inputDims == 4 )
+			processColorAttrib( reinterpret_cast<const vec4*>( inputData ), outputData, fn2, begin, end );
+	}
+	else if( fn3 ) {
+		if( inputDims == 2 )
+			processColorAttrib2d( reinterpret_cast<const vec2*>( inputData ), outputData, fn3, begin, end );
+		else if( inputDims == 3 )
+			processColorAttrib( reinterpret_cast<const vec3*>( inputData ), outputData, fn3, begin, end );
+		else if( inputDims == 4 )
+			processColorAttrib( reinterpret_cast<const vec4*>( inputData ), outputData, fn3, begin, end );
+	}
+}
 } // anonymous namespace
 
-void ColorFromAttrib::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+bool ColorFromAttrib::isInPlace( const SourceModsContext &ctx ) const
 {
-	AttribSet request = requestedAttribs;
-	request.insert( mAttrib );
-	ctx->processUpstream( request );
+	// changing the dimensions of an existing COLOR requires everything upstream to have finished with it
+	const uint8_t colorDims = ctx.getAttribDims( Attrib::COLOR );
+	return colorDims == 0 || colorDims == 3;
+}
 
+bool ColorFromAttrib::prepare( SourceModsContext *ctx ) const
+{
 	// if we have no function to apply just continue
 	if( ( ! mFnColor2 ) && ( ! mFnColor3 ) )
-		return;
+		return false;
 
-	if( ctx->getAttribDims( mAttrib ) == 0 ) {
+	const uint8_t inputAttribDims = ctx->getAttribDims( mAttrib );
+	if( inputAttribDims == 0 ) {
 		CI_LOG_W( "ColorFromAttrib called on geom::Source missing requested " << attribToString( mAttrib ) );
-		return;
+		return false;
 	}
-
-	const auto numVertices = ctx->getNumVertices();
-	unique_ptr<float[]> mColorData( new float[numVertices * 3] );
-	uint8_t inputAttribDims = ctx->getAttribDims( mAttrib );
-	const float* inputAttribData = ctx->getAttribData( mAttrib );
-	
-	if( mFnColor2 ) {
-		if( inputAttribDims == 2 )
-			processColorAttrib( reinterpret_cast<const vec2*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices );
-		else if( inputAttribDims == 3 )
-			processColorAttrib( reinterpret_cast<const vec3*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices );
-		else if( inputAttribDims == 4 )
-			processColorAttrib( reinterpret_cast<const vec4*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices );
+	if( inputAttribDims < 2 ) {
+		CI_LOG_W( "ColorFromAttrib unsupported dimension for " << attribToString( mAttrib ) );
+		return false;
 	}
-	else if( mFnColor3 ) {
-		if( inputAttribDims == 2 )
-			processColorAttrib2d( reinterpret_cast<const vec2*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices );
-		if( inputAttribDims == 3 )
-			processColorAttrib( reinterpret_cast<const vec3*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices );
-		else if( inputAttribDims == 4 )
-			processColorAttrib( reinterpret_cast<const vec4*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices );
+
+	const size_t numVertices = ctx->getNumVertices();
+	// reading and writing COLOR at different dimensions can't happen in place; compute the result up front
+	if( mAttrib == Attrib::COLOR && inputAttribDims != 3 ) {
+		Colorf *colors = reinterpret_cast<Colorf*>( ctx->getScratchData( numVertices * 3 ) );
+		processColorAttrib( inputAttribDims, ctx->getAttribData( mAttrib ), colors, mFnColor2, mFnColor3, 0, numVertices );
+		ctx->copyAttrib( Attrib::COLOR, 3, 0, (const float*)colors, numVertices );
+		return false;
 	}
 
-	ctx->copyAttrib( Attrib::COLOR, 3, 0, mColorData.get(), numVertices );
+	size_t strideBytes;
+	ctx->getAttribStorage( Attrib::COLOR, 3, numVertices, &strideBytes );
+	return true;
+}
+
+void ColorFromAttrib::processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const
+{
+	if( ctx->getAttribDims( Attrib::COLOR ) != 3 )
+		return;
+
+	Colorf *colors = reinterpret_cast<Colorf*>( ctx->getAttribData( Attrib::COLOR ) );
+	processColorAttrib( ctx->getAttribDims( mAttrib ), ctx->getAttribData( mAttrib ), colors, mFnColor2, mFnColor3, begin, end );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -3011,44 +3351,32 @@ AttribSet Constant::getAvailableAttribs( const Modifier::Params &upstreamParams
 	return result;
 }
 
-void Constant::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+bool Constant::isInPlace( const SourceModsContext &ctx ) const
 {
-	ctx->processUpstream( requestedAttribs );
+	const uint8_t dims = ctx.getAttribDims( mAttrib );
+	return dims == 0 || dims == mDims;
+}
 
-	const size_t numVertices = ctx->getNumVertices();
-	
-	switch( mDims ) {
-		case 1: {
-			unique_ptr<float[]> mColorData( new float[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = mValue.x;
-			ctx->copyAttrib( mAttrib, 1, 0, (const float*)mColorData.get(), numVertices );
-		}
-		break;
-		case 2: {
-			unique_ptr<vec2[]> mColorData( new vec2[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = vec2( mValue.x, mValue.y );
-			ctx->copyAttrib( mAttrib, 2, 0, (const float*)mColorData.get(), numVertices );
-		}
-		break;
-		case 3: {
-			unique_ptr<vec3[]> mColorData( new vec3[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = vec3( mValue.x, mValue.y, mValue.z );
-			ctx->copyAttrib( mAttrib, 3, 0, (const float*)mColorData.get(), numVertices );
-		}
-		break;
-		case 4: {
-			unique_ptr<vec4[]> mColorData( new vec4[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = mValue;
-			ctx->copyAttrib( mAttrib, 4, 0, (const float*)mColorData.get(), numVertices );
-		}
-		break;
-		default:
-			CI_LOG_E( "Illegal dimensions." );
+bool Constant::prepare( SourceModsContext *ctx ) const
+{
+	if( mDims < 1 || mDims > 4 ) {
+		CI_LOG_E( "Illegal dimensions." );
+		return false;
 	}
+
+	size_t strideBytes;
+	return ctx->getAttribStorage( mAttrib, mDims, ctx->getNumVertices(), &strideBytes ) != nullptr;
+}
+
+void Constant::processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const
+{
+	if( ctx->getAttribDims( mAttrib ) != mDims )
+		return;
+
+	float *data = ctx->getAttribData( mAttrib );
+	for( size_t v = begin; v < end; ++v )
+		for( uint8_t d = 0; d < mDims; ++d )
+			data[v * mDims + d] = mValue[d];
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -3072,46 +3400,76 @@ AttribSet AttribFn<S,D>::getAvailableAttribs( const Modifier::Params &upstreamPa
 
 namespace {
 template<typename S, typename D>
-void processAttrib( const float *inputDataFloat, float *outputDataFloat, const std::function<D(S)> &fn, size_t numVertices )
+void processAttrib( const float *inputDataFloat, float *outputDataFloat, const std::function<D(S)> &fn, size_t begin, size_t end )
 {
 	const S *inData = reinterpret_cast<const S*>( inputDataFloat );
 	D *outData = reinterpret_cast<D*>( outputDataFloat );
 
-	for( size_t v = 0; v < numVertices; ++v )
+	for( size_t v = begin; v < end; ++v )
 		outData[v] = fn( inData[v] );
 }
+
+// Variant of processAttrib() for when the input attribute isn't of the dimensions 'fn' expects; converts each input following copyData()
+template<typename S, typename D>
+void processAttribConverted( uint8_t inputDims, const float *inputData, float *outputDataFloat, const std::function<D(S)> &fn, size_t begin, size_t end )
+{
+	D *outData = reinterpret_cast<D*>( outputDataFloat );
+	for( size_t v = begin; v < end; ++v ) {
+		float in[4];
+		geom::copyData( inputDims, inputData + v * inputDims, 1, sizeof(S) / sizeof(float), 0, in );
+		outData[v] = fn( *reinterpret_cast<const S*>( in ) );
+	}
+}
 } // anonymous namespace
 
 template<typename S, typename D>
-void geom::AttribFn<S,D>::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+bool geom::AttribFn<S,D>::isInPlace( const SourceModsContext &ctx ) const
 {
-	AttribSet request = requestedAttribs;
-	request.insert( mSrcAttrib );
-	ctx->processUpstream( request );
+	// changing the dimensions of an existing attribute requires everything upstream to have finished with it
+	const uint8_t dstDims = ctx.getAttribDims( mDstAttrib );
+	return dstDims == 0 || dstDims == DSTDIM;
+}
 
-	if( ctx->getAttribDims( mSrcAttrib ) == 0 ) {
+template<typename S, typename D>
+bool geom::AttribFn<S,D>::prepare( SourceModsContext *ctx ) const
+{
+	const uint8_t inputAttribDims = ctx->getAttribDims( mSrcAttrib );
+	if( inputAttribDims == 0 ) {
 		CI_LOG_W( "AttribFn called on geom::Source missing requested " << attribToString( mSrcAttrib ) );
-		return;
+		return false;
 	}
-
-	const auto numVertices = ctx->getNumVertices();
-	std::unique_ptr<float[]> outData( new float[numVertices * DSTDIM] );
-	std::unique_ptr<float[]> tempInData;
-	const float *inputAttribData;
-	const uint8_t inputAttribDims = ctx->getAttribDims( mSrcAttrib );
-	// if the actual input dims of the attribute don't equal SRCDIMS, we'll need to temporarily copy it to a buffer
-	if( inputAttribDims != SRCDIM ) {
+	if( inputAttribDims != SRCDIM )
 		CI_LOG_W( "AttribFn source dimensions don't match for attrib " << attribToString( mSrcAttrib ) );
-		tempInData = std::unique_ptr<float[]>( new float[numVertices * SRCDIM] );
-		auto tempDataWrongDims = ctx->getAttribData( mSrcAttrib );
-		geom::copyData( inputAttribDims, tempDataWrongDims, numVertices, SRCDIM, 0, tempInData.get() );
-		inputAttribData = tempInData.get();
+
+	const size_t numVertices = ctx->getNumVertices();
+	// reading and writing the same attribute at different dimensions can't happen in place; compute the result up front
+	if( mSrcAttrib == mDstAttrib && inputAttribDims != DSTDIM ) {
+		float *outData = ctx->getScratchData( numVertices * DSTDIM );
+		if( inputAttribDims != SRCDIM )
+			processAttribConverted<S,D>( inputAttribDims, ctx->getAttribData( mSrcAttrib ), outData, mFn, 0, numVertices );
+		else
+			processAttrib<S,D>( ctx->getAttribData( mSrcAttrib ), outData, mFn, 0, numVertices );
+		ctx->copyAttrib( mDstAttrib, DSTDIM, 0, outData, numVertices );
+		return false;
 	}
+
+	size_t strideBytes;
+	return ctx->getAttribStorage( mDstAttrib, DSTDIM, numVertices, &strideBytes ) != nullptr;
+}
+
+template<typename S, typename D>
+void geom::AttribFn<S,D>::processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const
+{
+	const uint8_t inputAttribDims = ctx->getAttribDims( mSrcAttrib );
+	if( inputAttribDims == 0 || ctx->getAttribDims( mDstAttrib ) != DSTDIM )
+		return;
+
+	const float *inputAttribData = ctx->getAttribData( mSrcAttrib );
+	float *outputAttribData = ctx->getAttribData( mDstAttrib );
+	if( inputAttribDims != SRCDIM )
+		processAttribConverted<S,D>( inputAttribDims, inputAttribData, outputAttribData, mFn, begin, end );
 	else
-		inputAttribData = ctx->getAttribData( mSrcAttrib );
-	
-	processAttrib<S,D>( inputAttribData, outData.get(), mFn, numVertices );
-	ctx->copyAttrib( mDstAttrib, DSTDIM, 0, outData.get(), numVertices );
+		processAttrib<S,D>( inputAttribData, outputAttribData, mFn, begin, end );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -3156,77 +3514,80 @@ void Extrude::updatePathSubdivision()
 	mCap = triangulator.createMesh();
 }
 
-void Extrude::calculate( vector<vec3> *positions, vector<vec3> *normals, vector<vec3> *texCoords, vector<uint32_t> *indices ) const
+void Extrude::calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec3> texCoords, uint32_t *indices ) const
 {
 	// CAPS VERTICES
 	uint32_t numCapVertices = (uint32_t)mCap->getNumVertices();
 	const vec2* capPositions = mCap->getPositions<2>();
+	uint32_t numVertices = 0;
 	// front cap
 	if( mFrontCap )
-		for( size_t v = 0; v < numCapVertices; ++v ) {
-			positions->emplace_back( vec3( capPositions[v], mDistance * 0.5f ) );
-			normals->emplace_back( vec3( 0, 0, 1 ) );
-			texCoords->emplace_back( vec3( ( positions->back().x - mCapBounds.x1 ) / mCapBounds.getWidth(),
-											1.0f - ( positions->back().y - mCapBounds.y1 ) / mCapBounds.getHeight(),
-											0 ) );
+		for( size_t v = 0; v < numCapVertices; ++v, ++numVertices ) {
+			positions[numVertices] = vec3( capPositions[v], mDistance * 0.5f );
+			normals[numVertices] = vec3( 0, 0, 1 );
+			texCoords[numVertices] = vec3( ( capPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
+											1.0f - ( capPositions[v].y - mCapBounds.y1 ) / mCapBounds.getHeight(),
+											0 );
 		}
 	// back cap
 	if( mBackCap )
-		for( size_t v = 0; v < numCapVertices; ++v ) {
-			positions->emplace_back( vec3( capPositions[v], -mDistance * 0.5f ) );
-			normals->emplace_back( vec3( 0, 0, -1 ) );
-			texCoords->emplace_back( vec3( ( positions->back().x - mCapBounds.x1 ) / mCapBounds.getWidth(),
-											1.0f - ( positions->back().y - mCapBounds.y1 ) / mCapBounds.getHeight(),
-											1 ) );
+		for( size_t v = 0; v < numCapVertices; ++v, ++numVertices ) {
+			positions[numVertices] = vec3( capPositions[v], -mDistance * 0.5f );
+			normals[numVertices] = vec3( 0, 0, -1 );
+			texCoords[numVertices] = vec3( ( capPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
+											1.0f - ( capPositions[v].y - mCapBounds.y1 ) / mCapBounds.getHeight(),
+											1 );
 		}
 
 	// CAP INDICES
-	auto capIndices = mCap->getIndices();
+	const auto &capIndices = mCap->getIndices();
+	size_t numIndices = 0;
 	// front cap
 	if( mFrontCap )
 		for( size_t i = 0; i < capIndices.size(); ++i )
-			indices->push_back( capIndices[i] );
+			indices[numIndices++] = capIndices[i];
 	// back cap
 	if( mBackCap ) {
 		for( size_t i = 0; i < capIndices.size(); i += 3 ) { // we need to reverse the winding order for the back cap
-			indices->push_back( capIndices[i+2] + numCapVertices );
-			indices->push_back( capIndices[i+1] + numCapVertices );
-			indices->push_back( capIndices[i+0] + numCapVertices );
+			indices[numIndices++] = capIndices[i+2] + numCapVertices;
+			indices[numIndices++] = capIndices[i+1] + numCapVertices;
+			indices[numIndices++] = capIndices[i+0] + numCapVertices;
 		}
 	}
 	
 	// EXTRUSION
 	// we don't make use of the caps' vertices because their normals are wrong,
 	// so we'll need to create verts unique to the extrusion
-	for( size_t p = 0; p < mPathSubdivisionPositions.size(); ++p ) {
-		for( int sub = 0; sub <= mSubdivisions; ++sub ) {
-			const float t = sub / (float)mSubdivisions;
-			const float distance = ( 0.5f - t ) * mDistance;
-			const auto &pathPositions = mPathSubdivisionPositions[p];
-			const auto &pathTangents = mPathSubdivisionTangents[p];
-			// add all the positions & normals
-			uint32_t baseIndex = (uint32_t)positions->size();
-			for( size_t v = 0; v < pathPositions.size(); ++v ) {
-				positions->emplace_back( pathPositions[v], distance );
-				normals->emplace_back( vec2( pathTangents[v].y, -pathTangents[v].x ), 0 );
-				texCoords->emplace_back( ( positions->back().x - mCapBounds.x1 ) / mCapBounds.getWidth(),
-											1.0f - ( positions->back().y - mCapBounds.y1 ) / mCapBounds.getHeight(),
-											t );
-			}
-			// add the indices
-			if( sub != mSubdivisions ) {
-				uint32_t numSubdivVerts = (uint32_t)pathPositions.size();
-				for( uint32_t j = numSubdivVerts-1, i = 0; i < numSubdivVerts; j = i++ ) {
-					indices->push_back( baseIndex + i );
-					indices->push_back( baseIndex + j );
-					indices->push_back( baseIndex + numSubdivVerts + j );
-					indices->push_back( baseIndex + i );
-					indices->push_back( baseIndex + numSubdivVerts + j );
-					indices->push_back( baseIndex + numSubdivVerts + i );
-				}
+	const auto rows = calcExtrusionRows( mPathSubdivisionPositions, mSubdivisions, numVertices, numIndices );
+	forEachRow( rows.size(), ( getNumVertices() - numVertices ) / std::max<size_t>( rows.size(), 1 ), [&]( size_t r ) {
+		const ExtrusionRow &row = rows[r];
+		const float t = row.sub / (float)mSubdivisions;
+		const float distance = ( 0.5f - t ) * mDistance;
+		const auto &pathPositions = mPathSubdivisionPositions[row.path];
+		const auto &pathTangents = mPathSubdivisionTangents[row.path];
+		// the positions & normals
+		for( size_t v = 0; v < pathPositions.size(); ++v ) {
+			const size_t vert = row.baseVertex + v;
+			positions[vert] = vec3( pathPositions[v], distance );
+			normals[vert] = vec3( vec2( pathTangents[v].y, -pathTangents[v].x ), 0 );
+			texCoords[vert] = vec3( ( pathPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
+									1.0f - ( pathPositions[v].y - mCapBounds.y1 ) / mCapBounds.getHeight(),
+									t );
+		}
+		// the indices
+		if( row.sub != mSubdivisions ) {
+			uint32_t *index = indices + row.baseIndex;
+			uint32_t numSubdivVerts = (uint32_t)pathPositions.size();
+			for( uint32_t j = numSubdivVerts-1, i = 0; i < numSubdivVerts; j = i++ ) {
+				*index++ = row.baseVertex + i;
+				*index++ = row.baseVertex + j;
+				*index++ = row.baseVertex + numSubdivVerts + j;
+				*index++ = row.baseVertex + i;
+				*index++ = row.baseVertex + numSubdivVerts + j;
+				*index++ = row.baseVertex + numSubdivVerts + i;
 			}
 		}
-	}
+	} );
 }
 	
 size_t Extrude::getNumVertices() const
@@ -3272,22 +3633,24 @@ AttribSet Extrude::getAvailableAttribs() const
 
 void Extrude::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 {
-	vector<vec3> positions, normals, texCoords;
-	vector<uint32_t> indices;
+	const bool needTangents = requestedAttribs.count( geom::TANGENT ) > 0;
+	const size_t numVertices = getNumVertices();
+	AttribStorage<vec3> positions( target, Attrib::POSITION, numVertices, true, needTangents );
+	AttribStorage<vec3> normals( target, Attrib::NORMAL, numVertices, true, needTangents );
+	AttribStorage<vec3> texCoords( target, Attrib::TEX_COORD_0, numVertices, true, needTangents );
+	vector<uint32_t> indices( getNumIndices() );
 
-	calculate( &positions, &normals, &texCoords, &indices );
+	calculate( positions.get(), normals.get(), texCoords.get(), indices.data() );
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, (const float*)positions.data(), positions.size() );
-	target->copyAttrib( Attrib::NORMAL, 3, 0, (const float*)normals.data(), normals.size() );
-	target->copyAttrib( Attrib::TEX_COORD_0, 3, 0, (const float*)texCoords.data(), texCoords.size() );
+	positions.commit();
+	normals.commit();
+	texCoords.commit();
 
 	// generate tangents
-	if( requestedAttribs.count( geom::TANGENT ) ) {
+	if( needTangents ) {
 		vector<vec3> tangents;
-		calculateTangents( getNumIndices(), indices.data(), positions.size(), positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
-		
-		if( requestedAttribs.count( geom::TANGENT ) )
-			target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
+		calculateTangents( indices.size(), indices.data(), numVertices, positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
+		target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
 	}
 
 	target->copyIndices( Primitive::TRIANGLES, indices.data(), indices.size(), calcIndicesRequiredBytes( indices.size() ) );
@@ -3347,79 +3710,82 @@ void ExtrudeSpline::updatePathSubdivision()
 	mCap = triangulator.createMesh();
 }
 
-void ExtrudeSpline::calculate( vector<vec3> *positions, vector<vec3> *normals, vector<vec3> *texCoords, vector<uint32_t> *indices ) const
+void ExtrudeSpline::calculate( StridedPtr<vec3> positions, StridedPtr<vec3> normals, StridedPtr<vec3> texCoords, uint32_t *indices ) const
 {
 	auto capNumVertices = mCap->getNumVertices();
+	uint32_t numVertices = 0;
 	
 	// CAP VERTICES
 	const vec2* capPositions = mCap->getPositions<2>();
 	// front cap
 	if( mFrontCap ) {
 		const vec3 frontNormal = vec3( mSplineFrames.front() * vec4( 0, 0, -1, 0 ) );
-		for( size_t v = 0; v < mCap->getNumVertices(); ++v ) {
-			positions->emplace_back( mSplineFrames.front() * vec4( capPositions[v], 0, 1 ) );
-			normals->emplace_back( frontNormal );
-			texCoords->emplace_back( vec3( ( capPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
+		for( size_t v = 0; v < mCap->getNumVertices(); ++v, ++numVertices ) {
+			positions[numVertices] = vec3( mSplineFrames.front() * vec4( capPositions[v], 0, 1 ) );
+			normals[numVertices] = frontNormal;
+			texCoords[numVertices] = vec3( ( capPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
 											1.0f - ( capPositions[v].y - mCapBounds.y1 ) / mCapBounds.getHeight(),
-											0 ) );
+											0 );
 		}
 	}
 	// back cap
 	if( mBackCap ) {
 		const vec3 backNormal = vec3( mSplineFrames.back() * vec4( 0, 0, 1, 0 ) );
-		for( size_t v = 0; v < mCap->getNumVertices(); ++v ) {
-			positions->emplace_back( mSplineFrames.back() * vec4( capPositions[v], 0, 1 ) );
-			normals->emplace_back( backNormal );
-			texCoords->emplace_back( vec3( ( capPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
+		for( size_t v = 0; v < mCap->getNumVertices(); ++v, ++numVertices ) {
+			positions[numVertices] = vec3( mSplineFrames.back() * vec4( capPositions[v], 0, 1 ) );
+			normals[numVertices] = backNormal;
+			texCoords[numVertices] = vec3( ( capPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
 											1.0f - ( capPositions[v].y - mCapBounds.y1 ) / mCapBounds.getHeight(),
-											1 ) );
+											1 );
 		}
 	}
 	
 	// CAP INDICES
-	auto capIndices = mCap->getIndices();
+	const auto &capIndices = mCap->getIndices();
+	size_t numIndices = 0;
 	// front cap
 	if( mFrontCap )
 		for( size_t i = 0; i < capIndices.size(); ++i )
-			indices->push_back( capIndices[i] );
+			indices[numIndices++] = capIndices[i];
 	// back cap
 	if( mBackCap ) {
 		for( size_t i = 0; i < capIndices.size(); i += 3 ) { // we need to reverse the winding order for the back cap
-			indices->push_back( capIndices[i+2] + (uint32_t)capNumVertices );
-			indices->push_back( capIndices[i+1] + (uint32_t)capNumVertices );
-			indices->push_back( capIndices[i+0] + (uint32_t)capNumVertices );
+			indices[numIndices++] = capIndices[i+2] + (uint32_t)capNumVertices;
+			indices[numIndices++] = capIndices[i+1] + (uint32_t)capNumVertices;
+			indices[numIndices++] = capIndices[i+0] + (uint32_t)capNumVertices;
 		}
 	}
 
 	// EXTRUSION
-	for( size_t p = 0; p < mPathSubdivisionPositions.size(); ++p ) {
-		for( int sub = 0; sub <= mSubdivisions; ++sub ) {
-			const mat4 &transform = mSplineFrames[sub];
-			const auto &pathPositions = mPathSubdivisionPositions[p];
-			const auto &pathTangents = mPathSubdivisionTangents[p];
-			// add all the positions & normals
-			uint32_t baseIndex = (uint32_t)positions->size();
-			for( size_t v = 0; v < pathPositions.size(); ++v ) {
-				positions->emplace_back( vec3( transform * vec4( pathPositions[v], 0, 1 ) ) );
-				normals->emplace_back( transform * vec4( vec2( pathTangents[v].y, -pathTangents[v].x ), 0, 0 ) );
-				texCoords->emplace_back( ( pathPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
-											1.0f - ( pathPositions[v].y - mCapBounds.y1 ) / mCapBounds.getHeight(),
-											mSplineTimes[sub] );
-			}
-			// add the indices
-			if( sub != mSubdivisions ) {
-				uint32_t numSubdivVerts = (uint32_t)pathPositions.size();
-				for( uint32_t j = numSubdivVerts-1, i = 0; i < numSubdivVerts; j = i++ ) {
-					indices->push_back( baseIndex + i );
-					indices->push_back( baseIndex + j );
-					indices->push_back( baseIndex + numSubdivVerts + j );
-					indices->push_back( baseIndex + i );
-					indices->push_back( baseIndex + numSubdivVerts + j );
-					indices->push_back( baseIndex + numSubdivVerts + i );
-				}
+	const auto rows = calcExtrusionRows( mPathSubdivisionPositions, mSubdivisions, numVertices, numIndices );
+	forEachRow( rows.size(), ( getNumVertices() - numVertices ) / std::max<size_t>( rows.size(), 1 ), [&]( size_t r ) {
+		const ExtrusionRow &row = rows[r];
+		const mat4 &transform = mSplineFrames[row.sub];
+		const auto &pathPositions = mPathSubdivisionPositions[row.path];
+		const auto &pathTangents = mPathSubdivisionTangents[row.path];
+		// the positions & normals
+		for( size_t v = 0; v < pathPositions.size(); ++v ) {
+			const size_t vert = row.baseVertex + v;
+			positions[vert] = vec3( transform * vec4( pathPositions[v], 0, 1 ) );
+			normals[vert] = vec3( transform * vec4( vec2( pathTangents[v].y, -pathTangents[v].x ), 0, 0 ) );
+			texCoords[vert] = vec3( ( pathPositions[v].x - mCapBounds.x1 ) / mCapBounds.getWidth(),
+									1.0f - ( pathPositions[v].y - mCapBounds.y1 ) / mCapBounds.getHeight(),
+									mSplineTimes[row.sub] );
+		}
+		// the indices
+		if( row.sub != mSubdivisions ) {
+			uint32_t *index = indices + row.baseIndex;
+			uint32_t numSubdivVerts = (uint32_t)pathPositions.size();
+			for( uint32_t j = numSubdivVerts-1, i = 0; i < numSubdivVerts; j = i++ ) {
+				*index++ = row.baseVertex + i;
+				*index++ = row.baseVertex + j;
+				*index++ = row.baseVertex + numSubdivVerts + j;
+				*index++ = row.baseVertex + i;
+				*index++ = row.baseVertex + numSubdivVerts + j;
+				*index++ = row.baseVertex + numSubdivVerts + i;
 			}
 		}
-	}
+	} );
 }
 	
 size_t ExtrudeSpline::getNumVertices() const
@@ -3465,22 +3831,24 @@ AttribSet ExtrudeSpline::getAvailableAttribs() const
 
 void ExtrudeSpline::loadInto( Target *target, const AttribSet &requestedAttribs ) const
 {
-	vector<vec3> positions, normals, texCoords;
-	vector<uint32_t> indices;
+	const bool needTangents = requestedAttribs.count( geom::TANGENT ) > 0;
+	const size_t numVertices = getNumVertices();
+	AttribStorage<vec3> positions( target, Attrib::POSITION, numVertices, true, needTangents );
+	AttribStorage<vec3> normals( target, Attrib::NORMAL, numVertices, true, needTangents );
+	AttribStorage<vec3> texCoords( target, Attrib::TEX_COORD_0, numVertices, true, needTangents );
+	vector<uint32_t> indices( getNumIndices() );
 
-	calculate( &positions, &normals, &texCoords, &indices );
+	calculate( positions.get(), normals.get(), texCoords.get(), indices.data() );
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, (const float*)positions.data(), positions.size() );
-	target->copyAttrib( Attrib::NORMAL, 3, 0, (const float*)normals.data(), normals.size() );
-	target->copyAttrib( Attrib::TEX_COORD_0, 3, 0, (const float*)texCoords.data(), texCoords.size() );
+	positions.commit();
+	normals.commit();
+	texCoords.commit();
 
 	// generate tangents
-	if( requestedAttribs.count( geom::TANGENT ) ) {
+	if( needTangents ) {
 		vector<vec3> tangents;
-		calculateTangents( getNumIndices(), indices.data(), positions.size(), positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
-		
-		if( requestedAttribs.count( geom::TANGENT ) )
-			target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
+		calculateTangents( indices.size(), indices.data(), numVertices, positions.data(), normals.data(), texCoords.data(), &tangents, nullptr );
+		target->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), tangents.size() );
 	}
 
 	target->copyIndices( Primitive::TRIANGLES, indices.data(), indices.size(), calcIndicesRequiredBytes( indices.size() ) );
@@ -4286,11 +4654,7 @@ AttribSet Tangents::getAvailableAttribs( const Modifier::Params &upstreamParams
 
 void Tangents::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
 {
-	AttribSet request = requestedAttribs;
-	request.insert( Attrib::POSITION );
-	request.insert( Attrib::NORMAL );
-	request.insert( Attrib::TEX_COORD_0 );
-	ctx->processUpstream( request );
+	ctx->processUpstream( requestedAttribs, { Attrib::POSITION, Attrib::NORMAL, Attrib::TEX_COORD_0 } );
 
 	const size_t numIndices = ctx->getNumIndices();
 	const size_t numVertices = ctx->getNumVertices();
@@ -4317,34 +4681,41 @@ void Tangents::process( SourceModsContext *ctx, const AttribSet &requestedAttrib
 	const vec2 *texCoords = (const vec2*)ctx->getAttribData( geom::TEX_COORD_0 );
 	
 	if( requestedAttribs.count( geom::TANGENT ) || requestedAttribs.count( geom::BITANGENT ) ) {
-		vector<vec3> tangents, bitangents;
-		vector<vec3> *bitangentPtr = ( requestedAttribs.count( geom::BITANGENT ) ) ? &bitangents : nullptr;
-		calculateTangents( numIndices, ctx->getIndicesData(), numVertices, positions, normals, texCoords, &tangents, bitangentPtr );
-		
+		// compute directly into the context's storage; the tangents are needed for the bitangents even if they weren't requested
+		size_t strideBytes;
+		vec3 *tangents, *bitangents = nullptr;
 		if( requestedAttribs.count( geom::TANGENT ) )
-			ctx->copyAttrib( Attrib::TANGENT, 3, 0, (const float*)tangents.data(), numVertices );
-		if( bitangentPtr )
-			ctx->copyAttrib( Attrib::BITANGENT, 3, 0, (const float*)bitangentPtr, numVertices );
+			tangents = (vec3*)ctx->getAttribStorage( Attrib::TANGENT, 3, numVertices, &strideBytes );
+		else
+			tangents = (vec3*)ctx->getScratchData( numVertices * 3 );
+		if( requestedAttribs.count( geom::BITANGENT ) )
+			bitangents = (vec3*)ctx->getAttribStorage( Attrib::BITANGENT, 3, numVertices, &strideBytes );
+		calculateTangentsImpl( numIndices, ctx->getIndicesData(), numVertices, positions, normals, texCoords, tangents, bitangents );
 	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
 // Invert
-void Invert::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+bool Invert::prepare( SourceModsContext *ctx ) const
 {
-	ctx->processUpstream( requestedAttribs );
-
 	if( ctx->getAttribDims( mAttrib ) == 0 ) {
 		CI_LOG_W( "geom::Invert missing attrib: " << attribToString( mAttrib ) );
-		return;
+		return false;
 	}
-	
+
+	return true;
+}
+
+void Invert::processVertices( SourceModsContext *ctx, size_t begin, size_t end ) const
+{
+	const uint8_t dims = ctx->getAttribDims( mAttrib );
 	float *d = ctx->getAttribData( mAttrib );
-	size_t maxIdx = ctx->getAttribDims( mAttrib ) * ctx->getNumVertices();
-	for( size_t i = 0; i < maxIdx; ++i )
+	if( ! d )
+		return;
+
+	// we don't need to copyAttrib() because we process in place
+	for( size_t i = begin * dims; i < end * dims; ++i )
 		d[i] = -d[i];
-	
-	// we don't need to copyAttrib() because we processed in place
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -4414,9 +4785,7 @@ size_t determineRequiredIndices( Primitive sourcePrimitive, Primitive destPrimit
 // Bounds
 void Bounds::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
 {
-	AttribSet request = requestedAttribs;
-	request.insert( mAttrib );
-	ctx->processUpstream( request );
+	ctx->processUpstream( requestedAttribs, { mAttrib } );
 	
 	uint8_t dims = ctx->getAttribDims( mAttrib );
 	if( dims == 0 ) {
@@ -4453,6 +4822,57 @@ void Bounds::process( SourceModsContext *ctx, const AttribSet &requestedAttribs
 		*mResult = AxisAlignedBox( minResult, maxResult );
 }
 
+//////////////////////////////////////////////////////////////////////////////////////
+// Optimize
+void Optimize::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+{
+	if( mOverdraw )
+		ctx->processUpstream( requestedAttribs, { POSITION } );
+	else
+		ctx->processUpstream( requestedAttribs );
+
+	if( ctx->getPrimitive() != Primitive::TRIANGLES || ! ctx->getNumIndices() ) {
+		CI_LOG_W( "geom::Optimize requires indexed TRIANGLES." );
+		return;
+	}
+
+	const size_t numVertices = ctx->getNumVertices();
+	const size_t numIndices = ctx->getNumIndices();
+	uint32_t *indices = ctx->getIndicesData();
+
+	if( mAcmrBefore )
+		*mAcmrBefore = calcAcmr( numIndices, indices, numVertices, mCacheSize );
+
+	if( mVertexCache )
+		optimizeVertexCache( numIndices, indices, numVertices, mCacheSize );
+
+	if( mOverdraw ) {
+		if( ctx->getAttribDims( POSITION ) == 3 )
+			optimizeOverdraw( numIndices, indices, numVertices, reinterpret_cast<const vec3*>( ctx->getAttribData( POSITION ) ), mCacheSize, mOverdrawThreshold );
+		else
+			CI_LOG_W( "geom::Optimize requires 3D POSITION to reduce overdraw." );
+	}
+
+	if( mVertexFetch ) {
+		vector<uint32_t> remap;
+		optimizeVertexFetch( numIndices, indices, numVertices, &remap );
+		for( size_t a = 0; a < NUM_ATTRIBS; ++a ) {
+			const uint8_t dims = ctx->getAttribDims( (Attrib)a );
+			if( dims == 0 )
+				continue;
+
+			float *data = ctx->getAttribData( (Attrib)a );
+			float *reordered = ctx->getScratchData( numVertices * dims );
+			for( size_t v = 0; v < numVertices; ++v )
+				std::copy( data + v * dims, data + ( v + 1 ) * dims, reordered + remap[v] * dims );
+			std::copy( reordered, reordered + numVertices * dims, data );
+		}
+	}
+
+	if( mAcmrAfter )
+		*mAcmrAfter = calcAcmr( numIndices, indices, numVertices, mCacheSize );
+}
+
 //////////////////////////////////////////////////////////////////////////////////////
 // Subdivide
 size_t Subdivide::getNumVertices( const Modifier::Params &upstreamParams ) const
@@ -4479,9 +4899,7 @@ size_t Subdivide::getNumIndices( const Modifier::Params &upstreamParams ) const
 
 void Subdivide::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
 {
-	AttribSet request = requestedAttribs;
-	request.insert( POSITION );
-	ctx->processUpstream( request );
+	ctx->processUpstream( requestedAttribs, { POSITION } );
 	
 	if( ctx->getPrimitive() != Primitive::TRIANGLES ) {
 		CI_LOG_E( "geom::PhongTessellate only supports TRIANGLES primitive." );
@@ -4495,62 +4913,85 @@ void Subdivide::process( SourceModsContext *ctx, const AttribSet &requestedAttri
 	
 	const size_t numInVertices = ctx->getNumVertices();
 	const size_t numInIndices = ctx->getNumIndices();
+	const size_t numInTriangles = numInIndices / 3;
 	
 	const uint32_t *inIndices = ctx->getIndicesData();
-	const vec3 *inPositions = reinterpret_cast<const vec3*>( ctx->getAttribData( POSITION ) );
-	
-	vector<vec3> outPositions;
-	vector<uint32_t> outIndices;
+	uint32_t *outIndices = ctx->getScratchIndices( numInTriangles * 9 );
 	
-	for( size_t idx = 0; idx < numInIndices; idx += 3 ) {
-		vec3 sumPos = inPositions[inIndices[idx+0]] + inPositions[inIndices[idx+1]] +
-						inPositions[inIndices[idx+2]];
-		outPositions.push_back( sumPos / 3.0f );
-		
-		uint32_t newIdx = (uint32_t)(outPositions.size() + numInVertices - 1);
+	for( size_t tri = 0; tri < numInTriangles; ++tri ) {
+		const uint32_t *in = &inIndices[tri * 3];
+		uint32_t *out = &outIndices[tri * 9];
+		uint32_t newIdx = (uint32_t)(numInVertices + tri);
 		// 0-new-2
-		outIndices.push_back( inIndices[idx+0] ); outIndices.push_back( newIdx ); outIndices.push_back( inIndices[idx+2] );
+		out[0] = in[0]; out[1] = newIdx; out[2] = in[2];
 		// 0-1-new
-		outIndices.push_back( inIndices[idx+0] ); outIndices.push_back( inIndices[idx+1] ); outIndices.push_back( newIdx );
+		out[3] = in[0]; out[4] = in[1]; out[5] = newIdx;
 		// new-1-2
-		outIndices.push_back( newIdx ); outIndices.push_back( inIndices[idx+1] ); outIndices.push_back( inIndices[idx+2] );
+		out[6] = newIdx; out[7] = in[1]; out[8] = in[2];
 	}
 	
-	// iterate the attributes and lerp
-	for( const auto &attr : ctx->getAvailableAttribs() ) {
-		// we processed POSITION in the previous loop
-		if( attr == POSITION )
+	// iterate the attributes (POSITION included) and lerp; each gets a new vertex at the center of every input triangle
+	for( size_t a = 0; a < NUM_ATTRIBS; ++a ) {
+		const Attrib attr = (Attrib)a;
+		const uint8_t dims = ctx->getAttribDims( attr );
+		if( dims == 0 )
 			continue;
 	
-		vector<float> outData;
 		const float *inData = ctx->getAttribData( attr );
-		uint8_t dims = ctx->getAttribDims( attr );
-		outData.reserve( numInIndices / 3 * dims );
-		for( size_t idx = 0; idx < numInIndices; idx += 3 ) {
+		float *outData = ctx->getScratchData( numInTriangles * dims );
+		for( size_t tri = 0; tri < numInTriangles; ++tri ) {
+			const uint32_t *in = &inIndices[tri * 3];
 			for( uint8_t dim = 0; dim < dims; ++dim )
-				outData.push_back( (inData[inIndices[idx+0]*dims + dim] +
-									inData[inIndices[idx+1]*dims + dim] +
-									inData[inIndices[idx+2]*dims + dim]) / 3.0f );
+				outData[tri * dims + dim] = (inData[in[0]*dims + dim] + inData[in[1]*dims + dim] + inData[in[2]*dims + dim]) / 3.0f;
 		}
 		
 		// normalize 3D NORMAL, TANGENT or BITANGENT
 		if( ( (attr == NORMAL) || (attr == TANGENT) || (attr == BITANGENT) ) && ( dims == 3 ) ) {
-			size_t numVerts = outData.size() / 3;
-			for( size_t v = 0; v < numVerts; ++v ) {
+			for( size_t v = 0; v < numInTriangles; ++v ) {
 				vec3 *d = reinterpret_cast<vec3*>( &outData[v * 3] );
 				*d = normalize( *d );
 			}
 		}
 
-		ctx->appendAttrib( attr, dims, outData.data(), outData.size() / dims );
+		ctx->appendAttrib( attr, dims, outData, numInTriangles );
 	}
 	
-	ctx->appendAttrib( POSITION, 3, (const float*)outPositions.data(), outPositions.size() );
-	ctx->copyIndices( ctx->getPrimitive(), outIndices.data(), outIndices.size(), 4 );
+	ctx->copyIndices( ctx->getPrimitive(), outIndices, numInTriangles * 9, 4 );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////
 // SourceMods
+namespace {
+
+// Acquires the SourceModsContext cached by a SourceMods, falling back to a temporary one while the cache is in use
+class ScopedSourceModsContext {
+  public:
+	ScopedSourceModsContext( const SourceMods *sourceMods, SourceModsContext::Cache *cache )
+		: mCache( cache ), mContext( cache->acquire( sourceMods ) )
+	{
+		if( ! mContext ) {
+			mTemporary.reset( new SourceModsContext( sourceMods ) );
+			mContext = mTemporary.get();
+		}
+	}
+
+	~ScopedSourceModsContext()
+	{
+		if( ! mTemporary )
+			mCache->release();
+	}
+
+	SourceModsContext*	operator->() const { return mContext; }
+	SourceModsContext&	operator*() const { return *mContext; }
+
+  private:
+	SourceModsContext::Cache			*mCache;
+	SourceModsContext					*mContext;
+	std::unique_ptr<SourceModsContext>	mTemporary;
+};
+
+} // anonymous namespace
+
 void SourceMods::copyImpl( const SourceMods &rhs )
 {
 	mVariablesCached = false;
@@ -4690,19 +5131,19 @@ void SourceMods::loadInto( Target *target, const AttribSet &requestedAttribs ) c
 			mSourcePtr->loadInto( target, requestedAttribs );
 		}
 		else {
-			SourceModsContext context( this );
-			context.loadInto( target, requestedAttribs );
+			ScopedSourceModsContext context( this, &mContextCache );
+			context->loadInto( target, requestedAttribs );
 		}	
 	}
 	else if( ! mChildren.empty() ) { // children
-		SourceModsContext context( this );
+		ScopedSourceModsContext context( this, &mContextCache );
 		for( auto& child : mChildren ) {
-			SourceModsContext siblingContext( child.get() );
-			siblingContext.preload( requestedAttribs );
-			context.combine( siblingContext );
+			ScopedSourceModsContext siblingContext( child.get(), &child->mContextCache );
+			siblingContext->preload( requestedAttribs );
+			context->combine( *siblingContext );
 		}
 	
-		context.complete( target, requestedAttribs );	
+		context->complete( target, requestedAttribs );	
 	}
 }
 
@@ -4737,21 +5178,78 @@ void SourceMods::append( const SourceMods &sourceMods )
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // SourceModsContext
+namespace {
+
+// number of vertices each Modifier in a run of PointwiseModifiers processes before handing off to the next one; small enough that the block stays in cache
+const size_t kPointwiseBlockSize = 1024;
+
+// Returns whether 'request' is exactly the union of 'requestedAttribs' and 'additionalAttribs'
+bool isAttribUnion( const AttribSet &request, const AttribSet &requestedAttribs, const Attrib *additionalAttribs, size_t numAdditionalAttribs )
+{
+	for( Attrib attr : requestedAttribs )
+		if( request.count( attr ) == 0 )
+			return false;
+	for( size_t a = 0; a < numAdditionalAttribs; ++a )
+		if( request.count( additionalAttribs[a] ) == 0 )
+			return false;
+	for( Attrib attr : request )
+		if( requestedAttribs.count( attr ) == 0 && std::find( additionalAttribs, additionalAttribs + numAdditionalAttribs, attr ) == additionalAttribs + numAdditionalAttribs )
+			return false;
+
+	return true;
+}
+
+} // anonymous namespace
+
 SourceModsContext::SourceModsContext( const SourceMods *sourceMods )
-	: mNumIndices( 0 ), mNumVertices( 0 ), mAttribMask( nullptr ), mPrimitive( NUM_PRIMITIVES )
 {
-	mSource = sourceMods->getSource();
-	
-	if( ! sourceMods->mParamsStack.empty() ) // this allows for a non-indexed Source to have never specified the primitive via copyIndices()
-		mPrimitive = sourceMods->mParamsStack.front().mPrimitive;
-	
-	for( auto &modifier : sourceMods->mModifiers )
-		mModiferStack.push_back( modifier.get() );
+	reset( sourceMods );
 }
 
 SourceModsContext::SourceModsContext()
-	: mNumIndices( 0 ), mNumVertices( 0 ), mSource( nullptr ), mAttribMask( nullptr ), mPrimitive( NUM_PRIMITIVES )
 {
+	reset( nullptr );
+}
+
+void SourceModsContext::reset( const SourceMods *sourceMods )
+{
+	mSource = sourceMods ? sourceMods->getSource() : nullptr;
+	mModiferStack.clear();
+	mAttribMask = nullptr;
+	mNumVertices = 0;
+	mNumIndices = 0;
+	mIndicesRequiredBytes = 0;
+	mPrimitive = NUM_PRIMITIVES;
+	mNumRequests = 0;
+	mPointwiseRun.clear();
+	mPointwiseAttribs.clear();
+
+	// keep the storage of the attributes around for the next load
+	for( auto &attrib : mAttribs ) {
+		attrib.mDims = 0;
+		attrib.mCount = 0;
+	}
+
+	if( sourceMods ) {
+		if( ! sourceMods->mParamsStack.empty() ) // this allows for a non-indexed Source to have never specified the primitive via copyIndices()
+			mPrimitive = sourceMods->mParamsStack.front().mPrimitive;
+	
+		for( auto &modifier : sourceMods->mModifiers )
+			mModiferStack.push_back( modifier.get() );
+	}
+}
+
+SourceModsContext* SourceModsContext::Cache::acquire( const SourceMods *sourceMods )
+{
+	if( mInUse.exchange( true ) )
+		return nullptr;
+
+	if( mContext )
+		mContext->reset( sourceMods );
+	else
+		mContext.reset( new SourceModsContext( sourceMods ) );
+
+	return mContext.get();
 }
 
 void SourceModsContext::preload( const AttribSet &requestedAttribs )
@@ -4767,7 +5265,7 @@ void SourceModsContext::preload( const AttribSet &requestedAttribs )
 	if( ! mModiferStack.empty() ) {
 		auto modifier = mModiferStack.back();
 		mModiferStack.pop_back();
-		modifier->process( this, requestedAttribs );
+		processModifier( modifier, requestedAttribs );
 	}
 	else { // no modifiers; just loadInto on the soucre directly
 		mSource->loadInto( this, requestedAttribs );
@@ -4781,10 +5279,10 @@ void SourceModsContext::combine( const SourceModsContext &rhs )
 	if( mPrimitive == NUM_PRIMITIVES ) {
 		mPrimitive = rhs.getPrimitive();
 		this->copyIndices( rhs.getPrimitive(), rhs.getIndicesData(), rhs.getNumIndices(), 4 );
-		for( auto &attribInfo : rhs.mAttribInfo ) {
-			const auto &data = rhs.mAttribData.find( attribInfo.first )->second;
-			const auto &count = rhs.mAttribCount.find( attribInfo.first )->second;
-			this->copyAttrib( attribInfo.first, attribInfo.second.getDims(), attribInfo.second.getStride(), data.get(), count );
+		for( size_t a = 0; a < NUM_ATTRIBS; ++a ) {
+			const AttribBuffer &attrib = rhs.mAttribs[a];
+			if( attrib.mDims )
+				this->copyAttrib( (Attrib)a, attrib.mDims, 0, attrib.mData.data(), attrib.mCount );
 		}
 			
 		return;
@@ -4808,46 +5306,44 @@ void SourceModsContext::combine( const SourceModsContext &rhs )
 	size_t rhsNumOutIndices = determineRequiredIndices( rhsPrimitive, combinedPrimitive, rhsNumIndices ? rhsNumIndices : rhsNumVertices );
 	size_t totalOutIndices = numOutIndices + rhsNumOutIndices;
 	
-	std::vector<uint32_t> outIndices;
-	outIndices.resize( totalOutIndices );
+	uint32_t *outIndices = getScratchIndices( totalOutIndices );
 	
 	if( combinedPrimitive == Primitive::TRIANGLES ) {
 		if( getNumIndices() ) // 'this is indexed
-			Target::copyIndexDataForceTriangles( getPrimitive(), getIndicesData(), numIndices, 0, outIndices.data() );
+			Target::copyIndexDataForceTriangles( getPrimitive(), getIndicesData(), numIndices, 0, outIndices );
 		else // 'this' wasn't previously indexed but needs to be
-			Target::generateIndicesForceTriangles( getPrimitive(), numVertices, 0, outIndices.data() );
+			Target::generateIndicesForceTriangles( getPrimitive(), numVertices, 0, outIndices );
 
 		// rhs
 		if( rhs.getNumIndices() ) // 'rhs' is indexed
 			Target::copyIndexDataForceTriangles( rhsPrimitive, rhs.getIndicesData(),
-				rhsNumIndices, (uint32_t)numVertices, outIndices.data() + numOutIndices );
+				rhsNumIndices, (uint32_t)numVertices, outIndices + numOutIndices );
 		else // 'rhs' wasn't previously indexed but needs to be
-			Target::generateIndicesForceTriangles( rhsPrimitive, rhsNumVertices, (uint32_t)numVertices, outIndices.data() + numOutIndices );
+			Target::generateIndicesForceTriangles( rhsPrimitive, rhsNumVertices, (uint32_t)numVertices, outIndices + numOutIndices );
 	}
 	else if( combinedPrimitive == Primitive::LINES ) {
 		if( getNumIndices() ) // 'this' is indexed
-			Target::copyIndexDataForceLines( getPrimitive(), getIndicesData(), numIndices, 0, outIndices.data() );
+			Target::copyIndexDataForceLines( getPrimitive(), getIndicesData(), numIndices, 0, outIndices );
 		else // 'this' wasn't previously indexed but needs to be
-			Target::generateIndicesForceLines( getPrimitive(), numVertices, 0, outIndices.data() );
+			Target::generateIndicesForceLines( getPrimitive(), numVertices, 0, outIndices );
 
 		// rhs
 		if( rhs.getNumIndices() ) // 'rhs' is indexed
 			Target::copyIndexDataForceLines( rhsPrimitive, rhs.getIndicesData(),
-				rhsNumIndices, (uint32_t)numVertices, outIndices.data() + numOutIndices );
+				rhsNumIndices, (uint32_t)numVertices, outIndices + numOutIndices );
 		else // 'rhs' wasn't previously indexed but needs to be
-			Target::generateIndicesForceLines( rhsPrimitive, rhsNumVertices, (uint32_t)numVertices, outIndices.data() + numOutIndices );
+			Target::generateIndicesForceLines( rhsPrimitive, rhsNumVertices, (uint32_t)numVertices, outIndices + numOutIndices );
 	}
 
-	this->copyIndices( combinedPrimitive, outIndices.data(), outIndices.size(), 4 );
+	this->copyIndices( combinedPrimitive, outIndices, totalOutIndices, 4 );
 	
 	// Handle Attributes
-	for( const auto &attribInfo : mAttribInfo ) {
-		uint8_t dims = getAttribDims( attribInfo.first );
-		if( dims > 0 ) {
-			uint8_t rhsDims = rhs.getAttribDims( attribInfo.first );
+	for( size_t a = 0; a < NUM_ATTRIBS; ++a ) {
+		if( mAttribs[a].mDims > 0 ) {
+			uint8_t rhsDims = rhs.getAttribDims( (Attrib)a );
 			// if 'rhs' has data for the attribute, copy that
-			const float *rhsAttribData = rhs.getAttribData( attribInfo.first );
-			this->appendAttrib( attribInfo.first, rhsDims, rhsAttribData, rhsNumVertices );
+			const float *rhsAttribData = rhs.getAttribData( (Attrib)a );
+			this->appendAttrib( (Attrib)a, rhsDims, rhsAttribData, rhsNumVertices );
 		}
 	}
 }
@@ -4861,21 +5357,21 @@ void SourceModsContext::complete( Target *target, const AttribSet &requestedAttr
 		// are no remaining modifiers. Finally processUpstream() will call loadInto() on the Source
 		auto modifier = mModiferStack.back();
 		mModiferStack.pop_back();
-		modifier->process( this, requestedAttribs );
+		processModifier( modifier, requestedAttribs );
 	}
 
 	// first let's verify that all counts on our requested attributes are the same. If not, we'll continue to process but with an error
-	for( const auto &attribCount : mAttribCount )
-		if( attribCount.second != mNumVertices && ( requestedAttribs.count( attribCount.first ) > 0 ) )
-			CI_LOG_E( "Attribute " << attribToString( attribCount.first ) << " count is " << attribCount.first << " instead of " << mNumVertices );
+	for( size_t a = 0; a < NUM_ATTRIBS; ++a )
+		if( mAttribs[a].mDims && mAttribs[a].mCount != mNumVertices && ( requestedAttribs.count( (Attrib)a ) > 0 ) )
+			CI_LOG_E( "Attribute " << attribToString( (Attrib)a ) << " count is " << mAttribs[a].mCount << " instead of " << mNumVertices );
 	
-	for( const auto &attribInfoPair : mAttribInfo ) {
-		Attrib attrib = attribInfoPair.first;
-		const AttribInfo &attribInfo = attribInfoPair.second;
-		target->copyAttrib( attrib, attribInfo.getDims(), attribInfo.getStride(), mAttribData[attrib].get(), mAttribCount[attrib] );
+	for( size_t a = 0; a < NUM_ATTRIBS; ++a ) {
+		const AttribBuffer &attrib = mAttribs[a];
+		if( attrib.mDims )
+			target->copyAttrib( (Attrib)a, attrib.mDims, 0, attrib.mData.data(), attrib.mCount );
 	}
 
-	target->copyIndices( mPrimitive, mIndices.get(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );	
+	target->copyIndices( mPrimitive, getIndicesData(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );	
 }
 
 void SourceModsContext::loadInto( Target *target, const AttribSet &requestedAttribs )
@@ -4891,23 +5387,23 @@ void SourceModsContext::loadInto( Target *target, const AttribSet &requestedAttr
 	if( ! mModiferStack.empty() ) {
 		auto modifier = mModiferStack.back();
 		mModiferStack.pop_back();
-		modifier->process( this, requestedAttribs );
+		processModifier( modifier, requestedAttribs );
 
 		// We've finished processing all Modifiers and the Source. Now iterate all the attribute data and the indices
 		// and copy them to the target.
 		
 		// first let's verify that all counts on our requested attributes are the same. If not, we'll continue to process but with an error
-		for( const auto &attribCount : mAttribCount )
-			if( attribCount.second != mNumVertices && ( requestedAttribs.count( attribCount.first ) > 0 ) )
-				CI_LOG_E( "Attribute " << attribToString( attribCount.first ) << " count is " << attribCount.first << " instead of " << mNumVertices );
+		for( size_t a = 0; a < NUM_ATTRIBS; ++a )
+			if( mAttribs[a].mDims && mAttribs[a].mCount != mNumVertices && ( requestedAttribs.count( (Attrib)a ) > 0 ) )
+				CI_LOG_E( "Attribute " << attribToString( (Attrib)a ) << " count is " << mAttribs[a].mCount << " instead of " << mNumVertices );
 		
-		for( const auto &attribInfoPair : mAttribInfo ) {
-			Attrib attrib = attribInfoPair.first;
-			const AttribInfo &attribInfo = attribInfoPair.second;
-			target->copyAttrib( attrib, attribInfo.getDims(), attribInfo.getStride(), mAttribData[attrib].get(), mAttribCount[attrib] );
+		for( size_t a = 0; a < NUM_ATTRIBS; ++a ) {
+			const AttribBuffer &attrib = mAttribs[a];
+			if( attrib.mDims )
+				target->copyAttrib( (Attrib)a, attrib.mDims, 0, attrib.mData.data(), attrib.mCount );
 		}
 
-		target->copyIndices( mPrimitive, mIndices.get(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );
+		target->copyIndices( mPrimitive, getIndicesData(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );
 	}
 	else {
 		// no modifiers; in this case just call loadInto()
@@ -4928,15 +5424,103 @@ void SourceModsContext::processUpstream( const AttribSet &requestedAttribs )
 		// we want the Params to reflect upstream from the current Modifier
 		auto modifier = mModiferStack.back();
 		mModiferStack.pop_back();
+		processModifier( modifier, requestedAttribs );
+	}
+}
+
+void SourceModsContext::processUpstream( const AttribSet &requestedAttribs, std::initializer_list<Attrib> additionalAttribs )
+{
+	processUpstream( requestedAttribs, additionalAttribs.begin(), additionalAttribs.size() );
+}
+
+void SourceModsContext::processUpstream( const AttribSet &requestedAttribs, const Attrib *additionalAttribs, size_t numAdditionalAttribs )
+{
+	bool alreadyRequested = true;
+	for( size_t a = 0; a < numAdditionalAttribs; ++a )
+		alreadyRequested = alreadyRequested && requestedAttribs.count( additionalAttribs[a] ) > 0;
+	if( alreadyRequested ) {
+		processUpstream( requestedAttribs );
+		return;
+	}
+
+	// Building an AttribSet allocates, so keep one per nesting level and only rebuild it when the request changes
+	if( mNumRequests == mRequests.size() )
+		mRequests.emplace_back( new AttribSet );
+	AttribSet &request = *mRequests[mNumRequests];
+	if( ! isAttribUnion( request, requestedAttribs, additionalAttribs, numAdditionalAttribs ) ) {
+		request = requestedAttribs;
+		request.insert( additionalAttribs, additionalAttribs + numAdditionalAttribs );
+	}
+
+	++mNumRequests;
+	processUpstream( request );
+	--mNumRequests;
+}
+
+void SourceModsContext::processModifier( const Modifier *modifier, const AttribSet &requestedAttribs )
+{
+	auto pointwise = dynamic_cast<const PointwiseModifier*>( modifier );
+	if( ! pointwise ) {
 		modifier->process( this, requestedAttribs );
+		return;
+	}
+
+	// Gather the run of PointwiseModifiers directly upstream of 'modifier' so the whole run can be applied in a single pass.
+	// These vectors are used as stacks, as a Modifier further upstream can start a run of its own.
+	const size_t runBegin = mPointwiseRun.size();
+	const size_t attribsBegin = mPointwiseAttribs.size();
+	mPointwiseRun.push_back( pointwise );
+	while( ! mModiferStack.empty() ) {
+		auto upstream = dynamic_cast<const PointwiseModifier*>( mModiferStack.back() );
+		if( ! upstream )
+			break;
+		mPointwiseRun.push_back( upstream );
+		mModiferStack.pop_back();
+	}
+	std::reverse( mPointwiseRun.begin() + runBegin, mPointwiseRun.end() );
+
+	for( size_t m = runBegin; m < mPointwiseRun.size(); ++m ) {
+		Attrib upstreamAttrib = mPointwiseRun[m]->getUpstreamAttrib();
+		if( upstreamAttrib != NUM_ATTRIBS )
+			mPointwiseAttribs.push_back( upstreamAttrib );
+	}
+	processUpstream( requestedAttribs, mPointwiseAttribs.data() + attribsBegin, mPointwiseAttribs.size() - attribsBegin );
+	mPointwiseAttribs.resize( attribsBegin );
+
+	// Prepare the Modifiers in order, deferring their processVertices() as long as they keep the layout of the attributes.
+	// The deferred Modifiers are compacted to the front of the run.
+	size_t pendingEnd = runBegin;
+	for( size_t m = runBegin; m < mPointwiseRun.size(); ++m ) {
+		const PointwiseModifier *current = mPointwiseRun[m];
+		if( pendingEnd > runBegin && ! current->isInPlace( *this ) ) {
+			processPointwiseRun( runBegin, pendingEnd );
+			pendingEnd = runBegin;
+		}
+		if( current->prepare( this ) )
+			mPointwiseRun[pendingEnd++] = current;
+	}
+	processPointwiseRun( runBegin, pendingEnd );
+
+	mPointwiseRun.resize( runBegin );
+}
+
+void SourceModsContext::processPointwiseRun( size_t begin, size_t end )
+{
+	if( begin == end )
+		return;
+
+	// Modifiers are free to call user functions which aren't thread-safe, so this is done serially
+	for( size_t v = 0; v < mNumVertices; v += kPointwiseBlockSize ) {
+		const size_t blockEnd = std::min( v + kPointwiseBlockSize, mNumVertices );
+		for( size_t m = begin; m < end; ++m )
+			mPointwiseRun[m]->processVertices( this, v, blockEnd );
 	}
 }
 	
 uint8_t	SourceModsContext::getAttribDims( Attrib attr ) const
 {
-	auto attrInfoIt = mAttribInfo.find( attr );
-	if( attrInfoIt != mAttribInfo.end() )
-		return attrInfoIt->second.getDims();
+	if( attr < NUM_ATTRIBS )
+		return mAttribs[attr].mDims;
 	else
 		return 0;
 }
@@ -4958,10 +5542,8 @@ Primitive SourceModsContext::getPrimitive() const
 
 float* SourceModsContext::getAttribData( Attrib attr )
 {
-	auto attrDataIt = mAttribData.find( attr );
-	if( attrDataIt != mAttribData.end() ) {
-		return attrDataIt->second.get();
-	}
+	if( attr < NUM_ATTRIBS && mAttribs[attr].mDims )
+		return mAttribs[attr].mData.data();
 	else
 		return nullptr;
 }
@@ -4969,68 +5551,113 @@ float* SourceModsContext::getAttribData( Attrib attr )
 AttribSet SourceModsContext::getAvailableAttribs() const
 {
 	AttribSet result;
-	for( const auto &attribInfo : mAttribInfo )
-		result.insert( attribInfo.first );
+	for( size_t a = 0; a < NUM_ATTRIBS; ++a )
+		if( mAttribs[a].mDims )
+			result.insert( (Attrib)a );
 	return result;
 }
 
 uint32_t* SourceModsContext::getIndicesData()
 {
-	return mIndices.get();
+	return mNumIndices ? mIndices.data() : nullptr;
+}
+
+void SourceModsContext::convertAttribDims( Attrib attr, uint8_t dims )
+{
+	if( attr >= NUM_ATTRIBS || mAttribs[attr].mDims == 0 || mAttribs[attr].mDims == dims )
+		return;
+
+	AttribBuffer &attrib = mAttribs[attr];
+	const uint8_t srcDims = attrib.mDims;
+	if( attrib.mData.size() < dims * attrib.mCount )
+		attrib.mData.resize( dims * attrib.mCount );
+
+	// growing has to work back to front, shrinking front to back, for the conversion to happen in place
+	float *data = attrib.mData.data();
+	if( dims > srcDims ) {
+		for( size_t v = attrib.mCount; v-- > 0; ) {
+			float element[4];
+			std::copy( data + v * srcDims, data + ( v + 1 ) * srcDims, element );
+			copyData( srcDims, element, 1, dims, 0, data + v * dims );
+		}
+	}
+	else {
+		for( size_t v = 0; v < attrib.mCount; ++v ) {
+			float element[4];
+			std::copy( data + v * srcDims, data + ( v + 1 ) * srcDims, element );
+			copyData( srcDims, element, 1, dims, 0, data + v * dims );
+		}
+	}
+
+	attrib.mDims = dims;
+}
+
+float* SourceModsContext::getScratchData( size_t count )
+{
+	if( mScratchData.size() < count )
+		mScratchData.resize( count );
+	return mScratchData.data();
+}
+
+uint32_t* SourceModsContext::getScratchIndices( size_t count )
+{
+	if( mScratchIndices.size() < count )
+		mScratchIndices.resize( count );
+	return mScratchIndices.data();
 }
 
 void SourceModsContext::copyAttrib( Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count )
+{
+	size_t resultStrideBytes;
+	float *dest = getAttribStorage( attr, dims, count, &resultStrideBytes );
+	if( dest )
+		copyData( dims, strideBytes, srcData, count, dims, 0, dest );
+}
+
+float* SourceModsContext::getAttribStorage( Attrib attr, uint8_t dims, size_t count, size_t *resultStrideBytes )
 {
 	// The attribMask is used to ignore attributes coming from the source which were not directly requested
 	// A Source is allowed to supply attributes that weren't requested; this allows us to ignore them; without it,
 	// a chain like: sphere1 >> geom::Combine( &sphere2 ) >> geom::Combine( &sphere3 ) >> geom::Translate( ... )
 	// can crash, because geom::Translate could be processing residual attributes from further up the chain
 	if( mAttribMask && mAttribMask->count( attr ) == 0 )
-		return;
+		return nullptr;
+	// user-defined attributes have no storage in the context
+	if( attr >= NUM_ATTRIBS )
+		return nullptr;
 
 	// theoretically this should be the same for all calls to copyAttrib from a given modifier. If it's not at loadInto(), we'll log an error
 	mNumVertices = count;
 
-	// we definitely need allocation if we haven't encountered this attrib before
-	bool needsAllocation = ( mAttribCount.count( attr ) == 0 ) || ( mAttribData.count( attr ) == 0 ) || ( mAttribInfo.count( attr ) == 0 );
-	// we need allocation if we have this attrib but with different parameters
-	if( ! needsAllocation ) {
-		const AttribInfo &attribInfo = mAttribInfo.at( attr );
-		needsAllocation = ( attribInfo.getStride() != strideBytes ) || ( attribInfo.getDims() != dims ) || ( count != mAttribCount[attr] );
-	}
-	
-	if( needsAllocation ) {
-		mAttribData[attr] = unique_ptr<float[]>( new float[dims * count] );
-		mAttribCount[attr] = count;
-		// oddly elaborate logic necessary to replace set contents w/o a default-constructible type
-		// equivalent to mAttribInfo[attr] = AttribInfo( ... )
-		auto it = mAttribInfo.insert( make_pair( attr, AttribInfo( attr, dims, dims * sizeof(float), (size_t)0 ) ) ).first;
-		it->second = AttribInfo( attr, dims, dims * sizeof(float), (size_t)0 ); // only necessary if the key already exists
-	}
-	
-	copyData( dims, strideBytes, srcData, count, dims, 0, mAttribData.at( attr ).get() );
+	// the buffer only ever grows, so reloading geometry of the same size doesn't allocate
+	AttribBuffer &attrib = mAttribs[attr];
+	if( attrib.mData.size() < dims * count )
+		attrib.mData.resize( dims * count );
+	attrib.mDims = dims;
+	attrib.mCount = count;
+
+	*resultStrideBytes = 0;
+	return attrib.mData.data();
 }
 
 void SourceModsContext::appendAttrib( Attrib attr, uint8_t dims, const float *srcData, size_t count )
 {
+	if( attr >= NUM_ATTRIBS )
+		return;
+
 	// if we don't have any data for this attribute, just call copyAttrib
-	if( mAttribInfo.count( attr ) == 0 ) {
+	AttribBuffer &attrib = mAttribs[attr];
+	if( attrib.mDims == 0 ) {
 		copyAttrib( attr, dims, 0, srcData, count );
 		return;
 	}
-	auto attribInfoIt = mAttribInfo.at( attr );
-	uint8_t existingDims = attribInfoIt.getDims();
-	size_t existingCount = mAttribCount[attr];
-	const float *existingData = mAttribData[attr].get();
 
-	auto newData = unique_ptr<float[]>( new float[(existingCount + count) * existingDims] );
-	// copy old data
-	memcpy( newData.get(), existingData, sizeof(float) * existingCount * existingDims );
+	const size_t existingCount = attrib.mCount;
+	if( attrib.mData.size() < ( existingCount + count ) * attrib.mDims )
+		attrib.mData.resize( ( existingCount + count ) * attrib.mDims );
 	// append new data
-	copyData( dims, 0, srcData, count, existingDims, 0, newData.get() + existingCount * existingDims );
-	// reassign data
-	mAttribData[attr] = std::move( newData );
-	mAttribCount[attr] = existingCount + count;
+	copyData( dims, 0, srcData, count, attrib.mDims, 0, attrib.mData.data() + existingCount * attrib.mDims );
+	attrib.mCount = existingCount + count;
 
 	mNumVertices = existingCount + count;
 }
@@ -5039,12 +5666,14 @@ void SourceModsContext::copyIndices( Primitive primitive, const uint32_t *source
 {
 	mPrimitive = primitive;
 	mIndicesRequiredBytes = requiredBytes;
-	// need to reallocate storage only if this is a different number of indices
-	if( mNumIndices != numIndices ) {
-		mNumIndices = numIndices;
-		mIndices = unique_ptr<uint32_t[]>( new uint32_t[numIndices] );
-	}
-	memcpy( mIndices.get(), source, sizeof(uint32_t) * numIndices );
+	mNumIndices = numIndices;
+	// copying our own indices onto themselves is a no-op
+	if( numIndices == 0 || source == mIndices.data() )
+		return;
+
+	if( mIndices.size() < numIndices )
+		mIndices.resize( numIndices );
+	memcpy( mIndices.data(), source, sizeof(uint32_t) * numIndices );
 }
 
 void SourceModsContext::appendIndices( Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytes )
@@ -5052,31 +5681,28 @@ void SourceModsContext::appendIndices( Primitive primitive, const uint32_t *sour
 	if( mPrimitive != primitive )
 		CI_LOG_E( "Primitive types don't match" );
 	
-	auto newIndices = unique_ptr<uint32_t[]>( new uint32_t[numIndices + mNumIndices] );
 	mIndicesRequiredBytes = std::max( mIndicesRequiredBytes, requiredBytes );
 
-	// copy old index data
-	if( mNumIndices && mIndices.get() )
-		memcpy( newIndices.get(), mIndices.get(), sizeof(uint32_t) * mNumIndices );
-	// and append new index data
-	memcpy( newIndices.get() + mNumIndices, source, sizeof(uint32_t) * numIndices );
+	if( mIndices.size() < mNumIndices + numIndices )
+		mIndices.resize( mNumIndices + numIndices );
+	// append new index data
+	if( numIndices )
+		memcpy( mIndices.data() + mNumIndices, source, sizeof(uint32_t) * numIndices );
 	// total indices += new number of indices
 	mNumIndices = mNumIndices + numIndices;
-	
-	mIndices = std::move( newIndices );
 }
 
 void SourceModsContext::clearAttrib( Attrib attr )
 {
-	mAttribInfo.erase( attr );
-	mAttribData.erase( attr );
-	mAttribCount.erase( attr );
+	if( attr < NUM_ATTRIBS ) {
+		mAttribs[attr].mDims = 0;
+		mAttribs[attr].mCount = 0;
+	}
 }
 
 void SourceModsContext::clearIndices()
 {
 	mNumIndices = 0;
-	mIndices.reset();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,131 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/MappedFile.h"
+
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace cinder {
+
+MappedFile::MappedFile( const fs::path &path )
+	: mFilePath( path ), mData( nullptr ), mSize( 0 )
+{
+#if defined( CINDER_MSW )
+  #if defined( CINDER_UWP )
+	HANDLE file = ::CreateFile2( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, OPEN_EXISTING, nullptr );
+  #else
+	HANDLE file = ::CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+  #endif
+	if( file == INVALID_HANDLE_VALUE )
+		throw MappedFileExc( "failed to open file: " + path.string() );
+
+	LARGE_INTEGER fileSize;
+	if( ! ::GetFileSizeEx( file, &fileSize ) ) {
+		::CloseHandle( file );
+		throw MappedFileExc( "failed to get size of file: " + path.string() );
+	}
+
+	mSize = (size_t)fileSize.QuadPart;
+
+	// empty files can't be mapped, and don't need to be
+	if( mSize ) {
+		// the view keeps the file mapped after the handles are closed
+  #if defined( CINDER_UWP )
+		HANDLE mapping = ::CreateFileMappingFromApp( file, nullptr, PAGE_READONLY, 0, nullptr );
+		if( mapping ) {
+			mData = ::MapViewOfFileFromApp( mapping, FILE_MAP_READ, 0, 0 );
+			::CloseHandle( mapping );
+		}
+  #else
+		HANDLE mapping = ::CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+		if( mapping ) {
+			mData = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+			::CloseHandle( mapping );
+		}
+  #endif
+	}
+	::CloseHandle( file );
+#else
+	int fd = ::open( path.string().c_str(), O_RDONLY );
+	if( fd < 0 )
+		throw MappedFileExc( "failed to open file: " + path.string() );
+
+	struct stat fileStat;
+	if( ::fstat( fd, &fileStat ) != 0 ) {
+		::close( fd );
+		throw MappedFileExc( "failed to get size of file: " + path.string() );
+	}
+
+	mSize = (size_t)fileStat.st_size;
+
+	// empty files can't be mapped, and don't need to be. The mapping stays valid after the descriptor is closed.
+	if( mSize ) {
+		void *address = ::mmap( nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0 );
+		if( address != MAP_FAILED )
+			mData = address;
+	}
+	::close( fd );
+#endif
+
+	if( mSize && ! mData )
+		throw MappedFileExc( "failed to map file: " + path.string() );
+}
+
+void MappedFile::prefault()
+{
+	if( ! mData )
+		return;
+
+#if ! defined( CINDER_MSW )
+	// starts reading ahead asynchronously, which is faster than faulting the pages in one by one below
+	::madvise( mData, mSize, MADV_WILLNEED );
+#endif
+
+	// reading one byte of each page is what actually makes it resident. The mapping starts on a page boundary, and 4096 is the smallest
+	// page size of the supported platforms, so this reaches every page.
+	const size_t pageSize = 4096;
+	const volatile uint8_t *bytes = static_cast<const volatile uint8_t *>( mData );
+	for( size_t i = 0; i < mSize; i += pageSize )
+		(void)bytes[i];
+}
+
+MappedFile::~MappedFile()
+{
+	if( ! mData )
+		return;
+
+#if defined( CINDER_MSW )
+	::UnmapViewOfFile( mData );
+#else
+	::munmap( mData, mSize );
+#endif
+}
+
+} // namespace cinder
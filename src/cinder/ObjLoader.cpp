@@ -24,10 +24,22 @@
 */
 
 #include "cinder/ObjLoader.h"
+#include "cinder/Log.h"
+#include "cinder/MappedFile.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Utilities.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
 using namespace std;
 
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#else
+	#include <sys/stat.h>
+#endif
+
 // For stoi
 #if defined( CINDER_ANDROID )
 	#include "cinder/android/CinderAndroid.h"
@@ -40,29 +52,846 @@ geom::SourceRef	loadGeom( const fs::path &path )
 	return geom::SourceRef();
 }
 
+namespace {
+
+// Files are split into chunks of roughly this size, which are parsed in parallel.
+const size_t kChunkBytes = 1 << 22;
+
+bool isSpace( char c )
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+bool isDigit( char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+const char* skipSpace( const char *p, const char *end )
+{
+	while( p < end && isSpace( *p ) )
+		++p;
+	return p;
+}
+
+// Returns the end of the line starting at p, and sets next to the start of the following one. Lines end at "\n", "\r\n" or "\r", same as IStreamCinder::readLine().
+const char* findLineEnd( const char *p, const char *end, const char **next )
+{
+	while( p < end && *p != '\n' && *p != '\r' )
+		++p;
+
+	*next = p;
+	if( p < end ) {
+		++*next;
+		if( *p == '\r' && *next < end && **next == '\n' )
+			++*next;
+	}
+
+	return p;
+}
+
+// Returns the start of the first line at or after offset that doesn't continue the previous one (through a trailing backslash).
+size_t findChunkStart( const char *data, size_t size, size_t offset )
+{
+	const char *end = data + size;
+	const char *p = data + offset - 1; // in case offset is already the start of a line
+	while( p < end ) {
+		const char *next;
+		const char *lineEnd = findLineEnd( p, end, &next );
+		if( lineEnd == end )
+			break;
+		if( lineEnd == data || lineEnd[-1] != '\\' )
+			return next - data;
+
+		p = next;
+	}
+
+	return size;
+}
+
+// every power of ten that a double represents exactly
+const double kPowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// Parses the number at p, returning the position after it. Handles plain decimal notation, which is all OBJ files contain in practice, and
+// leaves anything unusual (very long mantissas, large exponents, inf or nan) to strtod().
+const char* parseFloat( const char *p, const char *end, float *result )
+{
+	const char *start = p;
+	bool negative = false;
+	if( p < end && ( *p == '-' || *p == '+' ) )
+		negative = *p++ == '-';
+
+	uint64_t mantissa = 0;
+	int numDigits = 0, exponent = 0;
+	bool valid = false;
+	for( ; p < end && isDigit( *p ); ++p ) {
+		valid = true;
+		if( numDigits < 19 ) {
+			mantissa = mantissa * 10 + ( *p - '0' );
+			numDigits += mantissa ? 1 : 0;
+		}
+		else
+			exponent++;
+	}
+
+	if( p < end && *p == '.' ) {
+		for( ++p; p < end && isDigit( *p ); ++p ) {
+			valid = true;
+			if( numDigits < 19 ) {
+				mantissa = mantissa * 10 + ( *p - '0' );
+				numDigits += mantissa ? 1 : 0;
+				exponent--;
+			}
+		}
+	}
+
+	if( valid && p < end && ( *p == 'e' || *p == 'E' ) ) {
+		const char *e = p + 1;
+		bool negativeExponent = false;
+		if( e < end && ( *e == '-' || *e == '+' ) )
+			negativeExponent = *e++ == '-';
+
+		if( e < end && isDigit( *e ) ) {
+			int value = 0;
+			for( ; e < end && isDigit( *e ); ++e )
+				value = std::min( value * 10 + ( *e - '0' ), 10000 );
+
+			exponent += negativeExponent ? -value : value;
+			p = e;
+		}
+	}
+
+	if( valid && ( mantissa == 0 || ( exponent >= -22 && exponent <= 22 ) ) ) {
+		double value = (double)mantissa;
+		if( exponent < 0 )
+			value /= kPowersOfTen[-exponent];
+		else if( mantissa )
+			value *= kPowersOfTen[exponent];
+
+		*result = float( negative ? -value : value );
+		return p;
+	}
+
+	// strtod() needs a null terminated copy of the token
+	char buffer[128];
+	size_t length = 0;
+	for( p = start; p < end && ! isSpace( *p ) && *p != '/' && length < sizeof( buffer ) - 1; ++p )
+		buffer[length++] = *p;
+	buffer[length] = 0;
+
+	char *parsedEnd;
+	*result = (float)strtod( buffer, &parsedEnd );
+	return start + ( parsedEnd - buffer );
+}
+
+const char* parseInt( const char *p, const char *end, int64_t *result, bool *valid )
+{
+	bool negative = false;
+	if( p < end && ( *p == '-' || *p == '+' ) )
+		negative = *p++ == '-';
+
+	int64_t value = 0;
+	*valid = p < end && isDigit( *p );
+	for( ; p < end && isDigit( *p ); ++p )
+		value = std::min<int64_t>( value * 10 + ( *p - '0' ), numeric_limits<int32_t>::max() );
+
+	*result = negative ? -value : value;
+	return p;
+}
+
+// The part of a file parsed by one task. Relative (negative) indices can't be resolved until the number of elements in all
+// preceding chunks is known, so they are stored relative to the chunk's first element and the corners that hold them are recorded.
+struct ObjChunk {
+	struct Event {
+		enum Type { GROUP, MATERIAL }	mType;
+		size_t			mFace, mNumVertices, mNumTexCoords, mNumNormals;
+		std::string		mName;
+	};
+
+	std::vector<vec3>		mVertices, mNormals;
+	std::vector<vec2>		mTexCoords;
+	std::vector<uint32_t>	mFaceSizes;
+	std::vector<int32_t>	mCornerVertices, mCornerTexCoords, mCornerNormals;
+	std::vector<size_t>		mRelativeVertices, mRelativeTexCoords, mRelativeNormals;
+	std::vector<Event>		mEvents;
+};
+
+// Marks an index that can't be valid (0, or out of the int32_t range), so that its face is skipped when loading.
+const int32_t kInvalidIndex = numeric_limits<int32_t>::max();
+
+int32_t resolveIndex( int64_t index, bool valid, size_t numElements, size_t corner, std::vector<size_t> *relativeCorners )
+{
+	if( ! valid || index == 0 )
+		return kInvalidIndex;
+	if( index > 0 )
+		return int32_t( index - 1 );
+
+	relativeCorners->push_back( corner );
+	return int32_t( std::max<int64_t>( int64_t( numElements ) + index, numeric_limits<int32_t>::min() + 1 ) );
+}
+
+void parseFace( const char *p, const char *end, bool includeNormals, bool includeTexCoords, ObjChunk *chunk )
+{
+	uint32_t numCorners = 0;
+	for( p = skipSpace( p, end ); p < end && *p != '#'; p = skipSpace( p, end ) ) {
+		const size_t corner = chunk->mCornerVertices.size();
+		int64_t index;
+		bool valid;
+
+		p = parseInt( p, end, &index, &valid );
+		chunk->mCornerVertices.push_back( resolveIndex( index, valid, chunk->mVertices.size(), corner, &chunk->mRelativeVertices ) );
+
+		int32_t texCoord = -1, normal = -1;
+		if( p < end && *p == '/' ) {
+			++p;
+			if( p < end && *p != '/' && ! isSpace( *p ) ) {
+				p = parseInt( p, end, &index, &valid );
+				if( includeTexCoords )
+					texCoord = resolveIndex( index, valid, chunk->mTexCoords.size(), corner, &chunk->mRelativeTexCoords );
+			}
+			if( p < end && *p == '/' ) {
+				p = parseInt( p + 1, end, &index, &valid );
+				if( includeNormals )
+					normal = resolveIndex( index, valid, chunk->mNormals.size(), corner, &chunk->mRelativeNormals );
+			}
+		}
+
+		chunk->mCornerTexCoords.push_back( texCoord );
+		chunk->mCornerNormals.push_back( normal );
+		numCorners++;
+
+		// skip anything unexpected up to the next corner
+		while( p < end && ! isSpace( *p ) )
+			++p;
+	}
+
+	chunk->mFaceSizes.push_back( numCorners );
+}
+
+void parseLine( const char *p, const char *end, bool includeNormals, bool includeTexCoords, ObjChunk *chunk )
+{
+	p = skipSpace( p, end );
+	if( p == end || *p == '#' )
+		return;
+
+	const char *tag = p;
+	while( p < end && ! isSpace( *p ) )
+		++p;
+
+	const size_t tagLength = p - tag;
+	if( tagLength == 1 && tag[0] == 'v' ) { // vertex
+		vec3 v;
+		for( int i = 0; i < 3; ++i )
+			p = parseFloat( skipSpace( p, end ), end, &v[i] );
+		chunk->mVertices.push_back( v );
+	}
+	else if( tagLength == 2 && tag[0] == 'v' && tag[1] == 't' ) { // vertex texture coordinates
+		if( includeTexCoords ) {
+			vec2 tex;
+			for( int i = 0; i < 2; ++i )
+				p = parseFloat( skipSpace( p, end ), end, &tex[i] );
+			chunk->mTexCoords.push_back( tex );
+		}
+	}
+	else if( tagLength == 2 && tag[0] == 'v' && tag[1] == 'n' ) { // vertex normals
+		if( includeNormals ) {
+			vec3 n;
+			for( int i = 0; i < 3; ++i )
+				p = parseFloat( skipSpace( p, end ), end, &n[i] );
+			chunk->mNormals.push_back( normalize( n ) );
+		}
+	}
+	else if( tagLength == 1 && tag[0] == 'f' ) { // face
+		parseFace( p, end, includeNormals, includeTexCoords, chunk );
+	}
+	else if( ( tagLength == 1 && tag[0] == 'g' ) || ( tagLength == 6 && equal( tag, tag + 6, "usemtl" ) ) ) { // group or material
+		ObjChunk::Event event;
+		event.mType = ( tagLength == 1 ) ? ObjChunk::Event::GROUP : ObjChunk::Event::MATERIAL;
+		event.mFace = chunk->mFaceSizes.size();
+		event.mNumVertices = chunk->mVertices.size();
+		event.mNumTexCoords = chunk->mTexCoords.size();
+		event.mNumNormals = chunk->mNormals.size();
+
+		// group names run to the end of the line, material names are a single token
+		const char *nameBegin = skipSpace( p, end );
+		const char *nameEnd = nameBegin;
+		while( nameEnd < end && ( event.mType == ObjChunk::Event::GROUP ? ( *nameEnd != '\r' && *nameEnd != '\n' ) : ! isSpace( *nameEnd ) ) )
+			++nameEnd;
+		while( nameEnd > nameBegin && isSpace( nameEnd[-1] ) )
+			--nameEnd;
+
+		event.mName.assign( nameBegin, nameEnd );
+		chunk->mEvents.push_back( event );
+	}
+}
+
+void parseChunk( const char *p, const char *end, bool includeNormals, bool includeTexCoords, ObjChunk *chunk )
+{
+	std::string joined;
+	while( p < end ) {
+		const char *next;
+		const char *lineEnd = findLineEnd( p, end, &next );
+
+		// comments are skipped before checking for line continuations, as before
+		const char *first = skipSpace( p, lineEnd );
+		if( first < lineEnd && *first != '#' && lineEnd[-1] == '\\' ) {
+			joined.assign( p, lineEnd - 1 );
+			while( next < end ) {
+				const char *continuation = next;
+				lineEnd = findLineEnd( continuation, end, &next );
+				joined.append( continuation, lineEnd );
+				if( lineEnd == continuation || lineEnd[-1] != '\\' )
+					break;
+
+				joined.pop_back();
+			}
+
+			parseLine( joined.data(), joined.data() + joined.size(), includeNormals, includeTexCoords, chunk );
+		}
+		else
+			parseLine( p, lineEnd, includeNormals, includeTexCoords, chunk );
+
+		p = next;
+	}
+}
+
+// Offsets of each chunk's elements in the concatenated arrays.
+struct ChunkOffsets {
+	size_t	mVertices, mTexCoords, mNormals, mFaces, mCorners;
+};
+
+// Unique output vertices are found through a hash table that is keyed by position index, so each bucket only holds the
+// (few) different tex coord / normal combinations that a position is used with.
+struct UniqueVertex {
+	int32_t		mTexCoord, mNormal;
+	uint32_t	mOutputIndex;
+	int32_t		mNext;
+};
+
+// Cache files start with a header: a magic number and version as uint32's, the size and modification time of the OBJ file as uint64's, the
+// includeNormals, includeTexCoords and optimize flags as uint8's and the number of groups as a uint32, followed by each group's name length as
+// a uint32, its name, and whether it has tex coords and normals as uint8's. Everything is little-endian. The header is padded to a multiple
+// of kCachePageBytes and followed by the geometry in the TriMesh::writeMapped() format, so that its raw blocks stay page aligned.
+const uint32_t	kCacheMagic = 0x4A424F43; // "COBJ"
+const uint32_t	kCacheVersion = 1;
+const size_t	kCachePageBytes = 4096;
+
+// Returns the modification time of the file at \a path in the finest units the platform reports, since fs::last_write_time() only has a resolution
+// of seconds. Falls back to fs::last_write_time() where the finer time isn't available.
+uint64_t getModificationTime( const fs::path &path )
+{
+#if defined( CINDER_MSW )
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if( ::GetFileAttributesExW( path.wstring().c_str(), GetFileExInfoStandard, &attributes ) )
+		return ( uint64_t( attributes.ftLastWriteTime.dwHighDateTime ) << 32 ) | attributes.ftLastWriteTime.dwLowDateTime; // 100ns intervals
+#elif defined( CINDER_COCOA )
+	struct stat info;
+	if( ::stat( path.c_str(), &info ) == 0 )
+		return uint64_t( info.st_mtimespec.tv_sec ) * 1000000000 + uint64_t( info.st_mtimespec.tv_nsec );
+#elif defined( CINDER_LINUX )
+	struct stat info;
+	if( ::stat( path.c_str(), &info ) == 0 )
+		return uint64_t( info.st_mtim.tv_sec ) * 1000000000 + uint64_t( info.st_mtim.tv_nsec );
+#endif
+	return uint64_t( fs::last_write_time( path ) ) * 1000000000;
+}
+
+// OStream and IStream have no 64 bit overloads, so these go through their low and high words
+void writeCacheUint64( const OStreamRef &out, uint64_t value )
+{
+	out->writeLittle( uint32_t( value ) );
+	out->writeLittle( uint32_t( value >> 32 ) );
+}
+
+uint64_t readCacheUint64( const IStreamRef &in )
+{
+	uint32_t low, high;
+	in->readLittle( &low );
+	in->readLittle( &high );
+	return ( uint64_t( high ) << 32 ) | low;
+}
+
+} // anonymous namespace
+
 ObjLoader::ObjLoader( shared_ptr<IStreamCinder> stream, bool includeNormals, bool includeTexCoords, bool optimize )
-	: mStream( stream ), mOutputCached( false ), mOptimizeVertices( optimize ), mGroupIndex( numeric_limits<size_t>::max() )
+	: mOptimizeVertices( optimize ), mOutputCached( false ), mGroupIndex( numeric_limits<size_t>::max() ), mLoadedFromCache( false ),
+	  mIncludeNormals( includeNormals ), mIncludeTexCoords( includeTexCoords ), mGroupFacesCreated( false )
 {
-	parse( includeNormals, includeTexCoords );
+	parse( stream, includeNormals, includeTexCoords );
 }
 
 ObjLoader::ObjLoader( DataSourceRef dataSource, bool includeNormals, bool includeTexCoords, bool optimize )
-	: mStream( dataSource->createStream() ), mOutputCached( false ), mOptimizeVertices( optimize ), mGroupIndex( numeric_limits<size_t>::max() )
+	: mOptimizeVertices( optimize ), mOutputCached( false ), mGroupIndex( numeric_limits<size_t>::max() ), mLoadedFromCache( false ),
+	  mIncludeNormals( includeNormals ), mIncludeTexCoords( includeTexCoords ), mGroupFacesCreated( false )
 {
-	parse( includeNormals, includeTexCoords );
+	parse( dataSource, includeNormals, includeTexCoords );
 }
 
 ObjLoader::ObjLoader( DataSourceRef dataSource, DataSourceRef materialSource, bool includeNormals, bool includeTexCoords, bool optimize )
-	: mStream( dataSource->createStream() ), mOutputCached( false ), mOptimizeVertices( optimize ), mGroupIndex( numeric_limits<size_t>::max() )
+	: mOptimizeVertices( optimize ), mOutputCached( false ), mGroupIndex( numeric_limits<size_t>::max() ), mLoadedFromCache( false ),
+	  mIncludeNormals( includeNormals ), mIncludeTexCoords( includeTexCoords ), mGroupFacesCreated( false )
 {
 	parseMaterial( materialSource->createStream() );
-	parse( includeNormals, includeTexCoords );
+	parse( dataSource, includeNormals, includeTexCoords );
 }
-	
+
+ObjLoader::ObjLoader( const fs::path &filePath, const fs::path &cachePath, bool includeNormals, bool includeTexCoords, bool optimize )
+	: mOptimizeVertices( optimize ), mOutputCached( false ), mGroupIndex( numeric_limits<size_t>::max() ), mLoadedFromCache( false ), mFilePath( filePath ),
+	  mIncludeNormals( includeNormals ), mIncludeTexCoords( includeTexCoords ), mGroupFacesCreated( false )
+{
+	if( ! cachePath.empty() && readCache( cachePath ) )
+		return;
+
+	auto file = MappedFile::create( filePath );
+	parse( static_cast<const char *>( file->getData() ), file->getSize(), includeNormals, includeTexCoords );
+
+	if( ! cachePath.empty() )
+		writeCache( cachePath );
+}
+
+void ObjLoader::parse( const DataSourceRef &dataSource, bool includeNormals, bool includeTexCoords )
+{
+	if( dataSource->isFilePath() ) {
+		auto file = MappedFile::create( dataSource->getFilePath() );
+		parse( static_cast<const char *>( file->getData() ), file->getSize(), includeNormals, includeTexCoords );
+	}
+	else {
+		auto buffer = dataSource->getBuffer();
+		parse( static_cast<const char *>( buffer->getData() ), buffer->getSize(), includeNormals, includeTexCoords );
+	}
+}
+
+void ObjLoader::parse( const shared_ptr<IStreamCinder> &stream, bool includeNormals, bool includeTexCoords )
+{
+	vector<char> data;
+	const size_t blockSize = 1 << 16;
+	while( ! stream->isEof() ) {
+		size_t offset = data.size();
+		data.resize( offset + blockSize );
+		data.resize( offset + stream->readDataAvailable( data.data() + offset, blockSize ) );
+	}
+
+	parse( data.data(), data.size(), includeNormals, includeTexCoords );
+}
+
+void ObjLoader::parse( const char *data, size_t size, bool includeNormals, bool includeTexCoords )
+{
+	// split into chunks at line boundaries and parse them in parallel
+	vector<size_t> chunkStarts( 1, 0 );
+	while( chunkStarts.back() < size )
+		chunkStarts.push_back( findChunkStart( data, size, std::min( chunkStarts.back() + kChunkBytes, size ) ) );
+
+	const size_t numChunks = chunkStarts.size() - 1;
+	vector<ObjChunk> chunks( numChunks );
+	parallelFor( numChunks, [&]( size_t c ) {
+		parseChunk( data + chunkStarts[c], data + chunkStarts[c + 1], includeNormals, includeTexCoords, &chunks[c] );
+	} );
+
+	// concatenate the chunks, resolving relative indices now that each chunk's offsets are known
+	vector<ChunkOffsets> offsets( numChunks + 1 );
+	offsets[0] = ChunkOffsets{ 0, 0, 0, 0, 0 };
+	for( size_t c = 0; c < numChunks; ++c ) {
+		offsets[c + 1].mVertices = offsets[c].mVertices + chunks[c].mVertices.size();
+		offsets[c + 1].mTexCoords = offsets[c].mTexCoords + chunks[c].mTexCoords.size();
+		offsets[c + 1].mNormals = offsets[c].mNormals + chunks[c].mNormals.size();
+		offsets[c + 1].mFaces = offsets[c].mFaces + chunks[c].mFaceSizes.size();
+		offsets[c + 1].mCorners = offsets[c].mCorners + chunks[c].mCornerVertices.size();
+	}
+
+	const ChunkOffsets &totals = offsets[numChunks];
+	mInternalVertices.resize( totals.mVertices );
+	mInternalTexCoords.resize( totals.mTexCoords );
+	mInternalNormals.resize( totals.mNormals );
+	mFaceStarts.resize( totals.mFaces + 1 );
+	mCornerVertices.resize( totals.mCorners );
+	mCornerTexCoords.resize( totals.mCorners );
+	mCornerNormals.resize( totals.mCorners );
+
+	parallelFor( numChunks, [&]( size_t c ) {
+		ObjChunk &chunk = chunks[c];
+		const ChunkOffsets &offset = offsets[c];
+		for( size_t i : chunk.mRelativeVertices )
+			chunk.mCornerVertices[i] += int32_t( offset.mVertices );
+		for( size_t i : chunk.mRelativeTexCoords )
+			chunk.mCornerTexCoords[i] += int32_t( offset.mTexCoords );
+		for( size_t i : chunk.mRelativeNormals )
+			chunk.mCornerNormals[i] += int32_t( offset.mNormals );
+
+		std::copy( chunk.mVertices.begin(), chunk.mVertices.end(), mInternalVertices.begin() + offset.mVertices );
+		std::copy( chunk.mTexCoords.begin(), chunk.mTexCoords.end(), mInternalTexCoords.begin() + offset.mTexCoords );
+		std::copy( chunk.mNormals.begin(), chunk.mNormals.end(), mInternalNormals.begin() + offset.mNormals );
+		std::copy( chunk.mCornerVertices.begin(), chunk.mCornerVertices.end(), mCornerVertices.begin() + offset.mCorners );
+		std::copy( chunk.mCornerTexCoords.begin(), chunk.mCornerTexCoords.end(), mCornerTexCoords.begin() + offset.mCorners );
+		std::copy( chunk.mCornerNormals.begin(), chunk.mCornerNormals.end(), mCornerNormals.begin() + offset.mCorners );
+
+		uint32_t corner = uint32_t( offset.mCorners );
+		for( size_t f = 0; f < chunk.mFaceSizes.size(); ++f ) {
+			mFaceStarts[offset.mFaces + f] = corner;
+			corner += chunk.mFaceSizes[f];
+		}
+
+		// release the chunk's memory as soon as it has been copied
+		vector<vec3>().swap( chunk.mVertices );
+		vector<vec2>().swap( chunk.mTexCoords );
+		vector<vec3>().swap( chunk.mNormals );
+		vector<int32_t>().swap( chunk.mCornerVertices );
+		vector<int32_t>().swap( chunk.mCornerTexCoords );
+		vector<int32_t>().swap( chunk.mCornerNormals );
+	} );
+	mFaceStarts.back() = uint32_t( totals.mCorners );
+
+	// groups and materials apply from the face they precede
+	mGroups.assign( 1, Group() );
+	mGroups.back().mBaseVertexOffset = mGroups.back().mBaseTexCoordOffset = mGroups.back().mBaseNormalOffset = 0;
+	mGroupFaces.assign( 1, make_pair( 0, 0 ) );
+	mFaceMaterials.assign( totals.mFaces, nullptr );
+
+	const Material *currentMaterial = nullptr;
+	size_t materialFace = 0;
+	for( size_t c = 0; c < numChunks; ++c ) {
+		for( const auto &event : chunks[c].mEvents ) {
+			const size_t face = offsets[c].mFaces + event.mFace;
+			if( event.mType == ObjChunk::Event::GROUP ) {
+				if( face > mGroupFaces.back().first ) {
+					mGroupFaces.back().second = face;
+					mGroupFaces.push_back( make_pair( face, face ) );
+					mGroups.push_back( Group() );
+				}
+
+				Group &group = mGroups.back();
+				group.mName = event.mName;
+				group.mBaseVertexOffset = int32_t( offsets[c].mVertices + event.mNumVertices );
+				group.mBaseTexCoordOffset = int32_t( offsets[c].mTexCoords + event.mNumTexCoords );
+				group.mBaseNormalOffset = int32_t( offsets[c].mNormals + event.mNumNormals );
+			}
+			else {
+				auto materialIt = mMaterials.find( event.mName );
+				if( materialIt != mMaterials.end() ) {
+					std::fill( mFaceMaterials.begin() + materialFace, mFaceMaterials.begin() + face, currentMaterial );
+					currentMaterial = &materialIt->second;
+					materialFace = face;
+				}
+			}
+		}
+	}
+
+	std::fill( mFaceMaterials.begin() + materialFace, mFaceMaterials.end(), currentMaterial );
+	mGroupFaces.back().second = totals.mFaces;
+
+	// a group has tex coords or normals if any of its faces does
+	for( size_t g = 0; g < mGroups.size(); ++g ) {
+		Group &group = mGroups[g];
+		group.mHasTexCoords = group.mHasNormals = false;
+		for( size_t corner = mFaceStarts[mGroupFaces[g].first]; corner < mFaceStarts[mGroupFaces[g].second]; ++corner ) {
+			group.mHasTexCoords |= mCornerTexCoords[corner] >= 0;
+			group.mHasNormals |= mCornerNormals[corner] >= 0;
+		}
+	}
+}
+
+const vector<ObjLoader::Group>& ObjLoader::getGroups() const
+{
+	// the cache only has the groups' names, not their faces
+	if( ! mGroupFacesCreated && ! mLoadedFromCache ) {
+		for( size_t g = 0; g < mGroups.size(); ++g ) {
+			Group &group = mGroups[g];
+			group.mFaces.clear();
+			group.mFaces.reserve( mGroupFaces[g].second - mGroupFaces[g].first );
+
+			for( size_t f = mGroupFaces[g].first; f < mGroupFaces[g].second; ++f ) {
+				Face face;
+				face.mNumVertices = int( mFaceStarts[f + 1] - mFaceStarts[f] );
+				face.mMaterial = mFaceMaterials[f];
+				face.mVertexIndices.assign( mCornerVertices.begin() + mFaceStarts[f], mCornerVertices.begin() + mFaceStarts[f + 1] );
+				for( uint32_t corner = mFaceStarts[f]; corner < mFaceStarts[f + 1]; ++corner ) {
+					if( mCornerTexCoords[corner] >= 0 )
+						face.mTexCoordIndices.push_back( mCornerTexCoords[corner] );
+					if( mCornerNormals[corner] >= 0 )
+						face.mNormalIndices.push_back( mCornerNormals[corner] );
+				}
+
+				group.mFaces.push_back( std::move( face ) );
+			}
+		}
+
+		mGroupFacesCreated = true;
+	}
+
+	return mGroups;
+}
+
+void ObjLoader::load() const
+{
+	if( mOutputCached )
+		return;
+
+	mOutputVertices.clear();
+	mOutputNormals.clear();
+	mOutputTexCoords.clear();
+	mOutputColors.clear();
+	mOutputIndices.clear();
+
+	size_t firstGroup = 0, lastGroup = mGroups.size();
+	if( mGroupIndex != numeric_limits<size_t>::max() ) {
+		firstGroup = mGroupIndex;
+		lastGroup = mGroupIndex + 1;
+	}
+
+	bool texCoords = false, normals = false;
+	for( size_t g = firstGroup; g < lastGroup; ++g ) {
+		texCoords |= mGroups[g].mHasTexCoords;
+		normals |= mGroups[g].mHasNormals;
+	}
+
+	const bool hasColors = ! mMaterials.empty();
+	const int32_t numVertices = int32_t( mInternalVertices.size() );
+	const int32_t numTexCoords = int32_t( mInternalTexCoords.size() );
+	const int32_t numNormals = int32_t( mInternalNormals.size() );
+
+	vector<int32_t> uniqueHeads( mInternalVertices.size(), -1 );
+	vector<UniqueVertex> uniqueVertices;
+	vector<uint32_t> faceIndices;
+	size_t numInvalidFaces = 0;
+
+	for( size_t g = firstGroup; g < lastGroup; ++g ) {
+		for( size_t f = mGroupFaces[g].first; f < mGroupFaces[g].second; ++f ) {
+			const uint32_t firstCorner = mFaceStarts[f], lastCorner = mFaceStarts[f + 1];
+
+			bool valid = lastCorner - firstCorner >= 3;
+			bool faceHasTexCoords = texCoords, faceHasNormals = normals;
+			for( uint32_t corner = firstCorner; corner < lastCorner && valid; ++corner ) {
+				valid = mCornerVertices[corner] >= 0 && mCornerVertices[corner] < numVertices;
+				faceHasTexCoords &= mCornerTexCoords[corner] >= 0;
+				faceHasNormals &= mCornerNormals[corner] >= 0;
+			}
+			for( uint32_t corner = firstCorner; corner < lastCorner && valid; ++corner ) {
+				valid = ( ! faceHasTexCoords || mCornerTexCoords[corner] < numTexCoords ) && ( ! faceHasNormals || mCornerNormals[corner] < numNormals );
+			}
+			if( ! valid ) {
+				numInvalidFaces++;
+				continue;
+			}
+
+			const Colorf rgb = ( hasColors && mFaceMaterials[f] ) ? Colorf( mFaceMaterials[f]->Kd[0], mFaceMaterials[f]->Kd[1], mFaceMaterials[f]->Kd[2] ) : Colorf( 1, 1, 1 );
+
+			vec3 inferredNormal;
+			if( normals && ! faceHasNormals ) { // we'll have to derive it from two edges
+				const vec3 &v0 = mInternalVertices[mCornerVertices[firstCorner]];
+				inferredNormal = normalize( cross( mInternalVertices[mCornerVertices[firstCorner + 1]] - v0, mInternalVertices[mCornerVertices[firstCorner + 2]] - v0 ) );
+			}
+
+			// faces that lack attributes the output has get unique vertices
+			const bool forceUnique = ( normals || texCoords ) && ( ! mOptimizeVertices || normals != faceHasNormals || texCoords != faceHasTexCoords );
+
+			faceIndices.clear();
+			for( uint32_t corner = firstCorner; corner < lastCorner; ++corner ) {
+				const int32_t vertex = mCornerVertices[corner];
+				const int32_t texCoord = faceHasTexCoords ? mCornerTexCoords[corner] : -1;
+				const int32_t normal = faceHasNormals ? mCornerNormals[corner] : -1;
+
+				if( ! forceUnique ) {
+					int32_t unique = uniqueHeads[vertex];
+					while( unique >= 0 && ( uniqueVertices[unique].mTexCoord != texCoord || uniqueVertices[unique].mNormal != normal ) )
+						unique = uniqueVertices[unique].mNext;
+
+					if( unique >= 0 ) {
+						faceIndices.push_back( uniqueVertices[unique].mOutputIndex );
+						continue;
+					}
+
+					UniqueVertex uniqueVertex = { texCoord, normal, uint32_t( mOutputVertices.size() ), uniqueHeads[vertex] };
+					uniqueHeads[vertex] = int32_t( uniqueVertices.size() );
+					uniqueVertices.push_back( uniqueVertex );
+				}
+
+				// we've got a new, unique vertex here, so let's append it
+				faceIndices.push_back( uint32_t( mOutputVertices.size() ) );
+				mOutputVertices.push_back( mInternalVertices[vertex] );
+				if( normals )
+					mOutputNormals.push_back( faceHasNormals ? mInternalNormals[normal] : inferredNormal );
+				if( texCoords )
+					mOutputTexCoords.push_back( faceHasTexCoords ? mInternalTexCoords[texCoord] : vec2() );
+				if( hasColors )
+					mOutputColors.push_back( rgb );
+			}
+
+			for( size_t t = 1; t + 1 < faceIndices.size(); ++t ) {
+				mOutputIndices.push_back( faceIndices[0] ); mOutputIndices.push_back( faceIndices[t] ); mOutputIndices.push_back( faceIndices[t + 1] );
+			}
+		}
+	}
+
+	if( numInvalidFaces )
+		CI_LOG_W( "skipped " << numInvalidFaces << " faces with fewer than three vertices or out of range indices" );
+
+	mOutputCached = true;
+}
+
+bool ObjLoader::readCache( const fs::path &cachePath )
+{
+	try {
+		if( ! fs::exists( cachePath ) )
+			return false;
+
+		auto file = MappedFile::create( cachePath );
+		const size_t size = file->getSize();
+		IStreamRef in = IStreamMem::create( file->getData(), size );
+
+		uint32_t magic, version;
+		in->readLittle( &magic );
+		in->readLittle( &version );
+		if( magic != kCacheMagic || version != kCacheVersion )
+			return false;
+
+		const uint64_t fileSize = readCacheUint64( in );
+		const uint64_t modificationTime = readCacheUint64( in );
+		uint8_t includeNormals, includeTexCoords, optimize;
+		in->read( &includeNormals );
+		in->read( &includeTexCoords );
+		in->read( &optimize );
+		if( fileSize != fs::file_size( mFilePath ) || modificationTime != getModificationTime( mFilePath )
+			|| ( includeNormals != 0 ) != mIncludeNormals || ( includeTexCoords != 0 ) != mIncludeTexCoords || ( optimize != 0 ) != mOptimizeVertices )
+			return false;
+
+		uint32_t numGroups;
+		in->readLittle( &numGroups );
+		if( numGroups > size )
+			return false;
+
+		vector<Group> groups( numGroups );
+		for( auto &group : groups ) {
+			uint32_t nameLength;
+			in->readLittle( &nameLength );
+			if( nameLength > size )
+				return false;
+
+			group.mName.resize( nameLength );
+			if( nameLength )
+				in->readData( &group.mName[0], nameLength );
+
+			uint8_t hasTexCoords, hasNormals;
+			in->read( &hasTexCoords );
+			in->read( &hasNormals );
+			group.mHasTexCoords = hasTexCoords != 0;
+			group.mHasNormals = hasNormals != 0;
+			group.mBaseVertexOffset = group.mBaseTexCoordOffset = group.mBaseNormalOffset = 0;
+		}
+
+		// the geometry is read straight from the mapping, as a Buffer that doesn't own it
+		const size_t meshOffset = ( size_t( in->tell() ) + kCachePageBytes - 1 ) / kCachePageBytes * kCachePageBytes;
+		if( meshOffset >= size )
+			return false;
+
+		auto meshBuffer = make_shared<Buffer>( const_cast<uint8_t *>( static_cast<const uint8_t *>( file->getData() ) ) + meshOffset, size - meshOffset );
+		MappedTriMesh mesh( DataSourceBuffer::create( meshBuffer ) );
+
+		const size_t numVertices = mesh.getNumVertices();
+		const uint8_t normalsDims = mesh.getAttribDims( geom::NORMAL ), texCoordsDims = mesh.getAttribDims( geom::TEX_COORD_0 ), colorsDims = mesh.getAttribDims( geom::COLOR );
+		if( mesh.getAttribDims( geom::POSITION ) != 3 || ( normalsDims && normalsDims != 3 ) || ( texCoordsDims && texCoordsDims != 2 ) || ( colorsDims && colorsDims != 3 ) )
+			return false;
+
+		auto positions = reinterpret_cast<const vec3 *>( mesh.getAttribData( geom::POSITION ) );
+		mOutputVertices.assign( positions, positions + numVertices );
+		if( normalsDims ) {
+			auto normals = reinterpret_cast<const vec3 *>( mesh.getAttribData( geom::NORMAL ) );
+			mOutputNormals.assign( normals, normals + numVertices );
+		}
+		if( texCoordsDims ) {
+			auto texCoords = reinterpret_cast<const vec2 *>( mesh.getAttribData( geom::TEX_COORD_0 ) );
+			mOutputTexCoords.assign( texCoords, texCoords + numVertices );
+		}
+		if( colorsDims ) {
+			auto colors = reinterpret_cast<const Colorf *>( mesh.getAttribData( geom::COLOR ) );
+			mOutputColors.assign( colors, colors + numVertices );
+		}
+		if( mesh.getIndices() )
+			mOutputIndices.assign( mesh.getIndices(), mesh.getIndices() + mesh.getNumIndices() );
+
+		mGroups.swap( groups );
+	}
+	catch( std::exception &exc ) {
+		CI_LOG_W( "failed to read cache " << cachePath << ": " << exc.what() );
+		mOutputVertices.clear();
+		mOutputNormals.clear();
+		mOutputTexCoords.clear();
+		mOutputColors.clear();
+		mOutputIndices.clear();
+		return false;
+	}
+
+	mOutputCached = true;
+	mLoadedFromCache = true;
+	return true;
+}
+
+void ObjLoader::writeCache( const fs::path &cachePath ) const
+{
+	load();
+
+	TriMesh::Format format = TriMesh::Format().positions( 3 );
+	if( ! mOutputNormals.empty() )
+		format.normals();
+	if( ! mOutputTexCoords.empty() )
+		format.texCoords0( 2 );
+	if( ! mOutputColors.empty() )
+		format.colors( 3 );
+
+	TriMesh mesh( format );
+	mesh.appendPositions( mOutputVertices.data(), mOutputVertices.size() );
+	if( ! mOutputNormals.empty() )
+		mesh.appendNormals( mOutputNormals.data(), mOutputNormals.size() );
+	if( ! mOutputTexCoords.empty() )
+		mesh.appendTexCoords0( mOutputTexCoords.data(), mOutputTexCoords.size() );
+	if( ! mOutputColors.empty() )
+		mesh.appendColors( mOutputColors.data(), mOutputColors.size() );
+	mesh.appendIndices( mOutputIndices.data(), mOutputIndices.size() );
+
+	try {
+		OStreamRef out = writeFileStream( cachePath );
+		out->writeLittle( kCacheMagic );
+		out->writeLittle( kCacheVersion );
+		writeCacheUint64( out, fs::file_size( mFilePath ) );
+		writeCacheUint64( out, getModificationTime( mFilePath ) );
+		out->write( uint8_t( mIncludeNormals ) );
+		out->write( uint8_t( mIncludeTexCoords ) );
+		out->write( uint8_t( mOptimizeVertices ) );
+
+		out->writeLittle( uint32_t( mGroups.size() ) );
+		for( const auto &group : mGroups ) {
+			out->writeLittle( uint32_t( group.mName.size() ) );
+			out->writeData( group.mName.data(), group.mName.size() );
+			out->write( uint8_t( group.mHasTexCoords ) );
+			out->write( uint8_t( group.mHasNormals ) );
+		}
+
+		const size_t headerSize = size_t( out->tell() );
+		const vector<uint8_t> padding( ( headerSize + kCachePageBytes - 1 ) / kCachePageBytes * kCachePageBytes - headerSize, 0 );
+		if( ! padding.empty() )
+			out->writeData( padding.data(), padding.size() );
+
+		mesh.writeMapped( DataTargetStream::createRef( out ) );
+	}
+	catch( std::exception &exc ) {
+		CI_LOG_W( "failed to write cache " << cachePath << ": " << exc.what() );
+	}
+}
+
+void ObjLoader::parseCachedFile()
+{
+	auto file = MappedFile::create( mFilePath );
+	parse( static_cast<const char *>( file->getData() ), file->getSize(), mIncludeNormals, mIncludeTexCoords );
+	mLoadedFromCache = false;
+	mGroupFacesCreated = false;
+	mOutputCached = false;
+}
+
 ObjLoader& ObjLoader::groupIndex( size_t groupIndex )
 {
 	if ( groupIndex < mGroups.size() ) {
 		if ( groupIndex != mGroupIndex ) {
+			// the cached geometry holds all groups, so loading just one needs the parsed file
+			if( mLoadedFromCache )
+				parseCachedFile();
 			mGroupIndex = groupIndex;
 			mOutputCached = false;
 		}
@@ -80,6 +909,8 @@ ObjLoader& ObjLoader::groupName( const std::string &groupName )
 	if ( it != mGroups.end() ) {
 		size_t groupIndex = std::distance( mGroups.begin(), it );
 		if ( groupIndex != mGroupIndex ) {
+			if( mLoadedFromCache )
+				parseCachedFile();
 			mGroupIndex = groupIndex;
 			mOutputCached = false;
 		}
@@ -186,466 +1017,13 @@ void ObjLoader::parseMaterial( std::shared_ptr<IStreamCinder> material )
         mMaterials[m.mName] = m;
 }
 
-void ObjLoader::parse( bool includeNormals, bool includeTexCoords )
-{
-	Group *currentGroup;
-	mGroups.push_back( Group() );
-	currentGroup = &mGroups[mGroups.size()-1];
-	currentGroup->mBaseVertexOffset = currentGroup->mBaseTexCoordOffset = currentGroup->mBaseNormalOffset = 0;
-
-    const Material *currentMaterial = 0;
-    
-	size_t lineNumber = 0;
-	while( ! mStream->isEof() ) {
-		lineNumber++;
-		string line = mStream->readLine(), tag;
-        if( line.empty() || line[0] == '#' )
-            continue;
-
-		while( line.back() == '\\' && ! mStream->isEof() ) {
-			auto next = mStream->readLine();
-			line = line.substr( 0, line.size() - 1 ) + next;
-		}
-
-		stringstream ss( line );
-		ss >> tag;
-		if( tag == "v" ) { // vertex
-			vec3 v;
-			ss >> v.x >> v.y >> v.z;
-			mInternalVertices.push_back( v );
-		}
-		else if( tag == "vt" ) { // vertex texture coordinates
-			if( includeTexCoords ) {
-				vec2 tex;
-				ss >> tex.x >> tex.y;
-				mInternalTexCoords.push_back( tex );
-			}
-		}
-		else if( tag == "vn" ) { // vertex normals
-			if ( includeNormals ) {
-				vec3 v;
-				ss >> v.x >> v.y >> v.z;
-				mInternalNormals.push_back( normalize( v ) );
-			}
-		}
-		else if( tag == "f" ) { // face
-			parseFace( currentGroup, currentMaterial, line, includeNormals, includeTexCoords );
-		}
-		else if( tag == "g" ) { // group
-			if( ! currentGroup->mFaces.empty() )
-				mGroups.push_back( Group() );
-			currentGroup = &mGroups[mGroups.size()-1];
-			currentGroup->mBaseVertexOffset = (int32_t)mInternalVertices.size();
-			currentGroup->mBaseTexCoordOffset = (int32_t)mInternalTexCoords.size();
-			currentGroup->mBaseNormalOffset = (int32_t)mInternalNormals.size();
-			currentGroup->mName = line.substr( line.find( ' ' ) + 1 );
-		}
-        else if( tag == "usemtl") { // material
-            string tag;
-            ss >> tag;
-            std::map<std::string, Material>::const_iterator m = mMaterials.find(tag);
-            if( m != mMaterials.end() ) {
-                currentMaterial = &m->second;
-            }
-        }
-	}
-}
-
-void ObjLoader::parseFace( Group *group, const Material *material, const std::string &s, bool includeNormals, bool includeTexCoords )
-{
-	ObjLoader::Face result;
-	result.mNumVertices = 0;
-    result.mMaterial = material;
-
-	size_t offset = 2; // account for "f "
-	size_t length = s.length();
-	while( offset < length ) {
-		size_t endOfTriple, firstSlashOffset, secondSlashOffset;
-	
-		while( s[offset] == ' ' )
-			++offset;
-	
-		// find the end of this triple "v/vt/vn"
-		endOfTriple = s.find( ' ', offset );
-		if( endOfTriple == string::npos ) endOfTriple = length;
-		firstSlashOffset = s.find( '/', offset );
-		if( firstSlashOffset != string::npos ) {
-			secondSlashOffset = s.find( '/', firstSlashOffset + 1 );
-			if( secondSlashOffset > endOfTriple ) secondSlashOffset = string::npos;
-		}
-		else
-			secondSlashOffset = string::npos;
-		
-		// process the vertex index
-		int vertexIndex = (firstSlashOffset != string::npos) ? 
-            stoi( s.substr( offset, firstSlashOffset - offset ) ) :
-            stoi( s.substr( offset, endOfTriple - offset));
-        
-		if( vertexIndex < 0 )
-			result.mVertexIndices.push_back( group->mBaseVertexOffset + vertexIndex );
-		else
-			result.mVertexIndices.push_back( vertexIndex - 1 );
-			
-		// process the tex coord index
-		if( includeTexCoords && ( firstSlashOffset != string::npos ) ) {
-			size_t numSize = ( secondSlashOffset == string::npos ) ? ( endOfTriple - firstSlashOffset - 1 ) : secondSlashOffset - firstSlashOffset - 1;
-			if( numSize > 0 ) {
-				int texCoordIndex = stoi( s.substr( firstSlashOffset + 1, numSize ) );
-				if( texCoordIndex < 0 )
-					result.mTexCoordIndices.push_back( group->mBaseTexCoordOffset + texCoordIndex );
-				else
-					result.mTexCoordIndices.push_back( texCoordIndex - 1 );
-				if( group->mFaces.empty() )
-					group->mHasTexCoords = true;
-			}
-			else
-				group->mHasTexCoords = false;
-		}
-		else if( group->mFaces.empty() ) // if this is the first face, let's note that this group has no tex coords
-			group->mHasTexCoords = false;
-			
-		// process the normal index
-		if( includeNormals && ( secondSlashOffset != string::npos ) ) {
-			int normalIndex = stoi( s.substr( secondSlashOffset + 1, endOfTriple - secondSlashOffset - 1 ) );
-			if( normalIndex < 0 )
-				result.mNormalIndices.push_back( group->mBaseNormalOffset + normalIndex );
-			else
-				result.mNormalIndices.push_back( normalIndex - 1 );
-			group->mHasNormals = true;
-		}
-		else if( group->mFaces.empty() ) // if this is the first face, let's note that this group has no normals
-			group->mHasNormals = false;
-		
-		offset = endOfTriple + 1;
-		result.mNumVertices++;
-	}
-	
-	group->mFaces.push_back( result );
-}
-	
-void ObjLoader::load() const
-{
-	if( mOutputCached )
-		return;
-
-	mOutputVertices.clear();
-	mOutputNormals.clear();
-	mOutputTexCoords.clear();
-	mOutputColors.clear();
-	mOutputIndices.clear();
-	
-	bool hasGroupIndex = ( mGroupIndex != numeric_limits<size_t>::max() );
-
-	bool texCoords;
-	if( hasGroupIndex ) {
-		texCoords = mGroups[mGroupIndex].mHasTexCoords;
-	}
-	else {
-		texCoords = false;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt ) {
-			if( groupIt->mHasTexCoords ) {
-				texCoords = true;
-				break;
-			}
-		}
-	}
-	
-	bool normals;
-	if( hasGroupIndex ) {
-		normals = mGroups[mGroupIndex].mHasNormals;
-	}
-	else {
-		normals = false;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt ) {
-			if( groupIt->mHasNormals ) {
-				normals = true;
-				break;
-			}
-		}
-	}
-	
-	if( normals && texCoords ) {
-		if( hasGroupIndex ) {
-			map<VertexTriple,int> uniqueVerts;
-			loadGroupNormalsTextures( mGroups[mGroupIndex], uniqueVerts );
-		}
-		else {
-			map<VertexTriple,int> uniqueVerts;
-			for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-				loadGroupNormalsTextures( *groupIt, uniqueVerts );
-		}
-	}
-	else if( normals ) {
-		if( hasGroupIndex ) {
-			map<VertexPair,int> uniqueVerts;
-			loadGroupNormals( mGroups[mGroupIndex], uniqueVerts );
-		}
-		else {
-			map<VertexPair,int> uniqueVerts;
-			for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-				loadGroupNormals( *groupIt, uniqueVerts );
-		}
-	}
-	else if( texCoords ) {
-		if( hasGroupIndex ) {
-			map<VertexPair,int> uniqueVerts;
-			loadGroupTextures( mGroups[mGroupIndex], uniqueVerts );
-		}
-		else {
-			map<VertexPair,int> uniqueVerts;
-			for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-				loadGroupTextures( *groupIt, uniqueVerts );
-		}
-	}
-	else {
-		if( hasGroupIndex ) {
-			map<int,int> uniqueVerts;
-			loadGroup( mGroups[mGroupIndex], uniqueVerts );
-		}
-		else {
-			map<int,int> uniqueVerts;
-			for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-				loadGroup( *groupIt, uniqueVerts );
-		}
-	}
-	
-	mOutputCached = true;
-}
-
-void ObjLoader::loadGroupNormalsTextures( const Group &group, map<VertexTriple,int> &uniqueVerts ) const
-{
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-		vec3 inferredNormal;
-		bool forceUnique = ! mOptimizeVertices;
-		Color rgb;
-		if( hasColors ) {
-			const Material *m = group.mFaces[f].mMaterial;
-			if( m ) {
-				rgb.r = m->Kd[0];
-				rgb.g = m->Kd[1];
-				rgb.b = m->Kd[2];
-			}
-			else {
-				rgb.r = 1;
-				rgb.g = 1;
-				rgb.b = 1;
-			}
-		}
-		if( group.mFaces[f].mNormalIndices.empty() ) { // we'll have to derive it from two edges
-			vec3 edge1 = mInternalVertices[group.mFaces[f].mVertexIndices[1]] - mInternalVertices[group.mFaces[f].mVertexIndices[0]];
-			vec3 edge2 = mInternalVertices[group.mFaces[f].mVertexIndices[2]] - mInternalVertices[group.mFaces[f].mVertexIndices[0]];
-			inferredNormal = normalize( cross( edge1, edge2 ) );
-			forceUnique = true;
-		}
-		
-		if( group.mFaces[f].mTexCoordIndices.empty() )
-			forceUnique = true;
-		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexTriple vTriple = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mTexCoordIndices[v], group.mFaces[f].mNormalIndices[v] );
-				pair<map<VertexTriple,int>::iterator,bool> result = uniqueVerts.insert( make_pair( vTriple, mOutputVertices.size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					mOutputVertices.push_back( mInternalVertices[group.mFaces[f].mVertexIndices[v]] );
-					mOutputNormals.push_back( mInternalNormals[group.mFaces[f].mNormalIndices[v]] );
-					mOutputTexCoords.push_back( mInternalTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-					if( hasColors )
-						mOutputColors.push_back( rgb );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks either normals or texCoords
-				faceIndices.push_back( (int32_t)mOutputVertices.size() );
-
-				mOutputVertices.push_back( mInternalVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasNormals )
-					mOutputNormals.push_back( inferredNormal );
-				else
-					mOutputNormals.push_back( mInternalNormals[group.mFaces[f].mNormalIndices[v]] );
-				if( ! group.mHasTexCoords )
-					mOutputTexCoords.push_back( vec2() );
-				else
-					mOutputTexCoords.push_back( mInternalTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-                if( hasColors )
-                    mOutputColors.push_back( rgb );
-			}
-		}
-
-		int32_t triangles = (int32_t)faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			mOutputIndices.push_back( faceIndices[0] ); mOutputIndices.push_back( faceIndices[t + 1] ); mOutputIndices.push_back( faceIndices[t + 2] );
-		}
-	}	
-}
-
-void ObjLoader::loadGroupNormals( const Group &group, map<VertexPair,int> &uniqueVerts ) const
-{
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-        Color rgb;
-        if( hasColors ) {
-			const Material *m = group.mFaces[f].mMaterial;
-			if( m ) {
-				rgb.r = m->Kd[0];
-				rgb.g = m->Kd[1];
-				rgb.b = m->Kd[2];
-			}
-			else {
-				rgb.r = 1;
-				rgb.g = 1;
-				rgb.b = 1;
-			}
-        }
-		vec3 inferredNormal;
-		bool forceUnique = ! mOptimizeVertices;
-		if( group.mFaces[f].mNormalIndices.empty() ) { // we'll have to derive it from two edges
-			vec3 edge1 = mInternalVertices[group.mFaces[f].mVertexIndices[1]] - mInternalVertices[group.mFaces[f].mVertexIndices[0]];
-			vec3 edge2 = mInternalVertices[group.mFaces[f].mVertexIndices[2]] - mInternalVertices[group.mFaces[f].mVertexIndices[0]];
-			inferredNormal = normalize( cross( edge1, edge2 ) );
-			forceUnique = true;
-		}
-		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexPair vPair = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mNormalIndices[v] );
-				pair<map<VertexPair,int>::iterator,bool> result = uniqueVerts.insert( make_pair( vPair, mOutputVertices.size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					mOutputVertices.push_back( mInternalVertices[group.mFaces[f].mVertexIndices[v]] );
-					mOutputNormals.push_back( mInternalNormals[group.mFaces[f].mNormalIndices[v]] );
-                    if( hasColors )
-                        mOutputColors.push_back( rgb );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks normals
-				faceIndices.push_back( (int32_t)mOutputVertices.size() );
-
-				mOutputVertices.push_back( mInternalVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasNormals )
-					mOutputNormals.push_back( inferredNormal );
-				else
-					mOutputNormals.push_back( mInternalNormals[group.mFaces[f].mNormalIndices[v]] );
-                if( hasColors )
-                    mOutputColors.push_back( rgb );
-			}
-		}
-
-		int32_t triangles = (int32_t)faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			mOutputIndices.push_back( faceIndices[0] ); mOutputIndices.push_back( faceIndices[t + 1] ); mOutputIndices.push_back( faceIndices[t + 2] );
-		}
-	}	
-}
-
-void ObjLoader::loadGroupTextures( const Group &group, map<VertexPair,int> &uniqueVerts ) const
-{
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-        Color rgb;
-        if( hasColors ) {
-			const Material *m = group.mFaces[f].mMaterial;
-			if( m ) {
-				rgb.r = m->Kd[0];
-				rgb.g = m->Kd[1];
-				rgb.b = m->Kd[2];
-			}
-			else {
-				rgb.r = 1;
-				rgb.g = 1;
-				rgb.b = 1;
-			}
-		}
-		bool forceUnique = ! mOptimizeVertices;
-		if( group.mFaces[f].mTexCoordIndices.empty() )
-			forceUnique = true;
-		
-		vector<int32_t> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexPair vPair = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mTexCoordIndices[v] );
-				pair<map<VertexPair,int>::iterator,bool> result = uniqueVerts.insert( make_pair( vPair, mOutputVertices.size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					mOutputVertices.push_back( mInternalVertices[group.mFaces[f].mVertexIndices[v]] );
-					mOutputTexCoords.push_back( mInternalTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-                    if( hasColors )
-                        mOutputColors.push_back( rgb );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks texCoords
-				faceIndices.push_back( (int32_t)mOutputVertices.size() );
-
-				mOutputVertices.push_back( mInternalVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasTexCoords )
-					mOutputTexCoords.push_back( vec2() );
-				else
-					mOutputTexCoords.push_back( mInternalTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-                if( hasColors )
-                    mOutputColors.push_back( rgb );
-			}
-		}
-
-		int32_t triangles = (int32_t)faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			mOutputIndices.push_back( faceIndices[0] ); mOutputIndices.push_back( faceIndices[t + 1] ); mOutputIndices.push_back( faceIndices[t + 2] );
-		}
-	}	
-}
-
-void ObjLoader::loadGroup( const Group &group, map<int,int> &uniqueVerts ) const
-{
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-        Color rgb;
-        if( hasColors ) {
-			const Material *m = group.mFaces[f].mMaterial;
-            if( m ) {
-                rgb.r = m->Kd[0];
-                rgb.g = m->Kd[1];
-                rgb.b = m->Kd[2];
-            }
-            else {
-                rgb.r = 1;
-                rgb.g = 1;
-                rgb.b = 1;
-            }
-        }
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			pair<map<int,int>::iterator,bool> result = uniqueVerts.insert( make_pair( group.mFaces[f].mVertexIndices[v], mOutputVertices.size() ) );
-			if( result.second ) { // we've got a new, unique vertex here, so let's append it
-				mOutputVertices.push_back( mInternalVertices[group.mFaces[f].mVertexIndices[v]] );
-                if( hasColors )
-                    mOutputColors.push_back( rgb );
-			}
-			// the unique ID of the vertex is appended for this vert
-			faceIndices.push_back( result.first->second );
-		}
-
-		int32_t triangles = (int32_t)faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			mOutputIndices.push_back( faceIndices[0] ); mOutputIndices.push_back( faceIndices[t + 1] ); mOutputIndices.push_back( faceIndices[t + 2] );
-		}
-	}	
-}
-
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // OBJ Writing
 namespace {
 class ObjWriteTarget : public geom::Target {
   public:
 	ObjWriteTarget( OStreamRef stream, bool includeNormals, bool includeTexCoords )
-		: mStream( stream ), mIncludeNormals( includeNormals ), mIncludeTexCoords( includeTexCoords )
+		: mStream( stream ), mIncludeTexCoords( includeTexCoords ), mIncludeNormals( includeNormals )
 	{
 		mHasNormals = mHasTexCoords = false;
 	}
@@ -25,10 +25,16 @@
 
 #include "cinder/TriMesh.h"
 #include "cinder/Exception.h"
+#include "cinder/Utilities.h"
 #if defined( CINDER_ANDROID )
 	#include "cinder/android/CinderAndroid.h"
 #endif 
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+
 using namespace std;
 
 namespace cinder {
@@ -44,6 +50,7 @@ class TriMeshGeomTarget : public geom::Target {
 	uint8_t	getAttribDims( geom::Attrib attr ) const override;
 	void copyAttrib( geom::Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) override;
 	void copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) override;
+	float* getAttribStorage( geom::Attrib attr, uint8_t dims, size_t count, size_t *resultStrideBytes ) override;
 	
   protected:
 	TriMesh		*mMesh;
@@ -60,6 +67,28 @@ void TriMeshGeomTarget::copyAttrib( geom::Attrib attr, uint8_t dims, size_t stri
 	mMesh->copyAttrib( attr, dims, strideBytes, srcData, count );
 }
 
+float* TriMeshGeomTarget::getAttribStorage( geom::Attrib attr, uint8_t dims, size_t count, size_t *resultStrideBytes )
+{
+	// only offer storage when no conversion between dimensions is necessary; copyAttrib() handles the rest
+	if( dims == 0 || mMesh->getAttribDims( attr ) != dims )
+		return nullptr;
+
+	*resultStrideBytes = 0;
+	switch( attr ) {
+		case geom::Attrib::POSITION:	mMesh->mPositions.resize( dims * count );	return mMesh->mPositions.data();
+		case geom::Attrib::COLOR:		mMesh->mColors.resize( dims * count );		return mMesh->mColors.data();
+		case geom::Attrib::TEX_COORD_0:	mMesh->mTexCoords0.resize( dims * count );	return mMesh->mTexCoords0.data();
+		case geom::Attrib::TEX_COORD_1:	mMesh->mTexCoords1.resize( dims * count );	return mMesh->mTexCoords1.data();
+		case geom::Attrib::TEX_COORD_2:	mMesh->mTexCoords2.resize( dims * count );	return mMesh->mTexCoords2.data();
+		case geom::Attrib::TEX_COORD_3:	mMesh->mTexCoords3.resize( dims * count );	return mMesh->mTexCoords3.data();
+		case geom::Attrib::NORMAL:		mMesh->mNormals.resize( count );			return (float*)mMesh->mNormals.data();
+		case geom::Attrib::TANGENT:		mMesh->mTangents.resize( count );			return (float*)mMesh->mTangents.data();
+		case geom::Attrib::BITANGENT:	mMesh->mBitangents.resize( count );			return (float*)mMesh->mBitangents.data();
+		default:
+			return nullptr;
+	}
+}
+
 void TriMeshGeomTarget::copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex )
 {
 	size_t targetNumIndices = numIndices;
@@ -446,6 +475,194 @@ AxisAlignedBox TriMesh::calcBoundingBox( const mat4 &transform ) const
 	return AxisAlignedBox( min, max );
 }
 
+namespace {
+
+// Version 3 files start with a 16 byte header: the version byte (in the same place as in version 1 and 2 files), a reserved byte, the number of
+// blocks as a uint16 and the number of vertices and indices as uint32's. It is followed by a table with one 24 byte entry per block: the toMask()
+// of its attribute (0 for the indices) as a uint32, its dimensions and codec as uint8's, two reserved bytes and its offset and size in bytes
+// as uint64's. Everything is little-endian. Uncompressed blocks are raw floats or uint32 indices starting on a page boundary.
+const uint8_t	kMappedVersion = 3;
+const size_t	kMappedHeaderBytes = 16;
+const size_t	kMappedBlockBytes = 24;
+const size_t	kMappedPageBytes = 4096;
+const uint32_t	kMappedIndicesBlock = 0;
+const uint8_t	kMappedCodecRaw = 0;
+const uint8_t	kMappedCodecCompressed = 1;
+
+// The vertex codec deltas each component against the previous vertex, then stores every byte of the zigzagged deltas as a separate plane.
+// Each plane is split into groups of 16 bytes, which are packed with 0, 2, 4 or 8 bits per byte as selected by a 2 bit header per group.
+const size_t	kGroupSize = 16;
+const int		kGroupBits[4] = { 0, 2, 4, 8 };
+
+struct MappedBlock {
+	uint32_t	mAttrib;
+	uint8_t		mDims, mCodec;
+	uint64_t	mOffset, mSize;
+};
+
+template<typename T>
+T readMapped( const uint8_t *data )
+{
+	T result;
+	memcpy( &result, data, sizeof( T ) );
+	return result;
+}
+
+inline uint32_t zigzagEncode( uint32_t v )
+{
+	return ( v << 1 ) ^ ( 0 - ( v >> 31 ) );
+}
+
+inline uint32_t zigzagDecode( uint32_t v )
+{
+	return ( v >> 1 ) ^ ( 0 - ( v & 1 ) );
+}
+
+// Indices are stored as varints of the zigzagged difference to the previous index, which is small for meshes with decent vertex locality.
+void encodeIndices( const uint32_t *indices, size_t numIndices, vector<uint8_t> *result )
+{
+	uint32_t last = 0;
+	for( size_t i = 0; i < numIndices; i++ ) {
+		uint32_t v = zigzagEncode( indices[i] - last );
+		last = indices[i];
+		while( v >= 0x80 ) {
+			result->push_back( uint8_t( v ) | 0x80 );
+			v >>= 7;
+		}
+		result->push_back( uint8_t( v ) );
+	}
+}
+
+bool decodeIndices( const uint8_t *data, size_t size, size_t numIndices, uint32_t *result )
+{
+	const uint8_t *end = data + size;
+	uint32_t last = 0;
+	for( size_t i = 0; i < numIndices; i++ ) {
+		uint32_t v = 0;
+		for( int shift = 0; ; shift += 7 ) {
+			if( data == end || shift > 28 )
+				return false;
+			uint8_t b = *data++;
+			v |= uint32_t( b & 0x7f ) << shift;
+			if( ! ( b & 0x80 ) )
+				break;
+		}
+		last += zigzagDecode( v );
+		result[i] = last;
+	}
+
+	return data == end;
+}
+
+void encodeBytePlane( const uint8_t *bytes, size_t count, vector<uint8_t> *result )
+{
+	const size_t numGroups = ( count + kGroupSize - 1 ) / kGroupSize;
+	const size_t headerPos = result->size();
+	result->resize( headerPos + ( numGroups + 3 ) / 4, 0 );
+
+	for( size_t g = 0; g < numGroups; g++ ) {
+		uint8_t group[kGroupSize] = { 0 };
+		const size_t groupCount = std::min( kGroupSize, count - g * kGroupSize );
+		uint8_t combined = 0;
+		for( size_t i = 0; i < groupCount; i++ ) {
+			group[i] = bytes[g * kGroupSize + i];
+			combined |= group[i];
+		}
+
+		int mode = combined == 0 ? 0 : ( combined < 4 ? 1 : ( combined < 16 ? 2 : 3 ) );
+		(*result)[headerPos + g / 4] |= uint8_t( mode << ( ( g % 4 ) * 2 ) );
+
+		const int bits = kGroupBits[mode];
+		const int valuesPerByte = bits ? 8 / bits : 0;
+		for( size_t i = 0; bits && i < kGroupSize; i += valuesPerByte ) {
+			uint8_t packed = 0;
+			for( int v = 0; v < valuesPerByte; v++ )
+				packed |= uint8_t( group[i + v] << ( v * bits ) );
+			result->push_back( packed );
+		}
+	}
+}
+
+// ORs the bytes of the plane at \a data, shifted left by \a shift, into \a result. Returns the end of the plane or nullptr if it overruns \a end.
+const uint8_t* decodeBytePlane( const uint8_t *data, const uint8_t *end, size_t count, int shift, uint32_t *result )
+{
+	const size_t numGroups = ( count + kGroupSize - 1 ) / kGroupSize;
+	const uint8_t *header = data;
+	if( size_t( end - data ) < ( numGroups + 3 ) / 4 )
+		return nullptr;
+	data += ( numGroups + 3 ) / 4;
+
+	for( size_t g = 0; g < numGroups; g++ ) {
+		const int bits = kGroupBits[( header[g / 4] >> ( ( g % 4 ) * 2 ) ) & 3];
+		if( bits == 0 )
+			continue;
+
+		const size_t groupBytes = kGroupSize * bits / 8;
+		if( size_t( end - data ) < groupBytes )
+			return nullptr;
+
+		const uint32_t mask = ( 1u << bits ) - 1;
+		const size_t groupCount = std::min( kGroupSize, count - g * kGroupSize );
+		uint32_t *groupResult = result + g * kGroupSize;
+		if( bits == 8 ) {
+			for( size_t i = 0; i < groupCount; i++ )
+				groupResult[i] |= uint32_t( data[i] ) << shift;
+		}
+		else {
+			for( size_t i = 0; i < groupCount; i++ ) {
+				const size_t bit = i * bits;
+				groupResult[i] |= ( ( data[bit / 8] >> ( bit % 8 ) ) & mask ) << shift;
+			}
+		}
+		data += groupBytes;
+	}
+
+	return data;
+}
+
+void encodeVertices( const uint32_t *words, size_t numVertices, uint8_t dims, vector<uint8_t> *result )
+{
+	vector<uint32_t> deltas( numVertices );
+	vector<uint8_t> plane( numVertices );
+	for( uint8_t c = 0; c < dims; c++ ) {
+		uint32_t last = 0;
+		for( size_t i = 0; i < numVertices; i++ ) {
+			const uint32_t word = words[i * dims + c];
+			deltas[i] = zigzagEncode( word - last );
+			last = word;
+		}
+
+		for( int shift = 0; shift < 32; shift += 8 ) {
+			for( size_t i = 0; i < numVertices; i++ )
+				plane[i] = uint8_t( deltas[i] >> shift );
+			encodeBytePlane( plane.data(), numVertices, result );
+		}
+	}
+}
+
+bool decodeVertices( const uint8_t *data, size_t size, size_t numVertices, uint8_t dims, uint32_t *result )
+{
+	const uint8_t *end = data + size;
+	vector<uint32_t> deltas( numVertices );
+	for( uint8_t c = 0; c < dims; c++ ) {
+		std::fill( deltas.begin(), deltas.end(), 0 );
+		for( int shift = 0; shift < 32 && data; shift += 8 )
+			data = decodeBytePlane( data, end, numVertices, shift, deltas.data() );
+		if( ! data )
+			return false;
+
+		uint32_t last = 0;
+		for( size_t i = 0; i < numVertices; i++ ) {
+			last += zigzagDecode( deltas[i] );
+			result[i * dims + c] = last;
+		}
+	}
+
+	return data == end;
+}
+
+} // anonymous namespace
+
 void TriMesh::read( const DataSourceRef &dataSource )
 {
 	IStreamRef in = dataSource->createStream();
@@ -461,8 +678,14 @@ void TriMesh::read( const DataSourceRef &dataSource )
 		clear();
 		readImplV2( in );
 	}
+	else if( versionNumber == kMappedVersion ) {
+		MappedTriMesh source( dataSource );
+		clear();
+		initFromFormat( formatFromSource( source ) );
+		loadFromSource( source );
+	}
 	else {
-		throw Exception( "TriMesh::read() error: wrong version number. expected version = 1 or 2, version read: " + std::to_string( versionNumber ) );
+		throw Exception( "TriMesh::read() error: wrong version number. expected version = 1, 2 or 3, version read: " + std::to_string( versionNumber ) );
 	}
 }
 
@@ -515,6 +738,97 @@ void TriMesh::write( const DataTargetRef &dataTarget, uint32_t writeMask ) const
 	writeAttrib( toMask( geom::BITANGENT ), mBitangentsDims, mBitangents.size() * 3, mBitangents.data() );
 }
 
+void TriMesh::writeMapped( const DataTargetRef &dataTarget, bool compress ) const
+{
+	struct BlockSource {
+		uint32_t	mAttrib;
+		uint8_t		mDims;
+		const void	*mData;
+		size_t		mNumWords;
+	};
+
+	const size_t numVertices = getNumVertices();
+	vector<BlockSource> sources;
+	if( ! mIndices.empty() ) {
+		BlockSource indices = { kMappedIndicesBlock, 1, mIndices.data(), mIndices.size() };
+		sources.push_back( indices );
+	}
+
+	auto addAttrib = [&]( geom::Attrib attrib, uint8_t dims, size_t numFloats, const void *data ) {
+		if( ! dims || ! numFloats )
+			return;
+		if( numFloats != numVertices * dims )
+			throw Exception( "TriMesh::writeMapped() error: " + geom::attribToString( attrib ) + " doesn't have one element per vertex." );
+
+		BlockSource source = { toMask( attrib ), dims, data, numFloats };
+		sources.push_back( source );
+	};
+
+	addAttrib( geom::POSITION, mPositionsDims, mPositions.size(), mPositions.data() );
+	addAttrib( geom::COLOR, mColorsDims, mColors.size(), mColors.data() );
+	addAttrib( geom::NORMAL, mNormalsDims, mNormals.size() * 3, mNormals.data() );
+	addAttrib( geom::TEX_COORD_0, mTexCoords0Dims, mTexCoords0.size(), mTexCoords0.data() );
+	addAttrib( geom::TEX_COORD_1, mTexCoords1Dims, mTexCoords1.size(), mTexCoords1.data() );
+	addAttrib( geom::TEX_COORD_2, mTexCoords2Dims, mTexCoords2.size(), mTexCoords2.data() );
+	addAttrib( geom::TEX_COORD_3, mTexCoords3Dims, mTexCoords3.size(), mTexCoords3.data() );
+	addAttrib( geom::TANGENT, mTangentsDims, mTangents.size() * 3, mTangents.data() );
+	addAttrib( geom::BITANGENT, mBitangentsDims, mBitangents.size() * 3, mBitangents.data() );
+
+	vector<vector<uint8_t>> encoded( sources.size() );
+	if( compress ) {
+		parallelFor( sources.size(), [&]( size_t i ) {
+			const BlockSource &source = sources[i];
+			if( source.mAttrib == kMappedIndicesBlock )
+				encodeIndices( static_cast<const uint32_t *>( source.mData ), source.mNumWords, &encoded[i] );
+			else
+				encodeVertices( static_cast<const uint32_t *>( source.mData ), numVertices, source.mDims, &encoded[i] );
+		} );
+	}
+
+	// lay out the blocks after the header and block table; raw blocks start on a page boundary so that they can be used in place once mapped
+	vector<uint64_t> offsets, sizes;
+	uint64_t offset = kMappedHeaderBytes + sources.size() * kMappedBlockBytes;
+	for( size_t i = 0; i < sources.size(); i++ ) {
+		if( ! compress )
+			offset = ( offset + kMappedPageBytes - 1 ) / kMappedPageBytes * kMappedPageBytes;
+		offsets.push_back( offset );
+		sizes.push_back( compress ? encoded[i].size() : sources[i].mNumWords * sizeof( uint32_t ) );
+		offset += sizes.back();
+	}
+
+	OStreamRef out = dataTarget->getStream();
+	out->write( kMappedVersion );
+	out->write( uint8_t( 0 ) );
+	out->writeLittle( static_cast<uint16_t>( sources.size() ) );
+	out->writeLittle( static_cast<uint32_t>( numVertices ) );
+	out->writeLittle( static_cast<uint32_t>( mIndices.size() ) );
+	out->writeLittle( uint32_t( 0 ) );
+
+	for( size_t i = 0; i < sources.size(); i++ ) {
+		out->writeLittle( sources[i].mAttrib );
+		out->write( sources[i].mDims );
+		out->write( compress ? kMappedCodecCompressed : kMappedCodecRaw );
+		out->writeLittle( uint16_t( 0 ) );
+		// OStream has no 64 bit overloads, so these go out as their low and high words
+		out->writeLittle( uint32_t( offsets[i] ) );
+		out->writeLittle( uint32_t( offsets[i] >> 32 ) );
+		out->writeLittle( uint32_t( sizes[i] ) );
+		out->writeLittle( uint32_t( sizes[i] >> 32 ) );
+	}
+
+	const vector<uint8_t> padding( kMappedPageBytes, 0 );
+	uint64_t written = kMappedHeaderBytes + sources.size() * kMappedBlockBytes;
+	for( size_t i = 0; i < sources.size(); i++ ) {
+		if( offsets[i] > written )
+			out->writeData( padding.data(), size_t( offsets[i] - written ) );
+		if( compress )
+			out->writeData( encoded[i].data(), encoded[i].size() );
+		else
+			out->writeData( sources[i].mData, size_t( sizes[i] ) );
+		written = offsets[i] + sizes[i];
+	}
+}
+
 // used in 0.9.0
 void TriMesh::readImplV2( const IStreamRef &in )
 {
@@ -631,6 +945,261 @@ void TriMesh::readImplV1( const IStreamRef &in )
 	mTexCoords0Dims = 2;
 }
 
+namespace {
+
+// Vertices are processed in tasks of this many, which keeps the threading overhead negligible for small meshes.
+const size_t kVerticesPerTask = 16384;
+
+// A vertex's cell in the spatial hash. Sorting orders vertices by cell and then by index, so each cell's vertices are contiguous and ascending.
+struct VertexCell {
+	int32_t		mX, mY, mZ;
+	uint32_t	mIndex;
+
+	bool sameCell( const VertexCell &rhs ) const	{ return mX == rhs.mX && mY == rhs.mY && mZ == rhs.mZ; }
+
+	bool operator<( const VertexCell &rhs ) const
+	{
+		if( mX != rhs.mX )
+			return mX < rhs.mX;
+		if( mY != rhs.mY )
+			return mY < rhs.mY;
+		if( mZ != rhs.mZ )
+			return mZ < rhs.mZ;
+
+		return mIndex < rhs.mIndex;
+	}
+};
+
+size_t hashCell( int32_t x, int32_t y, int32_t z )
+{
+	return size_t( uint32_t( x ) * 73856093u ^ uint32_t( y ) * 19349663u ^ uint32_t( z ) * 83492791u );
+}
+
+// clamped one short of the int32_t range so that neighbouring cells can still be addressed
+int32_t toCell( float coord, double invCellSize )
+{
+	const double limit = double( numeric_limits<int32_t>::max() - 1 );
+	double cell = std::floor( coord * invCellSize );
+	return int32_t( std::max( -limit, std::min( cell, limit ) ) );
+}
+
+// Sorts equal chunks in parallel, then merges neighbouring runs pairwise (also in parallel) until a single run remains.
+template<typename T>
+void parallelSort( vector<T> *data )
+{
+	const size_t size = data->size();
+	const size_t numChunks = std::min<size_t>( std::max<size_t>( 1, std::thread::hardware_concurrency() ), size / kVerticesPerTask + 1 );
+	const size_t chunkSize = ( size + numChunks - 1 ) / numChunks;
+	auto first = data->begin();
+
+	parallelFor( numChunks, [&]( size_t chunk ) {
+		std::sort( first + std::min( chunk * chunkSize, size ), first + std::min( ( chunk + 1 ) * chunkSize, size ) );
+	} );
+
+	for( size_t width = chunkSize; width < size; width *= 2 ) {
+		parallelFor( ( size + width * 2 - 1 ) / ( width * 2 ), [&]( size_t merge ) {
+			size_t begin = merge * width * 2;
+			std::inplace_merge( first + begin, first + std::min( begin + width, size ), first + std::min( begin + width * 2, size ) );
+		} );
+	}
+}
+
+/* Resolves each vertex to its representative: the lowest-indexed earlier representative within epsilon for which equal( representative, vertex )
+   holds, or itself if there is none. Vertex cells and the nearest earlier match of every vertex are found in parallel. Only vertices whose
+   nearest match was itself merged into another representative, which needs chains of vertices spaced just under epsilon apart, have to be
+   searched again during the sequential pass. */
+template<typename EqualFn>
+vector<uint32_t> calcRepresentatives( const float *positions, uint8_t dims, size_t numVertices, float epsilon, const EqualFn &equal )
+{
+	vector<uint32_t> result( numVertices );
+	if( ! numVertices || ! dims )
+		return result;
+
+	const float epsilon2 = epsilon * epsilon;
+	const size_t numTasks = ( numVertices + kVerticesPerTask - 1 ) / kVerticesPerTask;
+
+	auto position = [=]( uint32_t index ) {
+		const float *p = &positions[index * dims];
+		return vec3( p[0], dims > 1 ? p[1] : 0, dims > 2 ? p[2] : 0 );
+	};
+
+	// an epsilon of zero only matches identical positions, which always share a cell regardless of its size, so the cells are sized to hold about one vertex each
+	double invCellSize = 1.0;
+	if( epsilon > 0 )
+		invCellSize = 1.0 / epsilon;
+	else {
+		vec3 minimum = position( 0 ), maximum = minimum;
+		for( uint32_t i = 1; i < numVertices; ++i ) {
+			minimum = glm::min( minimum, position( i ) );
+			maximum = glm::max( maximum, position( i ) );
+		}
+		const vec3 size = maximum - minimum;
+		const float extent = std::max( size.x, std::max( size.y, size.z ) );
+		if( extent > 0 )
+			invCellSize = std::cbrt( double( numVertices ) ) / extent;
+	}
+
+	vector<VertexCell> cells( numVertices );
+	parallelFor( numTasks, [&]( size_t task ) {
+		size_t end = std::min( ( task + 1 ) * kVerticesPerTask, numVertices );
+		for( size_t i = task * kVerticesPerTask; i < end; ++i ) {
+			vec3 p = position( uint32_t( i ) );
+			cells[i].mX = toCell( p.x, invCellSize );
+			cells[i].mY = toCell( p.y, invCellSize );
+			cells[i].mZ = toCell( p.z, invCellSize );
+			cells[i].mIndex = uint32_t( i );
+		}
+	} );
+
+	parallelSort( &cells );
+
+	vector<uint32_t> cellStarts;
+	for( size_t i = 0; i < numVertices; ++i ) {
+		if( i == 0 || ! cells[i].sameCell( cells[i - 1] ) )
+			cellStarts.push_back( uint32_t( i ) );
+	}
+	const size_t numCells = cellStarts.size();
+	cellStarts.push_back( uint32_t( numVertices ) );
+
+	// open addressing table of cell indices, kept at most half full
+	size_t tableMask = 1;
+	while( tableMask < numCells * 2 )
+		tableMask <<= 1;
+	tableMask -= 1;
+
+	const uint32_t emptySlot = numeric_limits<uint32_t>::max();
+	vector<uint32_t> table( tableMask + 1, emptySlot );
+	for( size_t c = 0; c < numCells; ++c ) {
+		const VertexCell &cell = cells[cellStarts[c]];
+		size_t slot = hashCell( cell.mX, cell.mY, cell.mZ ) & tableMask;
+		while( table[slot] != emptySlot )
+			slot = ( slot + 1 ) & tableMask;
+
+		table[slot] = uint32_t( c );
+	}
+
+	// returns the vertices of the (up to) 27 occupied cells surrounding cell, as [begin, end) ranges into cells
+	auto findNeighborhood = [&]( const VertexCell &cell, std::pair<uint32_t, uint32_t> *ranges ) {
+		size_t numRanges = 0;
+		for( int32_t dx = -1; dx <= 1; ++dx ) {
+			for( int32_t dy = -1; dy <= 1; ++dy ) {
+				for( int32_t dz = -1; dz <= 1; ++dz ) {
+					int32_t x = cell.mX + dx, y = cell.mY + dy, z = cell.mZ + dz;
+					for( size_t slot = hashCell( x, y, z ) & tableMask; table[slot] != emptySlot; slot = ( slot + 1 ) & tableMask ) {
+						uint32_t c = table[slot];
+						const VertexCell &candidate = cells[cellStarts[c]];
+						if( candidate.mX == x && candidate.mY == y && candidate.mZ == z ) {
+							ranges[numRanges++] = make_pair( cellStarts[c], cellStarts[c + 1] );
+							break;
+						}
+					}
+				}
+			}
+		}
+		return numRanges;
+	};
+
+	// the nearest match for each vertex is its lowest-indexed earlier vertex within epsilon, regardless of whether that one is a representative
+	vector<uint32_t> cellOf( numVertices );
+	const size_t numCellTasks = ( numCells + kVerticesPerTask - 1 ) / kVerticesPerTask;
+	parallelFor( numCellTasks, [&]( size_t task ) {
+		std::pair<uint32_t, uint32_t> ranges[27];
+		size_t end = std::min( ( task + 1 ) * kVerticesPerTask, numCells );
+		for( size_t c = task * kVerticesPerTask; c < end; ++c ) {
+			size_t numRanges = findNeighborhood( cells[cellStarts[c]], ranges );
+			for( uint32_t s = cellStarts[c]; s < cellStarts[c + 1]; ++s ) {
+				const uint32_t i = cells[s].mIndex;
+				const vec3 p = position( i );
+				uint32_t nearest = i;
+				for( size_t r = 0; r < numRanges; ++r ) {
+					for( uint32_t n = ranges[r].first; n < ranges[r].second && cells[n].mIndex < nearest; ++n ) {
+						uint32_t j = cells[n].mIndex;
+						if( distance2( position( j ), p ) <= epsilon2 && equal( j, i ) ) {
+							nearest = j;
+							break;
+						}
+					}
+				}
+
+				result[i] = nearest;
+				cellOf[i] = uint32_t( c );
+			}
+		}
+	} );
+
+	for( uint32_t i = 0; i < numVertices; ++i ) {
+		uint32_t nearest = result[i];
+		if( nearest == i || result[nearest] == nearest )
+			continue;
+
+		std::pair<uint32_t, uint32_t> ranges[27];
+		size_t numRanges = findNeighborhood( cells[cellStarts[cellOf[i]]], ranges );
+		const vec3 p = position( i );
+		uint32_t representative = i;
+		for( size_t r = 0; r < numRanges; ++r ) {
+			for( uint32_t n = ranges[r].first; n < ranges[r].second && cells[n].mIndex < representative; ++n ) {
+				uint32_t j = cells[n].mIndex;
+				if( result[j] == j && distance2( position( j ), p ) <= epsilon2 && equal( j, i ) ) {
+					representative = j;
+					break;
+				}
+			}
+		}
+
+		result[i] = representative;
+	}
+
+	return result;
+}
+
+template<typename T>
+void compactAttrib( vector<T> *data, size_t dims, const vector<uint32_t> &representatives, size_t numKept )
+{
+	if( data->size() < representatives.size() * dims )
+		return;
+
+	size_t kept = 0;
+	for( size_t i = 0; i < representatives.size(); ++i ) {
+		if( representatives[i] == i ) {
+			if( kept != i )
+				std::copy( data->begin() + i * dims, data->begin() + ( i + 1 ) * dims, data->begin() + kept * dims );
+			++kept;
+		}
+	}
+
+	data->resize( numKept * dims );
+}
+
+// moves the element at index i to remap[i]
+template<typename T>
+void remapAttrib( vector<T> *data, size_t dims, const vector<uint32_t> &remap )
+{
+	if( data->size() < remap.size() * dims )
+		return;
+
+	vector<T> result( data->size() );
+	for( size_t i = 0; i < remap.size(); ++i )
+		std::copy( data->begin() + i * dims, data->begin() + ( i + 1 ) * dims, result.begin() + remap[i] * dims );
+	data->swap( result );
+}
+
+template<typename T>
+bool attribEqual( const vector<T> &data, size_t dims, uint32_t indexA, uint32_t indexB )
+{
+	if( ! dims || data.size() < ( size_t( std::max( indexA, indexB ) ) + 1 ) * dims )
+		return true;
+
+	float dist2 = 0;
+	const float *a = reinterpret_cast<const float*>( &data[indexA * dims] );
+	const float *b = reinterpret_cast<const float*>( &data[indexB * dims] );
+	for( size_t d = 0; d < dims * sizeof( T ) / sizeof( float ); ++d )
+		dist2 += ( a[d] - b[d] ) * ( a[d] - b[d] );
+
+	return dist2 <= FLT_EPSILON;
+}
+
+} // anonymous namespace
+
 bool TriMesh::recalculateNormals( bool smooth, bool weighted )
 {
 	// requires valid indices and 3D vertices
@@ -642,30 +1211,17 @@ bool TriMesh::recalculateNormals( bool smooth, bool weighted )
 
 	// for smooth renormalization, we first find all unique vertices and keep track of them
 	std::vector<uint32_t> uniquePositions;
-	if( smooth ) {
-		uniquePositions.assign( numPositions, 0 );
-
-		for( uint32_t i = 0; i < numPositions; ++i ) {
-			if( uniquePositions[i] == 0 ) {
-				uniquePositions[i] = i + 1;
-				const vec3 &v0 = *(const vec3*)(&mPositions[i * 3]);
-				for( size_t j = i + 1; j < numPositions; ++j ) {
-					const vec3 &v1 = *(const vec3*)(&mPositions[j * 3]);
-					if( length2( v1 - v0 ) < FLT_EPSILON )
-						uniquePositions[j] = uniquePositions[i];
-				}
-			}
-		}
-	}
+	if( smooth )
+		uniquePositions = calcCoincidentVertices( math<float>::sqrt( FLT_EPSILON ) );
 
 	// perform surface normalization
 	uint32_t index0, index1, index2;
 	size_t numTriangles = getNumTriangles();
 	for( size_t i = 0; i < numTriangles; ++i ) {
 		if( smooth ) {
-			index0 = uniquePositions[mIndices[i * 3 + 0]] - 1;
-			index1 = uniquePositions[mIndices[i * 3 + 1]] - 1;
-			index2 = uniquePositions[mIndices[i * 3 + 2]] - 1;
+			index0 = uniquePositions[mIndices[i * 3 + 0]];
+			index1 = uniquePositions[mIndices[i * 3 + 1]];
+			index2 = uniquePositions[mIndices[i * 3 + 2]];
 		}
 		else {
 			index0 = mIndices[i*3+0];
@@ -707,7 +1263,7 @@ bool TriMesh::recalculateNormals( bool smooth, bool weighted )
 	// copy normals to corresponding non-unique vertices
 	if( smooth ) {
 		for( size_t i = 0; i < numPositions; ++i ) {
-			mNormals[i] = mNormals[uniquePositions[i]-1];
+			mNormals[i] = mNormals[uniquePositions[i]];
 		}
 	}
 
@@ -722,15 +1278,30 @@ bool TriMesh::recalculateTangents()
 	if( mTexCoords0.empty() || mTexCoords0Dims != 2 )
 		return false;
 
-	if( ! hasNormals() )
+	if( ! hasNormals() || mPositionsDims != 3 )
 		return false;
 
 	mTangents.clear();
 
+	const size_t numPositions = mPositions.size() / 3;
 	const vec3 *positions = reinterpret_cast<const vec3*>( mPositions.data() );
 	const vec3 *normals = reinterpret_cast<const vec3*>( mNormals.data() );
 	const vec2 *texCoords = reinterpret_cast<const vec2*>( mTexCoords0.data() );
-	geom::calculateTangents( mIndices.size(), mIndices.data(), mPositions.size() / 3, positions, normals, texCoords, &mTangents, nullptr );
+
+	// vertices that were only split by attributes which don't affect the tangent frame (colors, secondary texture coordinates) accumulate a shared tangent
+	auto sameFrame = [&]( uint32_t a, uint32_t b ) {
+		return distance2( normals[a], normals[b] ) <= FLT_EPSILON && distance2( texCoords[a], texCoords[b] ) <= FLT_EPSILON;
+	};
+	vector<uint32_t> representatives = calcRepresentatives( mPositions.data(), 3, numPositions, math<float>::sqrt( FLT_EPSILON ), sameFrame );
+
+	vector<uint32_t> indices( mIndices.size() );
+	for( size_t i = 0; i < mIndices.size(); ++i )
+		indices[i] = representatives[mIndices[i]];
+
+	geom::calculateTangents( indices.size(), indices.data(), numPositions, positions, normals, texCoords, &mTangents, nullptr );
+
+	for( size_t i = 0; i < numPositions; ++i )
+		mTangents[i] = mTangents[representatives[i]];
 
 	mTangentsDims = 3;
 
@@ -754,6 +1325,611 @@ bool TriMesh::recalculateBitangents()
 	return true;
 }
 
+std::vector<uint32_t> TriMesh::calcCoincidentVertices( float epsilon ) const
+{
+	return calcRepresentatives( mPositions.data(), mPositionsDims, getNumVertices(), epsilon, []( uint32_t, uint32_t ) { return true; } );
+}
+
+size_t TriMesh::weld( float epsilon )
+{
+	size_t numRemoved = compactVertices( calcCoincidentVertices( epsilon ) );
+	if( ! numRemoved )
+		return 0;
+
+	// drop the triangles that collapsed
+	size_t numIndices = 0;
+	for( size_t i = 0; i + 2 < mIndices.size(); i += 3 ) {
+		uint32_t index0 = mIndices[i], index1 = mIndices[i + 1], index2 = mIndices[i + 2];
+		if( index0 == index1 || index1 == index2 || index2 == index0 )
+			continue;
+
+		mIndices[numIndices++] = index0;
+		mIndices[numIndices++] = index1;
+		mIndices[numIndices++] = index2;
+	}
+
+	mIndices.resize( numIndices );
+	return numRemoved;
+}
+
+size_t TriMesh::removeDuplicateVertices()
+{
+	auto equal = [this]( uint32_t a, uint32_t b ) { return verticesEqual( a, b ); };
+	return compactVertices( calcRepresentatives( mPositions.data(), mPositionsDims, getNumVertices(), math<float>::sqrt( FLT_EPSILON ), equal ) );
+}
+
+size_t TriMesh::compactVertices( const std::vector<uint32_t> &representatives )
+{
+	const size_t numVertices = representatives.size();
+	vector<uint32_t> remap( numVertices );
+	size_t numKept = 0;
+	for( size_t i = 0; i < numVertices; ++i )
+		remap[i] = ( representatives[i] == i ) ? uint32_t( numKept++ ) : remap[representatives[i]];
+
+	if( numKept == numVertices )
+		return 0;
+
+	compactAttrib( &mPositions, mPositionsDims, representatives, numKept );
+	compactAttrib( &mColors, mColorsDims, representatives, numKept );
+	compactAttrib( &mNormals, 1, representatives, numKept );
+	compactAttrib( &mTangents, 1, representatives, numKept );
+	compactAttrib( &mBitangents, 1, representatives, numKept );
+	compactAttrib( &mTexCoords0, mTexCoords0Dims, representatives, numKept );
+	compactAttrib( &mTexCoords1, mTexCoords1Dims, representatives, numKept );
+	compactAttrib( &mTexCoords2, mTexCoords2Dims, representatives, numKept );
+	compactAttrib( &mTexCoords3, mTexCoords3Dims, representatives, numKept );
+
+	for( auto &index : mIndices ) {
+		if( index < numVertices )
+			index = remap[index];
+	}
+
+	return numVertices - numKept;
+}
+
+namespace {
+
+// Squared distances to a set of weighted planes (Garland & Heckbert), stored as the upper half of the symmetric 4x4 matrix
+struct Quadric {
+	Quadric()
+		: mA00( 0 ), mA11( 0 ), mA22( 0 ), mA01( 0 ), mA02( 0 ), mA12( 0 ), mB0( 0 ), mB1( 0 ), mB2( 0 ), mC( 0 ), mWeight( 0 )
+	{}
+
+	// the plane dot( normal, p ) + d = 0, where normal is unit length
+	Quadric( const vec3 &normal, float d, double weight )
+	{
+		const double x = normal.x, y = normal.y, z = normal.z;
+		mA00 = weight * x * x; mA11 = weight * y * y; mA22 = weight * z * z;
+		mA01 = weight * x * y; mA02 = weight * x * z; mA12 = weight * y * z;
+		mB0 = weight * x * d; mB1 = weight * y * d; mB2 = weight * z * d;
+		mC = weight * d * d;
+		mWeight = weight;
+	}
+
+	Quadric& operator+=( const Quadric &rhs )
+	{
+		mA00 += rhs.mA00; mA11 += rhs.mA11; mA22 += rhs.mA22;
+		mA01 += rhs.mA01; mA02 += rhs.mA02; mA12 += rhs.mA12;
+		mB0 += rhs.mB0; mB1 += rhs.mB1; mB2 += rhs.mB2;
+		mC += rhs.mC;
+		mWeight += rhs.mWeight;
+		return *this;
+	}
+
+	// returns the weighted mean of the squared distances from p to the planes
+	double error( const vec3 &p ) const
+	{
+		const double x = p.x, y = p.y, z = p.z;
+		double result = x * ( mA00 * x + 2 * ( mA01 * y + mA02 * z + mB0 ) )
+						+ y * ( mA11 * y + 2 * ( mA12 * z + mB1 ) )
+						+ z * ( mA22 * z + 2 * mB2 )
+						+ mC;
+		return mWeight > 0 ? std::max( 0.0, result / mWeight ) : std::max( 0.0, result );
+	}
+
+	double	mA00, mA11, mA22, mA01, mA02, mA12;
+	double	mB0, mB1, mB2;
+	double	mC;
+	double	mWeight;
+};
+
+// Manifold vertices can collapse onto any neighbor, border and seam vertices only along their border or seam, and locked vertices never
+enum VertexKind { KIND_MANIFOLD, KIND_BORDER, KIND_SEAM, KIND_LOCKED };
+
+// how much more the planes perpendicular to open borders count than the triangles, per unit of area
+const double kBorderWeight = 2.0;
+
+struct EdgeCollapse {
+	uint32_t	mFrom, mTo;
+	float		mError;
+
+	bool operator<( const EdgeCollapse &rhs ) const
+	{
+		if( mError != rhs.mError )
+			return mError < rhs.mError;
+		if( mFrom != rhs.mFrom )
+			return mFrom < rhs.mFrom;
+
+		return mTo < rhs.mTo;
+	}
+};
+
+// A connected part of a TriMesh being simplified. mIndices refer to mVertices, which holds indices into the TriMesh's vertices
+struct SimplifyComponent {
+	vector<uint32_t>	mVertices;
+	vector<uint32_t>	mIndices;
+};
+
+/* Simplifies a connected mesh in place until it has at most targetIndices indices, or no collapse under maxError2 remains. Each pass picks the
+   cheapest collapse for every edge, sorts them and performs as many as needed, skipping the ones touching a vertex that already changed during the
+   pass. Vertices are identified by their representative, the lowest-indexed vertex sharing their position; the vertices sharing a position
+   (its wedges) are linked in a ring. */
+void simplifyComponent( const vector<vec3> &positions, const vector<uint32_t> &representatives, vector<uint32_t> *indices, size_t targetIndices, double maxError2, bool parallel )
+{
+	const uint32_t numVertices = uint32_t( positions.size() );
+	vector<uint32_t> &idx = *indices;
+
+	auto forEachTask = [&]( size_t count, const std::function<void( size_t, size_t )> &fn ) {
+		const size_t numTasks = ( count + kVerticesPerTask - 1 ) / kVerticesPerTask;
+		parallelFor( numTasks, [&]( size_t task ) {
+			fn( task * kVerticesPerTask, std::min( ( task + 1 ) * kVerticesPerTask, count ) );
+		}, parallel ? 0 : 1 );
+	};
+
+	vector<uint32_t> wedgeNext( numVertices );
+	for( uint32_t v = 0; v < numVertices; ++v )
+		wedgeNext[v] = v;
+	for( uint32_t v = 0; v < numVertices; ++v ) {
+		const uint32_t r = representatives[v];
+		if( r != v ) {
+			wedgeNext[v] = wedgeNext[r];
+			wedgeNext[r] = v;
+		}
+	}
+
+	// the triangles around each vertex, rebuilt after every pass
+	vector<uint32_t> adjacencyOffsets, adjacency, adjacencyFill;
+	auto buildAdjacency = [&]() {
+		adjacencyOffsets.assign( numVertices + 1, 0 );
+		for( uint32_t index : idx )
+			++adjacencyOffsets[index + 1];
+		for( uint32_t v = 0; v < numVertices; ++v )
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+		adjacency.resize( idx.size() );
+		adjacencyFill.assign( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 );
+		for( size_t i = 0; i < idx.size(); ++i )
+			adjacency[adjacencyFill[idx[i]]++] = uint32_t( i / 3 );
+	};
+
+	// calls fn( triangle, corner ) for every triangle around position p, where corner is the one at p
+	auto forEachTriangleAround = [&]( uint32_t p, const std::function<void( uint32_t, uint32_t )> &fn ) {
+		uint32_t w = p;
+		do {
+			for( uint32_t a = adjacencyOffsets[w]; a < adjacencyOffsets[w + 1]; ++a ) {
+				const uint32_t t = adjacency[a];
+				for( uint32_t c = 0; c < 3; ++c ) {
+					if( idx[t * 3 + c] == w ) {
+						fn( t, c );
+						break;
+					}
+				}
+			}
+			w = wedgeNext[w];
+		} while( w != p );
+	};
+
+	// returns whether a triangle has the directed edge between positions 'from' and 'to'
+	auto hasEdge = [&]( uint32_t from, uint32_t to ) {
+		uint32_t w = from;
+		do {
+			for( uint32_t a = adjacencyOffsets[w]; a < adjacencyOffsets[w + 1]; ++a ) {
+				const uint32_t *tri = &idx[adjacency[a] * 3];
+				for( uint32_t c = 0; c < 3; ++c ) {
+					if( tri[c] == w && representatives[tri[( c + 1 ) % 3]] == to )
+						return true;
+				}
+			}
+			w = wedgeNext[w];
+		} while( w != from );
+		return false;
+	};
+
+	buildAdjacency();
+
+	// classify the positions
+	vector<uint8_t> kinds( numVertices, KIND_LOCKED );
+	forEachTask( numVertices, [&]( size_t begin, size_t end ) {
+		for( uint32_t p = uint32_t( begin ); p < end; ++p ) {
+			if( representatives[p] != p )
+				continue;
+
+			size_t numWedges = 0, numOpenOut = 0, numOpenIn = 0;
+			uint32_t w = p;
+			do {
+				if( adjacencyOffsets[w + 1] > adjacencyOffsets[w] )
+					++numWedges;
+				w = wedgeNext[w];
+			} while( w != p );
+			forEachTriangleAround( p, [&]( uint32_t t, uint32_t c ) {
+				if( ! hasEdge( representatives[idx[t * 3 + ( c + 1 ) % 3]], p ) )
+					++numOpenOut;
+				if( ! hasEdge( p, representatives[idx[t * 3 + ( c + 2 ) % 3]] ) )
+					++numOpenIn;
+			} );
+
+			if( numWedges && ! numOpenOut && ! numOpenIn )
+				kinds[p] = ( numWedges == 1 ) ? KIND_MANIFOLD : KIND_SEAM;
+			else if( numWedges == 1 && numOpenOut == 1 && numOpenIn == 1 )
+				kinds[p] = KIND_BORDER;
+		}
+	} );
+
+	// the quadrics of the triangles' planes, plus planes perpendicular to the open borders that keep them in place
+	vector<Quadric> quadrics( numVertices );
+	for( size_t t = 0; t < idx.size() / 3; ++t ) {
+		const uint32_t *tri = &idx[t * 3];
+		const vec3 &p0 = positions[tri[0]], &p1 = positions[tri[1]], &p2 = positions[tri[2]];
+		vec3 normal = cross( p1 - p0, p2 - p0 );
+		const float area2 = length( normal );
+		if( area2 <= 0 )
+			continue;
+
+		normal /= area2;
+		Quadric quadric( normal, -dot( normal, p0 ), area2 * 0.5 );
+		for( uint32_t c = 0; c < 3; ++c ) {
+			const uint32_t a = representatives[tri[c]], b = representatives[tri[( c + 1 ) % 3]];
+			quadrics[a] += quadric;
+			if( ! hasEdge( b, a ) ) {
+				const vec3 edge = positions[b] - positions[a];
+				vec3 borderNormal = cross( edge, normal );
+				const float borderLength = length( borderNormal );
+				if( borderLength > 0 ) {
+					borderNormal /= borderLength;
+					Quadric border( borderNormal, -dot( borderNormal, positions[a] ), dot( edge, edge ) * kBorderWeight );
+					quadrics[a] += border;
+					quadrics[b] += border;
+				}
+			}
+		}
+	}
+
+	auto canCollapse = [&]( uint32_t from, uint32_t to ) {
+		switch( kinds[from] ) {
+			case KIND_MANIFOLD:
+				return true;
+			case KIND_BORDER: // only along the open edge
+				return ( kinds[to] == KIND_BORDER || kinds[to] == KIND_LOCKED ) && ( hasEdge( from, to ) != hasEdge( to, from ) );
+			case KIND_SEAM: // whether the edge follows the seam is verified when collapsing
+				return kinds[to] == KIND_SEAM || kinds[to] == KIND_LOCKED;
+			default:
+				return false;
+		}
+	};
+
+	const uint32_t noVertex = numeric_limits<uint32_t>::max();
+	vector<EdgeCollapse> collapses;
+	vector<uint32_t> remap( numVertices );
+	vector<uint8_t> changed( numVertices );
+	vector<std::pair<uint32_t, uint32_t>> wedgeTargets;
+
+	/* Maps every wedge of 'from' onto the wedge of 'to' it shares its triangles with, rejecting the collapse if any wedge has none or several (for a
+	   seam, that means the edge doesn't follow it), or if it would flip a triangle. Returns the number of triangles removed, or 0 if rejected. */
+	auto tryCollapse = [&]( uint32_t from, uint32_t to ) -> size_t {
+		wedgeTargets.clear();
+		uint32_t w = from;
+		do {
+			if( adjacencyOffsets[w + 1] > adjacencyOffsets[w] ) {
+				uint32_t target = noVertex;
+				for( uint32_t a = adjacencyOffsets[w]; a < adjacencyOffsets[w + 1]; ++a ) {
+					const uint32_t *tri = &idx[adjacency[a] * 3];
+					for( uint32_t c = 0; c < 3; ++c ) {
+						if( representatives[tri[c]] == to ) {
+							if( target != noVertex && target != tri[c] )
+								return 0;
+							target = tri[c];
+						}
+					}
+				}
+				if( target == noVertex )
+					return 0;
+
+				wedgeTargets.push_back( make_pair( w, target ) );
+			}
+			w = wedgeNext[w];
+		} while( w != from );
+
+		size_t numRemoved = 0;
+		bool flipped = false;
+		forEachTriangleAround( from, [&]( uint32_t t, uint32_t c ) {
+			const uint32_t *tri = &idx[t * 3];
+			const uint32_t next = remap[tri[( c + 1 ) % 3]], prev = remap[tri[( c + 2 ) % 3]];
+			if( representatives[next] == to || representatives[prev] == to ) {
+				++numRemoved;
+				return;
+			}
+
+			const vec3 &pNext = positions[next], &pPrev = positions[prev];
+			const vec3 before = cross( pNext - positions[from], pPrev - positions[from] );
+			const vec3 after = cross( pNext - positions[to], pPrev - positions[to] );
+			if( dot( before, after ) <= 0.25f * length( before ) * length( after ) )
+				flipped = true;
+		} );
+
+		return flipped ? 0 : numRemoved;
+	};
+
+	size_t numTriangles = idx.size() / 3;
+	bool firstPass = true;
+	while( numTriangles * 3 > targetIndices ) {
+		if( ! firstPass )
+			buildAdjacency();
+		firstPass = false;
+
+		// the cheapest allowed direction of every edge; interior edges are seen from both of their triangles, so only one side adds them
+		collapses.resize( numTriangles * 3 );
+		forEachTask( numTriangles, [&]( size_t begin, size_t end ) {
+			for( size_t t = begin; t < end; ++t ) {
+				for( uint32_t c = 0; c < 3; ++c ) {
+					EdgeCollapse &collapse = collapses[t * 3 + c];
+					collapse.mFrom = noVertex;
+					const uint32_t a = representatives[idx[t * 3 + c]], b = representatives[idx[t * 3 + ( c + 1 ) % 3]];
+					if( a == b || ( a > b && hasEdge( b, a ) ) )
+						continue;
+
+					const double errorAB = canCollapse( a, b ) ? quadrics[a].error( positions[b] ) : numeric_limits<double>::max();
+					const double errorBA = canCollapse( b, a ) ? quadrics[b].error( positions[a] ) : numeric_limits<double>::max();
+					if( std::min( errorAB, errorBA ) > maxError2 )
+						continue;
+
+					collapse.mFrom = ( errorAB <= errorBA ) ? a : b;
+					collapse.mTo = ( errorAB <= errorBA ) ? b : a;
+					collapse.mError = float( std::min( errorAB, errorBA ) );
+				}
+			}
+		} );
+
+		collapses.erase( std::remove_if( collapses.begin(), collapses.end(), [=]( const EdgeCollapse &collapse ) { return collapse.mFrom == noVertex; } ), collapses.end() );
+		if( collapses.empty() )
+			break;
+		parallelSort( &collapses );
+
+		// limit the pass to about as many collapses as are needed, so the rest get to see the quadrics they update
+		const size_t trianglesToRemove = numTriangles - targetIndices / 3;
+		const EdgeCollapse &goal = collapses[std::min( collapses.size(), trianglesToRemove / 2 + 1 ) - 1];
+		double errorLimit = std::min( maxError2, double( goal.mError ) * 1.5 );
+
+		for( uint32_t v = 0; v < numVertices; ++v )
+			remap[v] = v;
+		std::fill( changed.begin(), changed.end(), 0 );
+		size_t numRemoved = 0, numCollapses = 0;
+		for( int sweep = 0; sweep < 2 && ! numCollapses; ++sweep ) {
+			// if nothing under the limit could be collapsed, try everything under maxError2 before giving up
+			if( sweep == 1 ) {
+				if( errorLimit >= maxError2 )
+					break;
+				errorLimit = maxError2;
+			}
+
+			for( const EdgeCollapse &collapse : collapses ) {
+				if( numRemoved >= trianglesToRemove || collapse.mError > errorLimit )
+					break;
+				if( changed[collapse.mFrom] || changed[collapse.mTo] )
+					continue;
+
+				size_t removed = tryCollapse( collapse.mFrom, collapse.mTo );
+				if( ! removed )
+					continue;
+
+				for( const auto &wedgeTarget : wedgeTargets )
+					remap[wedgeTarget.first] = wedgeTarget.second;
+				quadrics[collapse.mTo] += quadrics[collapse.mFrom];
+				changed[collapse.mFrom] = changed[collapse.mTo] = 1;
+				numRemoved += removed;
+				++numCollapses;
+			}
+		}
+
+		if( ! numCollapses )
+			break;
+
+		// apply the collapses and drop the triangles that became degenerate
+		size_t numIndices = 0;
+		for( size_t t = 0; t < numTriangles; ++t ) {
+			const uint32_t i0 = remap[idx[t * 3]], i1 = remap[idx[t * 3 + 1]], i2 = remap[idx[t * 3 + 2]];
+			const uint32_t p0 = representatives[i0], p1 = representatives[i1], p2 = representatives[i2];
+			if( p0 == p1 || p1 == p2 || p2 == p0 )
+				continue;
+
+			idx[numIndices++] = i0;
+			idx[numIndices++] = i1;
+			idx[numIndices++] = i2;
+		}
+		idx.resize( numIndices );
+		numTriangles = numIndices / 3;
+	}
+}
+
+} // anonymous namespace
+
+size_t TriMesh::removeUnusedVertices()
+{
+	const size_t numVertices = getNumVertices();
+	vector<uint32_t> kept( numVertices, numeric_limits<uint32_t>::max() );
+	for( uint32_t index : mIndices ) {
+		if( index < numVertices )
+			kept[index] = index;
+	}
+
+	vector<uint32_t> remap( numVertices );
+	size_t numKept = 0;
+	for( size_t i = 0; i < numVertices; ++i ) {
+		if( kept[i] == i )
+			remap[i] = uint32_t( numKept++ );
+	}
+
+	if( numKept == numVertices )
+		return 0;
+
+	compactAttrib( &mPositions, mPositionsDims, kept, numKept );
+	compactAttrib( &mColors, mColorsDims, kept, numKept );
+	compactAttrib( &mNormals, 1, kept, numKept );
+	compactAttrib( &mTangents, 1, kept, numKept );
+	compactAttrib( &mBitangents, 1, kept, numKept );
+	compactAttrib( &mTexCoords0, mTexCoords0Dims, kept, numKept );
+	compactAttrib( &mTexCoords1, mTexCoords1Dims, kept, numKept );
+	compactAttrib( &mTexCoords2, mTexCoords2Dims, kept, numKept );
+	compactAttrib( &mTexCoords3, mTexCoords3Dims, kept, numKept );
+
+	for( auto &index : mIndices ) {
+		if( index < numVertices )
+			index = remap[index];
+	}
+
+	return numVertices - numKept;
+}
+
+size_t TriMesh::simplify( float targetRatio, float maxError )
+{
+	const size_t numVertices = getNumVertices();
+	const size_t numTriangles = getNumTriangles();
+	if( mPositionsDims != 3 || ! numTriangles || targetRatio >= 1 )
+		return 0;
+
+	targetRatio = std::max( targetRatio, 0.0f );
+	const double maxError2 = double( maxError ) * double( maxError );
+	const vec3 *positions = getPositions<3>();
+
+	// vertices sharing a position are treated as a single vertex with several sets of attributes
+	vector<uint32_t> representatives = calcCoincidentVertices( 0 );
+
+	// connected components, found by merging the positions of every triangle
+	vector<uint32_t> parents( numVertices );
+	for( uint32_t i = 0; i < numVertices; ++i )
+		parents[i] = i;
+	auto findRoot = [&]( uint32_t i ) {
+		while( parents[i] != i )
+			i = parents[i] = parents[parents[i]];
+		return i;
+	};
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		uint32_t root0 = findRoot( representatives[mIndices[t * 3]] );
+		for( size_t c = 1; c < 3; ++c ) {
+			uint32_t root = findRoot( representatives[mIndices[t * 3 + c]] );
+			if( root != root0 )
+				parents[std::max( root, root0 )] = std::min( root, root0 );
+		}
+	}
+
+	// number the components, and lay out each component's vertices contiguously
+	const uint32_t noComponent = numeric_limits<uint32_t>::max();
+	vector<uint32_t> componentOfRoot( numVertices, noComponent ), componentOf( numVertices );
+	vector<SimplifyComponent> components;
+	for( uint32_t i = 0; i < numVertices; ++i ) {
+		uint32_t root = findRoot( representatives[i] );
+		if( componentOfRoot[root] == noComponent ) {
+			componentOfRoot[root] = uint32_t( components.size() );
+			components.push_back( SimplifyComponent() );
+		}
+		componentOf[i] = componentOfRoot[root];
+	}
+
+	vector<uint32_t> localIndices( numVertices );
+	for( uint32_t i = 0; i < numVertices; ++i ) {
+		SimplifyComponent &component = components[componentOf[i]];
+		localIndices[i] = uint32_t( component.mVertices.size() );
+		component.mVertices.push_back( i );
+	}
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		SimplifyComponent &component = components[componentOf[mIndices[t * 3]]];
+		for( size_t c = 0; c < 3; ++c )
+			component.mIndices.push_back( localIndices[mIndices[t * 3 + c]] );
+	}
+
+	// largest components first, as they're handed out to threads in order
+	vector<uint32_t> order;
+	for( uint32_t c = 0; c < components.size(); ++c ) {
+		if( ! components[c].mIndices.empty() )
+			order.push_back( c );
+	}
+	std::sort( order.begin(), order.end(), [&]( uint32_t a, uint32_t b ) { return components[a].mIndices.size() > components[b].mIndices.size(); } );
+
+	// a single large component is parallelized internally instead
+	const bool parallelComponents = order.size() > 1;
+	parallelFor( order.size(), [&]( size_t o ) {
+		SimplifyComponent &component = components[order[o]];
+		const size_t numLocalVertices = component.mVertices.size();
+		vector<vec3> localPositions( numLocalVertices );
+		vector<uint32_t> localRepresentatives( numLocalVertices );
+		for( size_t v = 0; v < numLocalVertices; ++v ) {
+			localPositions[v] = positions[component.mVertices[v]];
+			localRepresentatives[v] = localIndices[representatives[component.mVertices[v]]];
+		}
+
+		size_t targetTriangles = size_t( double( component.mIndices.size() / 3 ) * targetRatio + 0.5 );
+		simplifyComponent( localPositions, localRepresentatives, &component.mIndices, targetTriangles * 3, maxError2, ! parallelComponents );
+	}, parallelComponents ? 0 : 1 );
+
+	mIndices.clear();
+	for( uint32_t c : order ) {
+		for( uint32_t index : components[c].mIndices )
+			mIndices.push_back( components[c].mVertices[index] );
+	}
+
+	removeUnusedVertices();
+	return numTriangles - getNumTriangles();
+}
+
+std::vector<TriMesh> TriMesh::buildLodChain( size_t numLevels, float ratioPerLevel, float maxError ) const
+{
+	std::vector<TriMesh> result;
+	result.reserve( numLevels );
+	for( size_t level = 0; level < numLevels; ++level ) {
+		TriMesh lod = result.empty() ? *this : result.back();
+		if( ! lod.simplify( ratioPerLevel, maxError ) )
+			break;
+
+		result.push_back( std::move( lod ) );
+	}
+
+	return result;
+}
+
+float TriMesh::calcAcmr( size_t cacheSize ) const
+{
+	return geom::calcAcmr( mIndices.size(), mIndices.data(), getNumVertices(), cacheSize );
+}
+
+float TriMesh::optimizeVertexCache( size_t cacheSize )
+{
+	geom::optimizeVertexCache( mIndices.size(), mIndices.data(), getNumVertices(), cacheSize );
+	return calcAcmr( cacheSize );
+}
+
+float TriMesh::optimizeOverdraw( float threshold, size_t cacheSize )
+{
+	if( mPositionsDims == 3 )
+		geom::optimizeOverdraw( mIndices.size(), mIndices.data(), getNumVertices(), getPositions<3>(), cacheSize, threshold );
+
+	return calcAcmr( cacheSize );
+}
+
+void TriMesh::optimizeVertexFetch()
+{
+	vector<uint32_t> remap;
+	geom::optimizeVertexFetch( mIndices.size(), mIndices.data(), getNumVertices(), &remap );
+
+	remapAttrib( &mPositions, mPositionsDims, remap );
+	remapAttrib( &mColors, mColorsDims, remap );
+	remapAttrib( &mNormals, 1, remap );
+	remapAttrib( &mTangents, 1, remap );
+	remapAttrib( &mBitangents, 1, remap );
+	remapAttrib( &mTexCoords0, mTexCoords0Dims, remap );
+	remapAttrib( &mTexCoords1, mTexCoords1Dims, remap );
+	remapAttrib( &mTexCoords2, mTexCoords2Dims, remap );
+	remapAttrib( &mTexCoords3, mTexCoords3Dims, remap );
+}
+
 //! TODO: optimize memory allocations
 void TriMesh::subdivide( int division, bool normalize )
 {
@@ -1104,135 +2280,17 @@ bool TriMesh::verticesEqual( uint32_t indexA, uint32_t indexB ) const
 	if( indexA >= numPositions || indexB >= numPositions )
 		return false;
 
-	// positions
-	const vec3 &a = *reinterpret_cast<const vec3*>(&mPositions[indexA*mPositionsDims]);
-	const vec3 &b = *reinterpret_cast<const vec3*>(&mPositions[indexB*mPositionsDims]);
-	if( distance2( a, b ) > FLT_EPSILON )
-		return false;
-
-	if( mColorsDims > 0 ) {
-		if( mColorsDims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mColors[indexA*mColorsDims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mColors[indexB*mColorsDims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mColorsDims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mColors[indexA*mColorsDims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mColors[indexB*mColorsDims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mNormalsDims > 0 ) {
-		const vec3 &a = *reinterpret_cast<const vec3*>(&mNormals[indexA*mNormalsDims]);
-		const vec3 &b = *reinterpret_cast<const vec3*>(&mNormals[indexB*mNormalsDims]);
-		if( distance2( a, b ) > FLT_EPSILON )
-		return false;
-	}
-
-	if( mTexCoords0Dims > 0 ) {
-		if( mTexCoords0Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords0[indexA*mTexCoords0Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords0[indexB*mTexCoords0Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords0Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords0[indexA*mTexCoords0Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords0[indexB*mTexCoords0Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords0Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords0[indexA*mTexCoords0Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords0[indexB*mTexCoords0Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mTexCoords1Dims > 0 ) {
-		if( mTexCoords1Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords1[indexA*mTexCoords1Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords1[indexB*mTexCoords1Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords1Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords1[indexA*mTexCoords1Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords1[indexB*mTexCoords1Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords1Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords1[indexA*mTexCoords1Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords1[indexB*mTexCoords1Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mTexCoords2Dims > 0 ) {
-		if( mTexCoords2Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords2[indexA*mTexCoords2Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords2[indexB*mTexCoords2Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords2Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords2[indexA*mTexCoords2Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords2[indexB*mTexCoords2Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords2Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords2[indexA*mTexCoords2Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords2[indexB*mTexCoords2Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mTexCoords3Dims > 0 ) {
-		if( mTexCoords3Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords3[indexA*mTexCoords3Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords3[indexB*mTexCoords3Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords3Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords3[indexA*mTexCoords3Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords3[indexB*mTexCoords3Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords3Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords3[indexA*mTexCoords3Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords3[indexB*mTexCoords3Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mTangentsDims > 0 ) {
-		const vec3 &a = *reinterpret_cast<const vec3*>(&mTangents[indexA*mTangentsDims]);
-		const vec3 &b = *reinterpret_cast<const vec3*>(&mTangents[indexB*mTangentsDims]);
-		if( distance2( a, b ) > FLT_EPSILON )
-		return false;
-	}
-
-	if( mBitangentsDims > 0 ) {
-		const vec3 &a = *reinterpret_cast<const vec3*>(&mBitangents[indexA*mBitangentsDims]);
-		const vec3 &b = *reinterpret_cast<const vec3*>(&mBitangents[indexB*mBitangentsDims]);
-		if( distance2( a, b ) > FLT_EPSILON )
-		return false;
-	}
-
+	// normals, tangents and bitangents are stored as vec3, hence one element per vertex
 	// TODO: bone index and weight
-
-	return true;
+	return attribEqual( mPositions, mPositionsDims, indexA, indexB )
+		&& attribEqual( mColors, mColorsDims, indexA, indexB )
+		&& attribEqual( mNormals, mNormalsDims ? 1 : 0, indexA, indexB )
+		&& attribEqual( mTangents, mTangentsDims ? 1 : 0, indexA, indexB )
+		&& attribEqual( mBitangents, mBitangentsDims ? 1 : 0, indexA, indexB )
+		&& attribEqual( mTexCoords0, mTexCoords0Dims, indexA, indexB )
+		&& attribEqual( mTexCoords1, mTexCoords1Dims, indexA, indexB )
+		&& attribEqual( mTexCoords2, mTexCoords2Dims, indexA, indexB )
+		&& attribEqual( mTexCoords3, mTexCoords3Dims, indexA, indexB );
 }
 
 uint32_t TriMesh::toMask( geom::Attrib attrib )
@@ -1291,4 +2349,148 @@ geom::Attrib TriMesh::fromMask( uint32_t attrib )
 	}
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// MappedTriMesh
+MappedTriMesh::MappedTriMesh( const fs::path &filePath )
+	: mMappedFile( MappedFile::create( filePath ) )
+{
+	init( static_cast<const uint8_t *>( mMappedFile->getData() ), mMappedFile->getSize() );
+}
+
+MappedTriMesh::MappedTriMesh( const DataSourceRef &dataSource )
+{
+	if( dataSource->isFilePath() ) {
+		try {
+			mMappedFile = MappedFile::create( dataSource->getFilePath() );
+		}
+		catch( MappedFileExc & ) {
+			// not a regular file (e.g. a packaged asset); fall back to the DataSource's Buffer below
+		}
+	}
+
+	if( mMappedFile )
+		init( static_cast<const uint8_t *>( mMappedFile->getData() ), mMappedFile->getSize() );
+	else {
+		mBuffer = dataSource->getBuffer();
+		init( static_cast<const uint8_t *>( mBuffer->getData() ), mBuffer->getSize() );
+	}
+}
+
+void MappedTriMesh::init( const uint8_t *data, size_t size )
+{
+	mIndices = nullptr;
+	for( int i = 0; i < geom::NUM_ATTRIBS; i++ ) {
+		mAttribData[i] = nullptr;
+		mAttribDims[i] = 0;
+	}
+
+	if( size < kMappedHeaderBytes || data[0] != kMappedVersion )
+		throw Exception( "MappedTriMesh error: not a version 3 TriMesh file." );
+
+	const size_t numBlocks = readMapped<uint16_t>( data + 2 );
+	mNumVertices = readMapped<uint32_t>( data + 4 );
+	mNumIndices = readMapped<uint32_t>( data + 8 );
+	if( size < kMappedHeaderBytes + numBlocks * kMappedBlockBytes )
+		throw Exception( "MappedTriMesh error: truncated block table." );
+
+	// validate the block table first, so that the storage for compressed blocks can be allocated in one go
+	vector<MappedBlock> blocks( numBlocks );
+	size_t decodedWords = 0;
+	for( size_t i = 0; i < numBlocks; i++ ) {
+		const uint8_t *entry = data + kMappedHeaderBytes + i * kMappedBlockBytes;
+		MappedBlock &block = blocks[i];
+		block.mAttrib = readMapped<uint32_t>( entry );
+		block.mDims = entry[4];
+		block.mCodec = entry[5];
+		block.mOffset = readMapped<uint64_t>( entry + 8 );
+		block.mSize = readMapped<uint64_t>( entry + 16 );
+
+		const bool isIndices = block.mAttrib == kMappedIndicesBlock;
+		if( isIndices ? block.mDims != 1 : ( block.mDims < 1 || block.mDims > 4 ) )
+			throw Exception( "MappedTriMesh error: invalid block dimensions." );
+		if( block.mOffset > size || block.mSize > size - block.mOffset )
+			throw Exception( "MappedTriMesh error: block extends past the end of the file." );
+
+		const uint64_t numWords = isIndices ? mNumIndices : uint64_t( mNumVertices ) * block.mDims;
+		if( block.mCodec == kMappedCodecRaw ) {
+			if( block.mSize != numWords * sizeof( uint32_t ) || block.mOffset % sizeof( uint32_t ) != 0 )
+				throw Exception( "MappedTriMesh error: invalid block size." );
+		}
+		else if( block.mCodec == kMappedCodecCompressed ) {
+			// every index takes at least a byte and every byte plane at least its group headers, which bounds what a corrupt header can make us allocate
+			const uint64_t minSize = isIndices ? numWords : block.mDims * 4 * ( ( mNumVertices + kGroupSize * 4 - 1 ) / ( kGroupSize * 4 ) );
+			if( block.mSize < minSize )
+				throw Exception( "MappedTriMesh error: invalid block size." );
+			decodedWords += size_t( numWords );
+		}
+		else
+			throw Exception( "MappedTriMesh error: unknown codec." );
+	}
+
+	// raw blocks are used in place, compressed ones point into mDecoded and are decoded in parallel
+	vector<pair<const MappedBlock *, uint32_t *>> compressed;
+	if( decodedWords )
+		mDecoded = make_shared<vector<uint32_t>>( decodedWords );
+	decodedWords = 0;
+	for( const auto &block : blocks ) {
+		const bool isIndices = block.mAttrib == kMappedIndicesBlock;
+		const void *blockData = data + block.mOffset;
+		if( block.mCodec == kMappedCodecCompressed ) {
+			uint32_t *decoded = mDecoded->data() + decodedWords;
+			compressed.push_back( make_pair( &block, decoded ) );
+			decodedWords += isIndices ? mNumIndices : mNumVertices * block.mDims;
+			blockData = decoded;
+		}
+
+		if( isIndices )
+			mIndices = static_cast<const uint32_t *>( blockData );
+		else {
+			geom::Attrib attrib = TriMesh::fromMask( block.mAttrib );
+			mAttribData[attrib] = static_cast<const float *>( blockData );
+			mAttribDims[attrib] = block.mDims;
+		}
+	}
+
+	const size_t numVertices = mNumVertices, numIndices = mNumIndices;
+	parallelFor( compressed.size(), [&]( size_t i ) {
+		const MappedBlock &block = *compressed[i].first;
+		bool success;
+		if( block.mAttrib == kMappedIndicesBlock )
+			success = decodeIndices( data + block.mOffset, size_t( block.mSize ), numIndices, compressed[i].second );
+		else
+			success = decodeVertices( data + block.mOffset, size_t( block.mSize ), numVertices, block.mDims, compressed[i].second );
+
+		if( ! success )
+			throw Exception( "MappedTriMesh error: corrupt compressed block." );
+	} );
+}
+
+uint8_t MappedTriMesh::getAttribDims( geom::Attrib attr ) const
+{
+	return attr < geom::NUM_ATTRIBS ? mAttribDims[attr] : 0;
+}
+
+geom::AttribSet MappedTriMesh::getAvailableAttribs() const
+{
+	geom::AttribSet result;
+	for( int i = 0; i < geom::NUM_ATTRIBS; i++ ) {
+		if( mAttribData[i] )
+			result.insert( (geom::Attrib)i );
+	}
+
+	return result;
+}
+
+void MappedTriMesh::loadInto( geom::Target *target, const geom::AttribSet &requestedAttribs ) const
+{
+	// the target copies straight out of the mapping (or decoded storage); nothing is staged here
+	for( auto &attrib : requestedAttribs ) {
+		if( getAttribData( attrib ) )
+			target->copyAttrib( attrib, mAttribDims[attrib], 0, mAttribData[attrib], mNumVertices );
+	}
+
+	if( mIndices )
+		target->copyIndices( geom::Primitive::TRIANGLES, mIndices, mNumIndices, 4 /* bytes per index */ );
+}
+
 } // namespace cinder
@@ -0,0 +1,887 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TriMeshBvh.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// ranges of triangles larger than this are split with parallel passes, and smaller ones are built as independent subtrees in parallel
+const size_t kSubtreeTriangles = 65536;
+const size_t kTrianglesPerTask = 16384;
+// the cost of traversing a node relative to intersecting a triangle
+const float kTraversalCost = 1.0f;
+// the number of rays traversing the hierarchy together
+const size_t kPacketSize = 8;
+// subtrees are held in a fixed size stack up to this depth
+const size_t kLocalStackSize = 64;
+
+float calcHalfArea( const vec3 &min, const vec3 &max )
+{
+	const vec3 size = max - min;
+	if( size.x < 0 || size.y < 0 || size.z < 0 )
+		return 0;
+
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// The bounds of the triangles whose centroids fall in one bin
+struct BvhBin {
+	BvhBin()
+		: mMin( numeric_limits<float>::max() ), mMax( -numeric_limits<float>::max() ), mCount( 0 )
+	{}
+
+	void include( const vec3 &min, const vec3 &max )
+	{
+		mMin = glm::min( mMin, min );
+		mMax = glm::max( mMax, max );
+		++mCount;
+	}
+
+	void include( const BvhBin &rhs )
+	{
+		mMin = glm::min( mMin, rhs.mMin );
+		mMax = glm::max( mMax, rhs.mMax );
+		mCount += rhs.mCount;
+	}
+
+	vec3		mMin, mMax;
+	uint32_t	mCount;
+};
+
+// The bounds of a range of triangles and of their centroids
+struct BvhBounds {
+	BvhBounds()
+		: mMin( numeric_limits<float>::max() ), mMax( -numeric_limits<float>::max() ), mCentroidMin( mMin ), mCentroidMax( mMax ), mCount( 0 )
+	{}
+
+	void include( const vec3 &min, const vec3 &max, const vec3 &centroid )
+	{
+		mMin = glm::min( mMin, min );
+		mMax = glm::max( mMax, max );
+		mCentroidMin = glm::min( mCentroidMin, centroid );
+		mCentroidMax = glm::max( mCentroidMax, centroid );
+		++mCount;
+	}
+
+	void include( const BvhBounds &rhs )
+	{
+		mMin = glm::min( mMin, rhs.mMin );
+		mMax = glm::max( mMax, rhs.mMax );
+		mCentroidMin = glm::min( mCentroidMin, rhs.mCentroidMin );
+		mCentroidMax = glm::max( mCentroidMax, rhs.mCentroidMax );
+		mCount += rhs.mCount;
+	}
+
+	vec3		mMin, mMax, mCentroidMin, mCentroidMax;
+	uint32_t	mCount;
+};
+
+// A triangle's bounds and index, which are partitioned together so that passes over a range of triangles read memory in order
+struct BvhPrimitive {
+	vec3		mMin;
+	uint32_t	mTriangle;
+	vec3		mMax;
+
+	float	getCentroid( size_t axis ) const	{ return ( mMin[axis] + mMax[axis] ) * 0.5f; }
+	vec3	getCentroid() const					{ return ( mMin + mMax ) * 0.5f; }
+};
+
+// Splits ranges of the triangles into subtrees. Triangles are partitioned in place, so every subtree refers to a contiguous range of them
+class BvhBuilder {
+  public:
+	typedef TriMeshBvh::Node Node;
+
+	// Storage reused across calls to split(), one per thread
+	struct Scratch {
+		vector<BvhBin>		mBins;
+		vector<float>		mRightCosts;
+	};
+
+	BvhBuilder( const TriMesh &mesh, const TriMeshBvh::Format &format )
+		: mNumBins( std::max<size_t>( format.getNumBins(), 2 ) ),
+			mMaxLeafTriangles( std::min<size_t>( std::max<size_t>( format.getMaxLeafTriangles(), 1 ), 255 ) )
+	{
+		const size_t numTriangles = mesh.getNumTriangles();
+		mPrimitives.resize( numTriangles );
+		const vec3 *positions = mesh.getPositions<3>();
+		const uint32_t *indices = mesh.getIndices().data();
+		forEachTask( 0, uint32_t( numTriangles ), true, [&]( uint32_t begin, uint32_t end ) {
+			for( uint32_t t = begin; t < end; ++t ) {
+				const vec3 &a = positions[indices[t * 3]], &b = positions[indices[t * 3 + 1]], &c = positions[indices[t * 3 + 2]];
+				mPrimitives[t].mMin = glm::min( a, glm::min( b, c ) );
+				mPrimitives[t].mMax = glm::max( a, glm::max( b, c ) );
+				mPrimitives[t].mTriangle = t;
+			}
+		} );
+	}
+
+	// Copies the triangle indices, in their partitioned order, to *result
+	void copyTriangles( vector<uint32_t> *result ) const
+	{
+		result->resize( mPrimitives.size() );
+		forEachTask( 0, uint32_t( mPrimitives.size() ), true, [&]( uint32_t begin, uint32_t end ) {
+			for( uint32_t i = begin; i < end; ++i )
+				(*result)[i] = mPrimitives[i].mTriangle;
+		} );
+	}
+
+	// Returns the bounds of the triangles in [begin, end)
+	BvhBounds calcBounds( uint32_t begin, uint32_t end, bool parallel ) const
+	{
+		vector<BvhBounds> taskBounds( parallel ? ( end - begin + kTrianglesPerTask - 1 ) / kTrianglesPerTask : 1 );
+		forEachTask( begin, end, parallel, [&]( uint32_t taskBegin, uint32_t taskEnd ) {
+			BvhBounds &bounds = taskBounds[( taskBegin - begin ) / kTrianglesPerTask];
+			for( uint32_t i = taskBegin; i < taskEnd; ++i )
+				bounds.include( mPrimitives[i].mMin, mPrimitives[i].mMax, mPrimitives[i].getCentroid() );
+		} );
+
+		for( size_t i = 1; i < taskBounds.size(); ++i )
+			taskBounds[0].include( taskBounds[i] );
+		return taskBounds[0];
+	}
+
+	/* Decides whether the triangles in [begin, end), with \a bounds, should be split. If so, partitions them and returns true with the partition
+	   point in *mid, the axis in *axis and the bounds of both halves. */
+	bool split( uint32_t begin, uint32_t end, const BvhBounds &bounds, bool parallel, Scratch *scratch, uint32_t *mid, uint16_t *axis, BvhBounds *firstBounds, BvhBounds *secondBounds )
+	{
+		const uint32_t count = end - begin;
+		if( count <= 1 )
+			return false;
+
+		// the cheapest split between bins along any axis, by the surface area heuristic
+		calcBins( begin, end, bounds, parallel, &scratch->mBins );
+		scratch->mRightCosts.resize( mNumBins );
+		float bestCost = numeric_limits<float>::max();
+		size_t bestAxis = 0, bestBin = 0;
+		for( size_t a = 0; a < 3; ++a ) {
+			const BvhBin *axisBins = &scratch->mBins[a * mNumBins];
+			BvhBin right;
+			for( size_t b = mNumBins - 1; b > 0; --b ) {
+				right.include( axisBins[b] );
+				scratch->mRightCosts[b] = right.mCount * calcHalfArea( right.mMin, right.mMax );
+			}
+
+			BvhBin left;
+			for( size_t b = 0; b + 1 < mNumBins; ++b ) {
+				left.include( axisBins[b] );
+				if( ! left.mCount || left.mCount == count )
+					continue;
+
+				const float cost = left.mCount * calcHalfArea( left.mMin, left.mMax ) + scratch->mRightCosts[b + 1];
+				if( cost < bestCost ) {
+					bestCost = cost;
+					bestAxis = a;
+					bestBin = b;
+				}
+			}
+		}
+
+		const float nodeArea = calcHalfArea( bounds.mMin, bounds.mMax );
+		if( count <= mMaxLeafTriangles && ( bestCost == numeric_limits<float>::max() || count * nodeArea <= kTraversalCost * nodeArea + bestCost ) )
+			return false;
+
+		*axis = uint16_t( bestAxis );
+		if( bestCost == numeric_limits<float>::max() ) {
+			// all the centroids fall in a single bin, so split the range in half
+			*mid = begin + count / 2;
+			*firstBounds = calcBounds( begin, *mid, parallel );
+			*secondBounds = calcBounds( *mid, end, parallel );
+			return true;
+		}
+
+		BvhBin first, second;
+		for( size_t b = 0; b < mNumBins; ++b )
+			( b <= bestBin ? first : second ).include( scratch->mBins[bestAxis * mNumBins + b] );
+
+		// partition the triangles by bin, gathering the centroid bounds of both halves along the way
+		*firstBounds = *secondBounds = BvhBounds();
+		const float scale = calcBinScale( bounds, bestAxis );
+		const float origin = bounds.mCentroidMin[bestAxis];
+		uint32_t i = begin, j = end;
+		while( true ) {
+			while( i < j && calcBin( mPrimitives[i].getCentroid( bestAxis ), origin, scale ) <= bestBin )
+				includeCentroid( mPrimitives[i++], firstBounds );
+			while( i < j && calcBin( mPrimitives[j - 1].getCentroid( bestAxis ), origin, scale ) > bestBin )
+				includeCentroid( mPrimitives[--j], secondBounds );
+			if( i >= j )
+				break;
+			std::swap( mPrimitives[i], mPrimitives[j - 1] );
+		}
+
+		*mid = i;
+		firstBounds->mMin = first.mMin;
+		firstBounds->mMax = first.mMax;
+		firstBounds->mCount = first.mCount;
+		secondBounds->mMin = second.mMin;
+		secondBounds->mMax = second.mMax;
+		secondBounds->mCount = second.mCount;
+		return true;
+	}
+
+	// Builds the subtree for the triangles in [begin, end) depth-first into *nodes, with indices relative to the subtree's root
+	void buildSubtree( uint32_t begin, uint32_t end, const BvhBounds &bounds, vector<Node> *nodes )
+	{
+		struct Range {
+			uint32_t	mBegin, mEnd, mParent;
+			BvhBounds	mBounds;
+		};
+
+		const uint32_t noParent = numeric_limits<uint32_t>::max();
+		Scratch scratch;
+		vector<Range> stack;
+		Range root = { begin, end, noParent, bounds };
+		stack.push_back( root );
+		while( ! stack.empty() ) {
+			const Range range = stack.back();
+			stack.pop_back();
+
+			const uint32_t index = uint32_t( nodes->size() );
+			if( range.mParent != noParent )
+				(*nodes)[range.mParent].mOffset = index;
+
+			Node node;
+			node.mMin = range.mBounds.mMin;
+			node.mMax = range.mBounds.mMax;
+			node.mAxis = 0;
+			uint32_t mid;
+			Range first, second;
+			if( split( range.mBegin, range.mEnd, range.mBounds, false, &scratch, &mid, &node.mAxis, &first.mBounds, &second.mBounds ) ) {
+				node.mCount = 0;
+				// the first child is processed next, so it directly follows its parent
+				first.mBegin = range.mBegin;
+				first.mEnd = second.mBegin = mid;
+				second.mEnd = range.mEnd;
+				first.mParent = noParent;
+				second.mParent = index;
+				stack.push_back( second );
+				stack.push_back( first );
+			}
+			else {
+				node.mOffset = range.mBegin;
+				node.mCount = uint16_t( range.mEnd - range.mBegin );
+			}
+			nodes->push_back( node );
+		}
+	}
+
+	// calls fn( begin, end ) for chunks of [begin, end), across threads if parallel
+	template<typename Fn>
+	static void forEachTask( uint32_t begin, uint32_t end, bool parallel, const Fn &fn )
+	{
+		if( ! parallel || end - begin <= kTrianglesPerTask ) {
+			fn( begin, end );
+			return;
+		}
+
+		const size_t numTasks = ( end - begin + kTrianglesPerTask - 1 ) / kTrianglesPerTask;
+		parallelFor( numTasks, [&]( size_t task ) {
+			fn( uint32_t( begin + task * kTrianglesPerTask ), uint32_t( std::min<size_t>( begin + ( task + 1 ) * kTrianglesPerTask, end ) ) );
+		} );
+	}
+
+  private:
+	// fills *result with mNumBins bins along each axis, one axis after another
+	void calcBins( uint32_t begin, uint32_t end, const BvhBounds &bounds, bool parallel, vector<BvhBin> *result ) const
+	{
+		const float scales[3] = { calcBinScale( bounds, 0 ), calcBinScale( bounds, 1 ), calcBinScale( bounds, 2 ) };
+		const size_t numTasks = ( parallel && end - begin > kTrianglesPerTask ) ? ( end - begin + kTrianglesPerTask - 1 ) / kTrianglesPerTask : 1;
+		result->assign( numTasks * mNumBins * 3, BvhBin() );
+		forEachTask( begin, end, parallel, [&]( uint32_t taskBegin, uint32_t taskEnd ) {
+			BvhBin *taskBins = &(*result)[( taskBegin - begin ) / kTrianglesPerTask * mNumBins * 3];
+			for( uint32_t i = taskBegin; i < taskEnd; ++i ) {
+				const BvhPrimitive &primitive = mPrimitives[i];
+				for( size_t axis = 0; axis < 3; ++axis )
+					taskBins[axis * mNumBins + calcBin( primitive.getCentroid( axis ), bounds.mCentroidMin[axis], scales[axis] )].include( primitive.mMin, primitive.mMax );
+			}
+		} );
+
+		for( size_t task = 1; task < numTasks; ++task ) {
+			for( size_t b = 0; b < mNumBins * 3; ++b )
+				(*result)[b].include( (*result)[task * mNumBins * 3 + b] );
+		}
+		result->resize( mNumBins * 3 );
+	}
+
+	static void includeCentroid( const BvhPrimitive &primitive, BvhBounds *bounds )
+	{
+		const vec3 centroid = primitive.getCentroid();
+		bounds->mCentroidMin = glm::min( bounds->mCentroidMin, centroid );
+		bounds->mCentroidMax = glm::max( bounds->mCentroidMax, centroid );
+	}
+
+	float calcBinScale( const BvhBounds &bounds, size_t axis ) const
+	{
+		const float extent = bounds.mCentroidMax[axis] - bounds.mCentroidMin[axis];
+		return extent > 0 ? float( mNumBins ) * ( 1 - 1e-5f ) / extent : 0;
+	}
+
+	size_t calcBin( float centroid, float origin, float scale ) const
+	{
+		return std::min( size_t( std::max( ( centroid - origin ) * scale, 0.0f ) ), mNumBins - 1 );
+	}
+
+	vector<BvhPrimitive>	mPrimitives;
+	size_t					mNumBins, mMaxLeafTriangles;
+};
+
+// A stack of nodes to visit, which only allocates for unusually deep hierarchies
+template<typename T>
+class NodeStack {
+  public:
+	explicit NodeStack( size_t depth )
+		: mData( mLocal ), mSize( 0 )
+	{
+		if( depth > kLocalStackSize ) {
+			mHeap.resize( depth );
+			mData = mHeap.data();
+		}
+	}
+
+	bool		empty() const { return mSize == 0; }
+	void		push( const T &node ) { mData[mSize++] = node; }
+	T			pop() { return mData[--mSize]; }
+
+  private:
+	T			mLocal[kLocalStackSize];
+	vector<T>	mHeap;
+	T			*mData;
+	size_t		mSize;
+};
+
+// A node to be visited by a packet of rays, and the first of its rays that may hit it
+struct PacketEntry {
+	PacketEntry() {}
+	PacketEntry( uint32_t node, uint32_t firstRay )
+		: mNode( node ), mFirstRay( firstRay )
+	{}
+
+	uint32_t	mNode, mFirstRay;
+};
+
+// Returns the distance at which ray enters the box, or a negative value if it misses it within [0, maxDistance]
+inline float intersectBox( const TriMeshBvh::Node &node, const Ray &ray, float maxDistance )
+{
+	const vec3 t0 = ( node.mMin - ray.getOrigin() ) * ray.getInverseDirection();
+	const vec3 t1 = ( node.mMax - ray.getOrigin() ) * ray.getInverseDirection();
+	const vec3 enters = glm::min( t0, t1 ), exits = glm::max( t0, t1 );
+	const float enter = std::max( std::max( enters.x, enters.y ), std::max( enters.z, 0.0f ) );
+	const float exit = std::min( std::min( exits.x, exits.y ), std::min( exits.z, maxDistance ) );
+	return enter <= exit ? enter : -1.0f;
+}
+
+// Moller-Trumbore, as in Ray::calcTriangleIntersection(), limited to hits in [0, maxDistance]
+inline bool intersectTriangle( const Ray &ray, const vec3 *vertices, float maxDistance, float *distance, vec2 *barycentric )
+{
+	const vec3 edge1 = vertices[1] - vertices[0];
+	const vec3 edge2 = vertices[2] - vertices[0];
+	const vec3 pvec = cross( ray.getDirection(), edge2 );
+	const float det = dot( edge1, pvec );
+	if( det > -0.000001f && det < 0.000001f )
+		return false;
+
+	const float invDet = 1.0f / det;
+	const vec3 tvec = ray.getOrigin() - vertices[0];
+	const float u = dot( tvec, pvec ) * invDet;
+	if( u < 0 || u > 1 )
+		return false;
+
+	const vec3 qvec = cross( tvec, edge1 );
+	const float v = dot( ray.getDirection(), qvec ) * invDet;
+	if( v < 0 || u + v > 1 )
+		return false;
+
+	const float t = dot( edge2, qvec ) * invDet;
+	if( t < 0 || t > maxDistance )
+		return false;
+
+	*distance = t;
+	*barycentric = vec2( u, v );
+	return true;
+}
+
+// Separating axis test (Akenine-Moller) of a triangle against a box given by its center and half size
+bool triangleOverlapsBox( const vec3 *vertices, const vec3 &center, const vec3 &extents )
+{
+	const vec3 v[3] = { vertices[0] - center, vertices[1] - center, vertices[2] - center };
+	if( glm::any( glm::greaterThan( glm::min( v[0], glm::min( v[1], v[2] ) ), extents ) ) || glm::any( glm::lessThan( glm::max( v[0], glm::max( v[1], v[2] ) ), -extents ) ) )
+		return false;
+
+	const vec3 edges[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+	auto separates = [&]( const vec3 &axis ) {
+		const float p0 = dot( v[0], axis ), p1 = dot( v[1], axis ), p2 = dot( v[2], axis );
+		const float radius = dot( extents, glm::abs( axis ) );
+		return std::min( p0, std::min( p1, p2 ) ) > radius || std::max( p0, std::max( p1, p2 ) ) < -radius;
+	};
+
+	if( separates( cross( edges[0], edges[1] ) ) )
+		return false;
+	for( size_t e = 0; e < 3; ++e ) {
+		if( separates( vec3( 0, -edges[e].z, edges[e].y ) ) || separates( vec3( edges[e].z, 0, -edges[e].x ) ) || separates( vec3( -edges[e].y, edges[e].x, 0 ) ) )
+			return false;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+TriMeshBvh::TriMeshBvh( const TriMesh &mesh, const Format &format )
+	: mMesh( &mesh ), mFormat( format ), mDepth( 0 )
+{
+	build();
+}
+
+void TriMeshBvh::build()
+{
+	mNodes.clear();
+	mTriangles.clear();
+	mVertices.clear();
+	mDepth = 0;
+
+	const size_t numTriangles = mMesh->getNumTriangles();
+	if( mMesh->getAttribDims( geom::POSITION ) != 3 || ! numTriangles )
+		return;
+
+	BvhBuilder builder( *mMesh, mFormat );
+
+	// the top of the hierarchy is split with parallel passes over its triangles, until ranges are small enough to be built as subtrees in parallel
+	struct Subtree {
+		uint32_t		mBegin, mEnd;
+		BvhBounds		mBounds;
+		vector<Node>	mNodes;
+	};
+	struct Range {
+		uint32_t	mBegin, mEnd, mParent;
+		BvhBounds	mBounds;
+	};
+
+	vector<Node> top;
+	vector<Subtree> subtrees;
+	const uint32_t noParent = numeric_limits<uint32_t>::max();
+	const uint16_t subtreeCount = numeric_limits<uint16_t>::max();
+	BvhBuilder::Scratch scratch;
+	vector<Range> stack;
+	Range root = { 0, uint32_t( numTriangles ), noParent, builder.calcBounds( 0, uint32_t( numTriangles ), true ) };
+	stack.push_back( root );
+	while( ! stack.empty() ) {
+		const Range range = stack.back();
+		stack.pop_back();
+
+		const uint32_t index = uint32_t( top.size() );
+		if( range.mParent != noParent )
+			top[range.mParent].mOffset = index;
+
+		Node node;
+		node.mMin = range.mBounds.mMin;
+		node.mMax = range.mBounds.mMax;
+		node.mAxis = 0;
+		uint32_t mid;
+		Range first, second;
+		if( range.mEnd - range.mBegin <= kSubtreeTriangles ) {
+			// a placeholder for the subtree
+			node.mOffset = uint32_t( subtrees.size() );
+			node.mCount = subtreeCount;
+			subtrees.push_back( Subtree() );
+			subtrees.back().mBegin = range.mBegin;
+			subtrees.back().mEnd = range.mEnd;
+			subtrees.back().mBounds = range.mBounds;
+		}
+		else if( builder.split( range.mBegin, range.mEnd, range.mBounds, true, &scratch, &mid, &node.mAxis, &first.mBounds, &second.mBounds ) ) {
+			node.mCount = 0;
+			first.mBegin = range.mBegin;
+			first.mEnd = second.mBegin = mid;
+			second.mEnd = range.mEnd;
+			first.mParent = noParent;
+			second.mParent = index;
+			stack.push_back( second );
+			stack.push_back( first );
+		}
+		else {
+			node.mOffset = range.mBegin;
+			node.mCount = uint16_t( range.mEnd - range.mBegin );
+		}
+		top.push_back( node );
+	}
+
+	parallelFor( subtrees.size(), [&]( size_t s ) {
+		builder.buildSubtree( subtrees[s].mBegin, subtrees[s].mEnd, subtrees[s].mBounds, &subtrees[s].mNodes );
+	} );
+	builder.copyTriangles( &mTriangles );
+
+	// splice the subtrees in place of their placeholders, which keeps the nodes in depth-first order
+	vector<uint32_t> topIndices( top.size() );
+	size_t numNodes = 0;
+	for( size_t i = 0; i < top.size(); ++i ) {
+		topIndices[i] = uint32_t( numNodes );
+		numNodes += ( top[i].mCount == subtreeCount ) ? subtrees[top[i].mOffset].mNodes.size() : 1;
+	}
+
+	mNodes.reserve( numNodes );
+	for( const Node &node : top ) {
+		if( node.mCount == subtreeCount ) {
+			const uint32_t base = uint32_t( mNodes.size() );
+			for( Node subtreeNode : subtrees[node.mOffset].mNodes ) {
+				if( ! subtreeNode.isLeaf() )
+					subtreeNode.mOffset += base;
+				mNodes.push_back( subtreeNode );
+			}
+		}
+		else {
+			mNodes.push_back( node );
+			if( ! node.isLeaf() )
+				mNodes.back().mOffset = topIndices[node.mOffset];
+		}
+	}
+
+	// parents precede their children, so depths can be propagated in order
+	vector<uint32_t> depths( mNodes.size(), 1 );
+	for( size_t i = 0; i < mNodes.size(); ++i ) {
+		mDepth = std::max<size_t>( mDepth, depths[i] );
+		if( ! mNodes[i].isLeaf() )
+			depths[i + 1] = depths[mNodes[i].mOffset] = depths[i] + 1;
+	}
+
+	updateVertices();
+}
+
+void TriMeshBvh::updateVertices()
+{
+	const vec3 *positions = mMesh->getPositions<3>();
+	const uint32_t *indices = mMesh->getIndices().data();
+	mVertices.resize( mTriangles.size() * 3 );
+	BvhBuilder::forEachTask( 0, uint32_t( mTriangles.size() ), true, [&]( uint32_t begin, uint32_t end ) {
+		for( uint32_t i = begin; i < end; ++i ) {
+			for( size_t c = 0; c < 3; ++c )
+				mVertices[i * 3 + c] = positions[indices[mTriangles[i] * 3 + c]];
+		}
+	} );
+}
+
+void TriMeshBvh::refit()
+{
+	if( mNodes.empty() )
+		return;
+
+	updateVertices();
+
+	// leaves in parallel, then every inner node from its children, which follow it
+	BvhBuilder::forEachTask( 0, uint32_t( mNodes.size() ), true, [&]( uint32_t begin, uint32_t end ) {
+		for( uint32_t n = begin; n < end; ++n ) {
+			Node &node = mNodes[n];
+			if( ! node.isLeaf() )
+				continue;
+
+			const vec3 *vertices = &mVertices[node.mOffset * 3];
+			node.mMin = node.mMax = vertices[0];
+			for( size_t v = 1; v < node.mCount * 3u; ++v ) {
+				node.mMin = glm::min( node.mMin, vertices[v] );
+				node.mMax = glm::max( node.mMax, vertices[v] );
+			}
+		}
+	} );
+
+	for( size_t n = mNodes.size(); n-- > 0; ) {
+		Node &node = mNodes[n];
+		if( ! node.isLeaf() ) {
+			node.mMin = glm::min( mNodes[n + 1].mMin, mNodes[node.mOffset].mMin );
+			node.mMax = glm::max( mNodes[n + 1].mMax, mNodes[node.mOffset].mMax );
+		}
+	}
+}
+
+AxisAlignedBox TriMeshBvh::getBounds() const
+{
+	if( mNodes.empty() )
+		return AxisAlignedBox();
+
+	return AxisAlignedBox( mNodes[0].mMin, mNodes[0].mMax );
+}
+
+TriMeshBvh::RayHit TriMeshBvh::raycast( const Ray &ray, float maxDistance ) const
+{
+	RayHit result;
+	if( mNodes.empty() || intersectBox( mNodes[0], ray, maxDistance ) < 0 )
+		return result;
+
+	NodeStack<uint32_t> stack( mDepth + 1 );
+	stack.push( 0 );
+	while( ! stack.empty() ) {
+		const Node &node = mNodes[stack.pop()];
+		if( node.isLeaf() ) {
+			for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+				if( intersectTriangle( ray, &mVertices[i * 3], maxDistance, &result.mDistance, &result.mBarycentric ) ) {
+					result.mTriangle = mTriangles[i];
+					maxDistance = result.mDistance;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first, so that its hits can cull the other one
+		const uint32_t first = uint32_t( &node - mNodes.data() ) + 1, second = node.mOffset;
+		const float firstDistance = intersectBox( mNodes[first], ray, maxDistance ), secondDistance = intersectBox( mNodes[second], ray, maxDistance );
+		if( firstDistance >= 0 && secondDistance >= 0 ) {
+			stack.push( firstDistance <= secondDistance ? second : first );
+			stack.push( firstDistance <= secondDistance ? first : second );
+		}
+		else if( firstDistance >= 0 )
+			stack.push( first );
+		else if( secondDistance >= 0 )
+			stack.push( second );
+	}
+
+	return result;
+}
+
+bool TriMeshBvh::raycastAny( const Ray &ray, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	NodeStack<uint32_t> stack( mDepth + 1 );
+	stack.push( 0 );
+	float distance;
+	vec2 barycentric;
+	while( ! stack.empty() ) {
+		const uint32_t index = stack.pop();
+		const Node &node = mNodes[index];
+		if( intersectBox( node, ray, maxDistance ) < 0 )
+			continue;
+
+		if( node.isLeaf() ) {
+			for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+				if( intersectTriangle( ray, &mVertices[i * 3], maxDistance, &distance, &barycentric ) )
+					return true;
+			}
+		}
+		else {
+			stack.push( node.mOffset );
+			stack.push( index + 1 );
+		}
+	}
+
+	return false;
+}
+
+size_t TriMeshBvh::raycast( const Ray *rays, size_t numRays, RayHit *results, float maxDistance ) const
+{
+	for( size_t r = 0; r < numRays; ++r )
+		results[r] = RayHit();
+	if( mNodes.empty() )
+		return 0;
+
+	const size_t numPackets = ( numRays + kPacketSize - 1 ) / kPacketSize;
+	parallelFor( numPackets, [&]( size_t packet ) {
+		const size_t begin = packet * kPacketSize;
+		const uint32_t count = uint32_t( std::min( kPacketSize, numRays - begin ) );
+		const Ray *packetRays = rays + begin;
+		RayHit *packetResults = results + begin;
+		float maxDistances[kPacketSize];
+		for( uint32_t r = 0; r < count; ++r )
+			maxDistances[r] = maxDistance;
+
+
+		/* The packet descends into a node if any of its rays hit it. Each node on the stack carries the first ray that may hit it, since rays that
+		   missed its parent miss it too, and inner nodes are entered as soon as one ray hits them. */
+		NodeStack<PacketEntry> stack( mDepth + 1 );
+		stack.push( PacketEntry( 0, 0 ) );
+		while( ! stack.empty() ) {
+			const PacketEntry entry = stack.pop();
+			const Node &node = mNodes[entry.mNode];
+			uint32_t first = entry.mFirstRay;
+			while( first < count && intersectBox( node, packetRays[first], maxDistances[first] ) < 0 )
+				++first;
+			if( first == count )
+				continue;
+
+			if( ! node.isLeaf() ) {
+				// visit the child nearer to the first active ray first
+				if( packetRays[first].getDirection()[node.mAxis] < 0 ) {
+					stack.push( PacketEntry( entry.mNode + 1, first ) );
+					stack.push( PacketEntry( node.mOffset, first ) );
+				}
+				else {
+					stack.push( PacketEntry( node.mOffset, first ) );
+					stack.push( PacketEntry( entry.mNode + 1, first ) );
+				}
+				continue;
+			}
+
+			for( uint32_t r = first; r < count; ++r ) {
+				if( r != first && intersectBox( node, packetRays[r], maxDistances[r] ) < 0 )
+					continue;
+
+				for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+					if( intersectTriangle( packetRays[r], &mVertices[i * 3], maxDistances[r], &packetResults[r].mDistance, &packetResults[r].mBarycentric ) ) {
+						packetResults[r].mTriangle = mTriangles[i];
+						maxDistances[r] = packetResults[r].mDistance;
+					}
+				}
+			}
+		}
+	} );
+
+	size_t numHits = 0;
+	for( size_t r = 0; r < numRays; ++r )
+		numHits += results[r].isHit() ? 1 : 0;
+	return numHits;
+}
+
+size_t TriMeshBvh::raycastAny( const Ray *rays, size_t numRays, bool *results, float maxDistance ) const
+{
+	std::fill( results, results + numRays, false );
+	if( mNodes.empty() )
+		return 0;
+
+	const size_t numPackets = ( numRays + kPacketSize - 1 ) / kPacketSize;
+	parallelFor( numPackets, [&]( size_t packet ) {
+		const size_t begin = packet * kPacketSize;
+		const uint32_t count = uint32_t( std::min( kPacketSize, numRays - begin ) );
+		const Ray *packetRays = rays + begin;
+		bool *packetResults = results + begin;
+		size_t numOpen = count;
+
+		// as in raycast(), except that rays which have found a hit drop out of the packet
+		NodeStack<PacketEntry> stack( mDepth + 1 );
+		stack.push( PacketEntry( 0, 0 ) );
+		float distance;
+		vec2 barycentric;
+		while( ! stack.empty() && numOpen ) {
+			const PacketEntry entry = stack.pop();
+			const Node &node = mNodes[entry.mNode];
+			uint32_t first = entry.mFirstRay;
+			while( first < count && ( packetResults[first] || intersectBox( node, packetRays[first], maxDistance ) < 0 ) )
+				++first;
+			if( first == count )
+				continue;
+
+			if( ! node.isLeaf() ) {
+				stack.push( PacketEntry( node.mOffset, first ) );
+				stack.push( PacketEntry( entry.mNode + 1, first ) );
+				continue;
+			}
+
+			for( uint32_t r = first; r < count; ++r ) {
+				if( packetResults[r] || ( r != first && intersectBox( node, packetRays[r], maxDistance ) < 0 ) )
+					continue;
+
+				for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+					if( intersectTriangle( packetRays[r], &mVertices[i * 3], maxDistance, &distance, &barycentric ) ) {
+						packetResults[r] = true;
+						--numOpen;
+						break;
+					}
+				}
+			}
+		}
+	} );
+
+	return size_t( std::count( results, results + numRays, true ) );
+}
+
+void TriMeshBvh::queryOverlapping( const AxisAlignedBox &box, vector<uint32_t> *result ) const
+{
+	if( mNodes.empty() )
+		return;
+
+	const vec3 boxMin = box.getMin(), boxMax = box.getMax();
+	NodeStack<uint32_t> stack( mDepth + 1 );
+	stack.push( 0 );
+	while( ! stack.empty() ) {
+		const uint32_t index = stack.pop();
+		const Node &node = mNodes[index];
+		if( glm::any( glm::greaterThan( node.mMin, boxMax ) ) || glm::any( glm::lessThan( node.mMax, boxMin ) ) )
+			continue;
+
+		// the triangles of a node inside the box all overlap it, and are contiguous from its first leaf to its last
+		if( glm::all( glm::greaterThanEqual( node.mMin, boxMin ) ) && glm::all( glm::lessThanEqual( node.mMax, boxMax ) ) ) {
+			uint32_t first = index, last = index;
+			while( ! mNodes[first].isLeaf() )
+				++first;
+			while( ! mNodes[last].isLeaf() )
+				last = mNodes[last].mOffset;
+			result->insert( result->end(), mTriangles.begin() + mNodes[first].mOffset, mTriangles.begin() + mNodes[last].mOffset + mNodes[last].mCount );
+		}
+		else if( node.isLeaf() ) {
+			for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+				if( triangleOverlapsBox( &mVertices[i * 3], box.getCenter(), box.getExtents() ) )
+					result->push_back( mTriangles[i] );
+			}
+		}
+		else {
+			stack.push( node.mOffset );
+			stack.push( index + 1 );
+		}
+	}
+}
+
+void TriMeshBvh::queryOverlapping( const Frustum &frustum, vector<uint32_t> *result ) const
+{
+	if( mNodes.empty() )
+		return;
+
+	NodeStack<uint32_t> stack( mDepth + 1 );
+	stack.push( 0 );
+	while( ! stack.empty() ) {
+		const uint32_t index = stack.pop();
+		const Node &node = mNodes[index];
+		const AxisAlignedBox bounds( node.mMin, node.mMax );
+		if( ! frustum.intersects( bounds ) )
+			continue;
+
+		if( frustum.contains( bounds ) ) {
+			uint32_t first = index, last = index;
+			while( ! mNodes[first].isLeaf() )
+				++first;
+			while( ! mNodes[last].isLeaf() )
+				last = mNodes[last].mOffset;
+			result->insert( result->end(), mTriangles.begin() + mNodes[first].mOffset, mTriangles.begin() + mNodes[last].mOffset + mNodes[last].mCount );
+		}
+		else if( node.isLeaf() ) {
+			// a triangle is outside if all of its vertices are outside the same plane
+			for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+				const vec3 *vertices = &mVertices[i * 3];
+				bool outside = false;
+				for( int p = 0; p < 6 && ! outside; ++p ) {
+					const Plane &plane = frustum.getPlane( Frustum::FrustumSection( p ) );
+					outside = plane.distance( vertices[0] ) < 0 && plane.distance( vertices[1] ) < 0 && plane.distance( vertices[2] ) < 0;
+				}
+				if( ! outside )
+					result->push_back( mTriangles[i] );
+			}
+		}
+		else {
+			stack.push( node.mOffset );
+			stack.push( index + 1 );
+		}
+	}
+}
+
+} // namespace cinder
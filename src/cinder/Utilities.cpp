@@ -32,6 +32,13 @@
 #endif
 
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -94,6 +101,144 @@ void sleep( float milliseconds )
 	app::Platform::get()->sleep( milliseconds );
 }
 
+namespace {
+
+// A parallelFor() call. Its indices are handed out dynamically to the calling thread and to any pool workers that join it.
+struct ParallelForJob {
+	ParallelForJob( size_t count, const std::function<void( size_t )> &fn, size_t maxHelpers )
+		: mCount( count ), mFn( fn ), mNextIndex( 0 ), mMaxHelpers( maxHelpers ), mNumHelpers( 0 ), mNumActiveHelpers( 0 )
+	{}
+
+	void run()
+	{
+		while( true ) {
+			size_t i = mNextIndex++;
+			if( i >= mCount )
+				break;
+
+			try {
+				mFn( i );
+			}
+			catch( ... ) {
+				std::lock_guard<std::mutex> lock( mExceptionMutex );
+				if( ! mException )
+					mException = std::current_exception();
+
+				mNextIndex = mCount;
+			}
+		}
+	}
+
+	const size_t							mCount;
+	const std::function<void( size_t )>&	mFn;
+	std::atomic<size_t>						mNextIndex;
+	std::mutex								mExceptionMutex;
+	std::exception_ptr						mException;
+
+	// guarded by ParallelForPool::mMutex
+	const size_t							mMaxHelpers;
+	size_t									mNumHelpers, mNumActiveHelpers;
+	std::condition_variable					mHelpersFinishedCond;
+};
+
+// Worker threads shared by all parallelFor() calls, one less than the number of hardware threads since the calling thread always works too.
+// Because a caller processes its own indices rather than waiting on the workers, nested parallelFor() calls can't deadlock the pool.
+class ParallelForPool {
+  public:
+	static ParallelForPool* get()
+	{
+		std::call_once( sInstanceFlag, [] { sInstance = new ParallelForPool; } ); // never deleted, so workers outlive static destruction
+		return sInstance;
+	}
+
+	size_t getNumWorkers() const	{ return mWorkers.size(); }
+
+	void run( ParallelForJob *job )
+	{
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			mJobs.push_back( job );
+		}
+		mJobAvailableCond.notify_all();
+
+		job->run();
+
+		// stop handing out the job, then wait for the workers that joined it to finish their last index.
+		std::unique_lock<std::mutex> lock( mMutex );
+		auto it = std::find( mJobs.begin(), mJobs.end(), job );
+		if( it != mJobs.end() )
+			mJobs.erase( it );
+
+		job->mHelpersFinishedCond.wait( lock, [job] { return job->mNumActiveHelpers == 0; } );
+	}
+
+  private:
+	ParallelForPool()
+	{
+		const size_t numWorkers = std::max<size_t>( 1, std::thread::hardware_concurrency() ) - 1;
+		for( size_t i = 0; i < numWorkers; i++ ) {
+			mWorkers.emplace_back( [this] { workerLoop(); } );
+			mWorkers.back().detach();
+		}
+	}
+
+	void workerLoop()
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		while( true ) {
+			mJobAvailableCond.wait( lock, [this] { return ! mJobs.empty(); } );
+
+			ParallelForJob *job = mJobs.front();
+			if( ++job->mNumHelpers >= job->mMaxHelpers )
+				mJobs.pop_front();
+
+			job->mNumActiveHelpers++;
+			lock.unlock();
+			job->run();
+			lock.lock();
+
+			if( --job->mNumActiveHelpers == 0 )
+				job->mHelpersFinishedCond.notify_all();
+		}
+	}
+
+	std::mutex						mMutex;
+	std::condition_variable			mJobAvailableCond;
+	std::deque<ParallelForJob *>	mJobs;
+	std::vector<std::thread>		mWorkers;
+
+	static std::once_flag			sInstanceFlag;
+	static ParallelForPool*			sInstance;
+};
+
+std::once_flag ParallelForPool::sInstanceFlag;
+ParallelForPool* ParallelForPool::sInstance = nullptr;
+
+} // anonymous namespace
+
+void parallelFor( size_t count, const std::function<void( size_t )> &fn, size_t numThreads )
+{
+	if( ! numThreads )
+		numThreads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+
+	numThreads = std::min( numThreads, count );
+	if( numThreads <= 1 ) {
+		for( size_t i = 0; i < count; i++ )
+			fn( i );
+		return;
+	}
+
+	ParallelForPool *pool = ParallelForPool::get();
+	ParallelForJob job( count, fn, std::min( numThreads - 1, pool->getNumWorkers() ) );
+	if( job.mMaxHelpers == 0 )
+		job.run();
+	else
+		pool->run( &job );
+
+	if( job.mException )
+		std::rethrow_exception( job.mException );
+}
+
 vector<string> stackTrace()
 {
 	return app::Platform::get()->stackTrace();
@@ -29,6 +29,7 @@
 #include "cinder/Cinder.h"
 #include "cinder/app/AppBase.h"
 
+#include <map>
 #include <sstream>
 
 #if defined( CINDER_COCOA )
@@ -135,7 +136,9 @@ void Context::setMaster( Context *masterContext, DeviceManager *deviceManager )
 }
 
 Context::Context()
-	: mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ), mNumProcessedFrames( 0 )
+	: mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ), mNumProcessedFrames( 0 ),
+		mProfilingEnabled( false ), mProfileBlockBeginNanos( 0 ), mProfileNumBlocks( 0 ), mProfileNumDeadlineMisses( 0 ),
+		mProfileTotalNanos( 0 ), mProfileMaxNanos( 0 ), mProfileLastNanos( 0 )
 {
 }
 
@@ -310,6 +313,7 @@ bool Context::isAudioThread() const
 void Context::preProcess()
 {
 	mAudioThreadId = std::this_thread::get_id();
+	mProfileBlockBeginNanos = isProfilingEnabled() ? getTimestampNanoseconds() : 0;
 
 	preProcessScheduledEvents();
 }
@@ -318,6 +322,21 @@ void Context::postProcess()
 {
 	processAutoPulledNodes();
 	postProcessScheduledEvents();
+
+	if( mProfileBlockBeginNanos ) {
+		const uint64_t elapsedNanos = getTimestampNanoseconds() - mProfileBlockBeginNanos;
+		const uint64_t deadlineNanos = ( (uint64_t)getFramesPerBlock() * 1000000000 ) / (uint64_t)getSampleRate();
+
+		// only the audio thread writes these, so plain loads and stores are enough.
+		mProfileNumBlocks.store( mProfileNumBlocks.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+		mProfileTotalNanos.store( mProfileTotalNanos.load( memory_order_relaxed ) + elapsedNanos, memory_order_relaxed );
+		mProfileLastNanos.store( elapsedNanos, memory_order_relaxed );
+		if( elapsedNanos > mProfileMaxNanos.load( memory_order_relaxed ) )
+			mProfileMaxNanos.store( elapsedNanos, memory_order_relaxed );
+		if( elapsedNanos > deadlineNanos )
+			mProfileNumDeadlineMisses.store( mProfileNumDeadlineMisses.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+	}
+
 	incrementFrameCount();
 }
 
@@ -392,7 +411,18 @@ const std::vector<Node *>& Context::getAutoPulledNodes()
 
 namespace {
 
-void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes )
+string channelModeToString( Node::ChannelMode mode )
+{
+	switch( mode ) {
+		case Node::ChannelMode::SPECIFIED: return "specified";
+		case Node::ChannelMode::MATCHES_INPUT: return "matches input";
+		case Node::ChannelMode::MATCHES_OUTPUT: return "matches output";
+	}
+
+	return "";
+}
+
+void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes, bool printProfile )
 {
 	if( ! node )
 		return;
@@ -406,41 +436,208 @@ void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<Nod
 
 	traversedNodes.insert( node );
 
-	string channelMode;
-	switch( node->getChannelMode() ) {
-		case Node::ChannelMode::SPECIFIED: channelMode = "specified"; break;
-		case Node::ChannelMode::MATCHES_INPUT: channelMode = "matches input"; break;
-		case Node::ChannelMode::MATCHES_OUTPUT: channelMode = "matches output"; break;
-	}
-
 	stream << node->getName() << "\t[ " << ( node->isEnabled() ? "enabled" : "disabled" );
 	stream << ", ch: " << node->getNumChannels();
-	stream << ", ch mode: " << channelMode;
+	stream << ", ch mode: " << channelModeToString( node->getChannelMode() );
 	stream << ", " << ( node->getProcessesInPlace() ? "in-place" : "sum" );
+	if( printProfile ) {
+		const auto profile = node->getProfile();
+		stream << ", avg: " << profile.getAverageSeconds() * 1000.0 << "ms";
+		stream << ", max: " << profile.mMaxSeconds * 1000.0 << "ms";
+		if( profile.mNumUnderruns || profile.mNumOverruns )
+			stream << ", underruns: " << profile.mNumUnderruns << ", overruns: " << profile.mNumOverruns;
+	}
 	stream << " ]" << endl;
 
 	for( const auto &input : node->getInputs() )
-		printRecursive( stream, input, depth + 1, traversedNodes );
+		printRecursive( stream, input, depth + 1, traversedNodes, printProfile );
 };
 
+string escapeJson( const string &str )
+{
+	string result;
+	result.reserve( str.size() );
+	for( char c : str ) {
+		switch( c ) {
+			case '"':	result += "\\\""; break;
+			case '\\':	result += "\\\\"; break;
+			case '\n':	result += "\\n"; break;
+			case '\t':	result += "\\t"; break;
+			default:
+				if( (unsigned char)c >= 0x20 )
+					result += c;
+		}
+	}
+
+	return result;
+}
+
+void printProfileJson( ostream &stream, const NodeProfile &profile )
+{
+	stream << "{ \"blocks\": " << profile.mNumBlocks;
+	stream << ", \"averageSeconds\": " << profile.getAverageSeconds();
+	stream << ", \"maxSeconds\": " << profile.mMaxSeconds;
+	stream << ", \"lastSeconds\": " << profile.mLastSeconds;
+	stream << ", \"underruns\": " << profile.mNumUnderruns;
+	stream << ", \"overruns\": " << profile.mNumOverruns << " }";
+}
+
+// Node's reachable through more than one path are printed once, the others refer to them by id.
+void printJsonRecursive( ostream &stream, const NodeRef &node, size_t depth, map<NodeRef, size_t> &nodeIds )
+{
+	const string indent( depth * 2, ' ' );
+
+	auto idIt = nodeIds.find( node );
+	if( idIt != nodeIds.end() ) {
+		stream << indent << "{ \"ref\": " << idIt->second << " }";
+		return;
+	}
+
+	const size_t id = nodeIds.size();
+	nodeIds[node] = id;
+
+	stream << indent << "{ \"id\": " << id;
+	stream << ", \"name\": \"" << escapeJson( node->getName() ) << "\"";
+	stream << ", \"enabled\": " << ( node->isEnabled() ? "true" : "false" );
+	stream << ", \"channels\": " << node->getNumChannels();
+	stream << ", \"channelMode\": \"" << channelModeToString( node->getChannelMode() ) << "\"";
+	stream << ", \"inPlace\": " << ( node->getProcessesInPlace() ? "true" : "false" );
+	stream << ",\n" << indent << "  \"profile\": ";
+	printProfileJson( stream, node->getProfile() );
+	stream << ",\n" << indent << "  \"inputs\": [";
+
+	const auto &inputs = node->getInputs();
+	for( auto inputIt = inputs.begin(); inputIt != inputs.end(); ++inputIt ) {
+		stream << ( inputIt == inputs.begin() ? "\n" : ",\n" );
+		printJsonRecursive( stream, *inputIt, depth + 2, nodeIds );
+	}
+
+	if( ! inputs.empty() )
+		stream << "\n" << indent << "  ";
+
+	stream << "] }";
+}
+
 } // anonymous namespace
 
 string Context::printGraphToString()
 {
 	stringstream stream;
 	set<NodeRef> traversedNodes;
+	const bool printProfile = isProfilingEnabled();
 
-	printRecursive( stream, getOutput(), 0, traversedNodes );
+	printRecursive( stream, getOutput(), 0, traversedNodes, printProfile );
 
 	if( ! mAutoPulledNodes.empty() ) {
 		stream << "(auto-pulled:)" << endl;
 		for( const auto& node : mAutoPulledNodes )
-			printRecursive( stream, node, 0, traversedNodes );
+			printRecursive( stream, node, 0, traversedNodes, printProfile );
+	}
+
+	if( printProfile ) {
+		const auto profile = getProfile();
+		stream << "(profile: blocks: " << profile.mNumBlocks << ", deadline misses: " << profile.mNumDeadlineMisses;
+		stream << ", avg: " << profile.getAverageSeconds() * 1000.0 << "ms, max: " << profile.mMaxSeconds * 1000.0 << "ms";
+		stream << ", load: " << profile.getLoad() * 100.0 << "%)" << endl;
+	}
+
+	return stream.str();
+}
+
+string Context::printGraphToJson()
+{
+	stringstream stream;
+	map<NodeRef, size_t> nodeIds;
+	const auto profile = getProfile();
+
+	stream << "{\n";
+	stream << "  \"sampleRate\": " << getSampleRate() << ",\n";
+	stream << "  \"framesPerBlock\": " << getFramesPerBlock() << ",\n";
+	stream << "  \"enabled\": " << ( isEnabled() ? "true" : "false" ) << ",\n";
+	stream << "  \"profiling\": " << ( isProfilingEnabled() ? "true" : "false" ) << ",\n";
+	stream << "  \"profile\": { \"blocks\": " << profile.mNumBlocks;
+	stream << ", \"deadlineMisses\": " << profile.mNumDeadlineMisses;
+	stream << ", \"deadlineSeconds\": " << profile.mDeadlineSeconds;
+	stream << ", \"averageSeconds\": " << profile.getAverageSeconds();
+	stream << ", \"maxSeconds\": " << profile.mMaxSeconds;
+	stream << ", \"lastSeconds\": " << profile.mLastSeconds;
+	stream << ", \"load\": " << profile.getLoad() << " },\n";
+
+	stream << "  \"output\":\n";
+	printJsonRecursive( stream, getOutput(), 2, nodeIds );
+	stream << ",\n  \"autoPulled\": [";
+	for( auto nodeIt = mAutoPulledNodes.begin(); nodeIt != mAutoPulledNodes.end(); ++nodeIt ) {
+		stream << ( nodeIt == mAutoPulledNodes.begin() ? "\n" : ",\n" );
+		printJsonRecursive( stream, *nodeIt, 2, nodeIds );
 	}
+	stream << ( mAutoPulledNodes.empty() ? "]\n" : "\n  ]\n" );
+	stream << "}\n";
 
 	return stream.str();
 }
 
+void Context::collectNodesRecursive( const NodeRef &node, vector<NodeRef> &nodes, set<NodeRef> &traversedNodes )
+{
+	if( ! node || traversedNodes.count( node ) )
+		return;
+
+	traversedNodes.insert( node );
+	nodes.push_back( node );
+
+	for( const auto &input : node->getInputs() )
+		collectNodesRecursive( input, nodes, traversedNodes );
+}
+
+vector<NodeRef> Context::collectProcessedNodes()
+{
+	vector<NodeRef> result;
+	set<NodeRef> traversedNodes;
+
+	collectNodesRecursive( getOutput(), result, traversedNodes );
+	for( const auto &node : mAutoPulledNodes )
+		collectNodesRecursive( node, result, traversedNodes );
+
+	return result;
+}
+
+ContextProfile Context::getProfile()
+{
+	ContextProfile result;
+	result.mNumBlocks = mProfileNumBlocks.load( memory_order_relaxed );
+	result.mNumDeadlineMisses = mProfileNumDeadlineMisses.load( memory_order_relaxed );
+	result.mTotalSeconds = (double)mProfileTotalNanos.load( memory_order_relaxed ) * 1e-9;
+	result.mMaxSeconds = (double)mProfileMaxNanos.load( memory_order_relaxed ) * 1e-9;
+	result.mLastSeconds = (double)mProfileLastNanos.load( memory_order_relaxed ) * 1e-9;
+	result.mDeadlineSeconds = (double)getFramesPerBlock() / (double)getSampleRate();
+
+	// the lock is only needed to traverse the graph, the counters themselves are read without blocking the audio thread.
+	vector<NodeRef> nodes;
+	{
+		lock_guard<mutex> lock( mMutex );
+		nodes = collectProcessedNodes();
+	}
+
+	result.mNodes.reserve( nodes.size() );
+	for( const auto &node : nodes )
+		result.mNodes.push_back( make_pair( node, node->getProfile() ) );
+
+	return result;
+}
+
+void Context::resetProfile()
+{
+	lock_guard<mutex> lock( mMutex );
+
+	mProfileNumBlocks = 0;
+	mProfileNumDeadlineMisses = 0;
+	mProfileTotalNanos = 0;
+	mProfileMaxNanos = 0;
+	mProfileLastNanos = 0;
+
+	for( const auto &node : collectProcessedNodes() )
+		node->resetProfile();
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - ScopedEnableContext
 // ----------------------------------------------------------------------------------------------------
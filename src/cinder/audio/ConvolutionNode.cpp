@@ -0,0 +1,343 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/ConvolutionNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderMath.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace ci;
+using namespace std;
+
+namespace cinder { namespace audio {
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ConvolutionNode::TailStage
+// ----------------------------------------------------------------------------------------------------
+
+//! Convolves one segment of the impulse response tail on a background thread, with partitions of getBlockSize() frames.
+//! Input is gathered on the audio thread for one block period, then handed off. The worker has a full block period to finish,
+//! and the result is mixed into the output during the period after that. This delay of two periods is accounted for by
+//! having the segment start at twice the block size into the impulse response. The audio thread never waits on the worker:
+//! if a job is late, the block gathered meanwhile is dropped and the late output is collected at the next boundary.
+class ConvolutionNode::TailStage {
+  public:
+	TailStage( size_t blockSize, ConvolverVector &&convolvers )
+		: mBlockSize( blockSize ), mInputFill( 0 ), mConvolvers( move( convolvers ) ), mJobPending( false ), mShouldQuit( false ), mJobFinished( true )
+	{
+		size_t numChannels = mConvolvers.size();
+		mInput = Buffer( mBlockSize, numChannels );
+		mJobInput = Buffer( mBlockSize, numChannels );
+		mJobOutput = Buffer( mBlockSize, numChannels );
+		mPrecalculated = Buffer( mBlockSize, numChannels );
+
+		mThread = thread( bind( &TailStage::run, this ) );
+	}
+
+	~TailStage()
+	{
+		{
+			lock_guard<mutex> lock( mMutex );
+			mShouldQuit = true;
+		}
+		mCond.notify_one();
+		mThread.join();
+	}
+
+	size_t getNumFramesUntilBoundary() const	{ return mBlockSize - mInputFill; }
+
+	//! Mixes precalculated output into \a output and gathers \a input, starting at \a frameOffset. Must not cross a block boundary.
+	//! Returns false if the previous job hadn't finished by the block boundary.
+	bool process( const Buffer &input, Buffer *output, size_t frameOffset, size_t numFrames )
+	{
+		CI_ASSERT( numFrames <= getNumFramesUntilBoundary() );
+
+		for( size_t ch = 0; ch < mConvolvers.size(); ch++ ) {
+			float *outChannel = output->getChannel( ch ) + frameOffset;
+			dsp::add( outChannel, mPrecalculated.getChannel( ch ) + mInputFill, outChannel, numFrames );
+			memcpy( mInput.getChannel( ch ) + mInputFill, input.getChannel( ch ) + frameOffset, numFrames * sizeof( float ) );
+		}
+
+		mInputFill += numFrames;
+		if( mInputFill < mBlockSize )
+			return true;
+
+		mInputFill = 0;
+
+		// Block boundary: collect the previous job's output, which will be played during the next period, and hand off the gathered input.
+		// If the job is late, drop the gathered input rather than blocking the audio thread, and output silence for the next period instead of
+		// repeating the previous output.
+		if( ! mJobFinished.load( memory_order_acquire ) ) {
+			mPrecalculated.zero();
+			return false;
+		}
+
+		swap( mPrecalculated, mJobOutput );
+		swap( mInput, mJobInput );
+
+		mJobFinished = false;
+		{
+			lock_guard<mutex> lock( mMutex );
+			mJobPending = true;
+		}
+		mCond.notify_one();
+
+		return true;
+	}
+
+	//! Blocks until the worker is idle. \note Must be synchronized with the audio thread, and isn't meant to be called from it.
+	void reset()
+	{
+		waitForJob();
+
+		for( auto &convolver : mConvolvers )
+			convolver->reset();
+
+		mInput.zero();
+		mJobOutput.zero();
+		mPrecalculated.zero();
+		mInputFill = 0;
+	}
+
+  private:
+	void waitForJob()
+	{
+		while( ! mJobFinished.load( memory_order_acquire ) )
+			this_thread::yield();
+	}
+
+	void run()
+	{
+		while( true ) {
+			{
+				unique_lock<mutex> lock( mMutex );
+				mCond.wait( lock, [this] { return mJobPending || mShouldQuit; } );
+
+				if( mShouldQuit )
+					return;
+
+				mJobPending = false;
+			}
+
+			for( size_t ch = 0; ch < mConvolvers.size(); ch++ )
+				mConvolvers[ch]->process( mJobInput.getChannel( ch ), mJobOutput.getChannel( ch ), mBlockSize );
+
+			mJobFinished.store( true, memory_order_release );
+		}
+	}
+
+	size_t					mBlockSize, mInputFill;
+	ConvolverVector			mConvolvers;
+	Buffer					mInput, mJobInput, mJobOutput, mPrecalculated;
+
+	thread					mThread;
+	mutex					mMutex;
+	condition_variable		mCond;
+	bool					mJobPending, mShouldQuit;
+	atomic<bool>			mJobFinished;
+};
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ConvolutionNode
+// ----------------------------------------------------------------------------------------------------
+
+ConvolutionNode::ConvolutionNode( const Format &format )
+	: Node( format ), mPartitionSize( format.getPartitionSize() ), mMaxPartitionSize( format.getMaxPartitionSize() ),
+		mNonUniform( format.isNonUniform() ), mNumTailDeadlineMisses( 0 )
+{
+}
+
+ConvolutionNode::ConvolutionNode( const BufferRef &impulseResponse, const Format &format )
+	: Node( format ), mImpulseResponse( impulseResponse ), mPartitionSize( format.getPartitionSize() ),
+		mMaxPartitionSize( format.getMaxPartitionSize() ), mNonUniform( format.isNonUniform() ), mNumTailDeadlineMisses( 0 )
+{
+}
+
+ConvolutionNode::~ConvolutionNode()
+{
+}
+
+void ConvolutionNode::initialize()
+{
+	if( ! mPartitionSize )
+		mPartitionSize = getFramesPerBlock();
+	if( ! isPowerOf2( mPartitionSize ) )
+		mPartitionSize = nextPowerOf2( static_cast<uint32_t>( mPartitionSize ) );
+
+	mInputBuffer = Buffer( getFramesPerBlock(), getNumChannels() );
+	mNumTailDeadlineMisses = 0;
+
+	if( mImpulseResponse )
+		buildConvolvers( mImpulseResponse, &mHeadConvolvers, &mTailStages );
+}
+
+void ConvolutionNode::uninitialize()
+{
+	mHeadConvolvers.clear();
+	mTailStages.clear();
+}
+
+void ConvolutionNode::setImpulseResponse( const BufferRef &impulseResponse )
+{
+	if( ! isInitialized() ) {
+		mImpulseResponse = impulseResponse;
+		return;
+	}
+
+	ConvolverVector headConvolvers;
+	TailStageVector tailStages;
+	if( impulseResponse )
+		buildConvolvers( impulseResponse, &headConvolvers, &tailStages );
+
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+
+		mImpulseResponse = impulseResponse;
+		swap( mHeadConvolvers, headConvolvers );
+		swap( mTailStages, tailStages );
+	}
+
+	// the previous convolvers and background threads are destroyed here, outside of the lock
+}
+
+void ConvolutionNode::loadImpulseResponse( const SourceFileRef &sourceFile )
+{
+	size_t sampleRate = getSampleRate();
+	if( sampleRate == sourceFile->getSampleRate() )
+		setImpulseResponse( sourceFile->loadBuffer() );
+	else {
+		auto sf = sourceFile->cloneWithSampleRate( sampleRate );
+		setImpulseResponse( sf->loadBuffer() );
+	}
+}
+
+void ConvolutionNode::reset()
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	for( auto &convolver : mHeadConvolvers )
+		convolver->reset();
+	for( auto &stage : mTailStages )
+		stage->reset();
+}
+
+void ConvolutionNode::process( Buffer *buffer )
+{
+	if( mHeadConvolvers.empty() ) {
+		buffer->zero();
+		return;
+	}
+
+	const size_t numFrames = buffer->getNumFrames();
+	mInputBuffer.copy( *buffer );
+
+	for( size_t ch = 0; ch < mHeadConvolvers.size(); ch++ )
+		mHeadConvolvers[ch]->process( mInputBuffer.getChannel( ch ), buffer->getChannel( ch ), numFrames );
+
+	// tail stages are advanced in chunks that never cross any of their block boundaries
+	size_t processed = 0;
+	while( processed < numFrames && ! mTailStages.empty() ) {
+		size_t count = numFrames - processed;
+		for( const auto &stage : mTailStages )
+			count = min( count, stage->getNumFramesUntilBoundary() );
+
+		for( auto &stage : mTailStages ) {
+			if( ! stage->process( mInputBuffer, buffer, processed, count ) )
+				mNumTailDeadlineMisses++;
+		}
+
+		processed += count;
+	}
+}
+
+// The head covers the impulse response up to where the first tail stage begins and is processed on the audio thread.
+// Each tail stage's partition size is four times the last, and it begins at twice its partition size into the impulse response,
+// giving the background thread a full period to compute it. The last stage takes whatever remains.
+void ConvolutionNode::buildConvolvers( const BufferRef &impulseResponse, ConvolverVector *headConvolvers, TailStageVector *tailStages ) const
+{
+	const size_t irLength = impulseResponse->getNumFrames();
+	const size_t irNumChannels = impulseResponse->getNumChannels();
+	const size_t numChannels = getNumChannels();
+
+	if( ! irNumChannels )
+		return;
+
+	struct Segment {
+		size_t mPartitionSize, mBegin, mEnd;
+	};
+
+	vector<Segment> tailSegments;
+	size_t headLength = irLength;
+
+	if( mNonUniform ) {
+		const size_t growthFactor = 4;
+		size_t stageSize = mPartitionSize * growthFactor;
+		if( stageSize <= mMaxPartitionSize && stageSize * 2 < irLength ) {
+			headLength = stageSize * 2;
+
+			while( true ) {
+				Segment segment;
+				segment.mPartitionSize = stageSize;
+				segment.mBegin = stageSize * 2;
+
+				size_t nextStageSize = stageSize * growthFactor;
+				bool isLast = nextStageSize > mMaxPartitionSize || nextStageSize * 2 >= irLength;
+				segment.mEnd = isLast ? irLength : nextStageSize * 2;
+				tailSegments.push_back( segment );
+
+				if( isLast )
+					break;
+
+				stageSize = nextStageSize;
+			}
+		}
+	}
+
+	// kernels are shared by all Node channels that use the same impulse response channel
+	vector<dsp::ConvolutionKernelRef> headKernels;
+	for( size_t irCh = 0; irCh < irNumChannels; irCh++ )
+		headKernels.push_back( make_shared<dsp::ConvolutionKernel>( impulseResponse->getChannel( irCh ), headLength, mPartitionSize ) );
+
+	headConvolvers->clear();
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		headConvolvers->emplace_back( new dsp::Convolver( headKernels[ch % irNumChannels] ) );
+
+	tailStages->clear();
+	for( const auto &segment : tailSegments ) {
+		vector<dsp::ConvolutionKernelRef> kernels;
+		for( size_t irCh = 0; irCh < irNumChannels; irCh++ )
+			kernels.push_back( make_shared<dsp::ConvolutionKernel>( impulseResponse->getChannel( irCh ) + segment.mBegin, segment.mEnd - segment.mBegin, segment.mPartitionSize ) );
+
+		ConvolverVector convolvers;
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			convolvers.emplace_back( new dsp::Convolver( kernels[ch % irNumChannels] ) );
+
+		tailStages->emplace_back( new TailStage( segment.mPartitionSize, move( convolvers ) ) );
+	}
+}
+
+} } // namespace cinder::audio
@@ -130,7 +130,7 @@ void DelayNode::process( Buffer *buffer )
 	}
 	else {
 		const size_t delayFrames = size_t( mParamDelaySeconds.getValue() * sampleRate );
-		size_t readIndex = writeIndex + delayBufferFrames - delayFrames;
+		size_t readIndex = ( writeIndex + delayBufferFrames - delayFrames ) % delayBufferFrames;
 
 		for( size_t i = 0; i < numFrames; i++ ) {
 			float sample = *inChannel;
@@ -0,0 +1,493 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/FileFlac.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Log.h"
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const size_t	BLOCK_SIZE = 4096;
+const size_t	MAX_FIXED_ORDER = 4;
+const size_t	MAX_PARTITION_ORDER = 8;
+const uint32_t	MAX_RICE_PARAM = 14; // 15 is the escape code for the 4-bit rice parameter coding method
+
+// Big-endian bit writer, as used throughout the FLAC bitstream.
+class BitWriter {
+  public:
+	BitWriter( vector<uint8_t> *bytes ) : mBytes( bytes ), mAccum( 0 ), mNumBits( 0 )	{}
+
+	void write( uint32_t value, size_t numBits )
+	{
+		if( ! numBits )
+			return;
+
+		if( numBits < 32 )
+			value &= ( 1u << numBits ) - 1;
+
+		mAccum = ( mAccum << numBits ) | value;
+		mNumBits += numBits;
+		while( mNumBits >= 8 ) {
+			mNumBits -= 8;
+			mBytes->push_back( uint8_t( mAccum >> mNumBits ) );
+		}
+	}
+
+	void writeUnary( uint32_t numZeros )
+	{
+		while( numZeros >= 32 ) {
+			write( 0, 32 );
+			numZeros -= 32;
+		}
+		write( 1, numZeros + 1 );
+	}
+
+	void writeRice( int32_t value, uint32_t param )
+	{
+		uint32_t folded = ( uint32_t( value ) << 1 ) ^ uint32_t( value >> 31 );
+		writeUnary( folded >> param );
+		write( folded, param );
+	}
+
+	void writeUtf8( uint64_t value )
+	{
+		if( value < 0x80 ) {
+			write( uint32_t( value ), 8 );
+			return;
+		}
+
+		size_t numContinuationBytes = 1;
+		while( value >= ( uint64_t( 1 ) << ( 5 * numContinuationBytes + 6 ) ) )
+			numContinuationBytes++;
+
+		uint32_t leading = ( 0xFF00u >> ( numContinuationBytes + 1 ) ) & 0xFF;
+		write( leading | uint32_t( value >> ( 6 * numContinuationBytes ) ), 8 );
+		for( size_t i = numContinuationBytes; i > 0; i-- )
+			write( 0x80 | uint32_t( ( value >> ( 6 * ( i - 1 ) ) ) & 0x3F ), 8 );
+	}
+
+	void alignToByte()
+	{
+		if( mNumBits )
+			write( 0, 8 - mNumBits );
+	}
+
+  private:
+	vector<uint8_t>	*mBytes;
+	uint64_t		mAccum;
+	size_t			mNumBits;
+};
+
+uint8_t crc8( const uint8_t *data, size_t size )
+{
+	uint8_t crc = 0;
+	for( size_t i = 0; i < size; i++ ) {
+		crc ^= data[i];
+		for( int b = 0; b < 8; b++ )
+			crc = ( crc & 0x80 ) ? uint8_t( ( crc << 1 ) ^ 0x07 ) : uint8_t( crc << 1 );
+	}
+	return crc;
+}
+
+uint16_t crc16( const uint8_t *data, size_t size )
+{
+	uint16_t crc = 0;
+	for( size_t i = 0; i < size; i++ ) {
+		crc ^= uint16_t( data[i] ) << 8;
+		for( int b = 0; b < 8; b++ )
+			crc = ( crc & 0x8000 ) ? uint16_t( ( crc << 1 ) ^ 0x8005 ) : uint16_t( crc << 1 );
+	}
+	return crc;
+}
+
+uint32_t foldSigned( int32_t value )
+{
+	return ( uint32_t( value ) << 1 ) ^ uint32_t( value >> 31 );
+}
+
+// Returns the rice parameter that best codes \a numSamples values whose folded sum is \a sum.
+uint32_t computeRiceParam( uint64_t sum, size_t numSamples )
+{
+	uint32_t param = 0;
+	while( param < MAX_RICE_PARAM && ( uint64_t( numSamples ) << ( param + 1 ) ) < sum )
+		param++;
+
+	return param;
+}
+
+// Computes the residual of the fixed predictor of \a order (the first \a order samples are warm-up and left untouched).
+void computeFixedResidual( const int32_t *samples, size_t numSamples, size_t order, int32_t *residual )
+{
+	for( size_t i = order; i < numSamples; i++ ) {
+		const int32_t *s = samples + i;
+		switch( order ) {
+			case 0: residual[i] = s[0]; break;
+			case 1: residual[i] = s[0] - s[-1]; break;
+			case 2: residual[i] = s[0] - 2 * s[-1] + s[-2]; break;
+			case 3: residual[i] = s[0] - 3 * s[-1] + 3 * s[-2] - s[-3]; break;
+			case 4: residual[i] = s[0] - 4 * s[-1] + 6 * s[-2] - 4 * s[-3] + s[-4]; break;
+			default: CI_ASSERT_NOT_REACHABLE();
+		}
+	}
+}
+
+// The encoding chosen for one subframe.
+struct Subframe {
+	enum class Type { CONSTANT, VERBATIM, FIXED };
+
+	Type		mType;
+	size_t		mOrder, mPartitionOrder;
+	uint64_t	mNumBits;
+};
+
+// Finds the cheapest partition order for the residual of a predictor of \a order, returning its size in bits.
+uint64_t choosePartitionOrder( const int32_t *residual, size_t numSamples, size_t order, size_t *resultPartitionOrder )
+{
+	size_t maxPartitionOrder = 0;
+	while( maxPartitionOrder < MAX_PARTITION_ORDER && ( numSamples % ( size_t( 2 ) << maxPartitionOrder ) ) == 0
+			&& ( numSamples >> ( maxPartitionOrder + 1 ) ) > order )
+		maxPartitionOrder++;
+
+	// sums at the finest partitioning, which are then merged pairwise for the coarser ones.
+	vector<uint64_t> sums( size_t( 1 ) << maxPartitionOrder, 0 );
+	const size_t partitionSize = numSamples >> maxPartitionOrder;
+	for( size_t i = order; i < numSamples; i++ )
+		sums[i / partitionSize] += foldSigned( residual[i] );
+
+	uint64_t bestBits = numeric_limits<uint64_t>::max();
+	for( size_t partitionOrder = maxPartitionOrder + 1; partitionOrder-- > 0; ) {
+		const size_t numPartitions = size_t( 1 ) << partitionOrder;
+		uint64_t bits = 4 + 4 * numPartitions;
+		for( size_t p = 0; p < numPartitions; p++ ) {
+			size_t count = ( numSamples >> partitionOrder ) - ( p == 0 ? order : 0 );
+			uint32_t param = computeRiceParam( sums[p], count );
+			bits += count * ( param + 1 ) + ( sums[p] >> param );
+		}
+
+		if( bits < bestBits ) {
+			bestBits = bits;
+			*resultPartitionOrder = partitionOrder;
+		}
+
+		for( size_t p = 0; p < numPartitions / 2; p++ )
+			sums[p] = sums[2 * p] + sums[2 * p + 1];
+	}
+
+	return bestBits;
+}
+
+Subframe analyzeSubframe( const int32_t *samples, size_t numSamples, size_t bitsPerSample, vector<int32_t> *residual )
+{
+	Subframe result;
+	result.mType = Subframe::Type::CONSTANT;
+	result.mOrder = result.mPartitionOrder = 0;
+	result.mNumBits = 8 + bitsPerSample;
+
+	bool constant = true;
+	for( size_t i = 1; i < numSamples && constant; i++ )
+		constant = samples[i] == samples[0];
+
+	if( constant )
+		return result;
+
+	result.mType = Subframe::Type::VERBATIM;
+	result.mNumBits = 8 + numSamples * bitsPerSample;
+
+	residual->resize( numSamples );
+	for( size_t order = 0; order <= MAX_FIXED_ORDER && order < numSamples; order++ ) {
+		computeFixedResidual( samples, numSamples, order, residual->data() );
+
+		size_t partitionOrder = 0;
+		uint64_t numBits = 8 + order * bitsPerSample + choosePartitionOrder( residual->data(), numSamples, order, &partitionOrder );
+		if( numBits < result.mNumBits ) {
+			result.mType = Subframe::Type::FIXED;
+			result.mOrder = order;
+			result.mPartitionOrder = partitionOrder;
+			result.mNumBits = numBits;
+		}
+	}
+
+	return result;
+}
+
+void writeSubframe( BitWriter *writer, const Subframe &subframe, const int32_t *samples, size_t numSamples, size_t bitsPerSample, vector<int32_t> *residual )
+{
+	switch( subframe.mType ) {
+		case Subframe::Type::CONSTANT:
+			writer->write( 0, 8 );
+			writer->write( uint32_t( samples[0] ), bitsPerSample );
+			break;
+		case Subframe::Type::VERBATIM:
+			writer->write( 0x01 << 1, 8 );
+			for( size_t i = 0; i < numSamples; i++ )
+				writer->write( uint32_t( samples[i] ), bitsPerSample );
+			break;
+		case Subframe::Type::FIXED: {
+			const size_t order = subframe.mOrder;
+			writer->write( uint32_t( 0x08 | order ) << 1, 8 );
+			for( size_t i = 0; i < order; i++ )
+				writer->write( uint32_t( samples[i] ), bitsPerSample );
+
+			residual->resize( numSamples );
+			computeFixedResidual( samples, numSamples, order, residual->data() );
+
+			// residual coding method 0 (4-bit rice parameters), followed by the partitions
+			writer->write( 0, 2 );
+			writer->write( uint32_t( subframe.mPartitionOrder ), 4 );
+
+			const size_t numPartitions = size_t( 1 ) << subframe.mPartitionOrder;
+			const size_t partitionSize = numSamples >> subframe.mPartitionOrder;
+			for( size_t p = 0; p < numPartitions; p++ ) {
+				size_t begin = ( p == 0 ) ? order : p * partitionSize;
+				size_t end = ( p + 1 ) * partitionSize;
+
+				uint64_t sum = 0;
+				for( size_t i = begin; i < end; i++ )
+					sum += foldSigned( (*residual)[i] );
+
+				uint32_t param = computeRiceParam( sum, end - begin );
+				writer->write( param, 4 );
+				for( size_t i = begin; i < end; i++ )
+					writer->writeRice( (*residual)[i], param );
+			}
+			break;
+		}
+		default: CI_ASSERT_NOT_REACHABLE();
+	}
+}
+
+uint32_t getSampleRateCode( size_t sampleRate )
+{
+	switch( sampleRate ) {
+		case 88200:		return 1;
+		case 176400:	return 2;
+		case 192000:	return 3;
+		case 8000:		return 4;
+		case 16000:		return 5;
+		case 22050:		return 6;
+		case 24000:		return 7;
+		case 32000:		return 8;
+		case 44100:		return 9;
+		case 48000:		return 10;
+		case 96000:		return 11;
+		default:		return 0; // read from STREAMINFO
+	}
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - TargetFileFlac
+// ----------------------------------------------------------------------------------------------------
+
+TargetFileFlac::TargetFileFlac( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType )
+	: TargetFile( dataTarget, sampleRate, numChannels, sampleType ), mNumBlockFrames( 0 ), mNumFramesTotal( 0 ), mFrameNumber( 0 ),
+		mMinFrameBytes( 0 ), mMaxFrameBytes( 0 )
+{
+	if( numChannels < 1 || numChannels > 8 )
+		throw AudioFileExc( "FLAC supports between 1 and 8 channels" );
+	if( sampleRate < 1 || sampleRate >= ( 1 << 20 ) )
+		throw AudioFileExc( "sample rate out of range for FLAC" );
+
+	// FLOAT_32 is stored as 24 bit integers, since FLAC has no floating point format.
+	mBitsPerSample = ( sampleType == SampleType::INT_16 ) ? 16 : 24;
+	mBlock.resize( numChannels, vector<int32_t>( BLOCK_SIZE ) );
+
+	mStream = dataTarget->getStream();
+	mStream->writeData( "fLaC", 4 );
+	mStreamInfoOffset = mStream->tell();
+	writeStreamInfo();
+}
+
+TargetFileFlac::~TargetFileFlac()
+{
+	try {
+		if( mNumBlockFrames )
+			writeFrame();
+
+		// go back and fill in the total length and frame sizes, now that they are known.
+		off_t endOffset = mStream->tell();
+		mStream->seekAbsolute( mStreamInfoOffset );
+		writeStreamInfo();
+		mStream->seekAbsolute( endOffset );
+	}
+	catch( ... ) {
+		CI_LOG_E( "failed to finalize FLAC stream" );
+	}
+}
+
+void TargetFileFlac::writeStreamInfo()
+{
+	vector<uint8_t> bytes;
+	BitWriter writer( &bytes );
+
+	// metadata block header: last block flag, type 0 (STREAMINFO), length
+	writer.write( 1, 1 );
+	writer.write( 0, 7 );
+	writer.write( 34, 24 );
+
+	// the last block may be shorter, which STREAMINFO's minimum block size doesn't account for (unless it is the only one)
+	uint32_t blockSize = uint32_t( mFrameNumber > 1 ? BLOCK_SIZE : max<uint64_t>( mNumFramesTotal, 16 ) );
+	writer.write( min<uint32_t>( blockSize, BLOCK_SIZE ), 16 );
+	writer.write( min<uint32_t>( blockSize, BLOCK_SIZE ), 16 );
+	writer.write( uint32_t( mMinFrameBytes ), 24 );
+	writer.write( uint32_t( mMaxFrameBytes ), 24 );
+	writer.write( uint32_t( mSampleRate ), 20 );
+	writer.write( uint32_t( mNumChannels - 1 ), 3 );
+	writer.write( uint32_t( mBitsPerSample - 1 ), 5 );
+	writer.write( uint32_t( mNumFramesTotal >> 32 ), 4 );
+	writer.write( uint32_t( mNumFramesTotal ), 32 );
+
+	// MD5 signature, zero means it wasn't computed
+	for( size_t i = 0; i < 4; i++ )
+		writer.write( 0, 32 );
+
+	mStream->writeData( bytes.data(), bytes.size() );
+}
+
+void TargetFileFlac::performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset )
+{
+	const float scale = float( 1 << ( mBitsPerSample - 1 ) );
+	const int32_t maxValue = ( 1 << ( mBitsPerSample - 1 ) ) - 1;
+	const int32_t minValue = - ( 1 << ( mBitsPerSample - 1 ) );
+
+	size_t readFrames = 0;
+	while( readFrames < numFrames ) {
+		size_t count = min( numFrames - readFrames, BLOCK_SIZE - mNumBlockFrames );
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			const float *channel = buffer->getChannel( ch ) + frameOffset + readFrames;
+			int32_t *block = mBlock[ch].data() + mNumBlockFrames;
+			for( size_t i = 0; i < count; i++ )
+				block[i] = constrain( int32_t( lround( channel[i] * scale ) ), minValue, maxValue );
+		}
+
+		mNumBlockFrames += count;
+		readFrames += count;
+
+		if( mNumBlockFrames == BLOCK_SIZE )
+			writeFrame();
+	}
+}
+
+void TargetFileFlac::writeFrame()
+{
+	const size_t numSamples = mNumBlockFrames;
+
+	mFrameBytes.clear();
+	BitWriter writer( &mFrameBytes );
+
+	vector<const int32_t *> channels( mNumChannels );
+	vector<size_t> channelBits( mNumChannels, mBitsPerSample );
+	vector<Subframe> subframes( mNumChannels );
+	uint32_t channelAssignment = uint32_t( mNumChannels - 1 );
+
+	if( mNumChannels == 2 ) {
+		// pick the cheapest of independent, left / side, side / right and mid / side coding.
+		const int32_t *left = mBlock[0].data();
+		const int32_t *right = mBlock[1].data();
+		mMid.resize( numSamples );
+		mSide.resize( numSamples );
+		for( size_t i = 0; i < numSamples; i++ ) {
+			mMid[i] = ( left[i] + right[i] ) >> 1;
+			mSide[i] = left[i] - right[i];
+		}
+
+		Subframe leftSubframe = analyzeSubframe( left, numSamples, mBitsPerSample, &mResidual );
+		Subframe rightSubframe = analyzeSubframe( right, numSamples, mBitsPerSample, &mResidual );
+		Subframe midSubframe = analyzeSubframe( mMid.data(), numSamples, mBitsPerSample, &mResidual );
+		Subframe sideSubframe = analyzeSubframe( mSide.data(), numSamples, mBitsPerSample + 1, &mResidual );
+
+		uint64_t independentBits = leftSubframe.mNumBits + rightSubframe.mNumBits;
+		uint64_t leftSideBits = leftSubframe.mNumBits + sideSubframe.mNumBits;
+		uint64_t sideRightBits = sideSubframe.mNumBits + rightSubframe.mNumBits;
+		uint64_t midSideBits = midSubframe.mNumBits + sideSubframe.mNumBits;
+		uint64_t minBits = min( min( independentBits, leftSideBits ), min( sideRightBits, midSideBits ) );
+
+		if( minBits == independentBits ) {
+			channels = { left, right };
+			subframes = { leftSubframe, rightSubframe };
+		}
+		else if( minBits == leftSideBits ) {
+			channelAssignment = 8;
+			channels = { left, mSide.data() };
+			subframes = { leftSubframe, sideSubframe };
+			channelBits[1]++;
+		}
+		else if( minBits == sideRightBits ) {
+			channelAssignment = 9;
+			channels = { mSide.data(), right };
+			subframes = { sideSubframe, rightSubframe };
+			channelBits[0]++;
+		}
+		else {
+			channelAssignment = 10;
+			channels = { mMid.data(), mSide.data() };
+			subframes = { midSubframe, sideSubframe };
+			channelBits[1]++;
+		}
+	}
+	else {
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			channels[ch] = mBlock[ch].data();
+			subframes[ch] = analyzeSubframe( channels[ch], numSamples, mBitsPerSample, &mResidual );
+		}
+	}
+
+	// frame header: sync code, fixed blocking strategy
+	writer.write( 0x3FFE, 14 );
+	writer.write( 0, 1 );
+	writer.write( 0, 1 );
+	writer.write( numSamples == BLOCK_SIZE ? 12 : 7, 4 ); // 12: 256 * 2^(12-8) = 4096, 7: 16-bit (blocksize - 1) at the end of the header
+	const uint32_t sampleRateCode = getSampleRateCode( mSampleRate );
+	writer.write( sampleRateCode, 4 );
+	writer.write( channelAssignment, 4 );
+	writer.write( mBitsPerSample == 16 ? 4 : 6, 3 );
+	writer.write( 0, 1 );
+	writer.writeUtf8( mFrameNumber );
+	if( numSamples != BLOCK_SIZE )
+		writer.write( uint32_t( numSamples - 1 ), 16 );
+
+	writer.write( crc8( mFrameBytes.data(), mFrameBytes.size() ), 8 );
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		writeSubframe( &writer, subframes[ch], channels[ch], numSamples, channelBits[ch], &mResidual );
+
+	writer.alignToByte();
+	writer.write( crc16( mFrameBytes.data(), mFrameBytes.size() ), 16 );
+
+	mStream->writeData( mFrameBytes.data(), mFrameBytes.size() );
+
+	const size_t frameBytes = mFrameBytes.size();
+	mMinFrameBytes = mFrameNumber == 0 ? frameBytes : min( mMinFrameBytes, frameBytes );
+	mMaxFrameBytes = max( mMaxFrameBytes, frameBytes );
+	mNumFramesTotal += numSamples;
+	mFrameNumber++;
+	mNumBlockFrames = 0;
+}
+
+} } // namespace cinder::audio
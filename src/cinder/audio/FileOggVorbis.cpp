@@ -24,13 +24,106 @@
 #include "cinder/audio/FileOggVorbis.h"
 #include "cinder/audio/dsp/Converter.h"
 #include "cinder/audio/Exception.h"
+#include "cinder/Log.h"
+#include "cinder/Utilities.h"
 
+#include <algorithm>
+#include <chrono>
 #include <sstream>
+#include <thread>
 
 using namespace std;
 
 namespace cinder { namespace audio {
 
+namespace {
+
+const uint32_t	SEEK_INDEX_MAGIC = 0x564f4943; // 'CIOV'
+const uint32_t	SEEK_INDEX_VERSION = 1;
+const size_t	SEEK_INDEX_READ_BYTES = 65536;
+// decoding chunks shorter than this isn't worth the cost of opening another decoder and seeking.
+const size_t	MIN_PARALLEL_CHUNK_FRAMES = 44100 * 4;
+
+void writeUInt64( const OStreamRef &stream, uint64_t value )
+{
+	stream->writeLittle( uint32_t( value ) );
+	stream->writeLittle( uint32_t( value >> 32 ) );
+}
+
+uint64_t readUInt64( const IStreamRef &stream )
+{
+	uint32_t low, high;
+	stream->readLittle( &low );
+	stream->readLittle( &high );
+	return uint64_t( low ) | ( uint64_t( high ) << 32 );
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SeekIndexOggVorbis
+// ----------------------------------------------------------------------------------------------------
+
+// static
+SeekIndexOggVorbisRef SeekIndexOggVorbis::read( const DataSourceRef &dataSource )
+{
+	auto result = make_shared<SeekIndexOggVorbis>();
+
+	try {
+		IStreamRef stream = dataSource->createStream();
+
+		uint32_t magic, version;
+		stream->readLittle( &magic );
+		stream->readLittle( &version );
+		if( magic != SEEK_INDEX_MAGIC || version != SEEK_INDEX_VERSION )
+			throw AudioFileExc( "not an Ogg Vorbis seek index or unsupported version" );
+
+		result->mFileSize = readUInt64( stream );
+		result->mNumFrames = readUInt64( stream );
+		uint64_t numPages = readUInt64( stream );
+		if( numPages * 16 > uint64_t( stream->size() ) )
+			throw AudioFileExc( "Ogg Vorbis seek index is truncated" );
+
+		result->mPages.resize( size_t( numPages ) );
+		for( auto &page : result->mPages ) {
+			page.mByteOffset = readUInt64( stream );
+			page.mEndFrame = readUInt64( stream );
+		}
+	}
+	catch( StreamExc &exc ) {
+		throw AudioFileExc( string( "failed to read Ogg Vorbis seek index: " ) + exc.what() );
+	}
+
+	return result;
+}
+
+void SeekIndexOggVorbis::write( const DataTargetRef &dataTarget ) const
+{
+	OStreamRef stream = dataTarget->getStream();
+	stream->writeLittle( SEEK_INDEX_MAGIC );
+	stream->writeLittle( SEEK_INDEX_VERSION );
+	writeUInt64( stream, mFileSize );
+	writeUInt64( stream, mNumFrames );
+	writeUInt64( stream, mPages.size() );
+
+	for( const auto &page : mPages ) {
+		writeUInt64( stream, page.mByteOffset );
+		writeUInt64( stream, page.mEndFrame );
+	}
+}
+
+int SeekIndexOggVorbis::findSeekPage( uint64_t frame ) const
+{
+	// Decoding can't start on the page that completes frame, since the packet continued from the previous page is
+	// dropped and the first whole packet only primes the decoder's overlap.
+	auto it = upper_bound( mPages.begin(), mPages.end(), frame, []( uint64_t f, const Page &page ) { return f < page.mEndFrame; } );
+	return int( it - mPages.begin() ) - 1;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SourceFileOggVorbis
+// ----------------------------------------------------------------------------------------------------
+
 SourceFileOggVorbis::SourceFileOggVorbis()
 	: SourceFile( 0 )
 {}
@@ -45,6 +138,8 @@ SourceFileOggVorbis::SourceFileOggVorbis( const DataSourceRef &dataSource, size_
 SourceFileRef SourceFileOggVorbis::cloneWithSampleRate( size_t sampleRate ) const
 {
 	auto result = make_shared<SourceFileOggVorbis>( mDataSource, sampleRate );
+	result->mConverterQuality = mConverterQuality;
+	result->mSeekIndex = mSeekIndex;
 	result->setupSampleRateConversion();
 
 	return result;
@@ -118,10 +213,138 @@ size_t SourceFileOggVorbis::performRead( Buffer *buffer, size_t bufferFrameOffse
 
 void SourceFileOggVorbis::performSeek( size_t readPositionFrames )
 {
+	if( mSeekIndex ) {
+		// ov_raw_seek() resolves the position of the page it lands on, so all that's left is to decode forward to the exact frame.
+		// If a page holds too few packets, decoding begins after readPositionFrames and the page before is tried.
+		const auto &pages = mSeekIndex->getPages();
+		const int seekPage = mSeekIndex->findSeekPage( readPositionFrames );
+		for( int page = seekPage; page >= 0 && page >= seekPage - 2; page-- ) {
+			if( ov_raw_seek( &mOggVorbisFile, (ogg_int64_t)pages[page].mByteOffset ) != 0 )
+				break;
+
+			ogg_int64_t pos = ov_pcm_tell( &mOggVorbisFile );
+			if( pos < 0 || pos > (ogg_int64_t)readPositionFrames )
+				continue;
+
+			size_t numSkipFrames = readPositionFrames - size_t( pos );
+			while( numSkipFrames ) {
+				float **outChannels;
+				int section;
+				long outNumFrames = ov_read_float( &mOggVorbisFile, &outChannels, int( min<size_t>( numSkipFrames, 4096 ) ), &section );
+				if( outNumFrames <= 0 )
+					break;
+
+				numSkipFrames -= outNumFrames;
+			}
+
+			if( ! numSkipFrames )
+				return;
+
+			break;
+		}
+	}
+
 	int status = ov_pcm_seek( &mOggVorbisFile, (ogg_int64_t)readPositionFrames );
 	CI_VERIFY( status == 0 );
 }
 
+uint64_t SourceFileOggVorbis::getFileSize() const
+{
+	return uint64_t( ov_raw_total( const_cast<OggVorbis_File *>( &mOggVorbisFile ), -1 ) );
+}
+
+SeekIndexOggVorbisRef SourceFileOggVorbis::buildSeekIndex()
+{
+	if( ov_streams( &mOggVorbisFile ) != 1 )
+		throw AudioFileExc( "Ogg Vorbis seek index only supports files with one logical stream" );
+
+	auto result = make_shared<SeekIndexOggVorbis>();
+	result->mFileSize = getFileSize();
+	result->mNumFrames = mFileNumFrames;
+
+	// scan the pages with a separate stream, so that the decoder's position is left untouched.
+	IStreamRef stream = mDataSource->createStream();
+	const int serialNumber = ov_serialnumber( &mOggVorbisFile, -1 );
+	const ogg_int64_t granuleOffset = mOggVorbisFile.pcmlengths[0];
+
+	ogg_sync_state syncState;
+	ogg_sync_init( &syncState );
+
+	uint64_t pageOffset = 0;
+	bool eof = false;
+	while( true ) {
+		ogg_page page;
+		long pageSize = ogg_sync_pageseek( &syncState, &page );
+		if( pageSize < 0 ) {
+			// skipped bytes that weren't part of a page
+			pageOffset += uint64_t( -pageSize );
+		}
+		else if( pageSize > 0 ) {
+			ogg_int64_t granulePos = ogg_page_granulepos( &page );
+			if( granulePos > 0 && ogg_page_serialno( &page ) == serialNumber ) {
+				uint64_t endFrame = uint64_t( max<ogg_int64_t>( 0, granulePos - granuleOffset ) );
+				result->mPages.push_back( { pageOffset, min<uint64_t>( endFrame, mFileNumFrames ) } );
+			}
+			pageOffset += uint64_t( pageSize );
+		}
+		else {
+			if( eof )
+				break;
+
+			char *buffer = ogg_sync_buffer( &syncState, long( SEEK_INDEX_READ_BYTES ) );
+			size_t bytesRead = stream->readDataAvailable( buffer, SEEK_INDEX_READ_BYTES );
+			ogg_sync_wrote( &syncState, long( bytesRead ) );
+			eof = bytesRead == 0;
+		}
+	}
+
+	ogg_sync_clear( &syncState );
+
+	mSeekIndex = result;
+	return result;
+}
+
+void SourceFileOggVorbis::setSeekIndex( const SeekIndexOggVorbisRef &seekIndex )
+{
+	if( seekIndex && ( seekIndex->getFileSize() != getFileSize() || seekIndex->getNumFrames() != mFileNumFrames ) )
+		throw AudioFileExc( "Ogg Vorbis seek index doesn't match the file" );
+
+	mSeekIndex = seekIndex;
+}
+
+BufferRef SourceFileOggVorbis::loadBufferParallel( size_t numThreads )
+{
+	if( mConverter )
+		return loadBuffer();
+
+	if( ! mSeekIndex )
+		buildSeekIndex();
+
+	if( ! numThreads )
+		numThreads = max<size_t>( 1, thread::hardware_concurrency() );
+
+	const size_t numFrames = mNumFrames;
+	const size_t numChunks = max<size_t>( 1, min( numThreads, numFrames / MIN_PARALLEL_CHUNK_FRAMES ) );
+	BufferRef result = make_shared<Buffer>( numFrames, mNumChannels );
+
+	// each chunk is decoded with its own decoder directly into its region of result, seeking to the start of the chunk with the shared index.
+	ci::parallelFor( numChunks, [&]( size_t chunk ) {
+		size_t beginFrame = numFrames * chunk / numChunks;
+		size_t endFrame = numFrames * ( chunk + 1 ) / numChunks;
+
+		SourceFileOggVorbis source( mDataSource, 0 );
+		source.mSeekIndex = mSeekIndex;
+		if( beginFrame )
+			source.performSeek( beginFrame );
+
+		size_t numRead = source.performRead( result.get(), beginFrame, endFrame - beginFrame );
+		if( numRead != endFrame - beginFrame )
+			throw AudioFileExc( "Ogg Vorbis decoding ended early" );
+	}, numChunks );
+
+	return result;
+}
+
 string SourceFileOggVorbis::getMetaData() const
 {
 	ostringstream str;
@@ -182,4 +405,86 @@ long SourceFileOggVorbis::tellFn( void *datasource )
 	return static_cast<long>( sourceFile->mStream->tell() );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - TargetFileOggVorbis
+// ----------------------------------------------------------------------------------------------------
+
+TargetFileOggVorbis::TargetFileOggVorbis( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType, float quality )
+	: TargetFile( dataTarget, sampleRate, numChannels, sampleType ), mQuality( quality )
+{
+	mStream = dataTarget->getStream();
+
+	vorbis_info_init( &mVorbisInfo );
+	int status = vorbis_encode_init_vbr( &mVorbisInfo, long( numChannels ), long( sampleRate ), quality );
+	if( status ) {
+		vorbis_info_clear( &mVorbisInfo );
+		throw AudioFileExc( "Failed to initialize Ogg Vorbis encoder with error: ", (int32_t)status );
+	}
+
+	vorbis_comment_init( &mVorbisComment );
+	vorbis_comment_add_tag( &mVorbisComment, "ENCODER", "libcinder" );
+
+	vorbis_analysis_init( &mVorbisDspState, &mVorbisInfo );
+	vorbis_block_init( &mVorbisDspState, &mVorbisBlock );
+
+	// the serial number only needs to be unique within a (chained) physical stream
+	ogg_stream_init( &mOggStream, int( chrono::steady_clock::now().time_since_epoch().count() ) );
+
+	ogg_packet header, headerComment, headerCode;
+	vorbis_analysis_headerout( &mVorbisDspState, &mVorbisComment, &header, &headerComment, &headerCode );
+	ogg_stream_packetin( &mOggStream, &header );
+	ogg_stream_packetin( &mOggStream, &headerComment );
+	ogg_stream_packetin( &mOggStream, &headerCode );
+
+	// the headers must be on their own pages, so audio data begins on a fresh page.
+	writePages( true );
+}
+
+TargetFileOggVorbis::~TargetFileOggVorbis()
+{
+	// signal the end of the stream and write out what is left.
+	vorbis_analysis_wrote( &mVorbisDspState, 0 );
+	try {
+		writePages( false );
+	}
+	catch( ... ) {
+		CI_LOG_E( "failed to finalize Ogg Vorbis stream" );
+	}
+
+	ogg_stream_clear( &mOggStream );
+	vorbis_block_clear( &mVorbisBlock );
+	vorbis_dsp_clear( &mVorbisDspState );
+	vorbis_comment_clear( &mVorbisComment );
+	vorbis_info_clear( &mVorbisInfo );
+}
+
+void TargetFileOggVorbis::performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset )
+{
+	float **analysisBuffer = vorbis_analysis_buffer( &mVorbisDspState, int( numFrames ) );
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		memcpy( analysisBuffer[ch], buffer->getChannel( ch ) + frameOffset, numFrames * sizeof( float ) );
+
+	vorbis_analysis_wrote( &mVorbisDspState, int( numFrames ) );
+	writePages( false );
+}
+
+// Encodes all blocks that are ready and writes the resulting ogg pages to mStream. If \a flush is true, a page is forced even if it isn't full.
+void TargetFileOggVorbis::writePages( bool flush )
+{
+	ogg_packet packet;
+	while( vorbis_analysis_blockout( &mVorbisDspState, &mVorbisBlock ) == 1 ) {
+		vorbis_analysis( &mVorbisBlock, nullptr );
+		vorbis_bitrate_addblock( &mVorbisBlock );
+
+		while( vorbis_bitrate_flushpacket( &mVorbisDspState, &packet ) )
+			ogg_stream_packetin( &mOggStream, &packet );
+	}
+
+	ogg_page page;
+	while( flush ? ogg_stream_flush( &mOggStream, &page ) : ogg_stream_pageout( &mOggStream, &page ) ) {
+		mStream->writeData( page.header, page.header_len );
+		mStream->writeData( page.body, page.body_len );
+	}
+}
+
 } } // namespace cinder::audio
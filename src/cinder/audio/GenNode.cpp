@@ -24,6 +24,7 @@
 #include "cinder/audio/GenNode.h"
 #include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
+#include "cinder/audio/dsp/Simd.h"
 #include "cinder/CinderMath.h"
 #include "cinder/Rand.h"
 
@@ -374,4 +375,290 @@ void GenPulseNode::process( Buffer *buffer )
 	dsp::sub( outputData, data2, outputData, numFrames );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - GenOscBankNode
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Converts phase increments in cycles per sample to 32-bit fixed point. Whole cycles wrap, so only the fractional part is converted,
+// which keeps frequencies at or above the nyquist in range. Half of it is converted and then doubled, since a full cycle doesn't fit in an int32.
+inline dsp::Int4 toPhaseIncr( const dsp::Float4 &cycles )
+{
+	const dsp::Float4 fraction = cycles - dsp::Int4::fromFloat( cycles ).toFloat();
+	const dsp::Int4 halfIncr = dsp::Int4::fromFloat( fraction * 2147483648.0f );
+	return halfIncr + halfIncr;
+}
+
+} // anonymous namespace
+
+GenOscBankNode::GenOscBankNode( size_t numOscillators, WaveformType waveformType, const Format &format )
+	: InputNode( format ), mNumOscillators( 0 ), mFreqScale( this, 1 ), mWaveformType( waveformType ), mPhaseIncrScale( 0 )
+{
+	setChannelMode( ChannelMode::SPECIFIED );
+	setNumChannels( 1 );
+
+	resizeImpl( numOscillators );
+}
+
+void GenOscBankNode::initialize()
+{
+	mAccumulator.setNumFrames( getFramesPerBlock() * 4 );
+
+	// phases are stored in 32-bit fixed point, where one cycle is 2^32 and wrapping happens on overflow. Increments are computed in cycles per sample.
+	size_t sampleRate = getSampleRate();
+	mPhaseIncrScale = 1.0 / (double)sampleRate;
+
+	bool needsFill = false;
+	if( ! mWaveTable ) {
+		mWaveTable.reset( new WaveTable2d( sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
+		needsFill = true;
+	}
+	else if( sampleRate != mWaveTable->getSampleRate() )
+		needsFill = true;
+
+	if( needsFill )
+		mWaveTable->fillBandlimited( mWaveformType );
+}
+
+void GenOscBankNode::setNumOscillators( size_t numOscillators )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	resizeImpl( numOscillators );
+}
+
+void GenOscBankNode::setFreq( size_t index, float freq )
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mFreqs[index] = freq;
+}
+
+float GenOscBankNode::getFreq( size_t index ) const
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	return mFreqs[index];
+}
+
+void GenOscBankNode::setGain( size_t index, float gain )
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mGains[index] = gain;
+}
+
+float GenOscBankNode::getGain( size_t index ) const
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	return mGains[index];
+}
+
+void GenOscBankNode::setPhase( size_t index, float phase )
+{
+	CI_ASSERT( index < mNumOscillators );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mPhases[index] = uint32_t( fract( phase ) * 4294967296.0 );
+}
+
+void GenOscBankNode::setFreqs( const float *freqs, size_t count, size_t offset )
+{
+	CI_ASSERT( offset + count <= mNumOscillators );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	memcpy( mFreqs.data() + offset, freqs, count * sizeof( float ) );
+}
+
+void GenOscBankNode::setGains( const float *gains, size_t count, size_t offset )
+{
+	CI_ASSERT( offset + count <= mNumOscillators );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	memcpy( mGains.data() + offset, gains, count * sizeof( float ) );
+}
+
+void GenOscBankNode::setModulationFn( const ModulationFn &modulationFn )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mModulationFn = modulationFn;
+}
+
+void GenOscBankNode::setWaveform( WaveformType waveformType )
+{
+	if( mWaveformType == waveformType )
+		return;
+
+	if( ! isInitialized() )
+		getContext()->initializeNode( shared_from_this() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mWaveformType = waveformType;
+	mWaveTable->fillBandlimited( waveformType );
+}
+
+void GenOscBankNode::resizeImpl( size_t numOscillators )
+{
+	const size_t numPadded = ( numOscillators + 3 ) & ~size_t( 3 );
+
+	mPhases.resize( numPadded, 0 );
+	mFreqs.resize( numPadded, 0 );
+	mGains.resize( numPadded, 0 );
+	mGainsCurrent.resize( numPadded, 0 );
+	mFreqsBlock.resize( numPadded );
+	mGainsBlock.resize( numPadded );
+	mTables.resize( numPadded );
+
+	// when shrinking, silence the oscillators that are now padding.
+	for( size_t i = numOscillators; i < numPadded; i++ ) {
+		mFreqs[i] = 0;
+		mGains[i] = 0;
+		mGainsCurrent[i] = 0;
+	}
+
+	mNumOscillators = numOscillators;
+}
+
+void GenOscBankNode::process( Buffer *buffer )
+{
+	const auto &frameRange = getProcessFramesRange();
+	const size_t numFrames = frameRange.second - frameRange.first;
+	float *outputData = buffer->getData() + frameRange.first;
+	const size_t numPadded = mFreqs.size();
+
+	const float *freqScaleArray = nullptr;
+	float freqScale = 1;
+	float maxFreqScale;
+	if( mFreqScale.eval() ) {
+		freqScaleArray = mFreqScale.getValueArray() + frameRange.first;
+		maxFreqScale = 0;
+		for( size_t i = 0; i < numFrames; i++ )
+			maxFreqScale = max( maxFreqScale, fabsf( freqScaleArray[i] ) );
+	}
+	else {
+		freqScale = mFreqScale.getValue();
+		maxFreqScale = fabsf( freqScale );
+	}
+
+	// modulation is applied to copies, so that the user values are used again next block
+	if( numPadded ) {
+		memcpy( mFreqsBlock.data(), mFreqs.data(), numPadded * sizeof( float ) );
+		memcpy( mGainsBlock.data(), mGains.data(), numPadded * sizeof( float ) );
+	}
+	if( mModulationFn )
+		mModulationFn( mFreqsBlock.data(), mGainsBlock.data(), mNumOscillators );
+
+	// choose tables by the highest frequency each oscillator reaches this block, so that it doesn't alias
+	for( size_t i = 0; i < numPadded; i++ )
+		mTables[i] = mWaveTable->getBandLimitedTable( mFreqsBlock[i] * maxFreqScale );
+
+	float *accumulator = mAccumulator.getData();
+	dsp::fill( 0.0f, accumulator, numFrames * 4 );
+
+	const size_t tableSize = mWaveTable->getTableSize();
+	for( size_t group = 0; group < numPadded / 4; group++ )
+		renderGroup( group, accumulator, numFrames, tableSize, freqScaleArray, freqScale );
+
+	for( size_t i = 0; i < numFrames; i++ )
+		outputData[i] = dsp::Float4::load( accumulator + i * 4 ).sum();
+
+	if( numPadded )
+		memcpy( mGainsCurrent.data(), mGainsBlock.data(), numPadded * sizeof( float ) );
+}
+
+// Renders four oscillators into the interleaved accumulator, each lane holding one oscillator.
+// Table indices are the top bits of the fixed-point phase and the remaining bits are the interpolation factor.
+void GenOscBankNode::renderGroup( size_t group, float *accumulator, size_t numFrames, size_t tableSize, const float *freqScaleArray, float freqScale )
+{
+	CI_ASSERT( tableSize && ( tableSize & ( tableSize - 1 ) ) == 0 );
+
+	const size_t offset = group * 4;
+	uint32_t *phases = &mPhases[offset];
+	const dsp::Float4 phaseIncrs = dsp::Float4::load( &mFreqsBlock[offset] ) * float( mPhaseIncrScale );
+	const float *gainsBegin = &mGainsCurrent[offset];
+	const float *gainsEnd = &mGainsBlock[offset];
+
+	bool isSilent = true;
+	for( size_t k = 0; k < 4; k++ ) {
+		if( gainsBegin[k] != 0 || gainsEnd[k] != 0 ) {
+			isSilent = false;
+			break;
+		}
+	}
+
+	dsp::Int4 phase = dsp::Int4::load( phases );
+
+	// increments at the block's first freq scale are computed in double precision, so that phases don't drift away from the exact frequencies
+	// over long notes. Per sample increments add the change in freq scale since then, which is small enough to be accurate in single precision.
+	const float baseFreqScale = freqScaleArray ? freqScaleArray[0] : freqScale;
+	uint32_t baseIncrs[4];
+	for( size_t k = 0; k < 4; k++ ) {
+		const double cycles = double( mFreqsBlock[offset + k] ) * double( baseFreqScale ) * mPhaseIncrScale;
+		baseIncrs[k] = uint32_t( uint64_t( ( cycles - floor( cycles ) ) * 4294967296.0 ) );
+	}
+	const dsp::Int4 baseIncr = dsp::Int4::load( baseIncrs );
+	dsp::Int4 phaseIncr = baseIncr;
+
+	// silent oscillators only need to advance their phase
+	if( isSilent ) {
+		if( freqScaleArray ) {
+			for( size_t i = 0; i < numFrames; i++ )
+				phase += baseIncr + toPhaseIncr( phaseIncrs * ( freqScaleArray[i] - baseFreqScale ) );
+
+			phase.store( phases );
+		}
+		else {
+			uint32_t incrs[4];
+			phaseIncr.store( incrs );
+			for( size_t k = 0; k < 4; k++ )
+				phases[k] += incrs[k] * uint32_t( numFrames );
+		}
+		return;
+	}
+
+	int indexBits = 0;
+	while( ( size_t( 1 ) << indexBits ) < tableSize )
+		indexBits++;
+
+	const int fracBits = 32 - indexBits;
+	const uint32_t indexMask = uint32_t( tableSize - 1 );
+	const dsp::Int4 fracMask( uint32_t( ( uint64_t( 1 ) << fracBits ) - 1 ) );
+	const dsp::Float4 fracScale( float( 1.0 / double( uint64_t( 1 ) << fracBits ) ) );
+	const float *tables[4] = { mTables[offset], mTables[offset + 1], mTables[offset + 2], mTables[offset + 3] };
+
+	const dsp::Float4 gainBegin = dsp::Float4::load( gainsBegin );
+	const dsp::Float4 gainIncr = ( dsp::Float4::load( gainsEnd ) - gainBegin ) * ( 1.0f / (float)numFrames );
+	dsp::Float4 gain = gainBegin;
+
+	uint32_t indices[4];
+	float values1[4], values2[4];
+
+	for( size_t i = 0; i < numFrames; i++ ) {
+		if( freqScaleArray )
+			phaseIncr = baseIncr + toPhaseIncr( phaseIncrs * ( freqScaleArray[i] - baseFreqScale ) );
+
+		phase.shiftRight( fracBits ).store( indices );
+		for( size_t k = 0; k < 4; k++ ) {
+			values1[k] = tables[k][indices[k]];
+			values2[k] = tables[k][( indices[k] + 1 ) & indexMask];
+		}
+
+		const dsp::Float4 frac = ( phase & fracMask ).toFloat() * fracScale;
+		const dsp::Float4 value1 = dsp::Float4::load( values1 );
+		const dsp::Float4 value = value1 + ( dsp::Float4::load( values2 ) - value1 ) * frac;
+
+		float *acc = accumulator + i * 4;
+		( dsp::Float4::load( acc ) + value * gain ).store( acc );
+
+		gain += gainIncr;
+		phase += phaseIncr;
+	}
+
+	phase.store( phases );
+}
+
 } } // namespace cinder::audio
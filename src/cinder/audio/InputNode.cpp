@@ -104,6 +104,7 @@ void InputDeviceNode::markUnderrun()
 	CI_ASSERT( ctx );
 
 	mLastUnderrun = ctx->getNumProcessedFrames();
+	countUnderrun();
 }
 
 void InputDeviceNode::markOverrun()
@@ -113,6 +114,7 @@ void InputDeviceNode::markOverrun()
 	CI_ASSERT( ctx );
 
 	mLastOverrun = getContext()->getNumProcessedFrames();
+	countOverrun();
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -26,6 +26,9 @@
 #include "cinder/audio/dsp/Fft.h"
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+#include <condition_variable>
+
 using namespace std;
 using namespace ci;
 
@@ -49,6 +52,7 @@ void MonitorNode::initialize()
 	if( ! mWindowSize )
 		mWindowSize = getFramesPerBlock();
 
+	mRingBuffers.clear();
 	for( size_t ch = 0; ch < getNumChannels(); ch++ )
 		mRingBuffers.emplace_back( mWindowSize * mRingBufferPaddingFactor );
 
@@ -90,22 +94,133 @@ void MonitorNode::fillCopiedBuffer()
 	}
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpectrumAnalyzer
+// ----------------------------------------------------------------------------------------------------
+
+//! Background thread shared by all MonitorSpectralNode's with async analysis, which analyzes each new window as soon as it is available.
+class SpectrumAnalyzer {
+  public:
+	static shared_ptr<SpectrumAnalyzer> get();
+	~SpectrumAnalyzer();
+
+	void add( MonitorSpectralNode *monitor );
+	//! Blocks until \a monitor is no longer being analyzed.
+	void remove( MonitorSpectralNode *monitor );
+
+  private:
+	SpectrumAnalyzer();
+	void run();
+
+	vector<MonitorSpectralNode *>	mMonitors;
+	thread							mThread;
+	mutex							mMutex;
+	condition_variable				mWakeCond, mIdleCond;
+	bool							mShouldQuit;
+};
+
+namespace {
+
+const chrono::milliseconds		SPECTRUM_ANALYZER_POLL_INTERVAL( 4 );
+
+mutex							sSpectrumAnalyzerMutex;
+weak_ptr<SpectrumAnalyzer>		sSpectrumAnalyzer;
+
+} // anonymous namespace
+
+shared_ptr<SpectrumAnalyzer> SpectrumAnalyzer::get()
+{
+	lock_guard<mutex> lock( sSpectrumAnalyzerMutex );
+
+	auto result = sSpectrumAnalyzer.lock();
+	if( ! result ) {
+		result = shared_ptr<SpectrumAnalyzer>( new SpectrumAnalyzer );
+		sSpectrumAnalyzer = result;
+	}
+
+	return result;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+	: mShouldQuit( false )
+{
+	mThread = thread( &SpectrumAnalyzer::run, this );
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mShouldQuit = true;
+	}
+
+	mWakeCond.notify_all();
+	mThread.join();
+}
+
+void SpectrumAnalyzer::add( MonitorSpectralNode *monitor )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		monitor->mAnalysisBusy = false;
+		mMonitors.push_back( monitor );
+	}
+
+	mWakeCond.notify_one();
+}
+
+void SpectrumAnalyzer::remove( MonitorSpectralNode *monitor )
+{
+	unique_lock<mutex> lock( mMutex );
+	mIdleCond.wait( lock, [monitor] { return ! monitor->mAnalysisBusy; } );
+	mMonitors.erase( std::remove( mMonitors.begin(), mMonitors.end(), monitor ), mMonitors.end() );
+}
+
+void SpectrumAnalyzer::run()
+{
+	unique_lock<mutex> lock( mMutex );
+	while( ! mShouldQuit ) {
+		bool analyzedAny = false;
+		for( size_t i = 0; i < mMonitors.size(); i++ ) {
+			auto monitor = mMonitors[i];
+			if( ! monitor->isWindowAvailable() )
+				continue;
+
+			// analyze outside of the lock so that monitors can be added and removed meanwhile. remove() waits on mAnalysisBusy.
+			monitor->mAnalysisBusy = true;
+			lock.unlock();
+			monitor->analyzeAvailable();
+			lock.lock();
+			monitor->mAnalysisBusy = false;
+			mIdleCond.notify_all();
+			analyzedAny = true;
+		}
+
+		if( ! analyzedAny )
+			mWakeCond.wait_for( lock, SPECTRUM_ANALYZER_POLL_INTERVAL );
+	}
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - MonitorSpectralNode
 // ----------------------------------------------------------------------------------------------------
 
 MonitorSpectralNode::MonitorSpectralNode( const Format &format )
 	: MonitorNode( format ), mFftSize( format.getFftSize() ), mWindowType( format.getWindowType() ),
-		mSmoothingFactor( 0.5f ), mLastFrameMagSpectrumComputed( 0 )
+		mSmoothingFactor( 0.5f ), mLastFrameMagSpectrumComputed( 0 ), mNumAnalysesRead( 0 ), mIsAsyncAnalysis( format.isAsyncAnalysis() ),
+		mAnalysisBusy( false )
 {
 }
 
 MonitorSpectralNode::~MonitorSpectralNode()
 {
+	stopAnalysis();
 }
 
 void MonitorSpectralNode::initialize()
 {
+	stopAnalysis();
+
 	MonitorNode::initialize();
 
 	if( mFftSize < mWindowSize )
@@ -116,37 +231,124 @@ void MonitorSpectralNode::initialize()
 	mFft = unique_ptr<dsp::Fft>( new dsp::Fft( mFftSize ) );
 	mFftBuffer = audio::Buffer( mFftSize );
 	mBufferSpectral = audio::BufferSpectral( mFftSize );
-	mMagSpectrum.resize( mFftSize / 2 );
+	mWindowBuffer = audio::Buffer( mWindowSize, getNumChannels() );
+	mMagSpectrumSmoothed.assign( mFftSize / 2, 0.0f );
+	mLatestAnalysis.mMagSpectrum.assign( mFftSize / 2, 0.0f );
 
 	mWindowingTable = makeAlignedArray<float>( mWindowSize );
 	generateWindow( mWindowType, mWindowingTable.get(), mWindowSize );
+
+	if( mIsAsyncAnalysis ) {
+		mAnalyzer = SpectrumAnalyzer::get();
+		mAnalyzer->add( this );
+	}
+}
+
+void MonitorSpectralNode::uninitialize()
+{
+	stopAnalysis();
+}
+
+void MonitorSpectralNode::stopAnalysis()
+{
+	if( mAnalyzer ) {
+		mAnalyzer->remove( this );
+		mAnalyzer.reset();
+	}
 }
 
-// TODO: When getNumChannels() > 1, use generic channel converter.
-// - alternatively, this tap can force mono output, which only works if it isn't a tap but is really a leaf node (no output).
 const std::vector<float>& MonitorSpectralNode::getMagSpectrum()
 {
-	uint64_t numFramesProcessed = getContext()->getNumProcessedFrames();
-	if( mLastFrameMagSpectrumComputed == numFramesProcessed )
-		return mMagSpectrum;
+	if( ! mIsAsyncAnalysis ) {
+		uint64_t numFramesProcessed = getContext()->getNumProcessedFrames();
+		if( mLastFrameMagSpectrumComputed != numFramesProcessed ) {
+			mLastFrameMagSpectrumComputed = numFramesProcessed;
 
-	mLastFrameMagSpectrumComputed = numFramesProcessed;
+			MonitorNode::fillCopiedBuffer();
+			analyze( mCopiedBuffer );
+		}
+	}
 
-	fillCopiedBuffer();
+	updateLatestAnalysis();
+	return mLatestAnalysis.mMagSpectrum;
+}
+
+bool MonitorSpectralNode::copyLatestAnalysis( Buffer *buffer, std::vector<float> *magSpectrum ) const
+{
+	return mAnalysis.visit( [buffer, magSpectrum]( const Analysis &analysis ) {
+		if( buffer )
+			*buffer = analysis.mBuffer;
+		if( magSpectrum )
+			*magSpectrum = analysis.mMagSpectrum;
+	} );
+}
+
+void MonitorSpectralNode::fillCopiedBuffer()
+{
+	if( ! mIsAsyncAnalysis ) {
+		MonitorNode::fillCopiedBuffer();
+		return;
+	}
+
+	// the analysis thread is the only reader of the RingBuffer's, so use the window it last analyzed
+	updateLatestAnalysis();
+	if( mLatestAnalysis.mBuffer.getNumFrames() == mCopiedBuffer.getNumFrames() && mLatestAnalysis.mBuffer.getNumChannels() == mCopiedBuffer.getNumChannels() )
+		memcpy( mCopiedBuffer.getData(), mLatestAnalysis.mBuffer.getData(), mCopiedBuffer.getSize() * sizeof( float ) );
+}
+
+void MonitorSpectralNode::updateLatestAnalysis()
+{
+	uint64_t numAnalyses = mAnalysis.getNumPublished();
+	if( numAnalyses != mNumAnalysesRead ) {
+		mAnalysis.read( &mLatestAnalysis );
+		mNumAnalysesRead = numAnalyses;
+	}
+}
+
+bool MonitorSpectralNode::isWindowAvailable() const
+{
+	for( const auto &ringBuffer : mRingBuffers ) {
+		if( ringBuffer.getAvailableRead() < mWindowSize )
+			return false;
+	}
+
+	return ! mRingBuffers.empty();
+}
+
+void MonitorSpectralNode::analyzeAvailable()
+{
+	// if the analysis thread fell behind, skip to the most recent window so readers don't see stale results.
+	bool haveWindow = false;
+	while( isWindowAvailable() ) {
+		for( size_t ch = 0; ch < mWindowBuffer.getNumChannels(); ch++ )
+			mRingBuffers[ch].read( mWindowBuffer.getChannel( ch ), mWindowSize );
+
+		haveWindow = true;
+	}
+
+	if( haveWindow )
+		analyze( mWindowBuffer );
+}
+
+// TODO: When getNumChannels() > 1, use generic channel converter.
+// - alternatively, this tap can force mono output, which only works if it isn't a tap but is really a leaf node (no output).
+void MonitorSpectralNode::analyze( const Buffer &window )
+{
+	const size_t numChannels = window.getNumChannels();
 
 	// window the copied buffer and compute forward FFT transform
-	if( getNumChannels() > 1 ) {
+	if( numChannels > 1 ) {
 		// naive average of all channels
 		mFftBuffer.zero();
-		float scale = 1.0f / getNumChannels();
-		for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
+		float scale = 1.0f / numChannels;
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
 			for( size_t i = 0; i < mWindowSize; i++ )
-				mFftBuffer[i] += mCopiedBuffer.getChannel( ch )[i] * scale;
+				mFftBuffer[i] += window.getChannel( ch )[i] * scale;
 		}
 		dsp::mul( mFftBuffer.getData(), mWindowingTable.get(), mFftBuffer.getData(), mWindowSize );
 	}
 	else
-		dsp::mul( mCopiedBuffer.getData(), mWindowingTable.get(), mFftBuffer.getData(), mWindowSize );
+		dsp::mul( window.getData(), mWindowingTable.get(), mFftBuffer.getData(), mWindowSize );
 
 	mFft->forward( &mFftBuffer, &mBufferSpectral );
 
@@ -159,13 +361,20 @@ const std::vector<float>& MonitorSpectralNode::getMagSpectrum()
 	// compute normalized magnitude spectrum
 	// TODO: break this into vector cartesian -> polar and then vector lowpass. skip lowpass if smoothing factor is very small
 	const float magScale = 1.0f / mFft->getSize();
-	for( size_t i = 0; i < mMagSpectrum.size(); i++ ) {
+	const float smoothingFactor = mSmoothingFactor;
+	for( size_t i = 0; i < mMagSpectrumSmoothed.size(); i++ ) {
 		float re = real[i];
 		float im = imag[i];
-		mMagSpectrum[i] = mMagSpectrum[i] * mSmoothingFactor + std::sqrt( re * re + im * im ) * magScale * ( 1 - mSmoothingFactor );
+		mMagSpectrumSmoothed[i] = mMagSpectrumSmoothed[i] * smoothingFactor + std::sqrt( re * re + im * im ) * magScale * ( 1 - smoothingFactor );
 	}
 
-	return mMagSpectrum;
+	// if readers are holding on to both other copies, skip publishing this one. The smoothed spectrum carries over to the next analysis.
+	Analysis *analysis = mAnalysis.beginWrite();
+	if( analysis ) {
+		analysis->mBuffer = window;
+		analysis->mMagSpectrum = mMagSpectrumSmoothed;
+		mAnalysis.endWrite();
+	}
 }
 
 float MonitorSpectralNode::getSpectralCentroid()
@@ -27,6 +27,7 @@
 #include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/Converter.h"
+#include "cinder/audio/Utilities.h"
 #include "cinder/CinderAssert.h"
 #include "cinder/System.h"
 
@@ -41,8 +42,10 @@ namespace cinder { namespace audio {
 // ----------------------------------------------------------------------------------------------------
 
 Node::Node( const Format &format )
-	: mInitialized( false ), mEnabled( false ),	mChannelMode( format.getChannelMode() ),
-		mNumChannels( 1 ), mAutoEnabled( true ), mProcessInPlace( true ), mLastProcessedFrame( numeric_limits<uint64_t>::max() )
+	: mContextPtr( nullptr ), mEnabled( false ), mInitialized( false ), mAutoEnabled( true ), mProcessInPlace( true ),
+		mChannelMode( format.getChannelMode() ), mNumChannels( 1 ), mLastProcessedFrame( numeric_limits<uint64_t>::max() ),
+		mProfileNumBlocks( 0 ), mProfileTotalNanos( 0 ), mProfileMaxNanos( 0 ), mProfileLastNanos( 0 ),
+		mProfileNumUnderruns( 0 ), mProfileNumOverruns( 0 )
 {
 	if( format.getChannels() ) {
 		mNumChannels = format.getChannels();
@@ -409,7 +412,7 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 			// from InputNode's that aren't filling the entire buffer are zero.
 			inPlaceBuffer->zero();
 			if( mEnabled )
-				process( inPlaceBuffer );
+				processWithProfiling( inPlaceBuffer );
 		}
 		else {
 			// First pull the input (can only be one when in-place), then run process() if input did any processing.
@@ -420,7 +423,7 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 				dsp::mixBuffers( input->getInternalBuffer(), inPlaceBuffer );
 
 			if( mEnabled )
-				process( inPlaceBuffer );
+				processWithProfiling( inPlaceBuffer );
 		}
 	}
 	else {
@@ -447,12 +450,53 @@ void Node::sumInputs()
 
 	// Process the summed results if enabled.
 	if( mEnabled )
-		process( &mSummingBuffer );
+		processWithProfiling( &mSummingBuffer );
 
 	// copy summed buffer back to internal so downstream can get it.
 	dsp::mixBuffers( &mSummingBuffer, &mInternalBuffer );
 }
 
+void Node::processWithProfiling( Buffer *buffer )
+{
+	if( ! mContextPtr->isProfilingEnabled() ) {
+		process( buffer );
+		return;
+	}
+
+	const uint64_t beginNanos = getTimestampNanoseconds();
+	process( buffer );
+	const uint64_t elapsedNanos = getTimestampNanoseconds() - beginNanos;
+
+	// only the audio thread writes these, so plain loads and stores are enough.
+	mProfileNumBlocks.store( mProfileNumBlocks.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+	mProfileTotalNanos.store( mProfileTotalNanos.load( memory_order_relaxed ) + elapsedNanos, memory_order_relaxed );
+	mProfileLastNanos.store( elapsedNanos, memory_order_relaxed );
+	if( elapsedNanos > mProfileMaxNanos.load( memory_order_relaxed ) )
+		mProfileMaxNanos.store( elapsedNanos, memory_order_relaxed );
+}
+
+NodeProfile Node::getProfile() const
+{
+	NodeProfile result;
+	result.mNumBlocks = mProfileNumBlocks.load( memory_order_relaxed );
+	result.mTotalSeconds = (double)mProfileTotalNanos.load( memory_order_relaxed ) * 1e-9;
+	result.mMaxSeconds = (double)mProfileMaxNanos.load( memory_order_relaxed ) * 1e-9;
+	result.mLastSeconds = (double)mProfileLastNanos.load( memory_order_relaxed ) * 1e-9;
+	result.mNumUnderruns = mProfileNumUnderruns.load( memory_order_relaxed );
+	result.mNumOverruns = mProfileNumOverruns.load( memory_order_relaxed );
+	return result;
+}
+
+void Node::resetProfile()
+{
+	mProfileNumBlocks = 0;
+	mProfileTotalNanos = 0;
+	mProfileMaxNanos = 0;
+	mProfileLastNanos = 0;
+	mProfileNumUnderruns = 0;
+	mProfileNumOverruns = 0;
+}
+
 void Node::setupProcessWithSumming()
 {
 	CI_ASSERT( getContext() );
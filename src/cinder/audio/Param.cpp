@@ -24,20 +24,75 @@
 #include "cinder/audio/Param.h"
 #include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
+#include "cinder/audio/dsp/Simd.h"
 
 #include "cinder/CinderMath.h"
 
+#include <limits>
+
 using namespace std;
 
 namespace cinder { namespace audio {
 
-void rampLinear( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+namespace {
+
+typedef void (*RampFnPtr)( float *, size_t, double, double, float, float );
+
+// Each group of four samples takes its time from a double so that long blocks don't accumulate float error.
+inline void fillRampLinear( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor( t );
-		array[i] = lerp( valueBegin, valueEnd, factor );
-		t += tIncr;
+	const float valueDelta = valueEnd - valueBegin;
+	const float tIncrFloat = float( tIncr );
+	const float offsets[4] = { 0, tIncrFloat, 2 * tIncrFloat, 3 * tIncrFloat };
+	const dsp::Float4 laneOffsets = dsp::Float4::load( offsets );
+	const dsp::Float4 begin( valueBegin );
+	const dsp::Float4 delta( valueDelta );
+
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		dsp::Float4 factor = dsp::Float4( float( t + double( i ) * tIncr ) ) + laneOffsets;
+		( begin + factor * delta ).store( array + i );
+	}
+	for( ; i < count; i++ )
+		array[i] = valueBegin + valueDelta * float( t + double( i ) * tIncr );
+}
+
+// Evaluates valueBegin * ( valueEnd / valueBegin )^t with a multiplicative recurrence, only calling pow() once per array.
+inline void fillRampExponential( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+{
+	if( valueBegin == 0 || valueEnd == 0 || ( valueBegin < 0 ) != ( valueEnd < 0 ) ) {
+		fillRampLinear( array, count, t, tIncr, valueBegin, valueEnd );
+		return;
 	}
+
+	const double ratio = double( valueEnd ) / double( valueBegin );
+	const double sampleFactor = pow( ratio, tIncr );
+	const double groupFactor = sampleFactor * sampleFactor * sampleFactor * sampleFactor;
+	const float factors[4] = { 1, float( sampleFactor ), float( sampleFactor * sampleFactor ), float( sampleFactor * sampleFactor * sampleFactor ) };
+	const dsp::Float4 laneFactors = dsp::Float4::load( factors );
+
+	double value = double( valueBegin ) * pow( ratio, t );
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		( dsp::Float4( float( value ) ) * laneFactors ).store( array + i );
+		value *= groupFactor;
+	}
+	for( ; i < count; i++ ) {
+		array[i] = float( value );
+		value *= sampleFactor;
+	}
+}
+
+} // anonymous namespace
+
+void rampLinear( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+{
+	fillRampLinear( array, count, t, tIncr, valueBegin, valueEnd );
+}
+
+void rampExponential( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+{
+	fillRampExponential( array, count, t, tIncr, valueBegin, valueEnd );
 }
 
 void rampInQuad( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
@@ -60,12 +115,20 @@ void rampOutQuad( float *array, size_t count, double t, double tIncr, float valu
 
 Event::Event( double timeBegin, double timeEnd, float valueBegin, float valueEnd, bool copyValueOnBegin, const RampFn &rampFn )
 	: mTimeBegin( timeBegin ), mTimeEnd( timeEnd ), mDuration( timeEnd - timeBegin ), mCopyValueOnBegin( copyValueOnBegin ),
-		mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampFn( rampFn ), mIsComplete( false ), mIsCanceled( false ), mTimeCancel( -1 )
+		mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampFn( rampFn ), mIsComplete( false ), mIsCanceled( false ), mTimeCancel( -1 ),
+		mRampType( RampType::CUSTOM )
 {
+	// detect the built-in ramps that eval() can fill directly
+	const RampFnPtr *fn = rampFn.target<RampFnPtr>();
+	if( fn && *fn == rampLinear )
+		mRampType = RampType::LINEAR;
+	else if( fn && *fn == rampExponential )
+		mRampType = RampType::EXPONENTIAL;
 }
 
 Param::Param( Node *parentNode, float initialValue )
-	: mParentNode( parentNode ), mValue( initialValue ), mIsVaryingThisBlock( false )
+	: mParentNode( parentNode ), mValue( initialValue ), mIsVaryingThisBlock( false ), mEventsTimeBegin( numeric_limits<double>::max() ),
+		mIsInternalBufferConstant( false ), mInternalBufferValue( 0 )
 {
 }
 
@@ -95,7 +158,7 @@ EventRef Param::applyRamp( float valueEnd, double rampSeconds, const Options &op
 	if( mProcessor )
 		mProcessor.reset();
 
-	mEvents.push_back( event );
+	addEvent( event );
 	return event;
 }
 
@@ -118,7 +181,7 @@ EventRef Param::applyRamp( float valueBegin, float valueEnd, double rampSeconds,
 	if( mProcessor )
 		mProcessor.reset();
 
-	mEvents.push_back( event );
+	addEvent( event );
 	return event;
 }
 
@@ -137,7 +200,7 @@ EventRef Param::appendRamp( float valueEnd, double rampSeconds, const Options &o
 		event->mLabel = options.getLabel();
 
 	lock_guard<mutex> lock( ctx->getMutex() );
-	mEvents.push_back( event );
+	addEvent( event );
 	return event;
 }
 
@@ -156,7 +219,7 @@ EventRef Param::appendRamp( float valueBegin, float valueEnd, double rampSeconds
 		event->mLabel = options.getLabel();
 
 	lock_guard<mutex> lock( ctx->getMutex() );
-	mEvents.push_back( event );
+	addEvent( event );
 	return event;
 }
 
@@ -221,8 +284,14 @@ pair<double, float> Param::findEndTimeAndValue() const
 const float* Param::getValueArray()
 {
 	if( ! mIsVaryingThisBlock ) {
-		initInternalBuffer();
-		dsp::fill( mValue, mInternalBuffer.getData(), mInternalBuffer.getSize() );
+		// only refill when the value has changed since the last time the buffer was filled with a constant
+		const float value = mValue;
+		if( ! mIsInternalBufferConstant || mInternalBufferValue != value ) {
+			initInternalBuffer();
+			dsp::fill( value, mInternalBuffer.getData(), mInternalBuffer.getSize() );
+			mInternalBufferValue = value;
+			mIsInternalBufferConstant = true;
+		}
 	}
 
 	return mInternalBuffer.getData();
@@ -233,11 +302,20 @@ bool Param::eval()
 	if( mProcessor ) {
 		mProcessor->pullInputs( &mInternalBuffer );
 		mValue = mInternalBuffer[mInternalBuffer.getNumFrames() - 1];
+		mIsInternalBufferConstant = false;
 		return true;
 	}
+	else if( mEvents.empty() ) {
+		// common case for Params that aren't being automated, no need to query the Context.
+		mIsVaryingThisBlock = false;
+		return false;
+	}
 	else {
 		auto ctx = getContext();
 		mIsVaryingThisBlock = eval( ctx->getNumProcessedSeconds(), mInternalBuffer.getData(), mInternalBuffer.getSize(), ctx->getSampleRate() );
+		if( mIsVaryingThisBlock )
+			mIsInternalBufferConstant = false;
+
 		return mIsVaryingThisBlock;
 	}
 }
@@ -246,7 +324,15 @@ bool Param::eval( double timeBegin, float *array, size_t arrayLength, size_t sam
 {
 	const double samplePeriod = 1.0 / (double)sampleRate;
 	const double secondsPerBlock = (double)arrayLength * samplePeriod;
-	size_t samplesWritten = 0;
+	const double timeEnd = timeBegin + secondsPerBlock;
+
+	// Nothing begins before the end of this block, so there is nothing to evaluate or remove yet.
+	if( mEventsTimeBegin >= timeEnd )
+		return false;
+
+	size_t writeEnd = 0;
+	bool isConstant = false;
+	double eventsTimeBegin = numeric_limits<double>::max();
 
 	for( auto eventIt = mEvents.begin(); eventIt != mEvents.end(); /* */ ) {
 		Event &event = **eventIt;
@@ -262,7 +348,7 @@ bool Param::eval( double timeBegin, float *array, size_t arrayLength, size_t sam
 			continue;
 		}
 
-		const double timeEnd = timeBegin + secondsPerBlock;
+		eventsTimeBegin = min( eventsTimeBegin, event.mTimeBegin );
 
 		if( event.mTimeBegin < timeEnd && event.mTimeEnd > timeBegin ) {
 			size_t startIndex = timeBegin >= event.mTimeBegin ? 0 : size_t( ( event.mTimeBegin - timeBegin ) * sampleRate );
@@ -271,8 +357,9 @@ bool Param::eval( double timeBegin, float *array, size_t arrayLength, size_t sam
 			CI_ASSERT( startIndex <= arrayLength && endIndex <= arrayLength );
 			CI_ASSERT( event.mTimeEnd >= event.mTimeBegin );
 
-			if( startIndex > 0 && samplesWritten == 0 )
-				dsp::fill( mValue, array, startIndex );
+			// Events are in time order, so anything between the end of the previous one and the start of this one holds the current value
+			if( startIndex > writeEnd )
+				dsp::fill( mValue, array + writeEnd, startIndex - writeEnd );
 
 			size_t count = size_t( endIndex - startIndex );
 			double timeBeginNormalized = ( timeBegin - event.mTimeBegin + startIndex * samplePeriod ) / event.mDuration;
@@ -298,8 +385,20 @@ bool Param::eval( double timeBegin, float *array, size_t arrayLength, size_t sam
 			if( event.getCopyValueOnBegin() )
 				event.setValueBegin( mValue ); // this is only copied the first block the Event is processed, as next block getCopyValueOnBegin() is false.
 
-			event.mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, event.mValueBegin, event.mValueEnd );
-			samplesWritten += count;
+			if( event.mRampType != Event::RampType::CUSTOM && event.mValueBegin == event.mValueEnd && count == arrayLength && writeEnd == 0 ) {
+				// a flat ramp that covers the entire block, so the Param is constant and the array doesn't need to be filled.
+				mValue = event.mValueEnd;
+				isConstant = true;
+				break;
+			}
+
+			switch( event.mRampType ) {
+				case Event::RampType::LINEAR:		fillRampLinear( array + startIndex, count, timeBeginNormalized, timeIncr, event.mValueBegin, event.mValueEnd ); break;
+				case Event::RampType::EXPONENTIAL:	fillRampExponential( array + startIndex, count, timeBeginNormalized, timeIncr, event.mValueBegin, event.mValueEnd ); break;
+				default:							event.mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, event.mValueBegin, event.mValueEnd ); break;
+			}
+
+			writeEnd = startIndex + count;
 
 			// if this ramp ended with the current processing block, update mValue then remove event
 			if( endIndex < arrayLength ) {
@@ -307,7 +406,7 @@ bool Param::eval( double timeBegin, float *array, size_t arrayLength, size_t sam
 				mValue = event.mValueEnd;
 				eventIt = mEvents.erase( eventIt );
 			}
-			else if( samplesWritten == arrayLength ) {
+			else if( writeEnd == arrayLength ) {
 				// the array was filled, store the last calculated samples in mValue and finish evaluating
 				mValue = array[arrayLength - 1];
 				break;
@@ -319,10 +418,13 @@ bool Param::eval( double timeBegin, float *array, size_t arrayLength, size_t sam
 			++eventIt;
 	}
 
-	if( ! samplesWritten )
+	// If the loop stopped early, an Event overlaps the end of this block so the next one will be fully evaluated again.
+	mEventsTimeBegin = eventsTimeBegin;
+
+	if( ! writeEnd || isConstant )
 		return false;
-	else if( samplesWritten < arrayLength )
-		dsp::fill( mValue, array + (size_t)samplesWritten, size_t( arrayLength - samplesWritten ) );
+	else if( writeEnd < arrayLength )
+		dsp::fill( mValue, array + (size_t)writeEnd, size_t( arrayLength - writeEnd ) );
 
 	return true;
 }
@@ -340,9 +442,16 @@ void Param::resetImpl()
 		mEvents.clear();
 	}
 
+	mEventsTimeBegin = numeric_limits<double>::max();
 	mProcessor.reset();
 }
 
+void Param::addEvent( const EventRef &event )
+{
+	mEvents.push_back( event );
+	mEventsTimeBegin = min( mEventsTimeBegin, event->mTimeBegin );
+}
+
 void Param::removeEventsAt( double time )
 {
 	for( auto &event : mEvents ) {
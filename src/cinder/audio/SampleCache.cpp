@@ -0,0 +1,362 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/SampleCache.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/Exception.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const char		CACHE_FILE_MAGIC[4]		= { 'C', 'I', 'S', 'C' };
+const uint32_t	CACHE_FILE_VERSION		= 1;
+const char		*CACHE_FILE_EXTENSION	= ".cisample";
+const size_t	DATA_ALIGNMENT			= 64;
+
+// Precedes the key string and then the samples, which start at mDataOffset.
+struct CacheFileHeader {
+	char		mMagic[4];
+	uint32_t	mVersion;
+	uint32_t	mNumChannels;
+	uint32_t	mSampleRate;
+	uint64_t	mNumFrames;
+	uint32_t	mKeyLength;
+	uint32_t	mDataOffset;
+};
+
+// FNV-1a, used instead of std::hash so that file names are the same for all processes and builds sharing the cache directory.
+uint64_t hashBytes( const void *data, size_t size, uint64_t hash = 14695981039346656037ULL )
+{
+	const uint8_t *bytes = static_cast<const uint8_t *>( data );
+	for( size_t i = 0; i < size; i++ ) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// boost::filesystem returns a time_t, whereas the standard library returns a std::chrono::time_point
+int64_t fileTimeToInt( time_t time )
+{
+	return (int64_t)time;
+}
+
+template <typename TimePointT>
+int64_t fileTimeToInt( const TimePointT &time )
+{
+	return (int64_t)time.time_since_epoch().count();
+}
+
+// Identifies the decoded contents: the file path, size and modification time for files, or a hash of the data otherwise.
+string makeKey( const DataSourceRef &dataSource, size_t sampleRate )
+{
+	stringstream ss;
+	if( dataSource->isFilePath() ) {
+		const fs::path &filePath = dataSource->getFilePath();
+		ss << fs::canonical( filePath ).string() << "|" << fs::file_size( filePath ) << "|" << fileTimeToInt( fs::last_write_time( filePath ) );
+	}
+	else {
+		auto buffer = dataSource->getBuffer();
+		ss << dataSource->getFilePathHint().string() << "|" << buffer->getSize() << "|" << hex << hashBytes( buffer->getData(), buffer->getSize() ) << dec;
+	}
+
+	ss << "|" << sampleRate;
+	return ss.str();
+}
+
+string makeFileName( const string &key )
+{
+	stringstream ss;
+	ss << hex;
+	ss.width( 16 );
+	ss.fill( '0' );
+	ss << hashBytes( key.data(), key.size() ) << CACHE_FILE_EXTENSION;
+	return ss.str();
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - CachedSample
+// ----------------------------------------------------------------------------------------------------
+
+CachedSample::CachedSample( const fs::path &filePath )
+	: mFilePath( filePath ), mData( nullptr ), mNumFrames( 0 ), mNumChannels( 0 ), mSampleRate( 0 )
+{
+	try {
+		mMappedFile = MappedFile::create( filePath );
+	}
+	catch( MappedFileExc &exc ) {
+		throw AudioFileExc( exc.what() );
+	}
+
+	const size_t numBytes = mMappedFile->getSize();
+	const auto *header = static_cast<const CacheFileHeader *>( mMappedFile->getData() );
+	const char *bytes = static_cast<const char *>( mMappedFile->getData() );
+
+	const bool valid = numBytes >= sizeof( CacheFileHeader ) && equal( CACHE_FILE_MAGIC, CACHE_FILE_MAGIC + 4, header->mMagic ) && header->mVersion == CACHE_FILE_VERSION
+						&& header->mDataOffset >= sizeof( CacheFileHeader ) + header->mKeyLength
+						&& header->mDataOffset + header->mNumFrames * header->mNumChannels * sizeof( float ) <= numBytes;
+	if( ! valid )
+		throw AudioFileExc( "invalid sample cache file: " + filePath.string() );
+
+	mNumFrames = (size_t)header->mNumFrames;
+	mNumChannels = header->mNumChannels;
+	mSampleRate = header->mSampleRate;
+	mKey.assign( bytes + sizeof( CacheFileHeader ), header->mKeyLength );
+	mData = reinterpret_cast<const float *>( bytes + header->mDataOffset );
+}
+
+BufferRef CachedSample::copyToBuffer() const
+{
+	auto result = make_shared<Buffer>( mNumFrames, mNumChannels );
+	memcpy( result->getData(), mData, mNumFrames * mNumChannels * sizeof( float ) );
+
+	return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SampleCache
+// ----------------------------------------------------------------------------------------------------
+
+SampleCacheRef SampleCache::create( const fs::path &directory, uint64_t maxBytes )
+{
+	return SampleCacheRef( new SampleCache( directory, maxBytes ) );
+}
+
+SampleCache::SampleCache( const fs::path &directory, uint64_t maxBytes )
+	: mDirectory( directory ), mMaxBytes( maxBytes ), mNumBytes( 0 )
+{
+	if( ! fs::exists( mDirectory ) )
+		fs::create_directories( mDirectory );
+
+	scanDirectory();
+
+	lock_guard<mutex> lock( mMutex );
+	evict( mMaxBytes );
+}
+
+void SampleCache::scanDirectory()
+{
+	struct FileInfo {
+		string				mFileName;
+		uint64_t			mNumBytes;
+		fs::file_time_type	mTime;
+	};
+
+	// files left by earlier runs (or other processes), oldest first
+	vector<FileInfo> files;
+	for( fs::directory_iterator it( mDirectory ), end; it != end; ++it ) {
+		const fs::path &p = it->path();
+		if( ! fs::is_regular_file( p ) || p.extension() != CACHE_FILE_EXTENSION )
+			continue;
+
+		files.push_back( { p.filename().string(), (uint64_t)fs::file_size( p ), fs::last_write_time( p ) } );
+	}
+
+	sort( files.begin(), files.end(), []( const FileInfo &a, const FileInfo &b ) { return a.mTime < b.mTime; } );
+
+	lock_guard<mutex> lock( mMutex );
+	for( const auto &file : files ) {
+		mEntries.push_back( { file.mFileName, file.mNumBytes, weak_ptr<CachedSample>() } );
+		mEntryLookup[file.mFileName] = prev( mEntries.end() );
+		mNumBytes += file.mNumBytes;
+	}
+}
+
+CachedSampleRef SampleCache::load( const DataSourceRef &dataSource, size_t sampleRate )
+{
+	const string key = makeKey( dataSource, sampleRate );
+	const string fileName = makeFileName( key );
+	const fs::path filePath = mDirectory / fileName;
+
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		auto lookupIt = mEntryLookup.find( fileName );
+		if( lookupIt != mEntryLookup.end() ) {
+			mEntries.splice( mEntries.end(), mEntries, lookupIt->second );
+			auto sample = lookupIt->second->mSample.lock();
+			if( sample && sample->mKey == key )
+				return sample;
+		}
+	}
+
+	// map an existing file if there is one with matching contents, otherwise decode. Done without holding the lock, as this can take a while.
+	CachedSampleRef result;
+	if( fs::exists( filePath ) ) {
+		try {
+			result.reset( new CachedSample( filePath ) );
+			if( result->mKey != key )
+				result.reset();
+		}
+		catch( AudioFileExc & ) {
+		}
+	}
+
+	if( ! result ) {
+		writeCacheFile( filePath, key, dataSource, sampleRate );
+		result.reset( new CachedSample( filePath ) );
+	}
+
+	// a page that isn't resident yet would block the audio thread on disk I/O when it is played, so read them all in here
+	result->mMappedFile->prefault();
+
+	lock_guard<mutex> lock( mMutex );
+
+	auto lookupIt = mEntryLookup.find( fileName );
+	if( lookupIt == mEntryLookup.end() ) {
+		mEntries.push_back( { fileName, 0, weak_ptr<CachedSample>() } );
+		lookupIt = mEntryLookup.insert( make_pair( fileName, prev( mEntries.end() ) ) ).first;
+	}
+	else
+		mEntries.splice( mEntries.end(), mEntries, lookupIt->second );
+
+	Entry &entry = *lookupIt->second;
+	mNumBytes = mNumBytes - entry.mNumBytes + result->getNumBytes();
+	entry.mNumBytes = result->getNumBytes();
+	entry.mSample = result;
+
+	evict( mMaxBytes );
+	return result;
+}
+
+void SampleCache::writeCacheFile( const fs::path &filePath, const string &key, const DataSourceRef &dataSource, size_t sampleRate ) const
+{
+	BufferRef buffer = audio::load( dataSource, sampleRate )->loadBuffer();
+
+	CacheFileHeader header;
+	copy( CACHE_FILE_MAGIC, CACHE_FILE_MAGIC + 4, header.mMagic );
+	header.mVersion = CACHE_FILE_VERSION;
+	header.mNumChannels = (uint32_t)buffer->getNumChannels();
+	header.mSampleRate = (uint32_t)sampleRate;
+	header.mNumFrames = (uint64_t)buffer->getNumFrames();
+	header.mKeyLength = (uint32_t)key.size();
+	header.mDataOffset = uint32_t( ( sizeof( CacheFileHeader ) + key.size() + DATA_ALIGNMENT - 1 ) / DATA_ALIGNMENT * DATA_ALIGNMENT );
+
+	// written to a unique temporary file first, so that other processes never map a partially written file
+	stringstream tempName;
+	tempName << filePath.filename().string() << "." << hex << hash<thread::id>()( this_thread::get_id() ) << chrono::steady_clock::now().time_since_epoch().count() << ".tmp";
+	const fs::path tempPath = filePath.parent_path() / tempName.str();
+
+	{
+		ofstream stream( tempPath.string().c_str(), ios::binary | ios::trunc );
+		if( ! stream )
+			throw AudioFileExc( "failed to create sample cache file: " + tempPath.string() );
+
+		const vector<char> padding( header.mDataOffset - sizeof( CacheFileHeader ) - key.size(), 0 );
+		stream.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+		stream.write( key.data(), key.size() );
+		stream.write( padding.data(), padding.size() );
+		stream.write( reinterpret_cast<const char *>( buffer->getData() ), buffer->getSize() * sizeof( float ) );
+
+		if( ! stream )
+			throw AudioFileExc( "failed to write sample cache file: " + tempPath.string() );
+	}
+
+	try {
+		if( fs::exists( filePath ) )
+			fs::remove( filePath );
+
+		fs::rename( tempPath, filePath );
+	}
+	catch( exception & ) {
+		// another process may have just written (or still maps) the same file, in which case its copy is used
+		try {
+			fs::remove( tempPath );
+		}
+		catch( exception & ) {
+		}
+
+		if( ! fs::exists( filePath ) )
+			throw AudioFileExc( "failed to move sample cache file into place: " + filePath.string() );
+	}
+}
+
+void SampleCache::evict( uint64_t maxBytes )
+{
+	for( auto it = mEntries.begin(); it != mEntries.end() && mNumBytes > maxBytes; /* */ ) {
+		if( ! it->mSample.expired() ) {
+			++it;
+			continue;
+		}
+
+		try {
+			fs::remove( mDirectory / it->mFileName );
+		}
+		catch( exception & ) {
+			// still mapped by another process on a platform that doesn't allow removing it, try again next time
+			++it;
+			continue;
+		}
+
+		mNumBytes -= it->mNumBytes;
+		mEntryLookup.erase( it->mFileName );
+		it = mEntries.erase( it );
+	}
+}
+
+void SampleCache::setMaxBytes( uint64_t maxBytes )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	mMaxBytes = maxBytes;
+	evict( mMaxBytes );
+}
+
+uint64_t SampleCache::getMaxBytes() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mMaxBytes;
+}
+
+uint64_t SampleCache::getNumBytes() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mNumBytes;
+}
+
+size_t SampleCache::getNumFiles() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mEntries.size();
+}
+
+void SampleCache::clear()
+{
+	lock_guard<mutex> lock( mMutex );
+	evict( 0 );
+}
+
+} } // namespace cinder::audio
@@ -25,6 +25,12 @@
 #include "cinder/audio/Context.h"
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+
 using namespace ci;
 using namespace std;
 
@@ -35,8 +41,8 @@ namespace cinder { namespace audio {
 // ----------------------------------------------------------------------------------------------------
 
 SamplePlayerNode::SamplePlayerNode( const Format &format )
-	: InputNode( format ), mNumFrames( 0 ), mReadPos( 0 ), mLoop( false ),
-		mLoopBegin( 0 ), mLoopEnd( 0 )
+	: InputNode( format ), mNumFrames( 0 ), mReadPos( 0 ), mLoopBegin( 0 ), mLoopEnd( 0 ),
+		mLoop( false ), mIsEof( false )
 {
 	setChannelMode( ChannelMode::SPECIFIED );
 }
@@ -130,9 +136,20 @@ BufferPlayerNode::BufferPlayerNode( const BufferRef &buffer, const Format &forma
 	setNumChannels( mBuffer->getNumChannels() );
 }
 
+BufferPlayerNode::BufferPlayerNode( const CachedSampleRef &cachedSample, const Format &format )
+	: SamplePlayerNode( format ), mCachedSample( cachedSample )
+{
+	size_t numFrames = mCachedSample ? mCachedSample->getNumFrames() : 0;
+	mNumFrames = mLoopEnd = numFrames;
+
+	// force channel mode to match the cached sample
+	if( mCachedSample )
+		setNumChannels( mCachedSample->getNumChannels() );
+}
+
 void BufferPlayerNode::enableProcessing()
 {
-	if( ! mBuffer ) {
+	if( ! mBuffer && ! mCachedSample ) {
 		disable();
 		return;
 	}
@@ -162,6 +179,7 @@ void BufferPlayerNode::setBuffer( const BufferRef &buffer )
 		mNumFrames = 0;
 
 	mBuffer = buffer;
+	mCachedSample.reset();
 
 	// reset loop markers
 	mLoopBegin = 0;
@@ -179,6 +197,47 @@ void BufferPlayerNode::loadBuffer( const SourceFileRef &sourceFile )
 	}
 }
 
+void BufferPlayerNode::loadCachedSample( const SampleCacheRef &sampleCache, const DataSourceRef &dataSource )
+{
+	setCachedSample( sampleCache->load( dataSource, getSampleRate() ) );
+}
+
+void BufferPlayerNode::setCachedSample( const CachedSampleRef &cachedSample )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	if( cachedSample ) {
+		if( getNumChannels() != cachedSample->getNumChannels() ) {
+			setNumChannels( cachedSample->getNumChannels() );
+			configureConnections();
+		}
+
+		mNumFrames = cachedSample->getNumFrames();
+	}
+	else
+		mNumFrames = 0;
+
+	mCachedSample = cachedSample;
+	mBuffer.reset();
+
+	// reset loop markers
+	mLoopBegin = 0;
+	mLoopEnd = mNumFrames;
+}
+
+void BufferPlayerNode::copySamples( Buffer *buffer, size_t numFrames, size_t frameOffset, size_t readPos ) const
+{
+	if( mBuffer )
+		buffer->copyOffset( *mBuffer, numFrames, frameOffset, readPos );
+	else {
+		CI_ASSERT( buffer->getNumChannels() == mCachedSample->getNumChannels() );
+		CI_ASSERT( readPos + numFrames <= mCachedSample->getNumFrames() );
+
+		for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ )
+			memcpy( buffer->getChannel( ch ) + frameOffset, mCachedSample->getChannel( ch ) + readPos, numFrames * sizeof( float ) );
+	}
+}
+
 void BufferPlayerNode::process( Buffer *buffer )
 {
 	const auto &frameRange = getProcessFramesRange();
@@ -190,7 +249,7 @@ void BufferPlayerNode::process( Buffer *buffer )
 	size_t readCount = 0;
 	if( readPos <= readEnd ) {
 		readCount = min( readEnd - readPos, numFrames );
-		buffer->copyOffset( *mBuffer, readCount, frameRange.first, readPos );
+		copySamples( buffer, readCount, frameRange.first, readPos );
 	}
 
 	if( readCount < numFrames  ) {
@@ -199,7 +258,7 @@ void BufferPlayerNode::process( Buffer *buffer )
 			size_t readBegin = mLoopBegin;
 			size_t readLeft = min( numFrames - readCount, mNumFrames - readBegin );
 
-			buffer->copyOffset( *mBuffer, readLeft, readCount, readBegin );
+			copySamples( buffer, readLeft, readCount, readBegin );
 			mReadPos.store( readBegin + readLeft );
 		}
 		else {
@@ -212,18 +271,148 @@ void BufferPlayerNode::process( Buffer *buffer )
 		mReadPos += readCount;
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FileStreamer
+// ----------------------------------------------------------------------------------------------------
+
+//! Small pool of threads shared by all async FilePlayerNode's, which keeps their ring buffers filled. Players whose
+//! ring buffers are the emptiest (or that have a pending seek) are serviced first.
+class FileStreamer {
+  public:
+	static shared_ptr<FileStreamer> get();
+	~FileStreamer();
+
+	void add( FilePlayerNode *player );
+	//! Blocks until \a player is no longer being read from by a streaming thread.
+	void remove( FilePlayerNode *player );
+	void notify()	{ mWakeCond.notify_one(); }
+
+  private:
+	FileStreamer();
+	void run();
+	FilePlayerNode* getMostUrgentPlayer() const;
+
+	vector<FilePlayerNode *>	mPlayers;
+	vector<thread>				mThreads;
+	mutex						mMutex;
+	condition_variable			mWakeCond, mIdleCond;
+	bool						mShouldQuit;
+};
+
+namespace {
+
+// Players are only serviced once their ring buffers are less than half full, so reads happen in large chunks.
+const float						FILE_STREAMER_URGENCY_THRESHOLD = 0.5f;
+// Upper bound on how long a streaming thread sleeps before checking the players again.
+const chrono::milliseconds		FILE_STREAMER_POLL_INTERVAL( 2 );
+
+mutex						sFileStreamerMutex;
+weak_ptr<FileStreamer>		sFileStreamer;
+
+} // anonymous namespace
+
+// static
+shared_ptr<FileStreamer> FileStreamer::get()
+{
+	lock_guard<mutex> lock( sFileStreamerMutex );
+
+	auto result = sFileStreamer.lock();
+	if( ! result ) {
+		result = shared_ptr<FileStreamer>( new FileStreamer );
+		sFileStreamer = result;
+	}
+
+	return result;
+}
+
+FileStreamer::FileStreamer()
+	: mShouldQuit( false )
+{
+	size_t numThreads = max<size_t>( 1, min<size_t>( 4, thread::hardware_concurrency() / 2 ) );
+	for( size_t i = 0; i < numThreads; i++ )
+		mThreads.emplace_back( &FileStreamer::run, this );
+}
+
+FileStreamer::~FileStreamer()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mShouldQuit = true;
+	}
+
+	mWakeCond.notify_all();
+	for( auto &t : mThreads )
+		t.join();
+}
+
+void FileStreamer::add( FilePlayerNode *player )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		player->mStreamBusy = false;
+		mPlayers.push_back( player );
+	}
+
+	mWakeCond.notify_one();
+}
+
+void FileStreamer::remove( FilePlayerNode *player )
+{
+	unique_lock<mutex> lock( mMutex );
+	mIdleCond.wait( lock, [player] { return ! player->mStreamBusy; } );
+	mPlayers.erase( std::remove( mPlayers.begin(), mPlayers.end(), player ), mPlayers.end() );
+}
+
+FilePlayerNode* FileStreamer::getMostUrgentPlayer() const
+{
+	FilePlayerNode *result = nullptr;
+	float minUrgency = FILE_STREAMER_URGENCY_THRESHOLD;
+	for( auto player : mPlayers ) {
+		if( player->mStreamBusy )
+			continue;
+
+		float urgency = player->getStreamUrgency();
+		if( urgency < minUrgency ) {
+			minUrgency = urgency;
+			result = player;
+		}
+	}
+
+	return result;
+}
+
+void FileStreamer::run()
+{
+	unique_lock<mutex> lock( mMutex );
+	while( ! mShouldQuit ) {
+		auto player = getMostUrgentPlayer();
+		if( ! player ) {
+			mWakeCond.wait_for( lock, FILE_STREAMER_POLL_INTERVAL );
+			continue;
+		}
+
+		// read outside of the lock so that other players can be serviced in parallel. remove() waits on mStreamBusy.
+		player->mStreamBusy = true;
+		lock.unlock();
+		player->readImpl();
+		lock.lock();
+		player->mStreamBusy = false;
+		mIdleCond.notify_all();
+	}
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - FilePlayerNode
 // ----------------------------------------------------------------------------------------------------
 
 FilePlayerNode::FilePlayerNode( const Format &format )
-	: SamplePlayerNode( format ), mRingBufferPaddingFactor( 2 ), mLastUnderrun( 0 ), mLastOverrun( 0 ), mIsReadAsync( true )
+	: SamplePlayerNode( format ), mRingBufferPaddingFactor( 2 ), mLastUnderrun( 0 ), mLastOverrun( 0 ), mIsReadAsync( true ), mStreamBusy( false )
 {
 }
 
 FilePlayerNode::FilePlayerNode( const SourceFileRef &sourceFile, bool isReadAsync, const Format &format )
-	: SamplePlayerNode( format ), mSourceFile( sourceFile ), mIsReadAsync( isReadAsync ), mRingBufferPaddingFactor( 2 ),
-		mLastUnderrun( 0 ), mLastOverrun( 0 )
+	: SamplePlayerNode( format ), mSourceFile( sourceFile ), mRingBufferPaddingFactor( 2 ), mLastUnderrun( 0 ), mLastOverrun( 0 ),
+		mIsReadAsync( isReadAsync ), mStreamBusy( false )
 {
 	if( mSourceFile ) {
 		mNumFrames = mSourceFile->getNumFrames();
@@ -235,40 +424,32 @@ FilePlayerNode::FilePlayerNode( const SourceFileRef &sourceFile, bool isReadAsyn
 
 FilePlayerNode::~FilePlayerNode()
 {
-	if( isInitialized() )
-		destroyReadThreadImpl();
+	stopStreaming();
 }
 
 void FilePlayerNode::initialize()
 {
-	if( mSourceFile ) {
-		// Ensure the SourceFile's output samplerate matches ours.
-		size_t sampleRate = getSampleRate();
-		if( mSourceFile->getSampleRate() != sampleRate )
-			mSourceFile = mSourceFile->cloneWithSampleRate( sampleRate );
+	if( ! mSourceFile )
+		return;
 
-		mNumFrames = mSourceFile->getNumFrames();
-	}
+	// Ensure the SourceFile's output samplerate matches ours.
+	size_t sampleRate = getSampleRate();
+	if( mSourceFile->getSampleRate() != sampleRate )
+		mSourceFile = mSourceFile->cloneWithSampleRate( sampleRate );
+
+	mNumFrames = mSourceFile->getNumFrames();
 
 	if( ! mLoopEnd  || mLoopEnd > mNumFrames )
 		mLoopEnd = mNumFrames;
 
-	mIoBuffer.setSize( mSourceFile->getMaxFramesPerRead(), getNumChannels() );
-
-	for( size_t i = 0; i < getNumChannels(); i++ )
-		mRingBuffers.emplace_back( mSourceFile->getMaxFramesPerRead() * mRingBufferPaddingFactor );
-
-	mBufferFramesThreshold = mRingBuffers[0].getSize() / 2;
-
-	if( mIsReadAsync ) {
-		mAsyncReadShouldQuit = false;
-		mReadThread = unique_ptr<thread>( new thread( bind( &FilePlayerNode::readAsyncImpl, this ) ) );
-	}
+	stopStreaming();
+	setupStreaming();
+	startStreaming();
 }
 
 void FilePlayerNode::uninitialize()
 {
-	destroyReadThreadImpl();
+	stopStreaming();
 }
 
 void FilePlayerNode::enableProcessing()
@@ -287,40 +468,12 @@ void FilePlayerNode::disableProcessing()
 
 void FilePlayerNode::stop()
 {
-	if( mIsReadAsync ) {
-		lock_guard<mutex> lock( mAsyncReadMutex );
-		stopImpl();
-	}
-	else {
-		auto ctx = getContext();
-		if( ! ctx->isAudioThread() ) {
-			lock_guard<mutex> lock( ctx->getMutex() );
-			stopImpl();
-		}
-		else {
-			// called from audio thread, lock is already held for the duration of this block
-			stopImpl();
-		}
-	}
+	stopImpl();
 }
 
 void FilePlayerNode::seek( size_t readPositionFrames )
 {
-	if( mIsReadAsync ) {
-		lock_guard<mutex> lock( mAsyncReadMutex );
-		seekImpl( readPositionFrames );
-	}
-	else {
-		auto ctx = getContext();
-		if( ! ctx->isAudioThread() ) {
-			lock_guard<mutex> lock( ctx->getMutex() );
-			seekImpl( readPositionFrames );
-		}
-		else {
-			// called from audio thread, lock is already held for the duration of this block
-			seekImpl( readPositionFrames );
-		}
-	}
+	seekImpl( readPositionFrames );
 }
 
 void FilePlayerNode::setSourceFile( const SourceFileRef &sourceFile )
@@ -329,6 +482,7 @@ void FilePlayerNode::setSourceFile( const SourceFileRef &sourceFile )
 
 	bool wasEnabled = isEnabled();
 	disable();
+	stopStreaming();
 
 	// ensure the source's samplerate matches the context
 	size_t sampleRate = getSampleRate();
@@ -337,8 +491,9 @@ void FilePlayerNode::setSourceFile( const SourceFileRef &sourceFile )
 	else
 		mSourceFile = sourceFile->cloneWithSampleRate( sampleRate );
 
-	// reset num frames and loop markers
+	// reset num frames, read position and loop markers
 	mNumFrames = mSourceFile->getNumFrames();
+	mReadPos = 0;
 	mLoopBegin = 0;
 	mLoopEnd = mNumFrames;
 
@@ -347,6 +502,13 @@ void FilePlayerNode::setSourceFile( const SourceFileRef &sourceFile )
 		configureConnections();
 	}
 
+	// configureConnections() may have already reinitialized, in which case this is restarted with the same (new) source
+	if( isInitialized() ) {
+		stopStreaming();
+		setupStreaming();
+		startStreaming();
+	}
+
 	if( wasEnabled )
 		enable();
 }
@@ -367,84 +529,231 @@ uint64_t FilePlayerNode::getLastOverrun()
 
 void FilePlayerNode::process( Buffer *buffer )
 {
-	size_t numFrames = buffer->getNumFrames();
-	size_t readPos = mReadPos;
-	size_t numReadAvail = mRingBuffers[0].getAvailableRead();
-
-	if( numReadAvail < mBufferFramesThreshold ) {
-		if( mIsReadAsync )
-			mIssueAsyncReadCond.notify_one();
-		else
-			readImpl();
-	}
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChannels = buffer->getNumChannels();
 
-	size_t readCount = std::min( numReadAvail, numFrames );
+	if( ! mIsReadAsync && getStreamUrgency() < 0.5f )
+		readImpl();
 
-	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
-		if( ! mRingBuffers[ch].read( buffer->getChannel( ch ), readCount ) )
+	// Handle a pending seek. Until the reading side has acknowledged it, there is nothing valid to play yet.
+	const uint64_t seekGeneration = mSeekGeneration.load( memory_order_acquire );
+	size_t numFramesPlayedEarly = 0;
+	if( mReadGeneration != seekGeneration ) {
+		const uint64_t sequence = mGenerationSequence.load( memory_order_acquire );
+		const uint64_t writeGeneration = mWriteGeneration.load( memory_order_relaxed );
+		const uint64_t beginFrame = mGenerationBeginFrame.load( memory_order_relaxed );
+		const size_t readPos = mGenerationReadPos.load( memory_order_relaxed );
+		atomic_thread_fence( memory_order_acquire );
+
+		// not acknowledged yet, or published while being read (in which case the next block will pick it up)
+		if( writeGeneration != seekGeneration || ( sequence & 1 ) || mGenerationSequence.load( memory_order_relaxed ) != sequence ) {
+			buffer->zero();
 			mLastUnderrun = getContext()->getNumProcessedFrames();
+			countUnderrun();
+			return;
+		}
+
+		// discard the frames that were written before the seek, using buffer as scratch space
+		while( mNumFramesRead < beginFrame ) {
+			size_t numDiscard = (size_t)min<uint64_t>( beginFrame - mNumFramesRead, numFrames );
+			for( size_t ch = 0; ch < numChannels; ch++ )
+				mRingBuffers[ch].read( buffer->getChannel( ch ), numDiscard );
+
+			mNumFramesRead += numDiscard;
+		}
+
+		// the previous block may have already played the first frames at the new position, if they were written before it saw the seek.
+		if( mNumFramesRead > beginFrame )
+			numFramesPlayedEarly = size_t( mNumFramesRead - beginFrame );
+
+		mReadPos = readPos;
+		mReadGeneration = seekGeneration;
 	}
 
-	// handle loop or EOF
+	// the last channel is written last, so it determines how many frames are available across all channels.
+	size_t readCount = min( mRingBuffers.back().getAvailableRead(), numFrames );
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		mRingBuffers[ch].read( buffer->getChannel( ch ), readCount );
+
+	mNumFramesRead += readCount;
+
+	// advance the read position, which the reading side wraps around the loop markers in the same manner.
+	size_t readPos = mReadPos + numFramesPlayedEarly + readCount;
+	size_t loopEnd = mLoopEnd;
+	if( mLoop && readPos >= loopEnd && loopEnd > mLoopBegin )
+		readPos = mLoopBegin + ( readPos - loopEnd ) % ( loopEnd - mLoopBegin );
+
+	mReadPos = min( readPos, mNumFrames );
+
 	if( readCount < numFrames ) {
-		// TODO: if looping, should fill with samples from the beginning of file
-		// - these should also already be in the ringbuffer, since a seek is done there as well. Rethink this path.
-		readPos += readCount;
-		if( mLoop && readPos >= mLoopEnd )
-			seekImpl( mLoopBegin );
-		else if( readPos >= mNumFrames ) {
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			fill( buffer->getChannel( ch ) + readCount, buffer->getChannel( ch ) + numFrames, 0.0f );
+
+		if( mNumFramesRead >= mStreamEndFrame.load( memory_order_acquire ) ) {
 			mIsEof = true;
 			disable();
 		}
+		else {
+			mLastUnderrun = getContext()->getNumProcessedFrames();
+			countUnderrun();
+		}
 	}
 }
 
-void FilePlayerNode::readAsyncImpl()
+void FilePlayerNode::setupStreaming()
 {
-	size_t lastReadPos = mReadPos;
-	while( true ) {
-		unique_lock<mutex> lock( mAsyncReadMutex );
-		mIssueAsyncReadCond.wait( lock );
+	const size_t maxFramesPerRead = mSourceFile->getMaxFramesPerRead();
+	const size_t numChannels = getNumChannels();
 
-		if( mAsyncReadShouldQuit )
-			return;
+	// large enough to ride out slow disks and many players sharing the streaming threads
+	const size_t ringBufferSize = max( maxFramesPerRead * mRingBufferPaddingFactor, getSampleRate() / 4 );
 
-		size_t readPos = mReadPos;
-		if( readPos != lastReadPos )
-			mSourceFile->seek( readPos );
+	mIoBuffer.setSize( maxFramesPerRead, numChannels );
 
-		readImpl();
-		lastReadPos = mReadPos;
+	mRingBuffers.clear();
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		mRingBuffers.emplace_back( ringBufferSize );
+
+	mBufferFramesThreshold = ringBufferSize / 2;
+
+	mNumFramesRead = 0;
+	mNumFramesWritten = 0;
+	mGenerationBeginFrame = 0;
+	mGenerationReadPos = 0;
+	mGenerationSequence = 0;
+	mStreamEndFrame = numeric_limits<uint64_t>::max();
+	mStreamPos = 0;
+
+	// the first read is handled as a seek to the current read position
+	mReadGeneration = 0;
+	mWriteGeneration = 0;
+	mSeekPos = min<size_t>( mReadPos, mNumFrames );
+	mSeekGeneration = 1;
+}
+
+void FilePlayerNode::startStreaming()
+{
+	if( mIsReadAsync && ! mStreamer ) {
+		mStreamer = FileStreamer::get();
+		mStreamer->add( this );
 	}
 }
 
-void FilePlayerNode::readImpl()
+void FilePlayerNode::stopStreaming()
 {
-	size_t readPos = mReadPos;
-	size_t availableWrite = mRingBuffers[0].getAvailableWrite();
-	size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
-	size_t numFramesToRead = readEnd < readPos ? 0 : min( availableWrite, readEnd - readPos );
+	if( mStreamer ) {
+		mStreamer->remove( this );
+		mStreamer.reset();
+	}
+}
 
-	if( ! numFramesToRead ) {
-		mLastOverrun = getContext()->getNumProcessedFrames();
-		return;
+float FilePlayerNode::getStreamUrgency() const
+{
+	if( mSeekGeneration.load( memory_order_acquire ) != mWriteGeneration.load( memory_order_relaxed ) )
+		return 0;
+
+	const size_t loopBegin = mLoopBegin;
+	const size_t readEnd = mLoop ? min( mLoopEnd.load(), mNumFrames ) : mNumFrames;
+	if( mStreamPos >= readEnd && ! ( mLoop && loopBegin < readEnd ) )
+		return 1;
+
+	const auto &ringBuffer = mRingBuffers.back();
+	return float( ringBuffer.getAvailableRead() ) / float( ringBuffer.getSize() );
+}
+
+void FilePlayerNode::readImpl()
+{
+	const size_t numChannels = mRingBuffers.size();
+	uint64_t seekGeneration = mSeekGeneration.load( memory_order_acquire );
+	uint64_t generationBeginFrame = 0;
+	size_t generationReadPos = 0;
+	bool ackPending = false;
+
+	// Seek if requested. The seek is acknowledged after the first chunk at the new position has been written,
+	// so that the audio thread doesn't underrun right after it resumes.
+	if( seekGeneration != mWriteGeneration.load( memory_order_relaxed ) ) {
+		mStreamPos = mSeekPos;
+		mSourceFile->seek( mStreamPos );
+		generationBeginFrame = mNumFramesWritten;
+		generationReadPos = mStreamPos;
+		mStreamEndFrame = numeric_limits<uint64_t>::max();
+		ackPending = true;
 	}
 
-	// safety check that the SourceFile is on the correct read position, which could happen if two users are simultaneously reading from the same file.
-	if( readPos != mSourceFile->getReadPosition() )
-		mSourceFile->seek( readPos );
+	while( true ) {
+		if( mSeekGeneration.load( memory_order_acquire ) != seekGeneration )
+			break;
+
+		bool loop = mLoop;
+		size_t loopBegin = mLoopBegin;
+		size_t readEnd = loop ? min( mLoopEnd.load(), mNumFrames ) : mNumFrames;
+
+		// prefetch across the loop point, so the audio thread plays straight through
+		if( loop && mStreamPos >= readEnd && loopBegin < readEnd )
+			mStreamPos = loopBegin;
+
+		if( mStreamPos >= readEnd ) {
+			mStreamEndFrame.store( mNumFramesWritten, memory_order_release );
+			break;
+		}
+
+		// the audio thread reads the last channel last, so it determines how much space is available across all channels.
+		size_t numFramesToRead = min( min( mRingBuffers.back().getAvailableWrite(), mIoBuffer.getNumFrames() ), readEnd - mStreamPos );
+		numFramesToRead = min( numFramesToRead, mSourceFile->getMaxFramesPerRead() );
+		if( ! numFramesToRead )
+			break;
+
+		// safety check that the SourceFile is on the correct read position, which could happen if two users are simultaneously reading from the same file.
+		if( mStreamPos != mSourceFile->getReadPosition() )
+			mSourceFile->seek( mStreamPos );
+
+		mIoBuffer.setNumFrames( numFramesToRead );
+		size_t numRead = mSourceFile->read( &mIoBuffer );
+		if( ! numRead ) {
+			// unexpected end of file, treat it as the end of the stream
+			mStreamEndFrame.store( mNumFramesWritten, memory_order_release );
+			break;
+		}
 
-	mIoBuffer.setNumFrames( numFramesToRead );
+		if( mStreamEndFrame.load( memory_order_relaxed ) != numeric_limits<uint64_t>::max() )
+			mStreamEndFrame.store( numeric_limits<uint64_t>::max(), memory_order_release );
 
-	size_t numRead = mSourceFile->read( &mIoBuffer );
-	mReadPos += numRead;
+		bool overrun = false;
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			if( ! mRingBuffers[ch].write( mIoBuffer.getChannel( ch ), numRead ) )
+				overrun = true;
+		}
 
-	for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
-		if( ! mRingBuffers[ch].write( mIoBuffer.getChannel( ch ), numRead ) ) {
+		if( overrun ) {
 			mLastOverrun = getContext()->getNumProcessedFrames();
-			return;
+			countOverrun();
+		}
+
+		mStreamPos += numRead;
+		mNumFramesWritten.fetch_add( numRead, memory_order_release );
+
+		if( ackPending ) {
+			publishGeneration( seekGeneration, generationBeginFrame, generationReadPos );
+			ackPending = false;
 		}
 	}
+
+	if( ackPending )
+		publishGeneration( seekGeneration, generationBeginFrame, generationReadPos );
+}
+
+void FilePlayerNode::publishGeneration( uint64_t generation, uint64_t beginFrame, size_t readPos )
+{
+	// only the reading side writes, so the sequence can be bumped without a read-modify-write.
+	const uint64_t sequence = mGenerationSequence.load( memory_order_relaxed );
+	mGenerationSequence.store( sequence + 1, memory_order_relaxed );
+	atomic_thread_fence( memory_order_release );
+
+	mWriteGeneration.store( generation, memory_order_relaxed );
+	mGenerationBeginFrame.store( beginFrame, memory_order_relaxed );
+	mGenerationReadPos.store( readPos, memory_order_relaxed );
+
+	mGenerationSequence.store( sequence + 2, memory_order_release );
 }
 
 void FilePlayerNode::seekImpl( size_t readPos )
@@ -455,28 +764,18 @@ void FilePlayerNode::seekImpl( size_t readPos )
 	mIsEof = false;
 	mReadPos = math<size_t>::clamp( readPos, 0, mNumFrames );
 
-	// if async mode, readAsyncImpl() will notice mReadPos was updated and do the seek there.
-	if( ! mIsReadAsync )
-		mSourceFile->seek( mReadPos );
+	// the reading side notices the new generation and does the actual seek, see readImpl().
+	mSeekPos = mReadPos.load();
+	mSeekGeneration.fetch_add( 1, memory_order_release );
+
+	if( mStreamer )
+		mStreamer->notify();
 }
 
 void FilePlayerNode::stopImpl()
 {
 	disable();
-
-	for( auto &ringBuffer : mRingBuffers )
-		ringBuffer.clear();
-
 	seekImpl( 0 );
 }
 
-void FilePlayerNode::destroyReadThreadImpl()
-{
-	if( mIsReadAsync && mReadThread ) {
-		mAsyncReadShouldQuit = true;
-		mIssueAsyncReadCond.notify_one();
-		mReadThread->join();
-	}
-}
-
 } } // namespace cinder::audio
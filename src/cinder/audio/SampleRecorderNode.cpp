@@ -24,6 +24,7 @@
 #include "cinder/audio/SampleRecorderNode.h"
 #include "cinder/audio/Context.h"
 #include "cinder/audio/Target.h"
+#include "cinder/audio/Exception.h"
 
 using namespace ci;
 using namespace std;
@@ -33,6 +34,7 @@ namespace cinder { namespace audio {
 namespace {
 
 const size_t DEFAULT_RECORD_BUFFER_FRAMES = 44100;
+const double DEFAULT_FILE_RECORD_BUFFER_SECONDS = 2;
 
 void resizeBufferAndShuffleChannels( BufferDynamic *buffer, size_t resultNumFrames )
 {
@@ -197,4 +199,91 @@ void BufferRecorderNode::process( Buffer *buffer )
 	mWritePos.compare_exchange_strong( writePos, writePosNew );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FileRecorderNode
+// ----------------------------------------------------------------------------------------------------
+
+FileRecorderNode::FileRecorderNode( const Format &format )
+	: SampleRecorderNode( format ), mBufferSeconds( DEFAULT_FILE_RECORD_BUFFER_SECONDS ), mLastOverrun( 0 )
+{
+}
+
+FileRecorderNode::~FileRecorderNode()
+{
+}
+
+void FileRecorderNode::start( const fs::path &filePath, SampleType sampleType )
+{
+	start( TargetFile::create( filePath, getSampleRate(), getNumChannels(), sampleType ) );
+}
+
+void FileRecorderNode::start( const DataTargetRef &dataTarget, const std::string &extension, SampleType sampleType )
+{
+	start( TargetFile::create( dataTarget, getSampleRate(), getNumChannels(), sampleType, extension ) );
+}
+
+void FileRecorderNode::start( unique_ptr<TargetFile> &&target )
+{
+	if( target->getNumChannels() != getNumChannels() )
+		throw AudioFormatExc( "TargetFile's channel count must match the FileRecorderNode's" );
+
+	size_t bufferFrames = max<size_t>( size_t( mBufferSeconds * (double)getSampleRate() ), getFramesPerBlock() * 2 );
+	unique_ptr<TargetFileAsync> asyncTarget( new TargetFileAsync( move( target ), bufferFrames ) );
+
+	unique_ptr<TargetFileAsync> previousTarget;
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+		previousTarget = move( mTarget );
+		mTarget = move( asyncTarget );
+		mWritePos = 0;
+	}
+
+	// the previous recording (if any) is finalized outside of the lock, so that the audio thread isn't blocked.
+	previousTarget.reset();
+	enable();
+}
+
+void FileRecorderNode::stop()
+{
+	disable();
+
+	unique_ptr<TargetFileAsync> target;
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+		target = move( mTarget );
+	}
+
+	if( target )
+		target->flush();
+}
+
+bool FileRecorderNode::isRecording() const
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	return mTarget && isEnabled();
+}
+
+uint64_t FileRecorderNode::getLastOverrun()
+{
+	uint64_t result = mLastOverrun;
+	mLastOverrun = 0;
+	return result;
+}
+
+void FileRecorderNode::process( Buffer *buffer )
+{
+	if( ! mTarget || buffer->getNumChannels() != mTarget->getNumChannels() )
+		return;
+
+	const uint64_t numDroppedFrames = mTarget->getNumDroppedFrames();
+	mTarget->write( buffer );
+
+	if( mTarget->getNumDroppedFrames() != numDroppedFrames ) {
+		mLastOverrun = getContext()->getNumProcessedFrames();
+		countOverrun();
+	}
+	else
+		mWritePos += buffer->getNumFrames();
+}
+
 } } // namespace cinder::audio
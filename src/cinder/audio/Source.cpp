@@ -24,6 +24,8 @@
 #include "cinder/audio/Source.h"
 #include "cinder/audio/dsp/Converter.h"
 #include "cinder/audio/FileOggVorbis.h"
+#include "cinder/audio/Utilities.h"
+#include "cinder/audio/Exception.h"
 
 #include "cinder/Utilities.h"
 
@@ -31,6 +33,7 @@
 	#include "cinder/audio/cocoa/FileCoreAudio.h"
 #elif defined( CINDER_MSW )
 	#include "cinder/audio/msw/FileMediaFoundation.h"
+	#include "cinder/msw/CinderMsw.h"
 #elif defined( CINDER_LINUX )
  	#include "cinder/audio/linux/FileAudioLoader.h"
 #endif
@@ -97,10 +100,25 @@ Source::~Source()
 }
 
 SourceFile::SourceFile( size_t sampleRate )
-	: Source( sampleRate ), mNumFrames( 0 ), mFileNumFrames( 0 ), mReadPos( 0 )
+	: Source( sampleRate ), mNumFrames( 0 ), mFileNumFrames( 0 ), mReadPos( 0 ), mConverterQuality( dsp::Converter::Quality::BEST )
 {
 }
 
+void SourceFile::setConverterQuality( dsp::Converter::Quality quality )
+{
+	if( mConverterQuality == quality )
+		return;
+
+	mConverterQuality = quality;
+
+	// rebuild the Converter with the new quality, if one is being used.
+	if( mConverter ) {
+		size_t readPos = mReadPos;
+		setupSampleRateConversion();
+		seek( readPos );
+	}
+}
+
 void SourceFile::setupSampleRateConversion()
 {
 	size_t nativeSampleRate = getSampleRateNative();
@@ -114,7 +132,7 @@ void SourceFile::setupSampleRateConversion()
 
 		if( ! supportsConversion() ) {
 			size_t numChannels = getNumChannels();
-			mConverter = audio::dsp::Converter::create( nativeSampleRate, outputSampleRate, numChannels, numChannels, getMaxFramesPerRead() );
+			mConverter = audio::dsp::Converter::create( nativeSampleRate, outputSampleRate, numChannels, numChannels, getMaxFramesPerRead(), mConverterQuality );
 			mConverterReadBuffer.setSize( getMaxFramesPerRead(), numChannels );
 		}
 	}
@@ -156,26 +174,47 @@ BufferRef SourceFile::loadBuffer()
 	BufferRef result = make_shared<Buffer>( mNumFrames, getNumChannels() );
 
 	if( mConverter ) {
+		// start from an empty history, as the previous read may have left the flushed tail in it
+		mConverter->clear();
+
 		// TODO: need BufferView's in order to reduce number of copies
 		Buffer converterDestBuffer( mConverter->getDestMaxFramesPerBlock(), getNumChannels() );
-		size_t readCount = 0;
-		while( true ) {
-			size_t framesNeeded = std::min( getMaxFramesPerRead(), mFileNumFrames - readCount );
-			if( framesNeeded == 0 )
-				break;
+		const size_t maxFramesPerRead = getMaxFramesPerRead();
+		mConverterReadBuffer.setNumFrames( maxFramesPerRead );
+
+		// numPending is the number of file frames at the start of mConverterReadBuffer that the Converter hasn't consumed yet.
+		size_t readCount = 0, numPending = 0;
+		while( mReadPos < mNumFrames ) {
+			size_t framesNeeded = std::min( maxFramesPerRead - numPending, mFileNumFrames - readCount );
+			if( framesNeeded ) {
+				size_t outNumFrames = performRead( &mConverterReadBuffer, numPending, framesNeeded );
+				CI_ASSERT( outNumFrames == framesNeeded );
 
-			// make sourceBuffer num frames match outNumFrames so that Converter doesn't think it has more
-			if( framesNeeded != mConverterReadBuffer.getNumFrames() )
-				mConverterReadBuffer.setNumFrames( framesNeeded );
+				readCount += outNumFrames;
+				numPending += outNumFrames;
+			}
 
-			size_t outNumFrames = performRead( &mConverterReadBuffer, 0, framesNeeded );
-			CI_ASSERT( outNumFrames == framesNeeded );
+			// past the end of the file, pad with silence so that the frames held back by the Converter's latency are flushed
+			for( size_t ch = 0; ch < mConverterReadBuffer.getNumChannels(); ch++ )
+				std::fill( mConverterReadBuffer.getChannel( ch ) + numPending, mConverterReadBuffer.getChannel( ch ) + maxFramesPerRead, 0.0f );
 
 			pair<size_t, size_t> count = mConverter->convert( &mConverterReadBuffer, &converterDestBuffer );
-			result->copyOffset( converterDestBuffer, count.second, mReadPos, 0 );
+			if( count.first == 0 && count.second == 0 )
+				break;
 
-			readCount += outNumFrames;
+			count.second = std::min( count.second, mNumFrames - mReadPos );
+			result->copyOffset( converterDestBuffer, count.second, mReadPos, 0 );
 			mReadPos += count.second;
+
+			// keep any file frames that weren't consumed for the next convert()
+			size_t numConsumed = std::min( count.first, numPending );
+			numPending -= numConsumed;
+			if( numPending && numConsumed ) {
+				for( size_t ch = 0; ch < mConverterReadBuffer.getNumChannels(); ch++ ) {
+					float *channel = mConverterReadBuffer.getChannel( ch );
+					std::copy( channel + numConsumed, channel + numConsumed + numPending, channel );
+				}
+			}
 		}
 	}
 	else {
@@ -200,4 +239,36 @@ void SourceFile::seek( size_t readPositionFrames )
 	mReadPos = readPositionFrames;
 }
 
+vector<BufferRef> loadBuffers( const vector<SourceFileRef> &sourceFiles, size_t numThreads )
+{
+	vector<BufferRef> result( sourceFiles.size() );
+	ci::parallelFor( sourceFiles.size(), [&]( size_t i ) {
+#if defined( CINDER_MSW )
+		// Media Foundation requires COM on each of the decoding threads
+		msw::initializeCom( COINIT_MULTITHREADED );
+#endif
+		result[i] = sourceFiles[i]->loadBuffer();
+	}, numThreads );
+
+	return result;
+}
+
+vector<BufferRef> loadBuffers( const vector<DataSourceRef> &dataSources, size_t sampleRate, size_t numThreads )
+{
+	// opening the files is done in parallel too, as parsing headers and setting up converters isn't free.
+	vector<BufferRef> result( dataSources.size() );
+	ci::parallelFor( dataSources.size(), [&]( size_t i ) {
+#if defined( CINDER_MSW )
+		msw::initializeCom( COINIT_MULTITHREADED );
+#endif
+		auto sourceFile = SourceFile::create( dataSources[i], sampleRate );
+		if( ! sourceFile )
+			throw AudioFileExc( "no SourceFile available for: " + dataSources[i]->getFilePathHint().string() );
+
+		result[i] = sourceFile->loadBuffer();
+	}, numThreads );
+
+	return result;
+}
+
 } } // namespace cinder::audio
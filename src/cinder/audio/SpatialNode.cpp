@@ -0,0 +1,557 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/SpatialNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/audio/dsp/Simd.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const float EPSILON = 1e-5f;
+
+void toUnitVector( const SpatialDirection &direction, float *result )
+{
+	const float azimuth = toRadians( direction.mAzimuth );
+	const float elevation = toRadians( direction.mElevation );
+	result[0] = cosf( elevation ) * cosf( azimuth );
+	result[1] = cosf( elevation ) * sinf( azimuth );
+	result[2] = sinf( elevation );
+}
+
+size_t getNumAmbisonicChannels( size_t order )
+{
+	if( order < 1 || order > 3 )
+		throw AudioFormatExc( "unsupported ambisonic order: " + to_string( order ) + " (must be between 1 and 3)" );
+
+	return ( order + 1 ) * ( order + 1 );
+}
+
+size_t getNumSpeakers( const vector<SpatialDirection> &speakers )
+{
+	if( speakers.empty() )
+		throw AudioFormatExc( "speaker layout is empty" );
+
+	return speakers.size();
+}
+
+// Adds source scaled by gain to dest.
+void mixConstant( const float *source, float *dest, size_t numFrames, float gain )
+{
+	const dsp::Float4 gain4( gain );
+
+	size_t i = 0;
+	for( ; i + 4 <= numFrames; i += 4 )
+		( dsp::Float4::load( dest + i ) + dsp::Float4::load( source + i ) * gain4 ).store( dest + i );
+
+	for( ; i < numFrames; i++ )
+		dest[i] += source[i] * gain;
+}
+
+// Adds source to dest, scaled by a gain that moves linearly from gainBegin to gainEnd over numFrames.
+void mixRamped( const float *source, float *dest, size_t numFrames, float gainBegin, float gainEnd )
+{
+	const float gainIncr = ( gainEnd - gainBegin ) / (float)numFrames;
+	const float gainsInitial[4] = { gainBegin + gainIncr, gainBegin + 2 * gainIncr, gainBegin + 3 * gainIncr, gainBegin + 4 * gainIncr };
+	const dsp::Float4 gainIncr4( gainIncr * 4 );
+	dsp::Float4 gain4 = dsp::Float4::load( gainsInitial );
+
+	size_t i = 0;
+	for( ; i + 4 <= numFrames; i += 4 ) {
+		( dsp::Float4::load( dest + i ) + dsp::Float4::load( source + i ) * gain4 ).store( dest + i );
+		gain4 += gainIncr4;
+	}
+
+	for( ; i < numFrames; i++ )
+		dest[i] += source[i] * ( gainBegin + float( i + 1 ) * gainIncr );
+}
+
+float legendre( size_t n, float x )
+{
+	switch( n ) {
+		case 0: return 1;
+		case 1: return x;
+		case 2: return 0.5f * ( 3 * x * x - 1 );
+		case 3: return 0.5f * ( 5 * x * x * x - 3 * x );
+		default: CI_ASSERT_NOT_REACHABLE();
+	}
+	return 0;
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// SpatialNode
+// ----------------------------------------------------------------------------------------------------
+
+SpatialNode::SpatialNode( size_t numSources, size_t numOutputChannels, const Format &format )
+	: Node( format ), mNumSources( numSources ), mGains( numSources * numOutputChannels, 0.0f ), mGainsCurrent( numSources * numOutputChannels, 0.0f ),
+		mGainsChanged( false )
+{
+	setChannelMode( ChannelMode::SPECIFIED );
+	setNumChannels( numOutputChannels );
+}
+
+void SpatialNode::initialize()
+{
+	const size_t framesPerBlock = getFramesPerBlock();
+	mSourceBuffer = Buffer( framesPerBlock, mNumSources );
+	mInputBuffer.setSize( framesPerBlock, max( mNumSources, getMaxNumInputChannels() ) );
+}
+
+float SpatialNode::getGain( size_t source, size_t outputChannel ) const
+{
+	CI_ASSERT( source < mNumSources && outputChannel < getNumChannels() );
+
+	return mGains[source * getNumChannels() + outputChannel];
+}
+
+void SpatialNode::setGains( size_t firstSource, size_t count, const float *gains )
+{
+	CI_ASSERT( firstSource + count <= mNumSources );
+
+	const size_t numOutputs = getNumChannels();
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	memcpy( mGains.data() + firstSource * numOutputs, gains, count * numOutputs * sizeof( float ) );
+	mGainsChanged = true;
+}
+
+void SpatialNode::sumInputs()
+{
+	// Sources are collected in their own buffer, since there are usually far more of them than output channels.
+	mSourceBuffer.zero();
+	const size_t numFrames = mSourceBuffer.getNumFrames();
+
+	for( auto &input : getInputs() ) {
+		mInputBuffer.setNumChannels( input->getNumChannels() );
+		input->pullInputs( &mInputBuffer );
+
+		const Buffer *processedBuffer = input->getProcessesInPlace() ? &mInputBuffer : input->getInternalBuffer();
+		const size_t numChannels = min( processedBuffer->getNumChannels(), mNumSources );
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			float *sourceChannel = mSourceBuffer.getChannel( ch );
+			dsp::add( sourceChannel, processedBuffer->getChannel( ch ), sourceChannel, numFrames );
+		}
+	}
+
+	Buffer *internalBuffer = getInternalBuffer();
+	if( isEnabled() )
+		processWithProfiling( internalBuffer );
+	else
+		internalBuffer->zero();
+}
+
+void SpatialNode::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numOutputs = buffer->getNumChannels();
+	const bool interpolate = mGainsChanged;
+
+	buffer->zero();
+
+	for( size_t source = 0; source < mNumSources; source++ ) {
+		const float *sourceChannel = mSourceBuffer.getChannel( source );
+		const float *gainsEnd = &mGains[source * numOutputs];
+		const float *gainsBegin = interpolate ? &mGainsCurrent[source * numOutputs] : gainsEnd;
+
+		for( size_t ch = 0; ch < numOutputs; ch++ ) {
+			const float gainBegin = gainsBegin[ch];
+			const float gainEnd = gainsEnd[ch];
+			if( gainBegin == gainEnd ) {
+				if( gainEnd != 0 )
+					mixConstant( sourceChannel, buffer->getChannel( ch ), numFrames, gainEnd );
+			}
+			else
+				mixRamped( sourceChannel, buffer->getChannel( ch ), numFrames, gainBegin, gainEnd );
+		}
+	}
+
+	if( interpolate ) {
+		memcpy( mGainsCurrent.data(), mGains.data(), mGains.size() * sizeof( float ) );
+		mGainsChanged = false;
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// SpatialPannerNode
+// ----------------------------------------------------------------------------------------------------
+
+SpatialPannerNode::SpatialPannerNode( size_t numSources, size_t numOutputChannels, const Format &format )
+	: SpatialNode( numSources, numOutputChannels, format ), mDirections( numSources )
+{
+}
+
+void SpatialPannerNode::setSourceDirection( size_t source, const SpatialDirection &direction )
+{
+	setSourceDirections( vector<SpatialDirection>( 1, direction ), source );
+}
+
+void SpatialPannerNode::setSourceDirections( const vector<SpatialDirection> &directions, size_t firstSource )
+{
+	CI_ASSERT( firstSource + directions.size() <= mNumSources );
+
+	// gains are computed on the calling thread, so the audio thread is only blocked while they are copied.
+	const size_t numOutputs = getNumChannels();
+	vector<float> gains( directions.size() * numOutputs );
+	for( size_t i = 0; i < directions.size(); i++ ) {
+		computeGains( directions[i], &gains[i * numOutputs] );
+		mDirections[firstSource + i] = directions[i];
+	}
+
+	setGains( firstSource, directions.size(), gains.data() );
+}
+
+const SpatialDirection& SpatialPannerNode::getSourceDirection( size_t source ) const
+{
+	CI_ASSERT( source < mNumSources );
+
+	return mDirections[source];
+}
+
+void SpatialPannerNode::updateAllGains()
+{
+	const size_t numOutputs = getNumChannels();
+	for( size_t source = 0; source < mNumSources; source++ )
+		computeGains( mDirections[source], &mGains[source * numOutputs] );
+
+	mGainsCurrent = mGains;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// VbapNode
+// ----------------------------------------------------------------------------------------------------
+
+VbapNode::VbapNode( size_t numSources, const vector<SpatialDirection> &speakers, const Format &format )
+	: SpatialPannerNode( numSources, getNumSpeakers( speakers ), format ), mSpeakers( speakers ), mHorizontal( true )
+{
+	for( const auto &speaker : mSpeakers ) {
+		if( speaker.mElevation != 0 ) {
+			mHorizontal = false;
+			break;
+		}
+	}
+
+	if( mHorizontal )
+		buildPairs();
+	else
+		buildTriplets();
+
+	updateAllGains();
+}
+
+// Pairs are formed from speakers that are adjacent in azimuth. Pairs that are 180 degrees or more apart can't
+// pan between each other, sources in that gap snap to the closest speaker.
+void VbapNode::buildPairs()
+{
+	const size_t numSpeakers = mSpeakers.size();
+	if( numSpeakers < 2 )
+		return;
+
+	vector<float> azimuths( numSpeakers );
+	vector<size_t> sorted( numSpeakers );
+	for( size_t i = 0; i < numSpeakers; i++ ) {
+		float azimuth = fmodf( mSpeakers[i].mAzimuth, 360.0f );
+		azimuths[i] = azimuth < 0 ? azimuth + 360.0f : azimuth;
+		sorted[i] = i;
+	}
+
+	sort( sorted.begin(), sorted.end(), [&azimuths]( size_t a, size_t b ) { return azimuths[a] < azimuths[b]; } );
+
+	for( size_t i = 0; i < numSpeakers; i++ ) {
+		const size_t a = sorted[i];
+		const size_t b = sorted[( i + 1 ) % numSpeakers];
+		float gap = azimuths[b] - azimuths[a];
+		if( i == numSpeakers - 1 )
+			gap += 360.0f;
+
+		if( gap >= 180.0f - EPSILON )
+			continue;
+
+		float va[3], vb[3];
+		toUnitVector( SpatialDirection( mSpeakers[a].mAzimuth ), va );
+		toUnitVector( SpatialDirection( mSpeakers[b].mAzimuth ), vb );
+
+		const float det = va[0] * vb[1] - va[1] * vb[0];
+		if( fabsf( det ) < EPSILON )
+			continue;
+
+		SpeakerGroup group;
+		group.mSpeakers[0] = a;
+		group.mSpeakers[1] = b;
+		group.mSpeakers[2] = b;
+		fill( group.mInverse, group.mInverse + 9, 0.0f );
+		group.mInverse[0] = vb[1] / det;
+		group.mInverse[1] = -va[1] / det;
+		group.mInverse[3] = -vb[0] / det;
+		group.mInverse[4] = va[0] / det;
+		mGroups.push_back( group );
+	}
+}
+
+// Triplets are the faces of the convex hull of the speaker positions, found by checking that every other speaker lies
+// behind the plane of a candidate triangle. Triangles that contain another speaker on their plane are skipped in favor of the smaller ones.
+void VbapNode::buildTriplets()
+{
+	const size_t numSpeakers = mSpeakers.size();
+	if( numSpeakers < 3 )
+		return;
+
+	vector<float> positions( numSpeakers * 3 );
+	for( size_t i = 0; i < numSpeakers; i++ )
+		toUnitVector( mSpeakers[i], &positions[i * 3] );
+
+	auto dot = []( const float *a, const float *b ) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+
+	for( size_t i = 0; i < numSpeakers; i++ ) {
+		for( size_t j = i + 1; j < numSpeakers; j++ ) {
+			for( size_t k = j + 1; k < numSpeakers; k++ ) {
+				const float *a = &positions[i * 3];
+				const float *b = &positions[j * 3];
+				const float *c = &positions[k * 3];
+
+				const float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+				const float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+				float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+				if( dot( normal, normal ) < EPSILON * EPSILON )
+					continue;
+
+				// orient the plane to face away from the center, which must be strictly inside for the triplet to be invertible.
+				float distance = dot( normal, a );
+				if( distance < 0 ) {
+					for( size_t n = 0; n < 3; n++ )
+						normal[n] = -normal[n];
+					distance = -distance;
+				}
+				if( distance < EPSILON )
+					continue;
+
+				// inverse of the matrix whose rows are a, b and c
+				const float det = a[0] * ( b[1] * c[2] - b[2] * c[1] ) - a[1] * ( b[0] * c[2] - b[2] * c[0] ) + a[2] * ( b[0] * c[1] - b[1] * c[0] );
+				if( fabsf( det ) < EPSILON )
+					continue;
+
+				SpeakerGroup group;
+				group.mSpeakers[0] = i;
+				group.mSpeakers[1] = j;
+				group.mSpeakers[2] = k;
+				float *inv = group.mInverse;
+				inv[0] = ( b[1] * c[2] - b[2] * c[1] ) / det;
+				inv[1] = ( a[2] * c[1] - a[1] * c[2] ) / det;
+				inv[2] = ( a[1] * b[2] - a[2] * b[1] ) / det;
+				inv[3] = ( b[2] * c[0] - b[0] * c[2] ) / det;
+				inv[4] = ( a[0] * c[2] - a[2] * c[0] ) / det;
+				inv[5] = ( a[2] * b[0] - a[0] * b[2] ) / det;
+				inv[6] = ( b[0] * c[1] - b[1] * c[0] ) / det;
+				inv[7] = ( a[1] * c[0] - a[0] * c[1] ) / det;
+				inv[8] = ( a[0] * b[1] - a[1] * b[0] ) / det;
+
+				bool isFace = true;
+				for( size_t m = 0; m < numSpeakers && isFace; m++ ) {
+					if( m == i || m == j || m == k )
+						continue;
+
+					const float *p = &positions[m * 3];
+					const float side = dot( normal, p ) - distance;
+					if( side > EPSILON )
+						isFace = false;
+					else if( side > -EPSILON ) {
+						// coplanar speaker, reject the triangle if it lies inside
+						bool inside = true;
+						for( size_t col = 0; col < 3; col++ ) {
+							if( p[0] * inv[col] + p[1] * inv[3 + col] + p[2] * inv[6 + col] < -EPSILON )
+								inside = false;
+						}
+						if( inside )
+							isFace = false;
+					}
+				}
+
+				if( isFace )
+					mGroups.push_back( group );
+			}
+		}
+	}
+}
+
+void VbapNode::computeGains( const SpatialDirection &direction, float *gains ) const
+{
+	const size_t numSpeakers = mSpeakers.size();
+	fill( gains, gains + numSpeakers, 0.0f );
+
+	float p[3];
+	toUnitVector( mHorizontal ? SpatialDirection( direction.mAzimuth ) : direction, p );
+
+	// Use the group where the source is most central, which is the one with the largest minimum gain. When the source
+	// is outside the area covered by the speakers, all groups have a negative gain and the best one is clamped.
+	const size_t groupSize = mHorizontal ? 2 : 3;
+	const SpeakerGroup *bestGroup = nullptr;
+	float bestGains[3] = { 0, 0, 0 };
+	float bestMinGain = -numeric_limits<float>::max();
+
+	for( const auto &group : mGroups ) {
+		float groupGains[3];
+		float minGain = numeric_limits<float>::max();
+		for( size_t col = 0; col < groupSize; col++ ) {
+			groupGains[col] = p[0] * group.mInverse[col] + p[1] * group.mInverse[3 + col] + p[2] * group.mInverse[6 + col];
+			minGain = min( minGain, groupGains[col] );
+		}
+
+		if( minGain > bestMinGain ) {
+			bestMinGain = minGain;
+			bestGroup = &group;
+			copy( groupGains, groupGains + groupSize, bestGains );
+		}
+	}
+
+	float sumSquares = 0;
+	for( size_t col = 0; col < groupSize; col++ ) {
+		bestGains[col] = max( 0.0f, bestGains[col] );
+		sumSquares += bestGains[col] * bestGains[col];
+	}
+
+	if( ! bestGroup || sumSquares < EPSILON ) {
+		// no usable group, fall back to the closest speaker.
+		size_t closest = 0;
+		float closestDot = -numeric_limits<float>::max();
+		for( size_t i = 0; i < numSpeakers; i++ ) {
+			float position[3];
+			toUnitVector( mHorizontal ? SpatialDirection( mSpeakers[i].mAzimuth ) : mSpeakers[i], position );
+			const float d = p[0] * position[0] + p[1] * position[1] + p[2] * position[2];
+			if( d > closestDot ) {
+				closestDot = d;
+				closest = i;
+			}
+		}
+
+		gains[closest] = 1;
+		return;
+	}
+
+	const float norm = 1.0f / sqrtf( sumSquares );
+	for( size_t col = 0; col < groupSize; col++ )
+		gains[bestGroup->mSpeakers[col]] = bestGains[col] * norm;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// AmbisonicEncoderNode
+// ----------------------------------------------------------------------------------------------------
+
+AmbisonicEncoderNode::AmbisonicEncoderNode( size_t numSources, size_t order, const Format &format )
+	: SpatialPannerNode( numSources, getNumAmbisonicChannels( order ), format ), mOrder( order )
+{
+	updateAllGains();
+}
+
+void AmbisonicEncoderNode::computeGains( const SpatialDirection &direction, float *gains ) const
+{
+	computeSphericalHarmonics( mOrder, direction, gains );
+}
+
+// static
+void AmbisonicEncoderNode::computeSphericalHarmonics( size_t order, const SpatialDirection &direction, float *result )
+{
+	CI_ASSERT( order >= 1 && order <= 3 );
+
+	float v[3];
+	toUnitVector( direction, v );
+	const float x = v[0], y = v[1], z = v[2];
+
+	result[0] = 1;
+	result[1] = y;
+	result[2] = z;
+	result[3] = x;
+
+	if( order < 2 )
+		return;
+
+	const float sqrt3 = 1.7320508f;
+	result[4] = sqrt3 * x * y;
+	result[5] = sqrt3 * y * z;
+	result[6] = 0.5f * ( 3 * z * z - 1 );
+	result[7] = sqrt3 * x * z;
+	result[8] = 0.5f * sqrt3 * ( x * x - y * y );
+
+	if( order < 3 )
+		return;
+
+	const float sqrt5_8 = 0.7905694f;
+	const float sqrt15 = 3.8729833f;
+	const float sqrt3_8 = 0.6123724f;
+	result[9] = sqrt5_8 * y * ( 3 * x * x - y * y );
+	result[10] = sqrt15 * x * y * z;
+	result[11] = sqrt3_8 * y * ( 5 * z * z - 1 );
+	result[12] = 0.5f * z * ( 5 * z * z - 3 );
+	result[13] = sqrt3_8 * x * ( 5 * z * z - 1 );
+	result[14] = 0.5f * sqrt15 * z * ( x * x - y * y );
+	result[15] = sqrt5_8 * x * ( x * x - 3 * y * y );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// AmbisonicDecoderNode
+// ----------------------------------------------------------------------------------------------------
+
+AmbisonicDecoderNode::AmbisonicDecoderNode( size_t order, const vector<SpatialDirection> &speakers, Weighting weighting, const Format &format )
+	: SpatialNode( getNumAmbisonicChannels( order ), getNumSpeakers( speakers ), format ), mOrder( order ), mSpeakers( speakers ), mWeighting( weighting )
+{
+	float weights[4];
+	float energy = 0;
+	for( size_t n = 0; n <= mOrder; n++ ) {
+		if( mWeighting == Weighting::MAX_RE )
+			weights[n] = legendre( n, cosf( toRadians( 137.9f ) / ( float( mOrder ) + 1.51f ) ) );
+		else
+			weights[n] = 1;
+
+		energy += float( 2 * n + 1 ) * weights[n] * weights[n];
+	}
+
+	// Sampling decoder: SN3D components are converted to N3D by the (2n + 1) factor, and the result is scaled so that
+	// a plane wave's total power over a uniform layout is preserved.
+	const size_t numSpeakers = mSpeakers.size();
+	const float scale = sqrtf( float( numSpeakers ) / energy ) / float( numSpeakers );
+
+	vector<float> harmonics( mNumSources );
+	for( size_t speaker = 0; speaker < numSpeakers; speaker++ ) {
+		AmbisonicEncoderNode::computeSphericalHarmonics( mOrder, mSpeakers[speaker], harmonics.data() );
+		for( size_t acn = 0; acn < mNumSources; acn++ ) {
+			size_t n = 0;
+			while( ( n + 1 ) * ( n + 1 ) <= acn )
+				n++;
+
+			mGains[acn * numSpeakers + speaker] = scale * weights[n] * float( 2 * n + 1 ) * harmonics[acn];
+		}
+	}
+
+	mGainsCurrent = mGains;
+}
+
+} } // namespace cinder::audio
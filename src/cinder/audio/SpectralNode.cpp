@@ -0,0 +1,160 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/SpectralNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/dsp/Fft.h"
+
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+SpectralNode::SpectralNode( const Format &format )
+	: Node( format ), mFftSize( format.getFftSize() ), mHopSize( format.getHopSize() ), mHopPos( 0 ), mWindowType( format.getWindowType() )
+{
+}
+
+SpectralNode::~SpectralNode()
+{
+}
+
+void SpectralNode::initialize()
+{
+	mFftSize = dsp::FftPlan::getNextSupportedSize( max<size_t>( mFftSize, 2 ) );
+	if( ! mHopSize )
+		mHopSize = mFftSize / 4;
+	mHopSize = min( mHopSize, mFftSize );
+
+	const size_t numChannels = getNumChannels();
+
+	if( ! mFft || mFft->getSize() != mFftSize )
+		mFft.reset( new dsp::Fft( mFftSize ) );
+
+	mInputBuffer = Buffer( mFftSize, numChannels );
+	mFftBuffer = Buffer( mFftSize, numChannels );
+	mOverlapBuffer = Buffer( mFftSize, numChannels );
+	mSpectra.assign( numChannels, BufferSpectral( mFftSize ) );
+	mHopPos = 0;
+
+	mAnalysisWindow.resize( mFftSize );
+	mSynthesisWindow.resize( mFftSize );
+	dsp::generateWindow( mWindowType, mAnalysisWindow.data(), mFftSize );
+
+	// Weighted overlap-add normalization: each output sample is the sum of all frames overlapping it, weighted by both windows,
+	// so dividing by the sum of the squared windows at that position makes an unmodified spectrum reconstruct the input exactly.
+	// If the windows vanish at some position, as at the edges of a HANN window when the hop equals the fft size, that position
+	// can't be reconstructed, so the hop is halved until every position is covered.
+	while( ! computeSynthesisWindow() && mHopSize > 1 )
+		mHopSize /= 2;
+}
+
+bool SpectralNode::computeSynthesisWindow()
+{
+	bool covered = true;
+	for( size_t i = 0; i < mFftSize; i++ ) {
+		float windowSum = 0;
+		for( size_t k = i % mHopSize; k < mFftSize; k += mHopSize )
+			windowSum += mAnalysisWindow[k] * mAnalysisWindow[k];
+
+		if( windowSum > 1e-6f )
+			mSynthesisWindow[i] = mAnalysisWindow[i] / windowSum;
+		else {
+			mSynthesisWindow[i] = 0;
+			covered = false;
+		}
+	}
+
+	return covered;
+}
+
+void SpectralNode::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChannels = buffer->getNumChannels();
+	const size_t inputOffset = mFftSize - mHopSize;
+
+	// new input goes to the end of the input buffer while finished output is read from the start of the overlap buffer, a hop at a time.
+	size_t frame = 0;
+	while( frame < numFrames ) {
+		const size_t count = min( numFrames - frame, mHopSize - mHopPos );
+
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			float *channel = buffer->getChannel( ch ) + frame;
+			memcpy( mInputBuffer.getChannel( ch ) + inputOffset + mHopPos, channel, count * sizeof( float ) );
+			memcpy( channel, mOverlapBuffer.getChannel( ch ) + mHopPos, count * sizeof( float ) );
+		}
+
+		mHopPos += count;
+		frame += count;
+
+		if( mHopPos == mHopSize ) {
+			processFrame();
+			mHopPos = 0;
+		}
+	}
+}
+
+void SpectralNode::processFrame()
+{
+	const size_t numChannels = mInputBuffer.getNumChannels();
+	const size_t remaining = mFftSize - mHopSize;
+
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		dsp::mul( mInputBuffer.getChannel( ch ), mAnalysisWindow.data(), mFftBuffer.getChannel( ch ), mFftSize );
+
+	mFft->forwardBatch( &mFftBuffer, mSpectra.data() );
+	processSpectrum( mSpectra.data() );
+	mFft->inverseBatch( mSpectra.data(), &mFftBuffer );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		// discard the hop that was just output and make room for this frame
+		float *overlap = mOverlapBuffer.getChannel( ch );
+		memmove( overlap, overlap + mHopSize, remaining * sizeof( float ) );
+		dsp::fill( 0.0f, overlap + remaining, mHopSize );
+
+		float *frameData = mFftBuffer.getChannel( ch );
+		dsp::mul( frameData, mSynthesisWindow.data(), frameData, mFftSize );
+		dsp::add( overlap, frameData, overlap, mFftSize );
+
+		float *input = mInputBuffer.getChannel( ch );
+		memmove( input, input + mHopSize, remaining * sizeof( float ) );
+	}
+}
+
+void SpectralNode::reset()
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mInputBuffer.zero();
+	mOverlapBuffer.zero();
+	mHopPos = 0;
+}
+
+float SpectralNode::getFreqForBin( size_t bin ) const
+{
+	return bin * getSampleRate() / (float)mFftSize;
+}
+
+} } // namespace cinder::audio
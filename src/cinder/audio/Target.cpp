@@ -22,10 +22,16 @@
  */
 
 #include "cinder/audio/Target.h"
+#include "cinder/audio/FileOggVorbis.h"
+#include "cinder/audio/FileFlac.h"
+#include "cinder/audio/Exception.h"
 #include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
 
 #include "cinder/Utilities.h"
 
+#include <chrono>
+
 #if defined( CINDER_COCOA )
 	#include "cinder/audio/cocoa/FileCoreAudio.h"
 #elif defined( CINDER_MSW )
@@ -41,16 +47,23 @@ namespace cinder { namespace audio {
 std::unique_ptr<TargetFile> TargetFile::create( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType, const std::string &extension )
 {
 #if ! defined( CINDER_UWP ) || ( _MSC_VER > 1800 )
-	std::string ext = dataTarget->getFilePathHint().extension().string();
+	std::string ext = extension.empty() ? dataTarget->getFilePathHint().extension().string() : extension;
 #else
-	std::string ext = dataTarget->getFilePathHint().extension();
+	std::string ext = extension.empty() ? dataTarget->getFilePathHint().extension() : extension;
 #endif
 	ext = ( ( ! ext.empty() ) && ( ext[0] == '.' ) ) ? ext.substr( 1, string::npos ) : ext;
 
+	if( ext == "ogg" )
+		return std::unique_ptr<TargetFile>( new TargetFileOggVorbis( dataTarget, sampleRate, numChannels, sampleType ) );
+	else if( ext == "flac" )
+		return std::unique_ptr<TargetFile>( new TargetFileFlac( dataTarget, sampleRate, numChannels, sampleType ) );
+
 #if defined( CINDER_COCOA )
 	return std::unique_ptr<TargetFile>( new cocoa::TargetFileCoreAudio( dataTarget, sampleRate, numChannels, sampleType, ext ) );
 #elif defined( CINDER_MSW )
 	return std::unique_ptr<TargetFile>( new msw::TargetFileMediaFoundation( dataTarget, sampleRate, numChannels, sampleType, ext ) );
+#else
+	throw AudioFileExc( "no TargetFile available for extension: " + ext );
 #endif
 }
 
@@ -84,4 +97,130 @@ void TargetFile::write( const Buffer *buffer, size_t numFrames, size_t frameOffs
 	performWrite( buffer, numFrames, frameOffset );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - TargetFileAsync
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+// The background thread wakes up at least this often to look for new frames, so that write() never has to touch the mutex.
+const auto ASYNC_POLL_INTERVAL = std::chrono::milliseconds( 10 );
+const size_t ASYNC_MAX_FRAMES_PER_WRITE = 4096;
+
+} // anonymous namespace
+
+TargetFileAsync::TargetFileAsync( std::unique_ptr<TargetFile> &&target, size_t maxBufferedFrames )
+	: TargetFile( nullptr, target->getSampleRate(), target->getNumChannels(), target->getSampleType() ), mTarget( move( target ) ),
+		mRunning( true ), mNumFramesWritten( 0 ), mNumFramesFlushed( 0 ), mNumFramesDropped( 0 )
+{
+	if( ! maxBufferedFrames )
+		maxBufferedFrames = mSampleRate;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		mRingBuffers.emplace_back( maxBufferedFrames );
+
+	mWriteBuffer.setSize( min( maxBufferedFrames, ASYNC_MAX_FRAMES_PER_WRITE ), mNumChannels );
+	mThread = thread( [this] { run(); } );
+}
+
+TargetFileAsync::~TargetFileAsync()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mRunning = false;
+	}
+	mCondition.notify_one();
+	mThread.join();
+
+	if( mException ) {
+		try {
+			rethrow_exception( mException );
+		}
+		catch( std::exception &exc ) {
+			CI_LOG_E( "exception while writing: " << exc.what() );
+		}
+		catch( ... ) {
+			CI_LOG_E( "unknown exception while writing" );
+		}
+	}
+
+	// mTarget is destroyed (and finalized) after this, on the calling thread.
+}
+
+void TargetFileAsync::flush()
+{
+	unique_lock<mutex> lock( mMutex );
+	mCondition.notify_one();
+	mFlushCondition.wait( lock, [this] { return mNumFramesFlushed == mNumFramesWritten || mException; } );
+
+	if( mException ) {
+		auto exc = mException;
+		mException = nullptr;
+		rethrow_exception( exc );
+	}
+}
+
+void TargetFileAsync::performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset )
+{
+	CI_ASSERT( buffer->getNumChannels() >= mNumChannels );
+
+	// frames are only accepted if all channels fit, so that the channels stay aligned.
+	if( mRingBuffers.back().getAvailableWrite() < numFrames ) {
+		mNumFramesDropped += numFrames;
+		return;
+	}
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		mRingBuffers[ch].write( buffer->getChannel( ch ) + frameOffset, numFrames );
+
+	mNumFramesWritten += numFrames;
+}
+
+void TargetFileAsync::run()
+{
+	while( true ) {
+		bool running;
+		{
+			unique_lock<mutex> lock( mMutex );
+			mCondition.wait_for( lock, ASYNC_POLL_INTERVAL );
+			running = mRunning;
+		}
+
+		// drain once more after being stopped, to pick up the frames written before destruction.
+		writeAvailable();
+		if( ! running )
+			break;
+	}
+}
+
+void TargetFileAsync::writeAvailable()
+{
+	while( true ) {
+		// the last channel is written last, so it has the least frames available.
+		size_t numFrames = min( mRingBuffers.back().getAvailableRead(), mWriteBuffer.getNumFrames() );
+		if( ! numFrames )
+			break;
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ )
+			mRingBuffers[ch].read( mWriteBuffer.getChannel( ch ), numFrames );
+
+		try {
+			mTarget->write( &mWriteBuffer, numFrames );
+		}
+		catch( ... ) {
+			lock_guard<mutex> lock( mMutex );
+			mException = current_exception();
+		}
+
+		// frames are considered flushed even if writing them failed, the exception is reported from flush() instead.
+		mNumFramesFlushed += numFrames;
+	}
+
+	// lock before notifying so a flush() that is about to wait can't miss the notification.
+	{
+		lock_guard<mutex> lock( mMutex );
+	}
+	mFlushCondition.notify_all();
+}
+
 } } // namespace cinder::audio
@@ -24,6 +24,12 @@
 #include "cinder/audio/Utilities.h"
 #include "cinder/CinderMath.h"
 
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#else
+	#include <chrono>
+#endif
+
 using namespace std;
 
 namespace cinder { namespace audio {
@@ -78,6 +84,38 @@ uint64_t timeToFrame( double timeSeconds, double sampleRate )
 	return static_cast<uint64_t>( lround( timeSeconds * sampleRate ) );
 }
 
+#if defined( CINDER_MSW )
+
+namespace {
+
+// std::chrono clocks are not high resolution on all supported msvc versions, so use the performance counter directly.
+double getPerformanceCounterNanosPerTick()
+{
+	::LARGE_INTEGER freq;
+	::QueryPerformanceFrequency( &freq );
+	return 1e9 / (double)freq.QuadPart;
+}
+
+const double sPerformanceCounterNanosPerTick = getPerformanceCounterNanosPerTick();
+
+} // anonymous namespace
+
+uint64_t getTimestampNanoseconds()
+{
+	::LARGE_INTEGER counter;
+	::QueryPerformanceCounter( &counter );
+	return static_cast<uint64_t>( (double)counter.QuadPart * sPerformanceCounterNanosPerTick );
+}
+
+#else
+
+uint64_t getTimestampNanoseconds()
+{
+	return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+
+#endif
+
 bool thresholdBuffer( const Buffer &buffer, float threshold, size_t *recordFrame )
 {
 	const float *buf = buffer.getData();
@@ -0,0 +1,443 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/VoicePoolNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Utilities.h"
+#include "cinder/CinderMath.h"
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// Mixes \a sample into \a buffer between frames [frameBegin, frameEnd), advancing \a readPos. If \a rampStep is non-zero, the gain is also
+// multiplied by a linear ramp starting at \a ramp. Returns false if the sample ended and isn't looping.
+bool mixSample( const Buffer *sample, size_t *readPos, bool loop, float gainLeft, float gainRight, float ramp, float rampStep, Buffer *buffer, size_t frameBegin, size_t frameEnd )
+{
+	const size_t numChannels = buffer->getNumChannels();
+	const size_t numSampleChannels = sample->getNumChannels();
+	const size_t numSampleFrames = sample->getNumFrames();
+
+	size_t frame = frameBegin;
+	while( frame < frameEnd ) {
+		if( *readPos >= numSampleFrames ) {
+			if( ! loop || ! numSampleFrames )
+				return false;
+
+			*readPos = 0;
+		}
+
+		const size_t count = min( frameEnd - frame, numSampleFrames - *readPos );
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			const float *in = sample->getChannel( min( ch, numSampleChannels - 1 ) ) + *readPos;
+			float *out = buffer->getChannel( ch ) + frame;
+			const float gain = ( ch == 1 ? gainRight : gainLeft );
+
+			if( rampStep == 0 ) {
+				for( size_t i = 0; i < count; i++ )
+					out[i] += in[i] * gain;
+			}
+			else {
+				float g = ramp;
+				for( size_t i = 0; i < count; i++ ) {
+					out[i] += in[i] * gain * g;
+					g -= rampStep;
+				}
+			}
+		}
+
+		ramp -= rampStep * count;
+		frame += count;
+		*readPos += count;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+VoicePoolNode::VoicePoolNode( const Format &format )
+	: InputNode( format ), mStealPolicy( format.getStealPolicy() ), mFadeSeconds( format.getFadeSeconds() ), mFadeFrames( 1 ),
+		mMaxPendingTriggers( max<size_t>( format.getMaxPendingTriggers(), 1 ) ), mNextVoiceId( 1 ), mBlockFrame( 0 ),
+		mNumSamples( 0 ), mNumActiveVoices( 0 ), mNumStolenVoices( 0 ), mNumDroppedTriggers( 0 )
+{
+	setChannelMode( ChannelMode::SPECIFIED );
+	if( ! format.getChannels() )
+		setNumChannels( 2 );
+
+	// triggers are what start playback, so there is no reason to require enable() like other InputNode's
+	if( boost::indeterminate( format.getAutoEnable() ) )
+		setAutoEnabled( true );
+
+	mVoices.resize( max<size_t>( format.getMaxVoices(), 1 ) );
+	for( auto &voice : mVoices ) {
+		voice.mId = 0;
+		voice.mSample = nullptr;
+		voice.mFadeSample = nullptr;
+		voice.mFadeFramesLeft = 0;
+	}
+
+	mPendingTriggers.reserve( mMaxPendingTriggers );
+	mCommands.resize( mMaxPendingTriggers );
+}
+
+VoicePoolNode::~VoicePoolNode()
+{
+}
+
+void VoicePoolNode::initialize()
+{
+	mFadeFrames = max<size_t>( 1, (size_t)( mFadeSeconds * (double)getSampleRate() ) );
+}
+
+size_t VoicePoolNode::addSample( const BufferRef &buffer )
+{
+	CI_ASSERT( buffer );
+
+	// the vector may reallocate, so it can't be modified while processing
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mSamples.push_back( buffer );
+	mNumSamples = mSamples.size();
+	return mSamples.size() - 1;
+}
+
+size_t VoicePoolNode::loadSample( const SourceFileRef &sourceFile )
+{
+	size_t sampleRate = getSampleRate();
+	if( sampleRate == sourceFile->getSampleRate() )
+		return addSample( sourceFile->loadBuffer() );
+	else {
+		auto sf = sourceFile->cloneWithSampleRate( sampleRate );
+		return addSample( sf->loadBuffer() );
+	}
+}
+
+void VoicePoolNode::clearSamples()
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	// voices reference the samples directly, so they are cut rather than faded out
+	for( auto &voice : mVoices ) {
+		voice.mSample = nullptr;
+		voice.mFadeSample = nullptr;
+		voice.mFadeFramesLeft = 0;
+	}
+
+	mPendingTriggers.clear();
+	mSamples.clear();
+	mNumSamples = 0;
+	mNumActiveVoices = 0;
+}
+
+VoicePoolNode::VoiceId VoicePoolNode::trigger( size_t sampleIndex, const TriggerOptions &options )
+{
+	return pushTrigger( sampleIndex, 0, options );
+}
+
+VoicePoolNode::VoiceId VoicePoolNode::trigger( size_t sampleIndex, double when, const TriggerOptions &options )
+{
+	return pushTrigger( sampleIndex, timeToFrame( when, (double)getSampleRate() ), options );
+}
+
+bool VoicePoolNode::stop( VoiceId voiceId )
+{
+	Command command;
+	command.mType = CommandType::STOP;
+	command.mVoiceId = voiceId;
+	return pushCommand( command );
+}
+
+bool VoicePoolNode::stopAll()
+{
+	Command command;
+	command.mType = CommandType::STOP_ALL;
+	command.mVoiceId = 0;
+	return pushCommand( command );
+}
+
+VoicePoolNode::VoiceId VoicePoolNode::pushTrigger( size_t sampleIndex, uint64_t startFrame, const TriggerOptions &options )
+{
+	CI_ASSERT_MSG( sampleIndex < mNumSamples, "sample index out of range" );
+
+	Command command;
+	command.mType = CommandType::TRIGGER;
+	command.mSampleIndex = sampleIndex;
+	command.mStartFrame = startFrame;
+	command.mGain = options.getGain();
+	command.mPan = options.getPan();
+	command.mPriority = options.getPriority();
+	command.mLoop = options.isLoop();
+
+	lock_guard<mutex> lock( mCommandWriteMutex );
+
+	command.mVoiceId = mNextVoiceId;
+	if( ! mCommands.write( &command, 1 ) ) {
+		mNumDroppedTriggers++;
+		return 0;
+	}
+
+	mNextVoiceId++;
+	return command.mVoiceId;
+}
+
+bool VoicePoolNode::pushCommand( const Command &command )
+{
+	lock_guard<mutex> lock( mCommandWriteMutex );
+	return mCommands.write( &command, 1 );
+}
+
+void VoicePoolNode::processCommands( uint64_t frame, Buffer *buffer )
+{
+	Command command;
+	while( mCommands.read( &command, 1 ) ) {
+		switch( command.mType ) {
+			case CommandType::TRIGGER:
+				if( mPendingTriggers.size() < mMaxPendingTriggers )
+					mPendingTriggers.push_back( command );
+				else
+					mNumDroppedTriggers++;
+				break;
+			case CommandType::STOP: {
+				bool found = false;
+				for( size_t i = 0; i < mPendingTriggers.size(); i++ ) {
+					if( mPendingTriggers[i].mVoiceId == command.mVoiceId ) {
+						mPendingTriggers[i] = mPendingTriggers.back();
+						mPendingTriggers.pop_back();
+						found = true;
+						break;
+					}
+				}
+				if( found )
+					break;
+
+				for( auto &voice : mVoices ) {
+					if( voice.mSample && voice.mId == command.mVoiceId ) {
+						fadeOutVoice( &voice, frame, buffer );
+						break;
+					}
+				}
+				break;
+			}
+			case CommandType::STOP_ALL:
+				mPendingTriggers.clear();
+				for( auto &voice : mVoices ) {
+					if( voice.mSample )
+						fadeOutVoice( &voice, frame, buffer );
+				}
+				break;
+			default:
+				CI_ASSERT_NOT_REACHABLE();
+		}
+	}
+}
+
+void VoicePoolNode::process( Buffer *buffer )
+{
+	const auto &frameRange = getProcessFramesRange();
+	mBlockFrame = getContext()->getNumProcessedFrames();
+
+	buffer->zero();
+	processCommands( mBlockFrame + frameRange.first, buffer );
+
+	// start the triggers that are due within this block, earliest first so that stealing respects their order
+	const uint64_t blockEnd = mBlockFrame + frameRange.second;
+	while( ! mPendingTriggers.empty() ) {
+		size_t earliest = mPendingTriggers.size();
+		for( size_t i = 0; i < mPendingTriggers.size(); i++ ) {
+			if( mPendingTriggers[i].mStartFrame < blockEnd && ( earliest == mPendingTriggers.size() || mPendingTriggers[i].mStartFrame < mPendingTriggers[earliest].mStartFrame ) )
+				earliest = i;
+		}
+		if( earliest == mPendingTriggers.size() )
+			break;
+
+		const Command trigger = mPendingTriggers[earliest];
+		mPendingTriggers[earliest] = mPendingTriggers.back();
+		mPendingTriggers.pop_back();
+
+		size_t frameOffset = frameRange.first;
+		if( trigger.mStartFrame > mBlockFrame + frameRange.first )
+			frameOffset = size_t( trigger.mStartFrame - mBlockFrame );
+
+		startVoice( trigger, frameOffset, buffer );
+	}
+
+	size_t numActiveVoices = 0;
+	for( auto &voice : mVoices ) {
+		if( voice.mFadeFramesLeft )
+			renderFade( &voice, frameRange.second, buffer );
+		if( voice.mSample ) {
+			renderVoice( &voice, frameRange.second, buffer );
+			if( voice.mSample )
+				numActiveVoices++;
+		}
+	}
+
+	mNumActiveVoices = numActiveVoices;
+}
+
+void VoicePoolNode::startVoice( const Command &trigger, size_t frameOffset, Buffer *buffer )
+{
+	if( trigger.mSampleIndex >= mSamples.size() )
+		return;
+
+	VoiceState *voice = findVoice( trigger.mPriority );
+	if( ! voice ) {
+		mNumDroppedTriggers++;
+		return;
+	}
+
+	if( voice->mSample ) {
+		// stolen, render what it had left up until the trigger and fade it out from there
+		mNumStolenVoices++;
+		renderVoice( voice, frameOffset, buffer );
+		if( voice->mSample )
+			fadeOutVoice( voice, mBlockFrame + frameOffset, buffer );
+	}
+
+	const float pan = math<float>::clamp( trigger.mPan, 0, 1 );
+	const Buffer *sample = mSamples[trigger.mSampleIndex].get();
+
+	voice->mId = trigger.mVoiceId;
+	voice->mSample = sample;
+	voice->mReadPos = 0;
+	voice->mStartFrame = mBlockFrame + frameOffset;
+	voice->mGain = trigger.mGain;
+	voice->mPriority = trigger.mPriority;
+	voice->mLoop = trigger.mLoop;
+
+	if( getNumChannels() != 2 )
+		voice->mGainLeft = voice->mGainRight = trigger.mGain;
+	else if( sample->getNumChannels() == 1 ) {
+		// equal power panning, same as Pan2dNode
+		voice->mGainLeft = trigger.mGain * cos( pan * float( M_PI / 2 ) );
+		voice->mGainRight = trigger.mGain * sin( pan * float( M_PI / 2 ) );
+	}
+	else {
+		// balance for multi-channel samples, unity when centered
+		voice->mGainLeft = trigger.mGain * min( 1.0f, 2 * ( 1 - pan ) );
+		voice->mGainRight = trigger.mGain * min( 1.0f, 2 * pan );
+	}
+}
+
+VoicePoolNode::VoiceState* VoicePoolNode::findVoice( int priority )
+{
+	// prefer a free slot that isn't fading out, then any free slot
+	VoiceState *freeVoice = nullptr;
+	for( auto &voice : mVoices ) {
+		if( ! voice.mSample ) {
+			if( ! voice.mFadeFramesLeft )
+				return &voice;
+			if( ! freeVoice )
+				freeVoice = &voice;
+		}
+	}
+
+	if( freeVoice )
+		return freeVoice;
+
+	VoiceState *result = nullptr;
+	switch( mStealPolicy ) {
+		case StealPolicy::NONE:
+			break;
+		case StealPolicy::OLDEST:
+			for( auto &voice : mVoices ) {
+				if( ! result || voice.mStartFrame < result->mStartFrame )
+					result = &voice;
+			}
+			break;
+		case StealPolicy::QUIETEST:
+			for( auto &voice : mVoices ) {
+				if( ! result || fabs( voice.mGain ) < fabs( result->mGain ) )
+					result = &voice;
+			}
+			break;
+		case StealPolicy::LOWEST_PRIORITY:
+			for( auto &voice : mVoices ) {
+				if( ! result || voice.mPriority < result->mPriority || ( voice.mPriority == result->mPriority && voice.mStartFrame < result->mStartFrame ) )
+					result = &voice;
+			}
+			if( result && result->mPriority > priority )
+				result = nullptr;
+			break;
+		default:
+			CI_ASSERT_NOT_REACHABLE();
+	}
+
+	return result;
+}
+
+void VoicePoolNode::fadeOutVoice( VoiceState *voice, uint64_t frame, Buffer *buffer )
+{
+	// a previous fade in this slot is cut short, after rendering what it had up until now
+	if( voice->mFadeFramesLeft )
+		renderFade( voice, size_t( frame - mBlockFrame ), buffer );
+
+	voice->mFadeSample = voice->mSample;
+	voice->mFadeReadPos = voice->mReadPos;
+	voice->mFadeFramesLeft = mFadeFrames;
+	voice->mFadeStartFrame = max( frame, voice->mStartFrame );
+	voice->mFadeGainLeft = voice->mGainLeft;
+	voice->mFadeGainRight = voice->mGainRight;
+	voice->mFadeLoop = voice->mLoop;
+
+	voice->mSample = nullptr;
+}
+
+void VoicePoolNode::renderVoice( VoiceState *voice, size_t frameEnd, Buffer *buffer )
+{
+	size_t frameBegin = getProcessFramesRange().first;
+	if( voice->mStartFrame > mBlockFrame + frameBegin )
+		frameBegin = size_t( voice->mStartFrame - mBlockFrame );
+
+	if( frameBegin >= frameEnd )
+		return;
+
+	if( ! mixSample( voice->mSample, &voice->mReadPos, voice->mLoop, voice->mGainLeft, voice->mGainRight, 1, 0, buffer, frameBegin, frameEnd ) )
+		voice->mSample = nullptr;
+}
+
+void VoicePoolNode::renderFade( VoiceState *voice, size_t frameEnd, Buffer *buffer )
+{
+	size_t frameBegin = getProcessFramesRange().first;
+	if( voice->mFadeStartFrame > mBlockFrame + frameBegin )
+		frameBegin = size_t( voice->mFadeStartFrame - mBlockFrame );
+
+	if( frameBegin >= frameEnd )
+		return;
+
+	const size_t numFrames = min( frameEnd - frameBegin, voice->mFadeFramesLeft );
+	const float rampStep = 1.0f / float( mFadeFrames );
+	const float ramp = float( voice->mFadeFramesLeft ) * rampStep;
+
+	bool playing = mixSample( voice->mFadeSample, &voice->mFadeReadPos, voice->mFadeLoop, voice->mFadeGainLeft, voice->mFadeGainRight, ramp, rampStep, buffer, frameBegin, frameBegin + numFrames );
+
+	voice->mFadeFramesLeft = playing ? voice->mFadeFramesLeft - numFrames : 0;
+	voice->mFadeStartFrame = mBlockFrame + frameBegin + numFrames;
+	if( ! voice->mFadeFramesLeft )
+		voice->mFadeSample = nullptr;
+}
+
+} } // namespace cinder::audio
@@ -0,0 +1,268 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/dsp/ConverterResampler.h"
+#include "cinder/audio/dsp/Simd.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/CinderMath.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+namespace {
+
+// Number of sinc kernel taps on each side of the interpolation point, at a rate of 1. This is scaled up when downsampling so that the
+// cutoff frequency can be lowered without losing stopband attenuation.
+const size_t SINC_HALF_TAPS = 16;
+// Number of fractional positions that the sinc kernel is tabulated at. Positions between two phases are linearly interpolated.
+const size_t SINC_NUM_PHASES = 256;
+// Cutoff as a fraction of the lower nyquist frequency, leaves room for the transition band.
+const double SINC_ROLLOFF = 0.94;
+// Kaiser window shape, about 80 dB of stopband attenuation.
+const double SINC_KAISER_BETA = 8.0;
+
+// Zeroth order modified bessel function of the first kind, used for the kaiser window.
+double besselI0( double x )
+{
+	double result = 1;
+	double term = 1;
+	const double halfXSquared = x * x * 0.25;
+	for( int k = 1; k < 32; k++ ) {
+		term *= halfXSquared / double( k * k );
+		result += term;
+		if( term < result * 1e-12 )
+			break;
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+ConverterImplResampler::ConverterImplResampler( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality )
+	: Converter( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock ), mQuality( quality ), mTargetRate( 1 )
+{
+	if( mQuality == Quality::BEST )
+		mQuality = Quality::SINC;
+
+	mBaseStep = (double)mSourceSampleRate / (double)mDestSampleRate;
+	mStep = mTargetStep = mBaseStep;
+
+	switch( mQuality ) {
+		case Quality::LINEAR:	mNumTaps = 2; break;
+		case Quality::CUBIC:	mNumTaps = 4; break;
+		default:				setupSincKernel(); break;
+	}
+
+	// resample dest channels when downmixing, source channels when upmixing, same as ConverterImplR8brain.
+	const size_t numResampledChannels = min( mSourceNumChannels, mDestNumChannels );
+	if( mSourceNumChannels > mDestNumChannels )
+		mMixingBuffer = Buffer( mSourceMaxFramesPerBlock, mDestNumChannels );
+	else if( mSourceNumChannels < mDestNumChannels )
+		mMixingBuffer = Buffer( mDestMaxFramesPerBlock, mSourceNumChannels );
+
+	mHistory = Buffer( mNumTaps + mSourceMaxFramesPerBlock * 2, numResampledChannels );
+	clear();
+}
+
+void ConverterImplResampler::setupSincKernel()
+{
+	// when downsampling, lower the cutoff to the destination nyquist and widen the kernel by the same amount.
+	const double downsampleFactor = max( 1.0, mBaseStep );
+	const double cutoff = 0.5 * SINC_ROLLOFF / downsampleFactor;
+
+	// keep the number of taps a multiple of 4 for the vectorized dot product.
+	size_t halfTaps = (size_t)ceil( SINC_HALF_TAPS * downsampleFactor );
+	halfTaps += halfTaps % 2;
+	mNumTaps = halfTaps * 2;
+
+	mKernel.resize( ( SINC_NUM_PHASES + 1 ) * mNumTaps );
+	mBlendedKernel.resize( mNumTaps );
+
+	const double windowNormalizer = 1.0 / besselI0( SINC_KAISER_BETA );
+	for( size_t phase = 0; phase <= SINC_NUM_PHASES; phase++ ) {
+		const double frac = (double)phase / (double)SINC_NUM_PHASES;
+		float *row = &mKernel[phase * mNumTaps];
+
+		double sum = 0;
+		vector<double> coeffs( mNumTaps );
+		for( size_t i = 0; i < mNumTaps; i++ ) {
+			// distance in source frames from the interpolation point to tap i.
+			const double x = (double)i - (double)( halfTaps - 1 ) - frac;
+			const double sincArg = 2.0 * M_PI * cutoff * x;
+			const double sinc = abs( sincArg ) < 1e-9 ? 1.0 : sin( sincArg ) / sincArg;
+			const double windowArg = x / (double)halfTaps;
+			const double window = abs( windowArg ) >= 1 ? 0.0 : besselI0( SINC_KAISER_BETA * sqrt( 1.0 - windowArg * windowArg ) ) * windowNormalizer;
+
+			coeffs[i] = sinc * window;
+			sum += coeffs[i];
+		}
+
+		// normalize each phase for unity gain at DC
+		for( size_t i = 0; i < mNumTaps; i++ )
+			row[i] = float( coeffs[i] / sum );
+	}
+}
+
+void ConverterImplResampler::clear()
+{
+	mHistory.zero();
+
+	// start with the frames that precede the first source frame as silence, so output is aligned with the source.
+	mNumHistoryFrames = mNumTaps / 2 - 1;
+	mPos = 0;
+	mStep = mTargetStep;
+	mNumRampFramesRemaining = 0;
+}
+
+void ConverterImplResampler::setRate( double rate, size_t rampFrames )
+{
+	CI_ASSERT( rate > 0 );
+
+	mTargetRate = rate;
+	mTargetStep = mBaseStep * rate;
+
+	if( rampFrames ) {
+		mStepIncrement = ( mTargetStep - mStep ) / (double)rampFrames;
+		mNumRampFramesRemaining = rampFrames;
+	}
+	else {
+		mStep = mTargetStep;
+		mNumRampFramesRemaining = 0;
+	}
+}
+
+pair<size_t, size_t> ConverterImplResampler::convert( const Buffer *sourceBuffer, Buffer *destBuffer )
+{
+	CI_ASSERT( sourceBuffer->getNumChannels() == mSourceNumChannels && destBuffer->getNumChannels() == mDestNumChannels );
+
+	// only take as many source frames as there is room for in the history.
+	const size_t readCount = min( min( sourceBuffer->getNumFrames(), mSourceMaxFramesPerBlock ), mHistory.getNumFrames() - mNumHistoryFrames );
+
+	const Buffer *resampledSource = sourceBuffer;
+	if( mSourceNumChannels > mDestNumChannels ) {
+		mixBuffers( sourceBuffer, &mMixingBuffer, readCount );
+		resampledSource = &mMixingBuffer;
+	}
+
+	for( size_t ch = 0; ch < mHistory.getNumChannels(); ch++ )
+		copy( resampledSource->getChannel( ch ), resampledSource->getChannel( ch ) + readCount, mHistory.getChannel( ch ) + mNumHistoryFrames );
+
+	mNumHistoryFrames += readCount;
+
+	size_t outCount;
+	if( mSourceNumChannels < mDestNumChannels ) {
+		outCount = resample( &mMixingBuffer, min( mMixingBuffer.getNumFrames(), destBuffer->getNumFrames() ) );
+		mixBuffers( &mMixingBuffer, destBuffer, outCount );
+	}
+	else
+		outCount = resample( destBuffer, destBuffer->getNumFrames() );
+
+	// discard the source frames that are no longer needed
+	const size_t numConsumed = min( (size_t)mPos, mNumHistoryFrames );
+	if( numConsumed ) {
+		const size_t numRemaining = mNumHistoryFrames - numConsumed;
+		for( size_t ch = 0; ch < mHistory.getNumChannels(); ch++ ) {
+			float *channel = mHistory.getChannel( ch );
+			memmove( channel, channel + numConsumed, numRemaining * sizeof( float ) );
+		}
+
+		mNumHistoryFrames = numRemaining;
+		mPos -= (double)numConsumed;
+	}
+
+	return make_pair( readCount, outCount );
+}
+
+size_t ConverterImplResampler::resample( Buffer *destBuffer, size_t maxNumFrames )
+{
+	const size_t numChannels = mHistory.getNumChannels();
+	const size_t numTaps = mNumTaps;
+
+	size_t count = 0;
+	while( count < maxNumFrames ) {
+		const size_t index = (size_t)mPos;
+		if( index + numTaps > mNumHistoryFrames )
+			break;
+
+		const float frac = float( mPos - (double)index );
+
+		switch( mQuality ) {
+			case Quality::LINEAR: {
+				for( size_t ch = 0; ch < numChannels; ch++ ) {
+					const float *x = mHistory.getChannel( ch ) + index;
+					destBuffer->getChannel( ch )[count] = x[0] + ( x[1] - x[0] ) * frac;
+				}
+				break;
+			}
+			case Quality::CUBIC: {
+				for( size_t ch = 0; ch < numChannels; ch++ ) {
+					const float *x = mHistory.getChannel( ch ) + index;
+					destBuffer->getChannel( ch )[count] = x[1] + 0.5f * frac * ( x[2] - x[0] + frac * ( 2.0f * x[0] - 5.0f * x[1] + 4.0f * x[2] - x[3] + frac * ( 3.0f * ( x[1] - x[2] ) + x[3] - x[0] ) ) );
+				}
+				break;
+			}
+			default: {
+				// blend the two nearest kernel phases once, then apply it to all channels
+				const float phasePos = frac * (float)SINC_NUM_PHASES;
+				const size_t phase = min( (size_t)phasePos, SINC_NUM_PHASES - 1 );
+				const Float4 phaseFrac( phasePos - (float)phase );
+				const float *row0 = &mKernel[phase * numTaps];
+				const float *row1 = row0 + numTaps;
+				float *blended = mBlendedKernel.data();
+				for( size_t i = 0; i < numTaps; i += 4 ) {
+					const Float4 k0 = Float4::load( row0 + i );
+					( k0 + ( Float4::load( row1 + i ) - k0 ) * phaseFrac ).store( blended + i );
+				}
+
+				for( size_t ch = 0; ch < numChannels; ch++ ) {
+					const float *x = mHistory.getChannel( ch ) + index;
+					Float4 sum( 0.0f );
+					for( size_t i = 0; i < numTaps; i += 4 )
+						sum += Float4::load( x + i ) * Float4::load( blended + i );
+
+					destBuffer->getChannel( ch )[count] = sum.sum();
+				}
+				break;
+			}
+		}
+
+		count++;
+		mPos += mStep;
+
+		if( mNumRampFramesRemaining ) {
+			if( --mNumRampFramesRemaining == 0 )
+				mStep = mTargetStep;
+			else
+				mStep += mStepIncrement;
+		}
+	}
+
+	return count;
+}
+
+} } } // namespace cinder::audio::dsp
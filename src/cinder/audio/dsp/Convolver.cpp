@@ -0,0 +1,173 @@
+/*
+ Copyright (c) 2016, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/dsp/Convolver.h"
+#include "cinder/audio/dsp/Fft.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/CinderMath.h"
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ConvolutionKernel
+// ----------------------------------------------------------------------------------------------------
+
+ConvolutionKernel::ConvolutionKernel( const float *impulseResponse, size_t length, size_t partitionSize )
+	: mPartitionSize( partitionSize )
+{
+	if( ! mPartitionSize || ! isPowerOf2( mPartitionSize ) )
+		throw AudioExc( "invalid partition size" );
+
+	const size_t fftSize = mPartitionSize * 2;
+	Fft fft( fftSize );
+	Buffer waveform( fftSize );
+
+	// Fft::forward()'s scaling is implementation specific, so measure it with an impulse and fold the inverse into the kernel.
+	// This makes inverse( forward( x ) * kernel ) equal to x convolved with the impulse response on all platforms.
+	BufferSpectral spectral( fftSize );
+	waveform[0] = 1;
+	fft.forward( &waveform, &spectral );
+	const float scale = 1.0f / spectral.getReal()[0];
+
+	const size_t numPartitions = max<size_t>( 1, ( length + mPartitionSize - 1 ) / mPartitionSize );
+	mPartitions.reserve( numPartitions );
+
+	for( size_t i = 0; i < numPartitions; i++ ) {
+		size_t offset = i * mPartitionSize;
+		size_t count = offset < length ? min( mPartitionSize, length - offset ) : 0;
+
+		waveform.zero();
+		if( count )
+			memcpy( waveform.getData(), impulseResponse + offset, count * sizeof( float ) );
+
+		mPartitions.emplace_back( fftSize );
+		BufferSpectral &partition = mPartitions.back();
+		fft.forward( &waveform, &partition );
+		dsp::mul( partition.getData(), scale, partition.getData(), partition.getSize() );
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Convolver
+// ----------------------------------------------------------------------------------------------------
+
+Convolver::Convolver( const ConvolutionKernelRef &kernel )
+	: mKernel( kernel ), mPartitionSize( kernel->getPartitionSize() ), mInputFill( 0 ), mCurrentSegment( 0 )
+{
+	const size_t fftSize = mPartitionSize * 2;
+
+	mFft.reset( new Fft( fftSize ) );
+	mInputBuffer = Buffer( fftSize );
+	mOutputBuffer = Buffer( fftSize );
+	mPreMultiplied = BufferSpectral( fftSize );
+	mConvolved = BufferSpectral( fftSize );
+
+	mSegments.reserve( mKernel->getNumPartitions() );
+	for( size_t i = 0; i < mKernel->getNumPartitions(); i++ )
+		mSegments.emplace_back( fftSize );
+}
+
+Convolver::~Convolver()
+{
+}
+
+void Convolver::reset()
+{
+	mInputFill = 0;
+	mCurrentSegment = 0;
+	mInputBuffer.zero();
+	mPreMultiplied.zero();
+	for( auto &segment : mSegments )
+		segment.zero();
+}
+
+// The input buffer holds the previous partition followed by the current one, which may only be partially filled (the remainder is zero).
+// Because of overlap-save, the second half of the inverse transform contains valid output for every sample that has arrived so far.
+// The contribution of all older segments only changes once per partition, so it is accumulated once into mPreMultiplied when a new partition begins.
+void Convolver::process( const float *input, float *output, size_t numFrames )
+{
+	const size_t numSegments = mSegments.size();
+	float *inputHalf = mInputBuffer.getData() + mPartitionSize;
+
+	size_t processed = 0;
+	while( processed < numFrames ) {
+		const size_t fillPos = mInputFill;
+		const size_t count = min( numFrames - processed, mPartitionSize - fillPos );
+
+		memcpy( inputHalf + fillPos, input + processed, count * sizeof( float ) );
+		mFft->forward( &mInputBuffer, &mSegments[mCurrentSegment] );
+
+		if( fillPos == 0 ) {
+			mPreMultiplied.zero();
+			for( size_t i = 1; i < numSegments; i++ )
+				multiplyAccumulateSpectral( mSegments[( mCurrentSegment + i ) % numSegments], mKernel->getPartition( i ), &mPreMultiplied );
+		}
+
+		mConvolved.copy( mPreMultiplied );
+		multiplyAccumulateSpectral( mSegments[mCurrentSegment], mKernel->getPartition( 0 ), &mConvolved );
+		mFft->inverse( &mConvolved, &mOutputBuffer );
+
+		memcpy( output + processed, mOutputBuffer.getData() + mPartitionSize + fillPos, count * sizeof( float ) );
+
+		mInputFill += count;
+		processed += count;
+
+		if( mInputFill == mPartitionSize ) {
+			// slide the window: the current partition becomes the previous one, and the delay line advances
+			memcpy( mInputBuffer.getData(), inputHalf, mPartitionSize * sizeof( float ) );
+			memset( inputHalf, 0, mPartitionSize * sizeof( float ) );
+			mInputFill = 0;
+			mCurrentSegment = ( mCurrentSegment > 0 ? mCurrentSegment : numSegments ) - 1;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Free functions
+// ----------------------------------------------------------------------------------------------------
+
+void multiplyAccumulateSpectral( const BufferSpectral &a, const BufferSpectral &b, BufferSpectral *accum )
+{
+	CI_ASSERT( a.getNumFrames() == b.getNumFrames() && a.getNumFrames() == accum->getNumFrames() );
+
+	const size_t numBins = a.getNumFrames();
+	const float *aReal = a.getReal();
+	const float *aImag = a.getImag();
+	const float *bReal = b.getReal();
+	const float *bImag = b.getImag();
+	float *real = accum->getReal();
+	float *imag = accum->getImag();
+
+	// DC and Nyquist are both real and packed into the first bin
+	real[0] += aReal[0] * bReal[0];
+	imag[0] += aImag[0] * bImag[0];
+
+	for( size_t i = 1; i < numBins; i++ ) {
+		real[i] += aReal[i] * bReal[i] - aImag[i] * bImag[i];
+		imag[i] += aReal[i] * bImag[i] + aImag[i] * bReal[i];
+	}
+}
+
+} } } // namespace cinder::audio::dsp
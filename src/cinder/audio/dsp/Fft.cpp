@@ -22,20 +22,350 @@
 */
 
 #include "cinder/audio/dsp/Fft.h"
+#include "cinder/audio/dsp/Simd.h"
 #include "cinder/CinderAssert.h"
 #include "cinder/audio/Exception.h"
 #include "cinder/CinderMath.h"
 
-#if defined( CINDER_AUDIO_FFT_OOURA )
-	#include "cinder/audio/dsp/ooura/fftsg.h"
-#endif
+#include <map>
+#include <mutex>
+
+using namespace std;
 
 namespace cinder { namespace audio { namespace dsp {
 
+namespace {
+
+// Spectral packing conventions. vDSP scales the forward transform by two and uses the usual negative exponent, whereas the generic path
+// matches the Ooura implementation that it replaced (unscaled, conjugated imaginary part) so that results are unchanged on those platforms.
+#if defined( CINDER_AUDIO_VDSP )
+const float FORWARD_SCALE	= 2.0f;
+const float IMAG_SIGN		= 1.0f;
+#else
+const float FORWARD_SCALE	= 1.0f;
+const float IMAG_SIGN		= -1.0f;
+#endif
+
+const size_t BATCH_SIZE = 4; // number of transforms that fit in the lanes of a Float4
+
+mutex									sPlanCacheMutex;
+map<size_t, weak_ptr<const FftPlan> >	sPlanCache;
+
+// Element access for the butterflies below. A Float4 element is four consecutive floats, which are either four adjacent
+// butterflies of a single transform (when the stride allows it) or the same butterfly of four batched transforms.
+template <typename T> T		loadElement( const float *array, size_t index );
+template <typename T> void	storeElement( float *array, size_t index, const T &value );
+
+template <> inline float	loadElement<float>( const float *array, size_t index )						{ return array[index]; }
+template <> inline void		storeElement<float>( float *array, size_t index, const float &value )		{ array[index] = value; }
+template <> inline Float4	loadElement<Float4>( const float *array, size_t index )						{ return Float4::load( array + index * 4 ); }
+template <> inline void		storeElement<Float4>( float *array, size_t index, const Float4 &value )		{ value.store( array + index * 4 ); }
+
+template <typename T>
+inline void storeTwiddled( float *yr, float *yi, size_t index, const T &re, const T &im, float wr, float wi )
+{
+	storeElement( yr, index, re * wr - im * wi );
+	storeElement( yi, index, re * wi + im * wr );
+}
+
+// Stockham autosort passes (decimation in frequency). For a pass of radix r over m butterflies with stride s, input element
+// (q, p, k) is read from q + s * ( p + k * m ) and output j is written to q + s * ( r * p + j ), multiplied by twiddle w^(p * j).
+
+template <typename T>
+void passRadix2( size_t m, size_t s, const float *twr, const float *twi, const float *xr, const float *xi, float *yr, float *yi )
+{
+	for( size_t p = 0; p < m; p++ ) {
+		const float w1r = twr[p], w1i = twi[p];
+		for( size_t q = 0; q < s; q++ ) {
+			const size_t in = q + s * p;
+			const size_t out = q + s * 2 * p;
+			const T a0r = loadElement<T>( xr, in ),			a0i = loadElement<T>( xi, in );
+			const T a1r = loadElement<T>( xr, in + s * m ),	a1i = loadElement<T>( xi, in + s * m );
+
+			storeElement( yr, out, a0r + a1r );
+			storeElement( yi, out, a0i + a1i );
+			storeTwiddled( yr, yi, out + s, a0r - a1r, a0i - a1i, w1r, w1i );
+		}
+	}
+}
+
+template <typename T>
+void passRadix3( size_t m, size_t s, const float *twr, const float *twi, const float *xr, const float *xi, float *yr, float *yi )
+{
+	const float sin60 = 0.866025403784438646763723170752936183f;
+
+	for( size_t p = 0; p < m; p++ ) {
+		const float w1r = twr[p * 2], w1i = twi[p * 2];
+		const float w2r = twr[p * 2 + 1], w2i = twi[p * 2 + 1];
+		for( size_t q = 0; q < s; q++ ) {
+			const size_t in = q + s * p;
+			const size_t out = q + s * 3 * p;
+			const T a0r = loadElement<T>( xr, in ),				a0i = loadElement<T>( xi, in );
+			const T a1r = loadElement<T>( xr, in + s * m ),		a1i = loadElement<T>( xi, in + s * m );
+			const T a2r = loadElement<T>( xr, in + s * m * 2 ),	a2i = loadElement<T>( xi, in + s * m * 2 );
+
+			const T tr = a1r + a2r, ti = a1i + a2i;
+			const T ur = a0r - tr * 0.5f, ui = a0i - ti * 0.5f;
+			const T vr = ( a1i - a2i ) * sin60, vi = ( a2r - a1r ) * sin60; // -i * sin60 * ( a1 - a2 )
+
+			storeElement( yr, out, a0r + tr );
+			storeElement( yi, out, a0i + ti );
+			storeTwiddled( yr, yi, out + s, ur + vr, ui + vi, w1r, w1i );
+			storeTwiddled( yr, yi, out + s * 2, ur - vr, ui - vi, w2r, w2i );
+		}
+	}
+}
+
+template <typename T>
+void passRadix4( size_t m, size_t s, const float *twr, const float *twi, const float *xr, const float *xi, float *yr, float *yi )
+{
+	for( size_t p = 0; p < m; p++ ) {
+		const float w1r = twr[p * 3], w1i = twi[p * 3];
+		const float w2r = twr[p * 3 + 1], w2i = twi[p * 3 + 1];
+		const float w3r = twr[p * 3 + 2], w3i = twi[p * 3 + 2];
+		for( size_t q = 0; q < s; q++ ) {
+			const size_t in = q + s * p;
+			const size_t out = q + s * 4 * p;
+			const T a0r = loadElement<T>( xr, in ),				a0i = loadElement<T>( xi, in );
+			const T a1r = loadElement<T>( xr, in + s * m ),		a1i = loadElement<T>( xi, in + s * m );
+			const T a2r = loadElement<T>( xr, in + s * m * 2 ),	a2i = loadElement<T>( xi, in + s * m * 2 );
+			const T a3r = loadElement<T>( xr, in + s * m * 3 ),	a3i = loadElement<T>( xi, in + s * m * 3 );
+
+			const T t0r = a0r + a2r, t0i = a0i + a2i;
+			const T t1r = a0r - a2r, t1i = a0i - a2i;
+			const T t2r = a1r + a3r, t2i = a1i + a3i;
+			const T dr = a1r - a3r, di = a1i - a3i; // multiplied by -i below
+
+			storeElement( yr, out, t0r + t2r );
+			storeElement( yi, out, t0i + t2i );
+			storeTwiddled( yr, yi, out + s, t1r + di, t1i - dr, w1r, w1i );
+			storeTwiddled( yr, yi, out + s * 2, t0r - t2r, t0i - t2i, w2r, w2i );
+			storeTwiddled( yr, yi, out + s * 3, t1r - di, t1i + dr, w3r, w3i );
+		}
+	}
+}
+
+template <typename T>
+void passRadix5( size_t m, size_t s, const float *twr, const float *twi, const float *xr, const float *xi, float *yr, float *yi )
+{
+	const float c1 = 0.309016994374947424102293417182819059f;	// cos( 2pi / 5 )
+	const float c2 = -0.809016994374947424102293417182819059f;	// cos( 4pi / 5 )
+	const float s1 = 0.951056516295153572116439333379382143f;	// sin( 2pi / 5 )
+	const float s2 = 0.587785252292473129168705954639072769f;	// sin( 4pi / 5 )
+
+	for( size_t p = 0; p < m; p++ ) {
+		const float *w = &twr[p * 4];
+		const float *wi = &twi[p * 4];
+		for( size_t q = 0; q < s; q++ ) {
+			const size_t in = q + s * p;
+			const size_t out = q + s * 5 * p;
+			const T a0r = loadElement<T>( xr, in ),				a0i = loadElement<T>( xi, in );
+			const T a1r = loadElement<T>( xr, in + s * m ),		a1i = loadElement<T>( xi, in + s * m );
+			const T a2r = loadElement<T>( xr, in + s * m * 2 ),	a2i = loadElement<T>( xi, in + s * m * 2 );
+			const T a3r = loadElement<T>( xr, in + s * m * 3 ),	a3i = loadElement<T>( xi, in + s * m * 3 );
+			const T a4r = loadElement<T>( xr, in + s * m * 4 ),	a4i = loadElement<T>( xi, in + s * m * 4 );
+
+			const T b1r = a1r + a4r, b1i = a1i + a4i;
+			const T b2r = a2r + a3r, b2i = a2i + a3i;
+			const T d1r = a1r - a4r, d1i = a1i - a4i;
+			const T d2r = a2r - a3r, d2i = a2i - a3i;
+
+			const T u1r = a0r + b1r * c1 + b2r * c2, u1i = a0i + b1i * c1 + b2i * c2;
+			const T u2r = a0r + b1r * c2 + b2r * c1, u2i = a0i + b1i * c2 + b2i * c1;
+			const T e1r = d1r * s1 + d2r * s2, e1i = d1i * s1 + d2i * s2;
+			const T e2r = d1r * s2 - d2r * s1, e2i = d1i * s2 - d2i * s1;
+
+			storeElement( yr, out, a0r + b1r + b2r );
+			storeElement( yi, out, a0i + b1i + b2i );
+			storeTwiddled( yr, yi, out + s, u1r + e1i, u1i - e1r, w[0], wi[0] );
+			storeTwiddled( yr, yi, out + s * 2, u2r + e2i, u2i - e2r, w[1], wi[1] );
+			storeTwiddled( yr, yi, out + s * 3, u2r - e2i, u2i + e2r, w[2], wi[2] );
+			storeTwiddled( yr, yi, out + s * 4, u1r - e1i, u1i + e1r, w[3], wi[3] );
+		}
+	}
+}
+
+template <typename T>
+void runPass( size_t radix, size_t m, size_t s, const float *twr, const float *twi, const float *xr, const float *xi, float *yr, float *yi )
+{
+	switch( radix ) {
+		case 2: passRadix2<T>( m, s, twr, twi, xr, xi, yr, yi ); break;
+		case 3: passRadix3<T>( m, s, twr, twi, xr, xi, yr, yi ); break;
+		case 4: passRadix4<T>( m, s, twr, twi, xr, xi, yr, yi ); break;
+		case 5: passRadix5<T>( m, s, twr, twi, xr, xi, yr, yi ); break;
+		default: CI_ASSERT_NOT_REACHABLE();
+	}
+}
+
+// Forward complex transform of \a re, \a im, ping-ponging with \a workRe, \a workIm. When \a batched is true, every element is a Float4 holding
+// four independent transforms. Otherwise passes whose stride is a multiple of four are vectorized across adjacent butterflies.
+// Returns true if the result ended up in the work buffers.
+bool transformComplex( const vector<FftPlan::Stage> &stages, const float *twiddlesReal, const float *twiddlesImag, bool batched, float *re, float *im, float *workRe, float *workIm )
+{
+	float *xr = re, *xi = im, *yr = workRe, *yi = workIm;
+
+	for( const auto &stage : stages ) {
+		const float *twr = twiddlesReal + stage.mTwiddleOffset;
+		const float *twi = twiddlesImag + stage.mTwiddleOffset;
+
+		if( batched )
+			runPass<Float4>( stage.mRadix, stage.mNumButterflies, stage.mStride, twr, twi, xr, xi, yr, yi );
+		else if( stage.mStride % 4 == 0 )
+			runPass<Float4>( stage.mRadix, stage.mNumButterflies, stage.mStride / 4, twr, twi, xr, xi, yr, yi );
+		else
+			runPass<float>( stage.mRadix, stage.mNumButterflies, stage.mStride, twr, twi, xr, xi, yr, yi );
+
+		swap( xr, yr );
+		swap( xi, yi );
+	}
+
+	return xr != re;
+}
+
+// Splits the half size complex transform \a zr, \a zi (elements spaced by \a stride) of the even / odd interleaved signal into the packed real spectrum.
+void splitRealSpectrum( const float *zr, const float *zi, size_t stride, size_t numBins, const float *postTwiddlesReal, const float *postTwiddlesImag, float *real, float *imag )
+{
+	real[0] = ( zr[0] + zi[0] ) * FORWARD_SCALE;	// DC
+	imag[0] = ( zr[0] - zi[0] ) * FORWARD_SCALE;	// Nyquist
+
+	const float halfScale = 0.5f * FORWARD_SCALE;
+	for( size_t k = 1; k < numBins; k++ ) {
+		const float ar = zr[k * stride], ai = zi[k * stride];
+		const float br = zr[( numBins - k ) * stride], bi = - zi[( numBins - k ) * stride];
+
+		// even = ( a + b ) / 2, odd = -i * ( a - b ) / 2, X[k] = even + w^k * odd
+		const float evenR = ar + br, evenI = ai + bi;
+		const float oddR = ai - bi, oddI = br - ar;
+		const float wr = postTwiddlesReal[k], wi = postTwiddlesImag[k];
+
+		real[k] = ( evenR + oddR * wr - oddI * wi ) * halfScale;
+		imag[k] = ( evenI + oddR * wi + oddI * wr ) * halfScale * IMAG_SIGN;
+	}
+}
+
+// Inverse of splitRealSpectrum(), producing the conjugate of the half size complex spectrum (scaled by 2 * FORWARD_SCALE) so that it can be run through the forward transform.
+void mergeRealSpectrum( const float *real, const float *imag, size_t numBins, const float *postTwiddlesReal, const float *postTwiddlesImag, float *zr, float *zi, size_t stride )
+{
+	zr[0] = real[0] + imag[0];
+	zi[0] = imag[0] - real[0];
+
+	for( size_t k = 1; k < numBins; k++ ) {
+		const float ar = real[k], ai = imag[k] * IMAG_SIGN;
+		const float br = real[numBins - k], bi = - imag[numBins - k] * IMAG_SIGN;
+
+		// even = a + b, odd = ( a - b ) * w^-k, z = even + i * odd
+		const float dr = ar - br, di = ai - bi;
+		const float wr = postTwiddlesReal[k], wi = - postTwiddlesImag[k];
+		const float oddR = dr * wr - di * wi, oddI = dr * wi + di * wr;
+
+		zr[k * stride] = ( ar + br ) - oddI;
+		zi[k * stride] = - ( ( ai + bi ) + oddR );
+	}
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FftPlan
+// ----------------------------------------------------------------------------------------------------
+
+FftPlanRef FftPlan::get( size_t fftSize )
+{
+	lock_guard<mutex> lock( sPlanCacheMutex );
+
+	auto &cached = sPlanCache[fftSize];
+	FftPlanRef result = cached.lock();
+	if( ! result ) {
+		result = make_shared<FftPlan>( fftSize );
+		cached = result;
+	}
+
+	return result;
+}
+
+bool FftPlan::isSizeSupported( size_t fftSize )
+{
+	if( fftSize < 2 || fftSize % 2 != 0 )
+		return false;
+
+	size_t n = fftSize / 2;
+	const size_t radices[] = { 2, 3, 5 };
+	for( size_t radix : radices ) {
+		while( n % radix == 0 )
+			n /= radix;
+	}
+
+	return n == 1;
+}
+
+size_t FftPlan::getNextSupportedSize( size_t fftSize )
+{
+	size_t result = max<size_t>( fftSize, 2 );
+	while( ! isSizeSupported( result ) )
+		result++;
+
+	return result;
+}
+
+FftPlan::FftPlan( size_t fftSize )
+	: mSize( fftSize ), mComplexSize( fftSize / 2 )
+{
+	if( ! isSizeSupported( mSize ) )
+		throw AudioExc( "invalid fft size" );
+
+	// Factor the complex size with radix 4 first, so that all later passes have a stride that is a multiple of four and can be vectorized.
+	vector<size_t> radices;
+	size_t n = mComplexSize;
+	while( n % 4 == 0 ) {
+		radices.push_back( 4 );
+		n /= 4;
+	}
+	const size_t otherRadices[] = { 2, 3, 5 };
+	for( size_t radix : otherRadices ) {
+		while( n % radix == 0 ) {
+			radices.push_back( radix );
+			n /= radix;
+		}
+	}
+
+	size_t stride = 1;
+	size_t length = mComplexSize;
+	for( size_t radix : radices ) {
+		Stage stage;
+		stage.mRadix = radix;
+		stage.mNumButterflies = length / radix;
+		stage.mStride = stride;
+		stage.mTwiddleOffset = mTwiddlesReal.size();
+
+		const double theta = -2.0 * M_PI / double( length );
+		for( size_t p = 0; p < stage.mNumButterflies; p++ ) {
+			for( size_t j = 1; j < radix; j++ ) {
+				mTwiddlesReal.push_back( float( cos( theta * double( p * j ) ) ) );
+				mTwiddlesImag.push_back( float( sin( theta * double( p * j ) ) ) );
+			}
+		}
+
+		mStages.push_back( stage );
+		stride *= radix;
+		length /= radix;
+	}
+
+	// the post twiddle tables need at least one element so that their data() is valid, even for a size 2 transform
+	const double theta = -2.0 * M_PI / double( mSize );
+	for( size_t k = 0; k < max<size_t>( mComplexSize, 1 ); k++ ) {
+		mPostTwiddlesReal.push_back( float( cos( theta * double( k ) ) ) );
+		mPostTwiddlesImag.push_back( float( sin( theta * double( k ) ) ) );
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Fft
+// ----------------------------------------------------------------------------------------------------
+
 Fft::Fft( size_t fftSize )
-: mSize( fftSize )
+	: mSize( fftSize )
 {
-	if( mSize < 2 || ! isPowerOf2( mSize ) )
+	if( ! FftPlan::isSizeSupported( mSize ) )
 		throw AudioExc( "invalid fft size" );
 
 	mSizeOverTwo = mSize / 2;
@@ -43,10 +373,201 @@ Fft::Fft( size_t fftSize )
 	init();
 }
 
+void Fft::forwardImpl( const float *waveform, float *real, float *imag )
+{
+	const size_t numBins = mSizeOverTwo;
+	const size_t quarter = numBins * BATCH_SIZE;
+	float *zr = mScratch.data();
+	float *zi = zr + quarter;
+	float *workRe = zi + quarter;
+	float *workIm = workRe + quarter;
+
+	for( size_t n = 0; n < numBins; n++ ) {
+		zr[n] = waveform[n * 2];
+		zi[n] = waveform[n * 2 + 1];
+	}
+
+	if( transformComplex( mPlan->mStages, mPlan->mTwiddlesReal.data(), mPlan->mTwiddlesImag.data(), false, zr, zi, workRe, workIm ) ) {
+		zr = workRe;
+		zi = workIm;
+	}
+
+	splitRealSpectrum( zr, zi, 1, numBins, mPlan->mPostTwiddlesReal.data(), mPlan->mPostTwiddlesImag.data(), real, imag );
+}
+
+void Fft::inverseImpl( const float *real, const float *imag, float *waveform )
+{
+	const size_t numBins = mSizeOverTwo;
+	const size_t quarter = numBins * BATCH_SIZE;
+	float *zr = mScratch.data();
+	float *zi = zr + quarter;
+	float *workRe = zi + quarter;
+	float *workIm = workRe + quarter;
+
+	mergeRealSpectrum( real, imag, numBins, mPlan->mPostTwiddlesReal.data(), mPlan->mPostTwiddlesImag.data(), zr, zi, 1 );
+
+	if( transformComplex( mPlan->mStages, mPlan->mTwiddlesReal.data(), mPlan->mTwiddlesImag.data(), false, zr, zi, workRe, workIm ) ) {
+		zr = workRe;
+		zi = workIm;
+	}
+
+	// conjugate back and remove the scaling: 1 / numBins for the inverse transform, 2 * FORWARD_SCALE from mergeRealSpectrum()
+	const float scale = 1.0f / ( float( numBins ) * 2.0f * FORWARD_SCALE );
+	for( size_t n = 0; n < numBins; n++ ) {
+		waveform[n * 2] = zr[n] * scale;
+		waveform[n * 2 + 1] = - zi[n] * scale;
+	}
+}
+
+void Fft::forwardBatchImpl( const float *const *waveforms, BufferSpectral *const *spectra )
+{
+	const size_t numBins = mSizeOverTwo;
+	const size_t quarter = numBins * BATCH_SIZE;
+	float *zr = mScratch.data();
+	float *zi = zr + quarter;
+	float *workRe = zi + quarter;
+	float *workIm = workRe + quarter;
+
+	// interleave so that each Float4 element holds the same sample of all transforms
+	for( size_t n = 0; n < numBins; n++ ) {
+		for( size_t lane = 0; lane < BATCH_SIZE; lane++ ) {
+			zr[n * BATCH_SIZE + lane] = waveforms[lane][n * 2];
+			zi[n * BATCH_SIZE + lane] = waveforms[lane][n * 2 + 1];
+		}
+	}
+
+	if( transformComplex( mPlan->mStages, mPlan->mTwiddlesReal.data(), mPlan->mTwiddlesImag.data(), true, zr, zi, workRe, workIm ) ) {
+		zr = workRe;
+		zi = workIm;
+	}
+
+	for( size_t lane = 0; lane < BATCH_SIZE; lane++ )
+		splitRealSpectrum( zr + lane, zi + lane, BATCH_SIZE, numBins, mPlan->mPostTwiddlesReal.data(), mPlan->mPostTwiddlesImag.data(), spectra[lane]->getReal(), spectra[lane]->getImag() );
+}
+
+void Fft::inverseBatchImpl( const BufferSpectral *const *spectra, float *const *waveforms )
+{
+	const size_t numBins = mSizeOverTwo;
+	const size_t quarter = numBins * BATCH_SIZE;
+	float *zr = mScratch.data();
+	float *zi = zr + quarter;
+	float *workRe = zi + quarter;
+	float *workIm = workRe + quarter;
+
+	for( size_t lane = 0; lane < BATCH_SIZE; lane++ )
+		mergeRealSpectrum( spectra[lane]->getReal(), spectra[lane]->getImag(), numBins, mPlan->mPostTwiddlesReal.data(), mPlan->mPostTwiddlesImag.data(), zr + lane, zi + lane, BATCH_SIZE );
+
+	if( transformComplex( mPlan->mStages, mPlan->mTwiddlesReal.data(), mPlan->mTwiddlesImag.data(), true, zr, zi, workRe, workIm ) ) {
+		zr = workRe;
+		zi = workIm;
+	}
+
+	const float scale = 1.0f / ( float( numBins ) * 2.0f * FORWARD_SCALE );
+	for( size_t n = 0; n < numBins; n++ ) {
+		for( size_t lane = 0; lane < BATCH_SIZE; lane++ ) {
+			waveforms[lane][n * 2] = zr[n * BATCH_SIZE + lane] * scale;
+			waveforms[lane][n * 2 + 1] = - zi[n * BATCH_SIZE + lane] * scale;
+		}
+	}
+}
+
+void Fft::forwardBatch( const Buffer *waveforms, BufferSpectral *spectra )
+{
+	CI_ASSERT( waveforms->getNumFrames() == mSize );
+
+	const size_t numChannels = waveforms->getNumChannels();
+	size_t ch = 0;
+
 #if defined( CINDER_AUDIO_VDSP )
+	if( ! mFftSetup )
+#endif
+	{
+		for( ; ch + BATCH_SIZE <= numChannels; ch += BATCH_SIZE ) {
+			const float *channels[BATCH_SIZE];
+			BufferSpectral *spectraBatch[BATCH_SIZE];
+			for( size_t lane = 0; lane < BATCH_SIZE; lane++ ) {
+				CI_ASSERT( spectra[ch + lane].getNumFrames() == mSizeOverTwo );
+				channels[lane] = waveforms->getChannel( ch + lane );
+				spectraBatch[lane] = &spectra[ch + lane];
+			}
+
+			forwardBatchImpl( channels, spectraBatch );
+		}
+	}
 
+	for( ; ch < numChannels; ch++ ) {
+		CI_ASSERT( spectra[ch].getNumFrames() == mSizeOverTwo );
+#if defined( CINDER_AUDIO_VDSP )
+		if( mFftSetup ) {
+			mSplitComplexSignal.realp = spectra[ch].getReal();
+			mSplitComplexSignal.imagp = spectra[ch].getImag();
+			vDSP_ctoz( (::DSPComplex *)waveforms->getChannel( ch ), 2, &mSplitComplexSignal, 1, mSizeOverTwo );
+			vDSP_fft_zrip( mFftSetup, &mSplitComplexSignal, 1, mLog2FftSize, FFT_FORWARD );
+			continue;
+		}
+#endif
+		forwardImpl( waveforms->getChannel( ch ), spectra[ch].getReal(), spectra[ch].getImag() );
+	}
+}
+
+void Fft::inverseBatch( const BufferSpectral *spectra, Buffer *waveforms )
+{
+	CI_ASSERT( waveforms->getNumFrames() == mSize );
+
+	const size_t numChannels = waveforms->getNumChannels();
+	size_t ch = 0;
+
+#if defined( CINDER_AUDIO_VDSP )
+	if( ! mFftSetup )
+#endif
+	{
+		for( ; ch + BATCH_SIZE <= numChannels; ch += BATCH_SIZE ) {
+			float *channels[BATCH_SIZE];
+			const BufferSpectral *spectraBatch[BATCH_SIZE];
+			for( size_t lane = 0; lane < BATCH_SIZE; lane++ ) {
+				CI_ASSERT( spectra[ch + lane].getNumFrames() == mSizeOverTwo );
+				channels[lane] = waveforms->getChannel( ch + lane );
+				spectraBatch[lane] = &spectra[ch + lane];
+			}
+
+			inverseBatchImpl( spectraBatch, channels );
+		}
+	}
+
+	for( ; ch < numChannels; ch++ ) {
+		CI_ASSERT( spectra[ch].getNumFrames() == mSizeOverTwo );
+#if defined( CINDER_AUDIO_VDSP )
+		if( mFftSetup ) {
+			BufferSpectral &spectral = const_cast<BufferSpectral &>( spectra[ch] );
+			mSplitComplexSignal.realp = spectral.getReal();
+			mSplitComplexSignal.imagp = spectral.getImag();
+			float *data = waveforms->getChannel( ch );
+			vDSP_fft_zrop( mFftSetup, &mSplitComplexSignal, 1, &mSplitComplexResult, 1, mLog2FftSize, FFT_INVERSE );
+			vDSP_ztoc( &mSplitComplexResult, 1, (::DSPComplex *)data, 2, mSizeOverTwo );
+
+			float scale = 1.0f / float( 2 * mSize );
+			vDSP_vsmul( data, 1, &scale, data, 1, mSize );
+			continue;
+		}
+#endif
+		inverseImpl( spectra[ch].getReal(), spectra[ch].getImag(), waveforms->getChannel( ch ) );
+	}
+}
+
+#if defined( CINDER_AUDIO_VDSP )
+
+// Power-of-two sizes use vDSP, others fall back to the generic transform.
 void Fft::init()
 {
+	mFftSetup = nullptr;
+	mSplitComplexResult.realp = mSplitComplexResult.imagp = nullptr;
+
+	if( ! isPowerOf2( mSize ) ) {
+		mPlan = FftPlan::get( mSize );
+		mScratch.resize( mSizeOverTwo * BATCH_SIZE * 4 );
+		return;
+	}
+
 	mSplitComplexResult.realp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
 	mSplitComplexResult.imagp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
 
@@ -57,9 +578,11 @@ void Fft::init()
 
 Fft::~Fft()
 {
-	free( mSplitComplexResult.realp );
-	free( mSplitComplexResult.imagp );
-	vDSP_destroy_fftsetup( mFftSetup );
+	if( mFftSetup ) {
+		free( mSplitComplexResult.realp );
+		free( mSplitComplexResult.imagp );
+		vDSP_destroy_fftsetup( mFftSetup );
+	}
 }
 
 void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
@@ -67,6 +590,11 @@ void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
+	if( ! mFftSetup ) {
+		forwardImpl( waveform->getData(), spectral->getReal(), spectral->getImag() );
+		return;
+	}
+
 	mSplitComplexSignal.realp = spectral->getReal();
 	mSplitComplexSignal.imagp = spectral->getImag();
 
@@ -80,6 +608,11 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
+	if( ! mFftSetup ) {
+		inverseImpl( spectral->getReal(), spectral->getImag(), waveform->getData() );
+		return;
+	}
+
 	mSplitComplexSignal.realp = const_cast<float *>( spectral->getReal() );
 	mSplitComplexSignal.imagp = const_cast<float *>( spectral->getImag() );
 	float *data = waveform->getData();
@@ -92,19 +625,18 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	vDSP_vsmul( data, 1, &scale, data, 1, mSize );
 }
 
-#elif defined( CINDER_AUDIO_FFT_OOURA )
+#else
 
 void Fft::init()
 {
-	mOouraIp = (int *)calloc( 2 + (int)sqrt( mSizeOverTwo ), sizeof( int ) );
-	mOouraW = (float *)calloc( mSizeOverTwo, sizeof( float ) );
-	mBufferCopy = Buffer( mSize );
+	mPlan = FftPlan::get( mSize );
+
+	// two ping-pong buffers of real and imaginary parts, wide enough for a batch
+	mScratch.resize( mSizeOverTwo * BATCH_SIZE * 4 );
 }
 
 Fft::~Fft()
 {
-	free( mOouraIp );
-	free( mOouraW );
 }
 
 void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
@@ -112,21 +644,7 @@ void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
-	mBufferCopy.copy( *waveform );
-
-	float *a = mBufferCopy.getData();
-	float *real = spectral->getReal();
-	float *imag = spectral->getImag();
-
-	ooura::rdft( (int)mSize, 1, a, mOouraIp, mOouraW );
-
-	real[0] = a[0];
-	imag[0] = a[1];
-
-	for( size_t k = 1; k < mSizeOverTwo; k++ ) {
-		real[k] = a[k * 2];
-		imag[k] = a[k * 2 + 1];
-	}
+	forwardImpl( waveform->getData(), spectral->getReal(), spectral->getImag() );
 }
 
 void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
@@ -134,24 +652,9 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
-	mBufferCopy.copy( *spectral );
-
-	float *real = mBufferCopy.getData();
-	float *imag = &mBufferCopy.getData()[mSizeOverTwo];
-	float *a = waveform->getData();
-
-	a[0] = real[0];
-	a[1] = imag[0];
-
-	for( size_t k = 1; k < mSizeOverTwo; k++ ) {
-		a[k * 2] = real[k];
-		a[k * 2 + 1] = imag[k];
-	}
-
-	ooura::rdft( (int)mSize, -1, a, mOouraIp, mOouraW );
-	dsp::mul( a, 2.0f / (float)mSize, a, mSize );
+	inverseImpl( spectral->getReal(), spectral->getImag(), waveform->getData() );
 }
 
-#endif // defined( CINDER_AUDIO_FFT_OOURA )
+#endif // defined( CINDER_AUDIO_VDSP )
 
 } } } // namespace cinder::audio::dsp
@@ -105,11 +105,9 @@ struct IStreamSndFile {
 	}
 
 	static sf_count_t read( void* ptr, sf_count_t count, void* userData ) {
+		// the decoders read ahead in fixed size chunks, so the last read is usually short
 		ci::IStreamCinder* stream = static_cast<ci::IStreamCinder*>( userData );
-		size_t pos0 = stream->tell();
-		stream->readData( ptr, count );
-		size_t pos1 = stream->tell();
-		return pos1 - pos0;
+		return stream->readDataAvailable( ptr, count );
 	}
 
 	static sf_count_t write( const void* ptr, sf_count_t count, void *userData ) {
@@ -128,10 +126,7 @@ struct IStreamSndFile {
 struct IStreamMpg123 {
 	static ssize_t read( void* userData, void* ptr, size_t count ) {
 		ci::IStreamCinder* stream = static_cast<ci::IStreamCinder*>( userData );
-		size_t pos0 = stream->tell();
-		stream->readData( ptr, count );
-		size_t pos1 = stream->tell();
-		return pos1 - pos0;
+		return stream->readDataAvailable( ptr, count );
 	}
 
 	static off_t seek( void* userData, off_t offset, int whence ) {
@@ -545,6 +540,7 @@ void SourceFileAudioLoader::init()
 SourceFileRef SourceFileAudioLoader::cloneWithSampleRate( size_t sampleRate ) const
 {
 	auto result = std::make_shared<SourceFileAudioLoader>( mDataSource, sampleRate );
+	result->mConverterQuality = mConverterQuality;
 	result->setupSampleRateConversion();
 
 	return result;
@@ -573,7 +569,7 @@ size_t SourceFileAudioLoader::performRead( Buffer *buffer, size_t bufferFrameOff
 
 	while( readCount < numFramesNeeded ) {
 		// Read the audio audio data
-		const size_t maxFrames = std::min<size_t>( mAudioData.getNumFrames(), getNumFrames() - readCount );
+		const size_t maxFrames = std::min<size_t>( mAudioData.getNumFrames(), numFramesNeeded - readCount );
 		size_t numFramesRead = mFileLoader->read( mAudioData.getData(), maxFrames );
 		if( 0 == numFramesRead ) {
 			break;
@@ -591,7 +587,7 @@ size_t SourceFileAudioLoader::performRead( Buffer *buffer, size_t bufferFrameOff
 		for( size_t ch = 0; ch < numChannels; ch++ ) {
 			float *readChannel = mReadBuffer.getChannel( ch );
 			float *resultChannel = buffer->getChannel( ch );
-			std::memcpy( resultChannel + readCount, readChannel, numFramesRead * sizeof( float ) );
+			std::memcpy( resultChannel + bufferFrameOffset + readCount, readChannel, numFramesRead * sizeof( float ) );
 		}		
 
 		readCount += numFramesRead;
@@ -87,6 +87,7 @@ class VboMeshGeomTarget : public geom::Target {
 	uint8_t	getAttribDims( geom::Attrib attr ) const override;
 	void	copyAttrib( geom::Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) override;
 	void	copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) override;
+	float*	getAttribStorage( geom::Attrib attr, uint8_t dims, size_t count, size_t *resultStrideBytes ) override;
 	
 	//! Must be called in order to upload temporary 'mBufferData' to VBOs
 	void	copyBuffers();
@@ -146,6 +147,30 @@ void VboMeshGeomTarget::copyAttrib( geom::Attrib attr, uint8_t dims, size_t stri
 		geom::copyData( dims, srcData, count, dstDims, dstStride, reinterpret_cast<float*>( dstData ) );
 }
 
+float* VboMeshGeomTarget::getAttribStorage( geom::Attrib attr, uint8_t dims, size_t count, size_t *resultStrideBytes )
+{
+	// the Source can write straight into the interleaved buffer as long as no conversion is required
+	if( count == 0 || count != mVboMesh->mNumVertices )
+		return nullptr;
+
+	for( const auto &bufferData : mBufferData ) {
+		if( bufferData.mLayout.hasAttrib( attr ) ) {
+			auto attrInfo = bufferData.mLayout.getAttribInfo( attr );
+			if( attrInfo.getDims() != dims || attrInfo.getDataType() != geom::FLOAT )
+				return nullptr;
+
+			size_t stride = attrInfo.getStride() ? attrInfo.getStride() : ( dims * sizeof(float) );
+			if( bufferData.mDataSize < attrInfo.getOffset() + ( count - 1 ) * stride + dims * sizeof(float) )
+				return nullptr;
+
+			*resultStrideBytes = stride;
+			return reinterpret_cast<float*>( bufferData.mData.get() + attrInfo.getOffset() );
+		}
+	}
+
+	return nullptr;
+}
+
 void VboMeshGeomTarget::copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex )
 {
 // @TODO: Find a better way to handle this
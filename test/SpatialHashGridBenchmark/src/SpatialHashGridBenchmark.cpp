@@ -0,0 +1,122 @@
+// Headless benchmark comparing SpatialHashGrid with KdTree for neighbor searches over moving points. For each point count, the points are
+// jittered every frame, and each frame rebuilds both structures and finds every point's neighbors within the radius. The grid also visits
+// every pair of neighbors once. Reported times are the median over the frames, in milliseconds.
+//
+// The points fill a cube at a density of two points per unit cube, so a unit radius finds about 9 neighbors per point whatever their number.
+//
+// usage: SpatialHashGridBenchmark [--radius r] [--cell-size s] [--frames n] [--points n]
+
+#include "cinder/SpatialHashGrid.h"
+#include "cinder/KdTree.h"
+#include "cinder/Rand.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+struct Timings {
+	vector<double>	mGridBuild, mGridQuery, mGridPairs, mTreeBuild, mTreeQuery;
+};
+
+template<typename Fn>
+double measure( const Fn &fn )
+{
+	const auto start = chrono::steady_clock::now();
+	fn();
+	return chrono::duration<double, milli>( chrono::steady_clock::now() - start ).count();
+}
+
+double median( vector<double> values )
+{
+	sort( values.begin(), values.end() );
+	return values.empty() ? 0 : values[values.size() / 2];
+}
+
+void runBenchmark( size_t numPoints, float radius, float cellSize, size_t numFrames )
+{
+	const float side = pow( numPoints / 2.0f, 1.0f / 3.0f );
+	Rand rnd( 1234 );
+	vector<vec3> points( numPoints );
+	for( auto &p : points )
+		p = vec3( rnd.nextFloat( side ), rnd.nextFloat( side ), rnd.nextFloat( side ) );
+
+	SpatialHashGrid3 grid( cellSize );
+	KdTree<vec3> tree;
+	vector<uint32_t> gridIndices, gridOffsets, treeIndices, treeOffsets;
+	Timings timings;
+	size_t numNeighbors = 0, numPairs = 0;
+
+	for( size_t frame = 0; frame < numFrames; ++frame ) {
+		for( auto &p : points )
+			p = glm::clamp( p + rnd.nextVec3() * 0.05f, vec3( 0 ), vec3( side ) );
+
+		timings.mGridBuild.push_back( measure( [&] { grid.build( points ); } ) );
+		timings.mGridQuery.push_back( measure( [&] { grid.findWithinRadius( points.data(), points.size(), radius, &gridIndices, &gridOffsets ); } ) );
+
+		atomic<size_t> pairs( 0 );
+		timings.mGridPairs.push_back( measure( [&] {
+			grid.forEachPair( radius, [&pairs]( uint32_t, uint32_t, float ) { pairs.fetch_add( 1, memory_order_relaxed ); } );
+		} ) );
+
+		timings.mTreeBuild.push_back( measure( [&] { tree.initialize( points ); } ) );
+		timings.mTreeQuery.push_back( measure( [&] { tree.findWithinRadius( points.data(), points.size(), radius, &treeIndices, &treeOffsets ); } ) );
+
+		if( gridIndices.size() != treeIndices.size() )
+			cerr << "mismatch: the grid found " << gridIndices.size() << " neighbors and the tree " << treeIndices.size() << endl;
+		numNeighbors = gridIndices.size();
+		numPairs = pairs;
+	}
+
+	cout << setw( 8 ) << numPoints << fixed << setprecision( 2 )
+		<< setw( 12 ) << median( timings.mGridBuild ) << setw( 12 ) << median( timings.mTreeBuild )
+		<< setw( 12 ) << median( timings.mGridQuery ) << setw( 12 ) << median( timings.mTreeQuery )
+		<< setw( 12 ) << median( timings.mGridPairs )
+		<< setw( 12 ) << double( numNeighbors ) / numPoints << setw( 12 ) << numPairs << endl;
+}
+
+} // anonymous namespace
+
+int main( int argc, char *argv[] )
+{
+	float radius = 1;
+	float cellSize = 0;
+	size_t numFrames = 10;
+	vector<size_t> pointCounts = { 100000, 250000, 500000, 1000000 };
+
+	for( int i = 1; i + 1 < argc; i += 2 ) {
+		if( ! strcmp( argv[i], "--radius" ) )
+			radius = (float)atof( argv[i + 1] );
+		else if( ! strcmp( argv[i], "--cell-size" ) )
+			cellSize = (float)atof( argv[i + 1] );
+		else if( ! strcmp( argv[i], "--frames" ) )
+			numFrames = max( 1, atoi( argv[i + 1] ) );
+		else if( ! strcmp( argv[i], "--points" ) )
+			pointCounts = { size_t( atoi( argv[i + 1] ) ) };
+		else {
+			cerr << "unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if( cellSize <= 0 )
+		cellSize = radius;
+
+	cout << "radius " << radius << ", cell size " << cellSize << ", median of " << numFrames << " frames (ms)" << endl;
+	cout << setw( 8 ) << "points" << setw( 12 ) << "grid build" << setw( 12 ) << "tree build" << setw( 12 ) << "grid query" << setw( 12 ) << "tree query"
+		<< setw( 12 ) << "grid pairs" << setw( 12 ) << "neighbors" << setw( 12 ) << "pairs" << endl;
+
+	for( size_t numPoints : pointCounts )
+		runBenchmark( numPoints, radius, cellSize, numFrames );
+
+	return 0;
+}
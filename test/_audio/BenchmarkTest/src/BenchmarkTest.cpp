@@ -0,0 +1,479 @@
+// Headless benchmark for audio graphs. Each benchmark builds a typical graph in its own Context, renders it offline (without a
+// device) and reports the realtime factor, per-block render time percentiles and the number of heap allocations made while
+// rendering. Results are written as JSON so they can be compared between releases.
+//
+// Blocks are rendered back to back, except for benchmarks that depend on background threads (i.e. file streaming), which are
+// paced to real time like a device would. The realtime factor is always computed from the time spent rendering.
+//
+// usage: BenchmarkTest [--duration seconds] [--sample-rate hz] [--frames-per-block n] [--scale factor] [--only name] [--output file.json] [--list]
+
+#include "cinder/audio/Context.h"
+#include "cinder/audio/OutputNode.h"
+#include "cinder/audio/GenNode.h"
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/FilterNode.h"
+#include "cinder/audio/DelayNode.h"
+#include "cinder/audio/MonitorNode.h"
+#include "cinder/audio/SamplePlayerNode.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/Utilities.h"
+#include "cinder/Json.h"
+#include "cinder/Rand.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <thread>
+
+using namespace ci;
+using namespace std;
+
+// ----------------------------------------------------------------------------------------------------
+// Allocation tracking: the global allocation functions are replaced so that allocations made on the render thread
+// can be counted while a benchmark is being measured.
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+atomic<bool>		sCountAllocations( false );
+atomic<uint64_t>	sNumAllocations( 0 );
+thread::id			sRenderThreadId;
+
+void* allocate( size_t size )
+{
+	if( sCountAllocations.load( memory_order_relaxed ) && this_thread::get_id() == sRenderThreadId )
+		sNumAllocations.fetch_add( 1, memory_order_relaxed );
+
+	void *result = malloc( size ? size : 1 );
+	if( ! result )
+		throw bad_alloc();
+
+	return result;
+}
+
+} // anonymous namespace
+
+void* operator new( size_t size )						{ return allocate( size ); }
+void* operator new[]( size_t size )						{ return allocate( size ); }
+void* operator new( size_t size, const nothrow_t & ) throw()
+{
+	try {
+		return allocate( size );
+	}
+	catch( bad_alloc & ) {
+		return nullptr;
+	}
+}
+void* operator new[]( size_t size, const nothrow_t &nt ) throw()	{ return operator new( size, nt ); }
+void operator delete( void *ptr ) throw()				{ free( ptr ); }
+void operator delete[]( void *ptr ) throw()				{ free( ptr ); }
+void operator delete( void *ptr, const nothrow_t & ) throw()		{ free( ptr ); }
+void operator delete[]( void *ptr, const nothrow_t & ) throw()	{ free( ptr ); }
+#if defined( __cpp_sized_deallocation )
+void operator delete( void *ptr, size_t ) throw()		{ free( ptr ); }
+void operator delete[]( void *ptr, size_t ) throw()		{ free( ptr ); }
+#endif
+
+namespace {
+
+// ----------------------------------------------------------------------------------------------------
+// Offline rendering
+// ----------------------------------------------------------------------------------------------------
+
+//! Context that isn't bound to any hardware, blocks are rendered by calling OfflineOutputNode::renderBlock().
+class OfflineContext : public audio::Context {
+  public:
+	audio::OutputDeviceNodeRef	createOutputDeviceNode( const audio::DeviceRef &, const audio::Node::Format & ) override	{ return nullptr; }
+	audio::InputDeviceNodeRef	createInputDeviceNode( const audio::DeviceRef &, const audio::Node::Format & ) override	{ return nullptr; }
+};
+
+//! OutputNode that renders one block at a time on the calling thread, the same way an OutputDeviceNode does from its device callback.
+class OfflineOutputNode : public audio::OutputNode {
+  public:
+	OfflineOutputNode( size_t sampleRate, size_t framesPerBlock, size_t numChannels )
+		: OutputNode( Format().channels( numChannels ) ), mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock )
+	{}
+
+	size_t getOutputSampleRate() override		{ return mSampleRate; }
+	size_t getOutputFramesPerBlock() override	{ return mFramesPerBlock; }
+
+	//! Renders one block and returns the buffer holding the result.
+	const audio::Buffer* renderBlock()
+	{
+		auto ctx = getContext();
+		lock_guard<mutex> lock( ctx->getMutex() );
+
+		ctx->preProcess();
+		mRenderBuffer.zero();
+		pullInputs( &mRenderBuffer );
+		ctx->postProcess();
+
+		return getProcessesInPlace() ? &mRenderBuffer : getInternalBuffer();
+	}
+
+  protected:
+	void initialize() override
+	{
+		mRenderBuffer = audio::Buffer( mFramesPerBlock, getNumChannels() );
+	}
+
+  private:
+	size_t			mSampleRate, mFramesPerBlock;
+	audio::Buffer	mRenderBuffer;
+};
+
+// ----------------------------------------------------------------------------------------------------
+// Benchmarks
+// ----------------------------------------------------------------------------------------------------
+
+struct Options {
+	Options() : mDurationSeconds( 10 ), mSampleRate( 48000 ), mFramesPerBlock( 512 ), mScale( 1 ), mList( false )	{}
+
+	//! Returns \a count multiplied by the scale option, but at least one.
+	size_t scaled( size_t count ) const		{ return max<size_t>( 1, size_t( count * mScale ) ); }
+
+	double		mDurationSeconds;
+	size_t		mSampleRate, mFramesPerBlock;
+	double		mScale;
+	bool		mList;
+	string		mOnly;
+	fs::path	mOutputPath, mDataPath;
+};
+
+//! Builds a graph into the Context, connecting it to \a output. All Node's that are created must be added to \a nodes.
+typedef function<void ( const audio::ContextRef &ctx, const audio::OutputNodeRef &output, const Options &options, vector<audio::NodeRef> *nodes )>	BuildFn;
+
+struct Benchmark {
+	string	mName, mDescription;
+	BuildFn	mBuildFn;
+	bool	mPaced;
+};
+
+template <typename NodeT>
+shared_ptr<NodeT> makeNode( const audio::ContextRef &ctx, NodeT *node, vector<audio::NodeRef> *nodes )
+{
+	auto result = ctx->makeNode( node );
+	nodes->push_back( result );
+	return result;
+}
+
+void buildGenFilterMix( const audio::ContextRef &ctx, const audio::OutputNodeRef &output, const Options &options, vector<audio::NodeRef> *nodes )
+{
+	const size_t numVoices = options.scaled( 64 );
+	auto mixer = makeNode( ctx, new audio::GainNode( 1.0f / float( numVoices ) ), nodes );
+
+	for( size_t i = 0; i < numVoices; i++ ) {
+		auto gen = makeNode( ctx, new audio::GenOscNode( audio::WaveformType::SAWTOOTH, randFloat( 50, 2000 ) ), nodes );
+		auto gain = makeNode( ctx, new audio::GainNode( randFloat( 0.2f, 1 ) ), nodes );
+		auto filter = makeNode( ctx, new audio::FilterLowPassNode, nodes );
+		filter->setCutoffFreq( randFloat( 200, 8000 ) );
+
+		gen >> gain >> filter >> mixer;
+		gen->enable();
+	}
+
+	mixer >> output;
+}
+
+void buildDelayChain( const audio::ContextRef &ctx, const audio::OutputNodeRef &output, const Options &options, vector<audio::NodeRef> *nodes )
+{
+	const size_t numStages = options.scaled( 32 );
+
+	audio::NodeRef node = makeNode( ctx, new audio::GenNoiseNode, nodes );
+	node->enable();
+
+	for( size_t i = 0; i < numStages; i++ ) {
+		auto delay = makeNode( ctx, new audio::DelayNode, nodes );
+		delay->setMaxDelaySeconds( 2 );
+		delay->setDelaySeconds( randFloat( 0.01f, 0.1f ) );
+
+		node >> delay;
+		node = delay;
+	}
+
+	// the last delay also feeds back into itself
+	auto feedback = makeNode( ctx, new audio::GainNode( 0.5f ), nodes );
+	auto gain = makeNode( ctx, new audio::GainNode( 0.5f ), nodes );
+	node >> feedback >> node >> gain >> output;
+}
+
+void buildMonitors( const audio::ContextRef &ctx, const audio::OutputNodeRef &output, const Options &options, vector<audio::NodeRef> *nodes )
+{
+	const size_t numMonitors = options.scaled( 16 );
+
+	auto gen = makeNode( ctx, new audio::GenOscNode( audio::WaveformType::SQUARE, 440 ), nodes );
+	gen->enable();
+	gen >> output;
+
+	for( size_t i = 0; i < numMonitors; i++ ) {
+		auto monitor = makeNode( ctx, new audio::MonitorSpectralNode( audio::MonitorSpectralNode::Format().fftSize( 2048 ).windowSize( 2048 ) ), nodes );
+		gen >> monitor;
+	}
+}
+
+void buildBufferPlayers( const audio::ContextRef &ctx, const audio::OutputNodeRef &output, const Options &options, vector<audio::NodeRef> *nodes )
+{
+	const size_t numPlayers = options.scaled( 64 );
+	auto mixer = makeNode( ctx, new audio::GainNode( 1.0f / float( numPlayers ) ), nodes );
+
+	// two seconds of noise, shared by all players
+	auto buffer = make_shared<audio::Buffer>( options.mSampleRate * 2, 2 );
+	for( size_t i = 0; i < buffer->getSize(); i++ )
+		buffer->getData()[i] = randFloat( -1, 1 );
+
+	for( size_t i = 0; i < numPlayers; i++ ) {
+		auto player = makeNode( ctx, new audio::BufferPlayerNode( buffer ), nodes );
+		player->setLoopEnabled();
+		player->seek( randInt( (int32_t)buffer->getNumFrames() ) );
+		player->start();
+		player >> mixer;
+	}
+
+	mixer >> output;
+}
+
+void buildFilePlayers( const audio::ContextRef &ctx, const audio::OutputNodeRef &output, const Options &options, vector<audio::NodeRef> *nodes )
+{
+	const size_t numPlayers = options.scaled( 16 );
+	const fs::path filePath = options.mDataPath / "tone440L220R.ogg";
+	auto mixer = makeNode( ctx, new audio::GainNode( 1.0f / float( numPlayers ) ), nodes );
+
+	for( size_t i = 0; i < numPlayers; i++ ) {
+		auto sourceFile = audio::load( loadFile( filePath ), ctx->getSampleRate() );
+		auto player = makeNode( ctx, new audio::FilePlayerNode( sourceFile ), nodes );
+		player->setLoopEnabled();
+		player->start();
+		player >> mixer;
+	}
+
+	mixer >> output;
+}
+
+vector<Benchmark> getBenchmarks()
+{
+	vector<Benchmark> result;
+	result.push_back( { "gen-filter-mix", "oscillators into gains into lowpass filters, summed into a mixer", buildGenFilterMix, false } );
+	result.push_back( { "delay-chain", "noise through a chain of delays with long buffers, ending in a feedback loop", buildDelayChain, false } );
+	result.push_back( { "spectral-monitors", "one oscillator analyzed by many MonitorSpectralNode's", buildMonitors, false } );
+	result.push_back( { "buffer-players", "looping BufferPlayerNode's summed into a mixer", buildBufferPlayers, false } );
+	result.push_back( { "file-players", "looping FilePlayerNode's streaming ogg vorbis, summed into a mixer", buildFilePlayers, true } );
+	return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Measurement
+// ----------------------------------------------------------------------------------------------------
+
+double percentile( const vector<double> &sorted, double fraction )
+{
+	if( sorted.empty() )
+		return 0;
+
+	size_t index = size_t( fraction * double( sorted.size() - 1 ) + 0.5 );
+	return sorted[min( index, sorted.size() - 1 )];
+}
+
+JsonTree runBenchmark( const Benchmark &benchmark, const Options &options )
+{
+	auto ctx = make_shared<OfflineContext>();
+	auto output = ctx->makeNode( new OfflineOutputNode( options.mSampleRate, options.mFramesPerBlock, 2 ) );
+	ctx->setOutput( output );
+
+	vector<audio::NodeRef> nodes;
+	benchmark.mBuildFn( ctx, output, options, &nodes );
+	ctx->enable();
+
+	const double deadlineSeconds = double( options.mFramesPerBlock ) / double( options.mSampleRate );
+	const auto deadline = chrono::nanoseconds( uint64_t( deadlineSeconds * 1e9 ) );
+	auto nextBlockTime = chrono::steady_clock::now();
+
+	// warm up for a fraction of a second, so that lazy initialization and streaming threads don't skew the results
+	const size_t numWarmupBlocks = max<size_t>( 1, options.mSampleRate / ( 4 * options.mFramesPerBlock ) );
+	for( size_t i = 0; i < numWarmupBlocks; i++ ) {
+		output->renderBlock();
+		if( benchmark.mPaced ) {
+			nextBlockTime += deadline;
+			this_thread::sleep_until( nextBlockTime );
+		}
+	}
+
+	ctx->resetProfile();
+
+	const size_t numBlocks = max<size_t>( 1, size_t( options.mDurationSeconds * options.mSampleRate / options.mFramesPerBlock ) );
+	vector<double> blockSeconds( numBlocks );
+	float peak = 0;
+
+	sRenderThreadId = this_thread::get_id();
+	sNumAllocations = 0;
+	sCountAllocations = true;
+
+	const uint64_t beginNanos = audio::getTimestampNanoseconds();
+	for( size_t i = 0; i < numBlocks; i++ ) {
+		const uint64_t blockBeginNanos = audio::getTimestampNanoseconds();
+		const audio::Buffer *rendered = output->renderBlock();
+		blockSeconds[i] = double( audio::getTimestampNanoseconds() - blockBeginNanos ) * 1e-9;
+
+		for( size_t s = 0; s < rendered->getSize(); s++ )
+			peak = max( peak, fabsf( rendered->getData()[s] ) );
+
+		if( benchmark.mPaced ) {
+			nextBlockTime += deadline;
+			this_thread::sleep_until( nextBlockTime );
+		}
+	}
+	const double wallSeconds = double( audio::getTimestampNanoseconds() - beginNanos ) * 1e-9;
+
+	sCountAllocations = false;
+	const uint64_t numAllocations = sNumAllocations;
+
+	uint64_t numUnderruns = 0, numOverruns = 0;
+	for( const auto &node : nodes ) {
+		const auto profile = node->getProfile();
+		numUnderruns += profile.mNumUnderruns;
+		numOverruns += profile.mNumOverruns;
+	}
+
+	ctx->disable();
+	ctx->disconnectAllNodes();
+
+	const double renderedSeconds = double( numBlocks * options.mFramesPerBlock ) / double( options.mSampleRate );
+	size_t numDeadlineMisses = 0;
+	double totalSeconds = 0;
+	for( double seconds : blockSeconds ) {
+		totalSeconds += seconds;
+		if( seconds > deadlineSeconds )
+			numDeadlineMisses++;
+	}
+	sort( blockSeconds.begin(), blockSeconds.end() );
+
+	auto blockMicros = JsonTree::makeObject( "blockMicroseconds" );
+	blockMicros.addChild( JsonTree( "mean", totalSeconds / double( numBlocks ) * 1e6 ) );
+	blockMicros.addChild( JsonTree( "p50", percentile( blockSeconds, 0.5 ) * 1e6 ) );
+	blockMicros.addChild( JsonTree( "p90", percentile( blockSeconds, 0.9 ) * 1e6 ) );
+	blockMicros.addChild( JsonTree( "p99", percentile( blockSeconds, 0.99 ) * 1e6 ) );
+	blockMicros.addChild( JsonTree( "p999", percentile( blockSeconds, 0.999 ) * 1e6 ) );
+	blockMicros.addChild( JsonTree( "max", blockSeconds.back() * 1e6 ) );
+	blockMicros.addChild( JsonTree( "deadline", deadlineSeconds * 1e6 ) );
+
+	auto result = JsonTree::makeObject();
+	result.addChild( JsonTree( "name", benchmark.mName ) );
+	result.addChild( JsonTree( "description", benchmark.mDescription ) );
+	result.addChild( JsonTree( "numNodes", uint64_t( nodes.size() ) ) );
+	result.addChild( JsonTree( "numBlocks", uint64_t( numBlocks ) ) );
+	result.addChild( JsonTree( "renderedSeconds", renderedSeconds ) );
+	result.addChild( JsonTree( "wallSeconds", wallSeconds ) );
+	result.addChild( JsonTree( "realtimeFactor", renderedSeconds / totalSeconds ) );
+	result.addChild( JsonTree( "paced", benchmark.mPaced ) );
+	result.addChild( blockMicros );
+	result.addChild( JsonTree( "deadlineMisses", uint64_t( numDeadlineMisses ) ) );
+	result.addChild( JsonTree( "audioThreadAllocations", numAllocations ) );
+	result.addChild( JsonTree( "allocationsPerBlock", double( numAllocations ) / double( numBlocks ) ) );
+	result.addChild( JsonTree( "underruns", numUnderruns ) );
+	result.addChild( JsonTree( "overruns", numOverruns ) );
+	result.addChild( JsonTree( "outputPeak", peak ) );
+
+	cerr << benchmark.mName << ": " << renderedSeconds / totalSeconds << "x realtime, p50 " << percentile( blockSeconds, 0.5 ) * 1e6
+		<< "us, p99 " << percentile( blockSeconds, 0.99 ) * 1e6 << "us, max " << blockSeconds.back() * 1e6 << "us, "
+		<< numAllocations << " allocations, " << numUnderruns << " underruns" << endl;
+
+	return result;
+}
+
+bool parseOptions( int argc, char *argv[], Options *options )
+{
+	for( int i = 1; i < argc; i++ ) {
+		const string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if( arg == "--list" )
+			options->mList = true;
+		else if( arg == "--duration" && hasValue )
+			options->mDurationSeconds = atof( argv[++i] );
+		else if( arg == "--sample-rate" && hasValue )
+			options->mSampleRate = (size_t)atoi( argv[++i] );
+		else if( arg == "--frames-per-block" && hasValue )
+			options->mFramesPerBlock = (size_t)atoi( argv[++i] );
+		else if( arg == "--scale" && hasValue )
+			options->mScale = atof( argv[++i] );
+		else if( arg == "--only" && hasValue )
+			options->mOnly = argv[++i];
+		else if( arg == "--output" && hasValue )
+			options->mOutputPath = argv[++i];
+		else if( arg == "--data" && hasValue )
+			options->mDataPath = argv[++i];
+		else {
+			cerr << "unknown or incomplete argument: " << arg << endl;
+			return false;
+		}
+	}
+
+	if( options->mDurationSeconds <= 0 || options->mSampleRate == 0 || options->mFramesPerBlock == 0 || options->mScale <= 0 ) {
+		cerr << "duration, sample rate, frames per block and scale must be positive" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+int main( int argc, char *argv[] )
+{
+	Options options;
+#if defined( BENCHMARK_DATA_DIR )
+	options.mDataPath = BENCHMARK_DATA_DIR;
+#endif
+
+	if( ! parseOptions( argc, argv, &options ) ) {
+		cerr << "usage: " << argv[0] << " [--duration seconds] [--sample-rate hz] [--frames-per-block n] [--scale factor] [--only name] [--output file.json] [--data dir] [--list]" << endl;
+		return 1;
+	}
+
+	const auto benchmarks = getBenchmarks();
+	if( options.mList ) {
+		for( const auto &benchmark : benchmarks )
+			cout << benchmark.mName << ": " << benchmark.mDescription << endl;
+		return 0;
+	}
+
+	// seed so that every run builds identical graphs
+	randSeed( 12345 );
+
+	auto results = JsonTree::makeArray( "benchmarks" );
+	bool succeeded = true;
+	for( const auto &benchmark : benchmarks ) {
+		if( ! options.mOnly.empty() && benchmark.mName.find( options.mOnly ) == string::npos )
+			continue;
+
+		try {
+			results.pushBack( runBenchmark( benchmark, options ) );
+		}
+		catch( exception &exc ) {
+			cerr << benchmark.mName << ": failed with exception: " << exc.what() << endl;
+			succeeded = false;
+		}
+	}
+
+	auto config = JsonTree::makeObject( "config" );
+	config.addChild( JsonTree( "durationSeconds", options.mDurationSeconds ) );
+	config.addChild( JsonTree( "sampleRate", uint64_t( options.mSampleRate ) ) );
+	config.addChild( JsonTree( "framesPerBlock", uint64_t( options.mFramesPerBlock ) ) );
+	config.addChild( JsonTree( "scale", options.mScale ) );
+
+	auto root = JsonTree::makeObject();
+	root.addChild( config );
+	root.addChild( results );
+
+	if( options.mOutputPath.empty() )
+		cout << root.serialize() << endl;
+	else {
+		ofstream stream( options.mOutputPath.string().c_str() );
+		stream << root.serialize() << endl;
+	}
+
+	return succeeded ? 0 : 1;
+}
@@ -62,6 +62,8 @@ void StressTestApp::setup()
 	mSelectedGenType = OSC_SQUARE;
 
 	auto ctx = audio::master();
+	ctx->setProfilingEnabled();
+
 	mGain = ctx->makeNode( new audio::GainNode );
 	mGain->setValue( 0.1f );
 
@@ -284,6 +286,10 @@ void StressTestApp::keyDown( KeyEvent event )
 			mEnableDrawing = ! mEnableDrawing;
 		else if( event.getChar() == 'a' )
 			addGens();
+		else if( event.getChar() == 'p' )
+			CI_LOG_I( "audio graph profile:\n" << audio::master()->printGraphToJson() );
+		else if( event.getChar() == 'r' )
+			audio::master()->resetProfile();
 	}
 }
 
@@ -307,8 +313,17 @@ void StressTestApp::draw()
 
 	drawWidgets( mWidgets );
 
+	const float lineHeight = getTestWidgetTexFont()->getFont().getAscent() + getTestWidgetTexFont()->getFont().getDescent();
+	vec2 textPos( mAddIncrInput.mBounds.x1, mAddIncrInput.mBounds.y2 + padding + lineHeight );
+
 	string countStr = string( "Gen count: " ) + to_string( mGenBank.size() );
-	getTestWidgetTexFont()->drawString( countStr, vec2( mAddIncrInput.mBounds.x1, mAddIncrInput.mBounds.y2 + padding + getTestWidgetTexFont()->getFont().getAscent() + getTestWidgetTexFont()->getFont().getDescent() ) );
+	getTestWidgetTexFont()->drawString( countStr, textPos );
+
+	auto profile = audio::master()->getProfile();
+	textPos.y += lineHeight;
+	getTestWidgetTexFont()->drawString( "load: " + to_string( int( profile.getLoad() * 100 ) ) + "%", textPos );
+	textPos.y += lineHeight;
+	getTestWidgetTexFont()->drawString( "deadline misses: " + to_string( profile.mNumDeadlineMisses ), textPos );
 }
 
 CINDER_APP( StressTestApp, RendererGl, []( App::Settings *settings ) {
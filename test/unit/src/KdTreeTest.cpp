@@ -0,0 +1,129 @@
+#include "catch.hpp"
+#include "cinder/KdTree.h"
+#include "cinder/Rand.h"
+
+#include <algorithm>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+// Returns the squared distances from p to every point closer than maxDist, nearest first
+vector<float> bruteForceDistances( const vector<vec3> &points, const vec3 &p, float maxDist )
+{
+	vector<float> result;
+	for( const auto &point : points ) {
+		const float d = distance2( point, p );
+		if( d < maxDist * maxDist )
+			result.push_back( d );
+	}
+	sort( result.begin(), result.end() );
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "KdTree" )
+{
+	Rand rnd( 1234 );
+	vector<vec3> points( 5000 );
+	for( auto &point : points )
+		point = vec3( rnd.nextFloat( 50 ), rnd.nextFloat( 50 ), rnd.nextFloat( 5 ) );
+	// some duplicates
+	copy( points.begin(), points.begin() + 100, points.end() - 100 );
+
+	KdTree<vec3> tree( points );
+	REQUIRE( tree.size() == points.size() );
+
+SECTION( "nearest and radius queries" )
+{
+	const size_t k = 8;
+	uint32_t indices[k];
+	float distances[k];
+	for( size_t q = 0; q < 100; ++q ) {
+		const vec3 p = ( q % 2 ) ? points[q * 13] : vec3( rnd.nextFloat( -5, 55 ), rnd.nextFloat( -5, 55 ), rnd.nextFloat( 5 ) );
+		const float maxDist = ( q % 3 ) ? 4.0f : FLT_MAX;
+		const vector<float> expected = bruteForceDistances( points, p, maxDist );
+
+		const size_t count = tree.findNearest( p, k, indices, distances, maxDist );
+		REQUIRE( count == std::min( k, expected.size() ) );
+		for( size_t i = 0; i < count; ++i ) {
+			REQUIRE( distances[i] == expected[i] );
+			REQUIRE( distance2( points[indices[i]], p ) == distances[i] );
+		}
+
+		vector<uint32_t> neighbors;
+		REQUIRE( tree.findWithinRadius( p, 3.0f, &neighbors ) == bruteForceDistances( points, p, 3.0f ).size() );
+		for( auto index : neighbors )
+			REQUIRE( distance2( points[index], p ) < 9.0f );
+	}
+}
+
+SECTION( "batch queries" )
+{
+	const size_t k = 4;
+	vector<uint32_t> indices( points.size() * k );
+	vector<float> distances( points.size() * k );
+	tree.findNearest( points.data(), points.size(), k, indices.data(), distances.data(), 1.0f );
+
+	vector<uint32_t> radiusIndices, radiusOffsets;
+	tree.findWithinRadius( points.data(), points.size(), 1.0f, &radiusIndices, &radiusOffsets );
+	REQUIRE( radiusOffsets.size() == points.size() + 1 );
+
+	for( size_t i = 0; i < points.size(); i += 37 ) {
+		uint32_t single[k];
+		float singleDistances[k];
+		const size_t count = tree.findNearest( points[i], k, single, singleDistances, 1.0f );
+		for( size_t j = 0; j < k; ++j )
+			REQUIRE( indices[i * k + j] == ( j < count ? single[j] : KdTree<vec3>::INVALID_INDEX ) );
+
+		vector<uint32_t> neighbors;
+		tree.findWithinRadius( points[i], 1.0f, &neighbors );
+		REQUIRE( vector<uint32_t>( radiusIndices.begin() + radiusOffsets[i], radiusIndices.begin() + radiusOffsets[i + 1] ) == neighbors );
+	}
+}
+
+SECTION( "insert" )
+{
+	KdTree<vec3> dynamic;
+	vector<vec3> inserted;
+	for( size_t i = 0; i < 1000; ++i ) {
+		inserted.push_back( vec3( rnd.nextFloat( 10 ), rnd.nextFloat( 10 ), rnd.nextFloat( 10 ) ) );
+		REQUIRE( dynamic.insert( inserted.back() ) == i );
+
+		const vec3 p( rnd.nextFloat( 10 ), rnd.nextFloat( 10 ), rnd.nextFloat( 10 ) );
+		uint32_t index;
+		float distance;
+		REQUIRE( dynamic.findNearest( p, 1, &index, &distance ) == 1 );
+		REQUIRE( distance == bruteForceDistances( inserted, p, FLT_MAX )[0] );
+	}
+	REQUIRE( dynamic.size() == inserted.size() );
+}
+
+SECTION( "large tree" )
+{
+	// enough points for the tree to be built in parallel
+	vector<vec3> many( 40000 );
+	for( auto &point : many )
+		point = vec3( rnd.nextFloat( 100 ), rnd.nextFloat( 100 ), rnd.nextFloat( 100 ) );
+
+	KdTree<vec3> large( many );
+	REQUIRE( large.size() == many.size() );
+
+	for( size_t q = 0; q < 50; ++q ) {
+		const vec3 p( rnd.nextFloat( 100 ), rnd.nextFloat( 100 ), rnd.nextFloat( 100 ) );
+		const vector<float> expected = bruteForceDistances( many, p, 10.0f );
+
+		uint32_t index;
+		float distance;
+		REQUIRE( large.findNearest( p, 1, &index, &distance, 10.0f ) == std::min<size_t>( 1, expected.size() ) );
+		if( ! expected.empty() )
+			REQUIRE( distance == expected[0] );
+
+		vector<uint32_t> neighbors;
+		REQUIRE( large.findWithinRadius( p, 10.0f, &neighbors ) == expected.size() );
+	}
+}
+
+} // "KdTree"
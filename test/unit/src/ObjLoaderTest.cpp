@@ -2,6 +2,7 @@
 #include "catch.hpp"
 #include "cinder/ObjLoader.h"
 #include "cinder/TriMesh.h"
+#include "cinder/Utilities.h"
 
 using namespace cinder;
 
@@ -39,6 +40,8 @@ f 1 4 \
  3 2
 )obj" );
 
+const auto planeDataRelativeIndices = std::string( "g plane\r\nv 1 1 -1\r\nv 1 1 1\r\nv -1.0 1.0 1.0\r\nv -1.0 1.0 -1.0\r\nvn 0.0 1.0 0.0\r\nf -4//-1 -1//-1 -2//-1 -3//-1\r\n" );
+
 const auto expectedPositions = std::vector<vec3> {
 	vec3( 1, 1, -1 ),
 	vec3( -1, 1, -1 ), // reordered by face indices
@@ -94,4 +97,111 @@ SECTION( "ObjLoader successfully parses faces with line continuations." )
 	REQUIRE( matchesExpectedPositions( mesh->getPositions<3>() ) );
 }
 
+SECTION( "ObjLoader resolves relative indices." )
+{
+	auto stream = IStreamMem::create(planeDataRelativeIndices.c_str(), planeDataRelativeIndices.size());
+	auto obj = ObjLoader(stream);
+	REQUIRE( obj.getNumGroups() == 1 );
+	REQUIRE( obj.getGroups()[0].mName == "plane" );
+	REQUIRE( obj.getGroups()[0].mHasNormals );
+	auto mesh = TriMesh::create(obj);
+	REQUIRE( mesh->getNumTriangles() == 2 );
+	REQUIRE( mesh->getNumVertices() == 4 );
+	REQUIRE( matchesExpectedPositions( mesh->getPositions<3>() ) );
+}
+
+const auto twoGroupsData = std::string( R"obj(
+g A
+v 1 1 -1
+v 1 1 1
+v -1.0 1.0 1.0
+v -1.0 1.0 -1.0
+vn 0.0 1.0 0.0
+f 1//1 4//1 3//1 2//1
+g B
+v 0 0 0
+v 1 0 0
+v 0 0 1
+f 5//1 6//1 7//1
+)obj" );
+
+const auto writeTextFile = [] ( const fs::path &path, const std::string &text ) {
+	writeFileStream( path )->writeData( text.data(), text.size() );
+};
+
+const auto isSameMesh = [] ( const TriMesh &a, const TriMesh &b ) {
+	return a.getNumVertices() == b.getNumVertices() && a.getNumIndices() == b.getNumIndices()
+		&& std::equal( a.getPositions<3>(), a.getPositions<3>() + a.getNumVertices(), b.getPositions<3>() )
+		&& a.getNormals().size() == b.getNormals().size() && std::equal( a.getNormals().begin(), a.getNormals().end(), b.getNormals().begin() )
+		&& std::equal( a.getIndices().begin(), a.getIndices().end(), b.getIndices().begin() );
+};
+
+SECTION( "ObjLoader cache round trip." )
+{
+	const fs::path objPath = getDocumentsDirectory() / "testoutput_groups.obj";
+	const fs::path cachePath = getDocumentsDirectory() / "testoutput_groups.obj.cache";
+	writeTextFile( objPath, twoGroupsData );
+	if( fs::exists( cachePath ) )
+		fs::remove( cachePath );
+
+	ObjLoader parsed( objPath, cachePath );
+	REQUIRE_FALSE( parsed.isLoadedFromCache() );
+	REQUIRE( fs::exists( cachePath ) );
+
+	ObjLoader cached( objPath, cachePath );
+	REQUIRE( cached.isLoadedFromCache() );
+	REQUIRE( isSameMesh( TriMesh( cached ), TriMesh( parsed ) ) );
+	REQUIRE( TriMesh( cached ).getNumTriangles() == 3 );
+
+	// the groups are listed from the cache, and selecting one parses the file
+	REQUIRE( cached.getNumGroups() == 2 );
+	REQUIRE( cached.hasGroup( "B" ) );
+	REQUIRE( cached.getGroups()[1].mHasNormals );
+	cached.groupName( "B" );
+	REQUIRE_FALSE( cached.isLoadedFromCache() );
+	TriMesh groupB( cached );
+	REQUIRE( groupB.getNumTriangles() == 1 );
+	REQUIRE( isSameMesh( groupB, TriMesh( parsed.groupName( "B" ) ) ) );
+	REQUIRE( cached.getGroups()[1].mFaces.size() == 1 );
+}
+
+SECTION( "ObjLoader cache is rebuilt when stale." )
+{
+	const fs::path objPath = getDocumentsDirectory() / "testoutput_stale.obj";
+	const fs::path cachePath = getDocumentsDirectory() / "testoutput_stale.obj.cache";
+	writeTextFile( objPath, twoGroupsData );
+	if( fs::exists( cachePath ) )
+		fs::remove( cachePath );
+
+	REQUIRE_FALSE( ObjLoader( objPath, cachePath ).isLoadedFromCache() );
+	REQUIRE( ObjLoader( objPath, cachePath ).isLoadedFromCache() );
+
+	// different flags than the cache was written with
+	REQUIRE_FALSE( ObjLoader( objPath, cachePath, false ).isLoadedFromCache() );
+	REQUIRE( ObjLoader( objPath, cachePath, false ).isLoadedFromCache() );
+	REQUIRE_FALSE( ObjLoader( objPath, cachePath, false, true, false ).isLoadedFromCache() );
+
+	// a different size, then the same size with a different modification time
+	writeTextFile( objPath, twoGroupsData + "f 5//1 7//1 6//1\n" );
+	ObjLoader grown( objPath, cachePath );
+	REQUIRE_FALSE( grown.isLoadedFromCache() );
+	REQUIRE( TriMesh( grown ).getNumTriangles() == 4 );
+
+	const std::time_t writeTime = fs::last_write_time( objPath );
+	writeTextFile( objPath, twoGroupsData + "f 6//1 5//1 7//1\n" );
+	fs::last_write_time( objPath, writeTime + 2 );
+	ObjLoader rewritten( objPath, cachePath );
+	REQUIRE_FALSE( rewritten.isLoadedFromCache() );
+	REQUIRE( TriMesh( rewritten ).getIndices()[9] == 5 );
+	REQUIRE( ObjLoader( objPath, cachePath ).isLoadedFromCache() );
+
+	// a cache that isn't one, or is cut short, is ignored
+	writeTextFile( cachePath, twoGroupsData );
+	REQUIRE_FALSE( ObjLoader( objPath, cachePath ).isLoadedFromCache() );
+	fs::resize_file( cachePath, fs::file_size( cachePath ) - 100 );
+	ObjLoader truncated( objPath, cachePath );
+	REQUIRE_FALSE( truncated.isLoadedFromCache() );
+	REQUIRE( TriMesh( truncated ).getNumTriangles() == 4 );
+}
+
 } // ObjLoader tests
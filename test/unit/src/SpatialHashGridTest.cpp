@@ -0,0 +1,144 @@
+#include "catch.hpp"
+#include "cinder/SpatialHashGrid.h"
+#include "cinder/Rand.h"
+
+#include <algorithm>
+#include <mutex>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+// Returns the sorted indices of the points closer than radius to p
+template<typename VecT>
+vector<uint32_t> bruteForceWithinRadius( const vector<VecT> &points, const VecT &p, float radius )
+{
+	vector<uint32_t> result;
+	for( uint32_t i = 0; i < points.size(); ++i ) {
+		if( distance2( points[i], p ) < radius * radius )
+			result.push_back( i );
+	}
+	return result;
+}
+
+vector<uint32_t> sorted( vector<uint32_t> indices )
+{
+	sort( indices.begin(), indices.end() );
+	return indices;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "SpatialHashGrid" )
+{
+	Rand rnd( 1234 );
+	vector<vec3> points( 5000 );
+	for( auto &point : points )
+		point = vec3( rnd.nextFloat( 20 ), rnd.nextFloat( 20 ), rnd.nextFloat( 5 ) );
+	// some duplicates
+	copy( points.begin(), points.begin() + 100, points.end() - 100 );
+
+	SpatialHashGrid3 grid( 1.5f );
+	grid.build( points );
+	REQUIRE( grid.size() == points.size() );
+
+SECTION( "radius and box queries" )
+{
+	for( size_t q = 0; q < 100; ++q ) {
+		const vec3 p = ( q % 2 ) ? points[q * 13] : vec3( rnd.nextFloat( -5, 25 ), rnd.nextFloat( -5, 25 ), rnd.nextFloat( 5 ) );
+		const float radius = ( q % 3 ) ? 1.5f : 6.0f;
+
+		vector<uint32_t> neighbors;
+		const vector<uint32_t> expectedNeighbors = bruteForceWithinRadius( points, p, radius );
+		REQUIRE( grid.findWithinRadius( p, radius, &neighbors ) == expectedNeighbors.size() );
+		REQUIRE( sorted( neighbors ) == expectedNeighbors );
+
+		const AxisAlignedBox box( p - vec3( radius ), p + vec3( radius ) );
+		vector<uint32_t> expected;
+		for( uint32_t i = 0; i < points.size(); ++i ) {
+			if( box.contains( points[i] ) )
+				expected.push_back( i );
+		}
+		vector<uint32_t> inBox;
+		grid.findInBox( box, &inBox );
+		REQUIRE( sorted( inBox ) == expected );
+	}
+}
+
+SECTION( "batch queries and pairs" )
+{
+	vector<uint32_t> radiusIndices, radiusOffsets;
+	grid.findWithinRadius( points.data(), points.size(), 1.0f, &radiusIndices, &radiusOffsets );
+	REQUIRE( radiusOffsets.size() == points.size() + 1 );
+
+	size_t numNeighbors = 0;
+	for( size_t i = 0; i < points.size(); ++i ) {
+		const vector<uint32_t> neighbors( radiusIndices.begin() + radiusOffsets[i], radiusIndices.begin() + radiusOffsets[i + 1] );
+		if( i % 37 == 0 )
+			REQUIRE( sorted( neighbors ) == bruteForceWithinRadius( points, points[i], 1.0f ) );
+		numNeighbors += neighbors.size();
+	}
+
+	// every pair is found once, so each point's neighbors other than itself are split between its pairs
+	vector<size_t> numPairs( points.size() );
+	mutex pairsMutex;
+	grid.forEachPair( 1.0f, [&]( uint32_t i, uint32_t j, float distanceSquared ) {
+		lock_guard<mutex> lock( pairsMutex );
+		REQUIRE( i != j );
+		REQUIRE( distanceSquared == distance2( points[i], points[j] ) );
+		++numPairs[i];
+		++numPairs[j];
+	} );
+	for( size_t i = 0; i < points.size(); i += 37 )
+		REQUIRE( numPairs[i] == bruteForceWithinRadius( points, points[i], 1.0f ).size() - 1 );
+	size_t totalPairs = 0;
+	for( size_t count : numPairs )
+		totalPairs += count;
+	REQUIRE( totalPairs == numNeighbors - points.size() );
+}
+
+SECTION( "sparse points" )
+{
+	// the bounds span far more cells than there are buckets, so cells share buckets
+	vector<vec2> sparse( 2000 );
+	for( size_t i = 0; i < sparse.size(); ++i )
+		sparse[i] = vec2( rnd.nextFloat( 1000 ), rnd.nextFloat( 1000 ) ) + ( i % 2 ? vec2( 0 ) : vec2( 1.0e5f, -1.0e5f ) );
+
+	SpatialHashGrid2 grid2( 2.0f );
+	grid2.build( sparse );
+	REQUIRE( grid2.getBounds().getMax().z == 0 );
+	for( size_t q = 0; q < 100; ++q ) {
+		const vec2 p = sparse[q * 17];
+		const float radius = ( q % 2 ) ? 40.0f : 2.0f;
+		vector<uint32_t> neighbors;
+		grid2.findWithinRadius( p, radius, &neighbors );
+		REQUIRE( sorted( neighbors ) == bruteForceWithinRadius( sparse, p, radius ) );
+	}
+
+	grid2.clear();
+	vector<uint32_t> neighbors;
+	REQUIRE( grid2.empty() );
+	REQUIRE( grid2.findWithinRadius( vec2( 0 ), 10.0f, &neighbors ) == 0 );
+}
+
+SECTION( "large grid" )
+{
+	// enough points for the grid to be built in parallel
+	vector<vec3> many( 40000 );
+	for( auto &point : many )
+		point = vec3( rnd.nextFloat( 100 ), rnd.nextFloat( 100 ), rnd.nextFloat( 100 ) );
+
+	SpatialHashGrid3 large( 4.0f );
+	large.build( many );
+	REQUIRE( large.size() == many.size() );
+
+	for( size_t q = 0; q < 50; ++q ) {
+		const vec3 p = ( q % 2 ) ? many[q * 701] : vec3( rnd.nextFloat( 100 ), rnd.nextFloat( 100 ), rnd.nextFloat( 100 ) );
+		vector<uint32_t> neighbors;
+		large.findWithinRadius( p, 5.0f, &neighbors );
+		REQUIRE( sorted( neighbors ) == bruteForceWithinRadius( many, p, 5.0f ) );
+	}
+}
+
+} // "SpatialHashGrid"
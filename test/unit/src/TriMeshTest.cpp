@@ -0,0 +1,362 @@
+#include "catch.hpp"
+#include "cinder/TriMesh.h"
+#include "cinder/TriMeshBvh.h"
+#include "cinder/GeomIo.h"
+#include "cinder/Rand.h"
+#include "cinder/Utilities.h"
+
+#include <map>
+
+using namespace cinder;
+
+namespace {
+
+// A 2x2 grid of quads where every quad has its own four vertices, as a flat shaded export would produce.
+TriMesh makeSplitGrid()
+{
+	TriMesh mesh( TriMesh::Format().positions().normals().texCoords0( 2 ) );
+	for( int y = 0; y < 2; ++y ) {
+		for( int x = 0; x < 2; ++x ) {
+			uint32_t base = (uint32_t)mesh.getNumVertices();
+			const vec3 corners[] = { vec3( x, 0, y ), vec3( x + 1, 0, y ), vec3( x + 1, 0, y + 1 ), vec3( x, 0, y + 1 ) };
+			for( const auto &corner : corners ) {
+				mesh.appendPosition( corner );
+				mesh.appendNormal( vec3( 0, 1, 0 ) );
+				mesh.appendTexCoord0( vec2( corner.x, corner.z ) * 0.5f );
+			}
+
+			mesh.appendTriangle( base, base + 2, base + 1 );
+			mesh.appendTriangle( base, base + 3, base + 2 );
+		}
+	}
+
+	return mesh;
+}
+
+// A Target that only implements copyAttrib(), as every Target did before getAttribStorage(), and keeps everything it is given.
+class RecordingTarget : public geom::Target {
+  public:
+	RecordingTarget( const geom::Source &source )
+		: mSource( source ), mPrimitive( geom::Primitive::NUM_PRIMITIVES )
+	{}
+
+	uint8_t getAttribDims( geom::Attrib attr ) const override	{ return mSource.getAttribDims( attr ); }
+
+	void copyAttrib( geom::Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) override
+	{
+		const size_t stride = strideBytes ? strideBytes / sizeof( float ) : dims;
+		std::vector<float> &data = mAttribs[attr];
+		data.clear();
+		for( size_t i = 0; i < count; ++i )
+			data.insert( data.end(), srcData + i * stride, srcData + i * stride + dims );
+	}
+
+	void copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t /*requiredBytesPerIndex*/ ) override
+	{
+		mPrimitive = primitive;
+		mIndices.assign( source, source + numIndices );
+	}
+
+	const geom::Source							&mSource;
+	std::map<geom::Attrib, std::vector<float>>	mAttribs;
+	std::vector<uint32_t>						mIndices;
+	geom::Primitive								mPrimitive;
+};
+
+// Checks that a TriMesh, which has \a source generate straight into its own storage, ends up with exactly what \a source passes to copyAttrib().
+void requireSameAsCopied( const geom::Source &source )
+{
+	// enough vertices for the source to generate in parallel
+	REQUIRE( source.getNumVertices() > 32768 );
+
+	const TriMesh mesh( source );
+	RecordingTarget copied( source ), loaded( source );
+	source.loadInto( &copied, source.getAvailableAttribs() );
+	mesh.loadInto( &loaded, source.getAvailableAttribs() );
+
+	REQUIRE( copied.mPrimitive == geom::Primitive::TRIANGLES );
+	REQUIRE( copied.mAttribs.count( geom::TANGENT ) == 1 );
+	REQUIRE( loaded.mIndices == copied.mIndices );
+	REQUIRE( loaded.mAttribs == copied.mAttribs );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "TriMesh" )
+{
+
+SECTION( "coincident vertices" )
+{
+	TriMesh mesh = makeSplitGrid();
+	auto representatives = mesh.calcCoincidentVertices( 0.001f );
+
+	REQUIRE( representatives.size() == 16 );
+	// the centre of the grid is shared by one corner of every quad
+	REQUIRE( representatives[2] == 2 );
+	REQUIRE( representatives[7] == 2 );
+	REQUIRE( representatives[9] == 2 );
+	REQUIRE( representatives[12] == 2 );
+	for( uint32_t i = 0; i < 16; ++i )
+		REQUIRE( representatives[representatives[i]] == representatives[i] );
+}
+
+SECTION( "weld" )
+{
+	TriMesh mesh = makeSplitGrid();
+	REQUIRE( mesh.weld( 0.001f ) == 7 );
+	REQUIRE( mesh.getNumVertices() == 9 );
+	REQUIRE( mesh.getNumTriangles() == 8 );
+	for( auto index : mesh.getIndices() )
+		REQUIRE( index < 9 );
+
+	// a larger epsilon collapses everything within a unit of the first vertex
+	REQUIRE( makeSplitGrid().weld( 1.0f ) > 7 );
+}
+
+SECTION( "removeDuplicateVertices" )
+{
+	TriMesh mesh = makeSplitGrid();
+	REQUIRE( mesh.removeDuplicateVertices() == 7 );
+	REQUIRE( mesh.getNumVertices() == 9 );
+	REQUIRE( mesh.getNumTriangles() == 8 );
+
+	// vertices that differ in any attribute are kept apart
+	TriMesh seams = makeSplitGrid();
+	seams.getTexCoords0<2>()[7] = vec2( 1 );
+	REQUIRE( seams.removeDuplicateVertices() == 6 );
+}
+
+SECTION( "smooth normals and tangents" )
+{
+	TriMesh mesh = makeSplitGrid();
+	REQUIRE( mesh.recalculateNormals( true ) );
+	REQUIRE( mesh.recalculateTangents() );
+	for( size_t i = 0; i < mesh.getNumVertices(); ++i ) {
+		REQUIRE( distance( mesh.getNormals()[i], vec3( 0, 1, 0 ) ) < 0.0001f );
+		REQUIRE( distance( mesh.getTangents()[i], vec3( 1, 0, 0 ) ) < 0.0001f );
+	}
+}
+
+SECTION( "mapped read / write" )
+{
+	TriMesh mesh = makeSplitGrid();
+	mesh.recalculateTangents();
+	const fs::path path = getDocumentsDirectory() / "testoutput_trimesh.bin";
+
+	for( int compress = 0; compress < 2; ++compress ) {
+		mesh.writeMapped( writeFile( path ), compress != 0 );
+
+		MappedTriMesh mapped( path );
+		REQUIRE( mapped.getNumVertices() == 16 );
+		REQUIRE( mapped.getNumIndices() == 24 );
+		REQUIRE( mapped.getAttribDims( geom::TEX_COORD_0 ) == 2 );
+		REQUIRE( mapped.getAttribDims( geom::COLOR ) == 0 );
+		// uncompressed attributes are used in place, starting on a page boundary
+		if( ! compress ) {
+			auto offset = (const uint8_t *)mapped.getAttribData( geom::POSITION ) - (const uint8_t *)mapped.getMappedFile()->getData();
+			REQUIRE( offset > 0 );
+			REQUIRE( offset % 4096 == 0 );
+		}
+
+		TriMesh fromMapped( mapped ), fromRead;
+		fromRead.read( loadFile( path ) );
+		for( const TriMesh *loaded : { &fromMapped, &fromRead } ) {
+			REQUIRE( loaded->getIndices() == mesh.getIndices() );
+			REQUIRE( loaded->getBufferPositions() == mesh.getBufferPositions() );
+			REQUIRE( loaded->getNormals() == mesh.getNormals() );
+			REQUIRE( loaded->getTangents() == mesh.getTangents() );
+			REQUIRE( loaded->getBufferTexCoords0() == mesh.getBufferTexCoords0() );
+		}
+	}
+
+	fs::remove( path );
+}
+
+SECTION( "modifier chain" )
+{
+	auto format = TriMesh::Format().positions().normals().texCoords().tangents().bitangents().colors();
+	geom::SourceMods chain = geom::Cube() >> geom::Subdivide() >> geom::Tangents() >> geom::Scale( 2 )
+		>> geom::ColorFromAttrib( geom::NORMAL, []( vec3 n ) { return Colorf( n.x, n.y, n.z ); } ) >> geom::Invert( geom::TEX_COORD_0 );
+
+	// the SourceMods reuses its context, which mustn't carry anything over between loads
+	TriMesh first( chain, format ), second( chain, format );
+	REQUIRE( first.getNumVertices() == 24 + 12 );
+	REQUIRE( first.getBufferPositions() == second.getBufferPositions() );
+	REQUIRE( first.getBitangents() == second.getBitangents() );
+	REQUIRE( first.getBufferColors() == second.getBufferColors() );
+
+	for( size_t i = 0; i < first.getNumVertices(); ++i ) {
+		REQUIRE( distance( first.getBitangents()[i], normalize( cross( first.getNormals()[i], first.getTangents()[i] ) ) ) < 0.0001f );
+		Colorf color = first.getColors<3>()[i];
+		REQUIRE( distance( vec3( color.r, color.g, color.b ), first.getNormals()[i] ) < 0.0001f );
+		REQUIRE( first.getTexCoords0<2>()[i].x <= 0 );
+	}
+}
+
+SECTION( "simplify" )
+{
+	TriMesh sphere( geom::Sphere().subdivisions( 32 ), TriMesh::Format().positions().normals().texCoords() );
+	TriMesh mesh = sphere;
+	const size_t numTriangles = mesh.getNumTriangles();
+	REQUIRE( mesh.simplify( 0.25f ) > 0 );
+	REQUIRE( mesh.getNumTriangles() <= numTriangles / 4 + 1 );
+	REQUIRE( mesh.getNumTriangles() > numTriangles / 8 );
+
+	// the remaining vertices keep their original attributes
+	for( size_t i = 0; i < mesh.getNumVertices(); ++i ) {
+		bool found = false;
+		for( size_t j = 0; j < sphere.getNumVertices() && ! found; ++j )
+			found = mesh.getPositions<3>()[i] == sphere.getPositions<3>()[j] && mesh.getNormals()[i] == sphere.getNormals()[j] && mesh.getTexCoords0<2>()[i] == sphere.getTexCoords0<2>()[j];
+		REQUIRE( found );
+	}
+	for( auto index : mesh.getIndices() )
+		REQUIRE( index < mesh.getNumVertices() );
+
+	// a flat grid reduces to two triangles without moving its outline, but a split one has no edge that keeps the attributes intact
+	TriMesh grid = makeSplitGrid();
+	REQUIRE( grid.simplify( 0, 0.001f ) == 0 );
+	grid.removeDuplicateVertices();
+	REQUIRE( grid.simplify( 0, 0.001f ) == 6 );
+	REQUIRE( grid.getNumVertices() == 4 );
+	REQUIRE( grid.calcBoundingBox().getMin() == vec3( 0 ) );
+	REQUIRE( grid.calcBoundingBox().getMax() == vec3( 2, 0, 2 ) );
+
+	auto lods = sphere.buildLodChain( 3 );
+	REQUIRE( lods.size() == 3 );
+	REQUIRE( lods[2].getNumTriangles() < lods[1].getNumTriangles() );
+	REQUIRE( lods[1].getNumTriangles() < lods[0].getNumTriangles() );
+}
+
+SECTION( "optimize" )
+{
+	TriMesh mesh( geom::Sphere().subdivisions( 32 ), TriMesh::Format().positions().normals() );
+
+	// reverse the triangles in groups of 7 for a scattered order to start from
+	std::vector<uint32_t> &indices = mesh.getIndices();
+	for( size_t t = 0; t + 7 <= indices.size() / 3; t += 7 ) {
+		for( size_t i = 0; i < 3; ++i )
+			for( size_t c = 0; c < 3; ++c )
+				std::swap( indices[( t + i ) * 3 + c], indices[( t + 6 - i ) * 3 + c] );
+	}
+	const TriMesh original = mesh;
+
+	const float acmrBefore = mesh.calcAcmr();
+	const float acmrAfter = mesh.optimizeVertexCache();
+	REQUIRE( acmrAfter < acmrBefore );
+	REQUIRE( acmrAfter < 0.7f );
+	REQUIRE( mesh.optimizeOverdraw() < acmrAfter * 1.1f );
+
+	// vertices are renumbered in the order they're first used, and every triangle still has its original corners
+	mesh.optimizeVertexFetch();
+	uint32_t numUsed = 0;
+	for( auto index : mesh.getIndices() ) {
+		REQUIRE( index <= numUsed );
+		numUsed = std::max( numUsed, index + 1 );
+	}
+
+	auto corners = []( const TriMesh &m ) {
+		std::vector<std::vector<float>> result;
+		for( size_t t = 0; t < m.getNumTriangles(); ++t ) {
+			std::vector<float> triangle;
+			for( size_t c = 0; c < 3; ++c ) {
+				const uint32_t index = m.getIndices()[t * 3 + c];
+				triangle.insert( triangle.end(), { m.getPositions<3>()[index].x, m.getPositions<3>()[index].y, m.getPositions<3>()[index].z, m.getNormals()[index].x } );
+			}
+			result.push_back( triangle );
+		}
+		std::sort( result.begin(), result.end() );
+		return result;
+	};
+	REQUIRE( corners( mesh ) == corners( original ) );
+
+	float modifierBefore = 0, modifierAfter = 0;
+	TriMesh optimized( geom::Sphere().subdivisions( 32 ) >> geom::Optimize().overdraw().acmr( &modifierBefore, &modifierAfter ), TriMesh::Format().positions().normals() );
+	REQUIRE( modifierAfter < modifierBefore );
+	REQUIRE( optimized.calcAcmr() == modifierAfter );
+	REQUIRE( optimized.getNumIndices() == original.getNumIndices() );
+}
+
+SECTION( "bvh" )
+{
+	TriMesh mesh( geom::Sphere().subdivisions( 24 ) >> geom::Twist(), TriMesh::Format().positions() );
+	TriMeshBvh bvh( mesh );
+	REQUIRE( bvh.getTriangles().size() == mesh.getNumTriangles() );
+
+	// single rays and packets find the same nearest triangle as testing every triangle
+	Rand rnd( 12345 );
+	std::vector<Ray> rays;
+	for( size_t i = 0; i < 100; ++i ) {
+		const vec3 origin = rnd.nextVec3() * 2.0f;
+		rays.push_back( Ray( origin, normalize( rnd.nextVec3() * 0.5f - origin ) ) );
+	}
+	std::vector<TriMeshBvh::RayHit> hits( rays.size() );
+	std::unique_ptr<bool[]> anyHits( new bool[rays.size()] );
+	const size_t numHits = bvh.raycast( rays.data(), rays.size(), hits.data() );
+	REQUIRE( bvh.raycastAny( rays.data(), rays.size(), anyHits.get() ) == numHits );
+	REQUIRE( numHits > 10 );
+	for( size_t r = 0; r < rays.size(); ++r ) {
+		float nearest = std::numeric_limits<float>::max(), distance;
+		for( size_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+			vec3 a, b, c;
+			mesh.getTriangleVertices( t, &a, &b, &c );
+			if( rays[r].calcTriangleIntersection( a, b, c, &distance ) && distance >= 0 && distance < nearest )
+				nearest = distance;
+		}
+
+		const TriMeshBvh::RayHit single = bvh.raycast( rays[r] );
+		REQUIRE( single.isHit() == ( nearest < std::numeric_limits<float>::max() ) );
+		REQUIRE( hits[r].isHit() == single.isHit() );
+		REQUIRE( bvh.raycastAny( rays[r] ) == single.isHit() );
+		if( single.isHit() ) {
+			REQUIRE( std::abs( single.mDistance - nearest ) < 1e-4f );
+			REQUIRE( hits[r].mTriangle == single.mTriangle );
+		}
+	}
+
+	// a box query returns every triangle with a vertex inside the box
+	const AxisAlignedBox box( vec3( -0.2f, 0, -1 ), vec3( 0.3f, 1, 1 ) );
+	std::vector<uint32_t> overlapping;
+	bvh.queryOverlapping( box, &overlapping );
+	for( size_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+		vec3 a, b, c;
+		mesh.getTriangleVertices( t, &a, &b, &c );
+		if( box.contains( a ) || box.contains( b ) || box.contains( c ) )
+			REQUIRE( std::find( overlapping.begin(), overlapping.end(), uint32_t( t ) ) != overlapping.end() );
+	}
+
+	// refitting after moving the vertices matches a new hierarchy
+	for( size_t i = 0; i < mesh.getNumVertices(); ++i )
+		mesh.getPositions<3>()[i] *= vec3( 2, 1, 1 );
+	bvh.refit();
+	const TriMeshBvh rebuilt( mesh );
+	REQUIRE( bvh.getBounds().getMin() == rebuilt.getBounds().getMin() );
+	REQUIRE( bvh.getBounds().getMax() == rebuilt.getBounds().getMax() );
+	for( const Ray &ray : rays ) {
+		const TriMeshBvh::RayHit refitHit = bvh.raycast( ray ), rebuiltHit = rebuilt.raycast( ray );
+		REQUIRE( refitHit.isHit() == rebuiltHit.isHit() );
+		REQUIRE( refitHit.mDistance == Approx( rebuiltHit.mDistance ) );
+	}
+}
+
+SECTION( "large sources load the same as through copyAttrib()" )
+{
+	requireSameAsCopied( geom::Sphere().subdivisions( 300 ).colors() );
+	requireSameAsCopied( geom::Torus().subdivisionsAxis( 256 ).subdivisionsHeight( 160 ).colors() );
+	requireSameAsCopied( geom::TorusKnot().subdivisionsAxis( 1024 ).subdivisionsHeight( 64 ).colors() );
+	requireSameAsCopied( geom::Teapot().subdivisions( 40 ) );
+
+	// a star outline with enough points for the extrusions to be large
+	Shape2d star;
+	star.moveTo( 1, 0 );
+	for( int i = 1; i < 2000; ++i ) {
+		const float angle = float( i ) * 2 * float( M_PI ) / 2000, radius = ( i % 2 ) ? 0.5f : 1.0f;
+		star.lineTo( vec2( cos( angle ), sin( angle ) ) * radius );
+	}
+	star.close();
+
+	const BSpline<3, float> spline( { vec3( 0 ), vec3( 1, 1, 0 ), vec3( 2, 0, 1 ), vec3( 3, 1, 1 ) }, 3, false, true );
+	requireSameAsCopied( geom::Extrude( star, 1 ).subdivisions( 10 ) );
+	requireSameAsCopied( geom::ExtrudeSpline( star, spline, 16 ) );
+}
+
+} // "TriMesh"
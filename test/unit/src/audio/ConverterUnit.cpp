@@ -0,0 +1,139 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/dsp/ConverterResampler.h"
+#include "cinder/CinderMath.h"
+
+#include <vector>
+
+using namespace std;
+using namespace ci::audio;
+
+namespace {
+
+// Resamples a sine from 44.1k to 48k and returns the signal to noise ratio (in decibels) of the output, measured against the analytic sine after the filter latency.
+double computeSineSnr( dsp::Converter::Quality quality, double freq = 1000 )
+{
+	const size_t sourceSampleRate = 44100;
+	const size_t destSampleRate = 48000;
+	const size_t framesPerBlock = 512;
+	const size_t numBlocks = 40;
+
+	dsp::ConverterImplResampler converter( sourceSampleRate, destSampleRate, 1, 1, framesPerBlock, quality );
+
+	Buffer sourceBuffer( framesPerBlock );
+	Buffer destBuffer( converter.getDestMaxFramesPerBlock() );
+	vector<float> output;
+
+	size_t sourcePos = 0;
+	for( size_t block = 0; block < numBlocks; block++ ) {
+		for( size_t i = 0; i < framesPerBlock; i++ )
+			sourceBuffer[i] = (float)sin( 2 * M_PI * freq * double( sourcePos + i ) / sourceSampleRate );
+
+		auto count = converter.convert( &sourceBuffer, &destBuffer );
+		REQUIRE( count.first == framesPerBlock );
+
+		output.insert( output.end(), destBuffer.getData(), destBuffer.getData() + count.second );
+		sourcePos += framesPerBlock;
+	}
+
+	// skip the first and last 100ms so the filter latency and edges don't affect the measurement
+	const size_t skipFrames = destSampleRate / 10;
+	REQUIRE( output.size() > skipFrames * 2 );
+
+	double signal = 0, noise = 0;
+	for( size_t i = skipFrames; i < output.size() - skipFrames; i++ ) {
+		double expected = sin( 2 * M_PI * freq * double( i ) / destSampleRate );
+		signal += expected * expected;
+		noise += ( output[i] - expected ) * ( output[i] - expected );
+	}
+
+	return 10 * log10( signal / noise );
+}
+
+// Resamples a sine of amplitude 1 from 96k to 44.1k and returns the gain (in decibels) of the output.
+double computeDownsampledSineGain( dsp::Converter::Quality quality, double freq )
+{
+	const size_t sourceSampleRate = 96000;
+	const size_t destSampleRate = 44100;
+	const size_t framesPerBlock = 512;
+	const size_t numBlocks = 80;
+
+	dsp::ConverterImplResampler converter( sourceSampleRate, destSampleRate, 1, 1, framesPerBlock, quality );
+
+	Buffer sourceBuffer( framesPerBlock );
+	Buffer destBuffer( converter.getDestMaxFramesPerBlock() );
+	vector<float> output;
+
+	for( size_t block = 0; block < numBlocks; block++ ) {
+		for( size_t i = 0; i < framesPerBlock; i++ )
+			sourceBuffer[i] = (float)sin( 2 * M_PI * freq * double( block * framesPerBlock + i ) / sourceSampleRate );
+
+		auto count = converter.convert( &sourceBuffer, &destBuffer );
+		output.insert( output.end(), destBuffer.getData(), destBuffer.getData() + count.second );
+	}
+
+	const size_t skipFrames = destSampleRate / 10;
+	REQUIRE( output.size() > skipFrames * 2 );
+
+	double energy = 0;
+	for( size_t i = skipFrames; i < output.size() - skipFrames; i++ )
+		energy += output[i] * output[i];
+
+	// the mean square of a sine with amplitude 1 is 0.5
+	return 10 * log10( energy / double( output.size() - skipFrames * 2 ) / 0.5 );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/Converter" )
+{
+
+SECTION( "linear sine snr" )
+{
+	REQUIRE( computeSineSnr( dsp::Converter::Quality::LINEAR ) > 45 );
+}
+
+SECTION( "cubic sine snr" )
+{
+	REQUIRE( computeSineSnr( dsp::Converter::Quality::CUBIC ) > 70 );
+}
+
+SECTION( "sinc sine snr" )
+{
+	// the kaiser window gives about 80 dB of attenuation, and unlike CUBIC this holds up to high frequencies
+	REQUIRE( computeSineSnr( dsp::Converter::Quality::SINC ) > 80 );
+	REQUIRE( computeSineSnr( dsp::Converter::Quality::SINC, 10000 ) > 80 );
+	REQUIRE( computeSineSnr( dsp::Converter::Quality::CUBIC, 10000 ) < 40 );
+}
+
+SECTION( "sinc stopband" )
+{
+	// a tone above the destination nyquist would alias back to 14.1k, so it must be filtered out
+	REQUIRE( computeDownsampledSineGain( dsp::Converter::Quality::SINC, 30000 ) < -80 );
+	REQUIRE( computeDownsampledSineGain( dsp::Converter::Quality::LINEAR, 30000 ) > -10 );
+
+	// while passband tones keep their level
+	REQUIRE( std::abs( computeDownsampledSineGain( dsp::Converter::Quality::SINC, 1000 ) ) < 0.1 );
+}
+
+SECTION( "varispeed output count" )
+{
+	const size_t framesPerBlock = 512;
+	dsp::ConverterImplResampler converter( 44100, 44100, 2, 2, framesPerBlock, dsp::Converter::Quality::SINC );
+
+	Buffer sourceBuffer( framesPerBlock, 2 );
+	Buffer destBuffer( converter.getDestMaxFramesPerBlock() * 2, 2 );
+	fillRandom( &sourceBuffer );
+
+	// playing back at double speed should produce roughly half as many frames
+	converter.setRate( 2.0 );
+	size_t totalDest = 0;
+	for( int i = 0; i < 8; i++ )
+		totalDest += converter.convert( &sourceBuffer, &destBuffer ).second;
+
+	REQUIRE( totalDest > framesPerBlock * 8 / 2 - framesPerBlock / 2 );
+	REQUIRE( totalDest < framesPerBlock * 8 / 2 + framesPerBlock / 2 );
+}
+
+} // "audio/Converter"
@@ -0,0 +1,84 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/dsp/Convolver.h"
+
+#include <vector>
+
+using namespace std;
+using namespace ci::audio;
+
+namespace {
+
+// time-domain reference
+vector<float> convolveDirect( const Buffer &input, const Buffer &ir )
+{
+	vector<float> result( input.getNumFrames(), 0.0f );
+	for( size_t n = 0; n < input.getNumFrames(); n++ ) {
+		double sum = 0;
+		for( size_t k = 0; k < ir.getNumFrames() && k <= n; k++ )
+			sum += ir[k] * input[n - k];
+
+		result[n] = (float)sum;
+	}
+
+	return result;
+}
+
+float computeMaxError( size_t partitionSize, size_t irLength, size_t chunkSize )
+{
+	const size_t numFrames = 4096;
+
+	Buffer input( numFrames );
+	Buffer ir( irLength );
+	fillRandom( &input );
+	fillRandom( &ir );
+
+	auto kernel = make_shared<dsp::ConvolutionKernel>( ir.getData(), ir.getNumFrames(), partitionSize );
+	dsp::Convolver convolver( kernel );
+
+	vector<float> output( numFrames );
+	for( size_t offset = 0; offset < numFrames; offset += chunkSize ) {
+		size_t count = min( chunkSize, numFrames - offset );
+		convolver.process( input.getData() + offset, output.data() + offset, count );
+	}
+
+	auto expected = convolveDirect( input, ir );
+
+	float maxErr = 0;
+	for( size_t i = 0; i < numFrames; i++ )
+		maxErr = max( maxErr, fabs( output[i] - expected[i] ) );
+
+	return maxErr;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/Convolver" )
+{
+
+// summing many random products accumulates more rounding error than a single transform
+const float acceptableError = 0.001f;
+
+SECTION( "chunk equals partition" )
+{
+	REQUIRE( computeMaxError( 64, 1000, 64 ) < acceptableError );
+	REQUIRE( computeMaxError( 256, 256, 256 ) < acceptableError );
+}
+
+SECTION( "chunk smaller than partition" )
+{
+	REQUIRE( computeMaxError( 128, 700, 37 ) < acceptableError );
+}
+
+SECTION( "chunk larger than partition" )
+{
+	REQUIRE( computeMaxError( 32, 300, 100 ) < acceptableError );
+}
+
+SECTION( "impulse response shorter than partition" )
+{
+	REQUIRE( computeMaxError( 512, 10, 512 ) < acceptableError );
+}
+
+} // "audio/Convolver"
@@ -1,14 +1,18 @@
 #include "cinder/Cinder.h"
 
-// FIXME: OOURA roundtrip FFT seems to be broken on windows for sizeFft = 4 (https://github.com/cinder/Cinder/issues/1263)
-#if ! defined( CINDER_MSW )
-
 #include "catch.hpp"
 #include "utils.h"
 
 #include "cinder/Log.h"
+#include "cinder/Timer.h"
+#include "cinder/audio/Exception.h"
 #include "cinder/audio/dsp/Fft.h"
 
+#if ! defined( CINDER_AUDIO_VDSP )
+	#include "cinder/audio/dsp/ooura/fftsg.h"
+#endif
+
+#include <cmath>
 #include <iostream>
 
 using namespace ci::audio;
@@ -43,8 +47,72 @@ void computeRoundTrip( size_t sizeFft )
 	REQUIRE( maxErr < ACCEPTABLE_FLOAT_ERROR );
 }
 
+// Compares against a direct DFT, using the packing and scaling conventions documented in Fft.
+void computeAgainstDirectDft( size_t sizeFft )
+{
+	dsp::Fft fft( sizeFft );
+	Buffer waveform( sizeFft );
+	BufferSpectral spectral( sizeFft );
+
+	fillRandom( &waveform );
+	fft.forward( &waveform, &spectral );
+
+#if defined( CINDER_AUDIO_VDSP )
+	const double scale = 2;
+	const double imagSign = 1;
+#else
+	const double scale = 1;
+	const double imagSign = -1;
+#endif
+
+	double maxErr = 0;
+	for( size_t k = 0; k <= sizeFft / 2; k++ ) {
+		double re = 0, im = 0;
+		for( size_t n = 0; n < sizeFft; n++ ) {
+			double phase = -2.0 * M_PI * double( ( k * n ) % sizeFft ) / double( sizeFft );
+			re += waveform[n] * cos( phase );
+			im += waveform[n] * sin( phase );
+		}
+
+		if( k == 0 )
+			maxErr = std::max( maxErr, std::fabs( spectral.getReal()[0] - re * scale ) );
+		else if( k == sizeFft / 2 )
+			maxErr = std::max( maxErr, std::fabs( spectral.getImag()[0] - re * scale ) );
+		else {
+			maxErr = std::max( maxErr, std::fabs( spectral.getReal()[k] - re * scale ) );
+			maxErr = std::max( maxErr, std::fabs( spectral.getImag()[k] - im * scale * imagSign ) );
+		}
+	}
+
+	// error grows with the magnitude of the bins, which is roughly sqrt( sizeFft ) for random input
+	REQUIRE( maxErr < 0.00001 * std::sqrt( double( sizeFft ) ) );
+}
+
+void computeBatch( size_t sizeFft, size_t numChannels )
+{
+	dsp::Fft fft( sizeFft );
+	Buffer waveforms( sizeFft, numChannels );
+	fillRandom( &waveforms );
+
+	std::vector<BufferSpectral> spectraBatch( numChannels, BufferSpectral( sizeFft ) );
+	fft.forwardBatch( &waveforms, spectraBatch.data() );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		Buffer waveform( sizeFft );
+		waveform.copyChannel( 0, waveforms.getChannel( ch ) );
+
+		BufferSpectral spectral( sizeFft );
+		fft.forward( &waveform, &spectral );
+		REQUIRE( maxError( spectral, spectraBatch[ch] ) < ACCEPTABLE_FLOAT_ERROR );
+	}
+
+	Buffer result( sizeFft, numChannels );
+	fft.inverseBatch( spectraBatch.data(), &result );
+	REQUIRE( maxError( result, waveforms ) < ACCEPTABLE_FLOAT_ERROR );
 }
 
+} // anonymous namespace
+
 TEST_CASE( "audio/Fft" )
 {
 
@@ -55,6 +123,86 @@ SECTION( "round trip error" )
 		computeRoundTrip( 2 << i );
 }
 
+SECTION( "mixed radix round trip error" )
+{
+	const size_t sizes[] = { 6, 10, 30, 96, 480, 1000, 1536, 1920, 6000 };
+	for( size_t sizeFft : sizes )
+		computeRoundTrip( sizeFft );
+}
+
+SECTION( "against direct dft" )
+{
+	const size_t sizes[] = { 2, 4, 6, 8, 10, 18, 64, 90, 480, 1024 };
+	for( size_t sizeFft : sizes )
+		computeAgainstDirectDft( sizeFft );
+}
+
+SECTION( "batch matches single" )
+{
+	computeBatch( 512, 4 );
+	computeBatch( 480, 7 );
+	computeBatch( 6, 5 );
+}
+
+SECTION( "supported sizes" )
+{
+	REQUIRE( dsp::FftPlan::isSizeSupported( 480 ) );
+	REQUIRE( ! dsp::FftPlan::isSizeSupported( 7 ) );
+	REQUIRE( ! dsp::FftPlan::isSizeSupported( 14 ) );
+	REQUIRE( dsp::FftPlan::getNextSupportedSize( 14 ) == 16 );
+	REQUIRE( dsp::FftPlan::get( 480 ) == dsp::FftPlan::get( 480 ) );
+	REQUIRE_THROWS_AS( dsp::Fft( 14 ), const AudioExc& );
+}
+
 } // "audio/Fft"
 
-#endif // ! defined( CINDER_MSW )
+#if ! defined( CINDER_AUDIO_VDSP )
+
+// Hidden by default, run explicitly with the "[benchmark]" tag.
+TEST_CASE( "audio/Fft/benchmark", "[.][benchmark]" )
+{
+	const size_t numIterations = 2000;
+
+	for( size_t sizeFft = 256; sizeFft <= 8192; sizeFft *= 2 ) {
+		dsp::Fft fft( sizeFft );
+		Buffer waveform( sizeFft );
+		BufferSpectral spectral( sizeFft );
+		fillRandom( &waveform );
+
+		ci::Timer timer( true );
+		for( size_t i = 0; i < numIterations; i++ ) {
+			fft.forward( &waveform, &spectral );
+			fft.inverse( &spectral, &waveform );
+		}
+		double fftSeconds = timer.getSeconds();
+
+		// reference: the Ooura transform that Fft previously wrapped
+		std::vector<int> ooIp( 2 + (size_t)std::sqrt( sizeFft / 2 ) );
+		std::vector<float> ooW( sizeFft / 2 );
+		std::vector<float> data( waveform.getData(), waveform.getData() + sizeFft );
+		ooIp[0] = 0;
+
+		timer.start();
+		for( size_t i = 0; i < numIterations; i++ ) {
+			dsp::ooura::rdft( (int)sizeFft, 1, data.data(), ooIp.data(), ooW.data() );
+			dsp::ooura::rdft( (int)sizeFft, -1, data.data(), ooIp.data(), ooW.data() );
+		}
+		double oouraSeconds = timer.getSeconds();
+
+		const size_t numChannels = 8;
+		Buffer waveforms( sizeFft, numChannels );
+		std::vector<BufferSpectral> spectra( numChannels, BufferSpectral( sizeFft ) );
+		fillRandom( &waveforms );
+
+		timer.start();
+		for( size_t i = 0; i < numIterations / numChannels; i++ ) {
+			fft.forwardBatch( &waveforms, spectra.data() );
+			fft.inverseBatch( spectra.data(), &waveforms );
+		}
+		double batchSeconds = timer.getSeconds();
+
+		CI_LOG_I( "sizeFft: " << sizeFft << ", Fft: " << fftSeconds << "s, ooura: " << oouraSeconds << "s, Fft batched: " << batchSeconds << "s" );
+	}
+}
+
+#endif // ! defined( CINDER_AUDIO_VDSP )
@@ -0,0 +1,119 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/FileOggVorbis.h"
+#include "cinder/audio/Target.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/Utilities.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+// long enough for loadBufferParallel() to decode in several chunks
+const size_t NUM_FRAMES = SAMPLE_RATE * 13;
+
+// Writes a stereo ogg vorbis file of \a numFrames frames, with a different sine in each channel, to \a fileName in the documents directory.
+ci::fs::path writeOggFile( const string &fileName, size_t numFrames )
+{
+	Buffer buffer( numFrames, 2 );
+	for( size_t i = 0; i < numFrames; i++ ) {
+		buffer.getChannel( 0 )[i] = 0.5f * (float)sin( 2 * M_PI * 440 * double( i ) / SAMPLE_RATE );
+		buffer.getChannel( 1 )[i] = 0.5f * (float)sin( 2 * M_PI * 1234 * double( i ) / SAMPLE_RATE );
+	}
+
+	const ci::fs::path path = ci::getDocumentsDirectory() / fileName;
+	TargetFile::create( path, SAMPLE_RATE, 2, SampleType::FLOAT_32 )->write( &buffer );
+	return path;
+}
+
+shared_ptr<SourceFileOggVorbis> loadOgg( const ci::fs::path &path )
+{
+	auto result = dynamic_pointer_cast<SourceFileOggVorbis>( load( ci::loadFile( path ) ) );
+	REQUIRE( result );
+	return result;
+}
+
+bool isEqual( const Buffer &a, const Buffer &b )
+{
+	return a.getNumFrames() == b.getNumFrames() && a.getNumChannels() == b.getNumChannels() && equal( a.getData(), a.getData() + a.getSize(), b.getData() );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/FileOggVorbis" )
+{
+
+const ci::fs::path oggPath = writeOggFile( "testoutput_audio_long.ogg", NUM_FRAMES );
+
+SECTION( "seek index write and read" )
+{
+	auto source = loadOgg( oggPath );
+	auto index = source->buildSeekIndex();
+	REQUIRE( index->getNumFrames() == NUM_FRAMES );
+	REQUIRE( index->getFileSize() == ci::fs::file_size( oggPath ) );
+	REQUIRE( index->getPages().size() > 1 );
+	REQUIRE( index->getPages().back().mEndFrame == NUM_FRAMES );
+
+	const ci::fs::path indexPath = ci::getDocumentsDirectory() / "testoutput_audio_long.ogg.index";
+	index->write( ci::writeFile( indexPath ) );
+	auto readIndex = SeekIndexOggVorbis::read( ci::loadFile( indexPath ) );
+
+	REQUIRE( readIndex->getFileSize() == index->getFileSize() );
+	REQUIRE( readIndex->getNumFrames() == index->getNumFrames() );
+	REQUIRE( readIndex->getPages().size() == index->getPages().size() );
+	for( size_t i = 0; i < index->getPages().size(); i++ ) {
+		REQUIRE( readIndex->getPages()[i].mByteOffset == index->getPages()[i].mByteOffset );
+		REQUIRE( readIndex->getPages()[i].mEndFrame == index->getPages()[i].mEndFrame );
+	}
+
+	// seeking with the loaded index decodes exactly the same frames as reading straight through
+	BufferRef expected = loadOgg( oggPath )->loadBuffer();
+	auto indexed = loadOgg( oggPath );
+	indexed->setSeekIndex( readIndex );
+
+	Buffer block( 1000, 2 );
+	for( size_t frame : { size_t( 0 ), size_t( 1 ), size_t( 4095 ), SAMPLE_RATE * 5 + 17, NUM_FRAMES - 2000, size_t( 12345 ) } ) {
+		indexed->seek( frame );
+		REQUIRE( indexed->read( &block ) == block.getNumFrames() );
+		for( size_t ch = 0; ch < 2; ch++ )
+			REQUIRE( equal( block.getChannel( ch ), block.getChannel( ch ) + block.getNumFrames(), expected->getChannel( ch ) + frame ) );
+	}
+}
+
+SECTION( "seek index mismatch" )
+{
+	auto index = loadOgg( oggPath )->buildSeekIndex();
+
+	auto otherSource = loadOgg( writeOggFile( "testoutput_audio_short.ogg", SAMPLE_RATE ) );
+	REQUIRE_THROWS_AS( otherSource->setSeekIndex( index ), const AudioFileExc& );
+	otherSource->setSeekIndex( nullptr );
+
+	// a file that isn't an index, and an index that is cut short
+	const ci::fs::path indexPath = ci::getDocumentsDirectory() / "testoutput_audio_long.ogg.index";
+	REQUIRE_THROWS_AS( SeekIndexOggVorbis::read( ci::loadFile( oggPath ) ), const AudioFileExc& );
+
+	index->write( ci::writeFile( indexPath ) );
+	ci::fs::resize_file( indexPath, ci::fs::file_size( indexPath ) / 2 );
+	REQUIRE_THROWS_AS( SeekIndexOggVorbis::read( ci::loadFile( indexPath ) ), const AudioFileExc& );
+}
+
+SECTION( "parallel load is identical to a serial load" )
+{
+	BufferRef expected = loadOgg( oggPath )->loadBuffer();
+	REQUIRE( expected->getNumFrames() == NUM_FRAMES );
+
+	for( size_t numThreads : { 1, 2, 3, 8 } )
+		REQUIRE( isEqual( *loadOgg( oggPath )->loadBufferParallel( numThreads ), *expected ) );
+
+	auto buffers = loadBuffers( vector<ci::DataSourceRef>{ ci::loadFile( oggPath ), ci::loadFile( oggPath ) } );
+	REQUIRE( buffers.size() == 2 );
+	REQUIRE( isEqual( *buffers[0], *expected ) );
+	REQUIRE( isEqual( *buffers[1], *expected ) );
+}
+
+} // audio/FileOggVorbis
@@ -0,0 +1,138 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/SamplePlayerNode.h"
+#include "cinder/Rand.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+const size_t FRAMES_PER_BLOCK = 64;
+
+// A mono SourceFile in which every sample holds its frame index plus one, so that played samples reveal where they were read from.
+class RampSourceFile : public SourceFile {
+  public:
+	RampSourceFile( size_t numFrames )
+		: SourceFile( SAMPLE_RATE ), mPos( 0 )
+	{
+		mNumFrames = mFileNumFrames = numFrames;
+	}
+
+	size_t			getNumChannels() const override			{ return 1; }
+	size_t			getSampleRateNative() const override	{ return SAMPLE_RATE; }
+	SourceFileRef	cloneWithSampleRate( size_t ) const override	{ return make_shared<RampSourceFile>( mFileNumFrames ); }
+
+  protected:
+	size_t performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded ) override
+	{
+		for( size_t i = 0; i < numFramesNeeded; i++ )
+			buffer->getChannel( 0 )[bufferFrameOffset + i] = float( mPos + i + 1 );
+
+		mPos += numFramesNeeded;
+		return numFramesNeeded;
+	}
+
+	void performSeek( size_t readPositionFrames ) override	{ mPos = readPositionFrames; }
+
+  private:
+	size_t	mPos;
+};
+
+// Checks that the samples of each block played without a seek being posted meanwhile are contiguous and end at the read position.
+// Blocks during which a seek is posted may switch to the new position partway through, so they are skipped.
+class CheckedFilePlayerNode : public FilePlayerNode {
+  public:
+	CheckedFilePlayerNode( const SourceFileRef &sourceFile )
+		: FilePlayerNode( sourceFile, true ), mNumCheckedBlocks( 0 ), mNumErrors( 0 )
+	{}
+
+	// seeks and checks are serialized with this, so that a check never sees a seek that is only half posted.
+	mutex	mSeekMutex;
+	size_t	mNumCheckedBlocks, mNumErrors;
+
+  protected:
+	void process( Buffer *buffer ) override
+	{
+		FilePlayerNode::process( buffer );
+
+		lock_guard<mutex> lock( mSeekMutex );
+		if( mReadGeneration != mSeekGeneration.load() )
+			return;
+
+		const float *samples = buffer->getChannel( 0 );
+		size_t numPlayed = 0;
+		while( numPlayed < buffer->getNumFrames() && samples[numPlayed] != 0 )
+			numPlayed++;
+
+		if( ! numPlayed )
+			return;
+
+		for( size_t i = 1; i < numPlayed; i++ ) {
+			if( samples[i] != samples[i - 1] + 1 )
+				mNumErrors++;
+		}
+
+		if( size_t( samples[numPlayed - 1] ) != mReadPos )
+			mNumErrors++;
+
+		mNumCheckedBlocks++;
+	}
+};
+
+} // anonymous namespace
+
+TEST_CASE( "audio/FilePlayerNode" )
+{
+
+SECTION( "seeking while streaming" )
+{
+	const size_t numFrames = SAMPLE_RATE * 60;
+
+	auto context = make_shared<TestContext>();
+	auto output = context->makeNode( new TestOutputNode( 1, SAMPLE_RATE, FRAMES_PER_BLOCK ) );
+	context->setOutput( output );
+
+	auto player = context->makeNode( new CheckedFilePlayerNode( make_shared<RampSourceFile>( numFrames ) ) );
+	player >> output;
+	player->start();
+	context->enable();
+
+	atomic<bool> seeking( true );
+	thread seekThread( [&] {
+		ci::Rand rnd( 1 );
+		for( size_t i = 0; i < 2000; i++ ) {
+			{
+				lock_guard<mutex> lock( player->mSeekMutex );
+				player->seek( size_t( rnd.nextUint( uint32_t( numFrames / 2 ) ) ) );
+			}
+			this_thread::sleep_for( chrono::microseconds( rnd.nextUint( 200 ) ) );
+		}
+		seeking = false;
+	} );
+
+	Buffer buffer( FRAMES_PER_BLOCK );
+	while( seeking ) {
+		output->render( &buffer );
+		this_thread::sleep_for( chrono::microseconds( 20 ) );
+	}
+	seekThread.join();
+
+	// let the last seek play out
+	for( size_t i = 0; i < 1000; i++ ) {
+		output->render( &buffer );
+		this_thread::sleep_for( chrono::microseconds( 20 ) );
+	}
+
+	REQUIRE( player->mNumErrors == 0 );
+	REQUIRE( player->mNumCheckedBlocks > 100 );
+	REQUIRE( player->isEnabled() );
+}
+
+} // audio/FilePlayerNode
@@ -0,0 +1,119 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/GenNode.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+const size_t FRAMES_PER_BLOCK = 64;
+
+// A GenOscBankNode of sines connected to a TestOutputNode.
+struct TestBank {
+	TestBank( const vector<float> &freqs, float gain )
+		: mContext( make_shared<TestContext>() ), mFreqs( freqs ), mGain( gain )
+	{
+		mOutput = mContext->makeNode( new TestOutputNode( 1, SAMPLE_RATE, FRAMES_PER_BLOCK ) );
+		mContext->setOutput( mOutput );
+		mBank = mContext->makeNode( new GenOscBankNode( freqs.size(), WaveformType::SINE ) );
+		mBank >> mOutput;
+		mBank->enable();
+		mContext->enable();
+
+		mBank->setFreqs( freqs.data(), freqs.size() );
+		for( size_t i = 0; i < freqs.size(); i++ )
+			mBank->setGain( i, gain );
+	}
+
+	// Renders \a numBlocks blocks and returns the signal to noise ratio in dB of the output against the analytic sum of sines.
+	// The freq scale of each frame is read back from the Param. The first block is skipped, since the gains ramp up from zero over it.
+	double renderSnr( size_t numBlocks )
+	{
+		vector<double> phases( mFreqs.size(), 0.0 );
+		double signal = 0, noise = 0;
+		Buffer block( FRAMES_PER_BLOCK );
+		for( size_t b = 0; b < numBlocks; b++ ) {
+			mOutput->render( &block );
+			const float *scales = mBank->getParamFreqScale()->getValueArray();
+
+			for( size_t i = 0; i < FRAMES_PER_BLOCK; i++ ) {
+				double expected = 0;
+				for( size_t k = 0; k < mFreqs.size(); k++ ) {
+					expected += mGain * sin( 2 * M_PI * phases[k] );
+					phases[k] += double( mFreqs[k] ) * scales[i] / double( SAMPLE_RATE );
+					phases[k] -= floor( phases[k] );
+				}
+
+				if( b > 0 ) {
+					signal += expected * expected;
+					noise += ( block[i] - expected ) * ( block[i] - expected );
+				}
+			}
+		}
+
+		return 10 * log10( signal / noise );
+	}
+
+	shared_ptr<TestContext>		mContext;
+	shared_ptr<TestOutputNode>	mOutput;
+	GenOscBankNodeRef			mBank;
+	vector<float>				mFreqs;
+	float						mGain;
+};
+
+} // anonymous namespace
+
+TEST_CASE( "audio/GenOscBankNode" )
+{
+
+// detuned unison voices, and partials close to, at and beyond the nyquist, which alias exactly like a sampled sine does
+const vector<float> freqs = { 440, 440 * 1.003f, 440 / 1.003f, 1000, 12345.6f, 21000, 22000, 22050, 30000, 65000, 100000 };
+const float gain = 1.0f / float( freqs.size() );
+const size_t numBlocks = SAMPLE_RATE / FRAMES_PER_BLOCK;
+
+SECTION( "output matches a sum of sines" )
+{
+	TestBank test( freqs, gain );
+	REQUIRE( test.renderSnr( numBlocks ) > 75 );
+}
+
+SECTION( "output matches a sum of sines with a freq scale" )
+{
+	TestBank test( freqs, gain );
+	test.mBank->setFreqScale( 1.5f );
+	REQUIRE( test.renderSnr( numBlocks ) > 75 );
+
+	// a sample accurate ramp, which is longer than the rendered frames so that the Param evaluates in every block
+	TestBank ramped( freqs, gain );
+	ramped.mBank->getParamFreqScale()->applyRamp( 1, 4, 2 );
+	REQUIRE( ramped.renderSnr( numBlocks ) > 75 );
+}
+
+SECTION( "a silent bank keeps its phase" )
+{
+	// oscillators without gain only advance their phase, which must end up where a playing one would be
+	TestBank silent( freqs, 0 );
+	silent.mBank->setFreqScale( 2 );
+	silent.renderSnr( 10 );
+	for( size_t i = 0; i < freqs.size(); i++ )
+		silent.mBank->setGain( i, gain );
+
+	TestBank playing( freqs, gain );
+	playing.mBank->setFreqScale( 2 );
+	playing.renderSnr( 10 );
+
+	Buffer silentBlock( FRAMES_PER_BLOCK ), playingBlock( FRAMES_PER_BLOCK );
+	silent.mOutput->render( &silentBlock );
+	silent.mOutput->render( &silentBlock );
+	playing.mOutput->render( &playingBlock );
+	playing.mOutput->render( &playingBlock );
+	for( size_t i = 0; i < FRAMES_PER_BLOCK; i++ )
+		REQUIRE( fabs( silentBlock[i] - playingBlock[i] ) < 1e-4f );
+}
+
+} // audio/GenOscBankNode
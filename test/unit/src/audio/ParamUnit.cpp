@@ -0,0 +1,211 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/Param.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+const size_t FRAMES_PER_BLOCK = 64;
+
+// Reference ramps evaluated one sample at a time in double precision. Being lambdas, they aren't detected as built-in ramps,
+// so Param evaluates them through the std::function.
+const RampFn referenceLinear = []( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd ) {
+	for( size_t i = 0; i < count; i++ )
+		array[i] = float( valueBegin + ( double( valueEnd ) - valueBegin ) * ( t + double( i ) * tIncr ) );
+};
+
+const RampFn referenceExponential = []( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd ) {
+	if( valueBegin == 0 || valueEnd == 0 || ( valueBegin < 0 ) != ( valueEnd < 0 ) ) {
+		referenceLinear( array, count, t, tIncr, valueBegin, valueEnd );
+		return;
+	}
+
+	for( size_t i = 0; i < count; i++ )
+		array[i] = float( valueBegin * pow( double( valueEnd ) / valueBegin, t + double( i ) * tIncr ) );
+};
+
+// A Context with Params that aren't connected to anything, so that they are only evaluated when the test calls eval().
+struct TestParams {
+	TestParams()
+		: mContext( make_shared<TestContext>() )
+	{
+		mContext->setOutput( mContext->makeNode( new TestOutputNode( 1, SAMPLE_RATE, FRAMES_PER_BLOCK ) ) );
+	}
+
+	Param* makeParam( float initialValue )
+	{
+		mNodes.push_back( mContext->makeNode( new GainNode( initialValue ) ) );
+		return mNodes.back()->getParam();
+	}
+
+	static double frameToSeconds( double frame )	{ return frame / double( SAMPLE_RATE ); }
+
+	shared_ptr<TestContext>		mContext;
+	vector<GainNodeRef>			mNodes;
+};
+
+// Returns whether \a value is within \a tolerance of \a expected, relative to its magnitude when that is greater than one.
+bool isClose( float value, float expected, float tolerance )
+{
+	return fabs( value - expected ) <= tolerance * max( 1.0f, fabs( expected ) );
+}
+
+// Evaluates both Params for \a numBlocks blocks and returns the number of samples that aren't within \a tolerance of each other,
+// plus the number of blocks in which they disagree on whether they are varying or on their value.
+size_t countMismatches( Param *param, Param *reference, size_t numBlocks, float tolerance )
+{
+	size_t result = 0;
+	vector<float> array( FRAMES_PER_BLOCK ), referenceArray( FRAMES_PER_BLOCK );
+	for( size_t b = 0; b < numBlocks; b++ ) {
+		const double timeBegin = TestParams::frameToSeconds( double( b * FRAMES_PER_BLOCK ) );
+		const bool isVarying = param->eval( timeBegin, array.data(), FRAMES_PER_BLOCK, SAMPLE_RATE );
+		const bool isReferenceVarying = reference->eval( timeBegin, referenceArray.data(), FRAMES_PER_BLOCK, SAMPLE_RATE );
+		if( isVarying != isReferenceVarying || ! isClose( param->getValue(), reference->getValue(), tolerance ) ) {
+			result++;
+			continue;
+		}
+
+		if( isVarying ) {
+			for( size_t i = 0; i < FRAMES_PER_BLOCK; i++ ) {
+				if( ! isClose( array[i], referenceArray[i], tolerance ) )
+					result++;
+			}
+		}
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/Param" )
+{
+
+SECTION( "built-in ramps match the std::function ramps" )
+{
+	struct Ramp {
+		RampFn	mFast, mReference;
+		float	mValues[3];
+	};
+	const Ramp ramps[] = {
+		{ rampLinear, referenceLinear, { 0.5f, 4, -1 } },
+		{ rampExponential, referenceExponential, { 0.5f, 4, 0.01f } },
+		// zero and a change of sign fall back to linear
+		{ rampExponential, referenceExponential, { 0, 3, -2 } }
+	};
+
+	for( const auto &ramp : ramps ) {
+		TestParams test;
+		Param *param = test.makeParam( ramp.mValues[0] );
+		Param *reference = test.makeParam( ramp.mValues[0] );
+
+		// events begin and end partway through blocks, and the second one starts in the block the first one ends in
+		for( auto p : { make_pair( param, ramp.mFast ), make_pair( reference, ramp.mReference ) } ) {
+			p.first->applyRamp( ramp.mValues[1], TestParams::frameToSeconds( 300.5 ), Param::Options().beginTime( TestParams::frameToSeconds( 37.25 ) ).rampFn( p.second ) );
+			p.first->appendRamp( ramp.mValues[2], TestParams::frameToSeconds( 1000 ), Param::Options().rampFn( p.second ) );
+		}
+
+		REQUIRE( countMismatches( param, reference, 30, 1e-5f ) == 0 );
+		REQUIRE( param->getNumEvents() == 0 );
+		REQUIRE( param->getValue() == ramp.mValues[2] );
+	}
+}
+
+SECTION( "flat ramps are only constant for the built-in ramps" )
+{
+	TestParams test;
+	float array[FRAMES_PER_BLOCK];
+
+	// the built-in ramps are detected, so a flat one over the whole block is reported as constant without filling the array
+	for( const RampFn &rampFn : { RampFn( rampLinear ), RampFn( rampExponential ) } ) {
+		Param *param = test.makeParam( 2 );
+		param->applyRamp( 2, 2, 1, Param::Options().rampFn( rampFn ) );
+		fill( array, array + FRAMES_PER_BLOCK, -1.0f );
+		REQUIRE_FALSE( param->eval( 0, array, FRAMES_PER_BLOCK, SAMPLE_RATE ) );
+		REQUIRE( param->getValue() == 2 );
+		REQUIRE( array[0] == -1 );
+	}
+
+	// other ramps go through the std::function, even when flat
+	for( const RampFn &rampFn : { RampFn( rampInQuad ), referenceLinear } ) {
+		Param *param = test.makeParam( 2 );
+		param->applyRamp( 2, 2, 1, Param::Options().rampFn( rampFn ) );
+		REQUIRE( param->eval( 0, array, FRAMES_PER_BLOCK, SAMPLE_RATE ) );
+		REQUIRE( count( array, array + FRAMES_PER_BLOCK, 2.0f ) == FRAMES_PER_BLOCK );
+	}
+
+	// a flat ramp that only covers part of the block is filled
+	Param *param = test.makeParam( 1 );
+	param->applyRamp( 3, 3, 1, Param::Options().beginTime( TestParams::frameToSeconds( 10 ) ) );
+	REQUIRE( param->eval( 0, array, FRAMES_PER_BLOCK, SAMPLE_RATE ) );
+	REQUIRE( array[9] == 1 );
+	REQUIRE( array[10] == 3 );
+	REQUIRE( array[FRAMES_PER_BLOCK - 1] == 3 );
+}
+
+SECTION( "events that haven't begun are skipped" )
+{
+	TestParams test;
+	Param *param = test.makeParam( 1 );
+	param->applyRamp( 2, 1, Param::Options().beginTime( TestParams::frameToSeconds( 1000 ) ) );
+
+	float array[FRAMES_PER_BLOCK];
+	fill( array, array + FRAMES_PER_BLOCK, -1.0f );
+	size_t block = 0;
+	for( ; ( block + 1 ) * FRAMES_PER_BLOCK <= 1000; block++ ) {
+		REQUIRE_FALSE( param->eval( TestParams::frameToSeconds( double( block * FRAMES_PER_BLOCK ) ), array, FRAMES_PER_BLOCK, SAMPLE_RATE ) );
+		REQUIRE( array[0] == -1 );
+		REQUIRE( param->getNumEvents() == 1 );
+		REQUIRE( param->getValue() == 1 );
+	}
+
+	// the block the event begins in
+	REQUIRE( param->eval( TestParams::frameToSeconds( double( block * FRAMES_PER_BLOCK ) ), array, FRAMES_PER_BLOCK, SAMPLE_RATE ) );
+	REQUIRE( array[1000 - block * FRAMES_PER_BLOCK - 1] == 1 );
+	REQUIRE( array[FRAMES_PER_BLOCK - 1] > 1 );
+
+	// an earlier event that is added later is still found
+	Param *other = test.makeParam( 1 );
+	other->applyRamp( 2, 1, Param::Options().beginTime( 10 ) );
+	REQUIRE_FALSE( other->eval( 0, array, FRAMES_PER_BLOCK, SAMPLE_RATE ) );
+	other->appendRamp( 5, 1, Param::Options().beginTime( 0 ) );
+	REQUIRE( other->eval( 0, array, FRAMES_PER_BLOCK, SAMPLE_RATE ) );
+	REQUIRE( array[FRAMES_PER_BLOCK - 1] > 1 );
+}
+
+SECTION( "constant value array" )
+{
+	TestParams test;
+	Param *param = test.makeParam( 1 );
+
+	auto isFilledWith = []( const float *array, float value ) {
+		return count( array, array + FRAMES_PER_BLOCK, value ) == FRAMES_PER_BLOCK;
+	};
+
+	REQUIRE_FALSE( param->eval() );
+	REQUIRE( isFilledWith( param->getValueArray(), 1 ) );
+	REQUIRE( isFilledWith( param->getValueArray(), 1 ) );
+
+	param->setValue( 2 );
+	REQUIRE_FALSE( param->eval() );
+	REQUIRE( isFilledWith( param->getValueArray(), 2 ) );
+
+	// a varying block overwrites the array, so it is refilled once the Param is constant again, even with the same value
+	param->applyRamp( 2, 10, 1 );
+	REQUIRE( param->eval() );
+	REQUIRE( param->getValueArray()[0] == 2 );
+	REQUIRE( param->getValueArray()[FRAMES_PER_BLOCK - 1] > 2 );
+
+	param->setValue( 2 );
+	REQUIRE_FALSE( param->eval() );
+	REQUIRE( isFilledWith( param->getValueArray(), 2 ) );
+}
+
+} // audio/Param
@@ -0,0 +1,142 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/SampleCache.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/Target.h"
+#include "cinder/Utilities.h"
+
+#include <cmath>
+#include <fstream>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+
+// Writes a stereo 16-bit flac file of \a numFrames frames, with sines at \a freq and twice that in the channels, to \a fileName in the documents directory.
+ci::fs::path writeFlacFile( const string &fileName, size_t numFrames, double freq )
+{
+	Buffer buffer( numFrames, 2 );
+	for( size_t i = 0; i < numFrames; i++ ) {
+		buffer.getChannel( 0 )[i] = 0.5f * (float)sin( 2 * M_PI * freq * double( i ) / SAMPLE_RATE );
+		buffer.getChannel( 1 )[i] = 0.5f * (float)sin( 2 * M_PI * 2 * freq * double( i ) / SAMPLE_RATE );
+	}
+
+	const ci::fs::path path = ci::getDocumentsDirectory() / fileName;
+	TargetFile::create( path, SAMPLE_RATE, 2, SampleType::INT_16 )->write( &buffer );
+	return path;
+}
+
+// Returns the cache directory used by the tests, emptied of files left by earlier runs.
+ci::fs::path makeCacheDirectory()
+{
+	const ci::fs::path result = ci::getDocumentsDirectory() / "testoutput_sample_cache";
+	ci::fs::remove_all( result );
+	return result;
+}
+
+BufferRef decode( const ci::fs::path &path, size_t sampleRate = SAMPLE_RATE )
+{
+	return load( ci::loadFile( path ), sampleRate )->loadBuffer();
+}
+
+bool isEqual( const Buffer &a, const Buffer &b )
+{
+	return a.getNumFrames() == b.getNumFrames() && a.getNumChannels() == b.getNumChannels() && equal( a.getData(), a.getData() + a.getSize(), b.getData() );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/SampleCache" )
+{
+
+const ci::fs::path flacPath = writeFlacFile( "testoutput_sample_cache_a.flac", SAMPLE_RATE, 440 );
+const ci::fs::path cacheDir = makeCacheDirectory();
+
+SECTION( "write and map round trip" )
+{
+	auto cache = SampleCache::create( cacheDir );
+	auto sample = cache->load( ci::loadFile( flacPath ), SAMPLE_RATE );
+	REQUIRE( sample->getNumFrames() == SAMPLE_RATE );
+	REQUIRE( sample->getNumChannels() == 2 );
+	REQUIRE( sample->getSampleRate() == SAMPLE_RATE );
+	REQUIRE( isEqual( *sample->copyToBuffer(), *decode( flacPath ) ) );
+
+	const ci::fs::path cachePath = sample->getFilePath();
+	REQUIRE( cachePath.parent_path() == cacheDir );
+	REQUIRE( cache->getNumFiles() == 1 );
+	REQUIRE( cache->getNumBytes() == ci::fs::file_size( cachePath ) );
+
+	// loads within the process share the CachedSample
+	REQUIRE( cache->load( ci::loadFile( flacPath ), SAMPLE_RATE ) == sample );
+
+	// mark the last sample of the file, which a later cache only sees if it maps the file rather than decoding it again
+	sample.reset();
+	{
+		fstream stream( cachePath.string().c_str(), ios::binary | ios::in | ios::out );
+		const float marker = 2;
+		stream.seekp( -streamoff( sizeof( marker ) ), ios::end );
+		stream.write( reinterpret_cast<const char *>( &marker ), sizeof( marker ) );
+	}
+
+	auto otherCache = SampleCache::create( cacheDir );
+	REQUIRE( otherCache->getNumFiles() == 1 );
+	auto mapped = otherCache->load( ci::loadFile( flacPath ), SAMPLE_RATE );
+	REQUIRE( mapped->getFilePath() == cachePath );
+	REQUIRE( mapped->getChannel( 1 )[SAMPLE_RATE - 1] == 2 );
+
+	// another samplerate is decoded to its own file
+	auto resampled = otherCache->load( ci::loadFile( flacPath ), 48000 );
+	REQUIRE( resampled->getSampleRate() == 48000 );
+	REQUIRE( resampled->getFilePath() != cachePath );
+	REQUIRE( isEqual( *resampled->copyToBuffer(), *decode( flacPath, 48000 ) ) );
+	REQUIRE( otherCache->getNumFiles() == 2 );
+}
+
+SECTION( "a file with another key is decoded again" )
+{
+	const ci::fs::path otherFlacPath = writeFlacFile( "testoutput_sample_cache_b.flac", SAMPLE_RATE / 2, 1000 );
+
+	auto cache = SampleCache::create( cacheDir );
+	const ci::fs::path cachePath = cache->load( ci::loadFile( flacPath ), SAMPLE_RATE )->getFilePath();
+	const ci::fs::path otherCachePath = cache->load( ci::loadFile( otherFlacPath ), SAMPLE_RATE )->getFilePath();
+	REQUIRE( cachePath != otherCachePath );
+
+	// stands in for two keys whose file names collide
+	ci::fs::remove( otherCachePath );
+	ci::fs::copy_file( cachePath, otherCachePath );
+
+	auto sample = SampleCache::create( cacheDir )->load( ci::loadFile( otherFlacPath ), SAMPLE_RATE );
+	REQUIRE( sample->getFilePath() == otherCachePath );
+	REQUIRE( isEqual( *sample->copyToBuffer(), *decode( otherFlacPath ) ) );
+
+	// a source file that has changed since it was cached is a different key
+	writeFlacFile( "testoutput_sample_cache_a.flac", SAMPLE_RATE * 2, 220 );
+	auto changed = cache->load( ci::loadFile( flacPath ), SAMPLE_RATE );
+	REQUIRE( changed->getFilePath() != cachePath );
+	REQUIRE( changed->getNumFrames() == SAMPLE_RATE * 2 );
+	REQUIRE( isEqual( *changed->copyToBuffer(), *decode( flacPath ) ) );
+}
+
+SECTION( "a truncated file is decoded again" )
+{
+	const ci::fs::path cachePath = SampleCache::create( cacheDir )->load( ci::loadFile( flacPath ), SAMPLE_RATE )->getFilePath();
+	const uintmax_t numBytes = ci::fs::file_size( cachePath );
+	const BufferRef expected = decode( flacPath );
+
+	// missing the last sample, cut within the header, and empty
+	for( uintmax_t size : { numBytes - 1, uintmax_t( 10 ), uintmax_t( 0 ) } ) {
+		ci::fs::resize_file( cachePath, size );
+
+		auto cache = SampleCache::create( cacheDir );
+		auto sample = cache->load( ci::loadFile( flacPath ), SAMPLE_RATE );
+		REQUIRE( isEqual( *sample->copyToBuffer(), *expected ) );
+		REQUIRE( ci::fs::file_size( cachePath ) == numBytes );
+		REQUIRE( cache->getNumBytes() == numBytes );
+	}
+}
+
+} // audio/SampleCache
@@ -0,0 +1,147 @@
+#include "catch.hpp"
+
+#include "cinder/audio/SpatialNode.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+// Exposes computeGains() so gains can be checked for any direction without a Context.
+class TestVbapNode : public VbapNode {
+  public:
+	TestVbapNode( const vector<SpatialDirection> &speakers ) : VbapNode( 1, speakers )	{}
+
+	vector<float> gains( const SpatialDirection &direction ) const
+	{
+		vector<float> result( getNumChannels() );
+		computeGains( direction, result.data() );
+		return result;
+	}
+};
+
+float sumOfSquares( const vector<float> &gains )
+{
+	float result = 0;
+	for( float g : gains )
+		result += g * g;
+
+	return result;
+}
+
+// Returns true if \a gains is 1 for \a speaker and 0 for all others.
+bool isOnlySpeaker( const vector<float> &gains, size_t speaker )
+{
+	for( size_t i = 0; i < gains.size(); i++ ) {
+		if( fabs( gains[i] - ( i == speaker ? 1.0f : 0.0f ) ) > 1e-5f )
+			return false;
+	}
+
+	return true;
+}
+
+// Returns true if \a gains is 1/sqrt(2) for both speakers \a a and \a b and 0 for all others.
+bool isEqualPower( const vector<float> &gains, size_t a, size_t b )
+{
+	const float expected = 1 / sqrt( 2.0f );
+	for( size_t i = 0; i < gains.size(); i++ ) {
+		if( fabs( gains[i] - ( i == a || i == b ? expected : 0.0f ) ) > 1e-5f )
+			return false;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/Spatial" )
+{
+
+SECTION( "vbap pairs" )
+{
+	// a 5.0 layout: center, left, right, left surround, right surround
+	TestVbapNode node( { { 0, 0 }, { 30, 0 }, { -30, 0 }, { 110, 0 }, { -110, 0 } } );
+	REQUIRE( node.isHorizontal() );
+
+	for( size_t i = 0; i < node.getSpeakers().size(); i++ )
+		REQUIRE( isOnlySpeaker( node.gains( node.getSpeakers()[i] ), i ) );
+
+	REQUIRE( isEqualPower( node.gains( { 15, 0 } ), 0, 1 ) );
+	REQUIRE( isEqualPower( node.gains( { -70, 0 } ), 2, 4 ) );
+	REQUIRE( isEqualPower( node.gains( { 180, 0 } ), 3, 4 ) );
+
+	for( int azimuth = -180; azimuth < 180; azimuth++ )
+		REQUIRE( sumOfSquares( node.gains( { float( azimuth ), 0 } ) ) == Approx( 1 ) );
+
+	// the node starts with its source in front
+	REQUIRE( node.getGain( 0, 0 ) == Approx( 1 ) );
+}
+
+SECTION( "vbap triplets" )
+{
+	// the corners of an octahedron: front, left, back, right, top and bottom
+	TestVbapNode node( { { 0, 0 }, { 90, 0 }, { 180, 0 }, { -90, 0 }, { 0, 90 }, { 0, -90 } } );
+	REQUIRE( ! node.isHorizontal() );
+
+	for( size_t i = 0; i < node.getSpeakers().size(); i++ )
+		REQUIRE( isOnlySpeaker( node.gains( node.getSpeakers()[i] ), i ) );
+
+	REQUIRE( isEqualPower( node.gains( { 45, 0 } ), 0, 1 ) );
+	REQUIRE( isEqualPower( node.gains( { -90, 45 } ), 3, 4 ) );
+	REQUIRE( isEqualPower( node.gains( { 180, -45 } ), 2, 5 ) );
+
+	for( int elevation = -90; elevation <= 90; elevation += 5 ) {
+		for( int azimuth = -180; azimuth < 180; azimuth += 5 )
+			REQUIRE( sumOfSquares( node.gains( { float( azimuth ), float( elevation ) } ) ) == Approx( 1 ) );
+	}
+}
+
+SECTION( "ambisonic first order" )
+{
+	struct Expected {
+		SpatialDirection	mDirection;
+		float				mAcn[4]; // W, Y, Z, X
+	};
+	const Expected expected[] = {
+		{ { 0, 0 },		{ 1, 0, 0, 1 } },
+		{ { 90, 0 },	{ 1, 1, 0, 0 } },
+		{ { 180, 0 },	{ 1, 0, 0, -1 } },
+		{ { -90, 0 },	{ 1, -1, 0, 0 } },
+		{ { 0, 90 },	{ 1, 0, 1, 0 } },
+		{ { 0, -90 },	{ 1, 0, -1, 0 } }
+	};
+
+	for( const auto &e : expected ) {
+		float result[4];
+		AmbisonicEncoderNode::computeSphericalHarmonics( 1, e.mDirection, result );
+		for( size_t i = 0; i < 4; i++ )
+			REQUIRE( result[i] == Approx( e.mAcn[i] ) );
+	}
+
+	AmbisonicEncoderNode node( 1 );
+	REQUIRE( node.getNumChannels() == 4 );
+	REQUIRE( node.getGain( 0, 0 ) == Approx( 1 ) );
+	REQUIRE( node.getGain( 0, 3 ) == Approx( 1 ) );
+}
+
+SECTION( "ambisonic sn3d normalization" )
+{
+	// with SN3D normalization the squared harmonics of each order sum to 1 in every direction
+	float result[16];
+	for( int elevation = -90; elevation <= 90; elevation += 15 ) {
+		for( int azimuth = -180; azimuth < 180; azimuth += 15 ) {
+			AmbisonicEncoderNode::computeSphericalHarmonics( 3, SpatialDirection( float( azimuth ), float( elevation ) ), result );
+			for( size_t order = 0; order <= 3; order++ ) {
+				float sum = 0;
+				for( size_t acn = order * order; acn < ( order + 1 ) * ( order + 1 ); acn++ )
+					sum += result[acn] * result[acn];
+
+				REQUIRE( sum == Approx( 1 ) );
+			}
+		}
+	}
+}
+
+} // audio/Spatial
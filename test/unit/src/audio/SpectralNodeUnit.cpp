@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/SpectralNode.h"
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+// Leaves the spectra untouched, so the output should be the input delayed by getLatencyFrames().
+class PassThroughSpectralNode : public SpectralNode {
+  public:
+	PassThroughSpectralNode( const Format &format ) : SpectralNode( format )	{}
+
+	using SpectralNode::initialize;
+	using SpectralNode::process;
+
+  protected:
+	void processSpectrum( BufferSpectral * ) override	{}
+};
+
+// Feeds random input through \a node in blocks of \a framesPerBlock and returns the largest difference between each output sample and the input getLatencyFrames() earlier.
+float computeReconstructionError( PassThroughSpectralNode *node, size_t numChannels, size_t framesPerBlock )
+{
+	const size_t numFrames = node->getFftSize() * 8;
+	const size_t latency = node->getLatencyFrames();
+
+	Buffer input( numFrames, numChannels );
+	fillRandom( &input );
+
+	Buffer output( numFrames, numChannels );
+	output.copy( input );
+
+	BufferDynamic block( framesPerBlock, numChannels );
+	for( size_t offset = 0; offset < numFrames; offset += framesPerBlock ) {
+		const size_t count = min( framesPerBlock, numFrames - offset );
+		block.setNumFrames( count );
+		block.copyOffset( output, count, 0, offset );
+		node->process( &block );
+		output.copyOffset( block, count, offset, 0 );
+	}
+
+	float error = 0;
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		for( size_t i = 0; i < numFrames; i++ ) {
+			const float expected = i < latency ? 0 : input.getChannel( ch )[i - latency];
+			error = max( error, fabs( output.getChannel( ch )[i] - expected ) );
+		}
+	}
+
+	return error;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/SpectralNode" )
+{
+
+SECTION( "unmodified spectrum reconstructs the input" )
+{
+	struct Params {
+		size_t			mFftSize, mHopSize;
+		dsp::WindowType	mWindowType;
+	};
+	const Params params[] = {
+		{ 1024, 0, dsp::WindowType::HANN },
+		{ 512, 256, dsp::WindowType::HANN },
+		{ 256, 64, dsp::WindowType::BLACKMAN },
+		{ 256, 100, dsp::WindowType::HAMMING },
+		{ 128, 128, dsp::WindowType::RECT }
+	};
+
+	for( const auto &p : params ) {
+		for( size_t framesPerBlock : { 64, 100, 512 } ) {
+			PassThroughSpectralNode node( SpectralNode::Format().fftSize( p.mFftSize ).hopSize( p.mHopSize ).windowType( p.mWindowType ).channels( 2 ) );
+			node.initialize();
+
+			REQUIRE( node.getLatencyFrames() == p.mFftSize );
+			REQUIRE( computeReconstructionError( &node, 2, framesPerBlock ) < 1e-5f );
+		}
+	}
+}
+
+SECTION( "hop size is reduced when the window vanishes" )
+{
+	// the symmetric HANN window is zero at both edges, so a hop equal to the fft size would drop those samples
+	PassThroughSpectralNode hann( SpectralNode::Format().fftSize( 512 ).hopSize( 512 ).windowType( dsp::WindowType::HANN ) );
+	hann.initialize();
+	REQUIRE( hann.getHopSize() < 512 );
+	REQUIRE( computeReconstructionError( &hann, 1, 128 ) < 1e-5f );
+
+	// a hop larger than the fft size is clamped to it, which a RECT window can reconstruct
+	PassThroughSpectralNode rect( SpectralNode::Format().fftSize( 512 ).hopSize( 1000 ).windowType( dsp::WindowType::RECT ) );
+	rect.initialize();
+	REQUIRE( rect.getHopSize() == 512 );
+	REQUIRE( computeReconstructionError( &rect, 1, 128 ) < 1e-5f );
+}
+
+} // audio/SpectralNode
@@ -0,0 +1,153 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/Target.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/FileFlac.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Utilities.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+// not a multiple of the FLAC block size, so the last block is a partial one
+const size_t NUM_FRAMES = 10000;
+
+// Returns a full-scale 1 kHz sine in the first channel. Other channels hold quieter sines at other frequencies, or noise if \a noise is true.
+Buffer makeSignal( size_t numChannels, bool noise = false )
+{
+	Buffer result( NUM_FRAMES, numChannels );
+	for( size_t i = 0; i < NUM_FRAMES; i++ )
+		result.getChannel( 0 )[i] = (float)sin( 2 * M_PI * 1000 * double( i ) / SAMPLE_RATE );
+
+	for( size_t ch = 1; ch < numChannels; ch++ ) {
+		float *channel = result.getChannel( ch );
+		if( noise ) {
+			Buffer noiseBuffer( NUM_FRAMES );
+			fillRandom( &noiseBuffer );
+			for( size_t i = 0; i < NUM_FRAMES; i++ )
+				channel[i] = noiseBuffer[i] * 0.5f;
+		}
+		else {
+			for( size_t i = 0; i < NUM_FRAMES; i++ )
+				channel[i] = 0.5f * (float)sin( 2 * M_PI * 440 * double( ch ) * double( i ) / SAMPLE_RATE );
+		}
+	}
+
+	return result;
+}
+
+// Writes \a buffer to a file with \a extension, in chunks of \a framesPerWrite, optionally through a TargetFileAsync. Then reads it back with SourceFile.
+BufferRef writeAndLoad( const Buffer &buffer, const string &extension, SampleType sampleType, bool async = false, size_t framesPerWrite = 512 )
+{
+	const ci::fs::path path = ci::getDocumentsDirectory() / ( "testoutput_audio." + extension );
+	{
+		unique_ptr<TargetFile> target = TargetFile::create( path, SAMPLE_RATE, buffer.getNumChannels(), sampleType );
+		if( async )
+			target.reset( new TargetFileAsync( move( target ), buffer.getNumFrames() ) );
+
+		for( size_t offset = 0; offset < buffer.getNumFrames(); offset += framesPerWrite )
+			target->write( &buffer, std::min( framesPerWrite, buffer.getNumFrames() - offset ), offset );
+
+		if( async ) {
+			auto asyncTarget = static_cast<TargetFileAsync *>( target.get() );
+			asyncTarget->flush();
+			REQUIRE( asyncTarget->getNumDroppedFrames() == 0 );
+		}
+	}
+
+	SourceFileRef source = load( ci::loadFile( path ) );
+	REQUIRE( source->getSampleRate() == SAMPLE_RATE );
+	REQUIRE( source->getNumChannels() == buffer.getNumChannels() );
+	REQUIRE( source->getNumFrames() == buffer.getNumFrames() );
+
+	return source->loadBuffer();
+}
+
+// Returns true if every sample of \a decoded equals the corresponding sample of \a original quantized to \a bitsPerSample, the same way TargetFileFlac does.
+bool isQuantizedCopy( const Buffer &original, const Buffer &decoded, size_t bitsPerSample )
+{
+	const float scale = float( 1 << ( bitsPerSample - 1 ) );
+	const int32_t maxValue = ( 1 << ( bitsPerSample - 1 ) ) - 1;
+	const int32_t minValue = - ( 1 << ( bitsPerSample - 1 ) );
+
+	if( original.getNumFrames() != decoded.getNumFrames() || original.getNumChannels() != decoded.getNumChannels() )
+		return false;
+
+	for( size_t i = 0; i < original.getSize(); i++ ) {
+		const int32_t quantized = ci::constrain( int32_t( lround( original.getData()[i] * scale ) ), minValue, maxValue );
+		if( decoded.getData()[i] != float( quantized ) / scale )
+			return false;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/TargetFile" )
+{
+
+SECTION( "flac round trip" )
+{
+	for( size_t numChannels = 1; numChannels <= 2; numChannels++ ) {
+		const Buffer sine = makeSignal( numChannels );
+		REQUIRE( isQuantizedCopy( sine, *writeAndLoad( sine, "flac", SampleType::INT_16 ), 16 ) );
+		REQUIRE( isQuantizedCopy( sine, *writeAndLoad( sine, "flac", SampleType::INT_24 ), 24 ) );
+
+		// FLOAT_32 is stored as 24 bit integers
+		REQUIRE( isQuantizedCopy( sine, *writeAndLoad( sine, "flac", SampleType::FLOAT_32 ), 24 ) );
+
+		const Buffer noise = makeSignal( numChannels, true );
+		REQUIRE( isQuantizedCopy( noise, *writeAndLoad( noise, "flac", SampleType::INT_16, false, 1000 ), 16 ) );
+
+		Buffer silence( NUM_FRAMES, numChannels );
+		silence.zero();
+		REQUIRE( isQuantizedCopy( silence, *writeAndLoad( silence, "flac", SampleType::INT_16 ), 16 ) );
+	}
+}
+
+SECTION( "flac bits per sample" )
+{
+	const ci::fs::path path = ci::getDocumentsDirectory() / "testoutput_audio.flac";
+	REQUIRE( TargetFileFlac( ci::writeFile( path ), SAMPLE_RATE, 1, SampleType::INT_16 ).getBitsPerSample() == 16 );
+	REQUIRE( TargetFileFlac( ci::writeFile( path ), SAMPLE_RATE, 1, SampleType::FLOAT_32 ).getBitsPerSample() == 24 );
+	REQUIRE_THROWS_AS( TargetFileFlac( ci::writeFile( path ), SAMPLE_RATE, 9, SampleType::INT_16 ), const AudioFileExc& );
+}
+
+SECTION( "async round trip" )
+{
+	const Buffer stereo = makeSignal( 2, true );
+	REQUIRE( isQuantizedCopy( stereo, *writeAndLoad( stereo, "flac", SampleType::INT_16, true, 333 ), 16 ) );
+}
+
+SECTION( "ogg round trip" )
+{
+	// vorbis is lossy, so only check that the decoded signal is close to the original
+	for( size_t numChannels = 1; numChannels <= 2; numChannels++ ) {
+		const Buffer sine = makeSignal( numChannels );
+		BufferRef decoded = writeAndLoad( sine, "ogg", SampleType::FLOAT_32 );
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			double signal = 0, noise = 0;
+			for( size_t i = 0; i < NUM_FRAMES; i++ ) {
+				const float expected = sine.getChannel( ch )[i];
+				signal += expected * expected;
+				noise += ( decoded->getChannel( ch )[i] - expected ) * ( decoded->getChannel( ch )[i] - expected );
+			}
+			REQUIRE( 10 * log10( signal / noise ) > 20 );
+		}
+
+		Buffer silence( NUM_FRAMES, numChannels );
+		silence.zero();
+		decoded = writeAndLoad( silence, "ogg", SampleType::FLOAT_32, true );
+		REQUIRE( maxError( silence, *decoded ) < 1e-4f );
+	}
+}
+
+} // audio/TargetFile
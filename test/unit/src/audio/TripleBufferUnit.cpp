@@ -0,0 +1,128 @@
+#include "catch.hpp"
+
+#include "cinder/audio/dsp/TripleBuffer.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+// Publishes a vector whose elements all equal value
+void publish( dsp::TripleBuffer<vector<int>> *tb, int value )
+{
+	vector<int> *slot = tb->beginWrite();
+	REQUIRE( slot );
+	slot->assign( 64, value );
+	tb->endWrite();
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/TripleBuffer" )
+{
+
+SECTION( "first read" )
+{
+	dsp::TripleBuffer<int> tb;
+	int result = -1;
+	REQUIRE_FALSE( tb.read( &result ) );
+	REQUIRE( result == -1 );
+	REQUIRE( tb.getNumPublished() == 0 );
+
+	*tb.beginWrite() = 7;
+	tb.endWrite();
+	REQUIRE( tb.read( &result ) );
+	REQUIRE( result == 7 );
+	REQUIRE( tb.getNumPublished() == 1 );
+}
+
+SECTION( "published values are consistent" )
+{
+	dsp::TripleBuffer<vector<int>> tb;
+	const int numValues = 20000;
+	atomic<bool> done( false ), consistent( true ), ordered( true );
+
+	// Catch isn't thread safe, so the readers only record failures
+	vector<thread> readers;
+	for( int i = 0; i < 3; i++ ) {
+		readers.push_back( thread( [&] {
+			vector<int> value;
+			int lastValue = -1;
+			while( ! done ) {
+				if( ! tb.read( &value ) )
+					continue;
+
+				for( int element : value ) {
+					if( element != value[0] )
+						consistent = false;
+				}
+				if( value[0] < lastValue )
+					ordered = false;
+				lastValue = value[0];
+			}
+		} ) );
+	}
+
+	int numSkipped = 0;
+	for( int i = 0; i < numValues; i++ ) {
+		vector<int> *slot = tb.beginWrite();
+		if( ! slot ) {
+			numSkipped++;
+			continue;
+		}
+		slot->assign( 64, i );
+		tb.endWrite();
+	}
+	done = true;
+	for( auto &reader : readers )
+		reader.join();
+
+	REQUIRE( consistent );
+	REQUIRE( ordered );
+	REQUIRE( tb.getNumPublished() == uint64_t( numValues - numSkipped ) );
+}
+
+SECTION( "write skipped while readers hold the other copies" )
+{
+	dsp::TripleBuffer<vector<int>> tb;
+	atomic<int> numHeld( 0 );
+	atomic<bool> release( false );
+
+	// each reader holds the copy that was latest when it started until released
+	auto holdLatest = [&] {
+		tb.visit( [&]( const vector<int> & ) {
+			numHeld++;
+			while( ! release )
+				this_thread::yield();
+		} );
+	};
+
+	publish( &tb, 1 );
+	thread first( holdLatest );
+	while( numHeld < 1 )
+		this_thread::yield();
+
+	publish( &tb, 2 );
+	thread second( holdLatest );
+	while( numHeld < 2 )
+		this_thread::yield();
+
+	// the only free copy becomes the latest, leaving none to write into
+	publish( &tb, 3 );
+	REQUIRE( tb.beginWrite() == nullptr );
+
+	release = true;
+	first.join();
+	second.join();
+
+	REQUIRE( tb.beginWrite() != nullptr );
+	vector<int> result;
+	REQUIRE( tb.read( &result ) );
+	REQUIRE( result == vector<int>( 64, 3 ) );
+}
+
+} // audio/TripleBuffer
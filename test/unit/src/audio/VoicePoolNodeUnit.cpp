@@ -0,0 +1,222 @@
+#include "catch.hpp"
+#include "utils.h"
+
+#include "cinder/audio/VoicePoolNode.h"
+
+using namespace std;
+using namespace cinder::audio;
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+const size_t FRAMES_PER_BLOCK = 64;
+
+// A mono VoicePoolNode connected to a TestOutputNode, rendered a block at a time.
+struct TestPool {
+	TestPool( const VoicePoolNode::Format &format = VoicePoolNode::Format() )
+		: mContext( make_shared<TestContext>() )
+	{
+		mOutput = mContext->makeNode( new TestOutputNode( 1, SAMPLE_RATE, FRAMES_PER_BLOCK ) );
+		mContext->setOutput( mOutput );
+		mPool = mContext->makeNode( new VoicePoolNode( VoicePoolNode::Format( format ).channels( 1 ) ) );
+		mPool >> mOutput;
+		mContext->enable();
+	}
+
+	// Renders \a numBlocks blocks and returns them concatenated.
+	Buffer render( size_t numBlocks )
+	{
+		Buffer result( numBlocks * FRAMES_PER_BLOCK );
+		Buffer block( FRAMES_PER_BLOCK );
+		for( size_t i = 0; i < numBlocks; i++ ) {
+			mOutput->render( &block );
+			copy( block.getData(), block.getData() + FRAMES_PER_BLOCK, result.getData() + i * FRAMES_PER_BLOCK );
+		}
+
+		return result;
+	}
+
+	double frameToSeconds( uint64_t frame ) const	{ return double( frame ) / double( SAMPLE_RATE ); }
+
+	shared_ptr<TestContext>		mContext;
+	shared_ptr<TestOutputNode>	mOutput;
+	VoicePoolNodeRef			mPool;
+};
+
+// Returns a mono sample of \a numFrames frames holding 1, 2, 3...
+BufferRef makeRamp( size_t numFrames )
+{
+	auto result = make_shared<Buffer>( numFrames );
+	for( size_t i = 0; i < numFrames; i++ )
+		result->getData()[i] = float( i + 1 );
+
+	return result;
+}
+
+// Returns a mono sample of \a numFrames frames that all hold \a value.
+BufferRef makeConstant( size_t numFrames, float value )
+{
+	auto result = make_shared<Buffer>( numFrames );
+	fill( result->getData(), result->getData() + numFrames, value );
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/VoicePoolNode" )
+{
+
+SECTION( "trigger" )
+{
+	TestPool test;
+	const size_t ramp = test.mPool->addSample( makeRamp( 200 ) );
+	REQUIRE( test.mPool->getNumSamples() == 1 );
+
+	auto id = test.mPool->trigger( ramp, VoicePoolNode::TriggerOptions().gain( 0.5f ) );
+	REQUIRE( id != 0 );
+
+	Buffer output = test.render( 2 );
+	REQUIRE( test.mPool->getNumActiveVoices() == 1 );
+	output = test.render( 4 );
+	REQUIRE( test.mPool->getNumActiveVoices() == 0 );
+
+	// the first two blocks were rendered separately, so the remaining frames of the sample start at 128
+	for( size_t i = 0; i < output.getNumFrames(); i++ )
+		REQUIRE( output[i] == ( i + 128 < 200 ? 0.5f * float( i + 129 ) : 0.0f ) );
+
+	// two voices of the same sample mix together
+	test.mPool->trigger( ramp );
+	test.mPool->trigger( ramp );
+	output = test.render( 1 );
+	for( size_t i = 0; i < output.getNumFrames(); i++ )
+		REQUIRE( output[i] == 2 * float( i + 1 ) );
+}
+
+SECTION( "sample accurate trigger offsets" )
+{
+	TestPool test;
+	const size_t ramp = test.mPool->addSample( makeRamp( 20 ) );
+
+	// in the middle of a block, on a block boundary and straddling two blocks
+	const uint64_t startFrames[] = { 1000, 2048, 3071 };
+	for( uint64_t frame : startFrames )
+		test.mPool->trigger( ramp, test.frameToSeconds( frame ), VoicePoolNode::TriggerOptions() );
+
+	const Buffer output = test.render( 4096 / FRAMES_PER_BLOCK );
+	for( size_t i = 0; i < output.getNumFrames(); i++ ) {
+		float expected = 0;
+		for( uint64_t frame : startFrames ) {
+			if( i >= frame && i < frame + 20 )
+				expected = float( i - frame + 1 );
+		}
+		REQUIRE( output[i] == expected );
+	}
+
+	// a time in the past starts at the beginning of the next block
+	test.mPool->trigger( ramp, 0.0, VoicePoolNode::TriggerOptions() );
+	const Buffer late = test.render( 1 );
+	REQUIRE( late[0] == 1 );
+	REQUIRE( late[19] == 20 );
+	REQUIRE( late[20] == 0 );
+}
+
+SECTION( "voice stealing" )
+{
+	// voices hold constant levels that are easy to tell apart in the mix
+	auto format = VoicePoolNode::Format().maxVoices( 2 ).fadeSeconds( 0.001 );
+	const auto loop = VoicePoolNode::TriggerOptions().loop();
+	const size_t fadeBlocks = 2;
+
+	{
+		TestPool test( format.stealPolicy( VoicePoolNode::StealPolicy::OLDEST ) );
+		test.mPool->trigger( test.mPool->addSample( makeConstant( 1000, 1 ) ), loop );
+		test.render( 1 );
+		test.mPool->trigger( test.mPool->addSample( makeConstant( 1000, 10 ) ), loop );
+		test.render( 1 );
+		test.mPool->trigger( test.mPool->addSample( makeConstant( 1000, 100 ) ), loop );
+		test.render( fadeBlocks );
+
+		REQUIRE( test.mPool->getNumStolenVoices() == 1 );
+		REQUIRE( test.mPool->getNumActiveVoices() == 2 );
+		REQUIRE( test.render( 1 )[0] == 110 );
+	}
+
+	{
+		TestPool test( format.stealPolicy( VoicePoolNode::StealPolicy::QUIETEST ) );
+		const size_t one = test.mPool->addSample( makeConstant( 1000, 1 ) );
+		test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 3 ) );
+		test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 1 ) );
+		test.render( 1 );
+		test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 2 ) );
+		test.render( fadeBlocks );
+
+		REQUIRE( test.mPool->getNumStolenVoices() == 1 );
+		REQUIRE( test.render( 1 )[0] == 5 );
+	}
+
+	{
+		TestPool test( format.stealPolicy( VoicePoolNode::StealPolicy::LOWEST_PRIORITY ) );
+		const size_t one = test.mPool->addSample( makeConstant( 1000, 1 ) );
+		test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 1 ).priority( 2 ) );
+		test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 10 ).priority( 1 ) );
+		test.render( 1 );
+
+		// lower than every playing voice, so it is dropped
+		test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 100 ).priority( 0 ) );
+		test.render( fadeBlocks );
+		REQUIRE( test.mPool->getNumDroppedTriggers() == 1 );
+		REQUIRE( test.render( 1 )[0] == 11 );
+
+		test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 100 ).priority( 5 ) );
+		test.render( fadeBlocks );
+		REQUIRE( test.mPool->getNumStolenVoices() == 1 );
+		REQUIRE( test.render( 1 )[0] == 101 );
+	}
+
+	{
+		TestPool test( format.stealPolicy( VoicePoolNode::StealPolicy::NONE ) );
+		const size_t one = test.mPool->addSample( makeConstant( 1000, 1 ) );
+		for( int i = 0; i < 3; i++ )
+			test.mPool->trigger( one, loop );
+
+		test.render( 1 );
+		REQUIRE( test.mPool->getNumStolenVoices() == 0 );
+		REQUIRE( test.mPool->getNumDroppedTriggers() == 1 );
+		REQUIRE( test.render( 1 )[0] == 2 );
+	}
+}
+
+SECTION( "stop and a full command queue" )
+{
+	TestPool test( VoicePoolNode::Format().maxPendingTriggers( 2 ).fadeSeconds( 0.001 ) );
+	const size_t one = test.mPool->addSample( makeConstant( 1000, 1 ) );
+	const auto loop = VoicePoolNode::TriggerOptions().loop();
+
+	auto first = test.mPool->trigger( one, loop );
+	auto second = test.mPool->trigger( one, VoicePoolNode::TriggerOptions( loop ).gain( 10 ) );
+	REQUIRE( first != 0 );
+	REQUIRE( second != 0 );
+
+	// nothing has been processed yet, so the queue is full
+	REQUIRE( test.mPool->trigger( one, loop ) == 0 );
+	REQUIRE( test.mPool->getNumDroppedTriggers() == 1 );
+	REQUIRE( ! test.mPool->stop( first ) );
+	REQUIRE( ! test.mPool->stopAll() );
+
+	REQUIRE( test.render( 1 )[0] == 11 );
+	REQUIRE( test.mPool->stop( first ) );
+
+	// faded out rather than cut
+	Buffer output = test.render( 2 );
+	REQUIRE( output[20] > 10 );
+	REQUIRE( output[20] < 11 );
+	REQUIRE( output[output.getNumFrames() - 1] == 10 );
+	REQUIRE( test.mPool->getNumActiveVoices() == 1 );
+
+	REQUIRE( test.mPool->stopAll() );
+	test.render( 2 );
+	REQUIRE( test.mPool->getNumActiveVoices() == 0 );
+	REQUIRE( test.render( 1 )[0] == 0 );
+}
+
+} // audio/VoicePoolNode
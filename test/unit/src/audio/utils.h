@@ -1,6 +1,8 @@
 #pragma once
 
 #include "cinder/audio/Buffer.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/OutputNode.h"
 #include "cinder/CinderAssert.h"
 #include "cinder/Rand.h"
 
@@ -21,4 +23,32 @@ inline float maxError( const ci::audio::Buffer &a, const ci::audio::Buffer &b )
 		error = std::max( error, std::fabs( a[i] - b[i]) );
 
 	return error;
-}
\ No newline at end of file
+}
+
+// A Context without devices, for testing Node's. Its output is pulled manually with TestOutputNode::render().
+class TestContext : public ci::audio::Context {
+  public:
+	ci::audio::OutputDeviceNodeRef	createOutputDeviceNode( const ci::audio::DeviceRef &, const ci::audio::Node::Format & ) override	{ return nullptr; }
+	ci::audio::InputDeviceNodeRef	createInputDeviceNode( const ci::audio::DeviceRef &, const ci::audio::Node::Format & ) override	{ return nullptr; }
+};
+
+class TestOutputNode : public ci::audio::OutputNode {
+  public:
+	TestOutputNode( size_t numChannels = 1, size_t sampleRate = 44100, size_t framesPerBlock = 64 )
+		: OutputNode( Format().channels( numChannels ) ), mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock )
+	{}
+
+	size_t getOutputSampleRate() override		{ return mSampleRate; }
+	size_t getOutputFramesPerBlock() override	{ return mFramesPerBlock; }
+
+	// Processes one block of the graph connected to this output into buffer.
+	void render( ci::audio::Buffer *buffer )
+	{
+		getContext()->preProcess();
+		pullInputs( buffer );
+		getContext()->postProcess();
+	}
+
+  private:
+	size_t	mSampleRate, mFramesPerBlock;
+};